@@ -34,6 +34,9 @@ fn main() {
     // Check if ASAN should be enabled
     let enable_asan = env::var("CARGO_FEATURE_ASAN").is_ok() || env::var("ENABLE_ASAN").is_ok();
 
+    // Realtime checks: count allocation and locking inside process() (rack::rt::violations)
+    let enable_rt_checks = env::var("CARGO_FEATURE_RT_CHECKS").is_ok();
+
     // Detect docs.rs environment
     let is_docs_rs = env::var("DOCS_RS").is_ok();
 
@@ -41,7 +44,8 @@ fn main() {
     let mut config = cmake::Config::new("rack-sys");
     config
         .define("CMAKE_BUILD_TYPE", "Release")
-        .define("BUILD_TESTS", "OFF"); // Don't build C++ tests in Rust build
+        .define("BUILD_TESTS", "OFF") // Don't build C++ tests in Rust build
+        .define("BUILD_BENCHMARKS", "OFF");
 
     // On docs.rs, allow build to succeed even without plugin formats
     if is_docs_rs {
@@ -74,6 +78,9 @@ fn main() {
         eprintln!("Building with AddressSanitizer enabled");
     }
 
+    // The release build type would leave them off
+    config.define("RACK_RT_CHECKS", if enable_rt_checks { "ON" } else { "OFF" });
+
     let dst = config.build();
 
     // Library name comes from CMake configuration (librack_sys.a)
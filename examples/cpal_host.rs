@@ -27,6 +27,7 @@
 //! - Q: Quit and cleanup
 
 use rack::prelude::*;
+use rack::convert::{self, Dither};
 use cpal::traits::{DeviceTrait, HostTrait, StreamTrait};
 use std::io::{self, Write};
 use std::sync::{Arc, Mutex};
@@ -136,29 +137,39 @@ fn main() -> Result<()> {
     println!("\n🔊 Starting audio stream...");
 
     let stream = match config.sample_format() {
-        cpal::SampleFormat::F32 => build_stream::<f32>(
+        cpal::SampleFormat::F32 => build_stream::<f32, _>(
             &device,
             &config.into(),
             plugin_clone,
             input_clone,
             channels,
             buffer_frames,
+            |src, dst| dst.copy_from_slice(src),
         )?,
-        cpal::SampleFormat::I16 => build_stream::<i16>(
-            &device,
-            &config.into(),
-            plugin_clone,
-            input_clone,
-            channels,
-            buffer_frames,
-        )?,
-        cpal::SampleFormat::U16 => build_stream::<u16>(
+        cpal::SampleFormat::I16 => {
+            let mut dither = Dither::new(1);
+            build_stream::<i16, _>(
+                &device,
+                &config.into(),
+                plugin_clone,
+                input_clone,
+                channels,
+                buffer_frames,
+                move |src, dst| convert::f32_to_i16(src, dst, Some(&mut dither)),
+            )?
+        }
+        cpal::SampleFormat::U16 => build_stream::<u16, _>(
             &device,
             &config.into(),
             plugin_clone,
             input_clone,
             channels,
             buffer_frames,
+            |src, dst| {
+                for (d, s) in dst.iter_mut().zip(src) {
+                    *d = cpal::Sample::from_sample(*s);
+                }
+            },
         )?,
         _ => {
             return Err(Error::Other(
@@ -319,20 +330,29 @@ fn main() -> Result<()> {
 }
 
 /// Build an audio stream for the given sample format
-fn build_stream<T>(
+///
+/// `write_samples` converts the interleaved f32 output to the device format.
+fn build_stream<T, W>(
     device: &cpal::Device,
     config: &cpal::StreamConfig,
     plugin: Arc<Mutex<Plugin>>,
     input: Arc<(Vec<f32>, Vec<f32>)>,
     channels: usize,
     buffer_frames: usize,
+    mut write_samples: W,
 ) -> Result<cpal::Stream>
 where
     T: cpal::Sample + cpal::SizedSample + cpal::FromSample<f32>,
+    W: FnMut(&[f32], &mut [T]) + Send + 'static,
 {
-    // Output buffers (planar format)
+    // Output buffers (planar format), and the interleaved f32 frames handed
+    // to write_samples
     let mut left_out = vec![0.0f32; buffer_frames];
     let mut right_out = vec![0.0f32; buffer_frames];
+    let mut interleaved = vec![0.0f32; buffer_frames * channels];
+
+    // Pick the conversion kernels before the first callback
+    println!("   Sample conversion: {}", convert::simd_level());
 
     let stream = device
         .build_output_stream(
@@ -351,27 +371,28 @@ where
                 }
 
                 // Copy plugin output (planar) to CPAL buffer (interleaved)
-                let frames = data.len() / channels;
-                for i in 0..frames.min(buffer_frames) {
-                    let left = left_out[i];
-                    let right = right_out[i];
-
-                    // Write to output based on channel count
-                    if channels == 2 {
-                        data[i * 2] = cpal::Sample::from_sample(left);
-                        data[i * 2 + 1] = cpal::Sample::from_sample(right);
-                    } else if channels == 1 {
-                        // Mono: average left and right
-                        let mono = (left + right) * 0.5;
-                        data[i] = cpal::Sample::from_sample(mono);
-                    } else {
-                        // Multi-channel: duplicate stereo to all channels
-                        for ch in 0..channels {
-                            let sample = if ch % 2 == 0 { left } else { right };
-                            data[i * channels + ch] = cpal::Sample::from_sample(sample);
+                let frames = (data.len() / channels).min(buffer_frames);
+                let left = &left_out[..frames];
+                let right = &right_out[..frames];
+                let out = &mut interleaved[..frames * channels];
+
+                if channels == 2 {
+                    convert::interleave(&[left, right], out);
+                } else if channels == 1 {
+                    // Mono: average left and right
+                    out.copy_from_slice(left);
+                    convert::mix_add(right, out, 1.0);
+                    convert::apply_gain(out, 0.5);
+                } else {
+                    // Multi-channel: duplicate stereo to all channels
+                    for (i, frame) in out.chunks_exact_mut(channels).enumerate() {
+                        for (ch, sample) in frame.iter_mut().enumerate() {
+                            *sample = if ch % 2 == 0 { left[i] } else { right[i] };
                         }
                     }
                 }
+
+                write_samples(out, &mut data[..frames * channels]);
             },
             move |err| {
                 eprintln!("Stream error: {}", err);
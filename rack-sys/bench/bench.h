@@ -0,0 +1,121 @@
+#ifndef RACK_BENCH_H
+#define RACK_BENCH_H
+
+// Shared pieces of rack_sys_bench: timing, allocation counting, statistics
+// and result output.
+//
+// Results are written as JSON lines, one object per benchmark run, so they
+// can be appended to a log and compared over time. Every object carries
+// "schema": "rack_sys_bench/1"; the first line of a run has "type": "meta"
+// (machine and build), the others "type": "result".
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rack_bench {
+
+// Command line options shared by all benchmark groups
+struct Options {
+    std::vector<uint32_t> block_sizes{64, 256, 1024};
+    size_t iterations = 10000;       // Timed calls per audio benchmark
+    size_t warmup = 200;             // Untimed calls before each benchmark
+    size_t load_iterations = 20;     // Timed create/initialize/free cycles
+    size_t state_iterations = 1000;  // Timed state saves/loads
+    size_t scan_iterations = 3;      // Timed full scans (only with --scan)
+    double sample_rate = 48000.0;
+    uint32_t midi_events = 16;       // Events per block in *.process_midi
+    bool scan = false;
+    std::string filter;              // Run only benchmarks containing this
+};
+
+// True if the benchmark should run under the current --filter
+bool selected(const Options& options, const std::string& bench);
+
+// Monotonic clock in nanoseconds
+uint64_t now_ns();
+
+// Global operator new calls so far, on all threads. Plugins that allocate
+// with malloc directly, or that live in a separate DLL on Windows, are not
+// counted.
+uint64_t allocation_count();
+
+// Per-call latency distribution
+struct Stats {
+    size_t samples = 0;
+    double mean_ns = 0.0;
+    uint64_t min_ns = 0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t p999_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+// Times repeated calls and counts their allocations
+class Sampler {
+public:
+    // ops_per_sample: calls made inside each measure() (timing batched
+    // calls keeps clock overhead out of very short operations)
+    explicit Sampler(size_t samples, size_t ops_per_sample = 1);
+
+    template <typename F>
+    void measure(F&& f) {
+        uint64_t allocations = allocation_count();
+        uint64_t start = now_ns();
+        f();
+        uint64_t end = now_ns();
+        allocations_ += allocation_count() - allocations;
+        samples_.push_back(end - start);
+    }
+
+    // Latency per call (each sample divided by ops_per_sample)
+    Stats stats();
+
+    size_t ops() const { return samples_.size() * ops_per_sample_; }
+    double allocations_per_op() const;
+
+private:
+    std::vector<uint64_t> samples_;
+    size_t ops_per_sample_;
+    uint64_t allocations_ = 0;
+};
+
+// One benchmark run
+struct Result {
+    std::string bench;          // e.g. "vst3.process"
+    std::string format;         // "vst3", "au" or "wine"
+    std::string plugin;         // Plugin name
+    uint32_t block_size = 0;    // 0 if not an audio benchmark
+    uint32_t channels = 0;
+    double sample_rate = 0.0;
+    uint64_t frames_per_op = 0; // Audio frames each call renders (realtime factor)
+    size_t iterations = 0;
+    Stats stats;
+    double allocations_per_op = 0.0;
+    std::string error;          // Non-empty if the benchmark could not run
+};
+
+// Fill the timing fields of a result from a sampler
+void finish(Result& result, Sampler& sampler);
+
+// Route JSON output to a file instead of stdout. Returns false on failure.
+bool open_output(const char* path);
+void close_output();
+
+// Write the meta line describing this machine and build
+void report_meta();
+
+// Write a result line (and a human-readable summary on stderr)
+void report(const Result& result);
+
+#ifdef RACK_BENCH_WINE
+// Benchmarks against a running rack-wine-host on 127.0.0.1:port
+// plugin_path: VST3 bundle path as seen by the Wine process
+// Returns 0 on success, 1 if the host could not be used
+int run_wine_benchmarks(const Options& options, int port, const char* plugin_path);
+#endif
+
+} // namespace rack_bench
+
+#endif // RACK_BENCH_H
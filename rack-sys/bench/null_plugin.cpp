@@ -0,0 +1,417 @@
+// Null VST3 plugin for rack_sys_bench
+//
+// Implemented directly on pluginterfaces (no public.sdk plugin framework)
+// so it builds from the same SDK subset as rack_sys. One class is both
+// component and controller; process() does no more than a plugin must, so
+// what the benchmark measures is host overhead.
+
+#include "null_plugin.h"
+#include "pluginterfaces/base/fplatform.h"
+#include "pluginterfaces/base/funknown.h"
+#include "pluginterfaces/base/ipluginbase.h"
+#include "pluginterfaces/base/ibstream.h"
+#include "pluginterfaces/vst/ivstaudioprocessor.h"
+#include "pluginterfaces/vst/ivstcomponent.h"
+#include "pluginterfaces/vst/ivsteditcontroller.h"
+#include "pluginterfaces/vst/ivstevents.h"
+#include "pluginterfaces/vst/ivstparameterchanges.h"
+#include "pluginterfaces/vst/ivstunits.h"
+#include "pluginterfaces/vst/vstspeaker.h"
+#include "pluginterfaces/vst/vsttypes.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+static const TUID kNullPluginUID = RACK_NULL_PLUGIN_TUID;
+
+// Copy an ASCII string into a UTF-16 VST3 string
+static void copy_ascii(TChar* dst, const char* src, size_t capacity) {
+    size_t i = 0;
+    for (; src[i] && i + 1 < capacity; ++i) {
+        dst[i] = static_cast<TChar>(src[i]);
+    }
+    dst[i] = 0;
+}
+
+// ============================================================================
+// NullPlugin - component, processor and controller in one object
+// ============================================================================
+
+class NullPlugin : public IComponent, public IAudioProcessor, public IEditController {
+public:
+    NullPlugin() = default;
+    virtual ~NullPlugin() = default;
+
+    // FUnknown
+    tresult PLUGIN_API queryInterface(const TUID _iid, void** obj) override {
+        QUERY_INTERFACE(_iid, obj, FUnknown::iid, IComponent)
+        QUERY_INTERFACE(_iid, obj, IPluginBase::iid, IComponent)
+        QUERY_INTERFACE(_iid, obj, IComponent::iid, IComponent)
+        QUERY_INTERFACE(_iid, obj, IAudioProcessor::iid, IAudioProcessor)
+        QUERY_INTERFACE(_iid, obj, IEditController::iid, IEditController)
+        *obj = nullptr;
+        return kNoInterface;
+    }
+
+    uint32 PLUGIN_API addRef() override { return ++ref_count_; }
+    uint32 PLUGIN_API release() override {
+        uint32 count = --ref_count_;
+        if (count == 0) {
+            delete this;
+        }
+        return count;
+    }
+
+    // IPluginBase (shared by the component and controller sides)
+    tresult PLUGIN_API initialize(FUnknown* context) override { return kResultOk; }
+    tresult PLUGIN_API terminate() override { return kResultOk; }
+
+    // IComponent
+    tresult PLUGIN_API getControllerClassId(TUID classId) override {
+        // Single component: the host casts this object to IEditController
+        return kResultFalse;
+    }
+
+    tresult PLUGIN_API setIoMode(IoMode mode) override { return kResultOk; }
+
+    int32 PLUGIN_API getBusCount(MediaType type, BusDirection dir) override {
+        if (type == kAudio) {
+            return 1;
+        }
+        // Event input so hosts deliver MIDI
+        return (type == kEvent && dir == kInput) ? 1 : 0;
+    }
+
+    tresult PLUGIN_API getBusInfo(MediaType type, BusDirection dir, int32 index, BusInfo& bus) override {
+        if (index != 0 || getBusCount(type, dir) == 0) {
+            return kInvalidArgument;
+        }
+        bus.mediaType = type;
+        bus.direction = dir;
+        bus.channelCount = (type == kAudio) ? channel_count() : 16;
+        copy_ascii(bus.name, type == kAudio ? (dir == kInput ? "Input" : "Output") : "MIDI In",
+                   sizeof(bus.name) / sizeof(bus.name[0]));
+        bus.busType = kMain;
+        bus.flags = BusInfo::kDefaultActive;
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API getRoutingInfo(RoutingInfo& inInfo, RoutingInfo& outInfo) override {
+        return kNotImplemented;
+    }
+
+    tresult PLUGIN_API activateBus(MediaType type, BusDirection dir, int32 index, TBool state) override {
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API setActive(TBool state) override { return kResultOk; }
+
+    // IComponent and IEditController share setState/getState, so both
+    // sides use the same state: the gain as a 32-bit float
+    tresult PLUGIN_API setState(IBStream* state) override {
+        float gain = 1.0f;
+        if (!read_gain(state, &gain)) {
+            return kResultFalse;
+        }
+        gain_.store(gain, std::memory_order_relaxed);
+        controller_gain_ = gain;
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API getState(IBStream* state) override {
+        if (!state) {
+            return kInvalidArgument;
+        }
+        float gain = gain_.load(std::memory_order_relaxed);
+        int32 written = 0;
+        state->write(&gain, sizeof(gain), &written);
+        return written == static_cast<int32>(sizeof(gain)) ? kResultOk : kResultFalse;
+    }
+
+    // IAudioProcessor
+    tresult PLUGIN_API setBusArrangements(SpeakerArrangement* inputs, int32 numIns,
+                                          SpeakerArrangement* outputs, int32 numOuts) override {
+        // Any layout, as long as input and output match
+        if (numIns != 1 || numOuts != 1 || inputs[0] != outputs[0] ||
+            SpeakerArr::getChannelCount(inputs[0]) == 0) {
+            return kResultFalse;
+        }
+        arrangement_ = inputs[0];
+        return kResultTrue;
+    }
+
+    tresult PLUGIN_API getBusArrangement(BusDirection dir, int32 index, SpeakerArrangement& arr) override {
+        if (index != 0) {
+            return kInvalidArgument;
+        }
+        arr = arrangement_;
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API canProcessSampleSize(int32 symbolicSampleSize) override {
+        return (symbolicSampleSize == kSample32 || symbolicSampleSize == kSample64) ? kResultTrue : kResultFalse;
+    }
+
+    uint32 PLUGIN_API getLatencySamples() override { return 0; }
+
+    tresult PLUGIN_API setupProcessing(ProcessSetup& setup) override { return kResultOk; }
+
+    tresult PLUGIN_API setProcessing(TBool state) override { return kResultOk; }
+
+    tresult PLUGIN_API process(ProcessData& data) override {
+        read_parameter_changes(data.inputParameterChanges);
+
+        // Read events like any instrument would, then drop them
+        if (data.inputEvents) {
+            int32 count = data.inputEvents->getEventCount();
+            Event event;
+            for (int32 i = 0; i < count; ++i) {
+                data.inputEvents->getEvent(i, event);
+            }
+        }
+
+        if (data.numInputs < 1 || data.numOutputs < 1 || data.numSamples <= 0) {
+            return kResultOk;
+        }
+
+        float gain = gain_.load(std::memory_order_relaxed);
+        if (data.symbolicSampleSize == kSample64) {
+            pass_through(data.inputs[0], data.outputs[0], data.inputs[0].channelBuffers64,
+                         data.outputs[0].channelBuffers64, data.numSamples, static_cast<double>(gain));
+        } else {
+            pass_through(data.inputs[0], data.outputs[0], data.inputs[0].channelBuffers32,
+                         data.outputs[0].channelBuffers32, data.numSamples, gain);
+        }
+        return kResultOk;
+    }
+
+    uint32 PLUGIN_API getTailSamples() override { return kNoTail; }
+
+    // IEditController
+    tresult PLUGIN_API setComponentState(IBStream* state) override {
+        float gain = 1.0f;
+        if (!read_gain(state, &gain)) {
+            return kResultFalse;
+        }
+        controller_gain_ = gain;
+        return kResultOk;
+    }
+
+    int32 PLUGIN_API getParameterCount() override { return 1; }
+
+    tresult PLUGIN_API getParameterInfo(int32 paramIndex, ParameterInfo& info) override {
+        if (paramIndex != 0) {
+            return kInvalidArgument;
+        }
+        info.id = RACK_NULL_PLUGIN_GAIN_ID;
+        copy_ascii(info.title, "Gain", sizeof(info.title) / sizeof(info.title[0]));
+        copy_ascii(info.shortTitle, "Gain", sizeof(info.shortTitle) / sizeof(info.shortTitle[0]));
+        copy_ascii(info.units, "", sizeof(info.units) / sizeof(info.units[0]));
+        info.stepCount = 0;
+        info.defaultNormalizedValue = 1.0;
+        info.unitId = kRootUnitId;
+        info.flags = ParameterInfo::kCanAutomate;
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API getParamStringByValue(ParamID id, ParamValue valueNormalized, String128 string) override {
+        if (id != RACK_NULL_PLUGIN_GAIN_ID) {
+            return kInvalidArgument;
+        }
+        char text[32];
+        snprintf(text, sizeof(text), "%.3f", valueNormalized);
+        copy_ascii(string, text, 128);
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API getParamValueByString(ParamID id, TChar* string, ParamValue& valueNormalized) override {
+        if (id != RACK_NULL_PLUGIN_GAIN_ID || !string) {
+            return kInvalidArgument;
+        }
+        char text[32];
+        size_t i = 0;
+        for (; string[i] && i + 1 < sizeof(text); ++i) {
+            text[i] = static_cast<char>(string[i]);
+        }
+        text[i] = 0;
+        valueNormalized = atof(text);
+        return kResultOk;
+    }
+
+    ParamValue PLUGIN_API normalizedParamToPlain(ParamID id, ParamValue valueNormalized) override {
+        return valueNormalized;
+    }
+
+    ParamValue PLUGIN_API plainParamToNormalized(ParamID id, ParamValue plainValue) override {
+        return plainValue;
+    }
+
+    ParamValue PLUGIN_API getParamNormalized(ParamID id) override {
+        return id == RACK_NULL_PLUGIN_GAIN_ID ? controller_gain_ : 0.0;
+    }
+
+    tresult PLUGIN_API setParamNormalized(ParamID id, ParamValue value) override {
+        if (id != RACK_NULL_PLUGIN_GAIN_ID) {
+            return kInvalidArgument;
+        }
+        controller_gain_ = value;
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API setComponentHandler(IComponentHandler* handler) override { return kResultOk; }
+
+    IPlugView* PLUGIN_API createView(FIDString name) override { return nullptr; }
+
+private:
+    int32 channel_count() const {
+        return SpeakerArr::getChannelCount(arrangement_);
+    }
+
+    static bool read_gain(IBStream* state, float* gain) {
+        if (!state) {
+            return false;
+        }
+        int32 read = 0;
+        state->read(gain, sizeof(*gain), &read);
+        return read == static_cast<int32>(sizeof(*gain));
+    }
+
+    // Last point of each Gain queue wins (no ramping)
+    void read_parameter_changes(IParameterChanges* changes) {
+        if (!changes) {
+            return;
+        }
+        int32 count = changes->getParameterCount();
+        for (int32 i = 0; i < count; ++i) {
+            IParamValueQueue* queue = changes->getParameterData(i);
+            if (!queue || queue->getParameterId() != RACK_NULL_PLUGIN_GAIN_ID) {
+                continue;
+            }
+            int32 points = queue->getPointCount();
+            int32 offset = 0;
+            ParamValue value = 0.0;
+            if (points > 0 && queue->getPoint(points - 1, offset, value) == kResultOk) {
+                gain_.store(static_cast<float>(value), std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template <typename Sample>
+    static void pass_through(AudioBusBuffers& in, AudioBusBuffers& out, Sample** inputs, Sample** outputs,
+                             int32 frames, Sample gain) {
+        int32 channels = in.numChannels < out.numChannels ? in.numChannels : out.numChannels;
+        for (int32 ch = 0; ch < channels; ++ch) {
+            if (gain == Sample(1)) {
+                if (outputs[ch] != inputs[ch]) {
+                    memcpy(outputs[ch], inputs[ch], frames * sizeof(Sample));
+                }
+            } else {
+                for (int32 i = 0; i < frames; ++i) {
+                    outputs[ch][i] = inputs[ch][i] * gain;
+                }
+            }
+        }
+        for (int32 ch = channels; ch < out.numChannels; ++ch) {
+            memset(outputs[ch], 0, frames * sizeof(Sample));
+        }
+        out.silenceFlags = in.silenceFlags;
+    }
+
+    std::atomic<uint32> ref_count_{1};
+    SpeakerArrangement arrangement_ = SpeakerArr::kStereo;
+    std::atomic<float> gain_{1.0f};     // Processor side
+    ParamValue controller_gain_ = 1.0;  // Controller side
+};
+
+// ============================================================================
+// Factory
+// ============================================================================
+
+class NullPluginFactory : public IPluginFactory2 {
+public:
+    tresult PLUGIN_API queryInterface(const TUID _iid, void** obj) override {
+        QUERY_INTERFACE(_iid, obj, FUnknown::iid, IPluginFactory2)
+        QUERY_INTERFACE(_iid, obj, IPluginFactory::iid, IPluginFactory2)
+        QUERY_INTERFACE(_iid, obj, IPluginFactory2::iid, IPluginFactory2)
+        *obj = nullptr;
+        return kNoInterface;
+    }
+
+    // Static lifetime
+    uint32 PLUGIN_API addRef() override { return 1; }
+    uint32 PLUGIN_API release() override { return 1; }
+
+    tresult PLUGIN_API getFactoryInfo(PFactoryInfo* info) override {
+        if (!info) {
+            return kInvalidArgument;
+        }
+        *info = PFactoryInfo(RACK_NULL_PLUGIN_VENDOR, "", "", PFactoryInfo::kNoFlags);
+        return kResultOk;
+    }
+
+    int32 PLUGIN_API countClasses() override { return 1; }
+
+    tresult PLUGIN_API getClassInfo(int32 index, PClassInfo* info) override {
+        if (index != 0 || !info) {
+            return kInvalidArgument;
+        }
+        *info = PClassInfo(kNullPluginUID, PClassInfo::kManyInstances, kVstAudioEffectClass,
+                           RACK_NULL_PLUGIN_NAME);
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API getClassInfo2(int32 index, PClassInfo2* info) override {
+        if (index != 0 || !info) {
+            return kInvalidArgument;
+        }
+        *info = PClassInfo2(kNullPluginUID, PClassInfo::kManyInstances, kVstAudioEffectClass,
+                            RACK_NULL_PLUGIN_NAME, 0, "Fx|Tools", RACK_NULL_PLUGIN_VENDOR, "1.0.0",
+                            kVstVersionString);
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API createInstance(FIDString cid, FIDString _iid, void** obj) override {
+        *obj = nullptr;
+        if (memcmp(cid, kNullPluginUID, sizeof(TUID)) != 0) {
+            return kNoInterface;
+        }
+        NullPlugin* plugin = new(std::nothrow) NullPlugin();
+        if (!plugin) {
+            return kOutOfMemory;
+        }
+        tresult result = plugin->queryInterface(_iid, obj);
+        plugin->release();
+        return result;
+    }
+};
+
+static NullPluginFactory g_factory;
+
+// ============================================================================
+// Module entry points
+// ============================================================================
+
+extern "C" {
+
+SMTG_EXPORT_SYMBOL IPluginFactory* PLUGIN_API GetPluginFactory() {
+    return &g_factory;
+}
+
+#if SMTG_OS_LINUX
+SMTG_EXPORT_SYMBOL bool ModuleEntry(void*) { return true; }
+SMTG_EXPORT_SYMBOL bool ModuleExit() { return true; }
+#elif SMTG_OS_MACOS
+SMTG_EXPORT_SYMBOL bool bundleEntry(void*) { return true; }
+SMTG_EXPORT_SYMBOL bool bundleExit() { return true; }
+#elif SMTG_OS_WINDOWS
+SMTG_EXPORT_SYMBOL bool InitDll() { return true; }
+SMTG_EXPORT_SYMBOL bool ExitDll() { return true; }
+#endif
+
+} // extern "C"
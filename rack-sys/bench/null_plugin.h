@@ -0,0 +1,23 @@
+#ifndef RACK_BENCH_NULL_PLUGIN_H
+#define RACK_BENCH_NULL_PLUGIN_H
+
+// Built-in passthrough VST3 used by rack_sys_bench to measure host overhead
+// without any DSP cost: audio is copied through (scaled by the Gain
+// parameter when it is not at unity), events are read and dropped.
+
+// Class ID, as the four 32-bit words of INLINE_UID
+#define RACK_NULL_PLUGIN_UID 0x5261636B, 0x4E756C6C, 0x42656E63, 0x68000001
+
+// The class ID as a TUID initializer. INLINE_UID(RACK_NULL_PLUGIN_UID) would
+// hand the macro a single argument; this expands the four words first.
+#define RACK_NULL_PLUGIN_TUID RACK_NULL_PLUGIN_APPLY_(INLINE_UID, RACK_NULL_PLUGIN_UID)
+#define RACK_NULL_PLUGIN_APPLY_(macro, ...) macro(__VA_ARGS__)
+
+// Bundle and class names
+#define RACK_NULL_PLUGIN_NAME "rack null"
+#define RACK_NULL_PLUGIN_VENDOR "rack"
+
+// The only parameter: linear gain, normalized 0..1, default 1 (unity)
+#define RACK_NULL_PLUGIN_GAIN_ID 0
+
+#endif // RACK_BENCH_NULL_PLUGIN_H
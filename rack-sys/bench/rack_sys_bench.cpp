@@ -0,0 +1,1041 @@
+// rack_sys_bench - per-call overhead of the rack-sys C API
+//
+// Runs the same set of benchmarks against the built-in null VST3 (host
+// overhead only), against plugins given on the command line, or against
+// every installed effect and instrument. See --help.
+
+#include "bench.h"
+#include "rack_convert.h"
+
+#ifdef RACK_BENCH_VST3
+#include "rack_vst3.h"
+#endif
+#ifdef RACK_BENCH_AU
+#include "rack_au.h"
+#endif
+#ifdef RACK_BENCH_NULL_PLUGIN
+#include "null_plugin.h"
+#include "pluginterfaces/base/funknown.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <string>
+#include <vector>
+
+#ifndef RACK_BENCH_BUILD_TYPE
+#define RACK_BENCH_BUILD_TYPE "unknown"
+#endif
+
+// ============================================================================
+// Allocation counting
+// ============================================================================
+
+static std::atomic<uint64_t> g_allocations{0};
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+
+namespace rack_bench {
+
+uint64_t allocation_count() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+uint64_t now_ns() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool selected(const Options& options, const std::string& bench) {
+    return options.filter.empty() || bench.find(options.filter) != std::string::npos;
+}
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+Sampler::Sampler(size_t samples, size_t ops_per_sample)
+    : ops_per_sample_(ops_per_sample ? ops_per_sample : 1) {
+    samples_.reserve(samples);
+}
+
+// Nearest-rank percentile of sorted samples
+static uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    size_t rank = (size_t)std::ceil(p * (double)sorted.size());
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+Stats Sampler::stats() {
+    Stats stats;
+    if (samples_.empty()) {
+        return stats;
+    }
+
+    std::vector<uint64_t>& sorted = samples_;
+    for (uint64_t& sample : sorted) {
+        sample /= ops_per_sample_;
+    }
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0.0;
+    for (uint64_t sample : sorted) {
+        total += (double)sample;
+    }
+    stats.samples = sorted.size();
+    stats.mean_ns = total / (double)sorted.size();
+    stats.min_ns = sorted.front();
+    stats.p50_ns = percentile(sorted, 0.50);
+    stats.p99_ns = percentile(sorted, 0.99);
+    stats.p999_ns = percentile(sorted, 0.999);
+    stats.max_ns = sorted.back();
+    return stats;
+}
+
+double Sampler::allocations_per_op() const {
+    return ops() ? (double)allocations_ / (double)ops() : 0.0;
+}
+
+void finish(Result& result, Sampler& sampler) {
+    result.iterations = sampler.ops();
+    result.allocations_per_op = sampler.allocations_per_op();
+    result.stats = sampler.stats();
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+
+static FILE* g_output = stdout;
+
+bool open_output(const char* path) {
+    FILE* file = fopen(path, "a");
+    if (!file) {
+        return false;
+    }
+    g_output = file;
+    return true;
+}
+
+void close_output() {
+    if (g_output != stdout) {
+        fclose(g_output);
+        g_output = stdout;
+    }
+}
+
+// JSON string literal (plugin names may contain anything)
+static std::string json_string(const std::string& value) {
+    std::string out = "\"";
+    for (unsigned char c : value) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += (char)c;
+        } else if (c < 0x20) {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += (char)c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+static const char* os_name() {
+#if defined(__APPLE__)
+    return "macos";
+#elif defined(_WIN32)
+    return "windows";
+#elif defined(__linux__)
+    return "linux";
+#else
+    return "unknown";
+#endif
+}
+
+void report_meta() {
+    char compiler[64];
+#if defined(__clang__)
+    snprintf(compiler, sizeof(compiler), "clang %d.%d.%d", __clang_major__, __clang_minor__, __clang_patchlevel__);
+#elif defined(__GNUC__)
+    snprintf(compiler, sizeof(compiler), "gcc %d.%d.%d", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
+#elif defined(_MSC_VER)
+    snprintf(compiler, sizeof(compiler), "msvc %d", _MSC_VER);
+#else
+    snprintf(compiler, sizeof(compiler), "unknown");
+#endif
+
+    fprintf(g_output,
+            "{\"schema\":\"rack_sys_bench/1\",\"type\":\"meta\",\"timestamp\":%lld,"
+            "\"os\":%s,\"isa\":%s,\"compiler\":%s,\"build_type\":%s}\n",
+            (long long)time(nullptr), json_string(os_name()).c_str(),
+            json_string(rack_convert_isa()).c_str(), json_string(compiler).c_str(),
+            json_string(RACK_BENCH_BUILD_TYPE).c_str());
+    fflush(g_output);
+}
+
+void report(const Result& result) {
+    std::string common = "{\"schema\":\"rack_sys_bench/1\",\"type\":\"result\",\"bench\":" +
+        json_string(result.bench) + ",\"format\":" + json_string(result.format) +
+        ",\"plugin\":" + json_string(result.plugin);
+
+    if (!result.error.empty()) {
+        fprintf(g_output, "%s,\"error\":%s}\n", common.c_str(), json_string(result.error).c_str());
+        fflush(g_output);
+        fprintf(stderr, "%-26s %-24s FAILED: %s\n", result.bench.c_str(), result.plugin.c_str(),
+                result.error.c_str());
+        return;
+    }
+
+    const Stats& s = result.stats;
+    double ops_per_sec = s.mean_ns > 0.0 ? 1e9 / s.mean_ns : 0.0;
+    fprintf(g_output,
+            "%s,\"block_size\":%u,\"channels\":%u,\"sample_rate\":%.0f,\"iterations\":%zu,"
+            "\"mean_ns\":%.1f,\"min_ns\":%llu,\"p50_ns\":%llu,\"p99_ns\":%llu,\"p999_ns\":%llu,"
+            "\"max_ns\":%llu,\"ops_per_sec\":%.1f",
+            common.c_str(), result.block_size, result.channels, result.sample_rate, result.iterations,
+            s.mean_ns, (unsigned long long)s.min_ns, (unsigned long long)s.p50_ns,
+            (unsigned long long)s.p99_ns, (unsigned long long)s.p999_ns, (unsigned long long)s.max_ns,
+            ops_per_sec);
+    if (result.frames_per_op > 0 && result.sample_rate > 0.0 && s.mean_ns > 0.0) {
+        // Seconds of audio rendered per second of wall time
+        double realtime_factor = ((double)result.frames_per_op / result.sample_rate) / (s.mean_ns * 1e-9);
+        fprintf(g_output, ",\"frames_per_sec\":%.1f,\"realtime_factor\":%.2f",
+                ops_per_sec * (double)result.frames_per_op, realtime_factor);
+    }
+    fprintf(g_output, ",\"allocs_per_op\":%.3f}\n", result.allocations_per_op);
+    fflush(g_output);
+
+    char block[16] = "";
+    if (result.block_size) {
+        snprintf(block, sizeof(block), "bs=%u", result.block_size);
+    }
+    fprintf(stderr, "%-26s %-24.24s %-8s p50 %9.2f us  p99 %9.2f us  p99.9 %9.2f us  allocs/op %.2f\n",
+            result.bench.c_str(), result.plugin.c_str(), block, s.p50_ns / 1e3, s.p99_ns / 1e3,
+            s.p999_ns / 1e3, result.allocations_per_op);
+}
+
+} // namespace rack_bench
+
+using namespace rack_bench;
+
+// ============================================================================
+// Plugin formats
+// ============================================================================
+
+// A plugin to benchmark
+struct Target {
+    std::string name;
+    std::string path;  // VST3 bundle
+    std::string uid;   // VST3 class UID or AudioUnit unique_id
+};
+
+// Each format maps the rack-sys C API onto the same names so the
+// benchmarks below are written once.
+#ifdef RACK_BENCH_VST3
+struct Vst3Api {
+    using Plugin = RackVST3Plugin;
+    using MidiEvent = RackVST3MidiEvent;
+    static constexpr const char* format = "vst3";
+    static constexpr int OK = RACK_VST3_OK;
+
+    static Plugin* create(const Target& target) {
+        return rack_vst3_plugin_new(target.path.c_str(), target.uid.c_str());
+    }
+    static void destroy(Plugin* plugin) { rack_vst3_plugin_free(plugin); }
+    static int initialize(Plugin* plugin, double sample_rate, uint32_t max_block_size) {
+        return rack_vst3_plugin_initialize(plugin, sample_rate, max_block_size);
+    }
+    static int input_channels(Plugin* plugin) { return rack_vst3_plugin_get_input_channels(plugin); }
+    static int output_channels(Plugin* plugin) { return rack_vst3_plugin_get_output_channels(plugin); }
+    static int process(Plugin* plugin, const float* const* in, uint32_t num_in, float* const* out,
+                       uint32_t num_out, uint32_t frames) {
+        return rack_vst3_plugin_process(plugin, in, num_in, out, num_out, frames);
+    }
+    static int process_split(Plugin* plugin, const float* const* in, uint32_t num_in, float* const* out,
+                             uint32_t num_out, uint32_t frames) {
+        return rack_vst3_plugin_process_split(plugin, in, num_in, out, num_out, frames);
+    }
+    static int send_midi(Plugin* plugin, const MidiEvent* events, uint32_t count) {
+        return rack_vst3_plugin_send_midi(plugin, events, count);
+    }
+    static int parameter_count(Plugin* plugin) { return rack_vst3_plugin_parameter_count(plugin); }
+    static int get_parameter(Plugin* plugin, uint32_t index, float* value) {
+        return rack_vst3_plugin_get_parameter(plugin, index, value);
+    }
+    static int set_parameter(Plugin* plugin, uint32_t index, float value) {
+        return rack_vst3_plugin_set_parameter(plugin, index, value);
+    }
+    static int get_state_size(Plugin* plugin) { return rack_vst3_plugin_get_state_size(plugin); }
+    static int get_state(Plugin* plugin, uint8_t* data, size_t* size) {
+        return rack_vst3_plugin_get_state(plugin, data, size);
+    }
+    static int set_state(Plugin* plugin, const uint8_t* data, size_t size) {
+        return rack_vst3_plugin_set_state(plugin, data, size);
+    }
+};
+#endif
+
+#ifdef RACK_BENCH_AU
+struct AuApi {
+    using Plugin = RackAUPlugin;
+    using MidiEvent = RackAUMidiEvent;
+    static constexpr const char* format = "au";
+    static constexpr int OK = RACK_AU_OK;
+
+    static Plugin* create(const Target& target) { return rack_au_plugin_new(target.uid.c_str()); }
+    static void destroy(Plugin* plugin) { rack_au_plugin_free(plugin); }
+    static int initialize(Plugin* plugin, double sample_rate, uint32_t max_block_size) {
+        return rack_au_plugin_initialize(plugin, sample_rate, max_block_size);
+    }
+    static int input_channels(Plugin* plugin) { return rack_au_plugin_get_input_channels(plugin); }
+    static int output_channels(Plugin* plugin) { return rack_au_plugin_get_output_channels(plugin); }
+    static int process(Plugin* plugin, const float* const* in, uint32_t num_in, float* const* out,
+                       uint32_t num_out, uint32_t frames) {
+        return rack_au_plugin_process(plugin, in, num_in, out, num_out, frames);
+    }
+    static int process_split(Plugin* plugin, const float* const* in, uint32_t num_in, float* const* out,
+                             uint32_t num_out, uint32_t frames) {
+        return rack_au_plugin_process_split(plugin, in, num_in, out, num_out, frames);
+    }
+    static int send_midi(Plugin* plugin, const MidiEvent* events, uint32_t count) {
+        return rack_au_plugin_send_midi(plugin, events, count);
+    }
+    static int parameter_count(Plugin* plugin) { return rack_au_plugin_parameter_count(plugin); }
+    static int get_parameter(Plugin* plugin, uint32_t index, float* value) {
+        return rack_au_plugin_get_parameter(plugin, index, value);
+    }
+    static int set_parameter(Plugin* plugin, uint32_t index, float value) {
+        return rack_au_plugin_set_parameter(plugin, index, value);
+    }
+    static int get_state_size(Plugin* plugin) { return rack_au_plugin_get_state_size(plugin); }
+    static int get_state(Plugin* plugin, uint8_t* data, size_t* size) {
+        return rack_au_plugin_get_state(plugin, data, size);
+    }
+    static int set_state(Plugin* plugin, const uint8_t* data, size_t size) {
+        return rack_au_plugin_set_state(plugin, data, size);
+    }
+};
+#endif
+
+// ============================================================================
+// Benchmarks
+// ============================================================================
+
+// Planar audio buffers for one instance
+struct AudioBuffers {
+    std::vector<std::vector<float>> inputs;
+    std::vector<std::vector<float>> outputs;
+    std::vector<const float*> input_ptrs;
+    std::vector<float*> output_ptrs;
+
+    AudioBuffers(uint32_t num_inputs, uint32_t num_outputs, uint32_t frames) {
+        // Noise at about -12 dBFS, so plugins that skip silence still work
+        uint32_t seed = 0x9E3779B9u;
+        inputs.assign(num_inputs, std::vector<float>(frames));
+        for (auto& channel : inputs) {
+            for (float& sample : channel) {
+                seed ^= seed << 13;
+                seed ^= seed >> 17;
+                seed ^= seed << 5;
+                sample = ((float)(seed >> 8) / 16777216.0f - 0.5f) * 0.5f;
+            }
+            input_ptrs.push_back(channel.data());
+        }
+        outputs.assign(num_outputs, std::vector<float>(frames));
+        for (auto& channel : outputs) {
+            output_ptrs.push_back(channel.data());
+        }
+    }
+
+    uint32_t num_inputs() const { return (uint32_t)input_ptrs.size(); }
+    uint32_t num_outputs() const { return (uint32_t)output_ptrs.size(); }
+};
+
+static std::string error_text(const char* what, int code) {
+    char text[96];
+    snprintf(text, sizeof(text), "%s failed (%d)", what, code);
+    return text;
+}
+
+template <typename Api>
+static Result make_result(const char* bench, const Target& target) {
+    Result result;
+    result.bench = std::string(Api::format) + "." + bench;
+    result.format = Api::format;
+    result.plugin = target.name;
+    return result;
+}
+
+// Audio benchmarks at one block size, on a fresh instance
+template <typename Api>
+static void run_block_benchmarks(const Options& options, const Target& target, uint32_t block_size) {
+    typename Api::Plugin* plugin = Api::create(target);
+    if (!plugin) {
+        Result result = make_result<Api>("process", target);
+        result.error = "create failed";
+        report(result);
+        return;
+    }
+
+    // process_split renders four blocks per call
+    const uint32_t split_frames = block_size * 4;
+    int rc = Api::initialize(plugin, options.sample_rate, block_size);
+    if (rc != Api::OK) {
+        Result result = make_result<Api>("process", target);
+        result.error = error_text("initialize", rc);
+        report(result);
+        Api::destroy(plugin);
+        return;
+    }
+
+    AudioBuffers audio((uint32_t)std::max(Api::input_channels(plugin), 0),
+                       (uint32_t)std::max(Api::output_channels(plugin), 0), split_frames);
+    auto process = [&](uint32_t frames) {
+        return Api::process(plugin, audio.input_ptrs.data(), audio.num_inputs(), audio.output_ptrs.data(),
+                            audio.num_outputs(), frames);
+    };
+
+    auto audio_result = [&](const char* bench, uint32_t frames_per_op) {
+        Result result = make_result<Api>(bench, target);
+        result.block_size = block_size;
+        result.channels = std::max(audio.num_inputs(), audio.num_outputs());
+        result.sample_rate = options.sample_rate;
+        result.frames_per_op = frames_per_op;
+        return result;
+    };
+
+    // Plain processing
+    if (selected(options, std::string(Api::format) + ".process")) {
+        Result result = audio_result("process", block_size);
+        for (size_t i = 0; i < options.warmup; i++) {
+            process(block_size);
+        }
+        Sampler sampler(options.iterations);
+        rc = Api::OK;
+        for (size_t i = 0; i < options.iterations && rc == Api::OK; i++) {
+            sampler.measure([&] { rc = process(block_size); });
+        }
+        if (rc != Api::OK) {
+            result.error = error_text("process", rc);
+        }
+        finish(result, sampler);
+        report(result);
+    }
+
+    // Long buffers split into sub-blocks
+    if (selected(options, std::string(Api::format) + ".process_split")) {
+        Result result = audio_result("process_split", split_frames);
+        Sampler sampler(options.iterations / 4 + 1);
+        rc = Api::OK;
+        for (size_t i = 0; i < options.iterations / 4 + 1 && rc == Api::OK; i++) {
+            sampler.measure([&] {
+                rc = Api::process_split(plugin, audio.input_ptrs.data(), audio.num_inputs(),
+                                        audio.output_ptrs.data(), audio.num_outputs(), split_frames);
+            });
+        }
+        if (rc != Api::OK) {
+            result.error = error_text("process_split", rc);
+        }
+        finish(result, sampler);
+        report(result);
+    }
+
+    // MIDI queueing and conversion: send_midi() plus the process() that
+    // drains it, alternating note on/off spread over the block
+    if (options.midi_events > 0 && selected(options, std::string(Api::format) + ".process_midi")) {
+        Result result = audio_result("process_midi", block_size);
+        std::vector<typename Api::MidiEvent> events(options.midi_events);
+        for (uint32_t i = 0; i < options.midi_events; i++) {
+            events[i].sample_offset = (uint32_t)((uint64_t)i * block_size / options.midi_events);
+            events[i].status = (i & 1) ? 0x80 : 0x90;
+            events[i].data1 = (uint8_t)(60 + (i / 2) % 12);
+            events[i].data2 = (i & 1) ? 0 : 100;
+            events[i].channel = 0;
+        }
+
+        Sampler sampler(options.iterations);
+        rc = Api::OK;
+        for (size_t i = 0; i < options.iterations && rc == Api::OK; i++) {
+            sampler.measure([&] {
+                rc = Api::send_midi(plugin, events.data(), (uint32_t)events.size());
+                if (rc == Api::OK) {
+                    rc = process(block_size);
+                }
+            });
+        }
+        if (rc != Api::OK) {
+            result.error = error_text("send_midi/process", rc);
+        }
+        finish(result, sampler);
+        report(result);
+    }
+
+    // Parameter queueing, alone (batches of 16 calls, drained by an untimed
+    // block) and as per-block automation
+    int param_count = Api::parameter_count(plugin);
+    float original_value = 0.0f;
+    if (param_count > 0 && Api::get_parameter(plugin, 0, &original_value) == Api::OK) {
+        if (selected(options, std::string(Api::format) + ".set_parameter")) {
+            const size_t batch = 16;
+            Result result = audio_result("set_parameter", 0);
+            Sampler sampler(options.iterations / batch + 1, batch);
+            rc = Api::OK;
+            for (size_t i = 0; i < options.iterations / batch + 1 && rc == Api::OK; i++) {
+                sampler.measure([&] {
+                    for (size_t j = 0; j < batch && rc == Api::OK; j++) {
+                        rc = Api::set_parameter(plugin, 0, (j & 1) ? 0.25f : 0.75f);
+                    }
+                });
+                process(block_size);
+            }
+            if (rc != Api::OK) {
+                result.error = error_text("set_parameter", rc);
+            }
+            finish(result, sampler);
+            report(result);
+        }
+
+        if (selected(options, std::string(Api::format) + ".process_automation")) {
+            Result result = audio_result("process_automation", block_size);
+            Sampler sampler(options.iterations);
+            rc = Api::OK;
+            for (size_t i = 0; i < options.iterations && rc == Api::OK; i++) {
+                sampler.measure([&] {
+                    rc = Api::set_parameter(plugin, 0, (i & 1) ? 0.25f : 0.75f);
+                    if (rc == Api::OK) {
+                        rc = process(block_size);
+                    }
+                });
+            }
+            if (rc != Api::OK) {
+                result.error = error_text("set_parameter/process", rc);
+            }
+            finish(result, sampler);
+            report(result);
+        }
+
+        Api::set_parameter(plugin, 0, original_value);
+        process(block_size);
+    }
+
+    Api::destroy(plugin);
+}
+
+// Instance lifecycle and state benchmarks
+template <typename Api>
+static void run_instance_benchmarks(const Options& options, const Target& target) {
+    if (selected(options, std::string(Api::format) + ".load")) {
+        Result result = make_result<Api>("load", target);
+        Sampler sampler(options.load_iterations);
+        for (size_t i = 0; i < options.load_iterations && result.error.empty(); i++) {
+            sampler.measure([&] {
+                typename Api::Plugin* plugin = Api::create(target);
+                if (!plugin) {
+                    result.error = "create failed";
+                    return;
+                }
+                int rc = Api::initialize(plugin, options.sample_rate, options.block_sizes.back());
+                if (rc != Api::OK) {
+                    result.error = error_text("initialize", rc);
+                }
+                Api::destroy(plugin);
+            });
+        }
+        finish(result, sampler);
+        report(result);
+    }
+
+    bool want_get = selected(options, std::string(Api::format) + ".get_state");
+    bool want_set = selected(options, std::string(Api::format) + ".set_state");
+    if (!want_get && !want_set) {
+        return;
+    }
+
+    typename Api::Plugin* plugin = Api::create(target);
+    int rc = plugin ? Api::initialize(plugin, options.sample_rate, options.block_sizes.back()) : Api::OK;
+    int state_size = (plugin && rc == Api::OK) ? Api::get_state_size(plugin) : 0;
+    if (!plugin || rc != Api::OK || state_size <= 0) {
+        Result result = make_result<Api>("get_state", target);
+        result.error = !plugin ? "create failed"
+            : rc != Api::OK ? error_text("initialize", rc)
+            : error_text("get_state_size", state_size);
+        report(result);
+        if (plugin) {
+            Api::destroy(plugin);
+        }
+        return;
+    }
+
+    // Headroom in case the state grows between the size query and the save
+    std::vector<uint8_t> state((size_t)state_size * 2);
+    size_t saved_size = 0;
+
+    // A save is a size query plus the copy, as hosts do it. It also runs
+    // when only set_state is selected, to produce the state to load.
+    {
+        Result result = make_result<Api>("get_state", target);
+        Sampler sampler(options.state_iterations);
+        rc = Api::OK;
+        for (size_t i = 0; i < options.state_iterations && rc == Api::OK; i++) {
+            sampler.measure([&] {
+                int size = Api::get_state_size(plugin);
+                saved_size = state.size();
+                rc = size < 0 ? size : Api::get_state(plugin, state.data(), &saved_size);
+            });
+        }
+        if (rc != Api::OK) {
+            result.error = error_text("get_state", rc);
+        }
+        finish(result, sampler);
+        if (want_get) {
+            report(result);
+        }
+    }
+
+    if (want_set && rc == Api::OK) {
+        Result result = make_result<Api>("set_state", target);
+        Sampler sampler(options.state_iterations);
+        for (size_t i = 0; i < options.state_iterations && rc == Api::OK; i++) {
+            sampler.measure([&] { rc = Api::set_state(plugin, state.data(), saved_size); });
+        }
+        if (rc != Api::OK) {
+            result.error = error_text("set_state", rc);
+        }
+        finish(result, sampler);
+        report(result);
+    }
+
+    Api::destroy(plugin);
+}
+
+template <typename Api>
+static void run_target(const Options& options, const Target& target) {
+    run_instance_benchmarks<Api>(options, target);
+    for (uint32_t block_size : options.block_sizes) {
+        run_block_benchmarks<Api>(options, target, block_size);
+    }
+}
+
+// ============================================================================
+// Scanning and target selection
+// ============================================================================
+
+#ifdef RACK_BENCH_VST3
+static bool is_wanted_type(RackVST3PluginType type) {
+    return type == RACK_VST3_TYPE_EFFECT || type == RACK_VST3_TYPE_INSTRUMENT;
+}
+
+// Scan like a host would: extra_path plus the default locations
+static std::vector<RackVST3PluginInfo> scan_vst3(const char* extra_path) {
+    std::vector<RackVST3PluginInfo> plugins;
+    RackVST3Scanner* scanner = rack_vst3_scanner_new();
+    if (!scanner) {
+        return plugins;
+    }
+    if (extra_path) {
+        rack_vst3_scanner_add_path(scanner, extra_path);
+    }
+    rack_vst3_scanner_add_default_paths(scanner);
+
+    int count = rack_vst3_scanner_scan(scanner, nullptr, 0);
+    if (count > 0) {
+        plugins.resize((size_t)count);
+        int filled = rack_vst3_scanner_scan(scanner, plugins.data(), plugins.size());
+        plugins.resize(filled > 0 ? std::min((size_t)filled, plugins.size()) : 0);
+    }
+    rack_vst3_scanner_free(scanner);
+    return plugins;
+}
+
+static void bench_vst3_scan(const Options& options) {
+    if (!options.scan || !selected(options, "vst3.scan")) {
+        return;
+    }
+    Result result;
+    result.bench = "vst3.scan";
+    result.format = "vst3";
+    result.plugin = "(default paths)";
+    Sampler sampler(options.scan_iterations);
+    int found = 0;
+    for (size_t i = 0; i < options.scan_iterations; i++) {
+        // A fresh scanner each time, so nothing comes from its cache
+        sampler.measure([&] {
+            RackVST3Scanner* scanner = rack_vst3_scanner_new();
+            if (scanner) {
+                rack_vst3_scanner_add_default_paths(scanner);
+                found = rack_vst3_scanner_scan(scanner, nullptr, 0);
+                rack_vst3_scanner_free(scanner);
+            }
+        });
+    }
+    if (found < 0) {
+        result.error = error_text("scan", found);
+    }
+    finish(result, sampler);
+    report(result);
+    fprintf(stderr, "%-26s %d plugin(s) found\n", "", found);
+}
+
+// Directory part of a path
+static std::string parent_dir(const std::string& path) {
+    size_t end = path.find_last_not_of("/\\");
+    if (end == std::string::npos) {
+        return path;
+    }
+    size_t slash = path.find_last_of("/\\", end);
+    return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+}
+
+// Resolve "PATH" or "PATH@UID". Without a UID the bundle's directory is
+// scanned and its first effect or instrument class is used.
+static bool resolve_vst3_target(const std::string& spec, Target* target) {
+    size_t at = spec.rfind('@');
+    target->path = (at == std::string::npos) ? spec : spec.substr(0, at);
+    while (target->path.size() > 1 && (target->path.back() == '/' || target->path.back() == '\\')) {
+        target->path.pop_back();
+    }
+    target->name = target->path;
+    if (at != std::string::npos) {
+        target->uid = spec.substr(at + 1);
+        return !target->uid.empty();
+    }
+
+    for (const RackVST3PluginInfo& info : scan_vst3(parent_dir(target->path).c_str())) {
+        if (target->path == info.path && is_wanted_type(info.plugin_type)) {
+            target->uid = info.unique_id;
+            target->name = info.name;
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
+#ifdef RACK_BENCH_AU
+static bool is_wanted_type(RackAUPluginType type) {
+    return type == RACK_AU_TYPE_EFFECT || type == RACK_AU_TYPE_INSTRUMENT;
+}
+
+static std::vector<RackAUPluginInfo> scan_au() {
+    std::vector<RackAUPluginInfo> plugins;
+    RackAUScanner* scanner = rack_au_scanner_new();
+    if (!scanner) {
+        return plugins;
+    }
+    int count = rack_au_scanner_scan(scanner, nullptr, 0);
+    if (count > 0) {
+        plugins.resize((size_t)count);
+        int filled = rack_au_scanner_scan(scanner, plugins.data(), plugins.size());
+        plugins.resize(filled > 0 ? std::min((size_t)filled, plugins.size()) : 0);
+    }
+    rack_au_scanner_free(scanner);
+    return plugins;
+}
+
+static void bench_au_scan(const Options& options) {
+    if (!options.scan || !selected(options, "au.scan")) {
+        return;
+    }
+    Result result;
+    result.bench = "au.scan";
+    result.format = "au";
+    result.plugin = "(system)";
+    Sampler sampler(options.scan_iterations);
+    int found = 0;
+    for (size_t i = 0; i < options.scan_iterations; i++) {
+        sampler.measure([&] {
+            RackAUScanner* scanner = rack_au_scanner_new();
+            if (scanner) {
+                found = rack_au_scanner_scan(scanner, nullptr, 0);
+                rack_au_scanner_free(scanner);
+            }
+        });
+    }
+    if (found < 0) {
+        result.error = error_text("scan", found);
+    }
+    finish(result, sampler);
+    report(result);
+    fprintf(stderr, "%-26s %d plugin(s) found\n", "", found);
+}
+
+static std::string au_name(const std::string& unique_id, const std::vector<RackAUPluginInfo>& plugins) {
+    for (const RackAUPluginInfo& info : plugins) {
+        if (unique_id == info.unique_id) {
+            return info.name;
+        }
+    }
+    return unique_id;
+}
+#endif
+
+#ifdef RACK_BENCH_NULL_PLUGIN
+static Target null_plugin_target() {
+    static const Steinberg::TUID uid = RACK_NULL_PLUGIN_TUID;
+    char hex[33];
+    for (size_t i = 0; i < sizeof(uid); i++) {
+        snprintf(hex + i * 2, 3, "%02X", (unsigned char)uid[i]);
+    }
+
+    Target target;
+    target.name = RACK_NULL_PLUGIN_NAME;
+    target.path = RACK_BENCH_NULL_PLUGIN;
+    target.uid = hex;
+    return target;
+}
+#endif
+
+// ============================================================================
+// Command line
+// ============================================================================
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "\n"
+            "Benchmarks the rack-sys C API. Results go to stdout (or --output) as JSON\n"
+            "lines; a summary goes to stderr. Without plugin options only the built-in\n"
+            "null VST3 runs, which measures host overhead alone.\n"
+            "\n"
+            "Plugins:\n"
+            "  --vst3 PATH[@UID]     VST3 bundle (first effect/instrument without UID)\n"
+            "  --au UNIQUE_ID        AudioUnit (macOS)\n"
+            "  --installed           every installed effect and instrument\n"
+            "  --limit N             with --installed, at most N plugins per format\n"
+            "  --no-null             skip the built-in null plugin\n"
+            "  --wine-port PORT      also benchmark a running rack-wine-host (Linux)\n"
+            "  --wine-plugin PATH    plugin for the Wine host to load (Wine path)\n"
+            "\n"
+            "Benchmarks:\n"
+            "  --block-sizes LIST    comma-separated block sizes (default 64,256,1024)\n"
+            "  --iterations N        timed calls per audio benchmark (default 10000)\n"
+            "  --sample-rate HZ      sample rate (default 48000)\n"
+            "  --midi-events N       events per block in process_midi (default 16)\n"
+            "  --scan                also time full plugin scans\n"
+            "  --filter TEXT         only benchmarks whose name contains TEXT\n"
+            "  --output FILE         append JSON lines to FILE\n",
+            program);
+}
+
+static bool parse_block_sizes(const char* text, std::vector<uint32_t>* sizes) {
+    sizes->clear();
+    const char* p = text;
+    while (*p) {
+        char* end = nullptr;
+        unsigned long value = strtoul(p, &end, 10);
+        if (end == p || value == 0 || value > 1u << 20) {
+            return false;
+        }
+        sizes->push_back((uint32_t)value);
+        p = (*end == ',') ? end + 1 : end;
+        if (*end && *end != ',') {
+            return false;
+        }
+    }
+    if (sizes->empty()) {
+        return false;
+    }
+    std::sort(sizes->begin(), sizes->end());
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    std::vector<std::string> vst3_specs;
+    std::vector<std::string> au_ids;
+    bool installed = false;
+    bool null_plugin = true;
+    size_t limit = 0;
+    int wine_port = 0;
+    const char* wine_plugin = nullptr;
+    const char* output = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : nullptr;
+        bool takes_value = true;
+
+        if (arg == "--help" || arg == "-h") {
+            usage(argv[0]);
+            return 0;
+        } else if (arg == "--installed") {
+            installed = true;
+            takes_value = false;
+        } else if (arg == "--no-null") {
+            null_plugin = false;
+            takes_value = false;
+        } else if (arg == "--scan") {
+            options.scan = true;
+            takes_value = false;
+        } else if (!value) {
+            fprintf(stderr, "Missing value for %s\n", arg.c_str());
+            return 2;
+        } else if (arg == "--vst3") {
+            vst3_specs.push_back(value);
+        } else if (arg == "--au") {
+            au_ids.push_back(value);
+        } else if (arg == "--limit") {
+            limit = strtoul(value, nullptr, 10);
+        } else if (arg == "--wine-port") {
+            wine_port = atoi(value);
+        } else if (arg == "--wine-plugin") {
+            wine_plugin = value;
+        } else if (arg == "--block-sizes") {
+            if (!parse_block_sizes(value, &options.block_sizes)) {
+                fprintf(stderr, "Invalid block sizes: %s\n", value);
+                return 2;
+            }
+        } else if (arg == "--iterations") {
+            options.iterations = std::max<size_t>(strtoul(value, nullptr, 10), 1);
+        } else if (arg == "--sample-rate") {
+            options.sample_rate = atof(value);
+        } else if (arg == "--midi-events") {
+            options.midi_events = (uint32_t)strtoul(value, nullptr, 10);
+        } else if (arg == "--filter") {
+            options.filter = value;
+        } else if (arg == "--output") {
+            output = value;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", arg.c_str());
+            usage(argv[0]);
+            return 2;
+        }
+        if (takes_value) {
+            i++;
+        }
+    }
+
+    if (options.sample_rate <= 0.0) {
+        fprintf(stderr, "Invalid sample rate\n");
+        return 2;
+    }
+    if (output && !open_output(output)) {
+        fprintf(stderr, "Cannot open %s\n", output);
+        return 2;
+    }
+
+    report_meta();
+    int status = 0;
+    (void)null_plugin;
+    (void)installed;
+    (void)limit;
+    (void)wine_plugin;
+
+#ifdef RACK_BENCH_VST3
+    std::vector<Target> vst3_targets;
+#ifdef RACK_BENCH_NULL_PLUGIN
+    if (null_plugin) {
+        vst3_targets.push_back(null_plugin_target());
+    }
+#endif
+    for (const std::string& spec : vst3_specs) {
+        Target target;
+        if (resolve_vst3_target(spec, &target)) {
+            vst3_targets.push_back(target);
+        } else {
+            fprintf(stderr, "No effect or instrument found in %s\n", spec.c_str());
+            status = 1;
+        }
+    }
+    if (installed) {
+        size_t added = 0;
+        for (const RackVST3PluginInfo& info : scan_vst3(nullptr)) {
+            if (!is_wanted_type(info.plugin_type) || (limit && added >= limit)) {
+                continue;
+            }
+            vst3_targets.push_back(Target{info.name, info.path, info.unique_id});
+            added++;
+        }
+    }
+
+    bench_vst3_scan(options);
+    for (const Target& target : vst3_targets) {
+        run_target<Vst3Api>(options, target);
+    }
+#else
+    if (!vst3_specs.empty()) {
+        fprintf(stderr, "VST3 support not built (no SDK)\n");
+        status = 1;
+    }
+#endif
+
+#ifdef RACK_BENCH_AU
+    std::vector<RackAUPluginInfo> au_plugins = scan_au();
+    std::vector<Target> au_targets;
+    for (const std::string& unique_id : au_ids) {
+        au_targets.push_back(Target{au_name(unique_id, au_plugins), std::string(), unique_id});
+    }
+    if (installed) {
+        size_t added = 0;
+        for (const RackAUPluginInfo& info : au_plugins) {
+            if (!is_wanted_type(info.plugin_type) || (limit && added >= limit)) {
+                continue;
+            }
+            au_targets.push_back(Target{info.name, std::string(), info.unique_id});
+            added++;
+        }
+    }
+
+    bench_au_scan(options);
+    for (const Target& target : au_targets) {
+        run_target<AuApi>(options, target);
+    }
+#else
+    if (!au_ids.empty()) {
+        fprintf(stderr, "AudioUnit support is only available on Apple platforms\n");
+        status = 1;
+    }
+#endif
+
+    if (wine_port > 0) {
+#ifdef RACK_BENCH_WINE
+        if (!wine_plugin) {
+            fprintf(stderr, "--wine-port needs --wine-plugin\n");
+            status = 1;
+        } else if (run_wine_benchmarks(options, wine_port, wine_plugin) != 0) {
+            status = 1;
+        }
+#else
+        fprintf(stderr, "Wine bridge benchmarks are only available on Linux\n");
+        status = 1;
+#endif
+    }
+
+    close_output();
+    return status;
+}
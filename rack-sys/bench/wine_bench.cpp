@@ -0,0 +1,355 @@
+// Wine bridge benchmarks: round trips to a running rack-wine-host
+//
+// Speaks the protocol in rack-wine-host/include/protocol.h directly (the
+// way the Rust client does), so the numbers are the bridge's own cost:
+// socket round trips for control commands, and the shm doorbell for audio.
+
+#include "bench.h"
+#include "protocol.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+
+namespace rack_bench {
+
+namespace {
+
+// One connection and its shared memory
+struct WineClient {
+    int sock = -1;
+    int shm_fd = -1;
+    void* shm = nullptr;
+    size_t shm_size = 0;
+    char shm_name[64] = {0};
+    uint8_t payload[4096];
+
+    ~WineClient() {
+        if (shm) {
+            munmap(shm, shm_size);
+        }
+        if (shm_fd >= 0) {
+            close(shm_fd);
+        }
+        if (shm_name[0]) {
+            unlink(shm_name);
+        }
+        if (sock >= 0) {
+            close(sock);
+        }
+    }
+
+    RackWineShmHeader* header() const { return (RackWineShmHeader*)shm; }
+};
+
+static bool write_all(int fd, const void* data, size_t size) {
+    const uint8_t* p = (const uint8_t*)data;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+static bool read_all(int fd, void* data, size_t size) {
+    uint8_t* p = (uint8_t*)data;
+    while (size > 0) {
+        ssize_t n = read(fd, p, size);
+        if (n <= 0) {
+            return false;
+        }
+        p += n;
+        size -= (size_t)n;
+    }
+    return true;
+}
+
+// Send a command and wait for its response.
+// Returns the response status, or -1 on a broken connection.
+static int request(WineClient& client, uint32_t command, const void* payload, uint32_t payload_size) {
+    RackWineHeader header;
+    header.magic = RACK_WINE_MAGIC;
+    header.version = RACK_WINE_PROTOCOL_VERSION;
+    header.command = command;
+    header.payload_size = payload_size;
+    if (!write_all(client.sock, &header, sizeof(header)) ||
+        (payload_size > 0 && !write_all(client.sock, payload, payload_size))) {
+        return -1;
+    }
+
+    RackWineResponse response;
+    if (!read_all(client.sock, &response, sizeof(response)) || response.magic != RACK_WINE_RESPONSE_MAGIC ||
+        response.payload_size > sizeof(client.payload)) {
+        return -1;
+    }
+    if (response.payload_size > 0 && !read_all(client.sock, client.payload, response.payload_size)) {
+        return -1;
+    }
+    return (int)response.status;
+}
+
+static bool connect_host(WineClient& client, int port) {
+    client.sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (client.sock < 0) {
+        return false;
+    }
+    int one = 1;
+    setsockopt(client.sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return connect(client.sock, (sockaddr*)&addr, sizeof(addr)) == 0;
+}
+
+// Create the shm file (visible to Wine through Z:) and CMD_INIT_AUDIO it
+static int init_audio(WineClient& client, const Options& options, uint32_t channels, uint32_t block_size) {
+    snprintf(client.shm_name, sizeof(client.shm_name), "/tmp/rack-bench-audio-%d", getpid());
+    client.shm_size = RACK_WINE_SHM_SIZE_EVENTS(channels, channels, block_size, 1, RACK_WINE_SAMPLE_F32);
+
+    client.shm_fd = open(client.shm_name, O_RDWR | O_CREAT | O_TRUNC, 0666);
+    if (client.shm_fd < 0 || ftruncate(client.shm_fd, (off_t)client.shm_size) < 0) {
+        return -1;
+    }
+    client.shm = mmap(nullptr, client.shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, client.shm_fd, 0);
+    if (client.shm == MAP_FAILED) {
+        client.shm = nullptr;
+        return -1;
+    }
+
+    RackWineShmHeader* hdr = client.header();
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->magic = RACK_WINE_SHM_MAGIC;
+    hdr->version = RACK_WINE_PROTOCOL_VERSION;
+    hdr->num_inputs = channels;
+    hdr->num_outputs = channels;
+    hdr->block_size = block_size;
+    hdr->sample_rate = (uint32_t)options.sample_rate;
+    hdr->input_offset = sizeof(RackWineShmHeader);
+    hdr->output_offset = (uint32_t)(sizeof(RackWineShmHeader) + channels * block_size * sizeof(float));
+    hdr->pipeline_depth = 1;
+    hdr->slot_stride = (uint32_t)(2 * channels * block_size * sizeof(float));
+    hdr->sample_format = RACK_WINE_SAMPLE_F32;
+    hdr->events_offset = (uint32_t)RACK_WINE_SHM_EVENTS_OFFSET(channels, channels, block_size, 1, RACK_WINE_SAMPLE_F32);
+
+    CmdInitAudio cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.sample_rate = (uint32_t)options.sample_rate;
+    cmd.block_size = block_size;
+    cmd.num_inputs = channels;
+    cmd.num_outputs = channels;
+    snprintf(cmd.shm_name, sizeof(cmd.shm_name), "Z:%s", client.shm_name);
+    for (char* p = cmd.shm_name; *p; p++) {
+        if (*p == '/') {
+            *p = '\\';
+        }
+    }
+    cmd.pipeline_depth = 1;
+    cmd.process_mode = 0;
+    cmd.sample_format = RACK_WINE_SAMPLE_F32;
+    return request(client, CMD_INIT_AUDIO, &cmd, sizeof(cmd));
+}
+
+static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Ring the realtime doorbell for one block and wait for completion
+// (same handshake as the Rust client). Returns false on error or timeout.
+static bool doorbell_block(RackWineShmHeader* hdr, uint32_t num_samples) {
+    uint32_t seq = hdr->client_ready + 1;
+    hdr->slot_samples[0] = num_samples;
+    __atomic_store_n(&hdr->client_ready, seq, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&hdr->host_waiting, __ATOMIC_SEQ_CST)) {
+        syscall(SYS_futex, &hdr->client_ready, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    }
+
+    for (int i = 0; i < RACK_WINE_RT_SPIN_COUNT; i++) {
+        if (__atomic_load_n(&hdr->host_ready, __ATOMIC_ACQUIRE) == seq) {
+            return !(hdr->rt_flags & RACK_WINE_RT_ERROR);
+        }
+        cpu_relax();
+    }
+
+    // Park, giving up after about two seconds
+    for (int round = 0; round < 2000; round++) {
+        __atomic_store_n(&hdr->client_waiting, 1, __ATOMIC_SEQ_CST);
+        uint32_t done = __atomic_load_n(&hdr->host_ready, __ATOMIC_SEQ_CST);
+        if (done != seq) {
+            timespec timeout = {0, 1000000};
+            if (hdr->rt_flags & RACK_WINE_RT_FUTEX) {
+                syscall(SYS_futex, &hdr->host_ready, FUTEX_WAIT, done, &timeout, nullptr, 0);
+            } else {
+                nanosleep(&timeout, nullptr);
+            }
+        }
+        __atomic_store_n(&hdr->client_waiting, 0, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&hdr->host_ready, __ATOMIC_ACQUIRE) == seq) {
+            return !(hdr->rt_flags & RACK_WINE_RT_ERROR);
+        }
+    }
+    return false;
+}
+
+static std::string status_text(const char* what, int status) {
+    char text[96];
+    snprintf(text, sizeof(text), "%s failed (status %d)", what, status);
+    return text;
+}
+
+} // namespace
+
+int run_wine_benchmarks(const Options& options, int port, const char* plugin_path) {
+    const uint32_t channels = 2;
+    const uint32_t max_block = options.block_sizes.back();
+
+    Result base;
+    base.format = "wine";
+    base.plugin = plugin_path;
+
+    WineClient client;
+    if (!connect_host(client, port)) {
+        Result result = base;
+        result.bench = "wine.ping";
+        result.error = "cannot connect to 127.0.0.1:" + std::to_string(port);
+        report(result);
+        return 1;
+    }
+
+    // Control round trip without any plugin work
+    if (selected(options, "wine.ping")) {
+        Result result = base;
+        result.bench = "wine.ping";
+        Sampler sampler(options.iterations);
+        int status = STATUS_OK;
+        for (size_t i = 0; i < options.iterations && status == STATUS_OK; i++) {
+            sampler.measure([&] { status = request(client, CMD_PING, nullptr, 0); });
+        }
+        if (status != STATUS_OK) {
+            result.error = status_text("PING", status);
+        }
+        finish(result, sampler);
+        report(result);
+    }
+
+    CmdLoadPlugin load;
+    memset(&load, 0, sizeof(load));
+    strncpy(load.path, plugin_path, sizeof(load.path) - 1);
+    uint64_t load_start = now_ns();
+    int status = request(client, CMD_LOAD_PLUGIN, &load, sizeof(load));
+    uint64_t load_ns = now_ns() - load_start;
+    if (status == STATUS_OK && request(client, CMD_GET_INFO, nullptr, 0) == STATUS_OK) {
+        base.plugin = ((RespPluginInfo*)client.payload)->name;
+    }
+    if (status == STATUS_OK) {
+        status = init_audio(client, options, channels, max_block);
+    }
+    if (status != STATUS_OK) {
+        Result result = base;
+        result.bench = "wine.load";
+        result.error = status_text("LOAD_PLUGIN/INIT_AUDIO", status);
+        report(result);
+        return 1;
+    }
+    fprintf(stderr, "%-26s %-24.24s %.2f ms\n", "wine.load (single)", base.plugin.c_str(), load_ns / 1e6);
+
+    // Parameter round trip (first parameter, if any)
+    uint32_t param_index = 0;
+    if (selected(options, "wine.set_param") &&
+        request(client, CMD_GET_PARAM_INFO, &param_index, sizeof(param_index)) == STATUS_OK) {
+        CmdParam param;
+        param.param_id = ((RespParamInfo*)client.payload)->id;
+        Result result = base;
+        result.bench = "wine.set_param";
+        Sampler sampler(options.iterations);
+        status = STATUS_OK;
+        for (size_t i = 0; i < options.iterations && status == STATUS_OK; i++) {
+            param.value = (i & 1) ? 0.25 : 0.75;
+            sampler.measure([&] { status = request(client, CMD_SET_PARAM, &param, sizeof(param)); });
+        }
+        if (status != STATUS_OK) {
+            result.error = status_text("SET_PARAM", status);
+        }
+        finish(result, sampler);
+        report(result);
+    }
+
+    for (uint32_t block_size : options.block_sizes) {
+        Result audio = base;
+        audio.block_size = block_size;
+        audio.channels = channels;
+        audio.sample_rate = options.sample_rate;
+        audio.frames_per_op = block_size;
+
+        // One socket round trip per block
+        if (selected(options, "wine.process_audio")) {
+            Result result = audio;
+            result.bench = "wine.process_audio";
+            CmdProcessAudio cmd;
+            cmd.num_samples = block_size;
+            Sampler sampler(options.iterations);
+            status = STATUS_OK;
+            for (size_t i = 0; i < options.iterations && status == STATUS_OK; i++) {
+                sampler.measure([&] { status = request(client, CMD_PROCESS_AUDIO, &cmd, sizeof(cmd)); });
+            }
+            if (status != STATUS_OK) {
+                result.error = status_text("PROCESS_AUDIO", status);
+            }
+            finish(result, sampler);
+            report(result);
+        }
+
+        // Realtime doorbell: no socket on the audio path
+        if (selected(options, "wine.realtime")) {
+            Result result = audio;
+            result.bench = "wine.realtime";
+            status = request(client, CMD_START_REALTIME, nullptr, 0);
+            if (status != STATUS_OK) {
+                result.error = status_text("START_REALTIME", status);
+                report(result);
+                continue;
+            }
+            Sampler sampler(options.iterations);
+            bool ok = true;
+            for (size_t i = 0; i < options.warmup && ok; i++) {
+                ok = doorbell_block(client.header(), block_size);
+            }
+            for (size_t i = 0; i < options.iterations && ok; i++) {
+                sampler.measure([&] { ok = doorbell_block(client.header(), block_size); });
+            }
+            request(client, CMD_STOP_REALTIME, nullptr, 0);
+            if (!ok) {
+                result.error = "doorbell block failed or timed out";
+            }
+            finish(result, sampler);
+            report(result);
+        }
+    }
+
+    request(client, CMD_UNLOAD_PLUGIN, nullptr, 0);
+    return 0;
+}
+
+} // namespace rack_bench
@@ -8,10 +8,13 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 
+#include "rack_rt.h"
+
 // Opaque types
 typedef struct RackAUScanner RackAUScanner;
 typedef struct RackAUPlugin RackAUPlugin;
 typedef struct RackAUGui RackAUGui;
+typedef struct RackAUPool RackAUPool;
 
 // Plugin type enum
 typedef enum {
@@ -38,6 +41,7 @@ typedef struct {
 #define RACK_AU_ERROR_NOT_FOUND -2
 #define RACK_AU_ERROR_INVALID_PARAM -3
 #define RACK_AU_ERROR_NOT_INITIALIZED -4
+#define RACK_AU_ERROR_NOT_SUPPORTED -6    // Feature not available in this build
 #define RACK_AU_ERROR_AUDIO_UNIT -1000  // Base for AudioUnit OSStatus errors
 
 // ============================================================================
@@ -54,11 +58,16 @@ void rack_au_scanner_free(RackAUScanner* scanner);
 // Scan for plugins
 // Returns number of plugins found (or would be found), or negative error code
 //
-// Two-pass usage pattern (recommended):
+// Results are cached by the scanner. The component list is walked again only
+// after the system reports a registration change (or after
+// rack_au_scanner_invalidate), and then only new components are queried, so
+// repeated scans are cheap.
+//
+// Two-pass usage pattern:
 //   1. count = rack_au_scanner_scan(scanner, NULL, 0);  // Get total count
 //   2. rack_au_scanner_scan(scanner, array, count);     // Fill array
 //
-// If plugins is NULL: Only counts plugins, does not extract details
+// If plugins is NULL: Only counts plugins
 // If plugins is not NULL: Fills array up to max_plugins
 //
 // IMPORTANT: Return value may exceed max_plugins if more plugins exist.
@@ -68,6 +77,27 @@ void rack_au_scanner_free(RackAUScanner* scanner);
 // max_plugins: size of output array (ignored if plugins is NULL)
 int rack_au_scanner_scan(RackAUScanner* scanner, RackAUPluginInfo* plugins, size_t max_plugins);
 
+// Scan for plugins in a single pass
+// On success *plugins points to an array owned by the scanner (NULL when
+// nothing was found). It stays valid until the next scan or
+// rack_au_scanner_free.
+// Returns number of plugins found, or negative error code
+int rack_au_scanner_scan_results(RackAUScanner* scanner, const RackAUPluginInfo** plugins);
+
+// Get the scanner's registration generation
+// Increases whenever AudioUnits are registered or unregistered
+// (kAudioComponentRegistrationsChangedNotification) or the scanner is
+// invalidated. If it is unchanged since a scan, that scan's results are
+// still current. Does not scan.
+// Thread-safety: may be called from any thread
+uint64_t rack_au_scanner_generation(const RackAUScanner* scanner);
+
+// Force the next scan to re-walk the component list
+// Fallback for when registration changes may have been missed (e.g. the
+// process never delivers the system notification). Bumps the generation.
+// Returns 0 on success, negative error code on failure
+int rack_au_scanner_invalidate(RackAUScanner* scanner);
+
 // ============================================================================
 // Plugin Instance API
 // ============================================================================
@@ -78,6 +108,41 @@ RackAUPlugin* rack_au_plugin_new(const char* unique_id);
 // Free plugin instance
 void rack_au_plugin_free(RackAUPlugin* plugin);
 
+// Create a new instance of the same AudioComponent with the source's state
+// The state (ClassInfo) is handed from one unit to the other without being
+// serialized. Offline render and idle sleep settings carry over; if the
+// source is initialized, the clone is initialized with the same sample rate
+// and block size.
+// Returns the new instance (free with rack_au_plugin_free), or NULL on error
+// Thread-safety: Not realtime-safe. Don't call other non-realtime functions on
+// source concurrently.
+RackAUPlugin* rack_au_plugin_clone(RackAUPlugin* source);
+
+// Instance pool: keeps up to size ready instances of a prototype plugin,
+// created like rack_au_plugin_clone() from the prototype's state and
+// settings at the time the pool was created. A background thread refills
+// the pool whenever an instance is taken, so acquire takes microseconds.
+// Spare instances are initialized but never rendered.
+// Returns NULL on error
+// Thread-safety: Not realtime-safe; same rules for prototype as clone()
+RackAUPool* rack_au_pool_new(RackAUPlugin* prototype, uint32_t size);
+
+// Stop refilling and free the pool's spare instances
+// Instances already acquired stay valid.
+// Thread-safety: Waits for an instance being created by the pool
+void rack_au_pool_free(RackAUPool* pool);
+
+// Take a ready instance out of the pool (free with rack_au_plugin_free)
+// Never waits for an instance to be created.
+// Returns NULL if the pool is empty (still refilling, or creating instances
+// failed; a failed creation is retried after each acquire)
+// Thread-safety: Thread-safe. Takes a short lock; not for the audio thread.
+RackAUPlugin* rack_au_pool_acquire(RackAUPool* pool);
+
+// Number of ready instances, or negative error code
+// Thread-safety: Thread-safe.
+int rack_au_pool_available(RackAUPool* pool);
+
 // Initialize plugin
 // Returns 0 on success, negative error code on failure
 int rack_au_plugin_initialize(RackAUPlugin* plugin, double sample_rate, uint32_t max_block_size);
@@ -115,7 +180,8 @@ int rack_au_plugin_get_output_channels(RackAUPlugin* plugin);
 // num_input_channels: number of input channels
 // outputs: array of output channel pointers (e.g., [left_ptr, right_ptr] for stereo)
 // num_output_channels: number of output channels
-// frames: number of frames to process
+// frames: number of frames to process (at most max_block_size; see
+//         rack_au_plugin_process_split() for longer buffers)
 //
 // Channel Layout Examples:
 //   Mono:   inputs = [mono_ptr], num_input_channels = 1
@@ -132,6 +198,150 @@ int rack_au_plugin_process(
     uint32_t frames
 );
 
+// Process a buffer of any length (planar format, same layout as process())
+// Buffers up to max_block_size frames go straight to process(). Longer ones
+// are rendered in max_block_size sub-blocks, and the MIDI queued for the
+// call goes to the sub-block containing its sample offset, rebased to it.
+// Events past the end of the buffer land on its last frame.
+//
+// Returns 0 on success, or the first sub-block's error code (the remaining
+// sub-blocks are still rendered)
+// Thread-safety: Same as process(). Realtime-safe (no allocation or locking).
+int rack_au_plugin_process_split(
+    RackAUPlugin* plugin,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames
+);
+
+// Enable or disable offline rendering (kAudioUnitProperty_OfflineRender)
+// Tells the AudioUnit it is being rendered for a bounce rather than live,
+// so it may use higher-quality, non-realtime algorithms and be driven
+// faster than realtime. May be called before or after initialize().
+//
+// Returns:
+//   0 (RACK_AU_OK) on success
+//   RACK_AU_ERROR_AUDIO_UNIT + OSStatus if the AudioUnit rejects the property
+//
+// Thread-safety: Non-realtime. Must not be called concurrently with process().
+int rack_au_plugin_set_offline_render(RackAUPlugin* plugin, int enabled);
+
+// Render a buffer of any length (planar format, same layout as process())
+// Splits the buffers into max_block_size chunks and renders them in order,
+// so AudioTimeStamp sample times stay continuous across chunks. MIDI queued
+// beforehand goes to the chunk containing its sample offset, as in
+// process_split().
+// Typically used together with rack_au_plugin_set_offline_render(plugin, 1).
+//
+// total_frames: frames per channel in inputs/outputs
+//
+// Returns 0 on success, negative error code on failure (from the failing chunk)
+// Thread-safety: Same as process(). Not realtime-safe.
+int rack_au_plugin_render_offline(
+    RackAUPlugin* plugin,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint64_t total_frames
+);
+
+// Enable or disable idle sleep (disabled by default)
+// process() always flags silent input to the AudioUnit with
+// kAudioUnitRenderAction_OutputIsSilence. With idle sleep enabled it also
+// stops rendering once the input has been digital silence, with no MIDI, for
+// longer than kAudioUnitProperty_TailTime plus kAudioUnitProperty_Latency
+// and the unit's last output was silent. While asleep, outputs are
+// zero-filled. The unit wakes on the first non-silent input or MIDI event,
+// and after reset, preset or state loads.
+// Returns 0 on success, negative error code on failure
+// Thread-safety: May be called from any thread.
+int rack_au_plugin_set_idle_sleep(RackAUPlugin* plugin, int enabled);
+
+// Get the number of blocks the AudioUnit rendered and skipped while asleep
+// Either output pointer may be NULL.
+// Returns 0 on success, negative error code on failure
+// Thread-safety: May be called from any thread (counters are approximate
+// while process() runs).
+int rack_au_plugin_get_block_counts(RackAUPlugin* plugin, uint64_t* processed, uint64_t* skipped);
+
+// Process-time histogram size of RackAUPluginStats
+#define RACK_AU_STATS_HISTOGRAM_BUCKETS 32
+
+// Rendering statistics of one instance. Times cover whole process() and
+// process_split() calls (one call of process_split() counts once), measured
+// with the CPU cycle counter; the block deadline of a call is frames /
+// sample rate.
+typedef struct {
+    uint64_t process_calls;          // Timed process calls
+    uint64_t frames;                 // Frames rendered by those calls
+    uint64_t total_ns;               // Time spent in them
+    uint64_t max_ns;                 // Slowest call
+    uint64_t deadline_ns;            // Sum of their block deadlines
+    uint64_t deadline_misses;        // Calls slower than their block deadline
+    double max_load;                 // Largest call time / block deadline
+    double average_load;             // total_ns / deadline_ns
+    uint64_t process_errors;         // Renders where AudioUnitRender failed
+    uint64_t dropped_midi_events;    // Events send_midi() could not queue
+    uint64_t dropped_param_changes;  // Always 0 (no GUI change queue for AudioUnits)
+    uint64_t histogram[RACK_AU_STATS_HISTOGRAM_BUCKETS];  // Bucket i: calls taking [2^i, 2^(i+1)) ns
+} RackAUPluginStats;
+
+// Get the instance's rendering statistics since creation or the last
+// reset_stats()
+// Returns 0 on success, RACK_AU_ERROR_NOT_SUPPORTED if rack-sys was built
+// with RACK_PERF_COUNTERS=0 (stats are then zeroed), negative error code on
+// failure
+// Thread-safety: May be called from any thread; meant for monitoring
+// threads polling while process() runs (fields are read one by one, so a
+// block in flight may be counted partially).
+int rack_au_plugin_get_stats(RackAUPlugin* plugin, RackAUPluginStats* stats);
+
+// Zero the statistics. Timing counters are cleared by the next process()
+// call, so a snapshot taken in between still shows the old values.
+// Returns 0 on success, negative error code on failure
+// Thread-safety: May be called from any thread.
+int rack_au_plugin_reset_stats(RackAUPlugin* plugin);
+
+// Lock the instance's preallocated processing buffers into RAM through a
+// realtime context (see rack_rt.h); they stay locked until the context is
+// left. Call after initialize(), and again after re-initializing.
+// Returns 0 on success (or if ctx doesn't lock memory), negative error code
+// on failure
+// Thread-safety: Not realtime-safe; call before processing starts
+int rack_au_plugin_lock_memory(RackAUPlugin* plugin, RackRtContext* ctx);
+
+// Get how input was delivered to the AudioUnit, counted per render
+// zero_copy: renders where the unit read the caller's input buffers directly
+// copied: renders where the unit supplied its own buffers and input was copied
+// A steadily growing copied count identifies units that force the copy.
+// Either output pointer may be NULL.
+// Returns 0 on success, negative error code on failure
+// Thread-safety: May be called from any thread (counters are approximate
+// while process() runs).
+int rack_au_plugin_get_input_copy_counts(RackAUPlugin* plugin, uint64_t* zero_copy, uint64_t* copied);
+
+// Get the unit's processing latency and tail, for delay compensation
+// Reads kAudioUnitProperty_Latency and kAudioUnitProperty_TailTime,
+// converted to samples at the initialized sample rate, and caches them. Call
+// again whenever rack_au_plugin_get_latency_generation() changes.
+// latency_samples: output delay in samples (may be NULL)
+// tail_samples: samples of output after the input goes silent (may be NULL)
+//
+// Returns 0 on success, RACK_AU_ERROR_NOT_INITIALIZED before initialize(),
+//   or negative error code on failure
+// Thread-safety: Non-realtime.
+int rack_au_plugin_get_latency(RackAUPlugin* plugin, uint32_t* latency_samples, uint32_t* tail_samples);
+
+// Counter that advances whenever the latency or tail changes: when the unit
+// notifies a property listener, or get_latency() finds new values
+// Returns the current generation (0 for NULL)
+// Thread-safety: Realtime-safe (one atomic load). Poll it from the audio
+// thread and call get_latency() from a control thread when it moves.
+uint32_t rack_au_plugin_get_latency_generation(RackAUPlugin* plugin);
+
 // Get parameter count
 // Thread-safety: Read-only after initialization. Safe to call from any thread,
 // but plugin instances should not be shared across threads (Send but not Sync).
@@ -151,6 +361,14 @@ int rack_au_plugin_get_parameter(RackAUPlugin* plugin, uint32_t index, float* va
 // Note: Calling during audio processing may cause clicks/pops (AudioUnit internal behavior).
 int rack_au_plugin_set_parameter(RackAUPlugin* plugin, uint32_t index, float value);
 
+// Map a native AudioUnitParameterID to its parameter index
+// Uses a hash table built at initialize(), so this is O(1) even for plugins
+// with thousands of parameters.
+// Returns parameter index (>= 0), RACK_AU_ERROR_NOT_FOUND if the ID is
+// unknown, or another negative error code on failure
+// Thread-safety: Read-only after initialization. Realtime-safe.
+int rack_au_plugin_param_index_for_id(RackAUPlugin* plugin, uint32_t param_id);
+
 // Get parameter info
 // name: output buffer for parameter name (allocated by caller)
 // name_size: size of name buffer
@@ -217,6 +435,17 @@ int rack_au_plugin_get_state_size(RackAUPlugin* plugin);
 // Typical usage: call get_state_size() first, allocate buffer, then call get_state()
 int rack_au_plugin_get_state(RackAUPlugin* plugin, uint8_t* data, size_t* size);
 
+// Serialize the plugin state once into a plugin-owned buffer
+// Cheaper than get_state_size + get_state for frequent snapshots (autosave,
+// undo): ClassInfo is fetched and serialized a single time and the bytes are
+// handed out without a copy.
+// On success *data/*size describe the state (same format as get_state).
+// The data stays valid until the next snapshot_state call on this plugin,
+// or until it is freed.
+// Returns 0 on success, negative error code on failure
+// Thread-safety: Same as get_state.
+int rack_au_plugin_snapshot_state(RackAUPlugin* plugin, const uint8_t** data, size_t* size);
+
 // Set plugin state (restore full state including parameters, preset, etc.)
 // data: state data (from previous get_state call)
 // size: size of state data in bytes
@@ -263,9 +492,17 @@ typedef struct {
 // Send MIDI events to plugin
 // events: array of MIDI events
 // event_count: number of events in array
+// Events go into a lock-free queue (1024 events); the next process() call
+// schedules them with MusicDeviceMIDIEvent in sample_offset order. If the
+// whole batch does not fit, nothing is queued and RACK_AU_ERROR_GENERIC is
+// returned. Effects that do not accept MIDI silently drop the events.
 // Returns 0 on success, negative error code on failure
-// Thread-safety: Should be called from the same thread that owns the plugin instance.
-// Not safe to call concurrently with process() or other plugin operations.
+// Thread-safety: Single producer. At most one thread may be inside
+// send_midi() at a time; it may run concurrently with process() (which is
+// the consumer). The queue is a single-producer ring, so concurrent
+// send_midi() calls from several threads (e.g. UI, network and sequencer)
+// corrupt it without any error being reported: serialize them in the host,
+// or funnel them through one thread.
 int rack_au_plugin_send_midi(
     RackAUPlugin* plugin,
     const RackAUMidiEvent* events,
@@ -0,0 +1,66 @@
+#ifndef RACK_CONVERT_H
+#define RACK_CONVERT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Sample format conversion for the host side of process().
+//
+// Plugins take planar float buffers; audio devices usually deliver
+// interleaved frames, often as integers. These kernels convert between the
+// two. x86 builds select SSE2 or AVX2 at runtime, ARM64 uses NEON.
+//
+// Integer full scale maps to [-1.0, 1.0). Float to integer rounds to
+// nearest and clips to the integer range. All functions are realtime-safe
+// (no allocation or locking) once rack_convert_isa() has been called.
+
+// State for TPDF (triangular) dither, +/-1 LSB. One per output stream.
+typedef struct {
+    uint32_t lanes[8];
+} RackDitherState;
+
+// Seed a dither state (any seed, including 0)
+void rack_dither_init(RackDitherState* state, uint32_t seed);
+
+// Returns the selected instruction set: "avx2", "sse2", "neon" or "scalar"
+// The first call picks the kernels; call it once outside the audio thread.
+const char* rack_convert_isa(void);
+
+// Interleaved frames -> one buffer per channel
+// interleaved: frames * channels samples
+// planar: channels pointers to at least frames samples each
+void rack_convert_deinterleave(const float* interleaved, float* const* planar,
+                               uint32_t channels, uint32_t frames);
+
+// One buffer per channel -> interleaved frames
+void rack_convert_interleave(const float* const* planar, float* interleaved,
+                             uint32_t channels, uint32_t frames);
+
+// Signed 16-bit <-> float
+// dither: NULL for plain rounding
+void rack_convert_s16_to_f32(const int16_t* src, float* dst, size_t count);
+void rack_convert_f32_to_s16(const float* src, int16_t* dst, size_t count, RackDitherState* dither);
+
+// Packed little-endian signed 24-bit (3 bytes per sample) <-> float
+void rack_convert_s24_to_f32(const uint8_t* src, float* dst, size_t count);
+void rack_convert_f32_to_s24(const float* src, uint8_t* dst, size_t count, RackDitherState* dither);
+
+// Signed 32-bit <-> float (no dither: float has less resolution than s32)
+void rack_convert_s32_to_f32(const int32_t* src, float* dst, size_t count);
+void rack_convert_f32_to_s32(const float* src, int32_t* dst, size_t count);
+
+// dst[i] += src[i] * gain
+void rack_mix_add(const float* src, float* dst, size_t count, float gain);
+
+// buffer[i] *= gain
+void rack_apply_gain(float* buffer, size_t count, float gain);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RACK_CONVERT_H
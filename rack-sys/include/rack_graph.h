@@ -0,0 +1,125 @@
+#ifndef RACK_GRAPH_H
+#define RACK_GRAPH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Format-agnostic processing graph.
+//
+// Nodes are plugin instances of any format (VST3, AudioUnit, ...), each
+// described by its instance pointer and process function; edges connect a
+// node's output channel to another node's input channel. rack_graph_process()
+// runs every node once per block, spreading independent branches over a
+// fixed pool of worker threads with work stealing.
+
+// Opaque type
+typedef struct RackGraph RackGraph;
+
+// Error codes (0 = success, negative = error)
+#define RACK_GRAPH_OK 0
+#define RACK_GRAPH_ERROR_GENERIC -1
+#define RACK_GRAPH_ERROR_INVALID_PARAM -2
+#define RACK_GRAPH_ERROR_NOT_PREPARED -3   // Graph changed since the last prepare()
+#define RACK_GRAPH_ERROR_CYCLE -4          // Connections form a feedback loop
+#define RACK_GRAPH_ERROR_NODE_FAILED -5    // A node's process function failed
+
+// Node ID standing for the graph itself: as a connection source it is the
+// graph input passed to process(), as a destination the graph output
+#define RACK_GRAPH_IO 0xFFFFFFFFu
+
+// Worker thread flags for rack_graph_new (best effort; ignored where the
+// platform or the process's privileges don't allow them)
+#define RACK_GRAPH_FLAG_PIN_THREADS 0x1        // Pin each worker to its own core
+#define RACK_GRAPH_FLAG_REALTIME_PRIORITY 0x2  // Realtime scheduling for workers
+
+// Per-node process function. Same signature as rack_vst3_plugin_process and
+// rack_au_plugin_process, with the plugin passed as instance.
+// Returns 0 on success, negative error code on failure
+typedef int (*RackGraphProcessFn)(
+    void* instance,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames
+);
+
+// Create a graph
+// num_workers: threads started in addition to the one calling process()
+//              (0 runs every node on the calling thread)
+// max_block_size: largest frames value process() will be called with
+// flags: RACK_GRAPH_FLAG_* bits
+// Returns NULL if allocation or thread creation fails
+RackGraph* rack_graph_new(uint32_t num_workers, uint32_t max_block_size, uint32_t flags);
+
+// Stop the workers and free the graph (does not free the node instances)
+void rack_graph_free(RackGraph* graph);
+
+// Add a node
+// instance: plugin pointer passed to process; must be initialized and stay
+//           valid (and otherwise unused while process() runs) until the graph
+//           is freed
+// num_input_channels / num_output_channels: the plugin's channel counts
+// Returns node ID (>= 0), or negative error code on failure
+// Thread-safety: Not while process() is running
+int rack_graph_add_node(
+    RackGraph* graph,
+    void* instance,
+    RackGraphProcessFn process,
+    uint32_t num_input_channels,
+    uint32_t num_output_channels
+);
+
+// Connect an output channel to an input channel
+// Several sources connected to one input are summed. Use RACK_GRAPH_IO as
+// src_node for a graph input channel or as dst_node for a graph output.
+// Returns 0 on success, RACK_GRAPH_ERROR_INVALID_PARAM for unknown nodes or
+// channels
+// Thread-safety: Not while process() is running
+int rack_graph_connect(
+    RackGraph* graph,
+    uint32_t src_node,
+    uint32_t src_channel,
+    uint32_t dst_node,
+    uint32_t dst_channel
+);
+
+// Compute the schedule and allocate all intermediate buffers
+// Must be called after adding nodes or connections and before process().
+// Returns 0 on success, RACK_GRAPH_ERROR_CYCLE if the connections contain a
+// feedback loop, negative error code on other failures
+// Thread-safety: Not while process() is running
+int rack_graph_prepare(RackGraph* graph);
+
+// Process one block through the whole graph
+// inputs: graph input channels (num_input_channels may be zero; missing
+//         channels read as silence)
+// outputs: graph output channels; unconnected outputs are zeroed
+// frames: must not exceed max_block_size
+// Returns 0 on success, RACK_GRAPH_ERROR_NOT_PREPARED if the graph changed
+// since prepare(), RACK_GRAPH_ERROR_NODE_FAILED if a node failed (its outputs
+// are silenced and the rest of the graph still runs)
+// Thread-safety: Realtime-safe once prepared: no allocation or locks (the
+// first block after the workers went idle takes a mutex to wake them).
+// Call from one thread at a time.
+int rack_graph_process(
+    RackGraph* graph,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames
+);
+
+// Returns the number of worker threads (excluding the caller of process)
+uint32_t rack_graph_get_num_workers(RackGraph* graph);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RACK_GRAPH_H
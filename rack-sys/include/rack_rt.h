@@ -0,0 +1,84 @@
+#ifndef RACK_RT_H
+#define RACK_RT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Realtime execution context for the thread that calls process().
+//
+// A host's audio thread enters a context once, before its first process()
+// call, and leaves it when it stops. Entering sets the FPU to flush
+// denormals, raises the thread to realtime priority (SCHED_FIFO on Linux,
+// a Mach time-constraint policy on macOS, MMCSS "Pro Audio" on Windows and
+// under Wine) and lets the host lock plugin buffers into RAM. Each part is
+// best effort; rack_rt_context_applied() reports what took effect.
+//
+// rack_*_plugin_process() flush denormals for the duration of each call
+// even without a context; the context makes that free and also covers the
+// host's own DSP on the thread.
+
+// Opaque type
+typedef struct RackRtContext RackRtContext;
+
+// Error codes (0 = success, negative = error)
+#define RACK_RT_OK 0
+#define RACK_RT_ERROR_GENERIC -1
+#define RACK_RT_ERROR_INVALID_PARAM -2
+#define RACK_RT_ERROR_NOT_SUPPORTED -3
+
+// Context flags (RackRtConfig.flags, rack_rt_context_applied)
+#define RACK_RT_FLUSH_DENORMALS 0x1    // FTZ/DAZ (x86 MXCSR) or FZ (ARM64 FPCR)
+#define RACK_RT_REALTIME_PRIORITY 0x2  // Realtime scheduling for the thread
+#define RACK_RT_LOCK_MEMORY 0x4        // Lock registered memory into RAM
+
+typedef struct {
+    uint32_t flags;        // RACK_RT_* bits
+    int32_t priority;      // SCHED_FIFO priority on Linux, 0 = maximum - 5
+                           // (above rack_graph workers, which use maximum - 10)
+    double sample_rate;    // With block_size, the callback period, used for
+    uint32_t block_size;   // the macOS time-constraint policy (0 = unknown)
+} RackRtConfig;
+
+// Enter a context on the calling thread
+// config: NULL for all flags with default settings
+// Returns NULL if allocation fails. The context belongs to the calling thread
+// and must be left on it.
+// Thread-safety: Call before the thread starts processing (not realtime-safe)
+RackRtContext* rack_rt_context_enter(const RackRtConfig* config);
+
+// Restore the thread's FPU mode and scheduling, unlock all memory locked
+// through the context, and free it
+// Thread-safety: Must be called on the thread that entered the context
+void rack_rt_context_leave(RackRtContext* ctx);
+
+// RACK_RT_* flags that took effect (e.g. RACK_RT_REALTIME_PRIORITY is missing
+// without the privileges for realtime scheduling)
+uint32_t rack_rt_context_applied(const RackRtContext* ctx);
+
+// Lock a memory range into RAM (mlock/VirtualLock) until the context is left
+// Does nothing unless the context was entered with RACK_RT_LOCK_MEMORY.
+// rack_vst3_plugin_lock_memory() and rack_au_plugin_lock_memory() register an
+// instance's preallocated buffers; lock again after re-initializing it.
+// Returns 0 on success, negative error code on failure (e.g. over
+// RLIMIT_MEMLOCK)
+// Thread-safety: Not realtime-safe; not concurrently with other calls on ctx
+int rack_rt_context_lock_memory(RackRtContext* ctx, const void* addr, size_t size);
+
+// Realtime violations detected inside rack's process paths: memory
+// allocations, and mutex locks (Linux only). Each thread reports its first
+// violation on stderr.
+// Only available when rack-sys is built with RACK_RT_CHECKS (the default for
+// Debug builds); otherwise returns RACK_RT_ERROR_NOT_SUPPORTED.
+// allocations, locks: output counters (either may be NULL)
+// Thread-safety: Can be called from any thread
+int rack_rt_get_violations(uint64_t* allocations, uint64_t* locks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RACK_RT_H
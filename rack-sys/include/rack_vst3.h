@@ -8,10 +8,13 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 
+#include "rack_rt.h"
+
 // Opaque types
 typedef struct RackVST3Scanner RackVST3Scanner;
 typedef struct RackVST3Plugin RackVST3Plugin;
 typedef struct RackVST3Gui RackVST3Gui;
+typedef struct RackVST3Pool RackVST3Pool;
 
 // Plugin type enum
 typedef enum {
@@ -41,6 +44,7 @@ typedef struct {
 #define RACK_VST3_ERROR_NOT_INITIALIZED -4
 #define RACK_VST3_ERROR_LOAD_FAILED -5
 #define RACK_VST3_ERROR_NOT_SUPPORTED -6  // Feature not supported by this plugin
+#define RACK_VST3_ERROR_BUSY -7           // An asynchronous state load is in progress
 
 // ============================================================================
 // Scanner API
@@ -61,14 +65,41 @@ int rack_vst3_scanner_add_path(RackVST3Scanner* scanner, const char* path);
 // Returns 0 on success, negative error code on failure
 int rack_vst3_scanner_add_default_paths(RackVST3Scanner* scanner);
 
+// Set the on-disk scan cache file
+// Bundles whose fingerprint (binary mtime and size) matches the cache are
+// reported without loading the module; changed and new bundles are probed
+// and the file is rewritten. Bundles that failed to load (or crashed the
+// probe) are cached too and retried only once they change.
+// path: cache file path, or NULL to disable the on-disk cache (the scanner
+//       always keeps an in-memory cache across scans)
+// Returns 0 on success, negative error code on failure
+int rack_vst3_scanner_set_cache_path(RackVST3Scanner* scanner, const char* path);
+
+// Enable or disable out-of-process probing (enabled by default)
+// On Linux, bundles that are not cached are loaded in parallel forked worker
+// processes, so a plugin that crashes or hangs during load cannot take the
+// host down. Elsewhere probing is always in-process and serial.
+// Returns 0 on success, negative error code on failure
+int rack_vst3_scanner_set_out_of_process(RackVST3Scanner* scanner, int enabled);
+
+// Scan for plugins in a single pass
+// On success *plugins points to an array owned by the scanner (NULL when
+// nothing was found). It stays valid until the next scan or
+// rack_vst3_scanner_free.
+// Returns number of plugins found, or negative error code
+int rack_vst3_scanner_scan_results(RackVST3Scanner* scanner, const RackVST3PluginInfo** plugins);
+
 // Scan for plugins
 // Returns number of plugins found (or would be found), or negative error code
 //
-// Two-pass usage pattern (recommended):
+// Two-pass usage pattern:
 //   1. count = rack_vst3_scanner_scan(scanner, NULL, 0);  // Get total count
 //   2. rack_vst3_scanner_scan(scanner, array, count);     // Fill array
 //
-// If plugins is NULL: Only counts plugins, does not extract details
+// The second pass is served from the scanner's cache, so no module is loaded
+// twice. rack_vst3_scanner_scan_results avoids the copy altogether.
+//
+// If plugins is NULL: Only counts plugins
 // If plugins is not NULL: Fills array up to max_plugins
 //
 // IMPORTANT: Return value may exceed max_plugins if more plugins exist.
@@ -78,11 +109,40 @@ int rack_vst3_scanner_add_default_paths(RackVST3Scanner* scanner);
 // max_plugins: size of output array (ignored if plugins is NULL)
 int rack_vst3_scanner_scan(RackVST3Scanner* scanner, RackVST3PluginInfo* plugins, size_t max_plugins);
 
+// ============================================================================
+// Module Cache API
+// ============================================================================
+
+// Loaded modules are cached process-wide, keyed by bundle path (the exact
+// string passed in). Every rack_vst3_plugin_new for the same path borrows
+// the cached module and its factory instead of opening the bundle again.
+// A module is unloaded when its last instance is freed, unless it is
+// preloaded.
+
+// Load a module ahead of the first instance and keep it loaded.
+// It stays loaded, even with no instances, until rack_vst3_module_release.
+// Returns 0 on success (including when it is already loaded), negative
+// error code on failure (RACK_VST3_ERROR_LOAD_FAILED if the bundle can't be loaded)
+// Thread-safety: Thread-safe (serialized with other users of the same module).
+int rack_vst3_module_preload(const char* path);
+
+// Undo rack_vst3_module_preload. The module is unloaded right away if no
+// instance uses it, otherwise when its last instance is freed.
+// Returns 0 on success, RACK_VST3_ERROR_NOT_FOUND if path is not preloaded
+// Thread-safety: Thread-safe.
+int rack_vst3_module_release(const char* path);
+
+// Check whether a module is currently loaded (by instances or preload)
+// Returns 1 if loaded, 0 otherwise
+// Thread-safety: Thread-safe.
+int rack_vst3_module_is_loaded(const char* path);
+
 // ============================================================================
 // Plugin Instance API
 // ============================================================================
 
 // Create a new plugin instance from path and UID
+// The module is shared with other instances of the same path (see above).
 // path: path to .vst3 bundle/folder
 // uid: plugin UID (from scan result)
 // Returns plugin instance or NULL on error
@@ -91,6 +151,69 @@ RackVST3Plugin* rack_vst3_plugin_new(const char* path, const char* uid);
 // Free plugin instance
 void rack_vst3_plugin_free(RackVST3Plugin* plugin);
 
+// Create (and optionally initialize) many plugin instances on a worker pool
+// Instance lifecycle calls are serialized per module only, so instances of
+// different bundles load and set up in parallel.
+// paths/uids: count bundle paths and UIDs, as for rack_vst3_plugin_new
+// sample_rate/max_block_size: passed to rack_vst3_plugin_initialize;
+//                             max_block_size 0 only creates the instances
+// num_threads: worker threads, 0 = one per hardware thread
+// plugins: output array of count entries; entries that failed are NULL
+// Returns the number of instances created, or negative error code
+// Thread-safety: Thread-safe.
+int rack_vst3_plugins_new_parallel(
+    const char* const* paths,
+    const char* const* uids,
+    size_t count,
+    double sample_rate,
+    uint32_t max_block_size,
+    uint32_t num_threads,
+    RackVST3Plugin** plugins
+);
+
+// Create a new instance of the same plugin with the source's state
+// The class is instantiated from the already loaded module and the state is
+// handed over in memory, before initialize(), so the new instance is set up
+// once. Process mode, double precision and idle sleep settings carry over; if
+// the source is initialized, the clone is initialized with the same sample
+// rate and block size.
+// Returns the new instance (free with rack_vst3_plugin_free), or NULL on
+// error or while an asynchronous state load is running on source
+// Thread-safety: Not realtime-safe. Don't call other non-realtime functions on
+// source concurrently; process() may keep running on it.
+RackVST3Plugin* rack_vst3_plugin_clone(RackVST3Plugin* source);
+
+// ============================================================================
+// Instance Pool API
+// ============================================================================
+
+// A pool keeps up to size ready instances of a prototype plugin, created like
+// rack_vst3_plugin_clone() from the prototype's state and settings at the
+// time the pool was created. A background thread refills the pool whenever
+// an instance is taken, so creating, initializing and activating a plugin
+// (often 50-500 ms) happens ahead of time and acquire takes microseconds.
+// Spare instances are active but never processed.
+// The pool keeps the module loaded; the prototype may be freed afterwards.
+// Returns NULL on error
+// Thread-safety: Not realtime-safe; same rules for prototype as clone()
+RackVST3Pool* rack_vst3_pool_new(RackVST3Plugin* prototype, uint32_t size);
+
+// Stop refilling and free the pool's spare instances
+// Instances already acquired stay valid.
+// Thread-safety: Waits for an instance being created by the pool
+void rack_vst3_pool_free(RackVST3Pool* pool);
+
+// Take a ready instance out of the pool (free with rack_vst3_plugin_free)
+// Never waits for an instance to be created.
+// Returns NULL if the pool is empty (still refilling, or creating instances
+// failed; a failed creation is retried after each acquire)
+// Thread-safety: Thread-safe. Takes a short lock; not for the audio thread.
+RackVST3Plugin* rack_vst3_pool_acquire(RackVST3Pool* pool);
+
+// Number of ready instances, or negative error code
+// Thread-safety: Thread-safe.
+int rack_vst3_pool_available(RackVST3Pool* pool);
+
 // Initialize plugin
 // Returns 0 on success, negative error code on failure
 int rack_vst3_plugin_initialize(RackVST3Plugin* plugin, double sample_rate, uint32_t max_block_size);
@@ -128,7 +251,8 @@ int rack_vst3_plugin_get_output_channels(RackVST3Plugin* plugin);
 // num_input_channels: number of input channels
 // outputs: array of output channel pointers (e.g., [left_ptr, right_ptr] for stereo)
 // num_output_channels: number of output channels
-// frames: number of frames to process
+// frames: number of frames to process (at most max_block_size; see
+//         rack_vst3_plugin_process_split() for longer buffers)
 //
 // Channel Layout Examples:
 //   Mono:   inputs = [mono_ptr], num_input_channels = 1
@@ -145,6 +269,200 @@ int rack_vst3_plugin_process(
     uint32_t frames
 );
 
+// Process a buffer of any length (planar format, same layout as process())
+// Buffers up to max_block_size frames go straight to process(). Longer ones
+// are split into max_block_size sub-blocks, and the MIDI and automation
+// queued for the call are routed to the sub-block containing their sample
+// offset, rebased to it. An automation ramp crossing a sub-block boundary
+// gets an interpolated point at the boundary, so it stays the same ramp.
+// Events and points past the end of the buffer land on its last frame.
+//
+// Returns 0 on success, or the first sub-block's error code (the remaining
+// sub-blocks are still processed)
+// Thread-safety: Same as process(). Realtime-safe (no allocation or locking).
+int rack_vst3_plugin_process_split(
+    RackVST3Plugin* plugin,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames
+);
+
+// Process double-precision audio (same layout and rules as process())
+// Runs the plugin at 64 bits without conversion when it was set up with
+// rack_vst3_plugin_set_double_precision() and supports kSample64 (see
+// rack_vst3_plugin_get_sample_size()). Otherwise the block is converted to
+// float and back around the plugin. process() on a 64-bit plugin converts
+// the other way, so a host should use the entry point matching its engine.
+//
+// Returns 0 on success, negative error code on failure
+// Thread-safety: Same as process(). Realtime-safe (no allocation or locking).
+int rack_vst3_plugin_process_f64(
+    RackVST3Plugin* plugin,
+    const double* const* inputs,
+    uint32_t num_input_channels,
+    double* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames
+);
+
+// process_split() for double-precision buffers of any length
+int rack_vst3_plugin_process_split_f64(
+    RackVST3Plugin* plugin,
+    const double* const* inputs,
+    uint32_t num_input_channels,
+    double* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames
+);
+
+// Processing mode (values match Steinberg::Vst::ProcessModes)
+typedef enum {
+    RACK_VST3_PROCESS_MODE_REALTIME = 0,  // Default: live playback
+    RACK_VST3_PROCESS_MODE_PREFETCH = 1,  // Disk-streaming/look-ahead playback
+    RACK_VST3_PROCESS_MODE_OFFLINE = 2    // Bounce/export, not tied to realtime
+} RackVST3ProcessMode;
+
+// Set the processing mode reported to the plugin (ProcessSetup::processMode)
+// In OFFLINE mode plugins may switch to higher-quality, non-realtime
+// algorithms, and the host may run them faster than realtime.
+// Before initialize() the mode is simply recorded. Afterwards the plugin is
+// briefly deactivated so the new ProcessSetup can be applied.
+//
+// Returns:
+//   0 (RACK_VST3_OK) on success
+//   RACK_VST3_ERROR_NOT_SUPPORTED if the plugin rejected the mode (the
+//     previous mode stays active)
+//   negative error code on failure
+//
+// Thread-safety: Non-realtime. Must not be called concurrently with process().
+int rack_vst3_plugin_set_process_mode(RackVST3Plugin* plugin, RackVST3ProcessMode mode);
+
+// Ask for 64-bit (kSample64) processing
+// The plugin runs at 64 bits only if it reports canProcessSampleSize(kSample64);
+// otherwise it stays at 32 bits and process_f64() converts. Before
+// initialize() the request is recorded (create instances with
+// rack_vst3_plugins_new_parallel() and max_block_size 0 to set it first).
+// Afterwards the plugin is briefly deactivated to apply the new setup.
+//
+// Returns 0 on success (check get_sample_size() for the outcome), or
+//   negative error code on failure
+// Thread-safety: Non-realtime. Must not be called concurrently with process().
+int rack_vst3_plugin_set_double_precision(RackVST3Plugin* plugin, int enabled);
+
+// Sample size the plugin processes at
+// Returns 32 or 64, or RACK_VST3_ERROR_NOT_INITIALIZED before initialize()
+int rack_vst3_plugin_get_sample_size(RackVST3Plugin* plugin);
+
+// Tail length reported by plugins that ring forever (VST3 kInfiniteTail)
+#define RACK_VST3_TAIL_INFINITE 0xFFFFFFFFu
+
+// Get the plugin's processing latency and tail, for delay compensation
+// Queries IAudioProcessor::getLatencySamples/getTailSamples and caches the
+// result. Call again whenever rack_vst3_plugin_get_latency_generation()
+// changes, e.g. after the plugin reports restartComponent(kLatencyChanged).
+// latency_samples: output delay in samples (may be NULL)
+// tail_samples: samples of output after the input goes silent, or
+//               RACK_VST3_TAIL_INFINITE (may be NULL)
+//
+// Returns 0 on success, RACK_VST3_ERROR_NOT_INITIALIZED before
+//   initialize(), or negative error code on failure
+// Thread-safety: Non-realtime (the plugin is queried on the calling thread).
+int rack_vst3_plugin_get_latency(RackVST3Plugin* plugin, uint32_t* latency_samples, uint32_t* tail_samples);
+
+// Counter that advances whenever the latency or tail changes: when the
+// plugin announces a latency change, or get_latency() finds new values
+// Returns the current generation (0 for NULL)
+// Thread-safety: Realtime-safe (one atomic load). Poll it from the audio
+// thread and call get_latency() from a control thread when it moves.
+uint32_t rack_vst3_plugin_get_latency_generation(RackVST3Plugin* plugin);
+
+// Render a buffer of any length (planar format, same layout as process())
+// Splits the buffers into max_block_size chunks and processes them in order,
+// so the transport sample position stays continuous across chunks. MIDI and
+// parameter points queued beforehand are routed to the chunk containing
+// their sample offset, as in process_split().
+// Typically used together with RACK_VST3_PROCESS_MODE_OFFLINE.
+//
+// total_frames: frames per channel in inputs/outputs
+//
+// Returns 0 on success, negative error code on failure (from the failing chunk)
+// Thread-safety: Same as process(). Not realtime-safe.
+int rack_vst3_plugin_render_offline(
+    RackVST3Plugin* plugin,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint64_t total_frames
+);
+
+// Enable or disable idle sleep (disabled by default)
+// process() always reports silent input channels to the plugin via
+// silenceFlags. With idle sleep enabled it also stops calling into the
+// plugin once the input has been digital silence, with no MIDI or parameter
+// changes, for longer than the plugin's tail plus latency
+// (IAudioProcessor::getTailSamples/getLatencySamples) and the plugin's last
+// output was silent. While asleep, outputs are zero-filled. The plugin wakes
+// on the first non-silent input, MIDI event or parameter change, and after
+// reset, preset or state loads. Plugins reporting an infinite tail never sleep.
+// Returns 0 on success, negative error code on failure
+// Thread-safety: May be called from any thread.
+int rack_vst3_plugin_set_idle_sleep(RackVST3Plugin* plugin, int enabled);
+
+// Get the number of blocks the plugin processed and skipped while asleep
+// Either output pointer may be NULL.
+// Returns 0 on success, negative error code on failure
+// Thread-safety: May be called from any thread (counters are approximate
+// while process() runs).
+int rack_vst3_plugin_get_block_counts(RackVST3Plugin* plugin, uint64_t* processed, uint64_t* skipped);
+
+// Process-time histogram size of RackVST3PluginStats
+#define RACK_VST3_STATS_HISTOGRAM_BUCKETS 32
+
+// Processing statistics of one instance. Times cover whole process*()
+// calls (one call of process_split() counts once), measured with the CPU
+// cycle counter; the block deadline of a call is frames / sample rate.
+typedef struct {
+    uint64_t process_calls;          // Timed process*() calls
+    uint64_t frames;                 // Frames rendered by those calls
+    uint64_t total_ns;               // Time spent in them
+    uint64_t max_ns;                 // Slowest call
+    uint64_t deadline_ns;            // Sum of their block deadlines
+    uint64_t deadline_misses;        // Calls slower than their block deadline
+    double max_load;                 // Largest call time / block deadline
+    double average_load;             // total_ns / deadline_ns
+    uint64_t process_errors;         // Blocks where the plugin's process() failed
+    uint64_t dropped_midi_events;    // Events send_midi() could not queue
+    uint64_t dropped_param_changes;  // GUI parameter changes dropped (see get_param_change_overflows)
+    uint64_t histogram[RACK_VST3_STATS_HISTOGRAM_BUCKETS];  // Bucket i: calls taking [2^i, 2^(i+1)) ns
+} RackVST3PluginStats;
+
+// Get the instance's processing statistics since creation or the last
+// reset_stats()
+// Returns 0 on success, RACK_VST3_ERROR_NOT_SUPPORTED if rack-sys was built
+// with RACK_PERF_COUNTERS=0 (stats are then zeroed), negative error code on
+// failure
+// Thread-safety: May be called from any thread; meant for monitoring
+// threads polling while process() runs (fields are read one by one, so a
+// block in flight may be counted partially).
+int rack_vst3_plugin_get_stats(RackVST3Plugin* plugin, RackVST3PluginStats* stats);
+
+// Zero the statistics. Timing counters are cleared by the next process()
+// call, so a snapshot taken in between still shows the old values.
+// Returns 0 on success, negative error code on failure
+// Thread-safety: May be called from any thread.
+int rack_vst3_plugin_reset_stats(RackVST3Plugin* plugin);
+
+// Lock the instance's preallocated processing buffers into RAM through a
+// realtime context (see rack_rt.h); they stay locked until the context is
+// left. Call after initialize(), and again after re-initializing.
+// Returns 0 on success (or if ctx doesn't lock memory), negative error code
+// on failure
+// Thread-safety: Not realtime-safe; call before processing starts
+int rack_vst3_plugin_lock_memory(RackVST3Plugin* plugin, RackRtContext* ctx);
+
 // Get parameter count
 // Thread-safety: Read-only after initialization. Safe to call from any thread.
 int rack_vst3_plugin_parameter_count(RackVST3Plugin* plugin);
@@ -159,9 +477,52 @@ int rack_vst3_plugin_get_parameter(RackVST3Plugin* plugin, uint32_t index, float
 // Returns 0 on success, negative error code on failure
 // Thread-safety: Can be called from any thread, but the same plugin instance
 // must not be accessed concurrently.
-// Note: Calling during audio processing may cause clicks/pops.
+// The change reaches the processor at sample offset 0 of the next process()
+// call. After initialization the controller side is deferred until
+// rack_vst3_plugin_flush_param_updates() (or get_parameter) runs.
 int rack_vst3_plugin_set_parameter(RackVST3Plugin* plugin, uint32_t index, float value);
 
+// Automation point for rack_vst3_plugin_queue_param_points()
+typedef struct {
+    uint32_t param_index;    // Parameter index (0 to parameter_count - 1)
+    uint32_t sample_offset;  // Offset within the next process() call
+    float value;             // Normalized value (0.0 to 1.0)
+} RackVST3ParamPoint;
+
+// Queue sample-accurate automation points for the next process() call
+// Points may arrive in any order and may share a parameter; each parameter
+// keeps its points sorted by offset, and a later point at the same offset
+// replaces the earlier one. Values are clamped to 0.0-1.0. Offsets past the
+// end of the next block land on its last frame (process_split() routes them
+// to later sub-blocks instead). Points with an invalid index, or that do not fit the
+// preallocated queues (64 points per parameter, 1024 parameters per block),
+// are dropped.
+// Returns number of points queued, or negative error code on failure
+// Thread-safety: Realtime-safe (no allocation or locking). Call from the audio
+// thread between process() calls.
+int rack_vst3_plugin_queue_param_points(
+    RackVST3Plugin* plugin,
+    const RackVST3ParamPoint* points,
+    uint32_t count
+);
+
+// Apply controller-side updates deferred by set_parameter/queue_param_points
+// Keeps the edit controller (and its GUI) in step with automation. Plugins
+// are free to do non-realtime work in setParamNormalized, so this belongs on
+// a UI or worker thread rather than the audio thread.
+// Returns 0 on success, negative error code on failure
+// Thread-safety: Call from a non-realtime thread. Must not run concurrently
+// with other controller access on the same plugin.
+int rack_vst3_plugin_flush_param_updates(RackVST3Plugin* plugin);
+
+// Map a native VST3 ParamID to its parameter index
+// Uses a hash table built at initialize(), so this is O(1) even for plugins
+// with thousands of parameters.
+// Returns parameter index (>= 0), RACK_VST3_ERROR_NOT_FOUND if the ID is
+// unknown, or another negative error code on failure
+// Thread-safety: Read-only after initialization. Realtime-safe.
+int rack_vst3_plugin_param_index_for_id(RackVST3Plugin* plugin, uint32_t param_id);
+
 // Get parameter info
 // name: output buffer for parameter name (allocated by caller)
 // name_size: size of name buffer
@@ -233,6 +594,18 @@ int rack_vst3_plugin_get_state_size(RackVST3Plugin* plugin);
 // Thread-safety: Should be called from the same thread that owns the plugin instance.
 int rack_vst3_plugin_get_state(RackVST3Plugin* plugin, uint8_t* data, size_t* size);
 
+// Serialize the plugin state once into a plugin-owned buffer
+// Cheaper than get_state_size + get_state for frequent snapshots (autosave,
+// undo): the state is serialized a single time, and the buffer is reused
+// between calls, so steady-state snapshots don't allocate.
+// On success *data/*size describe the state (same format as get_state).
+// The data stays valid until the next get_state_size, get_state,
+// snapshot_state or set_state call on this plugin, or until it is freed.
+// Passing it straight back to set_state is allowed.
+// Returns 0 on success, negative error code on failure
+// Thread-safety: Should be called from the same thread that owns the plugin instance.
+int rack_vst3_plugin_snapshot_state(RackVST3Plugin* plugin, const uint8_t** data, size_t* size);
+
 // Set plugin state (restore full state including parameters, preset, etc.)
 // data: state data (from previous get_state call)
 // size: size of state data in bytes
@@ -240,6 +613,61 @@ int rack_vst3_plugin_get_state(RackVST3Plugin* plugin, uint8_t* data, size_t* si
 // Thread-safety: Should be called from the same thread that owns the plugin instance.
 int rack_vst3_plugin_set_state(RackVST3Plugin* plugin, const uint8_t* data, size_t size);
 
+// ============================================================================
+// Asynchronous State Loading
+// ============================================================================
+
+// Returned by state_load_status while a load is still running
+#define RACK_VST3_STATE_LOAD_PENDING 1
+
+// Called on the loader thread when an asynchronous load has finished
+// result: 0 on success, negative error code on failure
+// The callback must not start another load or free the plugin.
+typedef void (*RackVST3StateLoadCallback)(void* user_data, int result);
+
+// Restore state on a background thread without stalling process()
+// Same data as set_state; it is copied, so the caller may free it on return.
+// Until the load completes, process() passes input straight to the output
+// (extra output channels are zeroed) and keeps queued MIDI for later.
+// Parameter values changed by the load reach the processor at the start of
+// the first block after it.
+// callback: optional, may be NULL (poll with state_load_status instead)
+// Returns 0 if the load was started, RACK_VST3_ERROR_BUSY if one is
+// already pending, negative error code on failure
+// While a load is pending, the blocking state and preset functions return
+// RACK_VST3_ERROR_BUSY (get_state_size returns 0).
+// Thread-safety: Should be called from the same thread that owns the plugin
+// instance. process() may keep running on the audio thread meanwhile; don't
+// call initialize, reset or set_process_mode until the load has finished.
+int rack_vst3_plugin_set_state_async(
+    RackVST3Plugin* plugin,
+    const uint8_t* data,
+    size_t size,
+    RackVST3StateLoadCallback callback,
+    void* user_data
+);
+
+// Load a factory preset on a background thread (see set_state_async)
+// preset_number: the preset number from get_preset_info()
+// Returns 0 if the load was started, negative error code on failure
+// Thread-safety: Same as set_state_async.
+int rack_vst3_plugin_load_preset_async(
+    RackVST3Plugin* plugin,
+    int32_t preset_number,
+    RackVST3StateLoadCallback callback,
+    void* user_data
+);
+
+// Returns RACK_VST3_STATE_LOAD_PENDING while a load is running, otherwise
+// the result of the last asynchronous load (0 if none was started)
+// Thread-safety: Safe to call from any thread.
+int rack_vst3_plugin_state_load_status(RackVST3Plugin* plugin);
+
+// Block until the pending asynchronous load (if any) has finished
+// Returns the result of the last asynchronous load
+// Thread-safety: Should be called from the same thread that owns the plugin instance.
+int rack_vst3_plugin_wait_state_load(RackVST3Plugin* plugin);
+
 // ============================================================================
 // MIDI API
 // ============================================================================
@@ -274,9 +702,17 @@ typedef struct {
 //       these non-native event types. If a plugin doesn't respond to Program Change,
 //       Channel Aftertouch, or Pitch Bend, it's a limitation of the plugin itself.
 //
+// Events go into a lock-free queue (1024 events) that the next process()
+// call drains and sorts by sample_offset. If the whole batch does not fit,
+// nothing is queued and RACK_VST3_ERROR_GENERIC is returned.
+//
 // Returns 0 on success, negative error code on failure
-// Thread-safety: Should be called from the same thread that owns the plugin instance.
-// Not safe to call concurrently with process() or other plugin operations.
+// Thread-safety: Single producer. At most one thread may be inside
+// send_midi() at a time; it may run concurrently with process() (which is
+// the consumer). The queue is a single-producer ring, so concurrent
+// send_midi() calls from several threads (e.g. UI, network and sequencer)
+// corrupt it without any error being reported: serialize them in the host,
+// or funnel them through one thread.
 int rack_vst3_plugin_send_midi(
     RackVST3Plugin* plugin,
     const RackVST3MidiEvent* events,
@@ -326,10 +762,23 @@ int rack_vst3_gui_is_visible(RackVST3Gui* gui);
 int rack_vst3_gui_get_size(RackVST3Gui* gui, uint32_t* width, uint32_t* height);
 
 // Process pending GUI events (call regularly from main thread)
+// Handles X11 events and runs the plugin's IRunLoop fd and timer handlers
+// that are ready, without blocking.
 // Returns number of events processed, or negative error code
 // Thread-safety: Must be called from the main thread
 int rack_vst3_gui_pump_events(RackVST3Gui* gui);
 
+// Get a file descriptor for event-driven GUI hosting
+// The fd becomes readable when the X11 connection, a plugin-registered fd or
+// a plugin timer needs servicing; add it to the host's poll/epoll loop and
+// call rack_vst3_gui_pump_events() when it fires instead of pumping on a
+// fixed interval. Also pump once after other GUI calls (show, hide), since
+// Xlib may already have read their events off the connection.
+// Returns fd (owned by the GUI, do not close), or negative error code
+// (RACK_VST3_ERROR_NOT_SUPPORTED on Windows)
+// Thread-safety: Can be called from any thread after creation
+int rack_vst3_gui_get_fd(RackVST3Gui* gui);
+
 // Get X11 window ID (for embedding in host UI)
 // Returns window ID or 0 if not available
 // Thread-safety: Can be called from any thread after creation
@@ -348,11 +797,13 @@ void* rack_vst3_plugin_get_edit_controller(RackVST3Plugin* plugin);
 // Parameter change event (for changes originating from plugin GUI)
 typedef struct {
     uint32_t param_id;      // Parameter ID
+    int32_t param_index;    // Parameter index, or -1 if the ID is not in the parameter list
     double value;           // Normalized value (0.0 to 1.0)
 } RackVST3ParamChange;
 
 // Get parameter changes from plugin GUI since last call
 // This allows the host to sync with parameter changes made by user in plugin GUI.
+// Each parameter appears at most once, with its latest value.
 //
 // changes: output array for parameter changes (allocated by caller)
 // max_changes: maximum number of changes to return
@@ -362,7 +813,7 @@ typedef struct {
 //   RackVST3ParamChange changes[64];
 //   int count = rack_vst3_plugin_get_param_changes(plugin, changes, 64);
 //   for (int i = 0; i < count; i++) {
-//       // Handle parameter change: changes[i].param_id, changes[i].value
+//       // Handle parameter change: changes[i].param_index, changes[i].value
 //   }
 //
 // Thread-safety: Should be called from the main thread, not during process()
@@ -372,6 +823,24 @@ int rack_vst3_plugin_get_param_changes(
     uint32_t max_changes
 );
 
+// Get the number of GUI parameter changes dropped so far
+// Repeated edits to one parameter coalesce (last value wins) while pending,
+// so this only grows if more than 1024 distinct parameters change between
+// polls, or more than 4096 distinct parameters are ever edited.
+// Returns cumulative drop count (0 if the plugin has no component handler)
+// Thread-safety: Can be called from any thread
+uint64_t rack_vst3_plugin_get_param_change_overflows(RackVST3Plugin* plugin);
+
+// Get a file descriptor that is readable while GUI parameter changes are pending
+// Add it to the host's poll/epoll loop and call
+// rack_vst3_plugin_get_param_changes() when it fires, instead of polling.
+// The fd stays readable until get_param_changes() has returned every pending
+// change; only read it through that call.
+// Returns fd (owned by the plugin, do not close), or negative error code
+// (RACK_VST3_ERROR_NOT_SUPPORTED on Windows or without a component handler)
+// Thread-safety: Can be called from any thread
+int rack_vst3_plugin_get_param_change_fd(RackVST3Plugin* plugin);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,21 +1,57 @@
 #include "rack_au.h"
+#include "param_index_map.h"
+#include "spsc_queue.h"
+#include "silence_gate.h"
+#include "latency_monitor.h"
+#include "perf_counters.h"
+#include "rt_guard.h"
 #include <AudioToolbox/AudioToolbox.h>
 #include <CoreFoundation/CoreFoundation.h>
 #include <cstring>
 #include <cstdio>  // for sscanf
 #include <climits> // for INT_MAX
 #include <new>     // for std::align_val_t
+#include <atomic>
 #include <mutex>
-
-// Global mutex to serialize AudioUnit LIFECYCLE operations only
-// Protects: AudioComponentInstanceNew, AudioUnitInitialize, AudioUnitUninitialize, AudioComponentInstanceDispose
-// NOT for runtime operations: AudioUnitReset, AudioUnitSetParameter, AudioUnitRender, etc.
-// Rationale: Apple's framework has race conditions in instance management, not in runtime state operations
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <thread>
+#include <condition_variable>
+#include <system_error>
+
+// AudioUnit LIFECYCLE serialization (NOT for runtime operations such as
+// AudioUnitReset, AudioUnitSetParameter, AudioUnitRender, etc.)
+//
+// Global mutex: AudioComponentInstanceNew and AudioComponentInstanceDispose.
+// Rationale: Apple's framework has race conditions in instance management
+// (the shared component registry), not in runtime state operations.
 static std::mutex g_audio_unit_cleanup_mutex;
 
+// Per-component mutexes: AudioUnitInitialize and AudioUnitUninitialize.
+// Instances of one component are set up one at a time, since they may share
+// state inside the plugin's bundle; different components initialize in
+// parallel. Entries live for the whole process (one per component used).
+static std::mutex g_component_locks_mutex;
+static std::unordered_map<AudioComponent, std::unique_ptr<std::mutex>> g_component_locks;
+
+static std::mutex* component_lock(AudioComponent component) {
+    std::lock_guard<std::mutex> lock(g_component_locks_mutex);
+    auto& entry = g_component_locks[component];
+    if (!entry) {
+        entry.reset(new std::mutex());
+    }
+    return entry.get();
+}
+
+// Maximum MIDI events queued between two process() calls
+static constexpr size_t MIDI_QUEUE_CAPACITY = 1024;
+
 // Internal plugin state
 struct RackAUPlugin {
     AudioComponentInstance audio_unit;
+    std::mutex* lifecycle_lock;  // Shared by instances of the same component
     bool initialized;
     double sample_rate;
     uint32_t max_block_size;
@@ -25,6 +61,10 @@ struct RackAUPlugin {
     AudioBufferList* input_buffer_list;
     AudioBufferList* output_buffer_list;
 
+    // Sub-block channel pointers for process_split (sized in initialize)
+    std::vector<const float*> split_inputs;
+    std::vector<float*> split_outputs;
+
     // Channel configuration (queried from AudioUnit during initialize)
     uint32_t input_channels;
     uint32_t output_channels;
@@ -36,6 +76,33 @@ struct RackAUPlugin {
     AudioUnitParameterID* parameter_ids;
     AudioUnitParameterInfo* parameter_info;  // Cached parameter info for performance
     UInt32 parameter_count;
+
+    // AudioUnitParameterID -> index into parameter_ids (built with the cache)
+    rack::ParamIndexMap param_index_map;
+
+    // MIDI from send_midi() (status already combined with channel), delivered
+    // to the AudioUnit by process() right before rendering
+    rack::SpscQueue<RackAUMidiEvent, MIDI_QUEUE_CAPACITY> midi_queue;
+    RackAUMidiEvent midi_scratch[MIDI_QUEUE_CAPACITY];
+
+    // Idle sleep and silence reporting (see rack_au_plugin_set_idle_sleep).
+    // input_silent is set by process() for input_render_callback.
+    rack::SilenceGate silence_gate;
+    bool input_silent;
+
+    // Data of the last rack_au_plugin_snapshot_state call (owned)
+    CFDataRef state_snapshot;
+
+    // Input renders that handed the caller's buffers to the AudioUnit
+    // directly, and renders that had to copy into the unit's own buffers
+    std::atomic<uint64_t> input_zero_copy_renders;
+    std::atomic<uint64_t> input_copied_renders;
+
+    // Latency and tail in samples; the property listener marks changes
+    rack::LatencyMonitor latency;
+
+    // Rendering statistics (rack_au_plugin_get_stats)
+    rack::PerfCounters perf;
 };
 
 // ============================================================================
@@ -77,7 +144,10 @@ static const char* parameter_unit_to_string(AudioUnitParameterUnit unit) {
 }
 
 // Render callback: provides input audio to the AudioUnit
-// Now works with planar data (no interleave/deinterleave conversion needed)
+// Now works with planar data (no interleave/deinterleave conversion needed).
+// When the unit leaves a buffer's mData NULL it is asking the host for the
+// memory, so the caller's buffer is handed through without copying; units
+// that insist on their own buffers get a copy (counted per render).
 static OSStatus input_render_callback(
     void* inRefCon,
     AudioUnitRenderActionFlags* ioActionFlags,
@@ -105,24 +175,84 @@ static OSStatus input_render_callback(
                               : plugin->input_buffer_list->mNumberBuffers;
 
     const UInt32 required_bytes = inNumberFrames * sizeof(float);
+    bool copied = false;
     for (UInt32 ch = 0; ch < num_channels; ch++) {
-        if (ioData->mBuffers[ch].mData &&
-            ioData->mBuffers[ch].mDataByteSize >= required_bytes &&
-            plugin->input_buffer_list->mBuffers[ch].mData) {
+        void* src = plugin->input_buffer_list->mBuffers[ch].mData;
+        AudioBuffer& dest = ioData->mBuffers[ch];
+        if (!src) {
+            continue;
+        }
 
+        if (!dest.mData) {
+            // Zero-copy: the unit reads straight from the caller's buffer
+            dest.mData = src;
+            dest.mDataByteSize = required_bytes;
+        } else if (dest.mData != src && dest.mDataByteSize >= required_bytes) {
             // Safety: This memcpy is safe because:
-            // 1. inNumberFrames validated at lines 95-98 to not exceed max_block_size
-            // 2. mData points to caller's buffer (validated in Rust to have ≥max_block_size frames)
+            // 1. inNumberFrames validated above to not exceed max_block_size
+            // 2. src points to caller's buffer (validated in Rust to have ≥max_block_size frames)
             // 3. Channel count validated in Rust process() before reaching here
-            const float* src = static_cast<const float*>(plugin->input_buffer_list->mBuffers[ch].mData);
-            float* dest = static_cast<float*>(ioData->mBuffers[ch].mData);
-            memcpy(dest, src, required_bytes);
+            memcpy(dest.mData, src, required_bytes);
+            copied = true;
         }
     }
 
+    if (copied) {
+        plugin->input_copied_renders.fetch_add(1, std::memory_order_relaxed);
+    } else if (num_channels > 0) {
+        plugin->input_zero_copy_renders.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Let the AudioUnit skip work on digital silence (it may ignore the hint)
+    if (plugin->input_silent) {
+        *ioActionFlags |= kAudioUnitRenderAction_OutputIsSilence;
+    }
+
     return noErr;
 }
 
+// A global-scope time property in seconds (0 if unsupported or negative)
+static Float64 global_seconds_property(RackAUPlugin* plugin, AudioUnitPropertyID property) {
+    Float64 seconds = 0.0;
+    UInt32 size = sizeof(Float64);
+    if (AudioUnitGetProperty(plugin->audio_unit, property,
+                             kAudioUnitScope_Global, 0, &seconds, &size) != noErr) {
+        return 0.0;
+    }
+    return seconds > 0.0 ? seconds : 0.0;
+}
+
+static uint64_t seconds_to_samples(RackAUPlugin* plugin, Float64 seconds) {
+    return static_cast<uint64_t>(seconds * plugin->sample_rate + 0.5);
+}
+
+// Samples the AudioUnit may keep producing after its input goes silent:
+// kAudioUnitProperty_TailTime plus kAudioUnitProperty_Latency (both seconds).
+// Units that don't report a tail are assumed to have none.
+static uint64_t plugin_tail_samples(RackAUPlugin* plugin) {
+    return seconds_to_samples(plugin, global_seconds_property(plugin, kAudioUnitProperty_TailTime) +
+                                      global_seconds_property(plugin, kAudioUnitProperty_Latency));
+}
+
+// Re-query latency and tail (in samples) into the cache
+static void refresh_latency(RackAUPlugin* plugin) {
+    uint64_t latency = seconds_to_samples(plugin, global_seconds_property(plugin, kAudioUnitProperty_Latency));
+    uint64_t tail = seconds_to_samples(plugin, global_seconds_property(plugin, kAudioUnitProperty_TailTime));
+    plugin->latency.update(static_cast<uint32_t>(std::min<uint64_t>(latency, UINT32_MAX)),
+                           static_cast<uint32_t>(std::min<uint64_t>(tail, UINT32_MAX)));
+}
+
+// kAudioUnitProperty_Latency/TailTime listener; runs on whatever thread the
+// unit changes the property from
+static void latency_property_listener(void* ref, AudioUnit unit, AudioUnitPropertyID property,
+                                      AudioUnitScope scope, AudioUnitElement element) {
+    (void)unit;
+    (void)property;
+    (void)scope;
+    (void)element;
+    static_cast<RackAUPlugin*>(ref)->latency.mark_changed();
+}
+
 // Parse unique_id format: "type-subtype-manufacturer" (all hex)
 // Example: "61756678-64796e78-4170706c" (aufx-dynx-Appl)
 static bool parse_unique_id(const char* unique_id, AudioComponentDescription* desc) {
@@ -146,13 +276,11 @@ static bool parse_unique_id(const char* unique_id, AudioComponentDescription* de
     return true;
 }
 
-RackAUPlugin* rack_au_plugin_new(const char* unique_id) {
-    if (!unique_id) {
-        return nullptr;
-    }
-
+// Create an instance of component (rack_au_plugin_new, clone and pools)
+static RackAUPlugin* new_instance(AudioComponent component, const char* unique_id) {
     RackAUPlugin* plugin = new RackAUPlugin();
     plugin->audio_unit = nullptr;
+    plugin->lifecycle_lock = nullptr;
     plugin->initialized = false;
     plugin->sample_rate = 0.0;
     plugin->max_block_size = 0;
@@ -161,25 +289,17 @@ RackAUPlugin* rack_au_plugin_new(const char* unique_id) {
     plugin->input_channels = 0;
     plugin->output_channels = 0;
     plugin->sample_position = 0;
+    plugin->input_silent = false;
+    plugin->state_snapshot = nullptr;
+    plugin->input_zero_copy_renders.store(0, std::memory_order_relaxed);
+    plugin->input_copied_renders.store(0, std::memory_order_relaxed);
     plugin->parameter_ids = nullptr;
     plugin->parameter_info = nullptr;
     plugin->parameter_count = 0;
     strncpy(plugin->unique_id, unique_id, sizeof(plugin->unique_id) - 1);
     plugin->unique_id[sizeof(plugin->unique_id) - 1] = '\0';
 
-    // Parse unique_id to get component description
-    AudioComponentDescription desc;
-    if (!parse_unique_id(unique_id, &desc)) {
-        delete plugin;
-        return nullptr;
-    }
-
-    // Find the AudioComponent
-    AudioComponent component = AudioComponentFindNext(nullptr, &desc);
-    if (!component) {
-        delete plugin;
-        return nullptr;
-    }
+    plugin->lifecycle_lock = component_lock(component);
 
     // Create the AudioComponentInstance
     // Serialize AudioComponent operations to avoid crashes in Apple's framework
@@ -193,19 +313,55 @@ RackAUPlugin* rack_au_plugin_new(const char* unique_id) {
         return nullptr;
     }
 
+    // Latency changes (e.g. a lookahead mode switch) are picked up by pollers
+    // of rack_au_plugin_get_latency_generation
+    AudioUnitAddPropertyListener(plugin->audio_unit, kAudioUnitProperty_Latency,
+                                 latency_property_listener, plugin);
+    AudioUnitAddPropertyListener(plugin->audio_unit, kAudioUnitProperty_TailTime,
+                                 latency_property_listener, plugin);
+
     return plugin;
 }
 
+RackAUPlugin* rack_au_plugin_new(const char* unique_id) {
+    if (!unique_id) {
+        return nullptr;
+    }
+
+    // Parse unique_id to get component description
+    AudioComponentDescription desc;
+    if (!parse_unique_id(unique_id, &desc)) {
+        return nullptr;
+    }
+
+    // Find the AudioComponent
+    AudioComponent component = AudioComponentFindNext(nullptr, &desc);
+    if (!component) {
+        return nullptr;
+    }
+
+    return new_instance(component, unique_id);
+}
+
 void rack_au_plugin_free(RackAUPlugin* plugin) {
     if (!plugin) {
         return;
     }
 
     if (plugin->audio_unit) {
-        // Serialize AudioUnit cleanup to avoid crashes in Apple's framework
+        AudioUnitRemovePropertyListenerWithUserData(plugin->audio_unit, kAudioUnitProperty_Latency,
+                                                    latency_property_listener, plugin);
+        AudioUnitRemovePropertyListenerWithUserData(plugin->audio_unit, kAudioUnitProperty_TailTime,
+                                                    latency_property_listener, plugin);
+
+        {
+            std::lock_guard<std::mutex> lock(*plugin->lifecycle_lock);
+            AudioUnitUninitialize(plugin->audio_unit);
+        }
+
+        // Serialize AudioUnit disposal to avoid crashes in Apple's framework
         // when multiple instances are being disposed concurrently
         std::lock_guard<std::mutex> lock(g_audio_unit_cleanup_mutex);
-        AudioUnitUninitialize(plugin->audio_unit);
         AudioComponentInstanceDispose(plugin->audio_unit);
     }
 
@@ -226,6 +382,10 @@ void rack_au_plugin_free(RackAUPlugin* plugin) {
         free(plugin->parameter_info);
     }
 
+    if (plugin->state_snapshot) {
+        CFRelease(plugin->state_snapshot);
+    }
+
     delete plugin;
 }
 
@@ -244,6 +404,7 @@ int rack_au_plugin_initialize(RackAUPlugin* plugin, double sample_rate, uint32_t
 
     plugin->sample_rate = sample_rate;
     plugin->max_block_size = max_block_size;
+    plugin->perf.set_sample_rate(sample_rate);
 
     // Default to stereo for compatibility - query actual config after initialization
     uint32_t channels = 2;
@@ -330,6 +491,8 @@ int rack_au_plugin_initialize(RackAUPlugin* plugin, double sample_rate, uint32_t
     // Store channel configuration
     plugin->input_channels = input_channels;
     plugin->output_channels = output_channels;
+    plugin->split_inputs.assign(input_channels, nullptr);
+    plugin->split_outputs.assign(output_channels, nullptr);
 
     // Allocate audio buffers for planar/non-interleaved format
     // Input buffer (for providing audio to effect plugins)
@@ -382,10 +545,23 @@ int rack_au_plugin_initialize(RackAUPlugin* plugin, double sample_rate, uint32_t
     // This may fail for instruments (no input), which is okay
     // We don't return error here
 
+    // Ask the unit not to allocate input buffers, so input_render_callback
+    // can lend it the caller's buffers. Units that refuse keep their own
+    // buffers and get a copy instead.
+    UInt32 should_allocate = 0;
+    AudioUnitSetProperty(
+        plugin->audio_unit,
+        kAudioUnitProperty_ShouldAllocateBuffer,
+        kAudioUnitScope_Input,
+        0,
+        &should_allocate,
+        sizeof(should_allocate)
+    );
+
     // Initialize the AudioUnit
-    // Serialize AudioUnit initialization to avoid crashes in Apple's framework
+    // Serialize initialization with other instances of this component
     {
-        std::lock_guard<std::mutex> lock(g_audio_unit_cleanup_mutex);
+        std::lock_guard<std::mutex> lock(*plugin->lifecycle_lock);
         status = AudioUnitInitialize(plugin->audio_unit);
     }
     if (status != noErr) {
@@ -470,6 +646,15 @@ int rack_au_plugin_initialize(RackAUPlugin* plugin, double sample_rate, uint32_t
         }
     }
 
+    if (plugin->parameter_ids) {
+        plugin->param_index_map.build(plugin->parameter_count,
+            [plugin](size_t i) { return static_cast<uint32_t>(plugin->parameter_ids[i]); });
+    } else {
+        plugin->param_index_map.clear();
+    }
+
+    refresh_latency(plugin);
+
     plugin->initialized = true;
     return RACK_AU_OK;
 }
@@ -494,32 +679,22 @@ int rack_au_plugin_reset(RackAUPlugin* plugin) {
         return RACK_AU_ERROR_AUDIO_UNIT + status;
     }
 
+    plugin->silence_gate.wake();
     return RACK_AU_OK;
 }
 
-int rack_au_plugin_process(
+// Render one block of at most max_block_size frames. midi holds the block's
+// events in time order, with offsets relative to the block.
+static int render_block(
     RackAUPlugin* plugin,
     const float* const* inputs,
     uint32_t num_input_channels,
     float* const* outputs,
     uint32_t num_output_channels,
-    uint32_t frames
+    uint32_t frames,
+    const RackAUMidiEvent* midi,
+    size_t midi_count
 ) {
-    if (!plugin || !plugin->initialized) {
-        return RACK_AU_ERROR_NOT_INITIALIZED;
-    }
-
-    if (!inputs || !outputs || frames == 0) {
-        return RACK_AU_ERROR_INVALID_PARAM;
-    }
-
-    if (frames > plugin->max_block_size) {
-        return RACK_AU_ERROR_INVALID_PARAM;
-    }
-
-    // Note: Channel count and pointer validation moved to Rust layer (public API)
-    // C++ trusts that Rust has validated inputs correctly
-
     // Zero-copy: point input buffer list directly at caller's buffers
     const uint32_t byte_size = frames * sizeof(float);
     for (uint32_t ch = 0; ch < num_input_channels; ch++) {
@@ -533,6 +708,33 @@ int rack_au_plugin_process(
         plugin->output_buffer_list->mBuffers[ch].mDataByteSize = byte_size;
     }
 
+    // Silent input is hinted to the AudioUnit via OutputIsSilence in the
+    // input callback; with idle sleep on, a unit whose tail has run out is
+    // not rendered at all
+    bool input_silent = false;
+    rack::silent_channel_mask(inputs, num_input_channels, frames, &input_silent);
+    plugin->input_silent = input_silent;
+
+    if (plugin->silence_gate.begin_block(input_silent, midi_count > 0,
+                                         [plugin]() { return plugin_tail_samples(plugin); })) {
+        for (uint32_t ch = 0; ch < num_output_channels; ch++) {
+            memset(outputs[ch], 0, byte_size);
+        }
+        plugin->sample_position += frames;
+        return RACK_AU_OK;
+    }
+
+    // Schedule the MIDI for this render cycle, in time order.
+    // Effects without MIDI support reject the call; those events are dropped.
+    if (midi_count > 0) {
+        for (size_t i = 0; i < midi_count; i++) {
+            const RackAUMidiEvent& event = midi[i];
+            // Clamp so late events land on the last frame instead of being lost
+            UInt32 offset = event.sample_offset < frames ? event.sample_offset : frames - 1;
+            MusicDeviceMIDIEvent(plugin->audio_unit, event.status, event.data1, event.data2, offset);
+        }
+    }
+
     // Set up AudioTimeStamp with running sample position
     AudioTimeStamp timestamp;
     memset(&timestamp, 0, sizeof(timestamp));
@@ -551,17 +753,374 @@ int rack_au_plugin_process(
     );
 
     if (status != noErr) {
+        plugin->perf.add_process_error();
         return RACK_AU_ERROR_AUDIO_UNIT + status;
     }
 
     // Zero-copy: AudioUnit already wrote directly to caller's output buffers
 
+    // The silence history only matters when idle sleep could use it
+    bool output_silent = false;
+    if (plugin->silence_gate.enabled() && input_silent && midi_count == 0) {
+        output_silent = (flags & kAudioUnitRenderAction_OutputIsSilence) != 0;
+        if (!output_silent) {
+            rack::silent_channel_mask(outputs, num_output_channels, frames, &output_silent);
+        }
+    }
+    plugin->silence_gate.end_block(output_silent, frames);
+
     // Update sample position for next call
     plugin->sample_position += frames;
 
     return RACK_AU_OK;
 }
 
+// Drain MIDI queued by send_midi() into midi_scratch in time order
+static size_t drain_midi_queue(RackAUPlugin* plugin) {
+    size_t count = plugin->midi_queue.pop_all(plugin->midi_scratch, MIDI_QUEUE_CAPACITY);
+    rack::sort_events(plugin->midi_scratch, count,
+        [](const RackAUMidiEvent& e) { return e.sample_offset; });
+    return count;
+}
+
+static int process_impl(
+    RackAUPlugin* plugin,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames
+) {
+    if (!plugin || !plugin->initialized) {
+        return RACK_AU_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!inputs || !outputs || frames == 0) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    if (frames > plugin->max_block_size) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    // Note: Channel count and pointer validation moved to Rust layer (public API)
+    // C++ trusts that Rust has validated inputs correctly
+
+    // Drain MIDI before deciding whether to render, so an event always wakes
+    // a sleeping plugin
+    size_t midi_count = drain_midi_queue(plugin);
+
+    return render_block(plugin, inputs, num_input_channels, outputs, num_output_channels,
+                        frames, plugin->midi_scratch, midi_count);
+}
+
+static int process_split_impl(
+    RackAUPlugin* plugin,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames
+) {
+    if (!plugin || !plugin->initialized || plugin->max_block_size == 0) {
+        return RACK_AU_ERROR_NOT_INITIALIZED;
+    }
+
+    if (frames <= plugin->max_block_size) {
+        return process_impl(plugin, inputs, num_input_channels, outputs, num_output_channels, frames);
+    }
+
+    if (!inputs || !outputs || num_input_channels > plugin->split_inputs.size() ||
+        num_output_channels > plugin->split_outputs.size()) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    // Every event goes to the sub-block containing its offset, rebased to it;
+    // render_block() puts events past the span on its last frame
+    RackAUMidiEvent* midi = plugin->midi_scratch;
+    size_t midi_count = drain_midi_queue(plugin);
+    size_t next_event = 0;
+
+    int result = RACK_AU_OK;
+    for (uint32_t start = 0; start < frames; ) {
+        uint32_t block = std::min(frames - start, plugin->max_block_size);
+        uint32_t end = start + block;
+
+        for (uint32_t ch = 0; ch < num_input_channels; ch++) {
+            plugin->split_inputs[ch] = inputs[ch] + start;
+        }
+        for (uint32_t ch = 0; ch < num_output_channels; ch++) {
+            plugin->split_outputs[ch] = outputs[ch] + start;
+        }
+
+        size_t first_event = next_event;
+        while (next_event < midi_count && (end == frames || midi[next_event].sample_offset < end)) {
+            midi[next_event++].sample_offset -= start;
+        }
+
+        int status = render_block(plugin, plugin->split_inputs.data(), num_input_channels,
+                                  plugin->split_outputs.data(), num_output_channels, block,
+                                  midi + first_event, next_event - first_event);
+        if (status != RACK_AU_OK && result == RACK_AU_OK) {
+            result = status;
+        }
+
+        start = end;
+    }
+
+    return result;
+}
+
+// Time one public process call for get_stats(). Calls rejected before
+// reaching the AudioUnit are not counted.
+// Every public process path goes through here, so this is also where the
+// FPU flushes denormals and RACK_RT_CHECKS watches for allocation.
+template <typename Process>
+static int timed_process(RackAUPlugin* plugin, uint32_t frames, Process&& process) {
+    if (!plugin) {
+        return RACK_AU_ERROR_NOT_INITIALIZED;
+    }
+    rack::ScopedFlushDenormals flush_denormals;
+    rack::RtCheckScope rt_check;
+    uint64_t start = plugin->perf.begin();
+    int result = process();
+    if (result != RACK_AU_ERROR_NOT_INITIALIZED && result != RACK_AU_ERROR_INVALID_PARAM) {
+        plugin->perf.end(start, frames);
+    }
+    return result;
+}
+
+int rack_au_plugin_process(
+    RackAUPlugin* plugin,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames
+) {
+    return timed_process(plugin, frames, [&]() {
+        return process_impl(plugin, inputs, num_input_channels, outputs, num_output_channels, frames);
+    });
+}
+
+int rack_au_plugin_process_split(
+    RackAUPlugin* plugin,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames
+) {
+    return timed_process(plugin, frames, [&]() {
+        return process_split_impl(plugin, inputs, num_input_channels, outputs, num_output_channels, frames);
+    });
+}
+
+int rack_au_plugin_set_idle_sleep(RackAUPlugin* plugin, int enabled) {
+    if (!plugin) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    plugin->silence_gate.set_enabled(enabled != 0);
+    plugin->silence_gate.wake();
+    return RACK_AU_OK;
+}
+
+int rack_au_plugin_get_block_counts(RackAUPlugin* plugin, uint64_t* processed, uint64_t* skipped) {
+    if (!plugin) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    if (processed) {
+        *processed = plugin->silence_gate.processed_blocks();
+    }
+    if (skipped) {
+        *skipped = plugin->silence_gate.skipped_blocks();
+    }
+    return RACK_AU_OK;
+}
+
+int rack_au_plugin_get_stats(RackAUPlugin* plugin, RackAUPluginStats* stats) {
+    if (!plugin || !stats) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    rack::PerfSnapshot snapshot;
+    plugin->perf.snapshot(snapshot);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->process_calls = snapshot.process_calls;
+    stats->frames = snapshot.frames;
+    stats->total_ns = snapshot.total_ns;
+    stats->max_ns = snapshot.max_ns;
+    stats->deadline_ns = snapshot.deadline_ns;
+    stats->deadline_misses = snapshot.deadline_misses;
+    stats->max_load = snapshot.max_load;
+    stats->average_load = snapshot.deadline_ns > 0
+        ? static_cast<double>(snapshot.total_ns) / static_cast<double>(snapshot.deadline_ns) : 0.0;
+    stats->process_errors = snapshot.process_errors;
+    stats->dropped_midi_events = snapshot.dropped_midi_events;
+    static_assert(RACK_AU_STATS_HISTOGRAM_BUCKETS == rack::PERF_HISTOGRAM_BUCKETS,
+                  "histogram size mismatch");
+    memcpy(stats->histogram, snapshot.histogram, sizeof(stats->histogram));
+
+    return RACK_PERF_COUNTERS ? RACK_AU_OK : RACK_AU_ERROR_NOT_SUPPORTED;
+}
+
+int rack_au_plugin_reset_stats(RackAUPlugin* plugin) {
+    if (!plugin) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    plugin->perf.reset();
+    return RACK_AU_OK;
+}
+
+int rack_au_plugin_lock_memory(RackAUPlugin* plugin, RackRtContext* ctx) {
+    if (!plugin || !ctx) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+    if (!plugin->initialized) {
+        return RACK_AU_ERROR_NOT_INITIALIZED;
+    }
+
+    // The instance holds the MIDI queue and scratch events; buffer lists
+    // and sub-block pointers were sized by initialize(). The AudioUnit's
+    // own render buffers are out of reach.
+    size_t input_list_size = offsetof(AudioBufferList, mBuffers[0]) + sizeof(AudioBuffer) * plugin->input_channels;
+    size_t output_list_size = offsetof(AudioBufferList, mBuffers[0]) + sizeof(AudioBuffer) * plugin->output_channels;
+    bool ok = rack_rt_context_lock_memory(ctx, plugin, sizeof(*plugin)) == RACK_RT_OK;
+    if (ok && plugin->input_buffer_list) {
+        ok = rack_rt_context_lock_memory(ctx, plugin->input_buffer_list, input_list_size) == RACK_RT_OK;
+    }
+    if (ok && plugin->output_buffer_list) {
+        ok = rack_rt_context_lock_memory(ctx, plugin->output_buffer_list, output_list_size) == RACK_RT_OK;
+    }
+    if (ok) {
+        ok = rack_rt_context_lock_memory(ctx, plugin->split_inputs.data(),
+                                         plugin->split_inputs.size() * sizeof(const float*)) == RACK_RT_OK &&
+             rack_rt_context_lock_memory(ctx, plugin->split_outputs.data(),
+                                         plugin->split_outputs.size() * sizeof(float*)) == RACK_RT_OK;
+    }
+    return ok ? RACK_AU_OK : RACK_AU_ERROR_GENERIC;
+}
+
+int rack_au_plugin_get_latency(RackAUPlugin* plugin, uint32_t* latency_samples, uint32_t* tail_samples) {
+    if (!plugin) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+    if (!plugin->initialized) {
+        return RACK_AU_ERROR_NOT_INITIALIZED;
+    }
+
+    refresh_latency(plugin);
+    if (latency_samples) {
+        *latency_samples = plugin->latency.latency();
+    }
+    if (tail_samples) {
+        *tail_samples = plugin->latency.tail();
+    }
+    return RACK_AU_OK;
+}
+
+uint32_t rack_au_plugin_get_latency_generation(RackAUPlugin* plugin) {
+    return plugin ? plugin->latency.generation() : 0;
+}
+
+int rack_au_plugin_get_input_copy_counts(RackAUPlugin* plugin, uint64_t* zero_copy, uint64_t* copied) {
+    if (!plugin) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    if (zero_copy) {
+        *zero_copy = plugin->input_zero_copy_renders.load(std::memory_order_relaxed);
+    }
+    if (copied) {
+        *copied = plugin->input_copied_renders.load(std::memory_order_relaxed);
+    }
+    return RACK_AU_OK;
+}
+
+int rack_au_plugin_set_offline_render(RackAUPlugin* plugin, int enabled) {
+    if (!plugin) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    if (!plugin->audio_unit) {
+        return RACK_AU_ERROR_NOT_INITIALIZED;
+    }
+
+    // The property may be changed before or after AudioUnitInitialize
+    UInt32 value = enabled ? 1 : 0;
+    OSStatus status = AudioUnitSetProperty(
+        plugin->audio_unit,
+        kAudioUnitProperty_OfflineRender,
+        kAudioUnitScope_Global,
+        0,
+        &value,
+        sizeof(value)
+    );
+
+    if (status != noErr) {
+        return RACK_AU_ERROR_AUDIO_UNIT + status;
+    }
+
+    return RACK_AU_OK;
+}
+
+int rack_au_plugin_render_offline(
+    RackAUPlugin* plugin,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint64_t total_frames
+) {
+    if (!plugin || !plugin->initialized || plugin->max_block_size == 0) {
+        return RACK_AU_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!inputs || !outputs) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    // Per-chunk channel pointers (render_offline is not a realtime call)
+    std::vector<const float*> chunk_inputs(num_input_channels);
+    std::vector<float*> chunk_outputs(num_output_channels);
+
+    // Spans of whole blocks; process_split() does the block splitting
+    const uint64_t span_limit = (uint64_t(UINT32_MAX) / plugin->max_block_size) * plugin->max_block_size;
+
+    uint64_t position = 0;
+    while (position < total_frames) {
+        uint64_t remaining = total_frames - position;
+        uint32_t frames = static_cast<uint32_t>(std::min(remaining, span_limit));
+
+        for (uint32_t ch = 0; ch < num_input_channels; ch++) {
+            chunk_inputs[ch] = inputs[ch] + position;
+        }
+        for (uint32_t ch = 0; ch < num_output_channels; ch++) {
+            chunk_outputs[ch] = outputs[ch] + position;
+        }
+
+        // process_split() advances sample_position, keeping timestamps
+        // continuous. It rejects NULL arrays, so channel-less sides keep the
+        // caller's.
+        int result = rack_au_plugin_process_split(
+            plugin,
+            num_input_channels ? chunk_inputs.data() : inputs, num_input_channels,
+            num_output_channels ? chunk_outputs.data() : outputs, num_output_channels,
+            frames);
+        if (result != RACK_AU_OK) {
+            return result;
+        }
+
+        position += frames;
+    }
+
+    return RACK_AU_OK;
+}
+
 int rack_au_plugin_parameter_count(RackAUPlugin* plugin) {
     if (!plugin || !plugin->initialized) {
         return 0;
@@ -712,6 +1271,15 @@ int rack_au_plugin_set_parameter(RackAUPlugin* plugin, uint32_t index, float val
     return RACK_AU_OK;
 }
 
+int rack_au_plugin_param_index_for_id(RackAUPlugin* plugin, uint32_t param_id) {
+    if (!plugin) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    int32_t index = plugin->param_index_map.find(param_id);
+    return index >= 0 ? index : RACK_AU_ERROR_NOT_FOUND;
+}
+
 int rack_au_plugin_parameter_info(
     RackAUPlugin* plugin,
     uint32_t index,
@@ -917,15 +1485,13 @@ int rack_au_plugin_load_preset(RackAUPlugin* plugin, int32_t preset_number) {
         return RACK_AU_ERROR_AUDIO_UNIT + status;
     }
 
+    plugin->silence_gate.wake();
     return RACK_AU_OK;
 }
 
-int rack_au_plugin_get_state_size(RackAUPlugin* plugin) {
-    if (!plugin || !plugin->initialized) {
-        return 0;
-    }
-
-    // Query ClassInfo (full plugin state as CFPropertyList)
+// Get the AudioUnit's ClassInfo (full plugin state as CFPropertyList).
+// On success the caller owns *out.
+static OSStatus copy_class_info(RackAUPlugin* plugin, CFPropertyListRef* out) {
     CFPropertyListRef class_info = nullptr;
     UInt32 data_size = sizeof(class_info);
     OSStatus status = AudioUnitGetProperty(
@@ -937,12 +1503,24 @@ int rack_au_plugin_get_state_size(RackAUPlugin* plugin) {
         &data_size
     );
 
-    if (status != noErr || !class_info) {
-        return 0;
+    if (status == noErr && !class_info) {
+        return kAudioUnitErr_InvalidPropertyValue;
     }
+    *out = class_info;
+    return status;
+}
 
-    // Serialize to binary data to determine size
-    CFDataRef data = CFPropertyListCreateData(
+// Serialize the AudioUnit's ClassInfo into binary property list data.
+// On success the caller owns *out.
+static int serialize_state(RackAUPlugin* plugin, CFDataRef* out) {
+    CFPropertyListRef class_info = nullptr;
+    OSStatus status = copy_class_info(plugin, &class_info);
+    if (status != noErr) {
+        return RACK_AU_ERROR_AUDIO_UNIT + status;
+    }
+
+    // Serialize to binary data
+    CFDataRef cf_data = CFPropertyListCreateData(
         kCFAllocatorDefault,
         class_info,
         kCFPropertyListBinaryFormat_v1_0,
@@ -952,7 +1530,22 @@ int rack_au_plugin_get_state_size(RackAUPlugin* plugin) {
 
     CFRelease(class_info);  // We own class_info, must release
 
-    if (!data) {
+    if (!cf_data) {
+        return RACK_AU_ERROR_GENERIC;
+    }
+
+    *out = cf_data;
+    return RACK_AU_OK;
+}
+
+int rack_au_plugin_get_state_size(RackAUPlugin* plugin) {
+    if (!plugin || !plugin->initialized) {
+        return 0;
+    }
+
+    // Serialize to binary data to determine size
+    CFDataRef data = nullptr;
+    if (serialize_state(plugin, &data) != RACK_AU_OK) {
         return 0;
     }
 
@@ -976,35 +1569,10 @@ int rack_au_plugin_get_state(RackAUPlugin* plugin, uint8_t* data, size_t* size)
         return RACK_AU_ERROR_INVALID_PARAM;
     }
 
-    // Query ClassInfo (full plugin state)
-    CFPropertyListRef class_info = nullptr;
-    UInt32 data_size = sizeof(class_info);
-    OSStatus status = AudioUnitGetProperty(
-        plugin->audio_unit,
-        kAudioUnitProperty_ClassInfo,
-        kAudioUnitScope_Global,
-        0,
-        &class_info,
-        &data_size
-    );
-
-    if (status != noErr || !class_info) {
-        return RACK_AU_ERROR_AUDIO_UNIT + status;
-    }
-
-    // Serialize to binary data
-    CFDataRef cf_data = CFPropertyListCreateData(
-        kCFAllocatorDefault,
-        class_info,
-        kCFPropertyListBinaryFormat_v1_0,
-        0,  // options
-        nullptr  // error
-    );
-
-    CFRelease(class_info);  // We own class_info, must release
-
-    if (!cf_data) {
-        return RACK_AU_ERROR_GENERIC;
+    CFDataRef cf_data = nullptr;
+    int result = serialize_state(plugin, &cf_data);
+    if (result != RACK_AU_OK) {
+        return result;
     }
 
     // Copy data to output buffer
@@ -1023,6 +1591,35 @@ int rack_au_plugin_get_state(RackAUPlugin* plugin, uint8_t* data, size_t* size)
     return RACK_AU_OK;
 }
 
+int rack_au_plugin_snapshot_state(RackAUPlugin* plugin, const uint8_t** data, size_t* size) {
+    if (!plugin || !plugin->initialized) {
+        return RACK_AU_ERROR_NOT_INITIALIZED;
+    }
+
+    if (!data || !size) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    CFDataRef cf_data = nullptr;
+    int result = serialize_state(plugin, &cf_data);
+    if (result != RACK_AU_OK) {
+        *data = nullptr;
+        *size = 0;
+        return result;
+    }
+
+    // Hand out the serialized bytes directly; they are kept alive until the
+    // next snapshot instead of being copied
+    if (plugin->state_snapshot) {
+        CFRelease(plugin->state_snapshot);
+    }
+    plugin->state_snapshot = cf_data;
+
+    *data = CFDataGetBytePtr(cf_data);
+    *size = static_cast<size_t>(CFDataGetLength(cf_data));
+    return RACK_AU_OK;
+}
+
 int rack_au_plugin_set_state(RackAUPlugin* plugin, const uint8_t* data, size_t size) {
     if (!plugin || !plugin->initialized) {
         return RACK_AU_ERROR_NOT_INITIALIZED;
@@ -1080,9 +1677,236 @@ int rack_au_plugin_set_state(RackAUPlugin* plugin, const uint8_t* data, size_t s
         return RACK_AU_ERROR_AUDIO_UNIT + status;
     }
 
+    plugin->silence_gate.wake();
     return RACK_AU_OK;
 }
 
+// ============================================================================
+// Instance Cloning and Pools
+// ============================================================================
+
+// What new instances are made from: the component to instantiate and the
+// settings carried over from the source instance
+struct UnitTemplate {
+    AudioComponent component;
+    char unique_id[64];
+    bool offline_render;
+    bool idle_sleep;
+    double sample_rate;
+    uint32_t max_block_size;  // 0 = leave new instances uninitialized
+};
+
+static void capture_template(RackAUPlugin* source, UnitTemplate* unit_template) {
+    unit_template->component = AudioComponentInstanceGetComponent(source->audio_unit);
+    memcpy(unit_template->unique_id, source->unique_id, sizeof(unit_template->unique_id));
+
+    UInt32 offline = 0;
+    UInt32 data_size = sizeof(offline);
+    if (AudioUnitGetProperty(source->audio_unit, kAudioUnitProperty_OfflineRender,
+                             kAudioUnitScope_Global, 0, &offline, &data_size) != noErr) {
+        offline = 0;
+    }
+    unit_template->offline_render = offline != 0;
+    unit_template->idle_sleep = source->silence_gate.enabled();
+
+    unit_template->sample_rate = source->initialized ? source->sample_rate : 0.0;
+    unit_template->max_block_size = source->initialized ? source->max_block_size : 0;
+}
+
+// Create an instance of the template's component and hand it class_info
+// (the source's ClassInfo, used as is; NULL = default state). Like
+// rack_au_plugin_set_state, the state is applied after AudioUnitInitialize.
+static RackAUPlugin* instantiate(const UnitTemplate& unit_template, CFPropertyListRef class_info) {
+    RackAUPlugin* plugin = new_instance(unit_template.component, unit_template.unique_id);
+    if (!plugin) {
+        return nullptr;
+    }
+
+    if (unit_template.offline_render) {
+        rack_au_plugin_set_offline_render(plugin, 1);
+    }
+    plugin->silence_gate.set_enabled(unit_template.idle_sleep);
+
+    if (unit_template.max_block_size == 0) {
+        return plugin;
+    }
+
+    if (rack_au_plugin_initialize(plugin, unit_template.sample_rate,
+                                  unit_template.max_block_size) != RACK_AU_OK) {
+        rack_au_plugin_free(plugin);
+        return nullptr;
+    }
+
+    if (class_info) {
+        OSStatus status = AudioUnitSetProperty(
+            plugin->audio_unit,
+            kAudioUnitProperty_ClassInfo,
+            kAudioUnitScope_Global,
+            0,
+            &class_info,
+            sizeof(class_info)
+        );
+        if (status != noErr) {
+            rack_au_plugin_free(plugin);
+            return nullptr;
+        }
+    }
+
+    return plugin;
+}
+
+RackAUPlugin* rack_au_plugin_clone(RackAUPlugin* source) {
+    if (!source || !source->audio_unit) {
+        return nullptr;
+    }
+
+    UnitTemplate unit_template;
+    capture_template(source, &unit_template);
+
+    // State is only settable on initialized units (see set_state), so an
+    // uninitialized source has nothing to carry over. The property list goes
+    // from one unit to the other without being serialized.
+    CFPropertyListRef class_info = nullptr;
+    if (source->initialized && copy_class_info(source, &class_info) != noErr) {
+        return nullptr;
+    }
+
+    RackAUPlugin* clone = instantiate(unit_template, class_info);
+    if (class_info) {
+        CFRelease(class_info);
+    }
+    return clone;
+}
+
+// Ready instances of one plugin, refilled by a background thread
+struct RackAUPool {
+    UnitTemplate unit_template;
+    CFPropertyListRef class_info = nullptr;  // Immutable copy of the prototype's state (owned)
+    uint32_t size = 0;
+
+    std::mutex lock;
+    std::condition_variable refill_cv;
+    std::vector<RackAUPlugin*> spares;  // Capacity reserved for size entries
+    bool refill_failed = false;  // Last creation failed; retried on the next acquire
+    bool stopping = false;
+    std::thread refill_thread;
+};
+
+static void refill_pool(RackAUPool* pool) {
+    std::unique_lock<std::mutex> lock(pool->lock);
+    for (;;) {
+        pool->refill_cv.wait(lock, [pool]() {
+            return pool->stopping || (!pool->refill_failed && pool->spares.size() < pool->size);
+        });
+        if (pool->stopping) {
+            return;
+        }
+
+        // Instances are created without the pool lock, so acquire() never
+        // waits for a unit to initialize
+        lock.unlock();
+        RackAUPlugin* plugin = instantiate(pool->unit_template, pool->class_info);
+        lock.lock();
+
+        if (plugin) {
+            pool->spares.push_back(plugin);
+        } else {
+            pool->refill_failed = true;
+        }
+    }
+}
+
+static void delete_pool(RackAUPool* pool) {
+    if (pool->class_info) {
+        CFRelease(pool->class_info);
+    }
+    delete pool;
+}
+
+RackAUPool* rack_au_pool_new(RackAUPlugin* prototype, uint32_t size) {
+    if (!prototype || !prototype->audio_unit || size == 0) {
+        return nullptr;
+    }
+
+    auto pool = new(std::nothrow) RackAUPool();
+    if (!pool) {
+        return nullptr;
+    }
+
+    capture_template(prototype, &pool->unit_template);
+    if (prototype->initialized) {
+        CFPropertyListRef class_info = nullptr;
+        if (copy_class_info(prototype, &class_info) != noErr) {
+            delete_pool(pool);
+            return nullptr;
+        }
+        pool->class_info = CFPropertyListCreateDeepCopy(kCFAllocatorDefault, class_info,
+                                                        kCFPropertyListImmutable);
+        CFRelease(class_info);
+        if (!pool->class_info) {
+            delete_pool(pool);
+            return nullptr;
+        }
+    }
+
+    pool->size = size;
+    pool->spares.reserve(size);
+
+    try {
+        pool->refill_thread = std::thread(refill_pool, pool);
+    } catch (const std::system_error&) {
+        delete_pool(pool);
+        return nullptr;
+    }
+
+    return pool;
+}
+
+void rack_au_pool_free(RackAUPool* pool) {
+    if (!pool) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool->lock);
+        pool->stopping = true;
+    }
+    pool->refill_cv.notify_one();
+    pool->refill_thread.join();
+
+    for (RackAUPlugin* plugin : pool->spares) {
+        rack_au_plugin_free(plugin);
+    }
+    delete_pool(pool);
+}
+
+RackAUPlugin* rack_au_pool_acquire(RackAUPool* pool) {
+    if (!pool) {
+        return nullptr;
+    }
+
+    RackAUPlugin* plugin = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pool->lock);
+        if (!pool->spares.empty()) {
+            plugin = pool->spares.back();
+            pool->spares.pop_back();
+        }
+        pool->refill_failed = false;
+    }
+    pool->refill_cv.notify_one();
+    return plugin;
+}
+
+int rack_au_pool_available(RackAUPool* pool) {
+    if (!pool) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lock(pool->lock);
+    return static_cast<int>(pool->spares.size());
+}
+
 // ============================================================================
 // MIDI Implementation
 // ============================================================================
@@ -1105,43 +1929,34 @@ int rack_au_plugin_send_midi(
         return RACK_AU_OK;
     }
 
-    // Send each MIDI event to the AudioUnit
-    // Using MusicDeviceMIDIEvent for sample-accurate timing via event->sample_offset
+    // Validate the whole batch first so it is queued all-or-nothing
     for (uint32_t i = 0; i < event_count; i++) {
-        const RackAUMidiEvent* event = &events[i];
-
-        uint8_t status;
-
         // System messages (0xF0-0xFF) don't use channels
-        if (event->status >= 0xF0) {
-            // System message - use status byte as-is
-            status = event->status;
-        } else {
-            // Channel message - validate channel and combine
-            if (event->channel > 15) {
-                return RACK_AU_ERROR_INVALID_PARAM;
-            }
-            // Clear any channel bits from status (use upper nibble only), then combine with channel
-            // Status byte upper nibble (0x90, 0x80, etc.) + channel lower nibble (0-15)
-            status = (event->status & 0xF0) | (event->channel & 0x0F);
+        if (events[i].status < 0xF0 && events[i].channel > 15) {
+            return RACK_AU_ERROR_INVALID_PARAM;
         }
+    }
 
-        // Send MIDI event to AudioUnit
-        // MusicDeviceMIDIEvent is the primary API for sending MIDI to instrument plugins
-        // For effect plugins that don't implement this, the call will fail gracefully
-        OSStatus result = MusicDeviceMIDIEvent(
-            plugin->audio_unit,
-            status,
-            event->data1,
-            event->data2,
-            event->sample_offset  // Sample offset within buffer for sample-accurate timing
-        );
+    if (plugin->midi_queue.write_available() < event_count) {
+        plugin->perf.add_dropped_midi(event_count);
+        return RACK_AU_ERROR_GENERIC;
+    }
 
-        // Note: Some effect plugins don't support MIDI, so we check the error
-        // and return it to let Rust handle the failure gracefully
-        if (result != noErr) {
-            return RACK_AU_ERROR_AUDIO_UNIT + result;
+    // Queue events for the next process() call, which schedules them with
+    // MusicDeviceMIDIEvent for sample-accurate timing via sample_offset.
+    // Calling MusicDeviceMIDIEvent here would race with AudioUnitRender.
+    for (uint32_t i = 0; i < event_count; i++) {
+        RackAUMidiEvent queued = events[i];
+
+        if (queued.status < 0xF0) {
+            // Channel message - clear any channel bits from status (use upper
+            // nibble only), then combine with channel
+            // Status byte upper nibble (0x90, 0x80, etc.) + channel lower nibble (0-15)
+            queued.status = (queued.status & 0xF0) | (queued.channel & 0x0F);
         }
+        // System message - use status byte as-is
+
+        plugin->midi_queue.push(queued);
     }
 
     return RACK_AU_OK;
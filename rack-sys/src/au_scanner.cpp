@@ -3,13 +3,34 @@
 #include <CoreFoundation/CoreFoundation.h>
 #include <new>
 #include <cstring>
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+
+// Cached result for one registered component
+struct ScannedComponent {
+    AudioComponentDescription desc;
+    bool usable;              // false if the component has no name (skipped)
+    RackAUPluginInfo info;
+};
 
 // Internal scanner state
-// Note: AudioComponent handles are transient and obtained via
-// AudioComponentFindNext during each scan. We don't need to store them
-// until we implement plugin loading functionality.
+// Results are kept between scans. The component list is only re-walked after
+// the system posts kAudioComponentRegistrationsChangedNotification (or after
+// rack_au_scanner_invalidate), and then only components that were not seen
+// before are queried for name and version.
 struct RackAUScanner {
-    // Reserved for future use (e.g., caching component handles)
+    std::unordered_map<AudioComponent, ScannedComponent> components;
+    std::vector<RackAUPluginInfo> results;
+
+    // Set by the notification callback (any thread), consumed by scans
+    std::atomic<bool> dirty{true};
+
+    // Bumped on every registration change; readable from any thread
+    std::atomic<uint64_t> generation{0};
+
+    bool observing = false;
 };
 
 // Helper: Convert CFString to C string
@@ -54,33 +75,82 @@ static void CreateUniqueID(const AudioComponentDescription& desc, char* buffer,
              (unsigned int)desc.componentManufacturer);
 }
 
-// ============================================================================
-// Scanner Implementation
-// ============================================================================
+// Helper: Query a component that was not seen in a previous scan
+static void ScanComponent(AudioComponent comp, const AudioComponentDescription& foundDesc, ScannedComponent& entry) {
+    entry.desc = foundDesc;
+    entry.usable = false;
+    memset(&entry.info, 0, sizeof(entry.info));
 
-RackAUScanner* rack_au_scanner_new(void) {
-    return new(std::nothrow) RackAUScanner();
-}
+    // Get component name
+    CFStringRef name = nullptr;
+    OSStatus status = AudioComponentCopyName(comp, &name);
+    if (status != noErr || !name) {
+        // Skip plugins that don't provide a name - these are typically
+        // malformed or system components we can't use anyway
+        return;
+    }
+    entry.usable = true;
 
-void rack_au_scanner_free(RackAUScanner* scanner) {
-    delete scanner;
-}
+    RackAUPluginInfo& info = entry.info;
 
-int rack_au_scanner_scan(RackAUScanner* scanner, RackAUPluginInfo* plugins, size_t max_plugins) {
-    if (!scanner) {
-        return RACK_AU_ERROR_INVALID_PARAM;
+    // Name (clear buffer first to ensure null termination)
+    info.name[0] = '\0';
+    if (!CFStringToCString(name, info.name, sizeof(info.name))) {
+        snprintf(info.name, sizeof(info.name), "<unknown>");
     }
+    CFRelease(name);
+
+    // Manufacturer (convert OSType to string)
+    OSType mfg = foundDesc.componentManufacturer;
+    if (mfg == kAudioUnitManufacturer_Apple) {
+        snprintf(info.manufacturer, sizeof(info.manufacturer), "Apple");
+    } else {
+        // Convert FourCC to readable string with validation
+        char mfgStr[5] = {0};
+        unsigned char bytes[4] = {
+            static_cast<unsigned char>((mfg >> 24) & 0xFF),
+            static_cast<unsigned char>((mfg >> 16) & 0xFF),
+            static_cast<unsigned char>((mfg >> 8) & 0xFF),
+            static_cast<unsigned char>(mfg & 0xFF)
+        };
+        for (int i = 0; i < 4; ++i) {
+            // Printable ASCII range: 0x20 (space) to 0x7E (~)
+            mfgStr[i] = (bytes[i] >= 0x20 && bytes[i] <= 0x7E) ? bytes[i] : '?';
+        }
+        snprintf(info.manufacturer, sizeof(info.manufacturer), "%s", mfgStr);
+    }
+
+    // Path (AudioUnits are system-registered, path not easily accessible)
+    // We use a placeholder - the unique_id is what matters for loading
+    snprintf(info.path, sizeof(info.path), "<system>");
+
+    // Unique ID
+    CreateUniqueID(foundDesc, info.unique_id, sizeof(info.unique_id));
+
+    // Version
+    UInt32 version = 0;
+    if (AudioComponentGetVersion(comp, &version) == noErr) {
+        info.version = version;
+    } else {
+        info.version = 0;
+    }
+
+    // Type
+    info.plugin_type = AudioUnitTypeToPluginType(foundDesc.componentType);
+}
+
+// Helper: Re-walk the registered components, reusing cached entries
+static void RefreshComponents(RackAUScanner* scanner) {
+    std::unordered_map<AudioComponent, ScannedComponent> components;
+    components.reserve(scanner->components.size());
+    scanner->results.clear();
 
-    // If plugins is NULL, we're just counting
-    bool count_only = (plugins == nullptr);
-    size_t count = 0;
-    
     // Enumerate all AudioUnit components
     AudioComponentDescription desc = {0};
     desc.componentType = 0;  // 0 means "any type"
     desc.componentSubType = 0;
     desc.componentManufacturer = 0;
-    
+
     AudioComponent comp = nullptr;
     while ((comp = AudioComponentFindNext(comp, &desc)) != nullptr) {
         // Get component description
@@ -90,81 +160,124 @@ int rack_au_scanner_scan(RackAUScanner* scanner, RackAUPluginInfo* plugins, size
             continue;
         }
 
-        // Get component name - check this for ALL plugins to ensure consistent counts
-        CFStringRef name = nullptr;
-        status = AudioComponentCopyName(comp, &name);
-        if (status != noErr || !name) {
-            // Skip plugins that don't provide a name - these are typically
-            // malformed or system components we can't use anyway
-            // IMPORTANT: This check happens for BOTH counting and filling passes
-            // to ensure the count matches the number of filled plugins
-            continue;
+        // Handles can in principle be reused after an unregistration, so
+        // a cached entry only counts if its description still matches
+        ScannedComponent entry;
+        auto it = scanner->components.find(comp);
+        if (it != scanner->components.end() &&
+            it->second.desc.componentType == foundDesc.componentType &&
+            it->second.desc.componentSubType == foundDesc.componentSubType &&
+            it->second.desc.componentManufacturer == foundDesc.componentManufacturer) {
+            entry = it->second;
+        } else {
+            ScanComponent(comp, foundDesc, entry);
         }
 
-        // If we're just counting, don't need to extract details
-        if (count_only) {
-            CFRelease(name);
-            count++;
-            continue;
+        if (entry.usable) {
+            scanner->results.push_back(entry.info);
         }
+        components[comp] = entry;
+    }
 
-        // If array is full, continue counting but don't fill
-        if (count >= max_plugins) {
-            CFRelease(name);
-            count++;
-            continue;
-        }
+    scanner->components.swap(components);
+}
 
-        // Fill in plugin info
-        RackAUPluginInfo& info = plugins[count];
+// Notification callback: may run on any thread, so only touches atomics
+static void RegistrationsChanged(CFNotificationCenterRef center, void* observer,
+                                 CFStringRef name, const void* object, CFDictionaryRef user_info) {
+    (void)center;
+    (void)name;
+    (void)object;
+    (void)user_info;
 
-        // Name (clear buffer first to ensure null termination)
-        info.name[0] = '\0';
-        if (!CFStringToCString(name, info.name, sizeof(info.name))) {
-            snprintf(info.name, sizeof(info.name), "<unknown>");
-        }
-        CFRelease(name);
-        
-        // Manufacturer (convert OSType to string)
-        OSType mfg = foundDesc.componentManufacturer;
-        if (mfg == kAudioUnitManufacturer_Apple) {
-            snprintf(info.manufacturer, sizeof(info.manufacturer), "Apple");
-        } else {
-            // Convert FourCC to readable string with validation
-            char mfgStr[5] = {0};
-            unsigned char bytes[4] = {
-                static_cast<unsigned char>((mfg >> 24) & 0xFF),
-                static_cast<unsigned char>((mfg >> 16) & 0xFF),
-                static_cast<unsigned char>((mfg >> 8) & 0xFF),
-                static_cast<unsigned char>(mfg & 0xFF)
-            };
-            for (int i = 0; i < 4; ++i) {
-                // Printable ASCII range: 0x20 (space) to 0x7E (~)
-                mfgStr[i] = (bytes[i] >= 0x20 && bytes[i] <= 0x7E) ? bytes[i] : '?';
-            }
-            snprintf(info.manufacturer, sizeof(info.manufacturer), "%s", mfgStr);
-        }
+    RackAUScanner* scanner = static_cast<RackAUScanner*>(observer);
+    // Mark dirty before publishing the new generation, so a reader that sees
+    // the new generation and then scans is guaranteed to refresh
+    scanner->dirty.store(true, std::memory_order_release);
+    scanner->generation.fetch_add(1, std::memory_order_acq_rel);
+}
 
-        // Path (AudioUnits are system-registered, path not easily accessible)
-        // We use a placeholder - the unique_id is what matters for loading
-        snprintf(info.path, sizeof(info.path), "<system>");
+// Helper: Bring cached results up to date (no-op if nothing changed)
+static void UpdateResults(RackAUScanner* scanner) {
+    if (scanner->dirty.exchange(false, std::memory_order_acq_rel)) {
+        RefreshComponents(scanner);
+    }
+}
 
-        // Unique ID
-        CreateUniqueID(foundDesc, info.unique_id, sizeof(info.unique_id));
+// ============================================================================
+// Scanner Implementation
+// ============================================================================
 
-        // Version
-        UInt32 version = 0;
-        if (AudioComponentGetVersion(comp, &version) == noErr) {
-            info.version = version;
-        } else {
-            info.version = 0;
+RackAUScanner* rack_au_scanner_new(void) {
+    RackAUScanner* scanner = new(std::nothrow) RackAUScanner();
+    if (!scanner) {
+        return nullptr;
+    }
+
+    CFNotificationCenterAddObserver(
+        CFNotificationCenterGetLocalCenter(),
+        scanner,
+        RegistrationsChanged,
+        kAudioComponentRegistrationsChangedNotification,
+        nullptr,
+        CFNotificationSuspensionBehaviorDeliverImmediately);
+    scanner->observing = true;
+
+    return scanner;
+}
+
+void rack_au_scanner_free(RackAUScanner* scanner) {
+    if (!scanner) {
+        return;
+    }
+
+    if (scanner->observing) {
+        CFNotificationCenterRemoveEveryObserver(CFNotificationCenterGetLocalCenter(), scanner);
+    }
+    delete scanner;
+}
+
+int rack_au_scanner_scan(RackAUScanner* scanner, RackAUPluginInfo* plugins, size_t max_plugins) {
+    if (!scanner) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    UpdateResults(scanner);
+
+    if (plugins) {
+        size_t n = std::min(max_plugins, scanner->results.size());
+        if (n > 0) {
+            memcpy(plugins, scanner->results.data(), n * sizeof(RackAUPluginInfo));
         }
-        
-        // Type
-        info.plugin_type = AudioUnitTypeToPluginType(foundDesc.componentType);
+    }
 
-        count++;
+    return static_cast<int>(scanner->results.size());
+}
+
+int rack_au_scanner_scan_results(RackAUScanner* scanner, const RackAUPluginInfo** plugins) {
+    if (!scanner || !plugins) {
+        return RACK_AU_ERROR_INVALID_PARAM;
     }
-    
-    return static_cast<int>(count);
+
+    UpdateResults(scanner);
+
+    *plugins = scanner->results.empty() ? nullptr : scanner->results.data();
+    return static_cast<int>(scanner->results.size());
+}
+
+uint64_t rack_au_scanner_generation(const RackAUScanner* scanner) {
+    if (!scanner) {
+        return 0;
+    }
+    return scanner->generation.load(std::memory_order_acquire);
+}
+
+int rack_au_scanner_invalidate(RackAUScanner* scanner) {
+    if (!scanner) {
+        return RACK_AU_ERROR_INVALID_PARAM;
+    }
+
+    scanner->dirty.store(true, std::memory_order_release);
+    scanner->generation.fetch_add(1, std::memory_order_acq_rel);
+    return RACK_AU_OK;
 }
@@ -0,0 +1,87 @@
+#include "rack_convert.h"
+#include "sample_convert.h"
+
+// ============================================================================
+// C API over the shared kernels in sample_convert.h
+// ============================================================================
+
+static_assert(sizeof(RackDitherState) == sizeof(rack::DitherState),
+              "RackDitherState must match rack::DitherState");
+
+static rack::DitherState* dither_state(RackDitherState* state) {
+    return reinterpret_cast<rack::DitherState*>(state);
+}
+
+void rack_dither_init(RackDitherState* state, uint32_t seed) {
+    if (state) {
+        rack::dither_seed(dither_state(state), seed);
+    }
+}
+
+const char* rack_convert_isa(void) {
+    return rack::convert_isa();
+}
+
+void rack_convert_deinterleave(const float* interleaved, float* const* planar,
+                               uint32_t channels, uint32_t frames) {
+    if (!interleaved || !planar || channels == 0) {
+        return;
+    }
+    rack::deinterleave(interleaved, planar, channels, frames);
+}
+
+void rack_convert_interleave(const float* const* planar, float* interleaved,
+                             uint32_t channels, uint32_t frames) {
+    if (!planar || !interleaved || channels == 0) {
+        return;
+    }
+    rack::interleave(planar, interleaved, channels, frames);
+}
+
+void rack_convert_s16_to_f32(const int16_t* src, float* dst, size_t count) {
+    if (src && dst) {
+        rack::s16_to_f32(src, dst, count);
+    }
+}
+
+void rack_convert_f32_to_s16(const float* src, int16_t* dst, size_t count, RackDitherState* dither) {
+    if (src && dst) {
+        rack::f32_to_s16(src, dst, count, dither_state(dither));
+    }
+}
+
+void rack_convert_s24_to_f32(const uint8_t* src, float* dst, size_t count) {
+    if (src && dst) {
+        rack::s24_to_f32(src, dst, count);
+    }
+}
+
+void rack_convert_f32_to_s24(const float* src, uint8_t* dst, size_t count, RackDitherState* dither) {
+    if (src && dst) {
+        rack::f32_to_s24(src, dst, count, dither_state(dither));
+    }
+}
+
+void rack_convert_s32_to_f32(const int32_t* src, float* dst, size_t count) {
+    if (src && dst) {
+        rack::s32_to_f32(src, dst, count);
+    }
+}
+
+void rack_convert_f32_to_s32(const float* src, int32_t* dst, size_t count) {
+    if (src && dst) {
+        rack::f32_to_s32(src, dst, count);
+    }
+}
+
+void rack_mix_add(const float* src, float* dst, size_t count, float gain) {
+    if (src && dst) {
+        rack::mix_add(src, dst, count, gain);
+    }
+}
+
+void rack_apply_gain(float* buffer, size_t count, float gain) {
+    if (buffer) {
+        rack::apply_gain(buffer, count, gain);
+    }
+}
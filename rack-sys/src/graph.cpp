@@ -0,0 +1,595 @@
+#include "rack_graph.h"
+#include "work_stealing_deque.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#elif defined(__APPLE__)
+    #include <pthread.h>
+#elif defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+#endif
+
+// ============================================================================
+// Internal Structures
+// ============================================================================
+
+namespace {
+
+// Source of one input: a node's output channel or a graph input channel
+struct Connection {
+    uint32_t node;     // Node ID or RACK_GRAPH_IO
+    uint32_t channel;
+};
+
+struct GraphNode {
+    void* instance = nullptr;
+    RackGraphProcessFn process = nullptr;
+    uint32_t num_inputs = 0;
+    uint32_t num_outputs = 0;
+
+    // Per input channel: everything summed into it
+    std::vector<std::vector<Connection>> input_sources;
+
+    // Schedule (built by prepare)
+    std::vector<uint32_t> successors;   // Distinct downstream nodes
+    uint32_t num_predecessors = 0;      // Distinct upstream nodes
+    std::atomic<uint32_t> pending{0};   // Upstream nodes not yet done this block
+
+    // Buffers (allocated by prepare, max_block_size frames per channel)
+    std::vector<float> input_mix;       // Sums for inputs with several sources
+    std::vector<float> output_storage;
+    std::vector<const float*> input_ptrs;
+    std::vector<float*> output_ptrs;
+};
+
+// How long an idle worker keeps polling before it sleeps. Long enough to
+// span the gap between audio callbacks, so steady playback never pays for a
+// wake-up.
+constexpr auto WORKER_IDLE_TIMEOUT = std::chrono::milliseconds(50);
+
+} // namespace
+
+struct RackGraph {
+    uint32_t max_block_size = 0;
+    uint32_t flags = 0;
+
+    std::vector<std::unique_ptr<GraphNode>> nodes;
+    std::vector<std::vector<Connection>> output_sources;  // Per graph output channel
+    std::vector<uint32_t> roots;                          // Nodes without upstream nodes
+    std::vector<float> silence;                           // max_block_size zeros
+    bool prepared = false;
+
+    // Current block (written by process before the workers are released)
+    const float* const* inputs = nullptr;
+    uint32_t num_inputs = 0;
+    uint32_t frames = 0;
+    std::atomic<uint32_t> remaining{0};   // Nodes not yet processed this block
+    std::atomic<int> result{RACK_GRAPH_OK};
+
+    // One deque per thread; index 0 belongs to the caller of process()
+    std::vector<std::unique_ptr<rack::WorkStealingDeque<uint32_t>>> deques;
+
+    // Worker pool
+    std::vector<std::thread> workers;
+    std::atomic<uint64_t> epoch{0};           // Bumped once per block
+    std::atomic<uint32_t> active_workers{0};  // Workers inside a block
+    std::atomic<uint32_t> sleepers{0};
+    std::atomic<bool> quit{false};
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static inline void cpu_relax() {
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    _mm_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+// Apply RACK_GRAPH_FLAG_* to the calling worker thread. Failures (missing
+// privileges, unsupported platform) leave the thread as it was.
+static void configure_worker_thread(uint32_t flags, uint32_t worker) {
+    unsigned cores = std::thread::hardware_concurrency();
+    if (cores == 0) {
+        cores = 1;
+    }
+
+#if defined(__linux__)
+    if (flags & RACK_GRAPH_FLAG_PIN_THREADS) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(worker % cores, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    if (flags & RACK_GRAPH_FLAG_REALTIME_PRIORITY) {
+        // Below a typical audio callback thread, above everything else
+        sched_param param{};
+        param.sched_priority = std::max(sched_get_priority_min(SCHED_FIFO),
+                                        sched_get_priority_max(SCHED_FIFO) - 10);
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    }
+#elif defined(__APPLE__)
+    // macOS has no hard affinity; only the QoS class applies
+    if (flags & RACK_GRAPH_FLAG_REALTIME_PRIORITY) {
+        pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
+    }
+#elif defined(_WIN32)
+    if (flags & RACK_GRAPH_FLAG_PIN_THREADS) {
+        SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << (worker % cores % 64));
+    }
+    if (flags & RACK_GRAPH_FLAG_REALTIME_PRIORITY) {
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+    }
+#else
+    (void)flags;
+    (void)worker;
+#endif
+}
+
+static const float* source_buffer(RackGraph* graph, const Connection& source) {
+    if (source.node == RACK_GRAPH_IO) {
+        if (source.channel < graph->num_inputs && graph->inputs[source.channel]) {
+            return graph->inputs[source.channel];
+        }
+        return graph->silence.data();
+    }
+    return graph->nodes[source.node]->output_ptrs[source.channel];
+}
+
+// Returns a buffer holding the sum of sources. A single source is passed
+// through without copying; several are summed into mix.
+static const float* gather_input(RackGraph* graph, const std::vector<Connection>& sources,
+                                 float* mix, uint32_t frames) {
+    if (sources.empty()) {
+        return graph->silence.data();
+    }
+    if (sources.size() == 1) {
+        return source_buffer(graph, sources[0]);
+    }
+
+    memcpy(mix, source_buffer(graph, sources[0]), frames * sizeof(float));
+    for (size_t s = 1; s < sources.size(); ++s) {
+        const float* src = source_buffer(graph, sources[s]);
+        for (uint32_t i = 0; i < frames; ++i) {
+            mix[i] += src[i];
+        }
+    }
+    return mix;
+}
+
+// Process one node and release the downstream nodes it was holding back.
+// Newly ready nodes go onto the running thread's deque, so a chain stays on
+// one core while idle threads steal the branches.
+static void run_node(RackGraph* graph, uint32_t index, rack::WorkStealingDeque<uint32_t>& own) {
+    GraphNode& node = *graph->nodes[index];
+    const uint32_t frames = graph->frames;
+
+    for (uint32_t ch = 0; ch < node.num_inputs; ++ch) {
+        node.input_ptrs[ch] = gather_input(graph, node.input_sources[ch],
+                                           node.input_mix.data() + size_t(ch) * graph->max_block_size,
+                                           frames);
+    }
+
+    int status = node.process(node.instance, node.input_ptrs.data(), node.num_inputs,
+                              node.output_ptrs.data(), node.num_outputs, frames);
+    if (status != 0) {
+        for (uint32_t ch = 0; ch < node.num_outputs; ++ch) {
+            memset(node.output_ptrs[ch], 0, frames * sizeof(float));
+        }
+        int expected = RACK_GRAPH_OK;
+        graph->result.compare_exchange_strong(expected, RACK_GRAPH_ERROR_NODE_FAILED,
+                                              std::memory_order_relaxed);
+    }
+
+    for (uint32_t successor : node.successors) {
+        if (graph->nodes[successor]->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            // Capacity covers every node, so this cannot fail
+            own.push(successor);
+        }
+    }
+
+    graph->remaining.fetch_sub(1, std::memory_order_release);
+}
+
+// Run and steal nodes until the current block is complete
+static void work_until_done(RackGraph* graph, uint32_t self) {
+    // A late worker arriving after the block must not touch the deques,
+    // which prepare() may be replacing
+    if (graph->remaining.load(std::memory_order_acquire) == 0) {
+        return;
+    }
+
+    rack::WorkStealingDeque<uint32_t>& own = *graph->deques[self];
+    const uint32_t num_deques = static_cast<uint32_t>(graph->deques.size());
+
+    while (graph->remaining.load(std::memory_order_acquire) > 0) {
+        uint32_t index = 0;
+        if (own.pop(&index)) {
+            run_node(graph, index, own);
+            continue;
+        }
+
+        bool stolen = false;
+        for (uint32_t i = 1; i < num_deques && !stolen; ++i) {
+            stolen = graph->deques[(self + i) % num_deques]->steal(&index);
+        }
+        if (stolen) {
+            run_node(graph, index, own);
+        } else {
+            cpu_relax();
+        }
+    }
+}
+
+// Wait for the next block (or shutdown). Polls for WORKER_IDLE_TIMEOUT, then
+// sleeps until process() wakes the pool.
+static bool wait_for_block(RackGraph* graph, uint64_t* seen_epoch) {
+    auto started = std::chrono::steady_clock::now();
+    uint32_t spins = 0;
+
+    for (;;) {
+        if (graph->quit.load(std::memory_order_acquire)) {
+            return false;
+        }
+        uint64_t epoch = graph->epoch.load(std::memory_order_acquire);
+        if (epoch != *seen_epoch) {
+            *seen_epoch = epoch;
+            return true;
+        }
+
+        if (++spins < 1024) {
+            cpu_relax();
+            continue;
+        }
+        spins = 0;
+        std::this_thread::yield();
+
+        if (std::chrono::steady_clock::now() - started >= WORKER_IDLE_TIMEOUT) {
+            std::unique_lock<std::mutex> lock(graph->wake_mutex);
+            graph->sleepers.fetch_add(1);
+            graph->wake_cv.wait(lock, [graph, seen_epoch]() {
+                return graph->quit.load() || graph->epoch.load() != *seen_epoch;
+            });
+            graph->sleepers.fetch_sub(1);
+            started = std::chrono::steady_clock::now();
+        }
+    }
+}
+
+static void worker_main(RackGraph* graph, uint32_t self) {
+    configure_worker_thread(graph->flags, self);
+
+    uint64_t seen_epoch = graph->epoch.load();
+    while (wait_for_block(graph, &seen_epoch)) {
+        // Counted before looking at the block, so prepare() can wait for
+        // workers to leave the deques alone
+        graph->active_workers.fetch_add(1);
+        work_until_done(graph, self);
+        graph->active_workers.fetch_sub(1);
+    }
+}
+
+// Wait until no worker is inside a block (they may still be polling)
+static void wait_for_workers_idle(RackGraph* graph) {
+    while (graph->active_workers.load() > 0) {
+        std::this_thread::yield();
+    }
+}
+
+static void stop_workers(RackGraph* graph) {
+    {
+        std::lock_guard<std::mutex> lock(graph->wake_mutex);
+        graph->quit.store(true);
+    }
+    graph->wake_cv.notify_all();
+
+    for (std::thread& worker : graph->workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    graph->workers.clear();
+}
+
+static bool valid_node(RackGraph* graph, uint32_t node) {
+    return node < graph->nodes.size();
+}
+
+// ============================================================================
+// Graph API
+// ============================================================================
+
+RackGraph* rack_graph_new(uint32_t num_workers, uint32_t max_block_size, uint32_t flags) {
+    if (max_block_size == 0) {
+        return nullptr;
+    }
+
+    RackGraph* graph = new(std::nothrow) RackGraph();
+    if (!graph) {
+        return nullptr;
+    }
+
+    graph->max_block_size = max_block_size;
+    graph->flags = flags;
+
+    try {
+        graph->silence.assign(max_block_size, 0.0f);
+        for (uint32_t i = 0; i <= num_workers; ++i) {
+            graph->deques.emplace_back(new rack::WorkStealingDeque<uint32_t>(2));
+        }
+        for (uint32_t i = 1; i <= num_workers; ++i) {
+            graph->workers.emplace_back(worker_main, graph, i);
+        }
+    } catch (const std::exception&) {
+        stop_workers(graph);
+        delete graph;
+        return nullptr;
+    }
+
+    return graph;
+}
+
+void rack_graph_free(RackGraph* graph) {
+    if (!graph) {
+        return;
+    }
+
+    stop_workers(graph);
+    delete graph;
+}
+
+int rack_graph_add_node(
+    RackGraph* graph,
+    void* instance,
+    RackGraphProcessFn process,
+    uint32_t num_input_channels,
+    uint32_t num_output_channels)
+{
+    if (!graph || !instance || !process) {
+        return RACK_GRAPH_ERROR_INVALID_PARAM;
+    }
+    if (graph->nodes.size() >= static_cast<size_t>(INT32_MAX)) {
+        return RACK_GRAPH_ERROR_GENERIC;
+    }
+
+    std::unique_ptr<GraphNode> node(new(std::nothrow) GraphNode());
+    if (!node) {
+        return RACK_GRAPH_ERROR_GENERIC;
+    }
+
+    node->instance = instance;
+    node->process = process;
+    node->num_inputs = num_input_channels;
+    node->num_outputs = num_output_channels;
+
+    try {
+        node->input_sources.resize(num_input_channels);
+        graph->nodes.push_back(std::move(node));
+    } catch (const std::bad_alloc&) {
+        return RACK_GRAPH_ERROR_GENERIC;
+    }
+
+    graph->prepared = false;
+    return static_cast<int>(graph->nodes.size() - 1);
+}
+
+int rack_graph_connect(
+    RackGraph* graph,
+    uint32_t src_node,
+    uint32_t src_channel,
+    uint32_t dst_node,
+    uint32_t dst_channel)
+{
+    if (!graph) {
+        return RACK_GRAPH_ERROR_INVALID_PARAM;
+    }
+    if (src_node != RACK_GRAPH_IO &&
+        (!valid_node(graph, src_node) || src_channel >= graph->nodes[src_node]->num_outputs)) {
+        return RACK_GRAPH_ERROR_INVALID_PARAM;
+    }
+    if (dst_node != RACK_GRAPH_IO &&
+        (!valid_node(graph, dst_node) || dst_channel >= graph->nodes[dst_node]->num_inputs)) {
+        return RACK_GRAPH_ERROR_INVALID_PARAM;
+    }
+
+    try {
+        if (dst_node == RACK_GRAPH_IO) {
+            if (dst_channel >= graph->output_sources.size()) {
+                graph->output_sources.resize(size_t(dst_channel) + 1);
+            }
+            graph->output_sources[dst_channel].push_back({src_node, src_channel});
+        } else {
+            graph->nodes[dst_node]->input_sources[dst_channel].push_back({src_node, src_channel});
+        }
+    } catch (const std::bad_alloc&) {
+        return RACK_GRAPH_ERROR_GENERIC;
+    }
+
+    graph->prepared = false;
+    return RACK_GRAPH_OK;
+}
+
+int rack_graph_prepare(RackGraph* graph) {
+    if (!graph) {
+        return RACK_GRAPH_ERROR_INVALID_PARAM;
+    }
+
+    graph->prepared = false;
+    wait_for_workers_idle(graph);
+
+    const size_t count = graph->nodes.size();
+    const size_t block = graph->max_block_size;
+
+    try {
+        // Dependencies: one edge per distinct upstream node
+        for (auto& node : graph->nodes) {
+            node->successors.clear();
+            node->num_predecessors = 0;
+        }
+        std::vector<uint32_t> upstream;
+        for (size_t i = 0; i < count; ++i) {
+            GraphNode& node = *graph->nodes[i];
+            upstream.clear();
+            for (const auto& sources : node.input_sources) {
+                for (const Connection& source : sources) {
+                    if (source.node != RACK_GRAPH_IO) {
+                        upstream.push_back(source.node);
+                    }
+                }
+            }
+            std::sort(upstream.begin(), upstream.end());
+            upstream.erase(std::unique(upstream.begin(), upstream.end()), upstream.end());
+
+            node.num_predecessors = static_cast<uint32_t>(upstream.size());
+            for (uint32_t predecessor : upstream) {
+                graph->nodes[predecessor]->successors.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        // Kahn's algorithm: every node must become ready exactly once
+        std::vector<uint32_t> indegree(count);
+        std::vector<uint32_t> ready;
+        graph->roots.clear();
+        for (size_t i = 0; i < count; ++i) {
+            indegree[i] = graph->nodes[i]->num_predecessors;
+            if (indegree[i] == 0) {
+                ready.push_back(static_cast<uint32_t>(i));
+                graph->roots.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        size_t visited = 0;
+        while (!ready.empty()) {
+            uint32_t index = ready.back();
+            ready.pop_back();
+            ++visited;
+            for (uint32_t successor : graph->nodes[index]->successors) {
+                if (--indegree[successor] == 0) {
+                    ready.push_back(successor);
+                }
+            }
+        }
+        if (visited != count) {
+            return RACK_GRAPH_ERROR_CYCLE;
+        }
+
+        // Buffers
+        for (auto& node : graph->nodes) {
+            node->input_mix.assign(node->num_inputs * block, 0.0f);
+            node->output_storage.assign(node->num_outputs * block, 0.0f);
+            node->input_ptrs.assign(node->num_inputs, nullptr);
+            node->output_ptrs.resize(node->num_outputs);
+            for (uint32_t ch = 0; ch < node->num_outputs; ++ch) {
+                node->output_ptrs[ch] = node->output_storage.data() + ch * block;
+            }
+        }
+
+        // Every thread's deque can hold every node
+        for (auto& deque : graph->deques) {
+            if (deque->capacity() < count) {
+                deque.reset(new rack::WorkStealingDeque<uint32_t>(count));
+            }
+        }
+    } catch (const std::bad_alloc&) {
+        return RACK_GRAPH_ERROR_GENERIC;
+    }
+
+    graph->prepared = true;
+    return RACK_GRAPH_OK;
+}
+
+int rack_graph_process(
+    RackGraph* graph,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames)
+{
+    if (!graph) {
+        return RACK_GRAPH_ERROR_INVALID_PARAM;
+    }
+    if (!graph->prepared) {
+        return RACK_GRAPH_ERROR_NOT_PREPARED;
+    }
+    if (frames > graph->max_block_size ||
+        (num_input_channels > 0 && !inputs) || (num_output_channels > 0 && !outputs)) {
+        return RACK_GRAPH_ERROR_INVALID_PARAM;
+    }
+
+    graph->inputs = inputs;
+    graph->num_inputs = num_input_channels;
+    graph->frames = frames;
+    graph->result.store(RACK_GRAPH_OK, std::memory_order_relaxed);
+
+    const uint32_t count = static_cast<uint32_t>(graph->nodes.size());
+    if (count > 0) {
+        for (auto& node : graph->nodes) {
+            node->pending.store(node->num_predecessors, std::memory_order_relaxed);
+        }
+        graph->remaining.store(count, std::memory_order_release);
+
+        rack::WorkStealingDeque<uint32_t>& own = *graph->deques[0];
+        for (uint32_t root : graph->roots) {
+            own.push(root);
+        }
+
+        // Release the workers; only sleeping ones need the mutex
+        graph->epoch.fetch_add(1);
+        if (graph->sleepers.load() > 0) {
+            std::lock_guard<std::mutex> lock(graph->wake_mutex);
+            graph->wake_cv.notify_all();
+        }
+
+        work_until_done(graph, 0);
+    }
+
+    // Graph outputs
+    for (uint32_t ch = 0; ch < num_output_channels; ++ch) {
+        if (ch >= graph->output_sources.size() || graph->output_sources[ch].empty()) {
+            memset(outputs[ch], 0, frames * sizeof(float));
+            continue;
+        }
+        const std::vector<Connection>& sources = graph->output_sources[ch];
+        const float* first = source_buffer(graph, sources[0]);
+        if (first != outputs[ch]) {
+            memmove(outputs[ch], first, frames * sizeof(float));
+        }
+        for (size_t s = 1; s < sources.size(); ++s) {
+            const float* src = source_buffer(graph, sources[s]);
+            for (uint32_t i = 0; i < frames; ++i) {
+                outputs[ch][i] += src[i];
+            }
+        }
+    }
+
+    return graph->result.load(std::memory_order_relaxed);
+}
+
+uint32_t rack_graph_get_num_workers(RackGraph* graph) {
+    return graph ? static_cast<uint32_t>(graph->workers.size()) : 0;
+}
@@ -0,0 +1,63 @@
+#ifndef RACK_LATENCY_MONITOR_H
+#define RACK_LATENCY_MONITOR_H
+
+// Internal header shared by the VST3 and AudioUnit backends and
+// rack-wine-host (C++17, no plugin SDK dependency).
+//
+// LatencyMonitor tracks the latency and tail a plugin reports, for plugin
+// delay compensation. Plugins announce changes on their own threads
+// (IComponentHandler::restartComponent(kLatencyChanged), AudioUnit property
+// listeners); the host re-queries the plugin from a control thread and the
+// audio thread only polls a generation counter.
+
+#include <atomic>
+#include <cstdint>
+
+namespace rack {
+
+// Every method is lock-free and may be called from any thread.
+class LatencyMonitor {
+public:
+    // Tail that never ends (VST3 kInfiniteTail)
+    static constexpr uint32_t INFINITE_TAIL = 0xFFFFFFFFu;
+
+    // The plugin reported a change; the cached values are stale until the
+    // next update()
+    void mark_changed() {
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+
+    // Store freshly queried values. Values that differ from the cached ones
+    // also advance the generation, so changes the plugin did not announce
+    // are still seen by pollers.
+    void update(uint32_t latency_samples, uint32_t tail_samples) {
+        uint32_t old_latency = latency_.exchange(latency_samples, std::memory_order_relaxed);
+        uint32_t old_tail = tail_.exchange(tail_samples, std::memory_order_relaxed);
+        if (old_latency != latency_samples || old_tail != tail_samples) {
+            generation_.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    // Advances on every change; compare with the last value seen
+    uint32_t generation() const {
+        return generation_.load(std::memory_order_acquire);
+    }
+
+    // Cached values as of the last update()
+    uint32_t latency() const {
+        return latency_.load(std::memory_order_relaxed);
+    }
+
+    uint32_t tail() const {
+        return tail_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> generation_{0};
+    std::atomic<uint32_t> latency_{0};
+    std::atomic<uint32_t> tail_{0};
+};
+
+} // namespace rack
+
+#endif // RACK_LATENCY_MONITOR_H
@@ -0,0 +1,231 @@
+#ifndef RACK_PARAM_CHANGE_QUEUE_H
+#define RACK_PARAM_CHANGE_QUEUE_H
+
+// Internal header shared by the VST3 backend and rack-wine-host (C++17, no
+// VST3 SDK dependency).
+//
+// ParamChangeQueue carries parameter edits reported by a plugin
+// (IComponentHandler::performEdit) to the host. Any number of threads may
+// push; one thread pops. Repeated edits to the same parameter coalesce while
+// they are pending (last value wins), so a GUI drag occupies a single queue
+// entry no matter how many performEdit calls it makes. Edits that cannot be
+// recorded are counted instead of silently vanishing.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace rack {
+
+// Bounded lock-free multi-producer/single-consumer ring (Vyukov-style cells
+// with per-slot sequence numbers). Producers never block; the consumer never
+// blocks. Capacity must be a power of two.
+template <typename T, size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "MpscQueue capacity must be a power of two");
+
+public:
+    MpscQueue() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    // Producer (any thread): returns false if the queue is full
+    bool push(const T& item) {
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells_[pos & (Capacity - 1)];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->item = item;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer (single thread): returns false if the queue is empty
+    bool pop(T& out) {
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        Cell* cell = &cells_[pos & (Capacity - 1)];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        if (static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1) < 0) {
+            return false;
+        }
+        out = cell->item;
+        cell->sequence.store(pos + Capacity, std::memory_order_release);
+        dequeue_pos_.store(pos + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Approximate number of queued items (exact when producers are idle)
+    size_t size() const {
+        size_t enq = enqueue_pos_.load(std::memory_order_acquire);
+        size_t deq = dequeue_pos_.load(std::memory_order_acquire);
+        return enq > deq ? enq - deq : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T item;
+    };
+
+    alignas(64) Cell cells_[Capacity];
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) std::atomic<size_t> dequeue_pos_{0};
+};
+
+// Coalescing parameter change queue.
+// Each parameter ID gets a stable slot in a fixed open-addressing table the
+// first time it is edited. A slot is enqueued only when it goes from clean
+// to pending; further edits just overwrite its value. The queue therefore
+// holds at most one entry per parameter and cannot overflow while
+// QueueCapacity >= distinct parameters edited between two drains.
+template <size_t QueueCapacity = 1024, size_t TableCapacity = 4096>
+class ParamChangeQueue {
+    static_assert(TableCapacity >= 2 && (TableCapacity & (TableCapacity - 1)) == 0,
+                  "ParamChangeQueue table capacity must be a power of two");
+
+public:
+    // 0xFFFFFFFF is kNoParamId in VST3 and never names a real parameter
+    static constexpr uint32_t EMPTY_ID = 0xFFFFFFFFu;
+
+    ParamChangeQueue() {
+        for (size_t i = 0; i < TableCapacity; ++i) {
+            slots_[i].id.store(EMPTY_ID, std::memory_order_relaxed);
+            slots_[i].value_bits.store(0, std::memory_order_relaxed);
+            slots_[i].pending.store(0, std::memory_order_relaxed);
+        }
+    }
+    ParamChangeQueue(const ParamChangeQueue&) = delete;
+    ParamChangeQueue& operator=(const ParamChangeQueue&) = delete;
+
+    // Producer (any thread): record the latest value for id.
+    // Returns false (and bumps the overflow counter) if it could not be kept.
+    bool push(uint32_t id, double value) {
+        uint32_t index = 0;
+        if (id == EMPTY_ID || !find_or_insert(id, &index)) {
+            overflows_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        Slot& slot = slots_[index];
+        slot.value_bits.store(to_bits(value), std::memory_order_release);
+
+        // Already pending: the consumer will read the value just stored
+        if (slot.pending.exchange(1, std::memory_order_acq_rel) != 0) {
+            return true;
+        }
+
+        if (!queue_.push(index)) {
+            slot.pending.store(0, std::memory_order_release);
+            overflows_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // Consumer (single thread): returns false if nothing is pending
+    bool pop(uint32_t* id, double* value) {
+        uint32_t index = 0;
+        if (!queue_.pop(index)) {
+            return false;
+        }
+
+        Slot& slot = slots_[index];
+        // Clear pending before reading, so an edit racing with us re-enqueues
+        slot.pending.exchange(0, std::memory_order_acq_rel);
+        *id = slot.id.load(std::memory_order_relaxed);
+        *value = from_bits(slot.value_bits.load(std::memory_order_acquire));
+        return true;
+    }
+
+    // Consumer: number of parameters with a pending change (approximate
+    // while producers are active)
+    size_t pending_count() const {
+        return queue_.size();
+    }
+
+    // Consumer: drop all pending changes
+    void clear() {
+        uint32_t id = 0;
+        double value = 0.0;
+        while (pop(&id, &value)) {
+        }
+    }
+
+    // Number of edits dropped because the queue or the ID table was full
+    uint64_t overflow_count() const {
+        return overflows_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> id;
+        std::atomic<uint32_t> pending;
+        std::atomic<uint64_t> value_bits;
+    };
+
+    static uint64_t to_bits(double value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static double from_bits(uint64_t bits) {
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    static uint32_t hash(uint32_t id) {
+        uint32_t h = id * 0x9E3779B1u;
+        return h ^ (h >> 16);
+    }
+
+    // Slots are claimed with a CAS and never released, so an ID keeps its
+    // slot for the lifetime of the queue
+    bool find_or_insert(uint32_t id, uint32_t* index) {
+        uint32_t pos = hash(id) & (TableCapacity - 1);
+        for (size_t probe = 0; probe < TableCapacity; ++probe) {
+            Slot& slot = slots_[pos];
+            uint32_t current = slot.id.load(std::memory_order_acquire);
+            if (current == EMPTY_ID) {
+                if (slot.id.compare_exchange_strong(current, id, std::memory_order_acq_rel)) {
+                    *index = pos;
+                    return true;
+                }
+                // Lost the race; current now holds the winner's ID
+            }
+            if (current == id) {
+                *index = pos;
+                return true;
+            }
+            pos = (pos + 1) & (TableCapacity - 1);
+        }
+        return false;
+    }
+
+    Slot slots_[TableCapacity];
+    MpscQueue<uint32_t, QueueCapacity> queue_;
+    alignas(64) std::atomic<uint64_t> overflows_{0};
+};
+
+} // namespace rack
+
+#endif // RACK_PARAM_CHANGE_QUEUE_H
@@ -0,0 +1,91 @@
+#ifndef RACK_PARAM_INDEX_MAP_H
+#define RACK_PARAM_INDEX_MAP_H
+
+// Internal header shared by the VST3 and AudioUnit backends.
+//
+// ParamIndexMap maps a plugin-native 32-bit parameter ID (VST3 ParamID,
+// AudioUnitParameterID) back to its index in the cached parameter list.
+// It is a flat open-addressing table with linear probing, built once when
+// the parameter cache is built and read-only afterwards, so lookups are
+// lock-free and never allocate.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rack {
+
+class ParamIndexMap {
+public:
+    static constexpr int32_t NOT_FOUND = -1;
+
+    // Rebuild the table from an ID getter: id_at(i) returns the ID of
+    // parameter index i. Duplicate IDs keep the lowest index.
+    // Not realtime-safe (allocates).
+    template <typename IdAt>
+    void build(size_t count, IdAt id_at) {
+        // Keep load factor <= 0.5 so probe sequences stay short
+        size_t capacity = 16;
+        while (capacity < count * 2) {
+            capacity <<= 1;
+        }
+
+        slots_.assign(capacity, Slot{0, NOT_FOUND});
+        mask_ = capacity - 1;
+
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t id = id_at(i);
+            size_t pos = hash(id) & mask_;
+            while (slots_[pos].index != NOT_FOUND && slots_[pos].id != id) {
+                pos = (pos + 1) & mask_;
+            }
+            if (slots_[pos].index == NOT_FOUND) {
+                slots_[pos].id = id;
+                slots_[pos].index = static_cast<int32_t>(i);
+            }
+        }
+    }
+
+    // Drop all entries (not realtime-safe)
+    void clear() {
+        slots_.clear();
+        mask_ = 0;
+    }
+
+    // Returns the parameter index for id, or NOT_FOUND
+    // Realtime-safe: no allocation, bounded by the probe length.
+    int32_t find(uint32_t id) const {
+        if (slots_.empty()) {
+            return NOT_FOUND;
+        }
+
+        size_t pos = hash(id) & mask_;
+        while (slots_[pos].index != NOT_FOUND) {
+            if (slots_[pos].id == id) {
+                return slots_[pos].index;
+            }
+            pos = (pos + 1) & mask_;
+        }
+        return NOT_FOUND;
+    }
+
+private:
+    struct Slot {
+        uint32_t id;
+        int32_t index;
+    };
+
+    // Parameter IDs are often sequential or hashed by the plugin; a
+    // multiplicative mix spreads both cases across the table
+    static size_t hash(uint32_t id) {
+        uint32_t h = id * 0x9E3779B1u;
+        return static_cast<size_t>(h ^ (h >> 16));
+    }
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+};
+
+} // namespace rack
+
+#endif // RACK_PARAM_INDEX_MAP_H
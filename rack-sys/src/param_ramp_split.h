@@ -0,0 +1,67 @@
+#ifndef RACK_PARAM_RAMP_SPLIT_H
+#define RACK_PARAM_RAMP_SPLIT_H
+
+// Internal header for the VST3 backend (C++17, no VST3 SDK dependency).
+//
+// split_ramp_points() cuts one parameter's automation over a long span into
+// the part a sub-block of it should see, for process_split(). A VST3 point
+// queue describes a piecewise linear ramp: from the value the parameter had
+// on the frame before the block to the first point, then point to point,
+// then holding the last value. Each sub-block gets its points rebased to its
+// own start, plus an interpolated point on its last frame when a ramp
+// crosses its end, so the plugin follows the same ramp as it would in one
+// long block.
+
+#include <algorithm>
+#include <cstdint>
+
+namespace rack {
+
+// get_point(i, &offset, &value) reads point i of count (ordered by span
+// offset). previous_value is what the processor was last given, i.e. the
+// value on the frame before the sub-block (begin - 1), where a ramp to the
+// sub-block's first point starts. add_point(local_offset, value) receives
+// the sub-block's points in order; returning false stops the routing (e.g.
+// the target queue is full).
+// [begin, begin + frames) is the sub-block; last marks the final one,
+// which takes every remaining point, clamped to its last frame.
+template <typename GetPoint, typename AddPoint>
+void split_ramp_points(int32_t count, GetPoint get_point, double previous_value,
+                       int32_t begin, int32_t frames, bool last, AddPoint add_point) {
+    if (frames <= 0) {
+        return;
+    }
+    const int32_t end = begin + frames;
+    const int32_t last_frame = frames - 1;
+
+    int32_t previous_offset = begin - 1;
+
+    for (int32_t p = 0; p < count; ++p) {
+        int32_t offset = 0;
+        double value = 0.0;
+        get_point(p, &offset, &value);
+
+        // Earlier sub-blocks already covered it
+        if (offset < begin) {
+            continue;
+        }
+
+        if (offset >= end && !last) {
+            // previous_offset < end always holds here, so t is in [0, 1)
+            double t = static_cast<double>(end - 1 - previous_offset) /
+                       static_cast<double>(offset - previous_offset);
+            add_point(last_frame, previous_value + (value - previous_value) * t);
+            return;
+        }
+
+        if (!add_point(std::min(offset - begin, last_frame), value)) {
+            return;
+        }
+        previous_offset = offset;
+        previous_value = value;
+    }
+}
+
+} // namespace rack
+
+#endif // RACK_PARAM_RAMP_SPLIT_H
@@ -0,0 +1,265 @@
+#ifndef RACK_PERF_COUNTERS_H
+#define RACK_PERF_COUNTERS_H
+
+// Internal header shared by the VST3 and AudioUnit backends and
+// rack-wine-host (C++17, no plugin SDK dependency).
+//
+// PerfCounters keeps per-instance processing statistics: call and frame
+// counts, a log2 histogram of call times, the worst call, load against the
+// block deadline (frames / sample rate) and error/drop counters. The audio
+// thread is the only writer of the timing fields, so they are updated with
+// relaxed load/store pairs instead of read-modify-write instructions; a
+// block costs two cycle-counter reads and a handful of plain stores. Any
+// thread may take a snapshot.
+//
+// Build with RACK_PERF_COUNTERS=0 to compile the counters out: every method
+// becomes an empty inline function and snapshots stay zero.
+
+#ifndef RACK_PERF_COUNTERS
+#define RACK_PERF_COUNTERS 1
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace rack {
+
+// Histogram buckets: bucket i counts calls that took [2^i, 2^(i+1)) ns
+// (bucket 0 also counts 0 ns, the last bucket everything longer)
+static constexpr size_t PERF_HISTOGRAM_BUCKETS = 32;
+
+// Raw cycle counter: TSC on x86, the virtual counter on ARM64, the
+// monotonic clock elsewhere. Only differences are meaningful.
+inline uint64_t perf_ticks() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    return __rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+namespace detail {
+
+inline double measure_ns_per_tick() {
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    // Invariant TSC assumed; time it against the monotonic clock for 1 ms
+    using clock = std::chrono::steady_clock;
+    clock::time_point start = clock::now();
+    uint64_t start_ticks = perf_ticks();
+    clock::time_point now;
+    do {
+        now = clock::now();
+    } while (now - start < std::chrono::milliseconds(1));
+    uint64_t ticks = perf_ticks() - start_ticks;
+    double ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count());
+    return ticks > 0 ? ns / static_cast<double>(ticks) : 1.0;
+#elif defined(__aarch64__)
+    uint64_t frequency;
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(frequency));
+    return frequency > 0 ? 1e9 / static_cast<double>(frequency) : 1.0;
+#else
+    return 1.0;
+#endif
+}
+
+inline uint32_t perf_bucket(uint64_t ns) {
+    if (ns < 2) {
+        return 0;
+    }
+#if defined(_MSC_VER)
+    unsigned long bit;
+    _BitScanReverse64(&bit, ns);
+    uint32_t bucket = static_cast<uint32_t>(bit);
+#else
+    uint32_t bucket = 63 - static_cast<uint32_t>(__builtin_clzll(ns));
+#endif
+    return bucket < PERF_HISTOGRAM_BUCKETS ? bucket : static_cast<uint32_t>(PERF_HISTOGRAM_BUCKETS - 1);
+}
+
+} // namespace detail
+
+// Nanoseconds per perf_ticks() tick. Measured on the first call (about 1 ms
+// on x86), so PerfCounters calls it on construction, off the audio thread.
+inline double perf_ns_per_tick() {
+    static const double ns_per_tick = detail::measure_ns_per_tick();
+    return ns_per_tick;
+}
+
+// Point-in-time copy of the counters
+struct PerfSnapshot {
+    uint64_t process_calls = 0;
+    uint64_t frames = 0;
+    uint64_t total_ns = 0;           // Time spent in timed calls
+    uint64_t max_ns = 0;             // Slowest call
+    uint64_t deadline_ns = 0;        // Sum of the calls' block deadlines
+    uint64_t deadline_misses = 0;    // Calls slower than their block deadline
+    double max_load = 0.0;           // Largest call time / block deadline
+    uint64_t process_errors = 0;     // Failed process()/render calls into the plugin
+    uint64_t dropped_midi_events = 0;
+    uint64_t histogram[PERF_HISTOGRAM_BUCKETS] = {};
+};
+
+class PerfCounters {
+public:
+    PerfCounters() {
+#if RACK_PERF_COUNTERS
+        ns_per_tick_ = perf_ns_per_tick();
+#endif
+    }
+
+    // Block deadlines are frames / sample_rate; 0 leaves them unmeasured.
+    // Call before processing starts.
+    void set_sample_rate(double sample_rate) {
+#if RACK_PERF_COUNTERS
+        ns_per_frame_ = sample_rate > 0.0 ? 1e9 / sample_rate : 0.0;
+#else
+        (void)sample_rate;
+#endif
+    }
+
+    // Audio thread: take the start time of a call...
+    uint64_t begin() const {
+#if RACK_PERF_COUNTERS
+        return perf_ticks();
+#else
+        return 0;
+#endif
+    }
+
+    // ...and record it once it rendered `frames` frames
+    void end(uint64_t start_ticks, uint32_t frames) {
+#if RACK_PERF_COUNTERS
+        uint64_t ns = static_cast<uint64_t>(static_cast<double>(perf_ticks() - start_ticks) * ns_per_tick_);
+        if (reset_requested_.load(std::memory_order_relaxed)) {
+            clear();
+        }
+
+        bump(calls_, 1);
+        bump(frames_, frames);
+        bump(total_ns_, ns);
+        bump(histogram_[detail::perf_bucket(ns)], 1);
+        if (ns > max_ns_.load(std::memory_order_relaxed)) {
+            max_ns_.store(ns, std::memory_order_relaxed);
+        }
+
+        uint64_t deadline = static_cast<uint64_t>(frames * ns_per_frame_);
+        if (deadline > 0) {
+            bump(deadline_ns_, deadline);
+            if (ns > deadline) {
+                bump(deadline_misses_, 1);
+            }
+            double load = static_cast<double>(ns) / static_cast<double>(deadline);
+            if (load > max_load_.load(std::memory_order_relaxed)) {
+                max_load_.store(load, std::memory_order_relaxed);
+            }
+        }
+#else
+        (void)start_ticks;
+        (void)frames;
+#endif
+    }
+
+    // Audio thread: the plugin's process()/render call failed
+    void add_process_error() {
+#if RACK_PERF_COUNTERS
+        bump(process_errors_, 1);
+#endif
+    }
+
+    // Any thread: MIDI events that could not be queued
+    void add_dropped_midi(uint64_t count) {
+#if RACK_PERF_COUNTERS
+        dropped_midi_.fetch_add(count, std::memory_order_relaxed);
+#else
+        (void)count;
+#endif
+    }
+
+    // Any thread. Fields are read one by one, so a snapshot taken while a
+    // block is being recorded may mix that block in partially.
+    void snapshot(PerfSnapshot& out) const {
+        out = PerfSnapshot();
+#if RACK_PERF_COUNTERS
+        out.process_calls = calls_.load(std::memory_order_relaxed);
+        out.frames = frames_.load(std::memory_order_relaxed);
+        out.total_ns = total_ns_.load(std::memory_order_relaxed);
+        out.max_ns = max_ns_.load(std::memory_order_relaxed);
+        out.deadline_ns = deadline_ns_.load(std::memory_order_relaxed);
+        out.deadline_misses = deadline_misses_.load(std::memory_order_relaxed);
+        out.max_load = max_load_.load(std::memory_order_relaxed);
+        out.process_errors = process_errors_.load(std::memory_order_relaxed);
+        out.dropped_midi_events = dropped_midi_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < PERF_HISTOGRAM_BUCKETS; ++i) {
+            out.histogram[i] = histogram_[i].load(std::memory_order_relaxed);
+        }
+#endif
+    }
+
+    // Any thread: zero the counters. The audio thread does the clearing at
+    // its next block, so there is no race with its stores; the drop counter
+    // is cleared right away.
+    void reset() {
+#if RACK_PERF_COUNTERS
+        reset_requested_.store(true, std::memory_order_relaxed);
+        dropped_midi_.store(0, std::memory_order_relaxed);
+#endif
+    }
+
+private:
+#if RACK_PERF_COUNTERS
+    // Single writer: a plain load and store, no locked instruction
+    static void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void clear() {
+        reset_requested_.store(false, std::memory_order_relaxed);
+        calls_.store(0, std::memory_order_relaxed);
+        frames_.store(0, std::memory_order_relaxed);
+        total_ns_.store(0, std::memory_order_relaxed);
+        max_ns_.store(0, std::memory_order_relaxed);
+        deadline_ns_.store(0, std::memory_order_relaxed);
+        deadline_misses_.store(0, std::memory_order_relaxed);
+        max_load_.store(0.0, std::memory_order_relaxed);
+        process_errors_.store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < PERF_HISTOGRAM_BUCKETS; ++i) {
+            histogram_[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    double ns_per_tick_ = 1.0;
+    double ns_per_frame_ = 0.0;
+
+    // Written by the audio thread only
+    std::atomic<uint64_t> calls_{0};
+    std::atomic<uint64_t> frames_{0};
+    std::atomic<uint64_t> total_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+    std::atomic<uint64_t> deadline_ns_{0};
+    std::atomic<uint64_t> deadline_misses_{0};
+    std::atomic<double> max_load_{0.0};
+    std::atomic<uint64_t> process_errors_{0};
+    std::atomic<uint64_t> histogram_[PERF_HISTOGRAM_BUCKETS] = {};
+
+    // Written by any thread
+    std::atomic<uint64_t> dropped_midi_{0};
+    std::atomic<bool> reset_requested_{false};
+#endif
+};
+
+} // namespace rack
+
+#endif // RACK_PERF_COUNTERS_H
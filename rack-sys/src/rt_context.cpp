@@ -0,0 +1,432 @@
+#include "rack_rt.h"
+#include "rt_guard.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+    #include <dlfcn.h>
+    #include <pthread.h>
+    #include <sched.h>
+    #include <sys/mman.h>
+#elif defined(__APPLE__)
+    #include <mach/mach.h>
+    #include <mach/mach_time.h>
+    #include <mach/thread_policy.h>
+    #include <pthread.h>
+    #include <sys/mman.h>
+#elif defined(_WIN32)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+#endif
+
+// ============================================================================
+// Internal Structures
+// ============================================================================
+
+// Stack locked (and prefaulted) below the entering frame with RACK_RT_LOCK_MEMORY
+static constexpr size_t RT_STACK_LOCK_BYTES = 64 * 1024;
+
+struct RackRtContext {
+    uint32_t flags = 0;
+    uint32_t applied = 0;
+    uint64_t saved_fpu_mode = 0;
+
+#if defined(__linux__)
+    int saved_policy = SCHED_OTHER;
+    sched_param saved_param{};
+#elif defined(__APPLE__)
+    bool time_constraint = false;
+    qos_class_t saved_qos = QOS_CLASS_DEFAULT;
+    int saved_qos_priority = 0;
+#elif defined(_WIN32)
+    HMODULE avrt = nullptr;
+    HANDLE mmcss = nullptr;
+    int saved_priority = THREAD_PRIORITY_NORMAL;
+#endif
+
+    // Ranges locked through the context, unlocked on leave
+    std::vector<std::pair<const void*, size_t>> locked;
+};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static bool lock_range(const void* addr, size_t size) {
+#if defined(_WIN32)
+    return VirtualLock(const_cast<void*>(addr), size) != 0;
+#else
+    return mlock(addr, size) == 0;
+#endif
+}
+
+static void unlock_range(const void* addr, size_t size) {
+#if defined(_WIN32)
+    VirtualUnlock(const_cast<void*>(addr), size);
+#else
+    munlock(addr, size);
+#endif
+}
+
+static bool track_range(RackRtContext* ctx, const void* addr, size_t size) {
+    try {
+        ctx->locked.emplace_back(addr, size);
+        return true;
+    } catch (const std::bad_alloc&) {
+        unlock_range(addr, size);
+        return false;
+    }
+}
+
+// Fault in and lock the stack the thread will process on, so the first
+// deep call chain in process() doesn't page-fault. Not inlined: the buffer
+// has to live in a frame below the caller's.
+#if defined(_MSC_VER)
+__declspec(noinline)
+#else
+__attribute__((noinline))
+#endif
+static bool lock_stack(RackRtContext* ctx) {
+    volatile char stack[RT_STACK_LOCK_BYTES];
+    for (size_t i = 0; i < RT_STACK_LOCK_BYTES; i += 256) {
+        stack[i] = 0;
+    }
+    const void* addr = const_cast<const char*>(stack);
+    return lock_range(addr, RT_STACK_LOCK_BYTES) && track_range(ctx, addr, RT_STACK_LOCK_BYTES);
+}
+
+static bool raise_priority(RackRtContext* ctx, const RackRtConfig& config) {
+#if defined(__linux__)
+    if (pthread_getschedparam(pthread_self(), &ctx->saved_policy, &ctx->saved_param) != 0) {
+        return false;
+    }
+    int min = sched_get_priority_min(SCHED_FIFO);
+    int max = sched_get_priority_max(SCHED_FIFO);
+    sched_param param{};
+    param.sched_priority = config.priority > 0 ? std::clamp(static_cast<int>(config.priority), min, max)
+                                               : std::max(min, max - 5);
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+#elif defined(__APPLE__)
+    pthread_get_qos_class_np(pthread_self(), &ctx->saved_qos, &ctx->saved_qos_priority);
+    if (config.sample_rate > 0.0 && config.block_size > 0) {
+        // Time-constraint policy: the thread needs up to half of every
+        // callback period, the rest is headroom
+        mach_timebase_info_data_t timebase;
+        mach_timebase_info(&timebase);
+        double ticks_per_ns = static_cast<double>(timebase.denom) / timebase.numer;
+        double period_ns = config.block_size * 1e9 / config.sample_rate;
+
+        thread_time_constraint_policy_data_t policy;
+        policy.period = static_cast<uint32_t>(period_ns * ticks_per_ns);
+        policy.computation = static_cast<uint32_t>(period_ns * 0.5 * ticks_per_ns);
+        policy.constraint = policy.period;
+        policy.preemptible = 1;
+        ctx->time_constraint = thread_policy_set(
+            pthread_mach_thread_np(pthread_self()), THREAD_TIME_CONSTRAINT_POLICY,
+            reinterpret_cast<thread_policy_t>(&policy), THREAD_TIME_CONSTRAINT_POLICY_COUNT) == KERN_SUCCESS;
+        if (ctx->time_constraint) {
+            return true;
+        }
+    }
+    // Period unknown (or refused): the highest QoS class is the next best
+    return pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) == 0;
+#elif defined(_WIN32)
+    (void)config;
+    ctx->saved_priority = GetThreadPriority(GetCurrentThread());
+
+    // MMCSS is loaded dynamically so the library doesn't link avrt.lib
+    typedef HANDLE (WINAPI *AvSetMmThreadCharacteristicsFn)(LPCWSTR, LPDWORD);
+    ctx->avrt = LoadLibraryW(L"avrt.dll");
+    if (ctx->avrt) {
+        auto set_characteristics = reinterpret_cast<AvSetMmThreadCharacteristicsFn>(
+            GetProcAddress(ctx->avrt, "AvSetMmThreadCharacteristicsW"));
+        DWORD task_index = 0;
+        ctx->mmcss = set_characteristics ? set_characteristics(L"Pro Audio", &task_index) : nullptr;
+        if (ctx->mmcss) {
+            return true;
+        }
+    }
+    return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL) != 0;
+#else
+    (void)ctx;
+    (void)config;
+    return false;
+#endif
+}
+
+static void restore_priority(RackRtContext* ctx) {
+#if defined(__linux__)
+    pthread_setschedparam(pthread_self(), ctx->saved_policy, &ctx->saved_param);
+#elif defined(__APPLE__)
+    if (ctx->time_constraint) {
+        thread_standard_policy_data_t policy{};
+        thread_policy_set(pthread_mach_thread_np(pthread_self()), THREAD_STANDARD_POLICY,
+                          reinterpret_cast<thread_policy_t>(&policy), THREAD_STANDARD_POLICY_COUNT);
+    }
+    pthread_set_qos_class_self_np(ctx->saved_qos, ctx->saved_qos_priority);
+#elif defined(_WIN32)
+    if (ctx->mmcss) {
+        typedef BOOL (WINAPI *AvRevertMmThreadCharacteristicsFn)(HANDLE);
+        auto revert = reinterpret_cast<AvRevertMmThreadCharacteristicsFn>(
+            GetProcAddress(ctx->avrt, "AvRevertMmThreadCharacteristics"));
+        if (revert) {
+            revert(ctx->mmcss);
+        }
+    }
+    SetThreadPriority(GetCurrentThread(), ctx->saved_priority);
+#else
+    (void)ctx;
+#endif
+}
+
+// ============================================================================
+// Realtime Checks (RACK_RT_CHECKS)
+// ============================================================================
+
+#if RACK_RT_CHECKS
+
+namespace rack {
+namespace detail {
+
+thread_local int rt_check_depth = 0;
+
+} // namespace detail
+} // namespace rack
+
+namespace {
+
+std::atomic<uint64_t> g_rt_allocations{0};
+std::atomic<uint64_t> g_rt_locks{0};
+thread_local bool t_rt_reported = false;
+
+void rt_violation(std::atomic<uint64_t>& counter, const char* what) {
+    counter.fetch_add(1, std::memory_order_relaxed);
+    if (t_rt_reported) {
+        return;
+    }
+    t_rt_reported = true;
+
+    // Leave the scope while reporting: stderr output may allocate or lock
+    int depth = rack::detail::rt_check_depth;
+    rack::detail::rt_check_depth = 0;
+    fprintf(stderr, "rack: %s inside process() - not realtime-safe "
+                    "(further violations on this thread are only counted)\n", what);
+    rack::detail::rt_check_depth = depth;
+}
+
+void* checked_alloc(size_t size, size_t alignment) {
+    if (rack::detail::rt_check_depth > 0) {
+        rt_violation(g_rt_allocations, "memory allocation");
+    }
+    if (size == 0) {
+        size = 1;
+    }
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(size);
+    }
+#if defined(_WIN32)
+    return _aligned_malloc(size, alignment);
+#else
+    void* ptr = nullptr;
+    return posix_memalign(&ptr, alignment, size) == 0 ? ptr : nullptr;
+#endif
+}
+
+void checked_free(void* ptr, bool aligned) {
+    if (!ptr) {
+        return;
+    }
+    if (rack::detail::rt_check_depth > 0) {
+        rt_violation(g_rt_allocations, "memory release");
+    }
+#if defined(_WIN32)
+    if (aligned) {
+        _aligned_free(ptr);
+        return;
+    }
+#else
+    (void)aligned;
+#endif
+    std::free(ptr);
+}
+
+void* checked_new(size_t size, size_t alignment) {
+    void* ptr = checked_alloc(size, alignment);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+constexpr size_t kDefaultAlignment = alignof(std::max_align_t);
+
+} // namespace
+
+// Replacement allocation functions. They only count while the thread is in
+// an RtCheckScope; plugin code allocating through them is caught too where
+// the platform resolves its operator new to the executable's.
+void* operator new(size_t size) { return checked_new(size, kDefaultAlignment); }
+void* operator new[](size_t size) { return checked_new(size, kDefaultAlignment); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return checked_alloc(size, kDefaultAlignment); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return checked_alloc(size, kDefaultAlignment); }
+void* operator new(size_t size, std::align_val_t al) { return checked_new(size, static_cast<size_t>(al)); }
+void* operator new[](size_t size, std::align_val_t al) { return checked_new(size, static_cast<size_t>(al)); }
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return checked_alloc(size, static_cast<size_t>(al));
+}
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return checked_alloc(size, static_cast<size_t>(al));
+}
+
+void operator delete(void* ptr) noexcept { checked_free(ptr, false); }
+void operator delete[](void* ptr) noexcept { checked_free(ptr, false); }
+void operator delete(void* ptr, size_t) noexcept { checked_free(ptr, false); }
+void operator delete[](void* ptr, size_t) noexcept { checked_free(ptr, false); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { checked_free(ptr, false); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { checked_free(ptr, false); }
+void operator delete(void* ptr, std::align_val_t al) noexcept {
+    checked_free(ptr, static_cast<size_t>(al) > kDefaultAlignment);
+}
+void operator delete[](void* ptr, std::align_val_t al) noexcept {
+    checked_free(ptr, static_cast<size_t>(al) > kDefaultAlignment);
+}
+void operator delete(void* ptr, size_t, std::align_val_t al) noexcept {
+    checked_free(ptr, static_cast<size_t>(al) > kDefaultAlignment);
+}
+void operator delete[](void* ptr, size_t, std::align_val_t al) noexcept {
+    checked_free(ptr, static_cast<size_t>(al) > kDefaultAlignment);
+}
+
+#if defined(__linux__)
+// Interpose pthread_mutex_lock (std::mutex locks through it) and forward to
+// libc. The forwarding pointer is constant-initialized, so the first lock
+// doesn't go through a guarded static.
+extern "C" int pthread_mutex_lock(pthread_mutex_t* mutex) noexcept {
+    typedef int (*LockFn)(pthread_mutex_t*);
+    static std::atomic<LockFn> real_lock{nullptr};
+
+    LockFn lock = real_lock.load(std::memory_order_acquire);
+    if (!lock) {
+        lock = reinterpret_cast<LockFn>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+        real_lock.store(lock, std::memory_order_release);
+    }
+    if (rack::detail::rt_check_depth > 0) {
+        rt_violation(g_rt_locks, "mutex lock");
+    }
+    return lock(mutex);
+}
+#endif
+
+#endif // RACK_RT_CHECKS
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+extern "C" {
+
+RackRtContext* rack_rt_context_enter(const RackRtConfig* config) {
+    RackRtConfig defaults{};
+    defaults.flags = RACK_RT_FLUSH_DENORMALS | RACK_RT_REALTIME_PRIORITY | RACK_RT_LOCK_MEMORY;
+    const RackRtConfig& cfg = config ? *config : defaults;
+
+    auto* ctx = new(std::nothrow) RackRtContext();
+    if (!ctx) {
+        return nullptr;
+    }
+    ctx->flags = cfg.flags;
+    ctx->saved_fpu_mode = rack::fpu_mode();
+
+    if ((cfg.flags & RACK_RT_FLUSH_DENORMALS) && rack::fpu_can_flush_denormals()) {
+        rack::set_fpu_mode(rack::fpu_mode_flush_denormals(ctx->saved_fpu_mode));
+        ctx->applied |= RACK_RT_FLUSH_DENORMALS;
+    }
+
+    if ((cfg.flags & RACK_RT_REALTIME_PRIORITY) && raise_priority(ctx, cfg)) {
+        ctx->applied |= RACK_RT_REALTIME_PRIORITY;
+    }
+
+    if ((cfg.flags & RACK_RT_LOCK_MEMORY) && lock_stack(ctx)) {
+        ctx->applied |= RACK_RT_LOCK_MEMORY;
+    }
+
+    return ctx;
+}
+
+void rack_rt_context_leave(RackRtContext* ctx) {
+    if (!ctx) {
+        return;
+    }
+
+    for (const auto& range : ctx->locked) {
+        unlock_range(range.first, range.second);
+    }
+
+    if (ctx->applied & RACK_RT_REALTIME_PRIORITY) {
+        restore_priority(ctx);
+    }
+#if defined(_WIN32)
+    if (ctx->avrt) {
+        FreeLibrary(ctx->avrt);
+    }
+#endif
+
+    if (ctx->applied & RACK_RT_FLUSH_DENORMALS) {
+        rack::set_fpu_mode(ctx->saved_fpu_mode);
+    }
+
+    delete ctx;
+}
+
+uint32_t rack_rt_context_applied(const RackRtContext* ctx) {
+    return ctx ? ctx->applied : 0;
+}
+
+int rack_rt_context_lock_memory(RackRtContext* ctx, const void* addr, size_t size) {
+    if (!ctx || (!addr && size > 0)) {
+        return RACK_RT_ERROR_INVALID_PARAM;
+    }
+    if (!(ctx->flags & RACK_RT_LOCK_MEMORY) || size == 0) {
+        return RACK_RT_OK;
+    }
+
+    if (!lock_range(addr, size) || !track_range(ctx, addr, size)) {
+        return RACK_RT_ERROR_GENERIC;
+    }
+    ctx->applied |= RACK_RT_LOCK_MEMORY;
+    return RACK_RT_OK;
+}
+
+int rack_rt_get_violations(uint64_t* allocations, uint64_t* locks) {
+#if RACK_RT_CHECKS
+    if (allocations) {
+        *allocations = g_rt_allocations.load(std::memory_order_relaxed);
+    }
+    if (locks) {
+        *locks = g_rt_locks.load(std::memory_order_relaxed);
+    }
+    return RACK_RT_OK;
+#else
+    if (allocations) {
+        *allocations = 0;
+    }
+    if (locks) {
+        *locks = 0;
+    }
+    return RACK_RT_ERROR_NOT_SUPPORTED;
+#endif
+}
+
+} // extern "C"
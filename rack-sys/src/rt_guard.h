@@ -0,0 +1,133 @@
+#ifndef RACK_RT_GUARD_H
+#define RACK_RT_GUARD_H
+
+// Internal header shared by the VST3 and AudioUnit backends and
+// rack-wine-host (C++17, no plugin SDK dependency).
+//
+// Floating-point mode and realtime checks for the process path.
+//
+// ScopedFlushDenormals turns on flush-to-zero and denormals-are-zero (MXCSR
+// FTZ|DAZ on x86, FPCR.FZ on ARM64) for one process call and restores the
+// caller's mode afterwards. Decaying reverb and filter tails otherwise run
+// into denormal operands, which cost x86 cores up to ~100 cycles each. When
+// the mode is already set (rack_rt_context_enter) the scope is one register
+// read.
+//
+// RtCheckScope marks the calling thread as inside a process path. With
+// RACK_RT_CHECKS=1 (Debug builds) rt_context.cpp counts and reports memory
+// allocation and, on Linux, mutex locking inside a scope; with
+// RACK_RT_CHECKS=0 the scope compiles to nothing.
+
+#ifndef RACK_RT_CHECKS
+#define RACK_RT_CHECKS 0
+#endif
+
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define RACK_FPU_MXCSR 1
+#elif defined(__aarch64__) && !defined(_MSC_VER)
+#define RACK_FPU_FPCR 1
+#endif
+
+namespace rack {
+
+// Control register value: MXCSR on x86, FPCR on ARM64, 0 elsewhere
+inline uint64_t fpu_mode() {
+#if defined(RACK_FPU_MXCSR)
+    return _mm_getcsr();
+#elif defined(RACK_FPU_FPCR)
+    uint64_t fpcr;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+    return fpcr;
+#else
+    return 0;
+#endif
+}
+
+inline void set_fpu_mode(uint64_t mode) {
+#if defined(RACK_FPU_MXCSR)
+    _mm_setcsr(static_cast<unsigned int>(mode));
+#elif defined(RACK_FPU_FPCR)
+    __asm__ __volatile__("msr fpcr, %0" : : "r"(mode));
+#else
+    (void)mode;
+#endif
+}
+
+// mode with denormal flushing turned on
+inline uint64_t fpu_mode_flush_denormals(uint64_t mode) {
+#if defined(RACK_FPU_MXCSR)
+    return mode | 0x8040;  // FTZ (bit 15) | DAZ (bit 6)
+#elif defined(RACK_FPU_FPCR)
+    return mode | (uint64_t(1) << 24);  // FZ
+#else
+    return mode;
+#endif
+}
+
+// Whether this platform can flush denormals at all
+inline bool fpu_can_flush_denormals() {
+#if defined(RACK_FPU_MXCSR) || defined(RACK_FPU_FPCR)
+    return true;
+#else
+    return false;
+#endif
+}
+
+class ScopedFlushDenormals {
+public:
+    ScopedFlushDenormals() : saved_(fpu_mode()) {
+        uint64_t mode = fpu_mode_flush_denormals(saved_);
+        if (mode != saved_) {
+            set_fpu_mode(mode);
+        }
+    }
+
+    ~ScopedFlushDenormals() {
+        if (fpu_mode() != saved_) {
+            set_fpu_mode(saved_);
+        }
+    }
+
+    ScopedFlushDenormals(const ScopedFlushDenormals&) = delete;
+    ScopedFlushDenormals& operator=(const ScopedFlushDenormals&) = delete;
+
+private:
+    uint64_t saved_;
+};
+
+#if RACK_RT_CHECKS
+
+namespace detail {
+
+// Depth of RtCheckScopes on this thread. Defined next to the checks in
+// rt_context.cpp, so every user of a scope links them in.
+extern thread_local int rt_check_depth;
+
+} // namespace detail
+
+class RtCheckScope {
+public:
+    RtCheckScope() { ++detail::rt_check_depth; }
+    ~RtCheckScope() { --detail::rt_check_depth; }
+
+    RtCheckScope(const RtCheckScope&) = delete;
+    RtCheckScope& operator=(const RtCheckScope&) = delete;
+};
+
+#else
+
+class RtCheckScope {
+public:
+    RtCheckScope() = default;
+    RtCheckScope(const RtCheckScope&) = delete;
+    RtCheckScope& operator=(const RtCheckScope&) = delete;
+};
+
+#endif // RACK_RT_CHECKS
+
+} // namespace rack
+
+#endif // RACK_RT_GUARD_H
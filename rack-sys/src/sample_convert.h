@@ -0,0 +1,803 @@
+#ifndef RACK_SAMPLE_CONVERT_H
+#define RACK_SAMPLE_CONVERT_H
+
+// Internal header shared by rack-sys (rack_convert.h) and rack-wine-host
+// (C++17, no plugin SDK dependency).
+//
+// Sample format kernels for the host side of process(): interleaved <->
+// planar, integer <-> float with clipping and optional TPDF dither, and
+// mix/gain. On x86 the SSE2 or AVX2 versions are picked at runtime (AVX2
+// code is compiled with a target attribute, so the build needs no -mavx2);
+// ARM64 uses NEON. The scalar versions define the conversion rules and
+// handle the tails.
+//
+// Conventions: integer full scale maps to [-1.0, 1.0) (s16 / 32768), float
+// to integer rounds to nearest and clips to the integer range (NaN becomes
+// negative full scale). Dither adds triangular noise of +/-1 LSB before
+// rounding.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define RACK_CONVERT_SSE2 1
+    #if defined(__GNUC__) || defined(__clang__)
+        #include <immintrin.h>
+        #define RACK_CONVERT_AVX2 1
+        #define RACK_CONVERT_TARGET_AVX2 __attribute__((target("avx2")))
+    #elif defined(_MSC_VER)
+        #include <immintrin.h>
+        #include <intrin.h>
+        #define RACK_CONVERT_AVX2 1
+        #define RACK_CONVERT_TARGET_AVX2
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define RACK_CONVERT_NEON 1
+#endif
+
+namespace rack {
+
+// Per-lane xorshift32 state for TPDF dither. Eight lanes so every kernel
+// width draws the same sequence: sample i always uses lane i % 8.
+struct DitherState {
+    uint32_t lanes[8];
+};
+
+inline void dither_seed(DitherState* state, uint32_t seed) {
+    for (uint32_t i = 0; i < 8; ++i) {
+        // splitmix32-style scramble; xorshift must not start at zero
+        uint32_t x = seed + 0x9E3779B9u * (i + 1);
+        x = (x ^ (x >> 16)) * 0x85EBCA6Bu;
+        x = (x ^ (x >> 13)) * 0xC2B2AE35u;
+        x ^= x >> 16;
+        state->lanes[i] = x ? x : 0x6D2B79F5u;
+    }
+}
+
+namespace convert_detail {
+
+constexpr float S16_SCALE = 32768.0f;
+constexpr float S24_SCALE = 8388608.0f;
+constexpr float S32_SCALE = 2147483648.0f;
+constexpr float S32_MAX = 2147483520.0f;    // Largest float below 2^31
+constexpr float NOISE_SCALE = 1.0f / 16777216.0f;
+
+inline uint32_t xorshift(uint32_t& x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Triangular noise in (-1, 1) from two uniform draws of 24 bits
+inline float tpdf(uint32_t& lane) {
+    float a = static_cast<float>(xorshift(lane) >> 8) * NOISE_SCALE;
+    float b = static_cast<float>(xorshift(lane) >> 8) * NOISE_SCALE;
+    return a - b;
+}
+
+// Written so NaN selects lo, like the SIMD min/max sequences
+inline float clip(float v, float lo, float hi) {
+    v = v > lo ? v : lo;
+    return v < hi ? v : hi;
+}
+
+inline int32_t float_to_int(float x, float scale, float hi, DitherState* dither, size_t i) {
+    float v = x * scale;
+    if (dither) {
+        v += tpdf(dither->lanes[i & 7]);
+    }
+    return static_cast<int32_t>(std::nearbyint(clip(v, -scale, hi)));
+}
+
+// ============================================================================
+// Scalar Kernels
+// ============================================================================
+
+inline void deinterleave_scalar(const float* src, float* const* dst, uint32_t channels, size_t frames) {
+    if (channels == 1) {
+        memcpy(dst[0], src, frames * sizeof(float));
+        return;
+    }
+    for (uint32_t ch = 0; ch < channels; ++ch) {
+        float* out = dst[ch];
+        const float* in = src + ch;
+        for (size_t f = 0; f < frames; ++f) {
+            out[f] = in[f * channels];
+        }
+    }
+}
+
+inline void interleave_scalar(const float* const* src, float* dst, uint32_t channels, size_t frames) {
+    if (channels == 1) {
+        memcpy(dst, src[0], frames * sizeof(float));
+        return;
+    }
+    for (uint32_t ch = 0; ch < channels; ++ch) {
+        const float* in = src[ch];
+        float* out = dst + ch;
+        for (size_t f = 0; f < frames; ++f) {
+            out[f * channels] = in[f];
+        }
+    }
+}
+
+inline void s16_to_f32_scalar(const int16_t* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<float>(src[i]) * (1.0f / S16_SCALE);
+    }
+}
+
+inline void f32_to_s16_scalar(const float* src, int16_t* dst, size_t count, DitherState* dither) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<int16_t>(float_to_int(src[i], S16_SCALE, S16_SCALE - 1.0f, dither, i));
+    }
+}
+
+inline void s32_to_f32_scalar(const int32_t* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<float>(src[i]) * (1.0f / S32_SCALE);
+    }
+}
+
+inline void f32_to_s32_scalar(const float* src, int32_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = float_to_int(src[i], S32_SCALE, S32_MAX, nullptr, i);
+    }
+}
+
+inline void mix_add_scalar(const float* src, float* dst, size_t count, float gain) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+inline void apply_gain_scalar(float* buffer, size_t count, float gain) {
+    for (size_t i = 0; i < count; ++i) {
+        buffer[i] *= gain;
+    }
+}
+
+// ============================================================================
+// SSE2 Kernels
+// ============================================================================
+
+#if defined(RACK_CONVERT_SSE2)
+
+inline __m128i xorshift_sse2(__m128i x) {
+    x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+    x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+    return _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+}
+
+inline __m128 tpdf_sse2(__m128i& lanes) {
+    const __m128 scale = _mm_set1_ps(NOISE_SCALE);
+    lanes = xorshift_sse2(lanes);
+    __m128 a = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(lanes, 8)), scale);
+    lanes = xorshift_sse2(lanes);
+    __m128 b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(lanes, 8)), scale);
+    return _mm_sub_ps(a, b);
+}
+
+inline void deinterleave_sse2(const float* src, float* const* dst, uint32_t channels, size_t frames) {
+    if (channels != 2) {
+        deinterleave_scalar(src, dst, channels, frames);
+        return;
+    }
+    float* left = dst[0];
+    float* right = dst[1];
+    size_t f = 0;
+    for (; f + 4 <= frames; f += 4) {
+        __m128 a = _mm_loadu_ps(src + 2 * f);
+        __m128 b = _mm_loadu_ps(src + 2 * f + 4);
+        _mm_storeu_ps(left + f, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm_storeu_ps(right + f, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    for (; f < frames; ++f) {
+        left[f] = src[2 * f];
+        right[f] = src[2 * f + 1];
+    }
+}
+
+inline void interleave_sse2(const float* const* src, float* dst, uint32_t channels, size_t frames) {
+    if (channels != 2) {
+        interleave_scalar(src, dst, channels, frames);
+        return;
+    }
+    const float* left = src[0];
+    const float* right = src[1];
+    size_t f = 0;
+    for (; f + 4 <= frames; f += 4) {
+        __m128 l = _mm_loadu_ps(left + f);
+        __m128 r = _mm_loadu_ps(right + f);
+        _mm_storeu_ps(dst + 2 * f, _mm_unpacklo_ps(l, r));
+        _mm_storeu_ps(dst + 2 * f + 4, _mm_unpackhi_ps(l, r));
+    }
+    for (; f < frames; ++f) {
+        dst[2 * f] = left[f];
+        dst[2 * f + 1] = right[f];
+    }
+}
+
+inline void s16_to_f32_sse2(const int16_t* src, float* dst, size_t count) {
+    const __m128 scale = _mm_set1_ps(1.0f / S16_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        // Duplicate each sample into a 32-bit lane, then shift to sign-extend
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    s16_to_f32_scalar(src + i, dst + i, count - i);
+}
+
+inline void f32_to_s16_sse2(const float* src, int16_t* dst, size_t count, DitherState* dither) {
+    const __m128 scale = _mm_set1_ps(S16_SCALE);
+    const __m128 lo = _mm_set1_ps(-S16_SCALE);
+    const __m128 hi = _mm_set1_ps(S16_SCALE - 1.0f);
+    __m128i lanes0 = _mm_setzero_si128();
+    __m128i lanes1 = _mm_setzero_si128();
+    if (dither) {
+        lanes0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dither->lanes));
+        lanes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dither->lanes + 4));
+    }
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+        if (dither) {
+            a = _mm_add_ps(a, tpdf_sse2(lanes0));
+            b = _mm_add_ps(b, tpdf_sse2(lanes1));
+        }
+        a = _mm_min_ps(_mm_max_ps(a, lo), hi);
+        b = _mm_min_ps(_mm_max_ps(b, lo), hi);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+    }
+
+    if (dither) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dither->lanes), lanes0);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dither->lanes + 4), lanes1);
+    }
+    f32_to_s16_scalar(src + i, dst + i, count - i, dither);
+}
+
+inline void s32_to_f32_sse2(const int32_t* src, float* dst, size_t count) {
+    const __m128 scale = _mm_set1_ps(1.0f / S32_SCALE);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+    s32_to_f32_scalar(src + i, dst + i, count - i);
+}
+
+inline void f32_to_s32_sse2(const float* src, int32_t* dst, size_t count) {
+    const __m128 scale = _mm_set1_ps(S32_SCALE);
+    const __m128 lo = _mm_set1_ps(-S32_SCALE);
+    const __m128 hi = _mm_set1_ps(S32_MAX);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        v = _mm_min_ps(_mm_max_ps(v, lo), hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_cvtps_epi32(v));
+    }
+    f32_to_s32_scalar(src + i, dst + i, count - i);
+}
+
+inline void mix_add_sse2(const float* src, float* dst, size_t count, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_add_ps(_mm_loadu_ps(dst + i), _mm_mul_ps(_mm_loadu_ps(src + i), g));
+        __m128 b = _mm_add_ps(_mm_loadu_ps(dst + i + 4), _mm_mul_ps(_mm_loadu_ps(src + i + 4), g));
+        _mm_storeu_ps(dst + i, a);
+        _mm_storeu_ps(dst + i + 4, b);
+    }
+    mix_add_scalar(src + i, dst + i, count - i, gain);
+}
+
+inline void apply_gain_sse2(float* buffer, size_t count, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm_storeu_ps(buffer + i, _mm_mul_ps(_mm_loadu_ps(buffer + i), g));
+        _mm_storeu_ps(buffer + i + 4, _mm_mul_ps(_mm_loadu_ps(buffer + i + 4), g));
+    }
+    apply_gain_scalar(buffer + i, count - i, gain);
+}
+
+#endif // RACK_CONVERT_SSE2
+
+// ============================================================================
+// AVX2 Kernels
+// ============================================================================
+
+#if defined(RACK_CONVERT_AVX2)
+
+RACK_CONVERT_TARGET_AVX2 inline __m256i xorshift_avx2(__m256i x) {
+    x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+    return _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+}
+
+RACK_CONVERT_TARGET_AVX2 inline __m256 tpdf_avx2(__m256i& lanes) {
+    const __m256 scale = _mm256_set1_ps(NOISE_SCALE);
+    lanes = xorshift_avx2(lanes);
+    __m256 a = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(lanes, 8)), scale);
+    lanes = xorshift_avx2(lanes);
+    __m256 b = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srli_epi32(lanes, 8)), scale);
+    return _mm256_sub_ps(a, b);
+}
+
+RACK_CONVERT_TARGET_AVX2 inline void deinterleave_avx2(const float* src, float* const* dst,
+                                                       uint32_t channels, size_t frames) {
+    if (channels != 2) {
+        deinterleave_scalar(src, dst, channels, frames);
+        return;
+    }
+    float* left = dst[0];
+    float* right = dst[1];
+    size_t f = 0;
+    for (; f + 8 <= frames; f += 8) {
+        __m256 a = _mm256_loadu_ps(src + 2 * f);
+        __m256 b = _mm256_loadu_ps(src + 2 * f + 8);
+        // Pair up frames 0-1/4-5 and 2-3/6-7 so each 128-bit lane shuffles alone
+        __m256 t0 = _mm256_permute2f128_ps(a, b, 0x20);
+        __m256 t1 = _mm256_permute2f128_ps(a, b, 0x31);
+        _mm256_storeu_ps(left + f, _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0)));
+        _mm256_storeu_ps(right + f, _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+    for (; f < frames; ++f) {
+        left[f] = src[2 * f];
+        right[f] = src[2 * f + 1];
+    }
+}
+
+RACK_CONVERT_TARGET_AVX2 inline void interleave_avx2(const float* const* src, float* dst,
+                                                     uint32_t channels, size_t frames) {
+    if (channels != 2) {
+        interleave_scalar(src, dst, channels, frames);
+        return;
+    }
+    const float* left = src[0];
+    const float* right = src[1];
+    size_t f = 0;
+    for (; f + 8 <= frames; f += 8) {
+        __m256 l = _mm256_loadu_ps(left + f);
+        __m256 r = _mm256_loadu_ps(right + f);
+        __m256 lo = _mm256_unpacklo_ps(l, r);  // Frames 0-1 | 4-5
+        __m256 hi = _mm256_unpackhi_ps(l, r);  // Frames 2-3 | 6-7
+        _mm256_storeu_ps(dst + 2 * f, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(dst + 2 * f + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    for (; f < frames; ++f) {
+        dst[2 * f] = left[f];
+        dst[2 * f + 1] = right[f];
+    }
+}
+
+RACK_CONVERT_TARGET_AVX2 inline void s16_to_f32_avx2(const int16_t* src, float* dst, size_t count) {
+    const __m256 scale = _mm256_set1_ps(1.0f / S16_SCALE);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(a)), scale));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(b)), scale));
+    }
+    s16_to_f32_scalar(src + i, dst + i, count - i);
+}
+
+RACK_CONVERT_TARGET_AVX2 inline void f32_to_s16_avx2(const float* src, int16_t* dst, size_t count,
+                                                     DitherState* dither) {
+    const __m256 scale = _mm256_set1_ps(S16_SCALE);
+    const __m256 lo = _mm256_set1_ps(-S16_SCALE);
+    const __m256 hi = _mm256_set1_ps(S16_SCALE - 1.0f);
+    __m256i lanes = _mm256_setzero_si256();
+    if (dither) {
+        lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dither->lanes));
+    }
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        if (dither) {
+            v = _mm256_add_ps(v, tpdf_avx2(lanes));
+        }
+        v = _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+        __m256i ints = _mm256_cvtps_epi32(v);
+        __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(ints), _mm256_extracti128_si256(ints, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), packed);
+    }
+
+    if (dither) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dither->lanes), lanes);
+    }
+    f32_to_s16_scalar(src + i, dst + i, count - i, dither);
+}
+
+RACK_CONVERT_TARGET_AVX2 inline void s32_to_f32_avx2(const int32_t* src, float* dst, size_t count) {
+    const __m256 scale = _mm256_set1_ps(1.0f / S32_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    s32_to_f32_scalar(src + i, dst + i, count - i);
+}
+
+RACK_CONVERT_TARGET_AVX2 inline void f32_to_s32_avx2(const float* src, int32_t* dst, size_t count) {
+    const __m256 scale = _mm256_set1_ps(S32_SCALE);
+    const __m256 lo = _mm256_set1_ps(-S32_SCALE);
+    const __m256 hi = _mm256_set1_ps(S32_MAX);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        v = _mm256_min_ps(_mm256_max_ps(v, lo), hi);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_cvtps_epi32(v));
+    }
+    f32_to_s32_scalar(src + i, dst + i, count - i);
+}
+
+RACK_CONVERT_TARGET_AVX2 inline void mix_add_avx2(const float* src, float* dst, size_t count, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_add_ps(_mm256_loadu_ps(dst + i), _mm256_mul_ps(_mm256_loadu_ps(src + i), g));
+        __m256 b = _mm256_add_ps(_mm256_loadu_ps(dst + i + 8), _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), g));
+        _mm256_storeu_ps(dst + i, a);
+        _mm256_storeu_ps(dst + i + 8, b);
+    }
+    mix_add_scalar(src + i, dst + i, count - i, gain);
+}
+
+RACK_CONVERT_TARGET_AVX2 inline void apply_gain_avx2(float* buffer, size_t count, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm256_storeu_ps(buffer + i, _mm256_mul_ps(_mm256_loadu_ps(buffer + i), g));
+        _mm256_storeu_ps(buffer + i + 8, _mm256_mul_ps(_mm256_loadu_ps(buffer + i + 8), g));
+    }
+    apply_gain_scalar(buffer + i, count - i, gain);
+}
+
+inline bool cpu_has_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7) {
+        return false;
+    }
+    __cpuid(regs, 1);
+    // OSXSAVE and AVX, and the OS saves YMM state
+    if ((regs[2] & (1 << 27)) == 0 || (regs[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif // RACK_CONVERT_AVX2
+
+// ============================================================================
+// NEON Kernels
+// ============================================================================
+
+#if defined(RACK_CONVERT_NEON)
+
+inline uint32x4_t xorshift_neon(uint32x4_t x) {
+    x = veorq_u32(x, vshlq_n_u32(x, 13));
+    x = veorq_u32(x, vshrq_n_u32(x, 17));
+    return veorq_u32(x, vshlq_n_u32(x, 5));
+}
+
+inline float32x4_t tpdf_neon(uint32x4_t& lanes) {
+    lanes = xorshift_neon(lanes);
+    float32x4_t a = vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(lanes, 8)), NOISE_SCALE);
+    lanes = xorshift_neon(lanes);
+    float32x4_t b = vmulq_n_f32(vcvtq_f32_u32(vshrq_n_u32(lanes, 8)), NOISE_SCALE);
+    return vsubq_f32(a, b);
+}
+
+// vmaxnm/vminnm return the number when one operand is NaN
+inline float32x4_t clip_neon(float32x4_t v, float32x4_t lo, float32x4_t hi) {
+    return vminnmq_f32(vmaxnmq_f32(v, lo), hi);
+}
+
+inline void deinterleave_neon(const float* src, float* const* dst, uint32_t channels, size_t frames) {
+    if (channels != 2) {
+        deinterleave_scalar(src, dst, channels, frames);
+        return;
+    }
+    float* left = dst[0];
+    float* right = dst[1];
+    size_t f = 0;
+    for (; f + 4 <= frames; f += 4) {
+        float32x4x2_t v = vld2q_f32(src + 2 * f);
+        vst1q_f32(left + f, v.val[0]);
+        vst1q_f32(right + f, v.val[1]);
+    }
+    for (; f < frames; ++f) {
+        left[f] = src[2 * f];
+        right[f] = src[2 * f + 1];
+    }
+}
+
+inline void interleave_neon(const float* const* src, float* dst, uint32_t channels, size_t frames) {
+    if (channels != 2) {
+        interleave_scalar(src, dst, channels, frames);
+        return;
+    }
+    const float* left = src[0];
+    const float* right = src[1];
+    size_t f = 0;
+    for (; f + 4 <= frames; f += 4) {
+        float32x4x2_t v;
+        v.val[0] = vld1q_f32(left + f);
+        v.val[1] = vld1q_f32(right + f);
+        vst2q_f32(dst + 2 * f, v);
+    }
+    for (; f < frames; ++f) {
+        dst[2 * f] = left[f];
+        dst[2 * f + 1] = right[f];
+    }
+}
+
+inline void s16_to_f32_neon(const int16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(src + i);
+        float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+        float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+        vst1q_f32(dst + i, vmulq_n_f32(lo, 1.0f / S16_SCALE));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(hi, 1.0f / S16_SCALE));
+    }
+    s16_to_f32_scalar(src + i, dst + i, count - i);
+}
+
+inline void f32_to_s16_neon(const float* src, int16_t* dst, size_t count, DitherState* dither) {
+    const float32x4_t lo = vdupq_n_f32(-S16_SCALE);
+    const float32x4_t hi = vdupq_n_f32(S16_SCALE - 1.0f);
+    uint32x4_t lanes0 = vdupq_n_u32(0);
+    uint32x4_t lanes1 = vdupq_n_u32(0);
+    if (dither) {
+        lanes0 = vld1q_u32(dither->lanes);
+        lanes1 = vld1q_u32(dither->lanes + 4);
+    }
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vmulq_n_f32(vld1q_f32(src + i), S16_SCALE);
+        float32x4_t b = vmulq_n_f32(vld1q_f32(src + i + 4), S16_SCALE);
+        if (dither) {
+            a = vaddq_f32(a, tpdf_neon(lanes0));
+            b = vaddq_f32(b, tpdf_neon(lanes1));
+        }
+        int32x4_t ia = vcvtnq_s32_f32(clip_neon(a, lo, hi));
+        int32x4_t ib = vcvtnq_s32_f32(clip_neon(b, lo, hi));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(ia), vqmovn_s32(ib)));
+    }
+
+    if (dither) {
+        vst1q_u32(dither->lanes, lanes0);
+        vst1q_u32(dither->lanes + 4, lanes1);
+    }
+    f32_to_s16_scalar(src + i, dst + i, count - i, dither);
+}
+
+inline void s32_to_f32_neon(const int32_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src + i)), 1.0f / S32_SCALE));
+    }
+    s32_to_f32_scalar(src + i, dst + i, count - i);
+}
+
+inline void f32_to_s32_neon(const float* src, int32_t* dst, size_t count) {
+    const float32x4_t lo = vdupq_n_f32(-S32_SCALE);
+    const float32x4_t hi = vdupq_n_f32(S32_MAX);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t v = vmulq_n_f32(vld1q_f32(src + i), S32_SCALE);
+        vst1q_s32(dst + i, vcvtnq_s32_f32(clip_neon(v, lo, hi)));
+    }
+    f32_to_s32_scalar(src + i, dst + i, count - i);
+}
+
+inline void mix_add_neon(const float* src, float* dst, size_t count, float gain) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vaddq_f32(vld1q_f32(dst + i), vmulq_n_f32(vld1q_f32(src + i), gain));
+        float32x4_t b = vaddq_f32(vld1q_f32(dst + i + 4), vmulq_n_f32(vld1q_f32(src + i + 4), gain));
+        vst1q_f32(dst + i, a);
+        vst1q_f32(dst + i + 4, b);
+    }
+    mix_add_scalar(src + i, dst + i, count - i, gain);
+}
+
+inline void apply_gain_neon(float* buffer, size_t count, float gain) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        vst1q_f32(buffer + i, vmulq_n_f32(vld1q_f32(buffer + i), gain));
+        vst1q_f32(buffer + i + 4, vmulq_n_f32(vld1q_f32(buffer + i + 4), gain));
+    }
+    apply_gain_scalar(buffer + i, count - i, gain);
+}
+
+#endif // RACK_CONVERT_NEON
+
+// ============================================================================
+// Runtime Dispatch
+// ============================================================================
+
+struct ConvertKernels {
+    const char* isa;
+    void (*deinterleave)(const float*, float* const*, uint32_t, size_t);
+    void (*interleave)(const float* const*, float*, uint32_t, size_t);
+    void (*s16_to_f32)(const int16_t*, float*, size_t);
+    void (*f32_to_s16)(const float*, int16_t*, size_t, DitherState*);
+    void (*s32_to_f32)(const int32_t*, float*, size_t);
+    void (*f32_to_s32)(const float*, int32_t*, size_t);
+    void (*mix_add)(const float*, float*, size_t, float);
+    void (*apply_gain)(float*, size_t, float);
+};
+
+// One table per instruction set built into this binary. The SIMD tables
+// are only safe to call where the CPU has the extension (cpu_has_avx2()).
+inline ConvertKernels scalar_kernels() {
+    return {"scalar", deinterleave_scalar, interleave_scalar, s16_to_f32_scalar, f32_to_s16_scalar,
+            s32_to_f32_scalar, f32_to_s32_scalar, mix_add_scalar, apply_gain_scalar};
+}
+
+#if defined(RACK_CONVERT_SSE2)
+inline ConvertKernels sse2_kernels() {
+    return {"sse2", deinterleave_sse2, interleave_sse2, s16_to_f32_sse2, f32_to_s16_sse2,
+            s32_to_f32_sse2, f32_to_s32_sse2, mix_add_sse2, apply_gain_sse2};
+}
+#endif
+
+#if defined(RACK_CONVERT_AVX2)
+inline ConvertKernels avx2_kernels() {
+    return {"avx2", deinterleave_avx2, interleave_avx2, s16_to_f32_avx2, f32_to_s16_avx2,
+            s32_to_f32_avx2, f32_to_s32_avx2, mix_add_avx2, apply_gain_avx2};
+}
+#endif
+
+#if defined(RACK_CONVERT_NEON)
+inline ConvertKernels neon_kernels() {
+    return {"neon", deinterleave_neon, interleave_neon, s16_to_f32_neon, f32_to_s16_neon,
+            s32_to_f32_neon, f32_to_s32_neon, mix_add_neon, apply_gain_neon};
+}
+#endif
+
+inline ConvertKernels select_kernels() {
+#if defined(RACK_CONVERT_AVX2)
+    if (cpu_has_avx2()) {
+        return avx2_kernels();
+    }
+#endif
+#if defined(RACK_CONVERT_SSE2)
+    return sse2_kernels();
+#elif defined(RACK_CONVERT_NEON)
+    return neon_kernels();
+#else
+    return scalar_kernels();
+#endif
+}
+
+} // namespace convert_detail
+
+// Kernels for this CPU, selected on first use. Call once outside the audio
+// thread (e.g. convert_isa()) so the thread-safe static init happens there.
+inline const convert_detail::ConvertKernels& convert_kernels() {
+    static const convert_detail::ConvertKernels kernels = convert_detail::select_kernels();
+    return kernels;
+}
+
+// Name of the selected instruction set: "avx2", "sse2", "neon" or "scalar"
+inline const char* convert_isa() {
+    return convert_kernels().isa;
+}
+
+// Interleaved frames -> one buffer per channel (SIMD for mono and stereo)
+inline void deinterleave(const float* src, float* const* dst, uint32_t channels, size_t frames) {
+    convert_kernels().deinterleave(src, dst, channels, frames);
+}
+
+// One buffer per channel -> interleaved frames (SIMD for mono and stereo)
+inline void interleave(const float* const* src, float* dst, uint32_t channels, size_t frames) {
+    convert_kernels().interleave(src, dst, channels, frames);
+}
+
+inline void s16_to_f32(const int16_t* src, float* dst, size_t count) {
+    convert_kernels().s16_to_f32(src, dst, count);
+}
+
+// dither: NULL for plain rounding
+inline void f32_to_s16(const float* src, int16_t* dst, size_t count, DitherState* dither) {
+    convert_kernels().f32_to_s16(src, dst, count, dither);
+}
+
+inline void s32_to_f32(const int32_t* src, float* dst, size_t count) {
+    convert_kernels().s32_to_f32(src, dst, count);
+}
+
+inline void f32_to_s32(const float* src, int32_t* dst, size_t count) {
+    convert_kernels().f32_to_s32(src, dst, count);
+}
+
+// Packed little-endian 24-bit (3 bytes per sample). Scalar: the 3-byte
+// stride doesn't map onto vector loads, and these devices are rare.
+inline void s24_to_f32(const uint8_t* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t* p = src + 3 * i;
+        // Assemble in the top 24 bits, then shift down to sign-extend
+        int32_t v = static_cast<int32_t>((uint32_t(p[0]) << 8) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 24));
+        dst[i] = static_cast<float>(v >> 8) * (1.0f / convert_detail::S24_SCALE);
+    }
+}
+
+inline void f32_to_s24(const float* src, uint8_t* dst, size_t count, DitherState* dither) {
+    using namespace convert_detail;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t v = static_cast<uint32_t>(float_to_int(src[i], S24_SCALE, S24_SCALE - 1.0f, dither, i));
+        uint8_t* p = dst + 3 * i;
+        p[0] = static_cast<uint8_t>(v);
+        p[1] = static_cast<uint8_t>(v >> 8);
+        p[2] = static_cast<uint8_t>(v >> 16);
+    }
+}
+
+// dst += src * gain
+inline void mix_add(const float* src, float* dst, size_t count, float gain) {
+    convert_kernels().mix_add(src, dst, count, gain);
+}
+
+// buffer *= gain
+inline void apply_gain(float* buffer, size_t count, float gain) {
+    convert_kernels().apply_gain(buffer, count, gain);
+}
+
+// Double-precision mix for 64-bit processing paths (plain loop; compilers
+// vectorize it at -O2)
+inline void mix_add(const double* src, double* dst, size_t count, double gain) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+// float <-> double, and same-type copies, for code templated on the sample
+// type. src and dst may be the same buffer only for the copies.
+inline void convert_samples(const float* src, double* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<double>(src[i]);
+    }
+}
+
+inline void convert_samples(const double* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        dst[i] = static_cast<float>(src[i]);
+    }
+}
+
+template <typename Sample>
+inline void convert_samples(const Sample* src, Sample* dst, size_t count) {
+    if (src != dst) {
+        memcpy(dst, src, count * sizeof(Sample));
+    }
+}
+
+} // namespace rack
+
+#endif // RACK_SAMPLE_CONVERT_H
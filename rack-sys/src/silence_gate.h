@@ -0,0 +1,233 @@
+#ifndef RACK_SILENCE_GATE_H
+#define RACK_SILENCE_GATE_H
+
+// Internal header shared by the VST3 and AudioUnit backends and
+// rack-wine-host (C++17, no plugin SDK dependency).
+//
+// Silence detection for planar buffers, and SilenceGate, which lets a host
+// stop calling into a plugin whose input has been digital silence for longer
+// than its tail, and wake it again on the first non-silent input or event.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define RACK_SILENCE_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define RACK_SILENCE_NEON 1
+#endif
+
+namespace rack {
+
+// Returns true if every sample is zero (+0.0 or -0.0).
+// Scans in 64-sample strides so loud buffers are rejected early.
+inline bool buffer_is_silent(const float* samples, size_t count) {
+    size_t i = 0;
+
+#if defined(RACK_SILENCE_SSE2)
+    // OR all bit patterns together, ignoring the sign bit
+    const __m128i magnitude_mask = _mm_set1_epi32(0x7FFFFFFF);
+    while (i + 64 <= count) {
+        __m128i acc = _mm_setzero_si128();
+        for (size_t j = 0; j < 64; j += 8) {
+            acc = _mm_or_si128(acc, _mm_castps_si128(_mm_loadu_ps(samples + i + j)));
+            acc = _mm_or_si128(acc, _mm_castps_si128(_mm_loadu_ps(samples + i + j + 4)));
+        }
+        acc = _mm_and_si128(acc, magnitude_mask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(acc, _mm_setzero_si128())) != 0xFFFF) {
+            return false;
+        }
+        i += 64;
+    }
+#elif defined(RACK_SILENCE_NEON)
+    const uint32x4_t magnitude_mask = vdupq_n_u32(0x7FFFFFFF);
+    while (i + 64 <= count) {
+        uint32x4_t acc = vdupq_n_u32(0);
+        for (size_t j = 0; j < 64; j += 8) {
+            acc = vorrq_u32(acc, vreinterpretq_u32_f32(vld1q_f32(samples + i + j)));
+            acc = vorrq_u32(acc, vreinterpretq_u32_f32(vld1q_f32(samples + i + j + 4)));
+        }
+        if (vmaxvq_u32(vandq_u32(acc, magnitude_mask)) != 0) {
+            return false;
+        }
+        i += 64;
+    }
+#endif
+
+    uint32_t acc = 0;
+    for (; i < count; ++i) {
+        uint32_t bits;
+        memcpy(&bits, samples + i, sizeof(bits));
+        acc |= bits;
+    }
+    return (acc & 0x7FFFFFFFu) == 0;
+}
+
+// Double-precision variant for kSample64 processing
+inline bool buffer_is_silent(const double* samples, size_t count) {
+    size_t i = 0;
+
+#if defined(RACK_SILENCE_SSE2)
+    const __m128i magnitude_mask = _mm_set1_epi64x(0x7FFFFFFFFFFFFFFFLL);
+    while (i + 32 <= count) {
+        __m128i acc = _mm_setzero_si128();
+        for (size_t j = 0; j < 32; j += 4) {
+            acc = _mm_or_si128(acc, _mm_castpd_si128(_mm_loadu_pd(samples + i + j)));
+            acc = _mm_or_si128(acc, _mm_castpd_si128(_mm_loadu_pd(samples + i + j + 2)));
+        }
+        acc = _mm_and_si128(acc, magnitude_mask);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(acc, _mm_setzero_si128())) != 0xFFFF) {
+            return false;
+        }
+        i += 32;
+    }
+#elif defined(RACK_SILENCE_NEON)
+    const uint64x2_t magnitude_mask = vdupq_n_u64(0x7FFFFFFFFFFFFFFFULL);
+    while (i + 32 <= count) {
+        uint64x2_t acc = vdupq_n_u64(0);
+        for (size_t j = 0; j < 32; j += 4) {
+            acc = vorrq_u64(acc, vreinterpretq_u64_f64(vld1q_f64(samples + i + j)));
+            acc = vorrq_u64(acc, vreinterpretq_u64_f64(vld1q_f64(samples + i + j + 2)));
+        }
+        acc = vandq_u64(acc, magnitude_mask);
+        if ((vgetq_lane_u64(acc, 0) | vgetq_lane_u64(acc, 1)) != 0) {
+            return false;
+        }
+        i += 32;
+    }
+#endif
+
+    uint64_t acc = 0;
+    for (; i < count; ++i) {
+        uint64_t bits;
+        memcpy(&bits, samples + i, sizeof(bits));
+        acc |= bits;
+    }
+    return (acc & 0x7FFFFFFFFFFFFFFFULL) == 0;
+}
+
+// Per-channel silence as a VST3-style silenceFlags mask (bit i = channel i
+// is silent; channels beyond 63 are scanned but not flagged).
+// *all_silent is set to whether every channel is silent (true for none).
+// Sample is float or double.
+template <typename Sample>
+inline uint64_t silent_channel_mask(const Sample* const* channels, uint32_t num_channels,
+                                    size_t frames, bool* all_silent) {
+    uint64_t mask = 0;
+    bool all = true;
+    for (uint32_t ch = 0; ch < num_channels; ++ch) {
+        if (buffer_is_silent(channels[ch], frames)) {
+            if (ch < 64) mask |= uint64_t(1) << ch;
+        } else {
+            all = false;
+        }
+    }
+    *all_silent = all;
+    return mask;
+}
+
+// Mask with the low num_channels bits set
+inline uint64_t all_channels_mask(uint32_t num_channels) {
+    return num_channels >= 64 ? ~uint64_t(0) : (uint64_t(1) << num_channels) - 1;
+}
+
+// Decides per block whether a plugin has to be called.
+// A plugin is put to sleep only when its input (and event input) has been
+// silent for at least tail_samples and its last processed output was silent,
+// so instruments with held notes or plugins with under-reported tails keep
+// running. Disabled by default.
+//
+// begin_block/end_block are audio-thread only. set_enabled, wake and the
+// counters may be used from any thread.
+class SilenceGate {
+public:
+    // Tail that never ends (VST3 kInfiniteTail): never sleep
+    static constexpr uint64_t INFINITE_TAIL = ~uint64_t(0);
+
+    void set_enabled(bool enabled) {
+        enabled_.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool enabled() const {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // Returns true if the block should be skipped (counted as skipped).
+    // tail_samples() is only called when the gate considers going to sleep.
+    template <typename TailFn>
+    bool begin_block(bool input_silent, bool has_events, TailFn tail_samples) {
+        if (wake_requested_.exchange(false, std::memory_order_acquire)) {
+            sleeping_ = false;
+            last_output_silent_ = false;
+            silent_input_samples_ = 0;
+        }
+
+        // Events restart the silent run just like audible input does
+        block_quiet_ = input_silent && !has_events;
+        if (!enabled() || !block_quiet_) {
+            sleeping_ = false;
+            return false;
+        }
+
+        if (!sleeping_ && last_output_silent_) {
+            uint64_t tail = tail_samples();
+            sleeping_ = tail != INFINITE_TAIL && silent_input_samples_ >= tail;
+        }
+
+        if (sleeping_) {
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return sleeping_;
+    }
+
+    // Record a block the plugin actually processed
+    void end_block(bool output_silent, uint32_t frames) {
+        silent_input_samples_ = block_quiet_ ? silent_input_samples_ + frames : 0;
+        last_output_silent_ = output_silent;
+        processed_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Forget the silence history before the next block (e.g. after a reset
+    // or state change, which may make the plugin audible without input)
+    void wake() {
+        wake_requested_.store(true, std::memory_order_release);
+    }
+
+    // Back to the initial state: disabled, awake, counters zeroed
+    void reset() {
+        set_enabled(false);
+        processed_.store(0, std::memory_order_relaxed);
+        skipped_.store(0, std::memory_order_relaxed);
+        wake();
+    }
+
+    bool sleeping() const {
+        return sleeping_;
+    }
+
+    uint64_t processed_blocks() const {
+        return processed_.load(std::memory_order_relaxed);
+    }
+
+    uint64_t skipped_blocks() const {
+        return skipped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<bool> enabled_{false};
+    std::atomic<bool> wake_requested_{false};
+    bool sleeping_ = false;
+    bool block_quiet_ = false;       // Current block: silent input, no events
+    bool last_output_silent_ = false;
+    uint64_t silent_input_samples_ = 0;
+    std::atomic<uint64_t> processed_{0};
+    std::atomic<uint64_t> skipped_{0};
+};
+
+} // namespace rack
+
+#endif // RACK_SILENCE_GATE_H
@@ -0,0 +1,121 @@
+#ifndef RACK_SPSC_QUEUE_H
+#define RACK_SPSC_QUEUE_H
+
+// Internal header shared by the VST3 and AudioUnit backends.
+//
+// SpscQueue is a bounded, wait-free single-producer/single-consumer ring.
+// It is used to hand events from one control thread to the render thread
+// without locks: push() and pop() never block or allocate. Exactly one
+// thread may push and one thread may pop at a time; nothing detects a
+// second concurrent producer, so callers (rack_*_plugin_send_midi) pass the
+// contract on to their users.
+
+#include <atomic>
+#include <cstddef>
+
+namespace rack {
+
+// Destructive interference size; hard-coded because
+// std::hardware_destructive_interference_size is not universally available
+static constexpr size_t CACHE_LINE_SIZE = 64;
+
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    SpscQueue() = default;
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    static constexpr size_t capacity() { return Capacity; }
+
+    // Producer: enqueue one item. Returns false if the queue is full.
+    bool push(const T& item) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ >= Capacity) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ >= Capacity) {
+                return false;
+            }
+        }
+        items_[tail & (Capacity - 1)] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer: free slots as seen from the producer side
+    size_t write_available() {
+        head_cache_ = head_.load(std::memory_order_acquire);
+        return Capacity - (tail_.load(std::memory_order_relaxed) - head_cache_);
+    }
+
+    // Consumer: dequeue one item. Returns false if the queue is empty.
+    bool pop(T& out) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return false;
+            }
+        }
+        out = items_[head & (Capacity - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: dequeue up to max_items into out. Returns the number popped.
+    size_t pop_all(T* out, size_t max_items) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        tail_cache_ = tail_.load(std::memory_order_acquire);
+
+        size_t count = tail_cache_ - head;
+        if (count > max_items) {
+            count = max_items;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = items_[(head + i) & (Capacity - 1)];
+        }
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer: drop everything currently queued
+    void clear() {
+        head_.store(tail_.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    // Indices only grow; slot = index & (Capacity - 1). Each side keeps a
+    // cached copy of the other side's index so the common case touches
+    // only its own cache line.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};  // Written by consumer
+    size_t tail_cache_ = 0;                                 // Consumer's view of tail_
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};  // Written by producer
+    size_t head_cache_ = 0;                                 // Producer's view of head_
+    alignas(CACHE_LINE_SIZE) T items_[Capacity];
+};
+
+// Stable in-place insertion sort for event batches drained from a queue.
+// No allocation, and close to linear for the nearly sorted batches that
+// hosts produce. key(item) returns the sort key (e.g. sample offset).
+template <typename T, typename Key>
+void sort_events(T* items, size_t count, Key key) {
+    for (size_t i = 1; i < count; ++i) {
+        if (!(key(items[i]) < key(items[i - 1]))) {
+            continue;
+        }
+        T moving = items[i];
+        size_t j = i;
+        while (j > 0 && key(moving) < key(items[j - 1])) {
+            items[j] = items[j - 1];
+            --j;
+        }
+        items[j] = moving;
+    }
+}
+
+} // namespace rack
+
+#endif // RACK_SPSC_QUEUE_H
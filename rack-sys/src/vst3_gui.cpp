@@ -10,9 +10,14 @@
 #include <X11/Xutil.h>
 #include <X11/Xatom.h>
 
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
 #include <cstdio>
 #include <cstring>
 #include <atomic>
+#include <vector>
 
 using namespace Steinberg;
 
@@ -31,9 +36,15 @@ static bool g_error_handler_installed = false;
 // Forward declaration - defined in vst3_instance.cpp
 extern "C" void* rack_vst3_plugin_get_edit_controller(RackVST3Plugin* plugin);
 
+// Reserved epoll tag for the X11 connection; run loop sources count up from 1
+static constexpr uint64 kX11SourceId = 0;
+
 // IPlugFrame implementation for resize callbacks
-// This allows the plugin to request window size changes
-class PlugFrame : public IPlugFrame {
+// This allows the plugin to request window size changes. It also provides
+// Linux::IRunLoop: plugin fds and timers are collected in one epoll set
+// (together with the X11 connection), so the host can wait on a single fd
+// and rack_vst3_gui_pump_events() only runs what is ready.
+class PlugFrame : public IPlugFrame, public Linux::IRunLoop {
 public:
     PlugFrame(Display* display, Window window)
         : ref_count_(1)
@@ -41,9 +52,27 @@ public:
         , window_(window)
         , current_width_(0)
         , current_height_(0)
-    {}
+        , epoll_fd_(epoll_create1(EPOLL_CLOEXEC))
+        , next_source_id_(kX11SourceId + 1)
+    {
+        if (epoll_fd_ >= 0 && display_) {
+            epoll_event ev = {};
+            ev.events = EPOLLIN;
+            ev.data.u64 = kX11SourceId;
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, ConnectionNumber(display_), &ev);
+        }
+    }
 
-    virtual ~PlugFrame() = default;
+    virtual ~PlugFrame() {
+        for (auto& source : sources_) {
+            if (source.timer) {
+                close(source.fd);
+            }
+        }
+        if (epoll_fd_ >= 0) {
+            close(epoll_fd_);
+        }
+    }
 
     // IUnknown
     tresult PLUGIN_API queryInterface(const TUID _iid, void** obj) override {
@@ -58,6 +87,12 @@ public:
             return kResultOk;
         }
 
+        if (FUnknownPrivate::iidEqual(_iid, Linux::IRunLoop::iid) && epoll_fd_ >= 0) {
+            addRef();
+            *obj = static_cast<Linux::IRunLoop*>(this);
+            return kResultOk;
+        }
+
         *obj = nullptr;
         return kNoInterface;
     }
@@ -100,15 +135,178 @@ public:
         return view->onSize(newSize);
     }
 
+    // Linux::IRunLoop
+    tresult PLUGIN_API registerEventHandler(Linux::IEventHandler* handler,
+                                            Linux::FileDescriptor fd) override {
+        if (!handler || fd < 0) {
+            return kInvalidArgument;
+        }
+
+        Source source;
+        source.id = next_source_id_++;
+        source.fd = fd;
+        source.timer = false;
+        source.event_handler = handler;
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = source.id;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            return kResultFalse;
+        }
+
+        sources_.push_back(source);
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API unregisterEventHandler(Linux::IEventHandler* handler) override {
+        if (!handler) {
+            return kInvalidArgument;
+        }
+
+        bool found = false;
+        for (size_t i = 0; i < sources_.size();) {
+            if (!sources_[i].timer && sources_[i].event_handler == handler) {
+                epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, sources_[i].fd, nullptr);
+                sources_.erase(sources_.begin() + i);
+                found = true;
+            } else {
+                i++;
+            }
+        }
+        return found ? kResultOk : kResultFalse;
+    }
+
+    tresult PLUGIN_API registerTimer(Linux::ITimerHandler* handler,
+                                     Linux::TimerInterval milliseconds) override {
+        if (!handler || milliseconds == 0) {
+            return kInvalidArgument;
+        }
+
+        int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fd < 0) {
+            return kResultFalse;
+        }
+
+        itimerspec spec = {};
+        spec.it_interval.tv_sec = static_cast<time_t>(milliseconds / 1000);
+        spec.it_interval.tv_nsec = static_cast<long>((milliseconds % 1000) * 1000000);
+        spec.it_value = spec.it_interval;
+
+        Source source;
+        source.id = next_source_id_++;
+        source.fd = fd;
+        source.timer = true;
+        source.timer_handler = handler;
+
+        epoll_event ev = {};
+        ev.events = EPOLLIN;
+        ev.data.u64 = source.id;
+        if (timerfd_settime(fd, 0, &spec, nullptr) != 0 ||
+            epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+            close(fd);
+            return kResultFalse;
+        }
+
+        sources_.push_back(source);
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API unregisterTimer(Linux::ITimerHandler* handler) override {
+        if (!handler) {
+            return kInvalidArgument;
+        }
+
+        bool found = false;
+        for (size_t i = 0; i < sources_.size();) {
+            if (sources_[i].timer && sources_[i].timer_handler == handler) {
+                // Closing the timerfd also removes it from the epoll set
+                close(sources_[i].fd);
+                sources_.erase(sources_.begin() + i);
+                found = true;
+            } else {
+                i++;
+            }
+        }
+        return found ? kResultOk : kResultFalse;
+    }
+
+    // Descriptor that is readable while X11 events, plugin fds or timers are pending
+    int getFd() const { return epoll_fd_; }
+
+    // Run the handlers of all ready run loop sources without blocking.
+    // X11 readiness is left to the XPending() loop. Returns the number of
+    // handlers called.
+    int dispatch() {
+        if (epoll_fd_ < 0) {
+            return 0;
+        }
+
+        epoll_event events[32];
+        int ready = epoll_wait(epoll_fd_, events, 32, 0);
+        int handled = 0;
+
+        for (int i = 0; i < ready; i++) {
+            uint64 id = events[i].data.u64;
+            if (id == kX11SourceId) {
+                continue;
+            }
+
+            // Look the source up again: an earlier handler in this batch may
+            // have unregistered it. Copy the handler so it stays alive even if
+            // its own callback unregisters it.
+            const Source* source = findSource(id);
+            if (!source) {
+                continue;
+            }
+
+            if (source->timer) {
+                uint64_t expirations = 0;
+                if (read(source->fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+                    continue;
+                }
+                IPtr<Linux::ITimerHandler> handler = source->timer_handler;
+                handler->onTimer();
+            } else {
+                IPtr<Linux::IEventHandler> handler = source->event_handler;
+                handler->onFDIsSet(source->fd);
+            }
+            handled++;
+        }
+
+        return handled;
+    }
+
     int32 getWidth() const { return current_width_; }
     int32 getHeight() const { return current_height_; }
 
 private:
+    // A plugin-registered fd or timer (timers own their timerfd)
+    struct Source {
+        uint64 id;
+        int fd;
+        bool timer;
+        IPtr<Linux::IEventHandler> event_handler;
+        IPtr<Linux::ITimerHandler> timer_handler;
+    };
+
+    const Source* findSource(uint64 id) const {
+        for (const auto& source : sources_) {
+            if (source.id == id) {
+                return &source;
+            }
+        }
+        return nullptr;
+    }
+
     std::atomic<uint32> ref_count_;
     Display* display_;
     Window window_;
     int32 current_width_;
     int32 current_height_;
+    int epoll_fd_;
+    uint64 next_source_id_;
+    std::vector<Source> sources_;
 };
 
 // Internal GUI state
@@ -364,7 +562,8 @@ int rack_vst3_gui_pump_events(RackVST3Gui* gui) {
         return RACK_VST3_ERROR_INVALID_PARAM;
     }
 
-    int event_count = 0;
+    // Plugin fds and timers first: their handlers may queue X requests
+    int event_count = gui->frame ? gui->frame->dispatch() : 0;
 
     while (XPending(gui->display)) {
         XEvent event;
@@ -432,4 +631,12 @@ unsigned long rack_vst3_gui_get_window_id(RackVST3Gui* gui) {
     return gui->window;
 }
 
+int rack_vst3_gui_get_fd(RackVST3Gui* gui) {
+    if (!gui || !gui->frame) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+    int fd = gui->frame->getFd();
+    return fd >= 0 ? fd : RACK_VST3_ERROR_NOT_SUPPORTED;
+}
+
 } // extern "C"
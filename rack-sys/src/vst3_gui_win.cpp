@@ -427,6 +427,14 @@ unsigned long rack_vst3_gui_get_window_id(RackVST3Gui* gui) {
     return reinterpret_cast<unsigned long>(gui->hwnd);
 }
 
+int rack_vst3_gui_get_fd(RackVST3Gui* gui) {
+    if (!gui) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+    // Window messages are delivered through the thread's message queue
+    return RACK_VST3_ERROR_NOT_SUPPORTED;
+}
+
 } // extern "C"
 
 #endif // _WIN32
@@ -1,4 +1,14 @@
 #include "rack_vst3.h"
+#include "param_index_map.h"
+#include "param_ramp_split.h"
+#include "spsc_queue.h"
+#include "param_change_queue.h"
+#include "silence_gate.h"
+#include "sample_convert.h"
+#include "latency_monitor.h"
+#include "perf_counters.h"
+#include "rt_guard.h"
+#include "wakeup_fd.h"
 #include "public.sdk/source/vst/hosting/module.h"
 #include "public.sdk/source/vst/hosting/plugprovider.h"
 #include "public.sdk/source/vst/hosting/hostclasses.h"
@@ -18,15 +28,20 @@
 #include <cstring>
 #include <mutex>
 #include <algorithm>
+#include <atomic>
+#include <memory>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <thread>
+#include <condition_variable>
+#include <system_error>
+#include <type_traits>
 
 using namespace VST3;
 using namespace Steinberg;
 using namespace Steinberg::Vst;
 
-// Global mutex for VST3 lifecycle operations
-// VST3 module loading/unloading is not guaranteed to be thread-safe
-static std::mutex g_vst3_lifecycle_mutex;
-
 // Helper: Convert UTF-16 to UTF-8
 // VST3 uses char16 (UTF-16) for strings
 // Handles surrogate pairs and malformed input safely
@@ -130,7 +145,7 @@ class MemoryStream : public IBStream {
 public:
     MemoryStream() : ref_count_(1), position_(0) {}
     MemoryStream(const uint8_t* data, size_t size) : ref_count_(1), position_(0) {
-        buffer_.assign(data, data + size);
+        assign(data, size);
     }
 
     virtual ~MemoryStream() = default;
@@ -227,7 +242,20 @@ public:
     // Accessors
     const std::vector<uint8_t>& getData() const { return buffer_; }
     size_t getSize() const { return buffer_.size(); }
+    // Both keep the allocated capacity, so a stream can be reused without
+    // allocating once it has grown to its working size
     void clear() { buffer_.clear(); position_ = 0; }
+    void assign(const uint8_t* data, size_t size) {
+        const uint8_t* own = buffer_.data();
+        if (size > 0 && data >= own && data < own + buffer_.size()) {
+            // Data lives in this buffer already (e.g. restoring a snapshot)
+            memmove(buffer_.data(), data, size);
+            buffer_.resize(size);
+        } else {
+            buffer_.assign(data, data + size);
+        }
+        position_ = 0;
+    }
 
 private:
     uint32 ref_count_;  // Non-atomic - IMPLEMENT_REFCOUNT macro handles thread-safety
@@ -254,13 +282,13 @@ struct ParamChangeEvent {
     ParamValue value;
 };
 
-// Maximum pending parameter changes
-static constexpr size_t MAX_PARAM_CHANGES = 256;
+// Parameters with a pending GUI change (edits to the same ParamID coalesce)
+static constexpr size_t MAX_PARAM_CHANGES = 1024;
 
 // ComponentHandler implementation - captures parameter changes from GUI
 class ComponentHandler : public IComponentHandler {
 public:
-    ComponentHandler() : ref_count_(1), write_index_(0), read_index_(0) {}
+    ComponentHandler() : ref_count_(1) {}
     virtual ~ComponentHandler() = default;
 
     // IUnknown
@@ -288,14 +316,10 @@ public:
     }
 
     tresult PLUGIN_API performEdit(ParamID id, ParamValue valueNormalized) override {
-        // Called when parameter value changes in GUI
-        // Store in circular buffer (lock-free for single producer)
-        size_t next = (write_index_ + 1) % MAX_PARAM_CHANGES;
-        if (next != read_index_) {  // Don't overflow
-            changes_[write_index_].param_id = id;
-            changes_[write_index_].value = valueNormalized;
-            write_index_ = next;
-        }
+        // Called when parameter value changes in GUI (possibly from several
+        // plugin threads); the queue is lock-free and coalesces per ParamID
+        changes_.push(id, valueNormalized);
+        wakeup_.signal();
         return kResultOk;
     }
 
@@ -306,42 +330,321 @@ public:
     }
 
     tresult PLUGIN_API restartComponent(int32 flags) override {
-        // Plugin requests host to restart (e.g., after latency change)
-        (void)flags;
+        // Plugin requests host to restart (e.g., after latency change).
+        // Latency changes are recorded for get_latency() and its pollers.
+        if (flags & kLatencyChanged) {
+            latency_.mark_changed();
+        }
         return kResultOk;
     }
 
+    rack::LatencyMonitor& latency() {
+        return latency_;
+    }
+
+    // Readable while changes are pending (-1 if unavailable)
+    rack::WakeupFd& wakeup() {
+        return wakeup_;
+    }
+
     // Get pending changes count
     size_t getPendingCount() const {
-        size_t w = write_index_;
-        size_t r = read_index_;
-        if (w >= r) return w - r;
-        return MAX_PARAM_CHANGES - r + w;
+        return changes_.pending_count();
     }
 
     // Get next pending change, returns false if none
     bool getNextChange(ParamChangeEvent* out) {
-        if (read_index_ == write_index_) return false;
-        *out = changes_[read_index_];
-        read_index_ = (read_index_ + 1) % MAX_PARAM_CHANGES;
+        uint32_t id = 0;
+        double value = 0.0;
+        if (!changes_.pop(&id, &value)) return false;
+        out->param_id = id;
+        out->value = value;
         return true;
     }
 
     // Clear all pending changes
     void clear() {
-        read_index_ = write_index_;
+        changes_.clear();
+    }
+
+    // Number of changes dropped because the queue was full
+    uint64_t getOverflowCount() const {
+        return changes_.overflow_count();
     }
 
 private:
     uint32 ref_count_;
-    ParamChangeEvent changes_[MAX_PARAM_CHANGES];
-    volatile size_t write_index_;
-    volatile size_t read_index_;
+    rack::ParamChangeQueue<MAX_PARAM_CHANGES> changes_;
+    rack::WakeupFd wakeup_;
+    rack::LatencyMonitor latency_;
+};
+
+// ============================================================================
+// Pooled parameter changes - preallocated input queues for automation
+// ============================================================================
+
+// Lock a preallocated vector's storage through a realtime context
+template <typename T>
+static bool lock_vector(RackRtContext* ctx, const std::vector<T>& values) {
+    return rack_rt_context_lock_memory(ctx, values.data(), values.size() * sizeof(T)) == RACK_RT_OK;
+}
+
+// Maximum automation points per parameter per process() call
+static constexpr int32 MAX_POINTS_PER_QUEUE = 64;
+
+// Maximum distinct parameters automated in one process() call
+static constexpr size_t MAX_PARAM_QUEUES = 1024;
+
+// Fixed-capacity IParamValueQueue. Points are kept ordered by sample offset,
+// as required by IParamValueQueue consumers.
+class PooledParamValueQueue : public IParamValueQueue {
+public:
+    PooledParamValueQueue() = default;
+    virtual ~PooledParamValueQueue() = default;
+
+    // IUnknown - owned by PooledParameterChanges, never reference counted
+    tresult PLUGIN_API queryInterface(const TUID _iid, void** obj) override {
+        QUERY_INTERFACE(_iid, obj, FUnknown::iid, IParamValueQueue)
+        QUERY_INTERFACE(_iid, obj, IParamValueQueue::iid, IParamValueQueue)
+        *obj = nullptr;
+        return kNoInterface;
+    }
+
+    uint32 PLUGIN_API addRef() override { return 1; }
+    uint32 PLUGIN_API release() override { return 1; }
+
+    // IParamValueQueue
+    ParamID PLUGIN_API getParameterId() override { return param_id_; }
+    int32 PLUGIN_API getPointCount() override { return count_; }
+
+    tresult PLUGIN_API getPoint(int32 index, int32& sampleOffset, ParamValue& value) override {
+        if (index < 0 || index >= count_) {
+            return kResultFalse;
+        }
+        sampleOffset = points_[index].offset;
+        value = points_[index].value;
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API addPoint(int32 sampleOffset, ParamValue value, int32& index) override {
+        // Find insertion point (points usually arrive in order, so scan from the end)
+        int32 pos = count_;
+        while (pos > 0 && points_[pos - 1].offset > sampleOffset) {
+            --pos;
+        }
+
+        // A second point at the same offset replaces the first
+        if (pos > 0 && points_[pos - 1].offset == sampleOffset) {
+            points_[pos - 1].value = value;
+            index = pos - 1;
+            return kResultOk;
+        }
+
+        if (count_ >= MAX_POINTS_PER_QUEUE) {
+            return kResultFalse;
+        }
+
+        if (pos < count_) {
+            memmove(&points_[pos + 1], &points_[pos], (count_ - pos) * sizeof(Point));
+        }
+        points_[pos].offset = sampleOffset;
+        points_[pos].value = value;
+        count_++;
+        index = pos;
+        return kResultOk;
+    }
+
+    // Rebind this queue to a parameter and drop all points
+    void reset(ParamID id) {
+        param_id_ = id;
+        count_ = 0;
+    }
+
+    // Move points past last_offset onto last_offset (the latest value wins)
+    void clampTo(int32 last_offset) {
+        int32 first_late = count_;
+        while (first_late > 0 && points_[first_late - 1].offset > last_offset) {
+            --first_late;
+        }
+        if (first_late == count_) {
+            return;
+        }
+
+        ParamValue value = points_[count_ - 1].value;
+        if (first_late > 0 && points_[first_late - 1].offset == last_offset) {
+            points_[first_late - 1].value = value;
+            count_ = first_late;
+        } else {
+            points_[first_late].offset = last_offset;
+            points_[first_late].value = value;
+            count_ = first_late + 1;
+        }
+    }
+
+private:
+    struct Point {
+        int32 offset;
+        ParamValue value;
+    };
+
+    ParamID param_id_ = kNoParamId;
+    int32 count_ = 0;
+    Point points_[MAX_POINTS_PER_QUEUE];
+};
+
+// IParameterChanges backed by a queue pool sized once in prepare().
+// Nothing here allocates after prepare(), so it is safe to fill from the
+// audio thread. Queues are handed out in first-touch order per block.
+class PooledParameterChanges : public IParameterChanges {
+public:
+    PooledParameterChanges() = default;
+    virtual ~PooledParameterChanges() = default;
+
+    // IUnknown - embedded in RackVST3Plugin, never reference counted
+    tresult PLUGIN_API queryInterface(const TUID _iid, void** obj) override {
+        QUERY_INTERFACE(_iid, obj, FUnknown::iid, IParameterChanges)
+        QUERY_INTERFACE(_iid, obj, IParameterChanges::iid, IParameterChanges)
+        *obj = nullptr;
+        return kNoInterface;
+    }
+
+    uint32 PLUGIN_API addRef() override { return 1; }
+    uint32 PLUGIN_API release() override { return 1; }
+
+    // IParameterChanges
+    int32 PLUGIN_API getParameterCount() override { return used_; }
+
+    IParamValueQueue* PLUGIN_API getParameterData(int32 index) override {
+        if (index < 0 || index >= used_) {
+            return nullptr;
+        }
+        return &queues_[index];
+    }
+
+    IParamValueQueue* PLUGIN_API addParameterData(const ParamID& id, int32& index) override {
+        for (int32 i = 0; i < used_; ++i) {
+            if (queues_[i].getParameterId() == id) {
+                index = i;
+                return &queues_[i];
+            }
+        }
+
+        if (static_cast<size_t>(used_) >= queues_.size()) {
+            return nullptr;
+        }
+
+        index = used_++;
+        queues_[index].reset(id);
+        index_for_slot_[index] = -1;
+        return &queues_[index];
+    }
+
+    // Size the pool for a plugin's parameter list (not realtime-safe)
+    void prepare(size_t param_count) {
+        queues_.clear();
+        queues_.resize(std::min(param_count, MAX_PARAM_QUEUES));
+        slot_for_index_.assign(param_count, -1);
+        index_for_slot_.assign(queues_.size(), -1);
+        used_ = 0;
+    }
+
+    // Get the queue for a cached parameter index, O(1) after first touch
+    // in a block. Returns nullptr if the pool is exhausted.
+    PooledParamValueQueue* queueForIndex(uint32_t param_index, ParamID id) {
+        if (param_index >= slot_for_index_.size()) {
+            return nullptr;
+        }
+
+        int32 slot = slot_for_index_[param_index];
+        if (slot >= 0) {
+            return &queues_[slot];
+        }
+
+        // May already have been added by ID (e.g. preset fallback)
+        if (!addParameterData(id, slot)) {
+            return nullptr;
+        }
+        slot_for_index_[param_index] = slot;
+        index_for_slot_[slot] = static_cast<int32>(param_index);
+        return &queues_[slot];
+    }
+
+    // Keep every point inside a block of last_offset + 1 frames
+    void clampOffsets(int32 last_offset) {
+        for (int32 i = 0; i < used_; ++i) {
+            queues_[i].clampTo(last_offset);
+        }
+    }
+
+    // Exchange contents with another pool prepared for the same plugin
+    void swap(PooledParameterChanges& other) {
+        queues_.swap(other.queues_);
+        slot_for_index_.swap(other.slot_for_index_);
+        index_for_slot_.swap(other.index_for_slot_);
+        std::swap(used_, other.used_);
+    }
+
+    // Lock the pool sized by prepare() into RAM
+    bool lockMemory(RackRtContext* ctx) const {
+        return lock_vector(ctx, queues_) && lock_vector(ctx, slot_for_index_) &&
+               lock_vector(ctx, index_for_slot_);
+    }
+
+    // Drop all queued points, touching only the queues used this block
+    void clearQueue() {
+        for (int32 i = 0; i < used_; ++i) {
+            if (index_for_slot_[i] >= 0) {
+                slot_for_index_[index_for_slot_[i]] = -1;
+                index_for_slot_[i] = -1;
+            }
+        }
+        used_ = 0;
+    }
+
+private:
+    std::vector<PooledParamValueQueue> queues_;
+    std::vector<int32> slot_for_index_;
+    std::vector<int32> index_for_slot_;
+    int32 used_ = 0;
+};
+
+// Maximum MIDI events queued between two process() calls
+static constexpr size_t MIDI_QUEUE_CAPACITY = 1024;
+
+// Shared module cache entry (see Module Cache below)
+struct ModuleEntry {
+    std::string path;
+    Hosting::Module::Ptr module;
+
+    // Serializes loading and instance lifecycle calls (create, initialize,
+    // setupProcessing, setActive, terminate) for this module's instances.
+    // Plugins may keep process-global state in their module, so instances
+    // of one module are not set up concurrently; different modules are.
+    std::mutex lock;
+
+    // Guarded by g_module_cache_mutex
+    uint32_t users = 0;
+    bool preloaded = false;
 };
 
 // Internal plugin state
+// Channel pointer arrays for one sample type (float or double)
+template <typename Sample>
+struct SampleBuffers {
+    // Sub-block pointers for process_split()
+    std::vector<const Sample*> split_inputs;
+    std::vector<Sample*> split_outputs;
+
+    // Only for the plugin's own sample type: blocks handed to process() in
+    // the other type are converted through these max_block_size buffers
+    std::vector<Sample> convert_storage;
+    std::vector<Sample*> convert_inputs;
+    std::vector<Sample*> convert_outputs;
+};
+
 struct RackVST3Plugin {
-    // Module and factory
+    // Module and factory (shared with other instances of the same bundle)
+    std::shared_ptr<ModuleEntry> module_entry;
     Hosting::Module::Ptr module;
 
     // Component and controller
@@ -363,22 +666,53 @@ struct RackVST3Plugin {
     // Audio configuration
     double sample_rate = 0.0;
     uint32_t max_block_size = 0;
+    int32 process_mode = kRealtime;
     bool initialized = false;
 
+    // Sample size the processor runs at: kSample64 when double precision
+    // was requested and canProcessSampleSize(kSample64) succeeded
+    bool prefer_double = false;
+    int32 symbolic_sample_size = kSample32;
+
+    // Transport handed to the plugin; the sample position advances by the
+    // frames processed in every process() call
+    ProcessContext process_context = {};
+    int64_t sample_position = 0;
+
+    // Skips process() calls while input is silent and the tail has run out
+    rack::SilenceGate silence_gate;
+
+    // Asynchronous state and preset loads (rack_vst3_plugin_set_state_async).
+    // While state_loading is set, process() passes audio through instead of
+    // calling the plugin; in_process lets the loader wait out a running block.
+    std::thread state_worker;
+    std::atomic<bool> state_loading{false};
+    std::atomic<bool> in_process{false};
+    std::atomic<int> state_load_result{RACK_VST3_OK};
+
+    // Parameter changes left by preset/state loads, handed to the processor
+    // by process() at the start of the next block
+    rack::ParamChangeQueue<> state_param_changes;
+
     // I/O configuration
     int32 num_input_channels = 0;
     int32 num_output_channels = 0;
 
     // Processing structures
     HostProcessData process_data;
-    ParameterChanges input_param_changes;
+    PooledParameterChanges input_param_changes;
+    PooledParameterChanges split_param_changes;  // Span automation for process_split()
     ParameterChanges output_param_changes;
     EventList input_events;
     EventList output_events;
 
+    // MIDI from send_midi(), drained into input_events by process()
+    rack::SpscQueue<Event, MIDI_QUEUE_CAPACITY> midi_queue;
+    Event midi_scratch[MIDI_QUEUE_CAPACITY];
+
     // Audio buffers (for pointer arrays)
-    std::vector<float*> input_ptrs;
-    std::vector<float*> output_ptrs;
+    SampleBuffers<float> buffers32;
+    SampleBuffers<double> buffers64;
 
     // Parameter cache
     struct ParameterInfo {
@@ -391,6 +725,19 @@ struct RackVST3Plugin {
     };
     std::vector<ParameterInfo> parameters;
 
+    // ParamID -> index into parameters (built with the parameter cache)
+    rack::ParamIndexMap param_index_map;
+
+    // Controller values queued from the audio thread, applied later by
+    // flush_controller_updates() on a non-realtime thread (NaN = none pending)
+    std::unique_ptr<std::atomic<float>[]> pending_controller_values;
+    std::atomic<uint32_t> pending_controller_count{0};
+
+    // Last normalized value handed to the processor for each parameter
+    // (audio thread; refreshed from the controller after a state load).
+    // Starts the ramp into each process_split() sub-block.
+    std::vector<ParamValue> processor_values;
+
     // Preset cache (factory presets from IUnitInfo)
     struct PresetInfo {
         int32 program_list_id;
@@ -398,53 +745,155 @@ struct RackVST3Plugin {
         std::string name;
     };
     std::vector<PresetInfo> presets;
+
+    // Reused by get_state/snapshot_state/set_state (created on first use)
+    IPtr<MemoryStream> state_stream;
+
+    // Processing statistics (rack_vst3_plugin_get_stats); GUI change
+    // overflows are reported relative to the count at the last reset
+    rack::PerfCounters perf;
+    std::atomic<uint64_t> param_overflow_base{0};
 };
 
 // ============================================================================
-// Plugin Instance Implementation
+// Module Cache
 // ============================================================================
 
-RackVST3Plugin* rack_vst3_plugin_new(const char* path, const char* uid) {
-    if (!path || !uid) {
+// Process-wide cache of module entries, keyed by bundle path. Instances share
+// an entry's module (and its factory); the entry is dropped once its last
+// user goes away, and the module unloads when the last reference to the
+// entry is released. g_module_cache_mutex only guards the map and the user
+// counts; loading and instance lifecycle run under each entry's own lock.
+static std::mutex g_module_cache_mutex;
+static std::unordered_map<std::string, std::shared_ptr<ModuleEntry>> g_module_cache;
+
+static void release_module(const std::shared_ptr<ModuleEntry>& entry);
+
+// Return the cache entry for path, loading the module on first use.
+// Each successful call counts as one user until release_module.
+static std::shared_ptr<ModuleEntry> acquire_module(const std::string& path) {
+    std::shared_ptr<ModuleEntry> entry;
+    {
+        std::lock_guard<std::mutex> lock(g_module_cache_mutex);
+        auto& slot = g_module_cache[path];
+        if (!slot) {
+            slot = std::make_shared<ModuleEntry>();
+            slot->path = path;
+        }
+        slot->users++;
+        entry = slot;
+    }
+
+    // Concurrent first users of the same bundle wait here while one loads it;
+    // other bundles load in parallel
+    bool loaded;
+    {
+        std::lock_guard<std::mutex> lock(entry->lock);
+        if (!entry->module) {
+            std::string error_description;
+            entry->module = Hosting::Module::create(path, error_description);
+        }
+        loaded = entry->module != nullptr;
+    }
+
+    if (!loaded) {
+        release_module(entry);
         return nullptr;
     }
+    return entry;
+}
+
+// Drop one user. The last user removes the entry from the cache; the module
+// itself unloads once the caller's (and any other) reference is gone.
+static void release_module(const std::shared_ptr<ModuleEntry>& entry) {
+    std::lock_guard<std::mutex> lock(g_module_cache_mutex);
+    if (--entry->users > 0) {
+        return;
+    }
 
-    std::lock_guard<std::mutex> lock(g_vst3_lifecycle_mutex);
+    auto it = g_module_cache.find(entry->path);
+    if (it != g_module_cache.end() && it->second == entry) {
+        g_module_cache.erase(it);
+    }
+}
 
-    auto plugin = new(std::nothrow) RackVST3Plugin();
-    if (!plugin) {
-        return nullptr;
+// Add a user to an entry that is already in use (instance clones and pools)
+static void retain_module(const std::shared_ptr<ModuleEntry>& entry) {
+    std::lock_guard<std::mutex> lock(g_module_cache_mutex);
+    entry->users++;
+}
+
+int rack_vst3_module_preload(const char* path) {
+    if (!path) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
     }
 
-    plugin->path = path;
+    std::shared_ptr<ModuleEntry> entry = acquire_module(path);
+    if (!entry) {
+        return RACK_VST3_ERROR_LOAD_FAILED;
+    }
 
-    // Parse UID
-    if (!string_to_uid(uid, plugin->uid)) {
-        delete plugin;
-        return nullptr;
+    // A preload holds one user until rack_vst3_module_release
+    bool already_preloaded;
+    {
+        std::lock_guard<std::mutex> lock(g_module_cache_mutex);
+        already_preloaded = entry->preloaded;
+        entry->preloaded = true;
+    }
+    if (already_preloaded) {
+        release_module(entry);
     }
+    return RACK_VST3_OK;
+}
 
-    // Load module
-    std::string error_description;
-    plugin->module = Hosting::Module::create(path, error_description);
-    if (!plugin->module) {
-        delete plugin;
-        return nullptr;
+int rack_vst3_module_release(const char* path) {
+    if (!path) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    std::shared_ptr<ModuleEntry> entry;
+    {
+        std::lock_guard<std::mutex> lock(g_module_cache_mutex);
+        auto it = g_module_cache.find(path);
+        if (it == g_module_cache.end() || !it->second->preloaded) {
+            return RACK_VST3_ERROR_NOT_FOUND;
+        }
+        entry = it->second;
+        entry->preloaded = false;
     }
 
+    release_module(entry);
+    return RACK_VST3_OK;
+}
+
+int rack_vst3_module_is_loaded(const char* path) {
+    if (!path) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(g_module_cache_mutex);
+    return g_module_cache.count(path) ? 1 : 0;
+}
+
+// ============================================================================
+// Plugin Instance Implementation
+// ============================================================================
+
+// Create, initialize and connect component and controller.
+// Caller must hold the module entry's lock. On failure the caller frees the
+// plugin with discard_plugin.
+static bool create_components(RackVST3Plugin* plugin) {
     // Create component
     const auto& factory = plugin->module->getFactory();
     plugin->component = factory.createInstance<IComponent>(plugin->uid);
     if (!plugin->component) {
-        delete plugin;
-        return nullptr;
+        return false;
     }
 
     // Get processor interface
     plugin->processor = U::cast<IAudioProcessor>(plugin->component);
     if (!plugin->processor) {
-        delete plugin;
-        return nullptr;
+        return false;
     }
 
     // Initialize component
@@ -453,9 +902,7 @@ RackVST3Plugin* rack_vst3_plugin_new(const char* path, const char* uid) {
         // IPtr will automatically release when plugin is deleted
         plugin->component = nullptr;
         plugin->processor = nullptr;
-        plugin->module = nullptr;
-        delete plugin;
-        return nullptr;
+        return false;
     }
 
     // Try to get edit controller
@@ -473,9 +920,7 @@ RackVST3Plugin* rack_vst3_plugin_new(const char* path, const char* uid) {
                 plugin->controller = nullptr;
                 plugin->component = nullptr;
                 plugin->processor = nullptr;
-                plugin->module = nullptr;
-                delete plugin;
-                return nullptr;
+                return false;
             }
         }
     } else {
@@ -483,9 +928,11 @@ RackVST3Plugin* rack_vst3_plugin_new(const char* path, const char* uid) {
         plugin->controller = U::cast<IEditController>(plugin->component);
     }
 
-    // Set up component handler for GUI parameter change notifications
+    // Set up component handler for GUI parameter change and restart
+    // notifications (created without a controller too: it also holds the
+    // latency cache)
+    plugin->component_handler = owned(new ComponentHandler());
     if (plugin->controller) {
-        plugin->component_handler = owned(new ComponentHandler());
         plugin->controller->setComponentHandler(plugin->component_handler);
     }
 
@@ -500,100 +947,303 @@ RackVST3Plugin* rack_vst3_plugin_new(const char* path, const char* uid) {
         }
     }
 
-    return plugin;
+    return true;
 }
 
-void rack_vst3_plugin_free(RackVST3Plugin* plugin) {
-    if (!plugin) {
+// Delete a plugin and give back its module. Remaining interface pointers are
+// released under the module lock; the module may unload afterwards.
+// Caller must not hold the module entry's lock.
+static void discard_plugin(RackVST3Plugin* plugin) {
+    std::shared_ptr<ModuleEntry> entry = plugin->module_entry;
+    if (!entry) {
+        delete plugin;
         return;
     }
 
-    std::lock_guard<std::mutex> lock(g_vst3_lifecycle_mutex);
+    {
+        std::lock_guard<std::mutex> lock(entry->lock);
+        delete plugin;
+    }
+    release_module(entry);
+}
 
-    // Deactivate if active
-    if (plugin->initialized && plugin->component) {
-        plugin->component->setActive(false);
+RackVST3Plugin* rack_vst3_plugin_new(const char* path, const char* uid) {
+    if (!path || !uid) {
+        return nullptr;
     }
 
-    // Disconnect connection points
-    if (plugin->component_cp && plugin->controller_cp) {
-        plugin->component_cp->disconnect(plugin->controller_cp);
-        plugin->controller_cp->disconnect(plugin->component_cp);
+    auto plugin = new(std::nothrow) RackVST3Plugin();
+    if (!plugin) {
+        return nullptr;
     }
 
-    // Terminate controller
-    if (plugin->controller && reinterpret_cast<void*>(plugin->controller.get()) != reinterpret_cast<void*>(plugin->component.get())) {
-        plugin->controller->terminate();
-        plugin->controller = nullptr;
+    plugin->path = path;
+
+    // Parse UID
+    if (!string_to_uid(uid, plugin->uid)) {
+        delete plugin;
+        return nullptr;
     }
 
-    // Terminate component
-    if (plugin->component) {
-        plugin->component->terminate();
-        plugin->component = nullptr;
+    // Borrow the module from the cache (loaded on first use)
+    plugin->module_entry = acquire_module(plugin->path);
+    if (!plugin->module_entry) {
+        delete plugin;
+        return nullptr;
     }
+    plugin->module = plugin->module_entry->module;
 
-    plugin->processor = nullptr;
-    plugin->module = nullptr;
+    // Only instances of the same module are serialized
+    bool created;
+    {
+        std::lock_guard<std::mutex> lock(plugin->module_entry->lock);
+        created = create_components(plugin);
+    }
+    if (!created) {
+        discard_plugin(plugin);
+        return nullptr;
+    }
 
-    delete plugin;
+    return plugin;
 }
 
-int rack_vst3_plugin_initialize(RackVST3Plugin* plugin, double sample_rate, uint32_t max_block_size) {
-    if (!plugin || !plugin->component || !plugin->processor) {
-        return RACK_VST3_ERROR_INVALID_PARAM;
+void rack_vst3_plugin_free(RackVST3Plugin* plugin) {
+    if (!plugin) {
+        return;
     }
 
-    std::lock_guard<std::mutex> lock(g_vst3_lifecycle_mutex);
-
-    plugin->sample_rate = sample_rate;
-    plugin->max_block_size = max_block_size;
+    // Let a pending asynchronous state load finish first
+    if (plugin->state_worker.joinable()) {
+        plugin->state_worker.join();
+    }
 
-    // Setup processing with 32-bit float samples in realtime mode
-    ProcessSetup setup;
-    setup.processMode = kRealtime;
-    setup.symbolicSampleSize = kSample32;
-    setup.maxSamplesPerBlock = max_block_size;
-    setup.sampleRate = sample_rate;
+    {
+        std::lock_guard<std::mutex> lock(plugin->module_entry->lock);
 
-    if (plugin->processor->setupProcessing(setup) != kResultOk) {
-        return RACK_VST3_ERROR_GENERIC;
-    }
+        // Deactivate if active
+        if (plugin->initialized && plugin->component) {
+            plugin->component->setActive(false);
+        }
 
-    // Get bus configuration
-    int32 numInputBuses = plugin->component->getBusCount(kAudio, kInput);
-    int32 numOutputBuses = plugin->component->getBusCount(kAudio, kOutput);
+        // Disconnect connection points
+        if (plugin->component_cp && plugin->controller_cp) {
+            plugin->component_cp->disconnect(plugin->controller_cp);
+            plugin->controller_cp->disconnect(plugin->component_cp);
+        }
 
-    // Activate main audio buses
-    if (numInputBuses > 0) {
-        plugin->component->activateBus(kAudio, kInput, 0, true);
-        BusInfo busInfo;
-        if (plugin->component->getBusInfo(kAudio, kInput, 0, busInfo) == kResultOk) {
-            plugin->num_input_channels = busInfo.channelCount;
+        // Terminate controller
+        if (plugin->controller && reinterpret_cast<void*>(plugin->controller.get()) != reinterpret_cast<void*>(plugin->component.get())) {
+            plugin->controller->terminate();
+            plugin->controller = nullptr;
         }
-    }
 
-    if (numOutputBuses > 0) {
-        plugin->component->activateBus(kAudio, kOutput, 0, true);
-        BusInfo busInfo;
-        if (plugin->component->getBusInfo(kAudio, kOutput, 0, busInfo) == kResultOk) {
-            plugin->num_output_channels = busInfo.channelCount;
+        // Terminate component
+        if (plugin->component) {
+            plugin->component->terminate();
+            plugin->component = nullptr;
         }
+
+        plugin->processor = nullptr;
+        plugin->module = nullptr;
     }
 
-    // Activate component
-    if (plugin->component->setActive(true) != kResultOk) {
-        return RACK_VST3_ERROR_GENERIC;
+    // Unloads the module if this was its last instance
+    discard_plugin(plugin);
+}
+
+int rack_vst3_plugins_new_parallel(
+    const char* const* paths,
+    const char* const* uids,
+    size_t count,
+    double sample_rate,
+    uint32_t max_block_size,
+    uint32_t num_threads,
+    RackVST3Plugin** plugins
+) {
+    if (!paths || !uids || !plugins) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
     }
 
-    // Start processing
-    if (plugin->processor->setProcessing(true) != kResultOk) {
-        plugin->component->setActive(false);
-        return RACK_VST3_ERROR_GENERIC;
+    for (size_t i = 0; i < count; ++i) {
+        plugins[i] = nullptr;
+    }
+    if (count == 0) {
+        return 0;
     }
 
-    // Prepare process_data once during initialization (not in hot path)
-    plugin->process_data.prepare(*plugin->component, max_block_size, kSample32);
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (num_threads > count) {
+        num_threads = static_cast<uint32_t>(count);
+    }
+
+    // Workers claim list entries in order; instances of different modules
+    // are created and set up concurrently
+    std::atomic<size_t> next{0};
+    std::atomic<int> created{0};
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            RackVST3Plugin* plugin = rack_vst3_plugin_new(paths[i], uids[i]);
+            if (plugin && max_block_size > 0 &&
+                rack_vst3_plugin_initialize(plugin, sample_rate, max_block_size) != RACK_VST3_OK) {
+                rack_vst3_plugin_free(plugin);
+                plugin = nullptr;
+            }
+            if (plugin) {
+                plugins[i] = plugin;
+                created.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    try {
+        for (uint32_t t = 1; t < num_threads; ++t) {
+            threads.emplace_back(worker);
+        }
+    } catch (const std::system_error&) {
+        // Fewer threads than asked for; the remaining workers pick up the slack
+    }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return created.load();
+}
+
+// Sample size to set the processor up with: 64-bit only when requested and
+// supported
+static int32 negotiate_sample_size(RackVST3Plugin* plugin) {
+    if (plugin->prefer_double && plugin->processor->canProcessSampleSize(kSample64) == kResultTrue) {
+        return kSample64;
+    }
+    return kSample32;
+}
+
+template <typename Sample>
+static void prepare_sample_buffers(SampleBuffers<Sample>& buffers, uint32_t num_inputs,
+                                   uint32_t num_outputs, uint32_t max_block_size, bool native) {
+    buffers.split_inputs.assign(num_inputs, nullptr);
+    buffers.split_outputs.assign(num_outputs, nullptr);
+
+    if (!native) {
+        std::vector<Sample>().swap(buffers.convert_storage);
+        buffers.convert_inputs.clear();
+        buffers.convert_outputs.clear();
+        return;
+    }
+
+    buffers.convert_storage.assign(static_cast<size_t>(num_inputs + num_outputs) * max_block_size, Sample(0));
+    buffers.convert_inputs.resize(num_inputs);
+    buffers.convert_outputs.resize(num_outputs);
+    Sample* next = buffers.convert_storage.data();
+    for (uint32_t ch = 0; ch < num_inputs; ++ch, next += max_block_size) {
+        buffers.convert_inputs[ch] = next;
+    }
+    for (uint32_t ch = 0; ch < num_outputs; ++ch, next += max_block_size) {
+        buffers.convert_outputs[ch] = next;
+    }
+}
+
+// Pointer arrays for both sample types, conversion buffers for the
+// processor's own type
+static void prepare_process_buffers(RackVST3Plugin* plugin) {
+    const uint32_t inputs = static_cast<uint32_t>(plugin->num_input_channels);
+    const uint32_t outputs = static_cast<uint32_t>(plugin->num_output_channels);
+    const bool native64 = plugin->symbolic_sample_size == kSample64;
+    prepare_sample_buffers(plugin->buffers32, inputs, outputs, plugin->max_block_size, !native64);
+    prepare_sample_buffers(plugin->buffers64, inputs, outputs, plugin->max_block_size, native64);
+}
+
+// Re-query latency and tail into the cache (non-realtime: the SDK expects
+// these calls on the main thread)
+static void refresh_latency(RackVST3Plugin* plugin) {
+    plugin->component_handler->latency().update(plugin->processor->getLatencySamples(),
+                                                plugin->processor->getTailSamples());
+}
+
+// Take the processor-side parameter values from the controller (non-realtime,
+// with the processor not running: initialize() and state loads)
+static void refresh_processor_values(RackVST3Plugin* plugin) {
+    plugin->processor_values.resize(plugin->parameters.size());
+    for (size_t i = 0; i < plugin->parameters.size(); ++i) {
+        plugin->processor_values[i] = plugin->controller->getParamNormalized(plugin->parameters[i].id);
+    }
+}
+
+int rack_vst3_plugin_initialize(RackVST3Plugin* plugin, double sample_rate, uint32_t max_block_size) {
+    if (!plugin || !plugin->component || !plugin->processor) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lock(plugin->module_entry->lock);
+
+    plugin->sample_rate = sample_rate;
+    plugin->max_block_size = max_block_size;
+    plugin->perf.set_sample_rate(sample_rate);
+
+    // Setup processing in the selected mode, with 64-bit samples if asked
+    // for and supported
+    plugin->symbolic_sample_size = negotiate_sample_size(plugin);
+    ProcessSetup setup;
+    setup.processMode = plugin->process_mode;
+    setup.symbolicSampleSize = plugin->symbolic_sample_size;
+    setup.maxSamplesPerBlock = max_block_size;
+    setup.sampleRate = sample_rate;
+
+    if (plugin->processor->setupProcessing(setup) != kResultOk) {
+        return RACK_VST3_ERROR_GENERIC;
+    }
+
+    // Get bus configuration
+    int32 numInputBuses = plugin->component->getBusCount(kAudio, kInput);
+    int32 numOutputBuses = plugin->component->getBusCount(kAudio, kOutput);
+
+    // Activate main audio buses
+    if (numInputBuses > 0) {
+        plugin->component->activateBus(kAudio, kInput, 0, true);
+        BusInfo busInfo;
+        if (plugin->component->getBusInfo(kAudio, kInput, 0, busInfo) == kResultOk) {
+            plugin->num_input_channels = busInfo.channelCount;
+        }
+    }
+
+    if (numOutputBuses > 0) {
+        plugin->component->activateBus(kAudio, kOutput, 0, true);
+        BusInfo busInfo;
+        if (plugin->component->getBusInfo(kAudio, kOutput, 0, busInfo) == kResultOk) {
+            plugin->num_output_channels = busInfo.channelCount;
+        }
+    }
+
+    // Activate component
+    if (plugin->component->setActive(true) != kResultOk) {
+        return RACK_VST3_ERROR_GENERIC;
+    }
+
+    // Start processing
+    if (plugin->processor->setProcessing(true) != kResultOk) {
+        plugin->component->setActive(false);
+        return RACK_VST3_ERROR_GENERIC;
+    }
+
+    refresh_latency(plugin);
+
+    // Prepare process_data once during initialization (not in hot path)
+    plugin->process_data.prepare(*plugin->component, max_block_size, plugin->symbolic_sample_size);
+    plugin->process_data.processMode = plugin->process_mode;
+
+    plugin->process_context = ProcessContext();
+    plugin->process_context.state = ProcessContext::kContTimeValid;
+    plugin->process_context.sampleRate = sample_rate;
+    plugin->sample_position = 0;
+    plugin->process_data.processContext = &plugin->process_context;
+
+    // Room for a full MIDI queue drain so addEvent() never rejects
+    plugin->input_events.setMaxSize(static_cast<int32>(MIDI_QUEUE_CAPACITY));
 
     // Build parameter cache
     if (plugin->controller) {
@@ -621,6 +1271,28 @@ int rack_vst3_plugin_initialize(RackVST3Plugin* plugin, double sample_rate, uint
         }
     }
 
+    plugin->param_index_map.build(plugin->parameters.size(),
+        [plugin](size_t i) { return static_cast<uint32_t>(plugin->parameters[i].id); });
+
+    // Preallocate automation queues and deferred controller slots so the
+    // audio thread never allocates when queueing parameter changes
+    plugin->input_param_changes.prepare(plugin->parameters.size());
+    plugin->split_param_changes.prepare(plugin->parameters.size());
+    prepare_process_buffers(plugin);
+    plugin->pending_controller_values.reset(
+        new(std::nothrow) std::atomic<float>[plugin->parameters.size()]);
+    if (!plugin->pending_controller_values && !plugin->parameters.empty()) {
+        plugin->processor->setProcessing(false);
+        plugin->component->setActive(false);
+        return RACK_VST3_ERROR_GENERIC;
+    }
+    for (size_t i = 0; i < plugin->parameters.size(); ++i) {
+        plugin->pending_controller_values[i].store(
+            std::numeric_limits<float>::quiet_NaN(), std::memory_order_relaxed);
+    }
+    plugin->pending_controller_count.store(0, std::memory_order_relaxed);
+    refresh_processor_values(plugin);
+
     // Enumerate factory presets if available
     IPtr<IUnitInfo> unit_info = U::cast<IUnitInfo>(plugin->controller);
     if (unit_info) {
@@ -659,7 +1331,7 @@ int rack_vst3_plugin_reset(RackVST3Plugin* plugin) {
 
     // Acquire mutex BEFORE checking state to prevent TOCTOU race condition
     // Without this, another thread could change initialized between check and lock
-    std::lock_guard<std::mutex> lock(g_vst3_lifecycle_mutex);
+    std::lock_guard<std::mutex> lock(plugin->module_entry->lock);
 
     if (!plugin->initialized || !plugin->component) {
         return RACK_VST3_ERROR_NOT_INITIALIZED;
@@ -672,6 +1344,7 @@ int rack_vst3_plugin_reset(RackVST3Plugin* plugin) {
         return RACK_VST3_ERROR_GENERIC;
     }
 
+    plugin->silence_gate.wake();
     return RACK_VST3_OK;
 }
 
@@ -689,30 +1362,112 @@ int rack_vst3_plugin_get_output_channels(RackVST3Plugin* plugin) {
     return plugin->num_output_channels;
 }
 
-int rack_vst3_plugin_process(
+// Samples the plugin may keep sounding after its input goes silent
+static uint64_t plugin_tail_samples(RackVST3Plugin* plugin) {
+    uint32 tail = plugin->processor->getTailSamples();
+    if (tail == kInfiniteTail) {
+        return rack::SilenceGate::INFINITE_TAIL;
+    }
+    return static_cast<uint64_t>(tail) + plugin->processor->getLatencySamples();
+}
+
+// Drain the MIDI queue into input_events in time order
+static void drain_midi_queue(RackVST3Plugin* plugin) {
+    Event* events = plugin->midi_scratch;
+    size_t count = plugin->midi_queue.pop_all(events, MIDI_QUEUE_CAPACITY);
+
+    rack::sort_events(events, count, [](const Event& e) { return e.sampleOffset; });
+
+    for (size_t i = 0; i < count; ++i) {
+        if (plugin->input_events.addEvent(events[i]) != kResultOk) {
+            plugin->perf.add_dropped_midi(1);
+        }
+    }
+}
+
+static bool queue_param_point(RackVST3Plugin* plugin, uint32_t index, uint32_t sample_offset, float value);
+
+// Marks a block as running for as long as it is in scope. Together with
+// state_loading this forms a store-then-load handshake: either process()
+// sees the load flag and bypasses, or the loader sees in_process and waits.
+class ProcessScope {
+public:
+    explicit ProcessScope(RackVST3Plugin* plugin) : plugin_(plugin) {
+        plugin_->in_process.store(true);
+    }
+    ~ProcessScope() {
+        plugin_->in_process.store(false);
+    }
+    ProcessScope(const ProcessScope&) = delete;
+    ProcessScope& operator=(const ProcessScope&) = delete;
+
+private:
+    RackVST3Plugin* plugin_;
+};
+
+// Pass input through while an asynchronous state load owns the plugin.
+// Queued MIDI stays in the queue for the first block after the load.
+template <typename Sample>
+static void bypass_block(RackVST3Plugin* plugin,
+                         const Sample* const* inputs, uint32_t num_input_channels,
+                         Sample* const* outputs, uint32_t num_output_channels,
+                         uint32_t frames) {
+    for (uint32_t ch = 0; ch < num_output_channels; ++ch) {
+        if (ch < num_input_channels) {
+            if (outputs[ch] != inputs[ch]) {
+                memcpy(outputs[ch], inputs[ch], frames * sizeof(Sample));
+            }
+        } else {
+            memset(outputs[ch], 0, frames * sizeof(Sample));
+        }
+    }
+    plugin->sample_position += frames;
+}
+
+// Record the value each parameter's automation ends on this block
+static void record_processor_values(RackVST3Plugin* plugin) {
+    PooledParameterChanges& changes = plugin->input_param_changes;
+    for (int32 q = 0; q < changes.getParameterCount(); ++q) {
+        IParamValueQueue* queue = changes.getParameterData(q);
+        int32_t index = plugin->param_index_map.find(queue->getParameterId());
+        if (index < 0 || queue->getPointCount() == 0) {
+            continue;
+        }
+        int32 offset = 0;
+        ParamValue value = 0.0;
+        queue->getPoint(queue->getPointCount() - 1, offset, value);
+        plugin->processor_values[index] = value;
+    }
+}
+
+// Hand parameter values left by a preset or state load to the processor
+static void drain_state_param_changes(RackVST3Plugin* plugin) {
+    uint32_t id = 0;
+    double value = 0.0;
+    while (plugin->state_param_changes.pop(&id, &value)) {
+        int32_t index = plugin->param_index_map.find(id);
+        if (index >= 0) {
+            queue_param_point(plugin, static_cast<uint32_t>(index), 0, static_cast<float>(value));
+        }
+    }
+}
+
+// Validate channel counts and buffer pointers against the configuration
+// from initialize(), to prevent buffer overruns
+template <typename Sample>
+static int check_process_buffers(
     RackVST3Plugin* plugin,
-    const float* const* inputs,
+    const Sample* const* inputs,
     uint32_t num_input_channels,
-    float* const* outputs,
-    uint32_t num_output_channels,
-    uint32_t frames)
+    Sample* const* outputs,
+    uint32_t num_output_channels)
 {
-    if (!plugin || !plugin->initialized || !plugin->processor) {
-        return RACK_VST3_ERROR_NOT_INITIALIZED;
-    }
-
-    // Validate input parameters to prevent buffer overruns
-    // Channel counts must match what was configured during initialization
     if (num_input_channels != static_cast<uint32_t>(plugin->num_input_channels)) {
         return RACK_VST3_ERROR_INVALID_PARAM;
     }
     if (num_output_channels != static_cast<uint32_t>(plugin->num_output_channels)) {
         return RACK_VST3_ERROR_INVALID_PARAM;
     }
-    // Frame count must not exceed the max block size configured during initialization
-    if (frames > plugin->max_block_size) {
-        return RACK_VST3_ERROR_INVALID_PARAM;
-    }
 
     // Validate buffer pointers when channel counts > 0
     if (num_input_channels > 0 && !inputs) {
@@ -721,7 +1476,39 @@ int rack_vst3_plugin_process(
     if (num_output_channels > 0 && !outputs) {
         return RACK_VST3_ERROR_INVALID_PARAM;
     }
+    return RACK_VST3_OK;
+}
+
+template <typename Sample>
+static SampleBuffers<Sample>& sample_buffers(RackVST3Plugin* plugin) {
+    if constexpr (std::is_same_v<Sample, double>) {
+        return plugin->buffers64;
+    } else {
+        return plugin->buffers32;
+    }
+}
+
+// Point a bus at caller buffers of the processor's sample type
+static void set_bus_channels(AudioBusBuffers& bus, const float* const* channels) {
+    bus.channelBuffers32 = const_cast<float**>(channels);
+}
 
+static void set_bus_channels(AudioBusBuffers& bus, const double* const* channels) {
+    bus.channelBuffers64 = const_cast<double**>(channels);
+}
+
+// Run the plugin on one block of at most max_block_size frames, in the
+// processor's sample type. MIDI for the block must already be in
+// input_events.
+template <typename Sample>
+static int process_block(
+    RackVST3Plugin* plugin,
+    const Sample* const* inputs,
+    uint32_t num_input_channels,
+    Sample* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames)
+{
     // Update dynamic fields only (prepare() was called during initialization)
     plugin->process_data.numSamples = frames;
 
@@ -729,14 +1516,46 @@ int rack_vst3_plugin_process(
     if (num_input_channels > 0) {
         AudioBusBuffers& bus = plugin->process_data.inputs[0];
         bus.numChannels = num_input_channels;
-        bus.channelBuffers32 = const_cast<float**>(inputs);
+        set_bus_channels(bus, inputs);
     }
 
     // Set output buffers
     if (num_output_channels > 0) {
         AudioBusBuffers& bus = plugin->process_data.outputs[0];
         bus.numChannels = num_output_channels;
-        bus.channelBuffers32 = const_cast<float**>(outputs);
+        set_bus_channels(bus, outputs);
+    }
+
+    drain_state_param_changes(plugin);
+
+    // Automation queued past the end of this block lands on its last frame
+    if (frames > 0) {
+        plugin->input_param_changes.clampOffsets(static_cast<int32>(frames - 1));
+    }
+    record_processor_values(plugin);
+
+    // Flag silent input channels for the plugin
+    bool input_silent = true;
+    if (num_input_channels > 0) {
+        plugin->process_data.inputs[0].silenceFlags =
+            rack::silent_channel_mask(inputs, num_input_channels, frames, &input_silent);
+    }
+
+    // Once the plugin has rung out on silent input, skip it until audio or
+    // an event arrives
+    bool has_events = plugin->input_events.getEventCount() > 0 ||
+                      plugin->input_param_changes.getParameterCount() > 0;
+    if (plugin->silence_gate.begin_block(input_silent, has_events,
+                                         [plugin]() { return plugin_tail_samples(plugin); })) {
+        for (uint32_t ch = 0; ch < num_output_channels; ++ch) {
+            memset(outputs[ch], 0, frames * sizeof(Sample));
+        }
+        plugin->sample_position += frames;
+        return RACK_VST3_OK;
+    }
+
+    if (num_output_channels > 0) {
+        plugin->process_data.outputs[0].silenceFlags = 0;
     }
 
     // Set parameter and event interfaces
@@ -745,8 +1564,24 @@ int rack_vst3_plugin_process(
     plugin->process_data.inputEvents = &plugin->input_events;
     plugin->process_data.outputEvents = &plugin->output_events;
 
+    plugin->process_context.projectTimeSamples = plugin->sample_position;
+    plugin->process_context.continousTimeSamples = plugin->sample_position;
+
     // Process
     tresult result = plugin->processor->process(plugin->process_data);
+    plugin->sample_position += frames;
+
+    // Output silence only matters while the input is silent; trust the
+    // plugin's flags when it sets them for every channel, otherwise scan
+    bool output_silent = false;
+    if (plugin->silence_gate.enabled() && input_silent && !has_events) {
+        output_silent = true;
+        if (num_output_channels > 0 &&
+            plugin->process_data.outputs[0].silenceFlags != rack::all_channels_mask(num_output_channels)) {
+            rack::silent_channel_mask(outputs, num_output_channels, frames, &output_silent);
+        }
+    }
+    plugin->silence_gate.end_block(output_silent, frames);
 
     // Clear input/output events and parameter changes for next call
     plugin->input_events.clear();
@@ -754,13 +1589,599 @@ int rack_vst3_plugin_process(
     plugin->output_events.clear();
     plugin->output_param_changes.clearQueue();
 
-    return (result == kResultOk) ? RACK_VST3_OK : RACK_VST3_ERROR_GENERIC;
+    if (result != kResultOk) {
+        plugin->perf.add_process_error();
+        return RACK_VST3_ERROR_GENERIC;
+    }
+    return RACK_VST3_OK;
+}
+
+// Run one block given in the caller's sample type. When the processor was
+// set up with the other type, the block goes through the conversion buffers.
+template <typename Sample>
+static int run_block(
+    RackVST3Plugin* plugin,
+    const Sample* const* inputs,
+    uint32_t num_input_channels,
+    Sample* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames)
+{
+    constexpr int32 caller_sample_size = std::is_same_v<Sample, double> ? kSample64 : kSample32;
+    if (plugin->symbolic_sample_size == caller_sample_size) {
+        return process_block(plugin, inputs, num_input_channels, outputs, num_output_channels, frames);
+    }
+
+    using Native = std::conditional_t<std::is_same_v<Sample, double>, float, double>;
+    SampleBuffers<Native>& native = sample_buffers<Native>(plugin);
+    for (uint32_t ch = 0; ch < num_input_channels; ++ch) {
+        rack::convert_samples(inputs[ch], native.convert_inputs[ch], frames);
+    }
+    int result = process_block<Native>(plugin, native.convert_inputs.data(), num_input_channels,
+                                       native.convert_outputs.data(), num_output_channels, frames);
+    for (uint32_t ch = 0; ch < num_output_channels; ++ch) {
+        rack::convert_samples(native.convert_outputs[ch], outputs[ch], frames);
+    }
+    return result;
+}
+
+template <typename Sample>
+static int process_impl(
+    RackVST3Plugin* plugin,
+    const Sample* const* inputs,
+    uint32_t num_input_channels,
+    Sample* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames)
+{
+    if (!plugin || !plugin->initialized || !plugin->processor) {
+        return RACK_VST3_ERROR_NOT_INITIALIZED;
+    }
+
+    int status = check_process_buffers(plugin, inputs, num_input_channels, outputs, num_output_channels);
+    if (status != RACK_VST3_OK) {
+        return status;
+    }
+    // Frame count must not exceed the max block size configured during initialization
+    if (frames > plugin->max_block_size) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    ProcessScope scope(plugin);
+    if (plugin->state_loading.load()) {
+        bypass_block(plugin, inputs, num_input_channels, outputs, num_output_channels, frames);
+        return RACK_VST3_OK;
+    }
+
+    // Hand MIDI queued by send_midi() to the plugin in time order
+    drain_midi_queue(plugin);
+
+    return run_block(plugin, inputs, num_input_channels, outputs, num_output_channels, frames);
+}
+
+// Time one public process call for get_stats(). Calls rejected before
+// reaching the plugin are not counted.
+// Every public process path goes through here, so this is also where the
+// FPU flushes denormals and RACK_RT_CHECKS watches for allocation.
+template <typename Process>
+static int timed_process(RackVST3Plugin* plugin, uint32_t frames, Process&& process) {
+    if (!plugin) {
+        return RACK_VST3_ERROR_NOT_INITIALIZED;
+    }
+    rack::ScopedFlushDenormals flush_denormals;
+    rack::RtCheckScope rt_check;
+    uint64_t start = plugin->perf.begin();
+    int result = process();
+    if (result != RACK_VST3_ERROR_NOT_INITIALIZED && result != RACK_VST3_ERROR_INVALID_PARAM) {
+        plugin->perf.end(start, frames);
+    }
+    return result;
+}
+
+int rack_vst3_plugin_process(
+    RackVST3Plugin* plugin,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames)
+{
+    return timed_process(plugin, frames, [&]() {
+        return process_impl(plugin, inputs, num_input_channels, outputs, num_output_channels, frames);
+    });
+}
+
+int rack_vst3_plugin_process_f64(
+    RackVST3Plugin* plugin,
+    const double* const* inputs,
+    uint32_t num_input_channels,
+    double* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames)
+{
+    return timed_process(plugin, frames, [&]() {
+        return process_impl(plugin, inputs, num_input_channels, outputs, num_output_channels, frames);
+    });
+}
+
+// Give the sub-block [start, start + frames) its share of the automation
+// staged in split_param_changes, rebased to the sub-block. A ramp that
+// crosses the end of the sub-block gets an interpolated point on its last
+// frame, so the plugin sees the same ramp as in one long block; the ramp to
+// a sub-block's first point starts from the value the processor has now.
+static void route_split_param_points(RackVST3Plugin* plugin, uint32_t start, uint32_t frames, bool last) {
+    PooledParameterChanges& staged = plugin->split_param_changes;
+
+    for (int32 q = 0; q < staged.getParameterCount(); ++q) {
+        IParamValueQueue* source = staged.getParameterData(q);
+        ParamID id = source->getParameterId();
+        int32_t index = plugin->param_index_map.find(id);
+        double previous_value = index >= 0 ? plugin->processor_values[index] : 0.0;
+
+        IParamValueQueue* target = nullptr;
+        int32 target_index = 0;
+        rack::split_ramp_points(source->getPointCount(),
+            [source](int32_t p, int32_t* offset, double* value) {
+                int32 point_offset = 0;
+                ParamValue point_value = 0.0;
+                source->getPoint(p, point_offset, point_value);
+                *offset = point_offset;
+                *value = point_value;
+            },
+            previous_value, static_cast<int32_t>(start), static_cast<int32_t>(frames), last,
+            [plugin, id, &target, &target_index](int32_t offset, double value) {
+                if (!target) {
+                    target = plugin->input_param_changes.addParameterData(id, target_index);
+                    if (!target) {
+                        return false;
+                    }
+                }
+                int32 point_index = 0;
+                target->addPoint(offset, value, point_index);
+                return true;
+            });
+    }
+}
+
+template <typename Sample>
+static int process_split_impl(
+    RackVST3Plugin* plugin,
+    const Sample* const* inputs,
+    uint32_t num_input_channels,
+    Sample* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames)
+{
+    if (!plugin || !plugin->initialized || !plugin->processor || plugin->max_block_size == 0) {
+        return RACK_VST3_ERROR_NOT_INITIALIZED;
+    }
+
+    if (frames <= plugin->max_block_size) {
+        return process_impl(plugin, inputs, num_input_channels, outputs, num_output_channels, frames);
+    }
+    // Sample offsets are int32
+    if (frames > static_cast<uint32_t>(std::numeric_limits<int32>::max())) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    int status = check_process_buffers(plugin, inputs, num_input_channels, outputs, num_output_channels);
+    if (status != RACK_VST3_OK) {
+        return status;
+    }
+
+    ProcessScope scope(plugin);
+    if (plugin->state_loading.load()) {
+        bypass_block(plugin, inputs, num_input_channels, outputs, num_output_channels, frames);
+        return RACK_VST3_OK;
+    }
+
+    // Take the whole span's MIDI and automation up front; each sub-block
+    // then gets the part that falls inside it
+    Event* events = plugin->midi_scratch;
+    size_t event_count = plugin->midi_queue.pop_all(events, MIDI_QUEUE_CAPACITY);
+    rack::sort_events(events, event_count, [](const Event& e) { return e.sampleOffset; });
+
+    plugin->split_param_changes.clearQueue();
+    plugin->split_param_changes.swap(plugin->input_param_changes);
+
+    SampleBuffers<Sample>& buffers = sample_buffers<Sample>(plugin);
+    size_t next_event = 0;
+    int result = RACK_VST3_OK;
+    for (uint32_t start = 0; start < frames; ) {
+        uint32_t block = std::min(frames - start, plugin->max_block_size);
+        uint32_t end = start + block;
+        bool last = end == frames;
+
+        for (uint32_t ch = 0; ch < num_input_channels; ++ch) {
+            buffers.split_inputs[ch] = inputs[ch] + start;
+        }
+        for (uint32_t ch = 0; ch < num_output_channels; ++ch) {
+            buffers.split_outputs[ch] = outputs[ch] + start;
+        }
+
+        // Events past the span land on its last frame
+        while (next_event < event_count &&
+               (last || events[next_event].sampleOffset < static_cast<int32>(end))) {
+            Event event = events[next_event++];
+            int32 offset = event.sampleOffset - static_cast<int32>(start);
+            event.sampleOffset = std::max(0, std::min(offset, static_cast<int32>(block - 1)));
+            if (plugin->input_events.addEvent(event) != kResultOk) {
+                plugin->perf.add_dropped_midi(1);
+            }
+        }
+        route_split_param_points(plugin, start, block, last);
+
+        status = run_block(plugin, buffers.split_inputs.data(), num_input_channels,
+                           buffers.split_outputs.data(), num_output_channels, block);
+        if (status != RACK_VST3_OK && result == RACK_VST3_OK) {
+            result = status;
+        }
+
+        start = end;
+    }
+
+    plugin->split_param_changes.clearQueue();
+    return result;
+}
+
+int rack_vst3_plugin_process_split(
+    RackVST3Plugin* plugin,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames)
+{
+    return timed_process(plugin, frames, [&]() {
+        return process_split_impl(plugin, inputs, num_input_channels, outputs, num_output_channels, frames);
+    });
+}
+
+int rack_vst3_plugin_process_split_f64(
+    RackVST3Plugin* plugin,
+    const double* const* inputs,
+    uint32_t num_input_channels,
+    double* const* outputs,
+    uint32_t num_output_channels,
+    uint32_t frames)
+{
+    return timed_process(plugin, frames, [&]() {
+        return process_split_impl(plugin, inputs, num_input_channels, outputs, num_output_channels, frames);
+    });
+}
+
+int rack_vst3_plugin_set_process_mode(RackVST3Plugin* plugin, RackVST3ProcessMode mode) {
+    if (!plugin || !plugin->component || !plugin->processor) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    if (mode != RACK_VST3_PROCESS_MODE_REALTIME &&
+        mode != RACK_VST3_PROCESS_MODE_PREFETCH &&
+        mode != RACK_VST3_PROCESS_MODE_OFFLINE) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lock(plugin->module_entry->lock);
+
+    int32 previous_mode = plugin->process_mode;
+    plugin->process_mode = static_cast<int32>(mode);
+    if (!plugin->initialized || previous_mode == plugin->process_mode) {
+        return RACK_VST3_OK;  // Applied by (or already current since) initialize()
+    }
+
+    // setupProcessing() is only allowed while inactive
+    ProcessSetup setup;
+    setup.processMode = plugin->process_mode;
+    setup.symbolicSampleSize = plugin->symbolic_sample_size;
+    setup.maxSamplesPerBlock = plugin->max_block_size;
+    setup.sampleRate = plugin->sample_rate;
+
+    plugin->processor->setProcessing(false);
+    plugin->component->setActive(false);
+
+    tresult setup_result = plugin->processor->setupProcessing(setup);
+    if (setup_result != kResultOk) {
+        // Keep running in the previous mode
+        plugin->process_mode = previous_mode;
+        setup.processMode = previous_mode;
+        plugin->processor->setupProcessing(setup);
+    }
+
+    if (plugin->component->setActive(true) != kResultOk ||
+        plugin->processor->setProcessing(true) != kResultOk) {
+        plugin->initialized = false;
+        return RACK_VST3_ERROR_GENERIC;
+    }
+
+    plugin->process_data.processMode = plugin->process_mode;
+    refresh_latency(plugin);
+    return (setup_result == kResultOk) ? RACK_VST3_OK : RACK_VST3_ERROR_NOT_SUPPORTED;
+}
+
+int rack_vst3_plugin_set_double_precision(RackVST3Plugin* plugin, int enabled) {
+    if (!plugin || !plugin->component || !plugin->processor) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lock(plugin->module_entry->lock);
+
+    plugin->prefer_double = enabled != 0;
+    if (!plugin->initialized) {
+        return RACK_VST3_OK;  // Negotiated by initialize()
+    }
+
+    int32 previous_size = plugin->symbolic_sample_size;
+    int32 sample_size = negotiate_sample_size(plugin);
+    if (sample_size == previous_size) {
+        return RACK_VST3_OK;
+    }
+
+    ProcessSetup setup;
+    setup.processMode = plugin->process_mode;
+    setup.symbolicSampleSize = sample_size;
+    setup.maxSamplesPerBlock = plugin->max_block_size;
+    setup.sampleRate = plugin->sample_rate;
+
+    plugin->processor->setProcessing(false);
+    plugin->component->setActive(false);
+
+    if (plugin->processor->setupProcessing(setup) != kResultOk) {
+        // Keep running at the previous sample size
+        sample_size = previous_size;
+        setup.symbolicSampleSize = previous_size;
+        plugin->processor->setupProcessing(setup);
+    }
+
+    if (plugin->component->setActive(true) != kResultOk ||
+        plugin->processor->setProcessing(true) != kResultOk) {
+        plugin->initialized = false;
+        return RACK_VST3_ERROR_GENERIC;
+    }
+
+    // The bus buffer pointers are a union, so process_data is not
+    // re-prepared; only the sample size and conversion buffers change
+    plugin->symbolic_sample_size = sample_size;
+    plugin->process_data.symbolicSampleSize = sample_size;
+    prepare_process_buffers(plugin);
+    refresh_latency(plugin);
+    return RACK_VST3_OK;
+}
+
+int rack_vst3_plugin_get_sample_size(RackVST3Plugin* plugin) {
+    if (!plugin || !plugin->initialized) {
+        return RACK_VST3_ERROR_NOT_INITIALIZED;
+    }
+    return plugin->symbolic_sample_size == kSample64 ? 64 : 32;
+}
+
+int rack_vst3_plugin_get_latency(RackVST3Plugin* plugin, uint32_t* latency_samples, uint32_t* tail_samples) {
+    if (!plugin) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+    if (!plugin->initialized || !plugin->processor) {
+        return RACK_VST3_ERROR_NOT_INITIALIZED;
+    }
+
+    refresh_latency(plugin);
+    rack::LatencyMonitor& latency = plugin->component_handler->latency();
+    if (latency_samples) {
+        *latency_samples = latency.latency();
+    }
+    if (tail_samples) {
+        *tail_samples = latency.tail();
+    }
+    return RACK_VST3_OK;
+}
+
+uint32_t rack_vst3_plugin_get_latency_generation(RackVST3Plugin* plugin) {
+    if (!plugin || !plugin->component_handler) {
+        return 0;
+    }
+    return plugin->component_handler->latency().generation();
+}
+
+int rack_vst3_plugin_render_offline(
+    RackVST3Plugin* plugin,
+    const float* const* inputs,
+    uint32_t num_input_channels,
+    float* const* outputs,
+    uint32_t num_output_channels,
+    uint64_t total_frames)
+{
+    if (!plugin || !plugin->initialized || plugin->max_block_size == 0) {
+        return RACK_VST3_ERROR_NOT_INITIALIZED;
+    }
+    if ((num_input_channels > 0 && !inputs) || (num_output_channels > 0 && !outputs)) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    // Per-span channel pointers (render_offline is not a realtime call)
+    std::vector<const float*> span_inputs(num_input_channels);
+    std::vector<float*> span_outputs(num_output_channels);
+
+    // Spans of whole blocks; process_split() does the block splitting
+    const uint64_t max_span = static_cast<uint64_t>(std::numeric_limits<int32>::max());
+    const uint64_t span_limit = (max_span / plugin->max_block_size) * plugin->max_block_size;
+
+    uint64_t position = 0;
+    while (position < total_frames) {
+        uint64_t remaining = total_frames - position;
+        uint32_t frames = static_cast<uint32_t>(std::min(remaining, span_limit));
+
+        for (uint32_t ch = 0; ch < num_input_channels; ++ch) {
+            span_inputs[ch] = inputs[ch] + position;
+        }
+        for (uint32_t ch = 0; ch < num_output_channels; ++ch) {
+            span_outputs[ch] = outputs[ch] + position;
+        }
+
+        int result = rack_vst3_plugin_process_split(
+            plugin,
+            span_inputs.data(), num_input_channels,
+            span_outputs.data(), num_output_channels,
+            frames);
+        if (result != RACK_VST3_OK) {
+            return result;
+        }
+
+        position += frames;
+    }
+
+    return RACK_VST3_OK;
+}
+
+int rack_vst3_plugin_set_idle_sleep(RackVST3Plugin* plugin, int enabled) {
+    if (!plugin) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    plugin->silence_gate.set_enabled(enabled != 0);
+    plugin->silence_gate.wake();
+    return RACK_VST3_OK;
+}
+
+int rack_vst3_plugin_get_block_counts(RackVST3Plugin* plugin, uint64_t* processed, uint64_t* skipped) {
+    if (!plugin) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    if (processed) {
+        *processed = plugin->silence_gate.processed_blocks();
+    }
+    if (skipped) {
+        *skipped = plugin->silence_gate.skipped_blocks();
+    }
+    return RACK_VST3_OK;
+}
+
+int rack_vst3_plugin_get_stats(RackVST3Plugin* plugin, RackVST3PluginStats* stats) {
+    if (!plugin || !stats) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    rack::PerfSnapshot snapshot;
+    plugin->perf.snapshot(snapshot);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->process_calls = snapshot.process_calls;
+    stats->frames = snapshot.frames;
+    stats->total_ns = snapshot.total_ns;
+    stats->max_ns = snapshot.max_ns;
+    stats->deadline_ns = snapshot.deadline_ns;
+    stats->deadline_misses = snapshot.deadline_misses;
+    stats->max_load = snapshot.max_load;
+    stats->average_load = snapshot.deadline_ns > 0
+        ? static_cast<double>(snapshot.total_ns) / static_cast<double>(snapshot.deadline_ns) : 0.0;
+    stats->process_errors = snapshot.process_errors;
+    stats->dropped_midi_events = snapshot.dropped_midi_events;
+    if (plugin->component_handler) {
+        stats->dropped_param_changes = plugin->component_handler->getOverflowCount() -
+                                       plugin->param_overflow_base.load(std::memory_order_relaxed);
+    }
+    static_assert(RACK_VST3_STATS_HISTOGRAM_BUCKETS == rack::PERF_HISTOGRAM_BUCKETS,
+                  "histogram size mismatch");
+    memcpy(stats->histogram, snapshot.histogram, sizeof(stats->histogram));
+
+    return RACK_PERF_COUNTERS ? RACK_VST3_OK : RACK_VST3_ERROR_NOT_SUPPORTED;
+}
+
+template <typename Sample>
+static bool lock_sample_buffers(RackRtContext* ctx, const SampleBuffers<Sample>& buffers) {
+    return lock_vector(ctx, buffers.split_inputs) && lock_vector(ctx, buffers.split_outputs) &&
+           lock_vector(ctx, buffers.convert_storage) && lock_vector(ctx, buffers.convert_inputs) &&
+           lock_vector(ctx, buffers.convert_outputs);
+}
+
+int rack_vst3_plugin_lock_memory(RackVST3Plugin* plugin, RackRtContext* ctx) {
+    if (!plugin || !ctx) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+    if (!plugin->initialized) {
+        return RACK_VST3_ERROR_NOT_INITIALIZED;
+    }
+
+    // The instance itself holds the MIDI queue and scratch events; the rest
+    // was sized by initialize()
+    bool ok = rack_rt_context_lock_memory(ctx, plugin, sizeof(*plugin)) == RACK_RT_OK &&
+              plugin->input_param_changes.lockMemory(ctx) &&
+              plugin->split_param_changes.lockMemory(ctx) &&
+              lock_vector(ctx, plugin->processor_values) &&
+              lock_sample_buffers(ctx, plugin->buffers32) &&
+              lock_sample_buffers(ctx, plugin->buffers64);
+    if (ok && plugin->pending_controller_values) {
+        ok = rack_rt_context_lock_memory(ctx, plugin->pending_controller_values.get(),
+                                         plugin->parameters.size() * sizeof(std::atomic<float>)) == RACK_RT_OK;
+    }
+    return ok ? RACK_VST3_OK : RACK_VST3_ERROR_GENERIC;
+}
+
+int rack_vst3_plugin_reset_stats(RackVST3Plugin* plugin) {
+    if (!plugin) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    plugin->perf.reset();
+    if (plugin->component_handler) {
+        plugin->param_overflow_base.store(plugin->component_handler->getOverflowCount(),
+                                          std::memory_order_relaxed);
+    }
+    return RACK_VST3_OK;
 }
 
 // ============================================================================
 // Parameter API
 // ============================================================================
 
+// Queue one automation point for the processor and mark the controller value
+// dirty. Realtime-safe: touches only storage preallocated in initialize().
+// Returns false if the parameter's queue or the queue pool is full.
+static bool queue_param_point(RackVST3Plugin* plugin, uint32_t index, uint32_t sample_offset, float value) {
+    PooledParamValueQueue* queue =
+        plugin->input_param_changes.queueForIndex(index, plugin->parameters[index].id);
+    if (!queue) {
+        return false;
+    }
+
+    int32 point_index = 0;
+    if (queue->addPoint(static_cast<int32>(sample_offset), value, point_index) != kResultOk) {
+        return false;
+    }
+
+    // The controller should reflect the value at the end of the block
+    int32 last_offset = 0;
+    ParamValue last_value = value;
+    queue->getPoint(queue->getPointCount() - 1, last_offset, last_value);
+
+    plugin->pending_controller_values[index].store(
+        static_cast<float>(last_value), std::memory_order_relaxed);
+    plugin->pending_controller_count.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+// Apply controller values queued from the audio thread
+static void flush_controller_updates(RackVST3Plugin* plugin) {
+    if (!plugin->controller || !plugin->pending_controller_values) {
+        return;
+    }
+
+    // The state worker owns the controller until the load completes
+    if (plugin->state_loading.load()) {
+        return;
+    }
+
+    if (plugin->pending_controller_count.exchange(0, std::memory_order_acquire) == 0) {
+        return;
+    }
+
+    const float clean = std::numeric_limits<float>::quiet_NaN();
+    for (size_t i = 0; i < plugin->parameters.size(); ++i) {
+        float value = plugin->pending_controller_values[i].exchange(clean, std::memory_order_acq_rel);
+        if (!std::isnan(value)) {
+            plugin->controller->setParamNormalized(plugin->parameters[i].id, value);
+        }
+    }
+}
+
 int rack_vst3_plugin_parameter_count(RackVST3Plugin* plugin) {
     if (!plugin || !plugin->controller) {
         return 0;
@@ -777,6 +2198,9 @@ int rack_vst3_plugin_get_parameter(RackVST3Plugin* plugin, uint32_t index, float
         return RACK_VST3_ERROR_INVALID_PARAM;
     }
 
+    // Make values queued from the audio thread visible first
+    flush_controller_updates(plugin);
+
     ParamID param_id = plugin->parameters[index].id;
     ParamValue normalized = plugin->controller->getParamNormalized(param_id);
     *value = static_cast<float>(normalized);
@@ -799,24 +2223,79 @@ int rack_vst3_plugin_set_parameter(RackVST3Plugin* plugin, uint32_t index, float
     if (value < 0.0f) value = 0.0f;
     if (value > 1.0f) value = 1.0f;
 
-    ParamID param_id = plugin->parameters[index].id;
+    // Before initialize() there is no processing, so update the controller
+    // directly; the component picks up the value through its state on activation
+    if (!plugin->pending_controller_values) {
+        plugin->controller->setParamNormalized(plugin->parameters[index].id, value);
+        return RACK_VST3_OK;
+    }
+
+    // Queue at sample offset 0 of the next process() call; the controller is
+    // updated later by rack_vst3_plugin_flush_param_updates()
+    if (!queue_param_point(plugin, index, 0, value)) {
+        return RACK_VST3_ERROR_GENERIC;
+    }
+
+    return RACK_VST3_OK;
+}
+
+int rack_vst3_plugin_queue_param_points(
+    RackVST3Plugin* plugin,
+    const RackVST3ParamPoint* points,
+    uint32_t count)
+{
+    if (!plugin || (!points && count > 0)) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
 
-    // Set parameter value on controller (for UI reflection)
-    plugin->controller->setParamNormalized(param_id, value);
+    if (!plugin->initialized || !plugin->pending_controller_values) {
+        return RACK_VST3_ERROR_NOT_INITIALIZED;
+    }
 
-    // Queue parameter change for component notification in next process() call
-    // This ensures the component receives the parameter change properly
-    int32 queue_index = 0;
-    IParamValueQueue* queue = plugin->input_param_changes.addParameterData(param_id, queue_index);
-    if (queue) {
-        // Add parameter change at sample offset 0 (beginning of next buffer)
-        int32 point_index = 0;
-        queue->addPoint(0, value, point_index);
+    // Offsets past the next block are kept for process_split(); process()
+    // moves them onto its last frame
+    const uint32_t last_offset = static_cast<uint32_t>(std::numeric_limits<int32>::max());
+    const uint32_t param_count = static_cast<uint32_t>(plugin->parameters.size());
+
+    int queued = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        const RackVST3ParamPoint& point = points[i];
+        if (point.param_index >= param_count) {
+            continue;
+        }
+
+        float value = point.value;
+        if (value < 0.0f) value = 0.0f;
+        if (value > 1.0f) value = 1.0f;
+
+        uint32_t offset = std::min(point.sample_offset, last_offset);
+
+        if (queue_param_point(plugin, point.param_index, offset, value)) {
+            queued++;
+        }
     }
 
+    return queued;
+}
+
+int rack_vst3_plugin_flush_param_updates(RackVST3Plugin* plugin) {
+    if (!plugin) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    flush_controller_updates(plugin);
     return RACK_VST3_OK;
 }
 
+int rack_vst3_plugin_param_index_for_id(RackVST3Plugin* plugin, uint32_t param_id) {
+    if (!plugin) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    int32_t index = plugin->param_index_map.find(param_id);
+    return index >= 0 ? index : RACK_VST3_ERROR_NOT_FOUND;
+}
+
 int rack_vst3_plugin_parameter_info(
     RackVST3Plugin* plugin,
     uint32_t index,
@@ -896,7 +2375,9 @@ int rack_vst3_plugin_get_preset_info(
     return RACK_VST3_OK;
 }
 
-int rack_vst3_plugin_load_preset(RackVST3Plugin* plugin, int32_t preset_number) {
+// Load a factory preset on the calling thread (shared by the blocking and
+// asynchronous entry points)
+static int apply_preset(RackVST3Plugin* plugin, int32_t preset_number) {
     if (!plugin || !plugin->initialized || !plugin->controller) {
         return RACK_VST3_ERROR_NOT_INITIALIZED;
     }
@@ -933,6 +2414,7 @@ int rack_vst3_plugin_load_preset(RackVST3Plugin* plugin, int32_t preset_number)
             result = program_data->setProgramData(preset.program_list_id, preset.program_index, stream);
 
             if (result == kResultOk) {
+                plugin->silence_gate.wake();
                 return RACK_VST3_OK;
             }
         }
@@ -1016,13 +2498,8 @@ int rack_vst3_plugin_load_preset(RackVST3Plugin* plugin, int32_t preset_number)
             // Set the parameter
             ParamID param_id = param_info.id;
             if (plugin->controller->setParamNormalized(param_id, normalized_value) == kResultOk) {
-                // Queue the parameter change for the processor
-                int32 queue_index = 0;
-                IParamValueQueue* queue = plugin->input_param_changes.addParameterData(param_id, queue_index);
-                if (queue) {
-                    int32 point_index = 0;
-                    queue->addPoint(0, normalized_value, point_index);
-                }
+                // Hand the parameter change to the processor with the next block
+                plugin->state_param_changes.push(param_id, normalized_value);
 
                 // Successfully loaded via parameter-based fallback
                 return RACK_VST3_OK;
@@ -1054,19 +2531,33 @@ int rack_vst3_plugin_load_preset(RackVST3Plugin* plugin, int32_t preset_number)
     return RACK_VST3_ERROR_NOT_SUPPORTED;
 }
 
-int rack_vst3_plugin_get_state_size(RackVST3Plugin* plugin) {
-    if (!plugin || !plugin->component) {
-        return 0;
+int rack_vst3_plugin_load_preset(RackVST3Plugin* plugin, int32_t preset_number) {
+    if (plugin && plugin->state_loading.load()) {
+        return RACK_VST3_ERROR_BUSY;
     }
+    return apply_preset(plugin, preset_number);
+}
 
-    // VST3 doesn't provide a query method for state size
-    // We need to actually serialize the state to determine the size
-    // This is done once for buffer allocation - worth the cost for accuracy
+// The plugin's reusable state stream, created on first use (NULL if out of memory)
+static MemoryStream* reusable_state_stream(RackVST3Plugin* plugin) {
+    if (!plugin->state_stream) {
+        plugin->state_stream = IPtr<MemoryStream>(new(std::nothrow) MemoryStream(), false);
+    }
+    return plugin->state_stream;
+}
 
-    // Create temporary memory stream for size calculation
-    IPtr<MemoryStream> stream(new MemoryStream(), false);
+// Serialize component and controller state into the plugin's reusable state
+// stream, layout: [uint32 component state size][component state][controller state].
+// The stream keeps its capacity, so repeated snapshots don't allocate once
+// it has grown to the plugin's state size.
+static int serialize_state(RackVST3Plugin* plugin) {
+    MemoryStream* stream = reusable_state_stream(plugin);
+    if (!stream) {
+        return RACK_VST3_ERROR_GENERIC;
+    }
+    stream->clear();
 
-    // Reserve space for component state size marker
+    // Reserve space for component state size marker (write it later)
     uint32_t size_marker_placeholder = 0;
     stream->write(&size_marker_placeholder, sizeof(size_marker_placeholder), nullptr);
 
@@ -1077,26 +2568,50 @@ int rack_vst3_plugin_get_state_size(RackVST3Plugin* plugin) {
     // Get component state
     tresult result = plugin->component->getState(stream);
     if (result != kResultOk) {
-        // State serialization failed - return a safe default
-        return 1024 * 1024;  // 1MB fallback
+        stream->clear();
+        return RACK_VST3_ERROR_GENERIC;
     }
 
-    // Record position after component state
+    // Record position after component state (= size of component state)
     int64 component_end_pos = 0;
     stream->tell(&component_end_pos);
+    uint32_t component_state_size = static_cast<uint32_t>(component_end_pos - component_start_pos);
+
+    // Write component state size marker at the beginning
+    stream->seek(0, IBStream::kIBSeekSet, nullptr);
+    stream->write(&component_state_size, sizeof(component_state_size), nullptr);
+
+    // Seek back to end to append controller state
+    stream->seek(component_end_pos, IBStream::kIBSeekSet, nullptr);
 
     // Get controller state if separate controller
     if (plugin->controller && reinterpret_cast<void*>(plugin->controller.get()) != reinterpret_cast<void*>(plugin->component.get())) {
         result = plugin->controller->getState(stream);
         if (result != kResultOk) {
-            // Controller state failed - return component state size only
-            return static_cast<int>(stream->getSize());
+            stream->clear();
+            return RACK_VST3_ERROR_GENERIC;
         }
     }
 
+    return RACK_VST3_OK;
+}
+
+int rack_vst3_plugin_get_state_size(RackVST3Plugin* plugin) {
+    if (!plugin || !plugin->component || plugin->state_loading.load()) {
+        return 0;
+    }
+
+    // VST3 doesn't provide a query method for state size
+    // We need to actually serialize the state to determine the size.
+    // rack_vst3_plugin_snapshot_state avoids serializing twice.
+    if (serialize_state(plugin) != RACK_VST3_OK) {
+        // State serialization failed - return a safe default
+        return 1024 * 1024;  // 1MB fallback
+    }
+
     // Return actual state size
     // This avoids the retry pattern - user gets correct size on first call
-    return static_cast<int>(stream->getSize());
+    return static_cast<int>(plugin->state_stream->getSize());
 }
 
 int rack_vst3_plugin_get_state(RackVST3Plugin* plugin, uint8_t* data, size_t* size) {
@@ -1108,69 +2623,53 @@ int rack_vst3_plugin_get_state(RackVST3Plugin* plugin, uint8_t* data, size_t* si
         return RACK_VST3_ERROR_INVALID_PARAM;
     }
 
-    // Create memory stream for state serialization
-    // IPtr ensures automatic cleanup on ALL code paths (success, error, buffer size check failure)
-    IPtr<MemoryStream> stream(new MemoryStream(), false);
-
-    // Reserve space for component state size marker (write it later)
-    uint32_t size_marker_placeholder = 0;
-    stream->write(&size_marker_placeholder, sizeof(size_marker_placeholder), nullptr);
-
-    // Record position before component state
-    int64 component_start_pos = 0;
-    stream->tell(&component_start_pos);
-
-    // Get component state
-    tresult result = plugin->component->getState(stream);
-    if (result != kResultOk) {
-        return RACK_VST3_ERROR_GENERIC;
+    if (plugin->state_loading.load()) {
+        return RACK_VST3_ERROR_BUSY;
     }
 
-    // Record position after component state (= size of component state)
-    int64 component_end_pos = 0;
-    stream->tell(&component_end_pos);
-    uint32_t component_state_size = static_cast<uint32_t>(component_end_pos - component_start_pos);
-
-    // Write component state size marker at the beginning
-    stream->seek(0, IBStream::kIBSeekSet, nullptr);
-    stream->write(&component_state_size, sizeof(component_state_size), nullptr);
-
-    // Seek back to end to append controller state
-    stream->seek(component_end_pos, IBStream::kIBSeekSet, nullptr);
-
-    // Get controller state if separate controller
-    if (plugin->controller && reinterpret_cast<void*>(plugin->controller.get()) != reinterpret_cast<void*>(plugin->component.get())) {
-        result = plugin->controller->getState(stream);
-        if (result != kResultOk) {
-            return RACK_VST3_ERROR_GENERIC;
-        }
+    int status = serialize_state(plugin);
+    if (status != RACK_VST3_OK) {
+        return status;
     }
 
     // Copy to output buffer
-    // Note: MemoryStream grows dynamically - no fixed limit, can't overflow
     // get_state_size() returns the actual size, so this should match
     // However, we still check in case the state changed between calls
-    size_t state_size = stream->getSize();
+    size_t state_size = plugin->state_stream->getSize();
     if (state_size > *size) {
         *size = state_size;  // Return required size for caller to retry
         return RACK_VST3_ERROR_INVALID_PARAM;
     }
 
-    memcpy(data, stream->getData().data(), state_size);
+    memcpy(data, plugin->state_stream->getData().data(), state_size);
     *size = state_size;
-    // IPtr automatically releases stream on scope exit
 
     return RACK_VST3_OK;
 }
 
-int rack_vst3_plugin_set_state(RackVST3Plugin* plugin, const uint8_t* data, size_t size) {
-    if (!plugin || !data || size == 0 || !plugin->component) {
+int rack_vst3_plugin_snapshot_state(RackVST3Plugin* plugin, const uint8_t** data, size_t* size) {
+    if (!plugin || !data || !size || !plugin->component) {
         return RACK_VST3_ERROR_INVALID_PARAM;
     }
 
-    // Create memory stream from data (IPtr provides RAII cleanup)
-    IPtr<MemoryStream> stream(new MemoryStream(data, size), false);
+    if (plugin->state_loading.load()) {
+        return RACK_VST3_ERROR_BUSY;
+    }
+
+    int status = serialize_state(plugin);
+    if (status != RACK_VST3_OK) {
+        *data = nullptr;
+        *size = 0;
+        return status;
+    }
+
+    *data = plugin->state_stream->getData().data();
+    *size = plugin->state_stream->getSize();
+    return RACK_VST3_OK;
+}
 
+// Restore component and controller state from stream (positioned at 0)
+static int apply_state(RackVST3Plugin* plugin, MemoryStream* stream) {
     // Read component state size marker first (written at position 0 during serialization)
     uint32_t component_state_size = 0;
     int32 bytes_read = 0;
@@ -1186,6 +2685,9 @@ int rack_vst3_plugin_set_state(RackVST3Plugin* plugin, const uint8_t* data, size
         return RACK_VST3_ERROR_GENERIC;
     }
 
+    // New state may make the plugin audible without input
+    plugin->silence_gate.wake();
+
     // Set controller state if separate controller
     if (plugin->controller && reinterpret_cast<void*>(plugin->controller.get()) != reinterpret_cast<void*>(plugin->component.get())) {
         // Stream is now positioned right after component state
@@ -1196,10 +2698,379 @@ int rack_vst3_plugin_set_state(RackVST3Plugin* plugin, const uint8_t* data, size
         }
     }
 
-    // IPtr automatically releases stream on scope exit
+    // The processor took its values from the new state, not from automation
+    if (plugin->initialized) {
+        refresh_processor_values(plugin);
+    }
+
+    return RACK_VST3_OK;
+}
+
+int rack_vst3_plugin_set_state(RackVST3Plugin* plugin, const uint8_t* data, size_t size) {
+    if (!plugin || !data || size == 0 || !plugin->component) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    if (plugin->state_loading.load()) {
+        return RACK_VST3_ERROR_BUSY;
+    }
+
+    // Load data into the reusable state stream
+    MemoryStream* stream = reusable_state_stream(plugin);
+    if (!stream) {
+        return RACK_VST3_ERROR_GENERIC;
+    }
+    stream->assign(data, size);
+
+    return apply_state(plugin, stream);
+}
+
+// ============================================================================
+// Asynchronous State Loading
+// ============================================================================
+
+// Wait for a process() call that is already running. The caller has set
+// state_loading, so no new block enters the plugin after this returns.
+static void wait_for_process_exit(RackVST3Plugin* plugin) {
+    while (plugin->in_process.load()) {
+        std::this_thread::yield();
+    }
+}
+
+// Run load() on the plugin's state worker thread while process() bypasses
+// the plugin, then report the result
+template <typename LoadFn>
+static int start_state_load(RackVST3Plugin* plugin, LoadFn load,
+                            RackVST3StateLoadCallback callback, void* user_data) {
+    if (plugin->state_loading.load()) {
+        return RACK_VST3_ERROR_BUSY;
+    }
+
+    // The previous load has finished; reap its thread
+    if (plugin->state_worker.joinable()) {
+        plugin->state_worker.join();
+    }
+
+    plugin->state_load_result.store(RACK_VST3_STATE_LOAD_PENDING);
+    plugin->state_loading.store(true);
+
+    try {
+        plugin->state_worker = std::thread([plugin, load = std::move(load), callback, user_data]() mutable {
+            wait_for_process_exit(plugin);
+            int result = load();
+
+            plugin->state_load_result.store(result);
+            plugin->state_loading.store(false);
+
+            if (callback) {
+                callback(user_data, result);
+            }
+        });
+    } catch (const std::system_error&) {
+        plugin->state_load_result.store(RACK_VST3_ERROR_GENERIC);
+        plugin->state_loading.store(false);
+        return RACK_VST3_ERROR_GENERIC;
+    }
+
     return RACK_VST3_OK;
 }
 
+int rack_vst3_plugin_set_state_async(
+    RackVST3Plugin* plugin,
+    const uint8_t* data,
+    size_t size,
+    RackVST3StateLoadCallback callback,
+    void* user_data)
+{
+    if (!plugin || !data || size == 0 || !plugin->component) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    // The worker gets its own copy, so the caller may free data right away
+    IPtr<MemoryStream> stream(new(std::nothrow) MemoryStream(), false);
+    if (!stream) {
+        return RACK_VST3_ERROR_GENERIC;
+    }
+    stream->assign(data, size);
+
+    return start_state_load(plugin,
+        [plugin, stream = std::move(stream)]() { return apply_state(plugin, stream); },
+        callback, user_data);
+}
+
+int rack_vst3_plugin_load_preset_async(
+    RackVST3Plugin* plugin,
+    int32_t preset_number,
+    RackVST3StateLoadCallback callback,
+    void* user_data)
+{
+    if (!plugin || !plugin->initialized || !plugin->controller) {
+        return RACK_VST3_ERROR_NOT_INITIALIZED;
+    }
+
+    if (preset_number < 0 || preset_number >= static_cast<int32_t>(plugin->presets.size())) {
+        return RACK_VST3_ERROR_NOT_FOUND;
+    }
+
+    // Program changes applied on the controller side are invisible to the
+    // processor, so everything the preset changed is forwarded to process()
+    return start_state_load(plugin, [plugin, preset_number]() {
+        const size_t count = plugin->parameters.size();
+        std::vector<ParamValue> before(count);
+        for (size_t i = 0; i < count; ++i) {
+            before[i] = plugin->controller->getParamNormalized(plugin->parameters[i].id);
+        }
+
+        int result = apply_preset(plugin, preset_number);
+        if (result == RACK_VST3_OK) {
+            for (size_t i = 0; i < count; ++i) {
+                ParamValue value = plugin->controller->getParamNormalized(plugin->parameters[i].id);
+                if (value != before[i]) {
+                    plugin->state_param_changes.push(plugin->parameters[i].id, value);
+                }
+            }
+        }
+        return result;
+    }, callback, user_data);
+}
+
+int rack_vst3_plugin_state_load_status(RackVST3Plugin* plugin) {
+    if (!plugin) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+    return plugin->state_load_result.load();
+}
+
+int rack_vst3_plugin_wait_state_load(RackVST3Plugin* plugin) {
+    if (!plugin) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    if (plugin->state_worker.joinable()) {
+        plugin->state_worker.join();
+    }
+    return plugin->state_load_result.load();
+}
+
+// ============================================================================
+// Instance Cloning and Pools
+// ============================================================================
+
+// What new instances are made from: the module and class to instantiate and
+// the settings carried over from the source instance
+struct InstanceTemplate {
+    std::shared_ptr<ModuleEntry> module_entry;
+    std::string path;
+    VST3::UID uid;
+    int32 process_mode = kRealtime;
+    bool prefer_double = false;
+    bool idle_sleep = false;
+    double sample_rate = 0.0;
+    uint32_t max_block_size = 0;  // 0 = leave new instances uninitialized
+};
+
+static InstanceTemplate capture_template(RackVST3Plugin* source) {
+    InstanceTemplate instance_template;
+    instance_template.module_entry = source->module_entry;
+    instance_template.path = source->path;
+    instance_template.uid = source->uid;
+    instance_template.process_mode = source->process_mode;
+    instance_template.prefer_double = source->prefer_double;
+    instance_template.idle_sleep = source->silence_gate.enabled();
+    if (source->initialized) {
+        instance_template.sample_rate = source->sample_rate;
+        instance_template.max_block_size = source->max_block_size;
+    }
+    return instance_template;
+}
+
+// Create an instance from the template's module, which is already loaded, and
+// restore state (serialize_state layout, NULL = default state). The state is
+// applied before initialize, so the processor is set up and activated once,
+// with the restored state.
+// Caller must not hold the module entry's lock.
+static RackVST3Plugin* instantiate(const InstanceTemplate& instance_template, MemoryStream* state) {
+    auto plugin = new(std::nothrow) RackVST3Plugin();
+    if (!plugin) {
+        return nullptr;
+    }
+
+    plugin->path = instance_template.path;
+    plugin->uid = instance_template.uid;
+    retain_module(instance_template.module_entry);
+    plugin->module_entry = instance_template.module_entry;
+    plugin->module = plugin->module_entry->module;
+
+    bool created;
+    {
+        std::lock_guard<std::mutex> lock(plugin->module_entry->lock);
+        created = create_components(plugin);
+    }
+    if (!created) {
+        discard_plugin(plugin);
+        return nullptr;
+    }
+
+    plugin->process_mode = instance_template.process_mode;
+    plugin->prefer_double = instance_template.prefer_double;
+    plugin->silence_gate.set_enabled(instance_template.idle_sleep);
+
+    if (state) {
+        state->seek(0, IBStream::kIBSeekSet, nullptr);
+        if (apply_state(plugin, state) != RACK_VST3_OK) {
+            rack_vst3_plugin_free(plugin);
+            return nullptr;
+        }
+    }
+
+    if (instance_template.max_block_size > 0 &&
+        rack_vst3_plugin_initialize(plugin, instance_template.sample_rate,
+                                    instance_template.max_block_size) != RACK_VST3_OK) {
+        rack_vst3_plugin_free(plugin);
+        return nullptr;
+    }
+
+    return plugin;
+}
+
+RackVST3Plugin* rack_vst3_plugin_clone(RackVST3Plugin* source) {
+    if (!source || !source->component || source->state_loading.load()) {
+        return nullptr;
+    }
+
+    // The clone reads the source's reusable state stream directly; the state
+    // is never copied out
+    if (serialize_state(source) != RACK_VST3_OK) {
+        return nullptr;
+    }
+    return instantiate(capture_template(source), source->state_stream);
+}
+
+// Ready instances of one plugin, refilled by a background thread
+struct RackVST3Pool {
+    InstanceTemplate instance_template;
+    IPtr<MemoryStream> state;  // Prototype state at pool creation, read by the refill thread only
+    uint32_t size = 0;
+
+    std::mutex lock;
+    std::condition_variable refill_cv;
+    std::vector<RackVST3Plugin*> spares;  // Capacity reserved for size entries
+    bool refill_failed = false;  // Last creation failed; retried on the next acquire
+    bool stopping = false;
+    std::thread refill_thread;
+};
+
+static void refill_pool(RackVST3Pool* pool) {
+    std::unique_lock<std::mutex> lock(pool->lock);
+    for (;;) {
+        pool->refill_cv.wait(lock, [pool]() {
+            return pool->stopping || (!pool->refill_failed && pool->spares.size() < pool->size);
+        });
+        if (pool->stopping) {
+            return;
+        }
+
+        // Instances are created without the pool lock, so acquire() never
+        // waits for a plugin to load
+        lock.unlock();
+        RackVST3Plugin* plugin = instantiate(pool->instance_template, pool->state);
+        lock.lock();
+
+        if (plugin) {
+            pool->spares.push_back(plugin);
+        } else {
+            pool->refill_failed = true;
+        }
+    }
+}
+
+RackVST3Pool* rack_vst3_pool_new(RackVST3Plugin* prototype, uint32_t size) {
+    if (!prototype || !prototype->component || size == 0 || prototype->state_loading.load()) {
+        return nullptr;
+    }
+
+    auto pool = new(std::nothrow) RackVST3Pool();
+    if (!pool) {
+        return nullptr;
+    }
+
+    if (serialize_state(prototype) != RACK_VST3_OK) {
+        delete pool;
+        return nullptr;
+    }
+    pool->state = IPtr<MemoryStream>(new(std::nothrow) MemoryStream(
+        prototype->state_stream->getData().data(), prototype->state_stream->getSize()), false);
+    if (!pool->state) {
+        delete pool;
+        return nullptr;
+    }
+
+    pool->instance_template = capture_template(prototype);
+    pool->size = size;
+    pool->spares.reserve(size);
+
+    // The pool keeps the module loaded after the prototype is freed
+    retain_module(pool->instance_template.module_entry);
+
+    try {
+        pool->refill_thread = std::thread(refill_pool, pool);
+    } catch (const std::system_error&) {
+        release_module(pool->instance_template.module_entry);
+        delete pool;
+        return nullptr;
+    }
+
+    return pool;
+}
+
+void rack_vst3_pool_free(RackVST3Pool* pool) {
+    if (!pool) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(pool->lock);
+        pool->stopping = true;
+    }
+    pool->refill_cv.notify_one();
+    pool->refill_thread.join();
+
+    for (RackVST3Plugin* plugin : pool->spares) {
+        rack_vst3_plugin_free(plugin);
+    }
+
+    std::shared_ptr<ModuleEntry> entry = pool->instance_template.module_entry;
+    delete pool;
+    release_module(entry);
+}
+
+RackVST3Plugin* rack_vst3_pool_acquire(RackVST3Pool* pool) {
+    if (!pool) {
+        return nullptr;
+    }
+
+    RackVST3Plugin* plugin = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(pool->lock);
+        if (!pool->spares.empty()) {
+            plugin = pool->spares.back();
+            pool->spares.pop_back();
+        }
+        pool->refill_failed = false;
+    }
+    pool->refill_cv.notify_one();
+    return plugin;
+}
+
+int rack_vst3_pool_available(RackVST3Pool* pool) {
+    if (!pool) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    std::lock_guard<std::mutex> lock(pool->lock);
+    return static_cast<int>(pool->spares.size());
+}
+
 // ============================================================================
 // MIDI API
 // ============================================================================
@@ -1223,7 +3094,13 @@ int rack_vst3_plugin_send_midi(
         return RACK_VST3_OK;
     }
 
-    // Convert MIDI events to VST3 events
+    // All-or-nothing: don't deliver half of a chord when the queue is full
+    if (plugin->midi_queue.write_available() < event_count) {
+        plugin->perf.add_dropped_midi(event_count);
+        return RACK_VST3_ERROR_GENERIC;
+    }
+
+    // Convert MIDI events to VST3 events and queue them for process()
     for (uint32_t i = 0; i < event_count; ++i) {
         const auto& midi_event = events[i];
 
@@ -1241,7 +3118,6 @@ int rack_vst3_plugin_send_midi(
                 vst3_event.noteOn.pitch = midi_event.data1;
                 vst3_event.noteOn.velocity = static_cast<float>(midi_event.data2) / 127.0f;
                 vst3_event.noteOn.noteId = -1;  // Not specified
-                plugin->input_events.addEvent(vst3_event);
                 break;
 
             case 0x80:  // Note Off
@@ -1250,7 +3126,6 @@ int rack_vst3_plugin_send_midi(
                 vst3_event.noteOff.pitch = midi_event.data1;
                 vst3_event.noteOff.velocity = static_cast<float>(midi_event.data2) / 127.0f;
                 vst3_event.noteOff.noteId = -1;  // Not specified
-                plugin->input_events.addEvent(vst3_event);
                 break;
 
             case 0xA0:  // Polyphonic Key Pressure (Aftertouch)
@@ -1258,7 +3133,6 @@ int rack_vst3_plugin_send_midi(
                 vst3_event.polyPressure.channel = midi_event.channel;
                 vst3_event.polyPressure.pitch = midi_event.data1;
                 vst3_event.polyPressure.pressure = static_cast<float>(midi_event.data2) / 127.0f;
-                plugin->input_events.addEvent(vst3_event);
                 break;
 
             case 0xB0:  // Control Change
@@ -1269,7 +3143,6 @@ int rack_vst3_plugin_send_midi(
                 vst3_event.midiCCOut.controlNumber = midi_event.data1;
                 vst3_event.midiCCOut.value = midi_event.data2;
                 vst3_event.midiCCOut.value2 = 0;
-                plugin->input_events.addEvent(vst3_event);
                 break;
 
             case 0xC0:  // Program Change
@@ -1281,7 +3154,6 @@ int rack_vst3_plugin_send_midi(
                 vst3_event.midiCCOut.controlNumber = 0x80;  // >= 0x80 indicates non-CC MIDI
                 vst3_event.midiCCOut.value = midi_event.data1;
                 vst3_event.midiCCOut.value2 = 0;
-                plugin->input_events.addEvent(vst3_event);
                 break;
 
             case 0xD0:  // Channel Pressure (Aftertouch)
@@ -1293,7 +3165,6 @@ int rack_vst3_plugin_send_midi(
                 vst3_event.midiCCOut.controlNumber = 0x81;  // >= 0x80 indicates non-CC MIDI
                 vst3_event.midiCCOut.value = midi_event.data1;
                 vst3_event.midiCCOut.value2 = 0;
-                plugin->input_events.addEvent(vst3_event);
                 break;
 
             case 0xE0: {  // Pitch Bend
@@ -1306,7 +3177,6 @@ int rack_vst3_plugin_send_midi(
                 vst3_event.midiCCOut.controlNumber = 0x82;  // >= 0x80 indicates non-CC MIDI
                 vst3_event.midiCCOut.value = midi_event.data1;   // LSB
                 vst3_event.midiCCOut.value2 = midi_event.data2;  // MSB
-                plugin->input_events.addEvent(vst3_event);
                 break;
             }
 
@@ -1314,6 +3184,8 @@ int rack_vst3_plugin_send_midi(
                 // Unknown MIDI event - skip it
                 continue;
         }
+
+        plugin->midi_queue.push(vst3_event);
     }
 
     return RACK_VST3_OK;
@@ -1346,19 +3218,50 @@ int rack_vst3_plugin_get_param_changes(
         return 0;  // No component handler = no changes to report
     }
 
+    // Keep the controller in step with automation before reporting GUI edits
+    flush_controller_updates(plugin);
+
     if (!changes || max_changes == 0) {
         // Just return the count of pending changes
         return static_cast<int>(plugin->component_handler->getPendingCount());
     }
 
+    // Drain the wakeup before popping so an edit arriving meanwhile re-arms it
+    rack::WakeupFd& wakeup = plugin->component_handler->wakeup();
+    wakeup.drain();
+
     // Retrieve pending changes
     uint32_t count = 0;
     ParamChangeEvent event;
     while (count < max_changes && plugin->component_handler->getNextChange(&event)) {
         changes[count].param_id = event.param_id;
+        changes[count].param_index = plugin->param_index_map.find(event.param_id);
         changes[count].value = event.value;
         count++;
     }
 
+    // Output array full: keep the fd readable for the rest
+    if (count == max_changes && plugin->component_handler->getPendingCount() > 0) {
+        wakeup.signal();
+    }
+
     return static_cast<int>(count);
 }
+
+int rack_vst3_plugin_get_param_change_fd(RackVST3Plugin* plugin) {
+    if (!plugin) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+    if (!plugin->component_handler) {
+        return RACK_VST3_ERROR_NOT_SUPPORTED;
+    }
+    int fd = plugin->component_handler->wakeup().fd();
+    return fd >= 0 ? fd : RACK_VST3_ERROR_NOT_SUPPORTED;
+}
+
+uint64_t rack_vst3_plugin_get_param_change_overflows(RackVST3Plugin* plugin) {
+    if (!plugin || !plugin->component_handler) {
+        return 0;
+    }
+    return plugin->component_handler->getOverflowCount();
+}
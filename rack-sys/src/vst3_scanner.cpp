@@ -8,6 +8,9 @@
 #include <string>
 #include <algorithm>
 #include <cstring>
+#include <cstdio>
+#include <map>
+#include <thread>
 
 #if defined(__APPLE__)
     #include <CoreFoundation/CoreFoundation.h>
@@ -23,13 +26,50 @@
     #include <sys/stat.h>
 #endif
 
+#if defined(__linux__)
+    #include <poll.h>
+    #include <signal.h>
+    #include <sys/wait.h>
+    #include <time.h>
+    #include <cerrno>
+#endif
+
 using namespace VST3;
 using namespace Steinberg;
 using namespace Steinberg::Vst;
 
+// Bundle fingerprint: a cached entry is reused while this is unchanged
+struct BundleStamp {
+    int64_t mtime = 0;
+    uint64_t size = 0;
+
+    bool operator==(const BundleStamp& other) const {
+        return mtime == other.mtime && size == other.size;
+    }
+};
+
+// Probe result for one bundle
+struct CacheEntry {
+    BundleStamp stamp;
+    bool failed = false;  // Could not be loaded (or crashed); skipped until it changes
+    std::vector<RackVST3PluginInfo> classes;
+};
+
 // Internal scanner state
 struct RackVST3Scanner {
     std::vector<std::string> search_paths;
+
+    // Scan cache keyed by bundle path. Always kept in memory; persisted to
+    // cache_path when one is set.
+    std::map<std::string, CacheEntry> cache;
+    std::string cache_path;
+    bool cache_file_loaded = false;
+
+    // Probe uncached bundles in forked worker processes (Linux only)
+    bool out_of_process = true;
+
+    // Results of the last scan (returned by rack_vst3_scanner_scan_results)
+    std::vector<RackVST3PluginInfo> results;
 };
 
 // Helper: Scan a directory for .vst3 bundles/folders
@@ -144,45 +184,494 @@ static RackVST3PluginType determine_plugin_type(const std::string& subcategories
     return RACK_VST3_TYPE_OTHER;
 }
 
+// Helper: Fill plugin info for one audio effect class
+static void fill_plugin_info(
+    RackVST3PluginInfo& info,
+    const Hosting::ClassInfo& class_info,
+    const Hosting::PluginFactory& factory,
+    const std::string& module_path)
+{
+    memset(&info, 0, sizeof(info));
+
+    // Name
+    std::string name = class_info.name();
+    strncpy(info.name, name.c_str(), sizeof(info.name) - 1);
+    info.name[sizeof(info.name) - 1] = '\0';
+
+    // Manufacturer
+    std::string vendor = class_info.vendor();
+    if (vendor.empty()) {
+        vendor = factory.info().vendor();
+    }
+    strncpy(info.manufacturer, vendor.c_str(), sizeof(info.manufacturer) - 1);
+    info.manufacturer[sizeof(info.manufacturer) - 1] = '\0';
+
+    // Path (full path to the .vst3 bundle/folder)
+    strncpy(info.path, module_path.c_str(), sizeof(info.path) - 1);
+    info.path[sizeof(info.path) - 1] = '\0';
+
+    // Unique ID (UID as hex string)
+    std::string uid_str = uid_to_string(class_info.ID());
+    strncpy(info.unique_id, uid_str.c_str(), sizeof(info.unique_id) - 1);
+    info.unique_id[sizeof(info.unique_id) - 1] = '\0';
+
+    // Version - parse version string (e.g., "1.0.0" or "1.2.3.4") to uint32_t
+    // Format: major.minor.patch.build -> pack into uint32_t
+    std::string version_str = class_info.version();
+    uint32_t version = 0;
+    if (!version_str.empty()) {
+        int major = 0, minor = 0, patch = 0, build = 0;
+        // Try to parse up to 4 components
+        int parsed = sscanf(version_str.c_str(), "%d.%d.%d.%d", &major, &minor, &patch, &build);
+        if (parsed >= 1) {
+            // Clamp each component to valid byte range [0, 255]
+            // This prevents integer overflow and handles negative/oversized values
+            auto clamp_byte = [](int val) -> uint8_t {
+                return static_cast<uint8_t>(std::max(0, std::min(255, val)));
+            };
+
+            uint8_t major_byte = clamp_byte(major);
+            uint8_t minor_byte = clamp_byte(minor);
+            uint8_t patch_byte = clamp_byte(patch);
+            uint8_t build_byte = clamp_byte(build);
+
+            // Pack into uint32_t: major(8) | minor(8) | patch(8) | build(8)
+            version = (static_cast<uint32_t>(major_byte) << 24) |
+                     (static_cast<uint32_t>(minor_byte) << 16) |
+                     (static_cast<uint32_t>(patch_byte) << 8) |
+                     static_cast<uint32_t>(build_byte);
+        }
+    }
+    info.version = version;
+
+    // Type (from subcategories)
+    std::string subcategories = class_info.subCategoriesString();
+    info.plugin_type = determine_plugin_type(subcategories);
+
+    // Category (subcategories string)
+    strncpy(info.category, subcategories.c_str(), sizeof(info.category) - 1);
+    info.category[sizeof(info.category) - 1] = '\0';
+}
+
+// Helper: Load a module and collect its audio effect classes
+// Returns false if the module could not be loaded
+static bool probe_module(const std::string& module_path, std::vector<RackVST3PluginInfo>& classes) {
+    std::string error_description;
+    auto module = Hosting::Module::create(module_path, error_description);
+
+    if (!module) {
+        return false;
+    }
+
+    const auto& factory = module->getFactory();
+    for (const auto& class_info : factory.classInfos()) {
+        // Only process audio effect classes
+        if (class_info.category() != kVstAudioEffectClass) {
+            continue;
+        }
+
+        RackVST3PluginInfo info;
+        fill_plugin_info(info, class_info, factory, module_path);
+        classes.push_back(info);
+    }
+
+    return true;
+}
+
 // ============================================================================
-// Scanner Implementation
+// Scan Cache
 // ============================================================================
 
-RackVST3Scanner* rack_vst3_scanner_new(void) {
-    return new(std::nothrow) RackVST3Scanner();
+// Cache file layout (host byte order and struct layout; the header records
+// sizeof(RackVST3PluginInfo) so a file from an incompatible build is ignored):
+//   CacheFileHeader
+//   entry_count x { CacheFileEntry, path bytes, class_count x RackVST3PluginInfo }
+static constexpr uint32_t CACHE_MAGIC = 0x43335652;  // 'RV3C'
+static constexpr uint32_t CACHE_VERSION = 1;
+
+struct CacheFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t info_size;
+    uint32_t entry_count;
+};
+
+struct CacheFileEntry {
+    int64_t mtime;
+    uint64_t size;
+    uint32_t path_length;
+    uint32_t class_count;
+    uint32_t failed;
+    uint32_t reserved;
+};
+
+#if !defined(_WIN32)
+// Helper: Fold the regular files directly inside dir into stamp
+static void stamp_directory_files(const std::string& dir_path, BundleStamp& stamp) {
+    DIR* dir = opendir(dir_path.c_str());
+    if (!dir) {
+        return;
+    }
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        std::string full_path = dir_path + "/" + entry->d_name;
+        struct stat st;
+        if (stat(full_path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            stamp.mtime = std::max<int64_t>(stamp.mtime, static_cast<int64_t>(st.st_mtime));
+            stamp.size += static_cast<uint64_t>(st.st_size);
+        }
+    }
+
+    closedir(dir);
 }
+#endif
 
-void rack_vst3_scanner_free(RackVST3Scanner* scanner) {
-    delete scanner;
+// Helper: Fingerprint a bundle without loading it
+// Bundles are folders, so the stamp covers the files in Contents/ and in each
+// of its immediate subfolders (Contents/MacOS, Contents/x86_64-linux, ...),
+// which is where the module binary lives.
+static bool stamp_bundle(const std::string& bundle_path, BundleStamp& stamp) {
+    stamp = BundleStamp();
+
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(bundle_path.c_str(), GetFileExInfoStandard, &data)) {
+        return false;
+    }
+
+    std::string file_path = bundle_path;
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+        // Bundle folder: use the binary inside
+        size_t slash = bundle_path.find_last_of("\\/");
+        std::string file_name = (slash == std::string::npos) ? bundle_path : bundle_path.substr(slash + 1);
+        file_path = bundle_path + "\\Contents\\x86_64-win\\" + file_name;
+        if (!GetFileAttributesExA(file_path.c_str(), GetFileExInfoStandard, &data)) {
+            return false;
+        }
+    }
+
+    stamp.mtime = (static_cast<int64_t>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+                  data.ftLastWriteTime.dwLowDateTime;
+    stamp.size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+    return true;
+#else
+    struct stat st;
+    if (stat(bundle_path.c_str(), &st) != 0) {
+        return false;
+    }
+
+    if (!S_ISDIR(st.st_mode)) {
+        stamp.mtime = static_cast<int64_t>(st.st_mtime);
+        stamp.size = static_cast<uint64_t>(st.st_size);
+        return true;
+    }
+
+    stamp.mtime = static_cast<int64_t>(st.st_mtime);
+    std::string contents = bundle_path + "/Contents";
+    stamp_directory_files(contents, stamp);
+
+    DIR* dir = opendir(contents.c_str());
+    if (dir) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != nullptr) {
+            std::string name = entry->d_name;
+            if (name == "." || name == ".." || name == "Resources") {
+                continue;
+            }
+            std::string sub_path = contents + "/" + name;
+            struct stat sub_st;
+            if (stat(sub_path.c_str(), &sub_st) == 0 && S_ISDIR(sub_st.st_mode)) {
+                stamp_directory_files(sub_path, stamp);
+            }
+        }
+        closedir(dir);
+    }
+    return true;
+#endif
 }
 
-int rack_vst3_scanner_add_path(RackVST3Scanner* scanner, const char* path) {
-    if (!scanner || !path) {
-        return RACK_VST3_ERROR_INVALID_PARAM;
+// Helper: Merge entries from the cache file into the in-memory cache
+// A missing, truncated or incompatible file is ignored (everything is rescanned)
+static void load_cache_file(RackVST3Scanner* scanner) {
+    FILE* file = fopen(scanner->cache_path.c_str(), "rb");
+    if (!file) {
+        return;
     }
 
-    scanner->search_paths.push_back(path);
-    return RACK_VST3_OK;
+    CacheFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        header.magic != CACHE_MAGIC ||
+        header.version != CACHE_VERSION ||
+        header.info_size != sizeof(RackVST3PluginInfo)) {
+        fclose(file);
+        return;
+    }
+
+    std::map<std::string, CacheEntry> loaded;
+    for (uint32_t i = 0; i < header.entry_count; ++i) {
+        CacheFileEntry file_entry;
+        if (fread(&file_entry, sizeof(file_entry), 1, file) != 1 ||
+            file_entry.path_length == 0 || file_entry.path_length > 4096) {
+            fclose(file);
+            return;
+        }
+
+        std::string path(file_entry.path_length, '\0');
+        CacheEntry entry;
+        entry.stamp.mtime = file_entry.mtime;
+        entry.stamp.size = file_entry.size;
+        entry.failed = file_entry.failed != 0;
+        entry.classes.resize(file_entry.class_count);
+
+        if (fread(&path[0], 1, path.size(), file) != path.size() ||
+            (file_entry.class_count > 0 &&
+             fread(entry.classes.data(), sizeof(RackVST3PluginInfo), entry.classes.size(), file) !=
+                 entry.classes.size())) {
+            fclose(file);
+            return;
+        }
+
+        loaded[path] = std::move(entry);
+    }
+    fclose(file);
+
+    // Entries probed in this process take precedence over the file
+    for (auto& item : loaded) {
+        scanner->cache.insert(std::move(item));
+    }
 }
 
-int rack_vst3_scanner_add_default_paths(RackVST3Scanner* scanner) {
-    if (!scanner) {
-        return RACK_VST3_ERROR_INVALID_PARAM;
+// Helper: Write the in-memory cache to cache_path (via a temp file + rename,
+// so a concurrent reader never sees a partial file)
+static void save_cache_file(const RackVST3Scanner* scanner) {
+    std::string temp_path = scanner->cache_path + ".tmp";
+    FILE* file = fopen(temp_path.c_str(), "wb");
+    if (!file) {
+        return;
     }
 
-    auto paths = get_default_vst3_paths();
-    scanner->search_paths.insert(scanner->search_paths.end(), paths.begin(), paths.end());
-    return RACK_VST3_OK;
+    CacheFileHeader header;
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.info_size = sizeof(RackVST3PluginInfo);
+    header.entry_count = static_cast<uint32_t>(scanner->cache.size());
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (const auto& item : scanner->cache) {
+        if (!ok) {
+            break;
+        }
+        const CacheEntry& entry = item.second;
+
+        CacheFileEntry file_entry;
+        memset(&file_entry, 0, sizeof(file_entry));
+        file_entry.mtime = entry.stamp.mtime;
+        file_entry.size = entry.stamp.size;
+        file_entry.path_length = static_cast<uint32_t>(item.first.size());
+        file_entry.class_count = static_cast<uint32_t>(entry.classes.size());
+        file_entry.failed = entry.failed ? 1 : 0;
+
+        ok = fwrite(&file_entry, sizeof(file_entry), 1, file) == 1 &&
+             fwrite(item.first.data(), 1, item.first.size(), file) == item.first.size() &&
+             (entry.classes.empty() ||
+              fwrite(entry.classes.data(), sizeof(RackVST3PluginInfo), entry.classes.size(), file) ==
+                  entry.classes.size());
+    }
+
+    if (fclose(file) != 0) {
+        ok = false;
+    }
+
+    if (!ok) {
+        remove(temp_path.c_str());
+        return;
+    }
+
+#if defined(_WIN32)
+    MoveFileExA(temp_path.c_str(), scanner->cache_path.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+    rename(temp_path.c_str(), scanner->cache_path.c_str());
+#endif
 }
 
-int rack_vst3_scanner_scan(RackVST3Scanner* scanner, RackVST3PluginInfo* plugins, size_t max_plugins) {
-    if (!scanner) {
-        return RACK_VST3_ERROR_INVALID_PARAM;
+// ============================================================================
+// Isolated Probing (Linux)
+// ============================================================================
+
+#if defined(__linux__)
+// Seconds a worker may take before it is killed and its bundle marked failed
+static constexpr int PROBE_TIMEOUT_SECONDS = 30;
+
+// Maximum concurrent worker processes
+static constexpr unsigned MAX_PROBE_JOBS = 16;
+
+// Helper: Write all bytes to a pipe (child side)
+static bool write_all(int fd, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+// Helper: Body of a forked worker. Never returns.
+// Writes the class count followed by the class infos to fd, then exits
+// without running destructors or atexit handlers of the parent's state.
+[[noreturn]] static void run_probe_worker(const std::string& module_path, int fd) {
+    std::vector<RackVST3PluginInfo> classes;
+    if (!probe_module(module_path, classes)) {
+        _exit(2);
+    }
+
+    uint32_t count = static_cast<uint32_t>(classes.size());
+    bool ok = write_all(fd, &count, sizeof(count)) &&
+              (classes.empty() || write_all(fd, classes.data(), classes.size() * sizeof(RackVST3PluginInfo)));
+    _exit(ok ? 0 : 3);
+}
+
+// Helper: Parse a worker's output into entry
+static bool parse_probe_output(const std::vector<char>& output, CacheEntry& entry) {
+    if (output.size() < sizeof(uint32_t)) {
+        return false;
+    }
+
+    uint32_t count = 0;
+    memcpy(&count, output.data(), sizeof(count));
+    if (output.size() != sizeof(count) + static_cast<size_t>(count) * sizeof(RackVST3PluginInfo)) {
+        return false;
+    }
+
+    entry.classes.resize(count);
+    if (count > 0) {
+        memcpy(entry.classes.data(), output.data() + sizeof(count), count * sizeof(RackVST3PluginInfo));
+    }
+    return true;
+}
+
+// Helper: Probe bundles in parallel forked workers
+// A worker that crashes, hangs or fails to load its module only marks that
+// bundle as failed. Falls back to in-process probing if fork() fails.
+static void probe_modules_isolated(
+    const std::vector<std::string>& paths,
+    const std::vector<CacheEntry*>& entries)
+{
+    struct Job {
+        size_t index;
+        pid_t pid;
+        int fd;
+        time_t started;
+        std::vector<char> output;
+    };
+
+    unsigned max_jobs = std::max(1u, std::min(MAX_PROBE_JOBS, std::thread::hardware_concurrency()));
+    std::vector<Job> running;
+    size_t next = 0;
+
+    while (next < paths.size() || !running.empty()) {
+        // Launch workers up to the concurrency limit
+        while (next < paths.size() && running.size() < max_jobs) {
+            size_t index = next++;
+            int fds[2];
+            if (pipe(fds) != 0) {
+                entries[index]->failed = !probe_module(paths[index], entries[index]->classes);
+                continue;
+            }
+
+            pid_t pid = fork();
+            if (pid == 0) {
+                close(fds[0]);
+                run_probe_worker(paths[index], fds[1]);
+            }
+
+            close(fds[1]);
+            if (pid < 0) {
+                close(fds[0]);
+                entries[index]->failed = !probe_module(paths[index], entries[index]->classes);
+                continue;
+            }
+
+            running.push_back(Job{index, pid, fds[0], time(nullptr), {}});
+        }
+
+        if (running.empty()) {
+            continue;
+        }
+
+        // Collect output from whichever workers are ready
+        std::vector<struct pollfd> pfds(running.size());
+        for (size_t i = 0; i < running.size(); ++i) {
+            pfds[i].fd = running[i].fd;
+            pfds[i].events = POLLIN;
+            pfds[i].revents = 0;
+        }
+
+        int ready = poll(pfds.data(), static_cast<nfds_t>(pfds.size()), 1000);
+        if (ready < 0 && errno != EINTR) {
+            break;
+        }
+
+        time_t now = time(nullptr);
+        for (size_t i = running.size(); i-- > 0;) {
+            Job& job = running[i];
+            bool finished = false;
+
+            if (pfds[i].revents & (POLLIN | POLLHUP | POLLERR)) {
+                char buffer[16384];
+                ssize_t n = read(job.fd, buffer, sizeof(buffer));
+                if (n > 0) {
+                    job.output.insert(job.output.end(), buffer, buffer + n);
+                } else if (n == 0 || errno != EINTR) {
+                    finished = true;
+                }
+            }
+
+            bool timed_out = !finished && (now - job.started) > PROBE_TIMEOUT_SECONDS;
+            if (timed_out) {
+                kill(job.pid, SIGKILL);
+            }
+
+            if (!finished && !timed_out) {
+                continue;
+            }
+
+            int status = 0;
+            while (waitpid(job.pid, &status, 0) < 0 && errno == EINTR) {
+            }
+            close(job.fd);
+
+            CacheEntry* entry = entries[job.index];
+            bool ok = !timed_out && WIFEXITED(status) && WEXITSTATUS(status) == 0 &&
+                      parse_probe_output(job.output, *entry);
+            entry->failed = !ok;
+            if (!ok) {
+                entry->classes.clear();
+            }
+
+            running.erase(running.begin() + static_cast<std::ptrdiff_t>(i));
+        }
     }
 
-    bool count_only = (plugins == nullptr);
-    size_t count = 0;
+    // Only reached early if poll() failed: reap anything still running
+    for (Job& job : running) {
+        kill(job.pid, SIGKILL);
+        waitpid(job.pid, nullptr, 0);
+        close(job.fd);
+        entries[job.index]->failed = true;
+    }
+}
+#endif
 
+// Helper: Run a full scan, filling scanner->results
+// Unchanged bundles come from the cache; the rest are probed (in parallel
+// worker processes where supported) and the cache is updated.
+static void run_scan(RackVST3Scanner* scanner) {
     // Determine which paths to scan
     std::vector<std::string> paths_to_scan = scanner->search_paths;
     if (paths_to_scan.empty()) {
@@ -207,103 +696,129 @@ int rack_vst3_scanner_scan(RackVST3Scanner* scanner, RackVST3PluginInfo* plugins
     std::sort(module_paths.begin(), module_paths.end());
     module_paths.erase(std::unique(module_paths.begin(), module_paths.end()), module_paths.end());
 
-    // Scan all found modules
+    if (!scanner->cache_path.empty() && !scanner->cache_file_loaded) {
+        load_cache_file(scanner);
+        scanner->cache_file_loaded = true;
+    }
+
+    // Find bundles that are new or changed since they were cached
+    std::vector<std::string> stale_paths;
+    std::vector<CacheEntry*> stale_entries;
     for (const auto& module_path : module_paths) {
-        std::string error_description;
-        auto module = Hosting::Module::create(module_path, error_description);
+        BundleStamp stamp;
+        bool have_stamp = stamp_bundle(module_path, stamp);
 
-        if (!module) {
-            // Failed to load module, skip it
+        auto it = scanner->cache.find(module_path);
+        if (have_stamp && it != scanner->cache.end() && it->second.stamp == stamp) {
             continue;
         }
 
-        const auto& factory = module->getFactory();
-        auto class_infos = factory.classInfos();
+        CacheEntry& entry = scanner->cache[module_path];
+        entry = CacheEntry();
+        entry.stamp = stamp;
+        stale_paths.push_back(module_path);
+        stale_entries.push_back(&entry);
+    }
 
-        // Enumerate all classes in this module
-        for (const auto& class_info : class_infos) {
-            // Only process audio effect classes
-            if (class_info.category() != kVstAudioEffectClass) {
-                continue;
+    if (!stale_paths.empty()) {
+#if defined(__linux__)
+        if (scanner->out_of_process) {
+            probe_modules_isolated(stale_paths, stale_entries);
+        } else
+#endif
+        {
+            for (size_t i = 0; i < stale_paths.size(); ++i) {
+                stale_entries[i]->failed = !probe_module(stale_paths[i], stale_entries[i]->classes);
             }
+        }
 
-            // If we're just counting, increment and continue
-            if (count_only) {
-                count++;
-                continue;
-            }
+        if (!scanner->cache_path.empty()) {
+            save_cache_file(scanner);
+        }
+    }
 
-            // If array is full, continue counting but don't fill
-            if (count >= max_plugins) {
-                count++;
-                continue;
-            }
+    // Assemble results in bundle path order
+    scanner->results.clear();
+    for (const auto& module_path : module_paths) {
+        const CacheEntry& entry = scanner->cache[module_path];
+        scanner->results.insert(scanner->results.end(), entry.classes.begin(), entry.classes.end());
+    }
+}
 
-            // Fill in plugin info
-            RackVST3PluginInfo& info = plugins[count];
+// ============================================================================
+// Scanner Implementation
+// ============================================================================
 
-            // Name
-            std::string name = class_info.name();
-            strncpy(info.name, name.c_str(), sizeof(info.name) - 1);
-            info.name[sizeof(info.name) - 1] = '\0';
+RackVST3Scanner* rack_vst3_scanner_new(void) {
+    return new(std::nothrow) RackVST3Scanner();
+}
 
-            // Manufacturer
-            std::string vendor = class_info.vendor();
-            if (vendor.empty()) {
-                vendor = factory.info().vendor();
-            }
-            strncpy(info.manufacturer, vendor.c_str(), sizeof(info.manufacturer) - 1);
-            info.manufacturer[sizeof(info.manufacturer) - 1] = '\0';
-
-            // Path (full path to the .vst3 bundle/folder)
-            strncpy(info.path, module_path.c_str(), sizeof(info.path) - 1);
-            info.path[sizeof(info.path) - 1] = '\0';
-
-            // Unique ID (UID as hex string)
-            std::string uid_str = uid_to_string(class_info.ID());
-            strncpy(info.unique_id, uid_str.c_str(), sizeof(info.unique_id) - 1);
-            info.unique_id[sizeof(info.unique_id) - 1] = '\0';
-
-            // Version - parse version string (e.g., "1.0.0" or "1.2.3.4") to uint32_t
-            // Format: major.minor.patch.build -> pack into uint32_t
-            std::string version_str = class_info.version();
-            uint32_t version = 0;
-            if (!version_str.empty()) {
-                int major = 0, minor = 0, patch = 0, build = 0;
-                // Try to parse up to 4 components
-                int parsed = sscanf(version_str.c_str(), "%d.%d.%d.%d", &major, &minor, &patch, &build);
-                if (parsed >= 1) {
-                    // Clamp each component to valid byte range [0, 255]
-                    // This prevents integer overflow and handles negative/oversized values
-                    auto clamp_byte = [](int val) -> uint8_t {
-                        return static_cast<uint8_t>(std::max(0, std::min(255, val)));
-                    };
-
-                    uint8_t major_byte = clamp_byte(major);
-                    uint8_t minor_byte = clamp_byte(minor);
-                    uint8_t patch_byte = clamp_byte(patch);
-                    uint8_t build_byte = clamp_byte(build);
-
-                    // Pack into uint32_t: major(8) | minor(8) | patch(8) | build(8)
-                    version = (static_cast<uint32_t>(major_byte) << 24) |
-                             (static_cast<uint32_t>(minor_byte) << 16) |
-                             (static_cast<uint32_t>(patch_byte) << 8) |
-                             static_cast<uint32_t>(build_byte);
-                }
-            }
-            info.version = version;
+void rack_vst3_scanner_free(RackVST3Scanner* scanner) {
+    delete scanner;
+}
 
-            // Type (from subcategories)
-            std::string subcategories = class_info.subCategoriesString();
-            info.plugin_type = determine_plugin_type(subcategories);
+int rack_vst3_scanner_add_path(RackVST3Scanner* scanner, const char* path) {
+    if (!scanner || !path) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
 
-            // Category (subcategories string)
-            strncpy(info.category, subcategories.c_str(), sizeof(info.category) - 1);
-            info.category[sizeof(info.category) - 1] = '\0';
+    scanner->search_paths.push_back(path);
+    return RACK_VST3_OK;
+}
 
-            count++;
-        }
+int rack_vst3_scanner_add_default_paths(RackVST3Scanner* scanner) {
+    if (!scanner) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
     }
 
-    return static_cast<int>(count);
+    auto paths = get_default_vst3_paths();
+    scanner->search_paths.insert(scanner->search_paths.end(), paths.begin(), paths.end());
+    return RACK_VST3_OK;
+}
+
+int rack_vst3_scanner_set_cache_path(RackVST3Scanner* scanner, const char* path) {
+    if (!scanner) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    scanner->cache_path = path ? path : "";
+    scanner->cache_file_loaded = false;
+    return RACK_VST3_OK;
+}
+
+int rack_vst3_scanner_set_out_of_process(RackVST3Scanner* scanner, int enabled) {
+    if (!scanner) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    scanner->out_of_process = enabled != 0;
+    return RACK_VST3_OK;
+}
+
+int rack_vst3_scanner_scan(RackVST3Scanner* scanner, RackVST3PluginInfo* plugins, size_t max_plugins) {
+    if (!scanner) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    // The in-memory cache makes the second call of the two-pass pattern
+    // cheap: no bundle is loaded again unless it changed in between
+    run_scan(scanner);
+
+    if (plugins) {
+        size_t n = std::min(max_plugins, scanner->results.size());
+        std::copy(scanner->results.begin(), scanner->results.begin() + n, plugins);
+    }
+
+    return static_cast<int>(scanner->results.size());
+}
+
+int rack_vst3_scanner_scan_results(RackVST3Scanner* scanner, const RackVST3PluginInfo** plugins) {
+    if (!scanner || !plugins) {
+        return RACK_VST3_ERROR_INVALID_PARAM;
+    }
+
+    run_scan(scanner);
+
+    *plugins = scanner->results.empty() ? nullptr : scanner->results.data();
+    return static_cast<int>(scanner->results.size());
 }
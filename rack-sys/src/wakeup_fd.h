@@ -0,0 +1,101 @@
+#ifndef RACK_WAKEUP_FD_H
+#define RACK_WAKEUP_FD_H
+
+// Internal header (C++17, no plugin SDK dependency).
+//
+// WakeupFd is a file descriptor that becomes readable while something is
+// pending, so a host can wait for it in its own poll/epoll/kqueue loop
+// instead of polling. An eventfd on Linux, a non-blocking pipe on other
+// POSIX systems; not available on Windows (fd() returns -1 and signal()
+// does nothing).
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#elif !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace rack {
+
+// signal() is lock-free and may be called from any thread; it only touches
+// the descriptor on the first signal after a drain(). drain() belongs to the
+// consumer.
+class WakeupFd {
+public:
+    WakeupFd() {
+#if defined(__linux__)
+        read_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        write_fd_ = read_fd_;
+#elif !defined(_WIN32)
+        int fds[2];
+        if (pipe(fds) == 0) {
+            for (int fd : fds) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+            read_fd_ = fds[0];
+            write_fd_ = fds[1];
+        }
+#endif
+    }
+
+    ~WakeupFd() {
+#if !defined(_WIN32)
+        if (read_fd_ >= 0) close(read_fd_);
+        if (write_fd_ >= 0 && write_fd_ != read_fd_) close(write_fd_);
+#endif
+    }
+
+    WakeupFd(const WakeupFd&) = delete;
+    WakeupFd& operator=(const WakeupFd&) = delete;
+
+    // Descriptor to wait on (readable while signaled), -1 if unavailable
+    int fd() const { return read_fd_; }
+
+    // Make the descriptor readable
+    void signal() {
+        if (write_fd_ < 0 || signaled_.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+#if defined(__linux__)
+        uint64_t one = 1;
+        ssize_t written = write(write_fd_, &one, sizeof(one));
+        (void)written;
+#elif !defined(_WIN32)
+        char byte = 0;
+        ssize_t written = write(write_fd_, &byte, 1);
+        (void)written;
+#endif
+    }
+
+    // Make the descriptor unreadable again. Call before consuming what was
+    // pending, so a signal() racing with the consumer is never lost.
+    void drain() {
+        if (read_fd_ < 0 || !signaled_.exchange(false, std::memory_order_acq_rel)) {
+            return;
+        }
+#if defined(__linux__)
+        uint64_t count = 0;
+        ssize_t got = read(read_fd_, &count, sizeof(count));
+        (void)got;
+#elif !defined(_WIN32)
+        char buffer[16];
+        while (read(read_fd_, buffer, sizeof(buffer)) > 0) {
+        }
+#endif
+    }
+
+private:
+    int read_fd_ = -1;
+    int write_fd_ = -1;
+    std::atomic<bool> signaled_{false};
+};
+
+} // namespace rack
+
+#endif // RACK_WAKEUP_FD_H
@@ -0,0 +1,102 @@
+#ifndef RACK_WORK_STEALING_DEQUE_H
+#define RACK_WORK_STEALING_DEQUE_H
+
+// Internal header used by the graph scheduler (C++17, no plugin SDK
+// dependency).
+//
+// WorkStealingDeque is a bounded Chase-Lev deque: the owning thread pushes
+// and pops at the bottom, any other thread steals from the top. All three
+// operations are lock-free and never allocate. Capacity is fixed at
+// construction, which suits a scheduler that queues each task at most once
+// per round.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace rack {
+
+template <typename T>
+class WorkStealingDeque {
+public:
+    // capacity is rounded up to a power of two
+    explicit WorkStealingDeque(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mask_ = size - 1;
+        items_.reset(new std::atomic<T>[size]);
+    }
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner: returns false if the deque is full
+    bool push(T item) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        if (bottom - top > static_cast<int64_t>(mask_)) {
+            return false;
+        }
+        items_[bottom & mask_].store(item, std::memory_order_relaxed);
+        bottom_.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Owner: take the most recently pushed item. Returns false if empty.
+    bool pop(T* out) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        *out = items_[bottom & mask_].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last item: race thieves for it
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread: take the oldest item. Returns false if empty or if another
+    // thread got it first.
+    bool steal(T* out) {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return false;
+        }
+
+        T item = items_[top & mask_].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return false;
+        }
+        *out = item;
+        return true;
+    }
+
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top_{0};     // Advanced by thieves and the owner's last pop
+    alignas(64) std::atomic<int64_t> bottom_{0};  // Written by the owner only
+    size_t mask_ = 0;
+    std::unique_ptr<std::atomic<T>[]> items_;
+};
+
+} // namespace rack
+
+#endif // RACK_WORK_STEALING_DEQUE_H
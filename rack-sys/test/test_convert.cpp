@@ -0,0 +1,424 @@
+#include "../src/sample_convert.h"
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+using rack::convert_detail::ConvertKernels;
+
+static int failures = 0;
+
+static void check(bool condition, const std::string& what) {
+    if (condition) {
+        std::cout << "PASS: " << what << "\n";
+    } else {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+// Every SIMD level this binary and CPU can run, plus the runtime choice
+static std::vector<ConvertKernels> simd_levels() {
+    std::vector<ConvertKernels> levels;
+#if defined(RACK_CONVERT_SSE2)
+    levels.push_back(rack::convert_detail::sse2_kernels());
+#endif
+#if defined(RACK_CONVERT_AVX2)
+    if (rack::convert_detail::cpu_has_avx2()) {
+        levels.push_back(rack::convert_detail::avx2_kernels());
+    }
+#endif
+#if defined(RACK_CONVERT_NEON)
+    levels.push_back(rack::convert_detail::neon_kernels());
+#endif
+    ConvertKernels dispatched = rack::convert_kernels();
+    dispatched.isa = "dispatch";
+    levels.push_back(dispatched);
+    return levels;
+}
+
+// Lengths around every vector width and unroll, plus long odd ones
+static std::vector<size_t> test_lengths() {
+    std::vector<size_t> lengths;
+    for (size_t n = 0; n <= 40; n++) {
+        lengths.push_back(n);
+    }
+    lengths.push_back(63);
+    lengths.push_back(64);
+    lengths.push_back(65);
+    lengths.push_back(1001);
+    return lengths;
+}
+
+// Element offsets from a 64-byte aligned base: aligned and unaligned starts
+static const size_t OFFSETS[] = {0, 1, 3};
+
+template <typename T>
+static bool same_bits(const T* a, const T* b, size_t count) {
+    return memcmp(a, b, count * sizeof(T)) == 0;
+}
+
+// Buffer with room for the largest test length behind any offset, filled
+// with a sentinel so writes past count show up
+template <typename T>
+struct TestBuffer {
+    alignas(64) T data[1001 + 16];
+
+    explicit TestBuffer(T fill) {
+        for (T& v : data) v = fill;
+    }
+    T* at(size_t offset) { return data + offset; }
+};
+
+static uint32_t next_random(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return seed;
+}
+
+// Samples that exercise clipping and rounding: normal range, exact rounding
+// ties, out of range, infinities, NaN, denormals and signed zeros
+static void fill_float_input(float* dst, size_t count, uint32_t seed, float int_scale) {
+    static const float specials[] = {
+        0.0f, -0.0f, 1.0f, -1.0f, 0.999999f, -0.999999f, 1.5f, -1.5f, 100.0f, -100.0f,
+        std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+        std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::denorm_min(),
+        -std::numeric_limits<float>::denorm_min(), 1e-30f,
+    };
+    const size_t special_count = sizeof(specials) / sizeof(specials[0]);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t r = next_random(seed);
+        switch (r % 4) {
+            case 0:
+                dst[i] = specials[(r >> 8) % special_count];
+                break;
+            case 1:
+                // Half-LSB ties round to even
+                dst[i] = ((float)((int32_t)(r >> 12) - (1 << 19)) + 0.5f) / int_scale;
+                break;
+            default:
+                dst[i] = ((float)(r >> 8) / 16777216.0f) * 2.4f - 1.2f;
+                break;
+        }
+    }
+}
+
+void test_interleave() {
+    std::cout << "Test 1: Interleave and deinterleave\n";
+    std::cout << "-----------------------------------\n";
+
+    const ConvertKernels scalar = rack::convert_detail::scalar_kernels();
+    const uint32_t channel_counts[] = {1, 2, 3, 6};
+    for (const ConvertKernels& level : simd_levels()) {
+        bool deinterleave_ok = true;
+        bool interleave_ok = true;
+        for (uint32_t channels : channel_counts) {
+            for (size_t frames : {size_t(0), size_t(1), size_t(3), size_t(4), size_t(7), size_t(8),
+                                  size_t(9), size_t(15), size_t(16), size_t(17), size_t(63), size_t(163)}) {
+                for (size_t offset : OFFSETS) {
+                    std::vector<float> interleaved(frames * channels + offset + 1);
+                    uint32_t seed = channels * 1000 + (uint32_t)frames;
+                    for (float& v : interleaved) {
+                        v = (float)(int32_t)next_random(seed) / 65536.0f;
+                    }
+                    const float* src = interleaved.data() + offset;
+
+                    std::vector<std::vector<float>> expect(channels, std::vector<float>(frames + 2, -7.0f));
+                    std::vector<std::vector<float>> actual(channels, std::vector<float>(frames + 2, -7.0f));
+                    std::vector<float*> expect_ptrs(channels);
+                    std::vector<float*> actual_ptrs(channels);
+                    for (uint32_t ch = 0; ch < channels; ch++) {
+                        expect_ptrs[ch] = expect[ch].data() + 1;
+                        actual_ptrs[ch] = actual[ch].data() + 1;
+                    }
+                    scalar.deinterleave(src, expect_ptrs.data(), channels, frames);
+                    level.deinterleave(src, actual_ptrs.data(), channels, frames);
+                    for (uint32_t ch = 0; ch < channels; ch++) {
+                        deinterleave_ok = deinterleave_ok && same_bits(expect[ch].data(), actual[ch].data(), frames + 2);
+                    }
+
+                    std::vector<const float*> planar(channels);
+                    for (uint32_t ch = 0; ch < channels; ch++) {
+                        planar[ch] = expect_ptrs[ch];
+                    }
+                    std::vector<float> expect_out(frames * channels + offset + 1, -7.0f);
+                    std::vector<float> actual_out(frames * channels + offset + 1, -7.0f);
+                    scalar.interleave(planar.data(), expect_out.data() + offset, channels, frames);
+                    level.interleave(planar.data(), actual_out.data() + offset, channels, frames);
+                    interleave_ok = interleave_ok && same_bits(expect_out.data(), actual_out.data(), expect_out.size());
+                    interleave_ok = interleave_ok && same_bits(actual_out.data() + offset, src, frames * channels);
+                }
+            }
+        }
+        check(deinterleave_ok, std::string(level.isa) + " deinterleave matches scalar");
+        check(interleave_ok, std::string(level.isa) + " interleave matches scalar and round-trips");
+    }
+    std::cout << "\n";
+}
+
+void test_int_to_float() {
+    std::cout << "Test 2: s16/s32 -> f32\n";
+    std::cout << "----------------------\n";
+
+    const ConvertKernels scalar = rack::convert_detail::scalar_kernels();
+    for (const ConvertKernels& level : simd_levels()) {
+        bool s16_ok = true;
+        bool s32_ok = true;
+        for (size_t count : test_lengths()) {
+            for (size_t offset : OFFSETS) {
+                TestBuffer<int16_t> s16(0);
+                TestBuffer<int32_t> s32(0);
+                uint32_t seed = (uint32_t)(count * 7 + offset);
+                for (size_t i = 0; i < count; i++) {
+                    uint32_t r = next_random(seed);
+                    // Include both extremes
+                    s16.at(offset)[i] = i % 5 == 0 ? INT16_MIN : i % 5 == 1 ? INT16_MAX : (int16_t)(r >> 16);
+                    s32.at(offset)[i] = i % 5 == 0 ? INT32_MIN : i % 5 == 1 ? INT32_MAX : (int32_t)r;
+                }
+
+                TestBuffer<float> expect(-7.0f);
+                TestBuffer<float> actual(-7.0f);
+                scalar.s16_to_f32(s16.at(offset), expect.at(offset), count);
+                level.s16_to_f32(s16.at(offset), actual.at(offset), count);
+                s16_ok = s16_ok && same_bits(expect.data, actual.data, count + offset + 8);
+
+                TestBuffer<float> expect32(-7.0f);
+                TestBuffer<float> actual32(-7.0f);
+                scalar.s32_to_f32(s32.at(offset), expect32.at(offset), count);
+                level.s32_to_f32(s32.at(offset), actual32.at(offset), count);
+                s32_ok = s32_ok && same_bits(expect32.data, actual32.data, count + offset + 8);
+            }
+        }
+        check(s16_ok, std::string(level.isa) + " s16 -> f32 matches scalar");
+        check(s32_ok, std::string(level.isa) + " s32 -> f32 matches scalar");
+    }
+    std::cout << "\n";
+}
+
+void test_float_to_int() {
+    std::cout << "Test 3: f32 -> s16/s32 with clipping\n";
+    std::cout << "------------------------------------\n";
+
+    const ConvertKernels scalar = rack::convert_detail::scalar_kernels();
+    for (const ConvertKernels& level : simd_levels()) {
+        bool s16_ok = true;
+        bool s32_ok = true;
+        for (size_t count : test_lengths()) {
+            for (size_t offset : OFFSETS) {
+                TestBuffer<float> input(0.0f);
+                fill_float_input(input.at(offset), count, (uint32_t)(count * 31 + offset), 32768.0f);
+
+                TestBuffer<int16_t> expect(0x5A5A);
+                TestBuffer<int16_t> actual(0x5A5A);
+                scalar.f32_to_s16(input.at(offset), expect.at(offset), count, nullptr);
+                level.f32_to_s16(input.at(offset), actual.at(offset), count, nullptr);
+                s16_ok = s16_ok && same_bits(expect.data, actual.data, count + offset + 8);
+
+                fill_float_input(input.at(offset), count, (uint32_t)(count * 37 + offset), 2147483648.0f);
+                TestBuffer<int32_t> expect32(0x5A5A5A5A);
+                TestBuffer<int32_t> actual32(0x5A5A5A5A);
+                scalar.f32_to_s32(input.at(offset), expect32.at(offset), count);
+                level.f32_to_s32(input.at(offset), actual32.at(offset), count);
+                s32_ok = s32_ok && same_bits(expect32.data, actual32.data, count + offset + 8);
+            }
+        }
+        check(s16_ok, std::string(level.isa) + " f32 -> s16 matches scalar");
+        check(s32_ok, std::string(level.isa) + " f32 -> s32 matches scalar");
+    }
+
+    // The scalar rules themselves
+    const float in[] = {1.0f, -1.0f, 2.0f, -2.0f, std::numeric_limits<float>::quiet_NaN(), 0.5f / 32768.0f,
+                        1.5f / 32768.0f};
+    const int16_t want[] = {32767, -32768, 32767, -32768, -32768, 0, 2};
+    int16_t out[7];
+    scalar.f32_to_s16(in, out, 7, nullptr);
+    check(memcmp(out, want, sizeof(want)) == 0, "scalar f32 -> s16 clips, maps NaN low, rounds ties to even");
+    std::cout << "\n";
+}
+
+void test_dithered_s16() {
+    std::cout << "Test 4: Dithered f32 -> s16\n";
+    std::cout << "---------------------------\n";
+
+    const ConvertKernels scalar = rack::convert_detail::scalar_kernels();
+    for (const ConvertKernels& level : simd_levels()) {
+        bool output_ok = true;
+        bool state_ok = true;
+        rack::DitherState expect_state;
+        rack::DitherState actual_state;
+        rack::dither_seed(&expect_state, 42);
+        rack::dither_seed(&actual_state, 42);
+
+        // Consecutive calls of varying odd and even lengths share one state
+        for (size_t count : test_lengths()) {
+            for (size_t offset : OFFSETS) {
+                TestBuffer<float> input(0.0f);
+                fill_float_input(input.at(offset), count, (uint32_t)(count * 13 + offset), 32768.0f);
+
+                TestBuffer<int16_t> expect(0x5A5A);
+                TestBuffer<int16_t> actual(0x5A5A);
+                scalar.f32_to_s16(input.at(offset), expect.at(offset), count, &expect_state);
+                level.f32_to_s16(input.at(offset), actual.at(offset), count, &actual_state);
+                output_ok = output_ok && same_bits(expect.data, actual.data, count + offset + 8);
+                state_ok = state_ok && memcmp(&expect_state, &actual_state, sizeof(expect_state)) == 0;
+            }
+        }
+        check(output_ok, std::string(level.isa) + " dithered output matches scalar");
+        check(state_ok, std::string(level.isa) + " dither state advances like scalar");
+    }
+
+    // Dither must actually perturb: silence turns into +/-1 LSB noise
+    rack::DitherState state;
+    rack::dither_seed(&state, 7);
+    float silence[256] = {};
+    int16_t noise[256];
+    rack::f32_to_s16(silence, noise, 256, &state);
+    bool bounded = true;
+    bool nonzero = false;
+    for (int16_t v : noise) {
+        bounded = bounded && v >= -1 && v <= 1;
+        nonzero = nonzero || v != 0;
+    }
+    check(bounded && nonzero, "dithered silence is nonzero and within +/-1 LSB");
+    std::cout << "\n";
+}
+
+// Independent packed 24-bit reference: sign-extend three little-endian bytes
+static float s24_reference(const uint8_t* p) {
+    int32_t v = p[0] | (p[1] << 8) | (p[2] << 16);
+    if (v & 0x800000) v -= 0x1000000;
+    return (float)v / 8388608.0f;
+}
+
+void test_packed_s24() {
+    std::cout << "Test 5: Packed s24 <-> f32\n";
+    std::cout << "--------------------------\n";
+
+    bool decode_ok = true;
+    bool encode_ok = true;
+    bool round_trip_ok = true;
+    for (size_t count : test_lengths()) {
+        for (size_t offset : OFFSETS) {
+            // Byte offsets, so samples straddle every alignment
+            std::vector<uint8_t> packed(3 * count + offset + 3, 0xA5);
+            uint32_t seed = (uint32_t)(count * 3 + offset);
+            for (size_t i = 0; i < 3 * count; i++) {
+                packed[offset + i] = (uint8_t)(next_random(seed) >> 24);
+            }
+            if (count > 1) {
+                // Both extremes
+                packed[offset + 0] = 0x00; packed[offset + 1] = 0x00; packed[offset + 2] = 0x80;
+                packed[offset + 3] = 0xFF; packed[offset + 4] = 0xFF; packed[offset + 5] = 0x7F;
+            }
+
+            std::vector<float> decoded(count + 1, -7.0f);
+            rack::s24_to_f32(packed.data() + offset, decoded.data(), count);
+            for (size_t i = 0; i < count; i++) {
+                decode_ok = decode_ok && decoded[i] == s24_reference(packed.data() + offset + 3 * i);
+            }
+            decode_ok = decode_ok && decoded[count] == -7.0f;
+
+            std::vector<uint8_t> encoded(3 * count + offset + 3, 0xA5);
+            rack::f32_to_s24(decoded.data(), encoded.data() + offset, count, nullptr);
+            round_trip_ok = round_trip_ok &&
+                            memcmp(encoded.data() + offset, packed.data() + offset, 3 * count) == 0;
+            encode_ok = encode_ok && encoded[offset + 3 * count] == 0xA5 && (offset == 0 || encoded[0] == 0xA5);
+        }
+    }
+    check(decode_ok, "s24 -> f32 matches the reference decode");
+    check(round_trip_ok, "f32 -> s24 round-trips every 24-bit value");
+    check(encode_ok, "f32 -> s24 writes exactly 3 bytes per sample");
+
+    const float in[] = {1.0f, -1.0f, 4.0f, std::numeric_limits<float>::quiet_NaN(), 0.5f / 8388608.0f};
+    const uint8_t want[] = {0xFF, 0xFF, 0x7F, 0x00, 0x00, 0x80, 0xFF, 0xFF, 0x7F, 0x00, 0x00, 0x80, 0x00, 0x00, 0x00};
+    uint8_t out[15];
+    rack::f32_to_s24(in, out, 5, nullptr);
+    check(memcmp(out, want, sizeof(want)) == 0, "f32 -> s24 clips, maps NaN low, rounds ties to even");
+
+    // Dithered s24 uses the same lanes as s16: sample i draws from lane i % 8
+    rack::DitherState a;
+    rack::DitherState b;
+    rack::dither_seed(&a, 99);
+    rack::dither_seed(&b, 99);
+    float input[37];
+    fill_float_input(input, 37, 5, 8388608.0f);
+    uint8_t dithered[3 * 37];
+    rack::f32_to_s24(input, dithered, 37, &a);
+    bool dither_ok = true;
+    for (size_t i = 0; i < 37; i++) {
+        float v = input[i] * 8388608.0f + rack::convert_detail::tpdf(b.lanes[i & 7]);
+        int32_t expect = (int32_t)std::nearbyint(rack::convert_detail::clip(v, -8388608.0f, 8388607.0f));
+        int32_t got = dithered[3 * i] | (dithered[3 * i + 1] << 8) | (dithered[3 * i + 2] << 16);
+        if (got & 0x800000) got -= 0x1000000;
+        dither_ok = dither_ok && got == expect;
+    }
+    check(dither_ok && memcmp(&a, &b, sizeof(a)) == 0, "dithered f32 -> s24 follows the lane rule");
+    std::cout << "\n";
+}
+
+void test_mix_and_gain() {
+    std::cout << "Test 6: mix_add and apply_gain\n";
+    std::cout << "------------------------------\n";
+
+    const ConvertKernels scalar = rack::convert_detail::scalar_kernels();
+    const float gains[] = {0.0f, 1.0f, -0.5f, 0.7071068f, 3.0e38f};
+    for (const ConvertKernels& level : simd_levels()) {
+        bool mix_ok = true;
+        bool gain_ok = true;
+        for (size_t count : test_lengths()) {
+            for (size_t offset : OFFSETS) {
+                for (float gain : gains) {
+                    TestBuffer<float> src(0.0f);
+                    TestBuffer<float> base(0.0f);
+                    fill_float_input(src.at(offset), count, (uint32_t)(count * 17 + offset), 32768.0f);
+                    fill_float_input(base.data, count + offset + 8, (uint32_t)(count * 19 + offset), 32768.0f);
+
+                    TestBuffer<float> expect(0.0f);
+                    TestBuffer<float> actual(0.0f);
+                    memcpy(expect.data, base.data, sizeof(base.data));
+                    memcpy(actual.data, base.data, sizeof(base.data));
+                    scalar.mix_add(src.at(offset), expect.at(offset), count, gain);
+                    level.mix_add(src.at(offset), actual.at(offset), count, gain);
+                    mix_ok = mix_ok && same_bits(expect.data, actual.data, count + offset + 8);
+
+                    memcpy(expect.data, base.data, sizeof(base.data));
+                    memcpy(actual.data, base.data, sizeof(base.data));
+                    scalar.apply_gain(expect.at(offset), count, gain);
+                    level.apply_gain(actual.at(offset), count, gain);
+                    gain_ok = gain_ok && same_bits(expect.data, actual.data, count + offset + 8);
+                }
+            }
+        }
+        check(mix_ok, std::string(level.isa) + " mix_add matches scalar");
+        check(gain_ok, std::string(level.isa) + " apply_gain matches scalar");
+    }
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << "Sample Conversion Test\n";
+    std::cout << "======================\n\n";
+
+    std::cout << "Dispatched ISA: " << rack::convert_isa() << "\n";
+    std::cout << "Levels under test:";
+    for (const ConvertKernels& level : simd_levels()) {
+        std::cout << " " << level.isa;
+    }
+    std::cout << "\n\n";
+
+    test_interleave();
+    test_int_to_float();
+    test_float_to_int();
+    test_dithered_s16();
+    test_packed_s24();
+    test_mix_and_gain();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All tests completed!\n";
+    return 0;
+}
@@ -0,0 +1,374 @@
+#include "rack_graph.h"
+#include <iostream>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Stub nodes: every output channel is gain * (sum of the input channels) +
+// offset. Gains and offsets are small binary fractions, so results are exact
+// in float and can be compared with ==.
+struct StubNode {
+    float gain = 1.0f;
+    float offset = 0.0f;
+    bool fail = false;
+    std::atomic<uint32_t> calls{0};
+};
+
+static int stub_process(void* instance, const float* const* inputs, uint32_t num_input_channels,
+                        float* const* outputs, uint32_t num_output_channels, uint32_t frames) {
+    StubNode* node = static_cast<StubNode*>(instance);
+    node->calls.fetch_add(1, std::memory_order_relaxed);
+    if (node->fail) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < frames; i++) {
+        float sum = 0.0f;
+        for (uint32_t ch = 0; ch < num_input_channels; ch++) {
+            sum += inputs[ch][i];
+        }
+        for (uint32_t ch = 0; ch < num_output_channels; ch++) {
+            outputs[ch][i] = node->gain * sum + node->offset;
+        }
+    }
+    return 0;
+}
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (condition) {
+        std::cout << "PASS: " << what << "\n";
+    } else {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+static float input_sample(uint32_t block, uint32_t frame) {
+    return (float)((block * 7 + frame) % 64) * 0.25f - 8.0f;
+}
+
+// Run one block of a 1-in graph and compare every output sample against
+// expected(x) for input sample x
+template <typename Expected>
+static bool run_and_compare(RackGraph* graph, uint32_t block, uint32_t frames, uint32_t num_outputs,
+                            Expected expected) {
+    std::vector<float> input(frames);
+    for (uint32_t i = 0; i < frames; i++) {
+        input[i] = input_sample(block, i);
+    }
+    std::vector<std::vector<float>> output(num_outputs, std::vector<float>(frames, 12345.0f));
+    std::vector<float*> output_ptrs(num_outputs);
+    for (uint32_t ch = 0; ch < num_outputs; ch++) {
+        output_ptrs[ch] = output[ch].data();
+    }
+    const float* input_ptrs[1] = {input.data()};
+
+    if (rack_graph_process(graph, input_ptrs, 1, output_ptrs.data(), num_outputs, frames) != RACK_GRAPH_OK) {
+        return false;
+    }
+    for (uint32_t ch = 0; ch < num_outputs; ch++) {
+        for (uint32_t i = 0; i < frames; i++) {
+            if (output[ch][i] != expected(ch, input[i])) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void test_diamond() {
+    std::cout << "Test 1: Diamond (A -> B, C -> D)\n";
+    std::cout << "--------------------------------\n";
+
+    RackGraph* graph = rack_graph_new(2, 64, 0);
+    if (!graph) {
+        std::cerr << "FAIL: Failed to create graph\n\n";
+        failures++;
+        return;
+    }
+
+    StubNode a, b, c, d;
+    a.gain = 2.0f;
+    a.offset = 1.0f;
+    b.gain = 0.5f;
+    c.gain = -1.0f;
+    c.offset = 3.0f;
+    d.gain = 1.0f;
+    d.offset = 0.25f;
+    uint32_t na = (uint32_t)rack_graph_add_node(graph, &a, stub_process, 1, 1);
+    uint32_t nb = (uint32_t)rack_graph_add_node(graph, &b, stub_process, 1, 1);
+    uint32_t nc = (uint32_t)rack_graph_add_node(graph, &c, stub_process, 1, 1);
+    uint32_t nd = (uint32_t)rack_graph_add_node(graph, &d, stub_process, 2, 1);
+
+    rack_graph_connect(graph, RACK_GRAPH_IO, 0, na, 0);
+    rack_graph_connect(graph, na, 0, nb, 0);
+    rack_graph_connect(graph, na, 0, nc, 0);
+    rack_graph_connect(graph, nb, 0, nd, 0);
+    rack_graph_connect(graph, nc, 0, nd, 1);
+    rack_graph_connect(graph, nd, 0, RACK_GRAPH_IO, 0);
+    check(rack_graph_prepare(graph) == RACK_GRAPH_OK, "prepare succeeds");
+
+    bool ok = true;
+    for (uint32_t block = 0; block < 100 && ok; block++) {
+        ok = run_and_compare(graph, block, 64, 2, [](uint32_t ch, float x) {
+            if (ch == 1) return 0.0f;  // Unconnected graph output
+            float y = 2.0f * x + 1.0f;
+            return (0.5f * y + (-1.0f * y + 3.0f)) + 0.25f;
+        });
+    }
+    check(ok, "100 blocks match the expected output, unconnected output zeroed");
+    check(a.calls == 100 && b.calls == 100 && c.calls == 100 && d.calls == 100, "each node ran once per block");
+
+    rack_graph_free(graph);
+    std::cout << "\n";
+}
+
+void test_fan_in() {
+    std::cout << "Test 2: Fan-in of 3 into one input channel\n";
+    std::cout << "------------------------------------------\n";
+
+    RackGraph* graph = rack_graph_new(2, 64, 0);
+    if (!graph) {
+        std::cerr << "FAIL: Failed to create graph\n\n";
+        failures++;
+        return;
+    }
+
+    StubNode sources[3];
+    StubNode sum;
+    uint32_t ids[3];
+    for (uint32_t i = 0; i < 3; i++) {
+        sources[i].gain = (float)(i + 1);
+        sources[i].offset = 0.5f * (float)i;
+        ids[i] = (uint32_t)rack_graph_add_node(graph, &sources[i], stub_process, 1, 1);
+        rack_graph_connect(graph, RACK_GRAPH_IO, 0, ids[i], 0);
+    }
+    uint32_t nsum = (uint32_t)rack_graph_add_node(graph, &sum, stub_process, 1, 1);
+    for (uint32_t i = 0; i < 3; i++) {
+        rack_graph_connect(graph, ids[i], 0, nsum, 0);
+    }
+    rack_graph_connect(graph, nsum, 0, RACK_GRAPH_IO, 0);
+    // The graph output sums too: source 2 straight out, plus the summing node
+    rack_graph_connect(graph, ids[2], 0, RACK_GRAPH_IO, 1);
+    rack_graph_connect(graph, nsum, 0, RACK_GRAPH_IO, 1);
+    check(rack_graph_prepare(graph) == RACK_GRAPH_OK, "prepare succeeds");
+
+    bool ok = true;
+    for (uint32_t block = 0; block < 100 && ok; block++) {
+        // Odd block lengths as well as full ones
+        uint32_t frames = block % 2 ? 64 : 1 + block % 63;
+        ok = run_and_compare(graph, block, frames, 2, [](uint32_t ch, float x) {
+            float total = x + (2.0f * x + 0.5f) + (3.0f * x + 1.0f);
+            return ch == 0 ? total : (3.0f * x + 1.0f) + total;
+        });
+    }
+    check(ok, "three sources are summed into one input and one graph output");
+
+    rack_graph_free(graph);
+    std::cout << "\n";
+}
+
+void test_cycle_rejected() {
+    std::cout << "Test 3: prepare() rejects a cycle\n";
+    std::cout << "---------------------------------\n";
+
+    RackGraph* graph = rack_graph_new(1, 64, 0);
+    if (!graph) {
+        std::cerr << "FAIL: Failed to create graph\n\n";
+        failures++;
+        return;
+    }
+
+    StubNode a, b, c;
+    uint32_t na = (uint32_t)rack_graph_add_node(graph, &a, stub_process, 2, 1);
+    uint32_t nb = (uint32_t)rack_graph_add_node(graph, &b, stub_process, 1, 1);
+    uint32_t nc = (uint32_t)rack_graph_add_node(graph, &c, stub_process, 1, 1);
+    rack_graph_connect(graph, RACK_GRAPH_IO, 0, na, 0);
+    rack_graph_connect(graph, na, 0, nb, 0);
+    rack_graph_connect(graph, nb, 0, nc, 0);
+    rack_graph_connect(graph, nc, 0, na, 1);  // Feedback
+    rack_graph_connect(graph, nc, 0, RACK_GRAPH_IO, 0);
+    check(rack_graph_prepare(graph) == RACK_GRAPH_ERROR_CYCLE, "prepare returns RACK_GRAPH_ERROR_CYCLE");
+
+    float input[64] = {};
+    float output[64] = {};
+    const float* inputs[1] = {input};
+    float* outputs[1] = {output};
+    check(rack_graph_process(graph, inputs, 1, outputs, 1, 64) == RACK_GRAPH_ERROR_NOT_PREPARED,
+          "process refuses to run an unprepared graph");
+    check(a.calls == 0 && b.calls == 0 && c.calls == 0, "no node ran");
+
+    StubNode self;
+    RackGraph* self_loop = rack_graph_new(0, 64, 0);
+    if (self_loop) {
+        uint32_t ns = (uint32_t)rack_graph_add_node(self_loop, &self, stub_process, 1, 1);
+        rack_graph_connect(self_loop, ns, 0, ns, 0);
+        check(rack_graph_prepare(self_loop) == RACK_GRAPH_ERROR_CYCLE, "a node feeding itself is a cycle");
+        rack_graph_free(self_loop);
+    }
+
+    rack_graph_free(graph);
+    std::cout << "\n";
+}
+
+void test_node_failure() {
+    std::cout << "Test 4: A failing node is silenced\n";
+    std::cout << "----------------------------------\n";
+
+    RackGraph* graph = rack_graph_new(1, 32, 0);
+    if (!graph) {
+        std::cerr << "FAIL: Failed to create graph\n\n";
+        failures++;
+        return;
+    }
+
+    StubNode good, bad;
+    good.gain = 2.0f;
+    bad.fail = true;
+    uint32_t ng = (uint32_t)rack_graph_add_node(graph, &good, stub_process, 1, 1);
+    uint32_t nb = (uint32_t)rack_graph_add_node(graph, &bad, stub_process, 1, 1);
+    rack_graph_connect(graph, RACK_GRAPH_IO, 0, ng, 0);
+    rack_graph_connect(graph, RACK_GRAPH_IO, 0, nb, 0);
+    rack_graph_connect(graph, ng, 0, RACK_GRAPH_IO, 0);
+    rack_graph_connect(graph, nb, 0, RACK_GRAPH_IO, 0);
+    rack_graph_prepare(graph);
+
+    float input[32];
+    float output[32];
+    for (uint32_t i = 0; i < 32; i++) {
+        input[i] = (float)i;
+    }
+    const float* inputs[1] = {input};
+    float* outputs[1] = {output};
+    check(rack_graph_process(graph, inputs, 1, outputs, 1, 32) == RACK_GRAPH_ERROR_NODE_FAILED,
+          "process reports RACK_GRAPH_ERROR_NODE_FAILED");
+    bool ok = true;
+    for (uint32_t i = 0; i < 32; i++) {
+        ok = ok && output[i] == 2.0f * input[i];
+    }
+    check(ok, "the rest of the graph still runs");
+
+    rack_graph_free(graph);
+    std::cout << "\n";
+}
+
+void test_many_blocks() {
+    std::cout << "Test 5: Thousands of blocks on several workers\n";
+    std::cout << "----------------------------------------------\n";
+
+    // 8 parallel chains of 3 nodes fanning into one mixer, so there is
+    // always work to steal
+    constexpr uint32_t branches = 8;
+    constexpr uint32_t depth = 3;
+    constexpr uint32_t blocks = 5000;
+    RackGraph* graph = rack_graph_new(3, 128, 0);
+    if (!graph) {
+        std::cerr << "FAIL: Failed to create graph\n\n";
+        failures++;
+        return;
+    }
+    check(rack_graph_get_num_workers(graph) == 3, "three workers started");
+
+    std::vector<StubNode> nodes(branches * depth);
+    StubNode mixer;
+    mixer.gain = 0.5f;
+    uint32_t nmix = 0;
+    for (uint32_t b = 0; b < branches; b++) {
+        uint32_t previous = RACK_GRAPH_IO;
+        for (uint32_t s = 0; s < depth; s++) {
+            StubNode& node = nodes[b * depth + s];
+            node.gain = s == 1 ? 0.5f : 1.0f;
+            node.offset = (float)(b + s);
+            uint32_t id = (uint32_t)rack_graph_add_node(graph, &node, stub_process, 1, 1);
+            rack_graph_connect(graph, previous, 0, id, 0);
+            previous = id;
+        }
+        if (b == 0) {
+            nmix = (uint32_t)rack_graph_add_node(graph, &mixer, stub_process, 1, 1);
+            rack_graph_connect(graph, nmix, 0, RACK_GRAPH_IO, 0);
+        }
+        rack_graph_connect(graph, previous, 0, nmix, 0);
+        // Branch 0 also goes straight to the second graph output
+        if (b == 0) {
+            rack_graph_connect(graph, previous, 0, RACK_GRAPH_IO, 1);
+        }
+    }
+    check(rack_graph_prepare(graph) == RACK_GRAPH_OK, "prepare succeeds");
+
+    auto branch = [](uint32_t b, float x) {
+        float y = x + (float)b;
+        y = 0.5f * y + (float)(b + 1);
+        return y + (float)(b + 2);
+    };
+    bool ok = true;
+    uint32_t failed_block = 0;
+    for (uint32_t block = 0; block < blocks && ok; block++) {
+        uint32_t frames = 1 + (block * 37) % 128;
+        ok = run_and_compare(graph, block, frames, 2, [&branch](uint32_t ch, float x) {
+            if (ch == 1) return branch(0, x);
+            float total = 0.0f;
+            for (uint32_t b = 0; b < branches; b++) {
+                total += branch(b, x);
+            }
+            return 0.5f * total;
+        });
+        failed_block = block;
+    }
+    if (!ok) {
+        std::cerr << "First mismatch in block " << failed_block << "\n";
+    }
+    check(ok, "every block's output matches");
+
+    bool counts = mixer.calls == blocks;
+    for (const StubNode& node : nodes) {
+        counts = counts && node.calls == blocks;
+    }
+    check(counts, "every node ran exactly once per block");
+
+    // Rebuilding the graph between blocks keeps working
+    StubNode extra;
+    extra.offset = 1.0f;
+    uint32_t nextra = (uint32_t)rack_graph_add_node(graph, &extra, stub_process, 1, 1);
+    rack_graph_connect(graph, RACK_GRAPH_IO, 0, nextra, 0);
+    rack_graph_connect(graph, nextra, 0, RACK_GRAPH_IO, 1);
+    float scratch[1] = {0.0f};
+    float* scratch_ptrs[1] = {scratch};
+    check(rack_graph_process(graph, nullptr, 0, scratch_ptrs, 1, 1) == RACK_GRAPH_ERROR_NOT_PREPARED,
+          "process refuses to run after the graph changed");
+    check(rack_graph_prepare(graph) == RACK_GRAPH_OK, "prepare succeeds again");
+    ok = true;
+    for (uint32_t block = 0; block < 1000 && ok; block++) {
+        ok = run_and_compare(graph, block, 128, 2, [&branch](uint32_t ch, float x) {
+            if (ch == 1) return branch(0, x) + (x + 1.0f);
+            float total = 0.0f;
+            for (uint32_t b = 0; b < branches; b++) {
+                total += branch(b, x);
+            }
+            return 0.5f * total;
+        });
+    }
+    check(ok, "1000 more blocks match after re-preparing");
+
+    rack_graph_free(graph);
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << "Processing Graph Test\n";
+    std::cout << "=====================\n\n";
+
+    test_diamond();
+    test_fan_in();
+    test_cycle_rejected();
+    test_node_failure();
+    test_many_blocks();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All tests completed!\n";
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include "../src/param_change_queue.h"
+#include <iostream>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (condition) {
+        std::cout << "PASS: " << what << "\n";
+    } else {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+void test_coalescing() {
+    std::cout << "Test 1: Repeated edits coalesce (last value wins)\n";
+    std::cout << "-------------------------------------------------\n";
+
+    rack::ParamChangeQueue<8, 16> queue;
+    uint32_t id = 0;
+    double value = 0.0;
+    check(!queue.pop(&id, &value), "pop on a new queue fails");
+
+    queue.push(7, 0.1);
+    queue.push(7, 0.2);
+    queue.push(3, 0.5);
+    queue.push(7, 0.3);
+    check(queue.pending_count() == 2, "two parameters pending after four edits");
+
+    check(queue.pop(&id, &value) && id == 7 && value == 0.3, "first pop is parameter 7 with its last value");
+    check(queue.pop(&id, &value) && id == 3 && value == 0.5, "second pop is parameter 3");
+    check(!queue.pop(&id, &value), "nothing else is pending");
+
+    // A popped parameter is clean again and re-enqueues on its next edit
+    queue.push(7, 0.9);
+    check(queue.pop(&id, &value) && id == 7 && value == 0.9, "edit after pop is delivered");
+
+    queue.push(1, 0.0);
+    queue.push(2, 1.0);
+    queue.clear();
+    check(queue.pending_count() == 0 && !queue.pop(&id, &value), "clear drops pending edits");
+    check(queue.overflow_count() == 0, "no overflows counted");
+    std::cout << "\n";
+}
+
+void test_queue_full() {
+    std::cout << "Test 2: Overflow when the queue is full\n";
+    std::cout << "---------------------------------------\n";
+
+    rack::ParamChangeQueue<4, 16> queue;
+    bool pushed = true;
+    for (uint32_t id = 0; id < 4; id++) {
+        pushed = pushed && queue.push(id, 0.25);
+    }
+    check(pushed, "QueueCapacity distinct parameters fit");
+    check(!queue.push(4, 0.5), "one more distinct parameter is refused");
+    check(queue.overflow_count() == 1, "the refused edit is counted");
+    check(queue.push(2, 0.75), "an already pending parameter still takes new values");
+    check(queue.overflow_count() == 1, "coalesced edit is not an overflow");
+
+    uint32_t id = 0;
+    double value = 0.0;
+    queue.pop(&id, &value);
+    check(queue.push(4, 0.5), "the refused parameter fits once a slot drains");
+
+    int popped = 0;
+    bool saw_update = false;
+    while (queue.pop(&id, &value)) {
+        popped++;
+        if (id == 2) saw_update = value == 0.75;
+    }
+    check(popped == 4 && saw_update, "queue drains with the coalesced value");
+    std::cout << "\n";
+}
+
+void test_table_full() {
+    std::cout << "Test 3: Overflow when the ID table is full\n";
+    std::cout << "------------------------------------------\n";
+
+    rack::ParamChangeQueue<16, 4> queue;
+    bool pushed = true;
+    for (uint32_t id = 100; id < 104; id++) {
+        pushed = pushed && queue.push(id, 0.5);
+    }
+    check(pushed, "TableCapacity distinct parameters fit");
+    queue.clear();
+
+    // Table slots are never released, so a fifth ID has nowhere to go even
+    // with the queue empty
+    check(!queue.push(200, 0.5), "a new parameter is refused once the table is full");
+    check(queue.overflow_count() == 1, "the refused edit is counted");
+    check(queue.push(101, 0.5), "known parameters keep working");
+    check(!queue.push(rack::ParamChangeQueue<16, 4>::EMPTY_ID, 0.5), "kNoParamId is refused");
+    check(queue.overflow_count() == 2, "the kNoParamId edit is counted");
+    std::cout << "\n";
+}
+
+void test_multi_producer() {
+    std::cout << "Test 4: Concurrent producers lose no edit\n";
+    std::cout << "-----------------------------------------\n";
+
+    // Each producer owns a few parameters and writes strictly increasing
+    // values to them while the consumer drains. The consumer must see every
+    // parameter's values in order, and after the producers stop, the last
+    // value written to each one.
+    constexpr uint32_t producers = 4;
+    constexpr uint32_t params_per_producer = 8;
+    constexpr uint32_t edits_per_param = 20000;
+    constexpr uint32_t total_params = producers * params_per_producer;
+
+    rack::ParamChangeQueue<64, 128> queue;
+    std::atomic<uint32_t> running{producers};
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, &running, p]() {
+            for (uint32_t n = 1; n <= edits_per_param; n++) {
+                for (uint32_t k = 0; k < params_per_producer; k++) {
+                    queue.push(p * params_per_producer + k, (double)n);
+                }
+                if ((n & 63) == 0) {
+                    std::this_thread::yield();
+                }
+            }
+            running.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    double last_seen[total_params] = {};
+    bool in_order = true;
+    auto drain = [&]() {
+        uint32_t id = 0;
+        double value = 0.0;
+        bool any = false;
+        while (queue.pop(&id, &value)) {
+            any = true;
+            if (id >= total_params || value < last_seen[id]) {
+                in_order = false;
+                continue;
+            }
+            last_seen[id] = value;
+        }
+        return any;
+    };
+    while (running.load(std::memory_order_acquire) > 0) {
+        if (!drain()) {
+            std::this_thread::yield();
+        }
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    drain();
+
+    bool all_final = true;
+    for (uint32_t id = 0; id < total_params; id++) {
+        all_final = all_final && last_seen[id] == (double)edits_per_param;
+    }
+    check(in_order, "values for each parameter never go backwards");
+    check(all_final, "every parameter ends on its last written value");
+    check(queue.overflow_count() == 0, "no overflows with capacity for every parameter");
+    check(queue.pending_count() == 0, "nothing is left pending");
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << "ParamChangeQueue Test\n";
+    std::cout << "=====================\n\n";
+
+    test_coalescing();
+    test_queue_full();
+    test_table_full();
+    test_multi_producer();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All tests completed!\n";
+    return 0;
+}
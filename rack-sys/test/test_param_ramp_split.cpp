@@ -0,0 +1,188 @@
+#include "../src/param_ramp_split.h"
+#include <iostream>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+struct Point {
+    int32_t offset;
+    double value;
+};
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (condition) {
+        std::cout << "PASS: " << what << "\n";
+    } else {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+// What a plugin follows for one block: a linear ramp from the value on the
+// frame before the block (offset -1) through each point, holding the last
+static std::vector<double> render_block(const std::vector<Point>& points, double previous, int32_t frames) {
+    std::vector<double> values(frames);
+    Point from = {-1, previous};
+    size_t next = 0;
+    for (int32_t x = 0; x < frames; x++) {
+        while (next < points.size() && points[next].offset < x) {
+            from = points[next++];
+        }
+        if (next < points.size()) {
+            const Point& to = points[next];
+            values[x] = from.value + (to.value - from.value) * (double)(x - from.offset) /
+                                         (double)(to.offset - from.offset);
+        } else {
+            values[x] = from.value;
+        }
+    }
+    return values;
+}
+
+// Cut the span into blocks of block_size, route each block's points the way
+// process_split() does, and render them back to back. Like the backend's
+// processor_values, each sub-block starts from the last point routed so far.
+static std::vector<double> render_split(const std::vector<Point>& points, double start_value,
+                                        int32_t frames, int32_t block_size) {
+    std::vector<double> values;
+    double previous = start_value;
+    for (int32_t begin = 0; begin < frames; begin += block_size) {
+        int32_t block = std::min(block_size, frames - begin);
+        bool last = begin + block == frames;
+
+        std::vector<Point> routed;
+        rack::split_ramp_points(
+            (int32_t)points.size(),
+            [&points](int32_t p, int32_t* offset, double* value) {
+                *offset = points[p].offset;
+                *value = points[p].value;
+            },
+            previous, begin, block, last,
+            [&routed](int32_t offset, double value) {
+                // A second point at the same offset replaces the first, as in
+                // PooledParamValueQueue::addPoint
+                if (!routed.empty() && routed.back().offset == offset) {
+                    routed.back().value = value;
+                } else {
+                    routed.push_back({offset, value});
+                }
+                return true;
+            });
+
+        std::vector<double> rendered = render_block(routed, previous, block);
+        values.insert(values.end(), rendered.begin(), rendered.end());
+        if (!routed.empty()) {
+            previous = routed.back().value;
+        }
+    }
+    return values;
+}
+
+static bool same_ramp(const std::vector<Point>& points, double start_value, int32_t frames, int32_t block_size) {
+    std::vector<double> whole = render_block(points, start_value, frames);
+    std::vector<double> split = render_split(points, start_value, frames, block_size);
+    if (split.size() != whole.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < whole.size(); i++) {
+        if (std::fabs(split[i] - whole[i]) > 1e-9) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_first_point_past_sub_block() {
+    std::cout << "Test 1: First point beyond the first sub-block\n";
+    std::cout << "----------------------------------------------\n";
+
+    // One point far into the span: every sub-block before it must ramp
+    // from the current value instead of jumping or holding
+    std::vector<Point> points = {{1000, 1.0}};
+    check(same_ramp(points, 0.25, 1024, 256), "single late point ramps from the current value");
+
+    std::vector<double> values = render_split(points, 0.25, 1024, 256);
+    check(std::fabs(values[255] - (0.25 + 0.75 * 256.0 / 1001.0)) < 1e-12,
+          "first sub-block ends on the interpolated value");
+    check(values[1023] == 1.0, "span ends on the point's value");
+
+    std::vector<Point> first_routed;
+    rack::split_ramp_points(
+        1, [&points](int32_t, int32_t* offset, double* value) {
+            *offset = points[0].offset;
+            *value = points[0].value;
+        },
+        0.25, 0, 256, false,
+        [&first_routed](int32_t offset, double value) {
+            first_routed.push_back({offset, value});
+            return true;
+        });
+    check(first_routed.size() == 1 && first_routed[0].offset == 255, "first sub-block gets a point");
+    std::cout << "\n";
+}
+
+void test_edges() {
+    std::cout << "Test 2: Points on sub-block edges\n";
+    std::cout << "---------------------------------\n";
+
+    check(same_ramp({{0, 0.5}}, 0.0, 512, 128), "point on the first frame");
+    check(same_ramp({{127, 0.5}, {128, 0.75}}, 0.0, 512, 128), "points either side of a seam");
+    check(same_ramp({{511, 1.0}}, 0.0, 512, 128), "point on the span's last frame");
+    check(same_ramp({{100, 0.2}, {300, 0.9}, {301, 0.1}}, 0.6, 512, 1), "one-frame sub-blocks");
+    check(same_ramp({}, 0.4, 512, 128), "no points holds the current value");
+    check(same_ramp({{50, 0.3}, {60, 0.8}}, 0.1, 100, 1000), "span shorter than a sub-block");
+    std::cout << "\n";
+}
+
+void test_random_spans() {
+    std::cout << "Test 3: Random spans match one long block\n";
+    std::cout << "-----------------------------------------\n";
+
+    uint32_t seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+
+    bool ok = true;
+    int cases = 0;
+    for (; cases < 2000 && ok; cases++) {
+        int32_t frames = 1 + (int32_t)(next() % 2048);
+        int32_t block_size = 1 + (int32_t)(next() % 300);
+        double start_value = (double)(next() % 1001) / 1000.0;
+
+        std::vector<Point> points;
+        int32_t count = (int32_t)(next() % 12);
+        int32_t offset = -1;
+        for (int32_t i = 0; i < count; i++) {
+            offset += 1 + (int32_t)(next() % (uint32_t)(frames / (count + 1) + 1));
+            if (offset >= frames) break;
+            points.push_back({offset, (double)(next() % 1001) / 1000.0});
+        }
+        ok = same_ramp(points, start_value, frames, block_size);
+        if (!ok) {
+            std::cerr << "Mismatch: frames=" << frames << " block=" << block_size
+                      << " points=" << points.size() << "\n";
+        }
+    }
+    check(ok, "2000 random spans split into random sub-blocks");
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << "Split Automation Routing Test\n";
+    std::cout << "=============================\n\n";
+
+    test_first_point_past_sub_block();
+    test_edges();
+    test_random_spans();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All tests completed!\n";
+    return 0;
+}
@@ -0,0 +1,183 @@
+#include "../src/spsc_queue.h"
+#include <iostream>
+#include <cstdint>
+#include <thread>
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (condition) {
+        std::cout << "PASS: " << what << "\n";
+    } else {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+void test_empty_and_full() {
+    std::cout << "Test 1: Empty and full edges\n";
+    std::cout << "----------------------------\n";
+
+    rack::SpscQueue<int, 4> queue;
+    int out = -1;
+    check(!queue.pop(out), "pop on a new queue fails");
+    check(queue.write_available() == 4, "new queue has Capacity free slots");
+
+    bool pushed = true;
+    for (int i = 0; i < 4; i++) {
+        pushed = pushed && queue.push(i);
+    }
+    check(pushed, "Capacity pushes succeed");
+    check(!queue.push(99), "push on a full queue fails");
+    check(queue.write_available() == 0, "full queue has no free slots");
+
+    check(queue.pop(out) && out == 0, "pop after full returns the oldest item");
+    check(queue.push(4), "push succeeds again after one pop");
+    check(!queue.push(5), "queue is full again");
+
+    bool order = true;
+    for (int expected = 1; expected <= 4; expected++) {
+        order = order && queue.pop(out) && out == expected;
+    }
+    check(order, "remaining items pop in FIFO order");
+    check(!queue.pop(out), "pop on a drained queue fails");
+    std::cout << "\n";
+}
+
+void test_wrap_around() {
+    std::cout << "Test 2: Wrap-around past Capacity\n";
+    std::cout << "---------------------------------\n";
+
+    // Interleave pushes and pops so the indices run many times past the
+    // ring size with the queue at every fill level
+    rack::SpscQueue<uint32_t, 8> queue;
+    uint32_t next_push = 0;
+    uint32_t next_pop = 0;
+    bool ok = true;
+    for (uint32_t round = 0; round < 1000 && ok; round++) {
+        uint32_t fill = round % 9;
+        for (uint32_t i = 0; i < fill; i++) {
+            ok = ok && queue.push(next_push++);
+        }
+        uint32_t out = 0;
+        for (uint32_t i = 0; i < fill; i++) {
+            ok = ok && queue.pop(out) && out == next_pop++;
+        }
+        ok = ok && !queue.pop(out);
+    }
+    check(ok, "1000 rounds of fill/drain keep FIFO order");
+    check(next_push > 8 * 100, "indices wrapped the ring many times");
+    std::cout << "\n";
+}
+
+void test_pop_all_partial() {
+    std::cout << "Test 3: pop_all with max_items below the queued count\n";
+    std::cout << "-----------------------------------------------------\n";
+
+    rack::SpscQueue<int, 8> queue;
+    // Start mid-ring so the batch straddles the wrap point
+    int out[8] = {};
+    for (int i = 0; i < 6; i++) queue.push(-1);
+    queue.pop_all(out, 8);
+    for (int i = 0; i < 7; i++) queue.push(i);
+
+    size_t n = queue.pop_all(out, 3);
+    check(n == 3 && out[0] == 0 && out[1] == 1 && out[2] == 2, "first pop_all returns the 3 oldest items");
+
+    n = queue.pop_all(out, 3);
+    check(n == 3 && out[0] == 3 && out[1] == 4 && out[2] == 5, "second pop_all continues where the first stopped");
+
+    n = queue.pop_all(out, 3);
+    check(n == 1 && out[0] == 6, "last pop_all returns only what is left");
+    check(queue.pop_all(out, 3) == 0, "pop_all on an empty queue returns 0");
+    check(queue.write_available() == 8, "every slot is free again");
+
+    queue.push(7);
+    queue.clear();
+    check(queue.pop_all(out, 8) == 0, "clear drops queued items");
+    std::cout << "\n";
+}
+
+void test_sort_events_stable() {
+    std::cout << "Test 4: sort_events stability\n";
+    std::cout << "-----------------------------\n";
+
+    struct Item {
+        uint32_t offset;
+        int order;
+    };
+    // Equal offsets must keep arrival order (a note-off queued before a
+    // note-on at the same sample must stay first)
+    Item items[] = {
+        {5, 0}, {1, 1}, {5, 2}, {0, 3}, {1, 4}, {5, 5}, {0, 6}, {3, 7},
+    };
+    const size_t count = sizeof(items) / sizeof(items[0]);
+    rack::sort_events(items, count, [](const Item& item) { return item.offset; });
+
+    bool sorted = true;
+    bool stable = true;
+    for (size_t i = 1; i < count; i++) {
+        sorted = sorted && items[i - 1].offset <= items[i].offset;
+        if (items[i - 1].offset == items[i].offset) {
+            stable = stable && items[i - 1].order < items[i].order;
+        }
+    }
+    check(sorted, "items are ordered by offset");
+    check(stable, "equal offsets keep arrival order");
+
+    Item single[] = {{2, 0}};
+    rack::sort_events(single, 1, [](const Item& item) { return item.offset; });
+    rack::sort_events(single, 0, [](const Item& item) { return item.offset; });
+    check(single[0].offset == 2, "0 and 1 item batches are left alone");
+    std::cout << "\n";
+}
+
+void test_producer_consumer() {
+    std::cout << "Test 5: One producer and one consumer thread\n";
+    std::cout << "--------------------------------------------\n";
+
+    constexpr uint32_t count = 200000;
+    rack::SpscQueue<uint32_t, 64> queue;
+    std::thread producer([&queue]() {
+        for (uint32_t i = 0; i < count; i++) {
+            while (!queue.push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t expected = 0;
+    bool ordered = true;
+    uint32_t batch[16];
+    while (expected < count) {
+        size_t n = queue.pop_all(batch, 16);
+        if (n == 0) {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < n; i++) {
+            ordered = ordered && batch[i] == expected;
+            expected++;
+        }
+    }
+    producer.join();
+    check(ordered, "every item arrives once, in order");
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << "SpscQueue Test\n";
+    std::cout << "==============\n\n";
+
+    test_empty_and_full();
+    test_wrap_around();
+    test_pop_all_partial();
+    test_sort_events_stable();
+    test_producer_consumer();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All tests completed!\n";
+    return 0;
+}
@@ -0,0 +1,474 @@
+// VST3 instance behavior against the built-in null plugin (bench/null_plugin.cpp)
+//
+// The null plugin copies input to output scaled by its Gain parameter, and
+// its state is that gain as a 32-bit float, so the effect of every state
+// transfer can be checked from the audio it produces.
+
+#include "rack_vst3.h"
+#include "../bench/null_plugin.h"
+#include "pluginterfaces/base/funknown.h"
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef RACK_TEST_NULL_PLUGIN
+#error "RACK_TEST_NULL_PLUGIN must name the rack_null.vst3 bundle"
+#endif
+
+static const char* const kPath = RACK_TEST_NULL_PLUGIN;
+static const uint32_t kBlockSize = 256;
+static const uint32_t kMaxChannels = 8;
+
+static int failures = 0;
+
+static void check(bool condition, const char* what) {
+    if (condition) {
+        std::cout << "PASS: " << what << "\n";
+    } else {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+static std::string null_plugin_uid() {
+    static const Steinberg::TUID uid = RACK_NULL_PLUGIN_TUID;
+    char hex[33];
+    for (size_t i = 0; i < sizeof(uid); i++) {
+        snprintf(hex + i * 2, 3, "%02X", (unsigned char)uid[i]);
+    }
+    return hex;
+}
+
+static RackVST3Plugin* new_plugin(bool initialize) {
+    RackVST3Plugin* plugin = rack_vst3_plugin_new(kPath, null_plugin_uid().c_str());
+    if (plugin && initialize && rack_vst3_plugin_initialize(plugin, 48000.0, kBlockSize) != RACK_VST3_OK) {
+        rack_vst3_plugin_free(plugin);
+        return nullptr;
+    }
+    return plugin;
+}
+
+// State as rack serializes it: the component state size, then the component
+// state (the null plugin's controller is the component, so nothing follows)
+static std::vector<uint8_t> gain_state(float gain) {
+    std::vector<uint8_t> state(sizeof(uint32_t) + sizeof(float));
+    uint32_t size = sizeof(float);
+    memcpy(state.data(), &size, sizeof(size));
+    memcpy(state.data() + sizeof(size), &gain, sizeof(gain));
+    return state;
+}
+
+static std::vector<uint8_t> get_state(RackVST3Plugin* plugin) {
+    int size = rack_vst3_plugin_get_state_size(plugin);
+    if (size <= 0) {
+        return {};
+    }
+    std::vector<uint8_t> state((size_t)size);
+    size_t written = state.size();
+    if (rack_vst3_plugin_get_state(plugin, state.data(), &written) != RACK_VST3_OK) {
+        return {};
+    }
+    state.resize(written);
+    return state;
+}
+
+// Run one block of a constant input and return the last output sample
+// (or -1 if processing failed)
+static float process_constant(RackVST3Plugin* plugin, float input) {
+    uint32_t channels = (uint32_t)rack_vst3_plugin_get_output_channels(plugin);
+    if (channels == 0 || channels > kMaxChannels) {
+        return -1.0f;
+    }
+    std::vector<std::vector<float>> in(channels, std::vector<float>(kBlockSize, input));
+    std::vector<std::vector<float>> out(channels, std::vector<float>(kBlockSize, 0.0f));
+    const float* inputs[kMaxChannels];
+    float* outputs[kMaxChannels];
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        inputs[ch] = in[ch].data();
+        outputs[ch] = out[ch].data();
+    }
+    if (rack_vst3_plugin_process(plugin, inputs, channels, outputs, channels, kBlockSize) != RACK_VST3_OK) {
+        return -1.0f;
+    }
+    return out[channels - 1][kBlockSize - 1];
+}
+
+// Poll until pred() holds, for at most timeout_ms
+template <typename Pred>
+static bool wait_for(Pred pred, int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void test_module_refcount() {
+    std::cout << "Test 1: Module cache reference counting\n";
+    std::cout << "---------------------------------------\n";
+
+    check(rack_vst3_module_is_loaded(kPath) == 0, "module is not loaded before the first instance");
+
+    RackVST3Plugin* a = new_plugin(false);
+    RackVST3Plugin* b = new_plugin(false);
+    check(a && b, "two instances of the same bundle");
+    check(rack_vst3_module_is_loaded(kPath) == 1, "module is loaded while instances exist");
+    rack_vst3_plugin_free(a);
+    check(rack_vst3_module_is_loaded(kPath) == 1, "module stays loaded while one instance is left");
+    rack_vst3_plugin_free(b);
+    check(rack_vst3_module_is_loaded(kPath) == 0, "module is unloaded with its last instance");
+
+    // A clone borrows the module, so it outlives its source's reference
+    a = new_plugin(false);
+    RackVST3Plugin* clone = a ? rack_vst3_plugin_clone(a) : nullptr;
+    check(clone != nullptr, "clone of an uninitialized instance");
+    rack_vst3_plugin_free(a);
+    check(rack_vst3_module_is_loaded(kPath) == 1, "clone keeps the module loaded after its source is freed");
+    rack_vst3_plugin_free(clone);
+    check(rack_vst3_module_is_loaded(kPath) == 0, "module is unloaded with the clone");
+
+    // A preload holds one reference however often it is repeated
+    check(rack_vst3_module_preload(kPath) == RACK_VST3_OK, "preload succeeds");
+    check(rack_vst3_module_preload(kPath) == RACK_VST3_OK, "repeated preload succeeds");
+    check(rack_vst3_module_is_loaded(kPath) == 1, "preloaded module is loaded without instances");
+    a = new_plugin(false);
+    rack_vst3_plugin_free(a);
+    check(rack_vst3_module_is_loaded(kPath) == 1, "preloaded module survives its instances");
+
+    a = new_plugin(false);
+    check(rack_vst3_module_release(kPath) == RACK_VST3_OK, "one release undoes both preloads");
+    check(rack_vst3_module_is_loaded(kPath) == 1, "released module stays loaded while an instance is left");
+    rack_vst3_plugin_free(a);
+    check(rack_vst3_module_is_loaded(kPath) == 0, "released module is unloaded with its last instance");
+    check(rack_vst3_module_release(kPath) == RACK_VST3_ERROR_NOT_FOUND, "release without preload is NOT_FOUND");
+    check(rack_vst3_module_preload("/nonexistent/rack_missing.vst3") == RACK_VST3_ERROR_LOAD_FAILED,
+          "preload of a missing bundle fails");
+    std::cout << "\n";
+}
+
+struct LoadCallback {
+    std::atomic<int> calls{0};
+    std::atomic<int> result{1};
+};
+
+static void on_state_loaded(void* user_data, int result) {
+    auto* callback = static_cast<LoadCallback*>(user_data);
+    callback->result.store(result);
+    callback->calls.fetch_add(1);
+}
+
+void test_async_state_busy() {
+    std::cout << "Test 2: Blocking calls are BUSY during an asynchronous load\n";
+    std::cout << "-----------------------------------------------------------\n";
+
+    RackVST3Plugin* plugin = new_plugin(true);
+    check(plugin != nullptr, "instance created and initialized");
+    if (!plugin) {
+        std::cout << "\n";
+        return;
+    }
+
+    const std::vector<uint8_t> half = gain_state(0.5f);
+    const std::vector<uint8_t> quarter = gain_state(0.25f);
+    check(rack_vst3_plugin_set_state(plugin, half.data(), half.size()) == RACK_VST3_OK, "set_state");
+    check(process_constant(plugin, 1.0f) == 0.5f, "state sets the gain");
+
+    // The null plugin loads in microseconds, so whether a call lands inside
+    // the load is up to the scheduler. A status of PENDING read after the
+    // calls proves the load covered all of them, and then each one must have
+    // refused; otherwise they may have run after it. Rounds continue past
+    // 200 until one did land inside a load.
+    bool consistent = true;
+    int busy_rounds = 0;
+    uint8_t scratch[64];
+    for (int round = 0; round < 5000 && consistent && (round < 200 || busy_rounds == 0); round++) {
+        const std::vector<uint8_t>& next = (round & 1) ? half : quarter;
+        const float next_gain = (round & 1) ? 0.5f : 0.25f;
+
+        LoadCallback callback;
+        if (rack_vst3_plugin_set_state_async(plugin, next.data(), next.size(), on_state_loaded, &callback) !=
+            RACK_VST3_OK) {
+            consistent = false;
+            break;
+        }
+        int set_result = rack_vst3_plugin_set_state(plugin, half.data(), half.size());
+        size_t scratch_size = sizeof(scratch);
+        int get_result = rack_vst3_plugin_get_state(plugin, scratch, &scratch_size);
+        int size_result = rack_vst3_plugin_get_state_size(plugin);
+        int again_result = rack_vst3_plugin_set_state_async(plugin, next.data(), next.size(), nullptr, nullptr);
+        RackVST3Plugin* clone = rack_vst3_plugin_clone(plugin);
+        float output = process_constant(plugin, 1.0f);
+        bool pending = rack_vst3_plugin_state_load_status(plugin) == RACK_VST3_STATE_LOAD_PENDING;
+
+        if (pending) {
+            busy_rounds++;
+            consistent = consistent && set_result == RACK_VST3_ERROR_BUSY && get_result == RACK_VST3_ERROR_BUSY &&
+                         size_result == 0 && again_result == RACK_VST3_ERROR_BUSY && clone == nullptr &&
+                         output == 1.0f;  // Passed through while the plugin is busy
+        } else {
+            consistent = consistent && (output == 1.0f || output == 0.5f || output == 0.25f);
+        }
+        rack_vst3_plugin_free(clone);
+
+        consistent = consistent && rack_vst3_plugin_wait_state_load(plugin) == RACK_VST3_OK;
+        if (again_result == RACK_VST3_OK) {
+            // The first load finished in time for a second one to start
+            consistent = consistent && rack_vst3_plugin_wait_state_load(plugin) == RACK_VST3_OK;
+        }
+        consistent = consistent && wait_for([&callback]() { return callback.calls.load() == 1; }, 1000) &&
+                     callback.result.load() == RACK_VST3_OK;
+
+        // Put the gain back where the next round expects it: a set_state that
+        // slipped in after the load may have overwritten it
+        std::vector<uint8_t> expected = gain_state(next_gain);
+        rack_vst3_plugin_set_state(plugin, expected.data(), expected.size());
+        consistent = consistent && process_constant(plugin, 1.0f) == next_gain;
+    }
+    check(consistent, "calls inside a load return BUSY and process() passes audio through");
+    check(busy_rounds > 0, "at least one round landed inside the load");
+    check(rack_vst3_plugin_state_load_status(plugin) == RACK_VST3_OK, "status reports the last load's result");
+
+    // Once idle, the blocking calls work again
+    check(rack_vst3_plugin_set_state(plugin, quarter.data(), quarter.size()) == RACK_VST3_OK,
+          "set_state works after the load");
+    check(get_state(plugin) == quarter, "get_state returns the loaded state");
+    check(rack_vst3_plugin_set_state_async(plugin, nullptr, 0, nullptr, nullptr) == RACK_VST3_ERROR_INVALID_PARAM,
+          "empty async state is rejected");
+
+    rack_vst3_plugin_free(plugin);
+    std::cout << "\n";
+}
+
+void test_clone_state() {
+    std::cout << "Test 3: A clone carries its source's state and settings\n";
+    std::cout << "-------------------------------------------------------\n";
+
+    RackVST3Plugin* source = new_plugin(true);
+    check(source != nullptr, "source created and initialized");
+    if (!source) {
+        std::cout << "\n";
+        return;
+    }
+
+    // Change the gain through automation, so the state comes from the
+    // processor rather than from a set_state call
+    check(rack_vst3_plugin_set_parameter(source, 0, 0.125f) == RACK_VST3_OK, "queue a gain change");
+    check(process_constant(source, 1.0f) == 0.125f, "source processes at the new gain");
+    rack_vst3_plugin_flush_param_updates(source);
+    check(rack_vst3_plugin_set_double_precision(source, 1) == RACK_VST3_OK, "source switched to 64-bit");
+
+    RackVST3Plugin* clone = rack_vst3_plugin_clone(source);
+    check(clone != nullptr, "clone created");
+    if (clone) {
+        std::vector<uint8_t> source_state = get_state(source);
+        check(!source_state.empty() && get_state(clone) == source_state, "clone state equals source state");
+        check(source_state == gain_state(0.125f), "state holds the automated gain");
+        check(rack_vst3_plugin_is_initialized(clone) == 1, "clone of an initialized source is initialized");
+        check(rack_vst3_plugin_get_sample_size(clone) == 64, "double precision carries over");
+        check(process_constant(clone, 1.0f) == 0.125f, "clone processes at the source's gain");
+
+        float value = 0.0f;
+        check(rack_vst3_plugin_get_parameter(clone, 0, &value) == RACK_VST3_OK && value == 0.125f,
+              "clone's controller shows the source's gain");
+
+        // The two instances are independent afterwards
+        std::vector<uint8_t> unity = gain_state(1.0f);
+        rack_vst3_plugin_set_state(clone, unity.data(), unity.size());
+        check(get_state(source) == source_state, "changing the clone leaves the source alone");
+        rack_vst3_plugin_free(clone);
+    }
+    rack_vst3_plugin_free(source);
+    std::cout << "\n";
+}
+
+void test_double_precision() {
+    std::cout << "Test 4: 64-bit processing\n";
+    std::cout << "-------------------------\n";
+
+    RackVST3Plugin* plugin = new_plugin(true);
+    check(plugin != nullptr, "instance created and initialized");
+    if (!plugin) {
+        std::cout << "\n";
+        return;
+    }
+    uint32_t channels = (uint32_t)rack_vst3_plugin_get_output_channels(plugin);
+    check(channels > 0 && channels <= kMaxChannels, "output channel count");
+    if (channels == 0 || channels > kMaxChannels) {
+        rack_vst3_plugin_free(plugin);
+        std::cout << "\n";
+        return;
+    }
+
+    // A value float can't hold: at unity gain it only survives untouched if
+    // the plugin runs at 64 bits
+    const double fine = 1.0 + 1e-12;
+    std::vector<std::vector<double>> in(channels, std::vector<double>(kBlockSize, fine));
+    std::vector<std::vector<double>> out(channels, std::vector<double>(kBlockSize, 0.0));
+    const double* inputs[kMaxChannels];
+    double* outputs[kMaxChannels];
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        inputs[ch] = in[ch].data();
+        outputs[ch] = out[ch].data();
+    }
+    auto all_equal = [&out, channels](double expect) {
+        for (uint32_t ch = 0; ch < channels; ch++) {
+            for (double v : out[ch]) {
+                if (v != expect) return false;
+            }
+        }
+        return true;
+    };
+
+    check(rack_vst3_plugin_get_sample_size(plugin) == 32, "plugins start at 32 bits");
+    check(rack_vst3_plugin_process_f64(plugin, inputs, channels, outputs, channels, kBlockSize) == RACK_VST3_OK,
+          "process_f64 on a 32-bit plugin");
+    check(all_equal((double)(float)fine), "32-bit plugin converts through float");
+
+    check(rack_vst3_plugin_set_double_precision(plugin, 1) == RACK_VST3_OK, "switch to 64-bit");
+    check(rack_vst3_plugin_get_sample_size(plugin) == 64, "null plugin runs at kSample64");
+    check(rack_vst3_plugin_process_f64(plugin, inputs, channels, outputs, channels, kBlockSize) == RACK_VST3_OK,
+          "process_f64 on a 64-bit plugin");
+    check(all_equal(fine), "64-bit plugin keeps full precision");
+
+    // Longer than a block: the split path must stay at 64 bits too
+    const uint32_t long_frames = kBlockSize * 3 + 17;
+    std::vector<std::vector<double>> long_in(channels, std::vector<double>(long_frames, fine));
+    std::vector<std::vector<double>> long_out(channels, std::vector<double>(long_frames, 0.0));
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        inputs[ch] = long_in[ch].data();
+        outputs[ch] = long_out[ch].data();
+    }
+    check(rack_vst3_plugin_process_split_f64(plugin, inputs, channels, outputs, channels, long_frames) ==
+              RACK_VST3_OK,
+          "process_split_f64 over several blocks");
+    bool split_exact = true;
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        for (double v : long_out[ch]) {
+            split_exact = split_exact && v == fine;
+        }
+    }
+    check(split_exact, "split 64-bit blocks keep full precision");
+
+    // The float entry point converts for a 64-bit plugin
+    check(process_constant(plugin, 0.75f) == 0.75f, "process() on a 64-bit plugin");
+
+    // Gain applies in double too, and automation reaches the 64-bit processor
+    check(rack_vst3_plugin_set_parameter(plugin, 0, 0.5f) == RACK_VST3_OK, "queue a gain change");
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        inputs[ch] = in[ch].data();
+        outputs[ch] = out[ch].data();
+    }
+    rack_vst3_plugin_process_f64(plugin, inputs, channels, outputs, channels, kBlockSize);
+    check(all_equal(fine * 0.5), "64-bit block applies the gain in double");
+
+    check(rack_vst3_plugin_set_double_precision(plugin, 0) == RACK_VST3_OK, "switch back to 32-bit");
+    check(rack_vst3_plugin_get_sample_size(plugin) == 32, "plugin runs at 32 bits again");
+    check(get_state(plugin) == gain_state(0.5f), "switching sample size keeps the state");
+
+    rack_vst3_plugin_free(plugin);
+    std::cout << "\n";
+}
+
+void test_pool_refill() {
+    std::cout << "Test 5: Instance pool refills after acquire\n";
+    std::cout << "-------------------------------------------\n";
+
+    RackVST3Plugin* prototype = new_plugin(true);
+    check(prototype != nullptr, "prototype created and initialized");
+    if (!prototype) {
+        std::cout << "\n";
+        return;
+    }
+    std::vector<uint8_t> state = gain_state(0.375f);
+    rack_vst3_plugin_set_state(prototype, state.data(), state.size());
+
+    const uint32_t size = 3;
+    RackVST3Pool* pool = rack_vst3_pool_new(prototype, size);
+    check(pool != nullptr, "pool created");
+    if (!pool) {
+        rack_vst3_plugin_free(prototype);
+        std::cout << "\n";
+        return;
+    }
+    check(rack_vst3_pool_new(prototype, 0) == nullptr, "pool of size 0 is rejected");
+
+    // The pool holds its own module reference and its own copy of the state
+    rack_vst3_plugin_free(prototype);
+    check(rack_vst3_module_is_loaded(kPath) == 1, "pool keeps the module loaded without the prototype");
+
+    check(wait_for([pool]() { return rack_vst3_pool_available(pool) == (int)size; }, 10000),
+          "pool fills to its size");
+
+    std::vector<RackVST3Plugin*> taken;
+    bool all_ready = true;
+    for (uint32_t i = 0; i < size * 3; i++) {
+        // Reaching size again after every acquire shows the refill ran
+        RackVST3Plugin* plugin = rack_vst3_pool_acquire(pool);
+        all_ready = all_ready && plugin != nullptr;
+        if (plugin) {
+            taken.push_back(plugin);
+        }
+        all_ready = all_ready && wait_for([pool]() { return rack_vst3_pool_available(pool) == (int)size; }, 10000);
+    }
+    check(all_ready, "every acquire is refilled back to size");
+
+    // Taking instances back to back may outrun the refill; acquire then
+    // returns NULL instead of waiting, and the pool never overfills
+    bool bounded = true;
+    for (uint32_t i = 0; i < size * 2; i++) {
+        RackVST3Plugin* plugin = rack_vst3_pool_acquire(pool);
+        if (plugin) {
+            taken.push_back(plugin);
+        }
+        int available = rack_vst3_pool_available(pool);
+        bounded = bounded && available >= 0 && available <= (int)size;
+    }
+    check(bounded, "pool never holds more than its size");
+    check(wait_for([pool]() { return rack_vst3_pool_available(pool) == (int)size; }, 10000),
+          "pool refills after being drained");
+
+    bool states_ok = true;
+    for (RackVST3Plugin* plugin : taken) {
+        states_ok = states_ok && rack_vst3_plugin_is_initialized(plugin) == 1 && get_state(plugin) == state &&
+                    process_constant(plugin, 1.0f) == 0.375f;
+    }
+    check(states_ok, "acquired instances are initialized with the prototype's state");
+
+    rack_vst3_pool_free(pool);
+    check(rack_vst3_module_is_loaded(kPath) == 1, "acquired instances keep the module after the pool is freed");
+    bool still_valid = true;
+    for (RackVST3Plugin* plugin : taken) {
+        still_valid = still_valid && process_constant(plugin, 1.0f) == 0.375f;
+        rack_vst3_plugin_free(plugin);
+    }
+    check(still_valid, "acquired instances outlive the pool");
+    check(rack_vst3_module_is_loaded(kPath) == 0, "module is unloaded with the last instance");
+    std::cout << "\n";
+}
+
+int main() {
+    std::cout << "VST3 Null Plugin Test\n";
+    std::cout << "=====================\n\n";
+    std::cout << "Bundle: " << kPath << "\n\n";
+
+    test_module_refcount();
+    test_async_state_busy();
+    test_clone_state();
+    test_double_precision();
+    test_pool_refill();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed\n";
+        return 1;
+    }
+    std::cout << "All tests completed!\n";
+    return 0;
+}
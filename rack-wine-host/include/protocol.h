@@ -1,9 +1,14 @@
 // rack-wine-host protocol definition
 // Shared between Wine host and Linux client
+//
+// One host process serves any number of TCP connections at once. Each
+// connection is an independent instance with its own plugin slots, shared
+// memory and audio thread.
 
 #ifndef RACK_WINE_PROTOCOL_H
 #define RACK_WINE_PROTOCOL_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -32,7 +37,7 @@ enum RackWineCommand {
     CMD_CLOSE_EDITOR = 15,  // Close plugin GUI editor
     CMD_GET_EDITOR_SIZE = 16, // Get editor window size
     CMD_GET_PARAM_CHANGES = 17, // Get parameter changes from GUI
-    CMD_SHUTDOWN = 99,      // Shutdown host
+    CMD_SHUTDOWN = 99,      // End this connection's session (the host exits after the last one unless --persistent)
 };
 
 // Response status
@@ -42,6 +47,7 @@ enum RackWineStatus {
     STATUS_NOT_LOADED = 2,
     STATUS_NOT_INITIALIZED = 3,
     STATUS_INVALID_PARAM = 4,
+    STATUS_NO_SPACE = 5,        // Shared-memory region too small (see RespState)
 };
 
 // Message header (all messages start with this)
@@ -77,7 +83,8 @@ typedef struct {
     uint32_t max_block_size;
 } CmdInit;
 
-// CMD_GET_PARAM / CMD_SET_PARAM payload
+// CMD_GET_PARAM / CMD_SET_PARAM payload. CMD_SET_PARAM sets the edit
+// controller and queues the value for the processor's next block.
 typedef struct {
     uint32_t param_id;
     double value;           // Normalized 0.0-1.0
@@ -90,7 +97,7 @@ typedef struct {
     char category[128];
     char uid[64];
     uint32_t num_params;
-    uint32_t num_audio_inputs;
+    uint32_t num_audio_inputs;    // Channels of the main buses as declared by the plugin
     uint32_t num_audio_outputs;
     uint32_t flags;         // Instrument, effect, etc.
 } RespPluginInfo;
@@ -114,7 +121,9 @@ typedef struct {
     uint32_t shm_offset_out;  // Offset in shared memory for output
 } CmdProcess;
 
-// CMD_SEND_MIDI payload
+// CMD_SEND_MIDI payload. Events are queued for the selected slot's next
+// block; CC, channel pressure and pitch bend lose their sample offset on
+// this path (see In-band Events for sample-accurate delivery).
 typedef struct {
     uint32_t num_events;
     // Followed by num_events * MidiEvent
@@ -147,7 +156,9 @@ typedef struct {
 
 typedef struct {
     uint32_t num_changes;
-    // Followed by num_changes * ParamChangeEvent
+    // Followed by num_changes * ParamChangeEvent, then a uint64_t count of
+    // GUI changes dropped so far (repeated edits to one parameter coalesce,
+    // so each parameter appears at most once)
 } RespParamChanges;
 
 #pragma pack(pop)
@@ -163,9 +174,11 @@ typedef struct {
 // Shared memory name template - %d is replaced with host PID
 #define RACK_WINE_SHM_NAME "/rack-wine-audio-%d"
 
-// Maximum supported configuration
-#define RACK_WINE_MAX_CHANNELS 8
-#define RACK_WINE_MAX_BLOCK_SIZE 4096
+// Maximum supported configuration. Shared memory and host buffers are sized
+// from the configuration actually requested, so these are only upper bounds.
+#define RACK_WINE_MAX_CHANNELS 64
+#define RACK_WINE_MAX_BLOCK_SIZE 65536
+#define RACK_WINE_MAX_PIPELINE_DEPTH 4
 
 // Shared memory header
 typedef struct {
@@ -176,26 +189,135 @@ typedef struct {
     uint32_t block_size;         // Current block size
     uint32_t sample_rate;        // Sample rate (as uint32)
 
-    // Synchronization
-    volatile uint32_t host_ready;    // Host has processed, output ready
-    volatile uint32_t client_ready;  // Client has written input, ready to process
+    // Synchronization (realtime doorbell, see CMD_START_REALTIME)
+    volatile uint32_t host_ready;    // Host has processed, output ready (completed sequence)
+    volatile uint32_t client_ready;  // Client has written input, ready to process (request sequence)
 
-    // Buffer offsets (from start of shared memory)
+    // Buffer offsets (from start of shared memory), for block slot 0
     uint32_t input_offset;       // Offset to input buffers
     uint32_t output_offset;      // Offset to output buffers
 
-    // Reserved for future use
-    uint32_t reserved[4];
+    // Realtime doorbell state
+    volatile uint32_t rt_flags;       // RACK_WINE_RT_* flags, written by host
+    volatile uint32_t host_waiting;   // Host audio thread is parked on client_ready
+    volatile uint32_t client_waiting; // Client is parked on host_ready
+
+    // Block ring (pipelined mode). Sequence number n (1-based) uses block
+    // slot (n - 1) % pipeline_depth; slot k's buffers are at input_offset /
+    // output_offset + k * slot_stride.
+    uint32_t pipeline_depth;     // Block slots in the ring (0 or 1 = synchronous)
+    uint32_t slot_stride;        // Bytes between consecutive block slots
+    volatile uint32_t slot_samples[RACK_WINE_MAX_PIPELINE_DEPTH];  // Samples per block slot
+    uint32_t sample_format;      // RACK_WINE_SAMPLE_* of the buffers
+
+    // Advances whenever the latency or tail of the chain may have changed;
+    // the client then re-queries CMD_GET_LATENCY. Written by host.
+    volatile uint32_t latency_generation;
+
+    // Offset of the RackWineShmEventBlock ring (one per block slot), see
+    // RACK_WINE_SHM_EVENTS_OFFSET. Written by client.
+    uint32_t events_offset;
+    uint32_t reserved[2];        // Keeps the buffers 16-byte aligned
 } RackWineShmHeader;
 
 #define RACK_WINE_SHM_MAGIC 0x52574153  // 'RWAS' - Rack Wine Audio Shm
 
+// Sample formats of the shm audio buffers. With F64, plugins that support
+// 64-bit processing run on the doubles directly; the others are converted
+// inside the host, so the client never converts.
+#define RACK_WINE_SAMPLE_F32 0  // 32-bit float (default)
+#define RACK_WINE_SAMPLE_F64 1  // 64-bit double
+
+#define RACK_WINE_SAMPLE_BYTES(format) \
+    ((format) == RACK_WINE_SAMPLE_F64 ? sizeof(double) : sizeof(float))
+
+// Realtime doorbell flags (RackWineShmHeader.rt_flags)
+//
+// In realtime mode the client writes input into the block slot for the next
+// sequence number, stores its slot_samples entry, increments client_ready and
+// wakes the host if host_waiting is set. The host audio thread processes all
+// submitted blocks in order, stores each completed sequence number in
+// host_ready and wakes the client if client_waiting is set. Both sides spin
+// briefly before parking.
+//
+// With pipeline_depth N > 1 the client submits block n and then only waits
+// for block n - (N - 1), so the plugin runs while the client is filling the
+// next block. Output is delayed by a fixed N - 1 blocks. The wakeup primitive is a Linux futex on the sequence
+// word itself (the mapping is a MAP_SHARED file, so the futex key is shared
+// between the Linux client and the Wine process).
+#define RACK_WINE_RT_ACTIVE     0x1   // Host audio thread is serving the doorbell
+#define RACK_WINE_RT_FUTEX      0x2   // Host issues futex wakes; client may park in FUTEX_WAIT
+#define RACK_WINE_RT_ERROR      0x4   // Last realtime block failed in process()
+
+// Spin iterations before either side parks on the doorbell
+#define RACK_WINE_RT_SPIN_COUNT 4000
+
 // Calculate shared memory size needed
 // Layout: [Header][Input ch0][Input ch1]...[Output ch0][Output ch1]...
 #define RACK_WINE_SHM_SIZE(num_in, num_out, block_size) \
     (sizeof(RackWineShmHeader) + \
      ((num_in) + (num_out)) * (block_size) * sizeof(float))
 
+// Pipelined layout: [Header][slot 0: inputs, outputs][slot 1: ...]...
+#define RACK_WINE_SHM_SIZE_PIPELINED(num_in, num_out, block_size, depth) \
+    (sizeof(RackWineShmHeader) + \
+     (depth) * ((num_in) + (num_out)) * (block_size) * sizeof(float))
+
+// Pipelined layout in any sample format
+#define RACK_WINE_SHM_SIZE_FORMAT(num_in, num_out, block_size, depth, format) \
+    (sizeof(RackWineShmHeader) + \
+     (depth) * ((num_in) + (num_out)) * (block_size) * RACK_WINE_SAMPLE_BYTES(format))
+
+// ============================================================================
+// In-band Events
+// ============================================================================
+
+// Every block slot has an event area next to its audio: MIDI messages and
+// sample-accurate parameter points for the plugin slots, written by the
+// client together with the input and delivered to process() of that block.
+// The client rewrites num_events (0 when there is nothing to send) before
+// every submission, on both the doorbell and the CMD_PROCESS_AUDIO path.
+//
+// MIDI note on/off and poly pressure become VST3 events. CC, channel
+// pressure and pitch bend become parameter points through the plugin's
+// IMidiMapping; other messages are ignored. Parameter points go to the
+// processor's inputParameterChanges and are passed on to the edit
+// controller after the block. Sample offsets past the block are clamped to
+// its last frame. Per block slot the host queues at most 256 VST3 events per
+// plugin slot; the rest count as dropped MIDI events in CMD_GET_STATS.
+
+// Events per block slot
+#define RACK_WINE_MAX_BLOCK_EVENTS 512
+
+// RackWineShmEvent.type
+#define RACK_WINE_EVENT_MIDI  0   // midi[0..2] is a channel-voice message
+#define RACK_WINE_EVENT_PARAM 1   // param_id = value (normalized 0.0-1.0)
+
+typedef struct {
+    uint32_t type;               // RACK_WINE_EVENT_*
+    uint32_t slot;               // Plugin slot the event is for
+    uint32_t sample_offset;      // Frame within the block
+    uint32_t param_id;           // PARAM: VST3 parameter ID
+    uint8_t midi[4];             // MIDI: status, data1, data2, 0
+    uint32_t reserved;
+    double value;                // PARAM: normalized value
+} RackWineShmEvent;
+
+typedef struct {
+    uint32_t num_events;         // Events in use, written by the client
+    uint32_t reserved[3];
+    RackWineShmEvent events[RACK_WINE_MAX_BLOCK_EVENTS];
+} RackWineShmEventBlock;
+
+// Layout with events: [Header][audio block slots][pad to 64][event block
+// slot 0][event block slot 1]...
+#define RACK_WINE_SHM_EVENTS_OFFSET(num_in, num_out, block_size, depth, format) \
+    ((RACK_WINE_SHM_SIZE_FORMAT(num_in, num_out, block_size, depth, format) + 63) & ~(size_t)63)
+
+#define RACK_WINE_SHM_SIZE_EVENTS(num_in, num_out, block_size, depth, format) \
+    (RACK_WINE_SHM_EVENTS_OFFSET(num_in, num_out, block_size, depth, format) + \
+     (depth) * sizeof(RackWineShmEventBlock))
+
 // CMD_INIT_AUDIO payload - initialize audio processing
 typedef struct {
     uint32_t sample_rate;
@@ -203,6 +325,9 @@ typedef struct {
     uint32_t num_inputs;
     uint32_t num_outputs;
     char shm_name[64];           // Shared memory name
+    uint32_t pipeline_depth;     // Block slots (optional, older clients omit it: 1)
+    uint32_t process_mode;       // VST3 ProcessModes: 0 = realtime, 2 = offline (optional: 0)
+    uint32_t sample_format;      // RACK_WINE_SAMPLE_* of the shm buffers (optional: F32)
 } CmdInitAudio;
 
 // CMD_PROCESS_AUDIO payload - trigger processing
@@ -211,8 +336,199 @@ typedef struct {
 } CmdProcessAudio;
 
 // Add new commands
-#define CMD_INIT_AUDIO    20     // Initialize audio with shared memory
-#define CMD_PROCESS_AUDIO 21     // Process audio block
+#define CMD_INIT_AUDIO      20   // Initialize audio with shared memory
+#define CMD_PROCESS_AUDIO   21   // Process audio block
+#define CMD_START_REALTIME  22   // Start host audio thread serving the shm doorbell
+#define CMD_STOP_REALTIME   23   // Stop host audio thread, back to CMD_PROCESS_AUDIO
+#define CMD_SELECT_SLOT     24   // Select plugin slot addressed by control commands
+#define CMD_SET_CHAIN       25   // Set processing chain over plugin slots
+#define CMD_SET_IDLE_SLEEP  26   // Enable/disable idle sleep for the selected slot
+#define CMD_GET_BLOCK_COUNTS 27  // Get processed/skipped block counters of the selected slot
+#define CMD_GET_LATENCY     28   // Get latency and tail of the selected slot and the chain
+#define CMD_GET_STATS       29   // Get processing statistics of the selected slot
+#define CMD_RESET_STATS     30   // Zero the processing statistics of the selected slot
+#define CMD_BATCH           31   // Run many control commands in one round trip
+#define CMD_GET_PARAM_INFO_ALL 32 // Get info of a range of parameters of the selected slot
+#define CMD_SET_STATE_REGION 33  // Map the shared-memory region used by GET/SET_STATE
+
+// ============================================================================
+// Plugin Chains
+// ============================================================================
+
+// Maximum plugin slots per host process
+#define RACK_WINE_MAX_SLOTS 16
+
+// CMD_SELECT_SLOT payload. LOAD_PLUGIN, GET_INFO, parameters, MIDI, editor
+// and param change commands all apply to the selected slot (default 0).
+typedef struct {
+    uint32_t slot;
+} CmdSelectSlot;
+
+// CMD_SET_CHAIN payload. Stages run in order; each stage is a bitmask of
+// slots that process the previous stage's output in parallel and are summed.
+// With no chain set (num_stages = 0), loaded slots run serially by index.
+typedef struct {
+    uint32_t num_stages;
+    uint32_t stage_masks[RACK_WINE_MAX_SLOTS];
+} CmdSetChain;
+
+// ============================================================================
+// Silence Handling
+// ============================================================================
+
+// Silent input channels are always reported to the plugin via silenceFlags.
+// With idle sleep enabled, a slot whose input has been silent (and without
+// MIDI) for longer than its tail plus latency, and whose last output was
+// silent, is not processed: its output is zero-filled until input or MIDI
+// arrives. Disabled by default and reset when the slot is unloaded.
+
+// CMD_SET_IDLE_SLEEP payload
+typedef struct {
+    uint32_t enabled;            // 0 = always process, 1 = sleep when idle
+} CmdSetIdleSleep;
+
+// CMD_GET_BLOCK_COUNTS response
+typedef struct {
+    uint64_t processed_blocks;   // Blocks the plugin processed
+    uint64_t skipped_blocks;     // Blocks skipped while asleep
+} RespBlockCounts;
+
+// ============================================================================
+// Latency
+// ============================================================================
+
+// Tail that never ends (VST3 kInfiniteTail)
+#define RACK_WINE_TAIL_INFINITE 0xFFFFFFFFu
+
+// CMD_GET_LATENCY response. Values are re-queried from the plugins on every
+// request. Chain latency is the sum over stages of the largest latency in
+// each stage; parallel slots in a stage are not delay-compensated against
+// each other. The chain tail likewise sums the stage maxima and is
+// RACK_WINE_TAIL_INFINITE if any slot's tail is.
+typedef struct {
+    uint32_t latency_samples;    // Selected slot
+    uint32_t tail_samples;       // Selected slot
+    uint32_t chain_latency;      // Whole processing chain
+    uint32_t chain_tail;         // Whole processing chain
+    uint32_t generation;         // Current RackWineShmHeader.latency_generation
+} RespLatency;
+
+// ============================================================================
+// Statistics
+// ============================================================================
+
+// Process-time histogram size of RespStats
+#define RACK_WINE_STATS_HISTOGRAM_BUCKETS 32
+
+// CMD_GET_STATS response: processing statistics of the selected slot since
+// it was loaded or CMD_RESET_STATS. Times cover the slot's share of each
+// block (its process() call plus the host's per-slot work), measured inside
+// the host; the block deadline is num_samples / sample rate.
+typedef struct {
+    uint64_t process_calls;          // Blocks the slot was run for
+    uint64_t frames;                 // Frames in those blocks
+    uint64_t total_ns;               // Time spent in them
+    uint64_t max_ns;                 // Slowest block
+    uint64_t deadline_ns;            // Sum of their block deadlines
+    uint64_t deadline_misses;        // Blocks slower than their deadline
+    double max_load;                 // Largest block time / block deadline
+    double average_load;             // total_ns / deadline_ns
+    uint64_t process_errors;         // Blocks where the plugin's process() failed
+    uint64_t dropped_midi_events;    // CMD_SEND_MIDI events the slot could not queue
+    uint64_t dropped_param_changes;  // GUI parameter changes dropped
+    uint64_t histogram[RACK_WINE_STATS_HISTOGRAM_BUCKETS];  // Bucket i: blocks taking [2^i, 2^(i+1)) ns
+} RespStats;
+
+// ============================================================================
+// Batching
+// ============================================================================
+
+// Largest message payload the host accepts; larger frames drop the connection
+#define RACK_WINE_MAX_PAYLOAD (64u * 1024u * 1024u)
+
+// CMD_GET_PARAM_INFO_ALL payload (optional). Without a payload every
+// parameter is returned; count is clamped to the parameters after `first`.
+typedef struct {
+    uint32_t first;              // First parameter index
+    uint32_t count;              // Number of parameters
+} CmdParamInfoRange;
+
+// CMD_GET_PARAM_INFO_ALL response. Followed by num_infos * RespParamInfo for
+// indices first .. first + num_infos - 1; the list ends early at the first
+// parameter the plugin fails to describe.
+typedef struct {
+    uint32_t total_params;       // Parameter count of the selected slot
+    uint32_t first;
+    uint32_t num_infos;
+} RespParamInfoList;
+
+// CMD_BATCH payload: num_entries sub-commands, each a BatchEntry followed by
+// payload_size bytes of that command's usual payload. Entries run in order
+// exactly as separate messages would, so a CMD_SELECT_SLOT entry retargets
+// the entries after it (and stays selected after the batch). Allowed:
+// CMD_SELECT_SLOT, CMD_GET_PARAM_COUNT, CMD_GET_PARAM_INFO,
+// CMD_GET_PARAM_INFO_ALL, CMD_GET_PARAM and CMD_SET_PARAM; other commands
+// fail their entry with STATUS_INVALID_PARAM.
+//
+// A failing entry does not stop the batch. The batch as a whole fails with
+// STATUS_INVALID_PARAM, before running any entry, only if the frame is
+// malformed.
+typedef struct {
+    uint32_t num_entries;
+} CmdBatch;
+
+typedef struct {
+    uint32_t command;            // CMD_*
+    uint32_t payload_size;
+} BatchEntry;
+
+// CMD_BATCH response: one BatchResult per entry, in entry order, each
+// followed by payload_size bytes of that command's usual response payload
+// (empty unless status is STATUS_OK).
+typedef struct {
+    uint32_t num_entries;
+} RespBatch;
+
+typedef struct {
+    uint32_t status;             // RackWineStatus
+    uint32_t payload_size;
+} BatchResult;
+
+// ============================================================================
+// State Transfer
+// ============================================================================
+
+// Plugin state never travels over the socket: it can run to hundreds of MB
+// for sample-based instruments. The client creates a file, as for the audio
+// shm, and maps it into this connection with CMD_SET_STATE_REGION; the
+// plugin's getState()/setState() then stream straight from and to the
+// region, and CMD_GET_STATE / CMD_SET_STATE only exchange sizes. The client
+// may grow the region (and send CMD_SET_STATE_REGION again) between commands.
+//
+// State layout, the same as rack-sys's native VST3 host:
+// [uint32_t component state size][component state][controller state]
+// The controller part is empty unless the plugin has a separate controller.
+
+// Largest state region the host maps
+#define RACK_WINE_MAX_STATE_REGION (1ull << 32)
+
+// CMD_SET_STATE_REGION payload. size 0 unmaps the current region.
+typedef struct {
+    uint64_t size;               // Bytes of the file to map
+    char shm_name[64];           // File name (as in CmdInitAudio)
+} CmdStateRegion;
+
+// CMD_SET_STATE payload: the state is in the first `size` bytes of the region
+typedef struct {
+    uint64_t size;
+} CmdState;
+
+// CMD_GET_STATE response. With STATUS_OK the state is in the first `size`
+// bytes of the region. With STATUS_NO_SPACE it did not fit and `size` is the
+// region size needed; grow the region and ask again.
+typedef struct {
+    uint64_t size;
+} RespState;
 
 #ifdef __cplusplus
 }
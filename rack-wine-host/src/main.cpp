@@ -4,12 +4,23 @@
 #include <winsock2.h>
 #include <windows.h>
 #include <ws2tcpip.h>
+#include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <math.h>
+#include <new>
+#include <type_traits>
 
 #include "../include/protocol.h"
+#include "../../rack-sys/src/param_change_queue.h"
+#include "../../rack-sys/src/spsc_queue.h"
+#include "../../rack-sys/src/silence_gate.h"
+#include "../../rack-sys/src/sample_convert.h"
+#include "../../rack-sys/src/latency_monitor.h"
+#include "../../rack-sys/src/perf_counters.h"
+#include "../../rack-sys/src/rt_guard.h"
 
 // ============================================================================
 // VST3 Types and Interfaces
@@ -44,7 +55,7 @@ public:
     virtual uint32 release() = 0;
 };
 
-enum { kResultOk = 0, kResultFalse = 1, kNoInterface = -1, kNotImplemented = -2 };
+enum { kResultOk = 0, kResultTrue = kResultOk, kResultFalse = 1, kNoInterface = -1, kNotImplemented = -2 };
 
 struct PClassInfo {
     TUID cid;
@@ -151,6 +162,24 @@ struct BusInfo {
     uint32 flags;
 };
 
+// IBStream {C3BF6EA2-3099-4752-9B6B-F9901EE33E9B}
+// COM bytes: A2 6E BF C3  99 30  52 47  9B 6B F9 90 1E E3 3E 9B
+static const TUID IBStream_iid = {
+    0xA2, 0x6E, 0xBF, 0xC3, 0x99, 0x30, 0x52, 0x47,
+    0x9B, 0x6B, 0xF9, 0x90, 0x1E, 0xE3, 0x3E, 0x9B
+};
+
+// IBStream - what getState()/setState() read and write
+class IBStream : public FUnknown {
+public:
+    enum IStreamSeekMode { kIBSeekSet = 0, kIBSeekCur = 1, kIBSeekEnd = 2 };
+
+    virtual tresult read(void* buffer, int32 numBytes, int32* numBytesRead) = 0;
+    virtual tresult write(void* buffer, int32 numBytes, int32* numBytesWritten) = 0;
+    virtual tresult seek(int64 pos, int32 mode, int64* result) = 0;
+    virtual tresult tell(int64* pos) = 0;
+};
+
 // IComponent
 class IComponent : public IPluginBase {
 public:
@@ -167,7 +196,11 @@ public:
 
 // Speaker arrangements
 typedef uint64 SpeakerArrangement;
-static const SpeakerArrangement kStereo = 0x3;  // L + R
+static const SpeakerArrangement kMono = 1 << 19;  // M
+static const SpeakerArrangement kStereo = 0x3;    // L + R
+
+// Symbolic sample sizes
+enum SymbolicSampleSizes { kSample32 = 0, kSample64 = 1 };
 
 // Process setup
 struct ProcessSetup {
@@ -320,7 +353,38 @@ public:
         return kResultOk;
     }
 
-    void clear() { count = 0; }
+    // Hold back events at or past the end of a block of `frames` samples for
+    // the next block, rebased to it (clients split long buffers into blocks
+    // but queue the whole buffer's MIDI up front). Events that don't fit are
+    // moved onto the block's last frame instead.
+    void defer_late(int32 frames) {
+        int32 kept = 0;
+        for (int32 i = 0; i < count; i++) {
+            Event& e = events[i];
+            if (e.sampleOffset >= frames) {
+                if (deferred_count < MAX_EVENTS) {
+                    deferred[deferred_count] = e;
+                    deferred[deferred_count].sampleOffset -= frames;
+                    deferred_count++;
+                    continue;
+                }
+                e.sampleOffset = frames - 1;
+            }
+            events[kept++] = e;
+        }
+        count = kept;
+    }
+
+    // Drop this block's events; deferred ones become the next block's
+    void clear() {
+        memcpy(events, deferred, deferred_count * sizeof(Event));
+        count = deferred_count;
+        deferred_count = 0;
+    }
+
+private:
+    Event deferred[MAX_EVENTS];
+    int32 deferred_count = 0;
 };
 
 // IAudioProcessor
@@ -337,6 +401,18 @@ public:
     virtual uint32 getTailSamples() = 0;
 };
 
+// IAudioProcessor::getTailSamples special values
+static const uint32 kNoTail = 0;
+static const uint32 kInfiniteTail = 0xFFFFFFFF;
+
+// IComponentHandler::restartComponent flags
+enum RestartFlags {
+    kReloadComponent = 1 << 0,
+    kIoChanged = 1 << 1,
+    kParamValuesChanged = 1 << 2,
+    kLatencyChanged = 1 << 3
+};
+
 // Parameter info structure
 struct ParameterInfo {
     uint32 id;
@@ -391,6 +467,176 @@ public:
     virtual tresult notify(void* message) = 0;
 };
 
+// ============================================================================
+// Parameter changes and MIDI mapping
+// ============================================================================
+
+static const uint32 kNoParamId = 0xFFFFFFFF;
+
+// IParamValueQueue {01263A18-ED07-4F6F-98C9-D3564686F9BA}
+// COM bytes: 18 3A 26 01  07 ED  6F 4F  98 C9 D3 56 46 86 F9 BA
+static const TUID IParamValueQueue_iid = {
+    0x18, 0x3A, 0x26, 0x01, 0x07, 0xED, 0x6F, 0x4F,
+    0x98, 0xC9, 0xD3, 0x56, 0x46, 0x86, 0xF9, 0xBA
+};
+
+class IParamValueQueue : public FUnknown {
+public:
+    virtual uint32 getParameterId() = 0;
+    virtual int32 getPointCount() = 0;
+    virtual tresult getPoint(int32 index, int32& sampleOffset, double& value) = 0;
+    virtual tresult addPoint(int32 sampleOffset, double value, int32& index) = 0;
+};
+
+// IParameterChanges {A4779663-0BB6-4A56-B443-84A8466FEB9D}
+// COM bytes: 63 96 77 A4  B6 0B  56 4A  B4 43 84 A8 46 6F EB 9D
+static const TUID IParameterChanges_iid = {
+    0x63, 0x96, 0x77, 0xA4, 0xB6, 0x0B, 0x56, 0x4A,
+    0xB4, 0x43, 0x84, 0xA8, 0x46, 0x6F, 0xEB, 0x9D
+};
+
+class IParameterChanges : public FUnknown {
+public:
+    virtual int32 getParameterCount() = 0;
+    virtual IParamValueQueue* getParameterData(int32 index) = 0;
+    virtual IParamValueQueue* addParameterData(const uint32& id, int32& index) = 0;
+};
+
+// IMidiMapping {DF0FF9F7-49B7-4669-B63A-B7327ADBF5E5}
+// COM bytes: F7 F9 0F DF  B7 49  69 46  B6 3A B7 32 7A DB F5 E5
+static const TUID IMidiMapping_iid = {
+    0xF7, 0xF9, 0x0F, 0xDF, 0xB7, 0x49, 0x69, 0x46,
+    0xB6, 0x3A, 0xB7, 0x32, 0x7A, 0xDB, 0xF5, 0xE5
+};
+
+class IMidiMapping : public FUnknown {
+public:
+    virtual tresult getMidiControllerAssignment(int32 busIndex, int16 channel, int16 midiControllerNumber,
+                                                uint32& id) = 0;
+};
+
+// Controller numbers past the 128 CCs
+enum ControllerNumbers {
+    kAfterTouch = 128,      // Channel pressure
+    kPitchBend = 129,
+    kCountCtrlNumber = 130
+};
+
+// Parameter change list for one process() call, in fixed arrays so the
+// audio thread never allocates. Points of a queue are kept ordered by
+// sample offset, as VST3 requires.
+#define MAX_PARAM_QUEUES 256
+#define MAX_QUEUE_POINTS 32
+
+class HostParamValueQueue : public IParamValueQueue {
+public:
+    uint32 id = kNoParamId;
+    int32 count = 0;
+    bool sync_controller = false;   // Pass the final value on to the edit controller
+    int32 offsets[MAX_QUEUE_POINTS];
+    double values[MAX_QUEUE_POINTS];
+
+    tresult queryInterface(const TUID& iid, void** obj) override {
+        if (memcmp(iid.data, IParamValueQueue_iid.data, sizeof(TUID)) == 0 ||
+            memcmp(iid.data, FUnknown_iid.data, sizeof(TUID)) == 0) {
+            *obj = this;
+            return kResultOk;
+        }
+        *obj = nullptr;
+        return kNoInterface;
+    }
+    uint32 addRef() override { return 1; }
+    uint32 release() override { return 1; }
+
+    uint32 getParameterId() override { return id; }
+    int32 getPointCount() override { return count; }
+
+    tresult getPoint(int32 index, int32& sampleOffset, double& value) override {
+        if (index < 0 || index >= count) return kResultFalse;
+        sampleOffset = offsets[index];
+        value = values[index];
+        return kResultOk;
+    }
+
+    // A point at an existing offset replaces it. When the queue is full a
+    // new last point replaces the last one, so the final value survives.
+    tresult addPoint(int32 sampleOffset, double value, int32& index) override {
+        int32 pos = count;
+        while (pos > 0 && offsets[pos - 1] > sampleOffset) pos--;
+        if (pos > 0 && offsets[pos - 1] == sampleOffset) {
+            values[pos - 1] = value;
+            index = pos - 1;
+            return kResultOk;
+        }
+        if (count >= MAX_QUEUE_POINTS) {
+            if (pos < count) return kResultFalse;
+            offsets[count - 1] = sampleOffset;
+            values[count - 1] = value;
+            index = count - 1;
+            return kResultOk;
+        }
+        memmove(&offsets[pos + 1], &offsets[pos], (count - pos) * sizeof(int32));
+        memmove(&values[pos + 1], &values[pos], (count - pos) * sizeof(double));
+        offsets[pos] = sampleOffset;
+        values[pos] = value;
+        count++;
+        index = pos;
+        return kResultOk;
+    }
+};
+
+class HostParameterChanges : public IParameterChanges {
+public:
+    HostParamValueQueue queues[MAX_PARAM_QUEUES];
+    int32 count = 0;
+
+    tresult queryInterface(const TUID& iid, void** obj) override {
+        if (memcmp(iid.data, IParameterChanges_iid.data, sizeof(TUID)) == 0 ||
+            memcmp(iid.data, FUnknown_iid.data, sizeof(TUID)) == 0) {
+            *obj = this;
+            return kResultOk;
+        }
+        *obj = nullptr;
+        return kNoInterface;
+    }
+    uint32 addRef() override { return 1; }
+    uint32 release() override { return 1; }
+
+    int32 getParameterCount() override { return count; }
+
+    IParamValueQueue* getParameterData(int32 index) override {
+        return (index >= 0 && index < count) ? &queues[index] : nullptr;
+    }
+
+    IParamValueQueue* addParameterData(const uint32& id, int32& index) override {
+        for (int32 i = 0; i < count; i++) {
+            if (queues[i].id == id) {
+                index = i;
+                return &queues[i];
+            }
+        }
+        if (count >= MAX_PARAM_QUEUES) return nullptr;
+        queues[count].id = id;
+        queues[count].count = 0;
+        queues[count].sync_controller = false;
+        index = count;
+        return &queues[count++];
+    }
+
+    // Add a point, creating the parameter's queue. Returns false if full.
+    bool add(uint32 id, int32 sampleOffset, double value, bool sync_controller) {
+        int32 index = 0;
+        HostParamValueQueue* queue = static_cast<HostParamValueQueue*>(addParameterData(id, index));
+        if (!queue || queue->addPoint(sampleOffset, value, index) != kResultOk) return false;
+        queue->sync_controller |= sync_controller;
+        return true;
+    }
+
+    bool full() const { return count >= MAX_PARAM_QUEUES; }
+
+    void clear() { count = 0; }
+};
+
 // ============================================================================
 // GUI interfaces
 // ============================================================================
@@ -500,17 +746,25 @@ struct ParamChange {
     double value;
 };
 
-// Maximum pending parameter changes
-static const int MAX_PARAM_CHANGES = 256;
+// Parameters with a pending GUI change (edits to the same ID coalesce)
+static const size_t MAX_PARAM_CHANGES = 1024;
+
+typedef rack::ParamChangeQueue<MAX_PARAM_CHANGES> ParamChangeQueue;
 
 // Host implementation of IComponentHandler
 // Captures parameter changes from the plugin GUI
 class HostComponentHandler : public IComponentHandler {
 public:
-    // Circular buffer for parameter changes
-    ParamChange changes[MAX_PARAM_CHANGES];
-    volatile int write_index = 0;
-    volatile int read_index = 0;
+    // Lock-free, multi-producer queue bound per slot at load time (kept
+    // outside PluginState so slots can be reset by assignment)
+    ParamChangeQueue* changes = nullptr;
+
+    // The slot's values pending for the processor, bound the same way
+    ParamChangeQueue* processor_changes = nullptr;
+
+    // Latency monitors of the slot and of the whole chain, bound the same way
+    rack::LatencyMonitor* latency = nullptr;
+    rack::LatencyMonitor* chain_latency = nullptr;
 
     tresult queryInterface(const TUID& iid, void** obj) override {
         if (memcmp(iid.data, IComponentHandler_iid.data, sizeof(TUID)) == 0) {
@@ -535,14 +789,11 @@ public:
     }
 
     tresult performEdit(uint32 id, double valueNormalized) override {
-        // Called when parameter value changes in GUI
-        // Store in circular buffer
-        int next = (write_index + 1) % MAX_PARAM_CHANGES;
-        if (next != read_index) {  // Don't overflow
-            changes[write_index].param_id = id;
-            changes[write_index].value = valueNormalized;
-            write_index = next;
-        }
+        // Called when parameter value changes in GUI (possibly from several
+        // plugin threads); last value per parameter wins. The host owns
+        // delivering the edit to the processor.
+        if (changes) changes->push(id, valueNormalized);
+        if (processor_changes) processor_changes->push(id, valueNormalized);
         return kResultOk;
     }
 
@@ -552,30 +803,110 @@ public:
     }
 
     tresult restartComponent(int32 flags) override {
-        // Plugin requests host to restart (e.g., after latency change)
+        // Plugin requests host to restart. Only latency changes are handled:
+        // the values are re-queried on the next CMD_GET_LATENCY.
+        if (flags & kLatencyChanged) {
+            if (latency) latency->mark_changed();
+            if (chain_latency) chain_latency->mark_changed();
+        }
         return kResultOk;
     }
 
     // Get pending changes count
     int getPendingCount() const {
-        int w = write_index;
-        int r = read_index;
-        if (w >= r) return w - r;
-        return MAX_PARAM_CHANGES - r + w;
+        return changes ? (int)changes->pending_count() : 0;
     }
 
     // Get next pending change, returns false if none
     bool getNextChange(ParamChange* out) {
-        if (read_index == write_index) return false;
-        *out = changes[read_index];
-        read_index = (read_index + 1) % MAX_PARAM_CHANGES;
-        return true;
+        return changes && changes->pop(&out->param_id, &out->value);
     }
 
     // Clear all pending changes
     void clear() {
-        read_index = write_index;
+        if (changes) changes->clear();
+    }
+
+    // Number of changes dropped because the queue was full
+    uint64_t getOverflowCount() const {
+        return changes ? changes->overflow_count() : 0;
+    }
+};
+
+// IBStream over a window of the state transfer region, read and written in
+// place. Writes past the window are dropped but still counted, so a state
+// that does not fit is measured in full and the client can retry once with
+// a large enough region.
+class ShmStateStream : public IBStream {
+public:
+    // `size` bytes of the window hold data already (the state to read)
+    ShmStateStream(uint8* data, uint64 capacity, uint64 size)
+        : data_(data), capacity_(capacity), size_(size) {}
+
+    tresult queryInterface(const TUID& iid, void** obj) override {
+        if (memcmp(iid.data, IBStream_iid.data, sizeof(TUID)) == 0 ||
+            memcmp(iid.data, FUnknown_iid.data, sizeof(TUID)) == 0) {
+            *obj = static_cast<IBStream*>(this);
+            return kResultOk;
+        }
+        *obj = nullptr;
+        return kNoInterface;
+    }
+    uint32 addRef() override { return 1; }  // Lives for one command
+    uint32 release() override { return 1; }
+
+    tresult read(void* buffer, int32 numBytes, int32* numBytesRead) override {
+        if (!buffer || numBytes < 0) return kResultFalse;
+        uint64 end = size_ < capacity_ ? size_ : capacity_;
+        uint64 available = position_ < end ? end - position_ : 0;
+        uint64 count = (uint64)numBytes < available ? (uint64)numBytes : available;
+        if (count > 0) {
+            memcpy(buffer, data_ + position_, count);
+            position_ += count;
+        }
+        if (numBytesRead) *numBytesRead = (int32)count;
+        return count == (uint64)numBytes ? kResultOk : kResultFalse;
+    }
+
+    tresult write(void* buffer, int32 numBytes, int32* numBytesWritten) override {
+        if (!buffer || numBytes < 0) return kResultFalse;
+        uint64 end = position_ + (uint64)numBytes;
+        if (position_ < capacity_) {
+            uint64 count = end <= capacity_ ? (uint64)numBytes : capacity_ - position_;
+            memcpy(data_ + position_, buffer, count);
+        }
+        position_ = end;
+        if (end > size_) size_ = end;
+        if (numBytesWritten) *numBytesWritten = numBytes;
+        return kResultOk;
+    }
+
+    tresult seek(int64 pos, int32 mode, int64* result) override {
+        if (mode < kIBSeekSet || mode > kIBSeekEnd) return kResultFalse;
+        int64 base = mode == kIBSeekSet ? 0 : (mode == kIBSeekCur ? (int64)position_ : (int64)size_);
+        int64 target = base + pos;
+        if (target < 0) target = 0;
+        if ((uint64)target > size_) target = (int64)size_;
+        position_ = (uint64)target;
+        if (result) *result = target;
+        return kResultOk;
     }
+
+    tresult tell(int64* pos) override {
+        if (!pos) return kResultFalse;
+        *pos = (int64)position_;
+        return kResultOk;
+    }
+
+    // Bytes written (or readable), including any that did not fit
+    uint64 size() const { return size_; }
+    bool overflowed() const { return size_ > capacity_; }
+
+private:
+    uint8* data_;
+    uint64 capacity_;
+    uint64 size_;
+    uint64 position_ = 0;
 };
 
 } // namespace Steinberg
@@ -599,8 +930,6 @@ struct PluginState {
     Steinberg::IComponent* component = nullptr;
     Steinberg::IAudioProcessor* processor = nullptr;
     Steinberg::IEditController* controller = nullptr;
-    InitModuleProc initModule = nullptr;
-    ExitModuleProc exitModule = nullptr;
 
     char name[256] = {0};
     char vendor[256] = {0};
@@ -614,6 +943,13 @@ struct PluginState {
     uint32_t block_size = 512;
     uint32_t num_inputs = 2;
     uint32_t num_outputs = 2;
+    bool process64 = false;   // Set up for kSample64 (F64 shm format only)
+
+    // Channels of the main audio buses as the plugin declares them at load
+    // (0: no such bus), reported by CMD_GET_INFO so clients can size their
+    // shared memory to match
+    uint32_t bus_inputs = 2;
+    uint32_t bus_outputs = 2;
 
     // Editor state
     Steinberg::IPlugView* view = nullptr;
@@ -623,18 +959,143 @@ struct PluginState {
 
     // Component handler for parameter change notifications from GUI
     Steinberg::HostComponentHandler componentHandler;
+
+    // The edit controller is its own object (created from the controller
+    // class ID) and keeps its own state
+    bool separate_controller = false;
+
+    // Event lists for MIDI
+    Steinberg::HostEventList inputEvents;
+    Steinberg::HostEventList outputEvents;
+
+    // Parameter each [channel][CC / kAfterTouch / kPitchBend] is mapped to
+    // through IMidiMapping (kNoParamId: unmapped), cached at load
+    bool has_midi_mapping = false;
+    Steinberg::uint32 midi_params[16][Steinberg::kCountCtrlNumber];
+};
+
+// Shared audio configuration for all slots of an instance
+struct AudioConfig {
+    bool active = false;
+    uint32_t sample_rate = 48000;
+    uint32_t block_size = 512;
+    uint32_t num_inputs = 2;
+    uint32_t num_outputs = 2;
+    uint32_t pipeline_depth = 1;   // Block slots in the shm ring
+    int32_t process_mode = 0;      // ProcessSetup/ProcessData processMode
+    uint32_t slot_stride = 0;      // Bytes between block slots
+    uint32_t sample_format = RACK_WINE_SAMPLE_F32;  // Format of the shm buffers
+    uint32_t events_offset = 0;    // In-band event blocks (0: none)
+};
+
+// Grow-only byte buffer. The receive loop and the response builders each
+// keep one for the whole session, so steady-state control traffic does not
+// allocate.
+struct ByteBuffer {
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+// ============================================================================
+// Instance State
+// ============================================================================
+
+// Everything one client connection owns. The host serves any number of
+// connections at once, each with its own slots, shared memory and audio
+// thread; only loaded modules and the editor window class are shared.
+struct HostInstance {
+    // Plugin slots. Control commands address the slot picked by
+    // CMD_SELECT_SLOT (slot 0 by default); the audio path walks the chain
+    // over all slots.
+    PluginState slots[RACK_WINE_MAX_SLOTS];
+    uint32_t current_slot = 0;
+    PluginState* plugin = &slots[0];
+
+    // GUI parameter change queues, one per slot
+    Steinberg::ParamChangeQueue param_changes[RACK_WINE_MAX_SLOTS];
+
+    // Idle sleep state and block counters, one per slot
+    rack::SilenceGate silence_gates[RACK_WINE_MAX_SLOTS];
+
+    // Reported latency and tail, one per slot and one for the whole chain.
+    // The chain generation is published in the shm header after every block.
+    rack::LatencyMonitor latency[RACK_WINE_MAX_SLOTS];
+    rack::LatencyMonitor chain_latency;
+
+    // Processing statistics, one per slot (CMD_GET_STATS). GUI change
+    // overflows are reported relative to the count at the last reset.
+    rack::PerfCounters perf[RACK_WINE_MAX_SLOTS];
+    uint64_t param_overflow_base[RACK_WINE_MAX_SLOTS] = {0};
+
+    // Values bound for each slot's processor (CMD_SET_PARAM, mapped MIDI
+    // sent with CMD_SEND_MIDI, GUI edits), delivered at offset 0 of its next
+    // block
+    Steinberg::ParamChangeQueue processor_params[RACK_WINE_MAX_SLOTS];
+
+    // Note events sent with CMD_SEND_MIDI, one ring per slot: pushed by the
+    // control thread, drained into the slot's event list by whichever thread
+    // runs its next block
+    rack::SpscQueue<MidiEvent, MAX_EVENTS> socket_midi[RACK_WINE_MAX_SLOTS];
+
+    // In-band parameter values the processors received, for the control
+    // thread to pass on to each slot's edit controller
+    Steinberg::ParamChangeQueue controller_sync[RACK_WINE_MAX_SLOTS];
+
+    // Parameter changes of the process() call being made (one slot at a time)
+    Steinberg::HostParameterChanges input_params;
+
+    // Event area of the block being processed, null without one
+    const RackWineShmEventBlock* block_events = nullptr;
+
+    AudioConfig audio;
+
+    // Processing chain: each stage is a bitmask of slots that run in
+    // parallel on the previous stage's output and are summed. 0 stages means
+    // every loaded slot in index order, one stage each.
+    uint32_t chain[RACK_WINE_MAX_SLOTS] = {0};
+    uint32_t chain_stages = 0;
+
+    // Intermediate buffers kept inside the host: two ping-pong stage buffers
+    // and one branch buffer for parallel stages, in the shm sample format,
+    // sized for the configured channel counts. With F64, convert_ptrs are
+    // float input/output copies for 32-bit-only plugins.
+    float* scratch = nullptr;
+    double* scratch64 = nullptr;
+    float* scratch_ptrs[3][RACK_WINE_MAX_CHANNELS] = {};
+    double* scratch_ptrs64[3][RACK_WINE_MAX_CHANNELS] = {};
+    float* convert_ptrs[2][RACK_WINE_MAX_CHANNELS] = {};
+
+    // Shared memory state
+    HANDLE shm_handle = nullptr;
+    void* shm_ptr = nullptr;
+    size_t shm_size = 0;
+
+    // Realtime doorbell state
+    HANDLE rt_thread = nullptr;
+    volatile LONG rt_stop = 0;
+
+
+    ByteBuffer rx_buffer;   // Payload of the message being handled
+    ByteBuffer tx_buffer;   // Response payload built by control commands
+
+    // State transfer region (CMD_SET_STATE_REGION)
+    HANDLE state_handle = nullptr;
+    uint8_t* state_ptr = nullptr;
+    uint64_t state_size = 0;
+
 };
 
-static PluginState g_plugin;
+// Instance served by the calling thread: set by each connection thread and
+// by the audio thread it starts
+static thread_local HostInstance* g_instance = nullptr;
 
-// Shared memory state
-static HANDLE g_shm_handle = nullptr;
-static void* g_shm_ptr = nullptr;
-static size_t g_shm_size = 0;
+// Process-wide state
+static bool g_have_futex = false;
 
-// Event list for MIDI
-static Steinberg::HostEventList g_input_events;
-static Steinberg::HostEventList g_output_events;
+// Guards the module table and the editor window class registration, which
+// every connection shares
+static CRITICAL_SECTION g_host_lock;
 
 // ============================================================================
 // Helpers
@@ -679,78 +1140,315 @@ bool find_vst3_dll(const char* bundle_path, char* dll_path, size_t dll_path_size
     return false;
 }
 
+// ============================================================================
+// Module Table
+// ============================================================================
+
+// Plugin DLLs loaded by any instance. LoadLibrary reference counts the
+// module already; the table makes InitDll/ExitDll run once per process
+// rather than once per load, so one instance unloading a plugin does not
+// pull the module out from under another.
+struct LoadedModule {
+    HMODULE module = nullptr;
+    ExitModuleProc exitModule = nullptr;
+    uint32_t refs = 0;
+};
+
+static const uint32_t MAX_MODULES = 256;
+static LoadedModule g_modules[MAX_MODULES];
+
+// Load a plugin DLL, running InitDll for its first user. Returns nullptr
+// (after logging why) on failure.
+static HMODULE acquire_module(const char* dll_path) {
+    HMODULE module = LoadLibraryA(dll_path);
+    if (!module) {
+        printf("[HOST] ERROR: LoadLibrary failed (%lu)\n", GetLastError());
+        return nullptr;
+    }
+    if (!GetProcAddress(module, "GetPluginFactory")) {
+        printf("[HOST] ERROR: GetPluginFactory not found\n");
+        FreeLibrary(module);
+        return nullptr;
+    }
+
+    EnterCriticalSection(&g_host_lock);
+    LoadedModule* entry = nullptr;
+    LoadedModule* unused = nullptr;
+    for (uint32_t i = 0; i < MAX_MODULES && !entry; i++) {
+        if (g_modules[i].refs > 0 && g_modules[i].module == module) {
+            entry = &g_modules[i];
+        } else if (g_modules[i].refs == 0 && !unused) {
+            unused = &g_modules[i];
+        }
+    }
+    if (!entry) {
+        if (!unused) {
+            LeaveCriticalSection(&g_host_lock);
+            printf("[HOST] ERROR: Too many plugin modules loaded\n");
+            FreeLibrary(module);
+            return nullptr;
+        }
+        entry = unused;
+        entry->module = module;
+        entry->exitModule = (ExitModuleProc)GetProcAddress(module, "ExitDll");
+        InitModuleProc initModule = (InitModuleProc)GetProcAddress(module, "InitDll");
+        if (initModule) {
+            initModule();
+        }
+    }
+    entry->refs++;
+    LeaveCriticalSection(&g_host_lock);
+    return module;
+}
+
+// Drop a reference from acquire_module, running ExitDll for the last user
+static void release_module(HMODULE module) {
+    EnterCriticalSection(&g_host_lock);
+    for (uint32_t i = 0; i < MAX_MODULES; i++) {
+        LoadedModule& entry = g_modules[i];
+        if (entry.refs > 0 && entry.module == module) {
+            if (--entry.refs == 0) {
+                if (entry.exitModule) entry.exitModule();
+                entry = LoadedModule();
+            }
+            break;
+        }
+    }
+    LeaveCriticalSection(&g_host_lock);
+    FreeLibrary(module);
+}
+
 // ============================================================================
 // Plugin Operations
 // ============================================================================
 
-void cleanup_audio() {
-    if (g_plugin.processing && g_plugin.processor) {
-        g_plugin.processor->setProcessing(0);
-        g_plugin.processing = false;
+void stop_realtime();                      // Forward declaration
+void resume_realtime(bool was_running);    // Forward declaration
+
+// Generic arrangement for a channel count: mono, or the first speakers of
+// the VST3 speaker order (L R C Lfe Ls Rs ...)
+static Steinberg::SpeakerArrangement speaker_arrangement(uint32_t channels) {
+    if (channels == 1) return Steinberg::kMono;
+    if (channels >= 64) return ~Steinberg::SpeakerArrangement(0);
+    return (Steinberg::SpeakerArrangement(1) << channels) - 1;
+}
+
+// Channel count of the component's first audio bus in `dir`, 0 if it has none
+static uint32_t main_bus_channels(Steinberg::IComponent* component, Steinberg::BusDirection dir) {
+    if (component->getBusCount(Steinberg::kAudio, dir) <= 0) return 0;
+    Steinberg::BusInfo info;
+    memset(&info, 0, sizeof(info));
+    if (component->getBusInfo(Steinberg::kAudio, dir, 0, info) != Steinberg::kResultOk || info.channelCount < 0) {
+        return 2;
+    }
+    uint32_t channels = (uint32_t)info.channelCount;
+    return channels > RACK_WINE_MAX_CHANNELS ? RACK_WINE_MAX_CHANNELS : channels;
+}
+
+bool activate_slot(PluginState* slot) {
+    if (!slot->loaded || !slot->component) return false;
+
+    slot->sample_rate = g_instance->audio.sample_rate;
+    slot->block_size = g_instance->audio.block_size;
+    slot->num_inputs = g_instance->audio.num_inputs;
+    slot->num_outputs = g_instance->audio.num_outputs;
+
+    // Match the main buses to the configured channel counts; a plugin that
+    // refuses keeps its own layout and copy_channels pads or drops the rest
+    bool has_input = slot->component->getBusCount(Steinberg::kAudio, Steinberg::kInput) > 0;
+    bool has_output = slot->component->getBusCount(Steinberg::kAudio, Steinberg::kOutput) > 0;
+    if (slot->processor) {
+        Steinberg::SpeakerArrangement inArr = speaker_arrangement(slot->num_inputs);
+        Steinberg::SpeakerArrangement outArr = speaker_arrangement(slot->num_outputs);
+        Steinberg::tresult r = slot->processor->setBusArrangements(&inArr, has_input ? 1 : 0, &outArr,
+                                                                   has_output ? 1 : 0);
+        if (r != Steinberg::kResultOk) {
+            printf("[HOST] WARNING: Plugin rejected %u in / %u out bus arrangement\n", slot->num_inputs,
+                   slot->num_outputs);
+        }
+    }
+
+    // Activate buses
+    if (has_input) slot->component->activateBus(Steinberg::kAudio, Steinberg::kInput, 0, 1);
+    if (has_output) slot->component->activateBus(Steinberg::kAudio, Steinberg::kOutput, 0, 1);
+
+    // Setup processing, at 64 bits when the shm carries doubles and the
+    // plugin supports it
+    slot->process64 = false;
+    if (slot->processor) {
+        slot->process64 = g_instance->audio.sample_format == RACK_WINE_SAMPLE_F64 &&
+            slot->processor->canProcessSampleSize(Steinberg::kSample64) == Steinberg::kResultTrue;
+
+        Steinberg::ProcessSetup setup;
+        setup.processMode = g_instance->audio.process_mode;
+        setup.symbolicSampleSize = slot->process64 ? Steinberg::kSample64 : Steinberg::kSample32;
+        setup.maxSamplesPerBlock = g_instance->audio.block_size;
+        setup.sampleRate = g_instance->audio.sample_rate;
+
+        Steinberg::tresult r = slot->processor->setupProcessing(setup);
+        printf("[HOST] setupProcessing result=%d (%d-bit)\n", r, slot->process64 ? 64 : 32);
+    }
+
+    // Activate
+    Steinberg::tresult r = slot->component->setActive(1);
+    printf("[HOST] setActive result=%d\n", r);
+    slot->initialized = true;
+
+    // Start processing
+    if (slot->processor) {
+        r = slot->processor->setProcessing(1);
+        printf("[HOST] setProcessing result=%d\n", r);
+    }
+    slot->processing = true;
+    g_instance->silence_gates[slot - g_instance->slots].wake();
+
+    // setupProcessing may change the latency
+    g_instance->chain_latency.mark_changed();
+    return true;
+}
+
+void deactivate_slot(PluginState* slot) {
+    if (slot->processing && slot->processor) {
+        slot->processor->setProcessing(0);
+    }
+    slot->processing = false;
+
+    if (slot->initialized && slot->component) {
+        slot->component->setActive(0);
+        slot->initialized = false;
     }
+}
+
+void cleanup_audio() {
+    stop_realtime();
 
-    if (g_plugin.initialized && g_plugin.component) {
-        g_plugin.component->setActive(0);
-        g_plugin.initialized = false;
+    for (uint32_t i = 0; i < RACK_WINE_MAX_SLOTS; i++) {
+        deactivate_slot(&g_instance->slots[i]);
     }
+    g_instance->audio.active = false;
 
-    if (g_shm_ptr) {
-        UnmapViewOfFile(g_shm_ptr);
-        g_shm_ptr = nullptr;
+    if (g_instance->shm_ptr) {
+        UnmapViewOfFile(g_instance->shm_ptr);
+        g_instance->shm_ptr = nullptr;
     }
-    if (g_shm_handle) {
-        CloseHandle(g_shm_handle);
-        g_shm_handle = nullptr;
+    if (g_instance->shm_handle) {
+        CloseHandle(g_instance->shm_handle);
+        g_instance->shm_handle = nullptr;
     }
-    g_shm_size = 0;
+    g_instance->shm_size = 0;
+
+    delete[] g_instance->scratch;
+    g_instance->scratch = nullptr;
+    delete[] g_instance->scratch64;
+    g_instance->scratch64 = nullptr;
+}
+
+bool any_slot_loaded() {
+    for (uint32_t i = 0; i < RACK_WINE_MAX_SLOTS; i++) {
+        if (g_instance->slots[i].loaded) return true;
+    }
+    return false;
 }
 
 void unload_plugin();  // Forward declaration
 void close_editor();   // Forward declaration
 
 void unload_plugin() {
-    if (!g_plugin.loaded) return;
+    if (!g_instance->plugin->loaded) return;
 
     printf("[HOST] Unloading plugin\n");
 
     // Close editor first
     close_editor();
 
-    cleanup_audio();
+    deactivate_slot(g_instance->plugin);
 
-    if (g_plugin.controller) {
-        g_plugin.controller->terminate();
-        g_plugin.controller->release();
-        g_plugin.controller = nullptr;
+    if (g_instance->plugin->controller) {
+        g_instance->plugin->controller->terminate();
+        g_instance->plugin->controller->release();
+        g_instance->plugin->controller = nullptr;
+    }
+    if (g_instance->plugin->processor) {
+        g_instance->plugin->processor->release();
+        g_instance->plugin->processor = nullptr;
+    }
+    if (g_instance->plugin->component) {
+        g_instance->plugin->component->terminate();
+        g_instance->plugin->component->release();
+        g_instance->plugin->component = nullptr;
     }
-    if (g_plugin.processor) {
-        g_plugin.processor->release();
-        g_plugin.processor = nullptr;
+    if (g_instance->plugin->factory2) {
+        g_instance->plugin->factory2->release();
+        g_instance->plugin->factory2 = nullptr;
     }
-    if (g_plugin.component) {
-        g_plugin.component->terminate();
-        g_plugin.component->release();
-        g_plugin.component = nullptr;
+    if (g_instance->plugin->factory) {
+        g_instance->plugin->factory->release();
+        g_instance->plugin->factory = nullptr;
     }
-    if (g_plugin.factory2) {
-        g_plugin.factory2->release();
-        g_plugin.factory2 = nullptr;
+    if (g_instance->plugin->module) {
+        release_module(g_instance->plugin->module);
+        g_instance->plugin->module = nullptr;
     }
-    if (g_plugin.factory) {
-        g_plugin.factory->release();
-        g_plugin.factory = nullptr;
+
+    *g_instance->plugin = PluginState();
+    g_instance->silence_gates[g_instance->current_slot].reset();
+    g_instance->perf[g_instance->current_slot].reset();
+    g_instance->socket_midi[g_instance->current_slot].clear();
+    g_instance->param_overflow_base[g_instance->current_slot] = g_instance->param_changes[g_instance->current_slot].overflow_count();
+
+    // Drop the slot from any explicit chain
+    for (uint32_t i = 0; i < g_instance->chain_stages; i++) {
+        g_instance->chain[i] &= ~(1u << g_instance->current_slot);
+    }
+    g_instance->latency[g_instance->current_slot].update(0, 0);
+    g_instance->chain_latency.mark_changed();
+
+    // Last plugin gone: release shared memory like a single-plugin host
+    if (!any_slot_loaded()) {
+        cleanup_audio();
     }
-    if (g_plugin.exitModule) g_plugin.exitModule();
-    if (g_plugin.module) {
-        FreeLibrary(g_plugin.module);
-        g_plugin.module = nullptr;
+}
+
+void unload_all_plugins() {
+    uint32_t selected = g_instance->current_slot;
+    for (uint32_t i = 0; i < RACK_WINE_MAX_SLOTS; i++) {
+        g_instance->current_slot = i;
+        g_instance->plugin = &g_instance->slots[i];
+        unload_plugin();
     }
+    g_instance->current_slot = selected;
+    g_instance->plugin = &g_instance->slots[selected];
+    g_instance->chain_stages = 0;
+}
 
-    g_plugin = PluginState();
+// Cache the slot's IMidiMapping assignments (CC, channel pressure and pitch
+// bend to parameters) so the audio path never calls into the controller
+static void load_midi_mapping(PluginState* slot) {
+    Steinberg::IMidiMapping* mapping = nullptr;
+    slot->controller->queryInterface(Steinberg::IMidiMapping_iid, (void**)&mapping);
+    if (!mapping) {
+        return;
+    }
+
+    int mapped = 0;
+    for (int ch = 0; ch < 16; ch++) {
+        for (int ctrl = 0; ctrl < Steinberg::kCountCtrlNumber; ctrl++) {
+            Steinberg::uint32 id = Steinberg::kNoParamId;
+            if (mapping->getMidiControllerAssignment(0, (Steinberg::int16)ch, (Steinberg::int16)ctrl, id) !=
+                Steinberg::kResultOk) {
+                id = Steinberg::kNoParamId;
+            }
+            slot->midi_params[ch][ctrl] = id;
+            if (id != Steinberg::kNoParamId) mapped++;
+        }
+    }
+    mapping->release();
+    slot->has_midi_mapping = mapped > 0;
+    printf("[HOST] MIDI mapping: %d controller assignments\n", mapped);
 }
 
 bool load_plugin(const char* path, uint32_t class_index) {
-    if (g_plugin.loaded) {
+    if (g_instance->plugin->loaded) {
         unload_plugin();
     }
 
@@ -764,58 +1462,42 @@ bool load_plugin(const char* path, uint32_t class_index) {
 
     printf("[HOST] DLL path: %s\n", dll_path);
 
-    g_plugin.module = LoadLibraryA(dll_path);
-    if (!g_plugin.module) {
-        printf("[HOST] ERROR: LoadLibrary failed (%lu)\n", GetLastError());
-        return false;
-    }
-
-    g_plugin.initModule = (InitModuleProc)GetProcAddress(g_plugin.module, "InitDll");
-    g_plugin.exitModule = (ExitModuleProc)GetProcAddress(g_plugin.module, "ExitDll");
-    GetFactoryProc getFactory = (GetFactoryProc)GetProcAddress(g_plugin.module, "GetPluginFactory");
-
-    if (!getFactory) {
-        printf("[HOST] ERROR: GetPluginFactory not found\n");
-        FreeLibrary(g_plugin.module);
-        g_plugin.module = nullptr;
+    g_instance->plugin->module = acquire_module(dll_path);
+    if (!g_instance->plugin->module) {
         return false;
     }
 
-    if (g_plugin.initModule) {
-        g_plugin.initModule();
-    }
-
-    g_plugin.factory = getFactory();
-    if (!g_plugin.factory) {
+    GetFactoryProc getFactory = (GetFactoryProc)GetProcAddress(g_instance->plugin->module, "GetPluginFactory");
+    g_instance->plugin->factory = getFactory();
+    if (!g_instance->plugin->factory) {
         printf("[HOST] ERROR: Factory is null\n");
-        if (g_plugin.exitModule) g_plugin.exitModule();
-        FreeLibrary(g_plugin.module);
-        g_plugin.module = nullptr;
+        release_module(g_instance->plugin->module);
+        g_instance->plugin->module = nullptr;
         return false;
     }
 
-    g_plugin.factory->queryInterface(Steinberg::IPluginFactory2_iid, (void**)&g_plugin.factory2);
+    g_instance->plugin->factory->queryInterface(Steinberg::IPluginFactory2_iid, (void**)&g_instance->plugin->factory2);
 
     Steinberg::PFactoryInfo factory_info;
-    if (g_plugin.factory->getFactoryInfo(&factory_info) == Steinberg::kResultOk) {
-        strncpy(g_plugin.vendor, factory_info.vendor, sizeof(g_plugin.vendor) - 1);
+    if (g_instance->plugin->factory->getFactoryInfo(&factory_info) == Steinberg::kResultOk) {
+        strncpy(g_instance->plugin->vendor, factory_info.vendor, sizeof(g_instance->plugin->vendor) - 1);
     }
 
-    g_plugin.num_classes = g_plugin.factory->countClasses();
-    printf("[HOST] Found %d classes\n", g_plugin.num_classes);
+    g_instance->plugin->num_classes = g_instance->plugin->factory->countClasses();
+    printf("[HOST] Found %d classes\n", g_instance->plugin->num_classes);
 
     // Find the Audio Module Class (processor)
     bool found = false;
-    for (int32_t i = 0; i < g_plugin.num_classes && !found; i++) {
+    for (int32_t i = 0; i < g_instance->plugin->num_classes && !found; i++) {
         Steinberg::PClassInfo info;
-        if (g_plugin.factory->getClassInfo(i, &info) == Steinberg::kResultOk) {
+        if (g_instance->plugin->factory->getClassInfo(i, &info) == Steinberg::kResultOk) {
             printf("[HOST] Class %d: name='%s', category='%s'\n", i, info.name, info.category);
             if (strcmp(info.category, "Audio Module Class") == 0) {
                 if (class_index == 0) {
-                    memcpy(&g_plugin.cid, &info.cid, sizeof(Steinberg::TUID));
-                    strncpy(g_plugin.name, info.name, sizeof(g_plugin.name) - 1);
-                    strncpy(g_plugin.category, info.category, sizeof(g_plugin.category) - 1);
-                    tuid_to_string(info.cid, g_plugin.uid);
+                    memcpy(&g_instance->plugin->cid, &info.cid, sizeof(Steinberg::TUID));
+                    strncpy(g_instance->plugin->name, info.name, sizeof(g_instance->plugin->name) - 1);
+                    strncpy(g_instance->plugin->category, info.category, sizeof(g_instance->plugin->category) - 1);
+                    tuid_to_string(info.cid, g_instance->plugin->uid);
                     found = true;
                     printf("[HOST] Using class %d: %s\n", i, info.name);
                 }
@@ -832,7 +1514,7 @@ bool load_plugin(const char* path, uint32_t class_index) {
 
     // Create component instance
     Steinberg::FUnknown* unknown = nullptr;
-    Steinberg::tresult result = g_plugin.factory->createInstance(g_plugin.cid, Steinberg::FUnknown_iid,
+    Steinberg::tresult result = g_instance->plugin->factory->createInstance(g_instance->plugin->cid, Steinberg::FUnknown_iid,
                                           (void**)&unknown);
     printf("[HOST] createInstance(FUnknown) result=%d, ptr=%p\n", result, unknown);
 
@@ -843,21 +1525,21 @@ bool load_plugin(const char* path, uint32_t class_index) {
     }
 
     // Get IComponent interface via QueryInterface on the FUnknown
-    result = unknown->queryInterface(Steinberg::IComponent_iid, (void**)&g_plugin.component);
-    printf("[HOST] queryInterface(IComponent) result=%d, ptr=%p\n", result, g_plugin.component);
+    result = unknown->queryInterface(Steinberg::IComponent_iid, (void**)&g_instance->plugin->component);
+    printf("[HOST] queryInterface(IComponent) result=%d, ptr=%p\n", result, g_instance->plugin->component);
 
-    if (result != Steinberg::kResultOk || !g_plugin.component) {
+    if (result != Steinberg::kResultOk || !g_instance->plugin->component) {
         // The object might already be IComponent without needing QueryInterface
         // In VST3, many implementations return the interface directly
         printf("[HOST] QueryInterface failed, trying direct cast\n");
-        g_plugin.component = reinterpret_cast<Steinberg::IComponent*>(unknown);
+        g_instance->plugin->component = reinterpret_cast<Steinberg::IComponent*>(unknown);
     } else {
         // QueryInterface succeeded, release the original FUnknown reference
         unknown->release();
     }
 
     // Initialize component
-    result = g_plugin.component->initialize(nullptr);
+    result = g_instance->plugin->component->initialize(nullptr);
     printf("[HOST] component->initialize() result=%d\n", result);
     if (result != Steinberg::kResultOk) {
         printf("[HOST] ERROR: Failed to initialize component\n");
@@ -865,69 +1547,81 @@ bool load_plugin(const char* path, uint32_t class_index) {
         return false;
     }
 
+    g_instance->plugin->bus_inputs = main_bus_channels(g_instance->plugin->component, Steinberg::kInput);
+    g_instance->plugin->bus_outputs = main_bus_channels(g_instance->plugin->component, Steinberg::kOutput);
+    printf("[HOST] Main buses: %u in, %u out\n", g_instance->plugin->bus_inputs, g_instance->plugin->bus_outputs);
+
     // Get audio processor interface - try via the FUnknown first since that seemed to work
     // The same object typically implements both IComponent and IAudioProcessor
-    Steinberg::FUnknown* component_as_unknown = reinterpret_cast<Steinberg::FUnknown*>(g_plugin.component);
+    Steinberg::FUnknown* component_as_unknown = reinterpret_cast<Steinberg::FUnknown*>(g_instance->plugin->component);
     result = component_as_unknown->queryInterface(Steinberg::IAudioProcessor_iid,
-                                            (void**)&g_plugin.processor);
-    printf("[HOST] queryInterface(IAudioProcessor) result=%d, ptr=%p\n", result, g_plugin.processor);
+                                            (void**)&g_instance->plugin->processor);
+    printf("[HOST] queryInterface(IAudioProcessor) result=%d, ptr=%p\n", result, g_instance->plugin->processor);
 
-    if (result != Steinberg::kResultOk || !g_plugin.processor) {
+    if (result != Steinberg::kResultOk || !g_instance->plugin->processor) {
         // QueryInterface failed - we can still load the plugin but can't do audio processing
         printf("[HOST] WARNING: Could not get IAudioProcessor - audio will be passthrough only\n");
-        g_plugin.processor = nullptr;
+        g_instance->plugin->processor = nullptr;
     }
 
     // Get edit controller interface for parameters
     // First try: QueryInterface (for plugins where controller is same object as component)
     result = component_as_unknown->queryInterface(Steinberg::IEditController_iid,
-                                            (void**)&g_plugin.controller);
-    printf("[HOST] queryInterface(IEditController) result=%d, ptr=%p\n", result, g_plugin.controller);
+                                            (void**)&g_instance->plugin->controller);
+    printf("[HOST] queryInterface(IEditController) result=%d, ptr=%p\n", result, g_instance->plugin->controller);
 
-    if (result != Steinberg::kResultOk || !g_plugin.controller) {
+    if (result != Steinberg::kResultOk || !g_instance->plugin->controller) {
         // Second try: Get controller class ID and create separate instance
         printf("[HOST] Trying to get separate controller class...\n");
         Steinberg::TUID controller_cid;
-        result = g_plugin.component->getControllerClassId(controller_cid);
+        result = g_instance->plugin->component->getControllerClassId(controller_cid);
         printf("[HOST] getControllerClassId result=%d\n", result);
 
         if (result == Steinberg::kResultOk) {
             // Create controller instance
             Steinberg::FUnknown* ctrl_unknown = nullptr;
-            result = g_plugin.factory->createInstance(controller_cid, Steinberg::FUnknown_iid,
+            result = g_instance->plugin->factory->createInstance(controller_cid, Steinberg::FUnknown_iid,
                                                       (void**)&ctrl_unknown);
             printf("[HOST] createInstance(controller) result=%d, ptr=%p\n", result, ctrl_unknown);
 
             if (result == Steinberg::kResultOk && ctrl_unknown) {
                 result = ctrl_unknown->queryInterface(Steinberg::IEditController_iid,
-                                                      (void**)&g_plugin.controller);
+                                                      (void**)&g_instance->plugin->controller);
                 printf("[HOST] queryInterface(IEditController) on controller result=%d, ptr=%p\n",
-                       result, g_plugin.controller);
+                       result, g_instance->plugin->controller);
                 ctrl_unknown->release();
+                g_instance->plugin->separate_controller = g_instance->plugin->controller != nullptr;
             }
         }
 
-        if (!g_plugin.controller) {
+        if (!g_instance->plugin->controller) {
             printf("[HOST] WARNING: Could not get IEditController - parameters not available\n");
         }
     }
 
-    if (g_plugin.controller) {
+    if (g_instance->plugin->controller) {
         // Initialize the controller
-        result = g_plugin.controller->initialize(nullptr);
+        result = g_instance->plugin->controller->initialize(nullptr);
         printf("[HOST] controller->initialize() result=%d\n", result);
         if (result != Steinberg::kResultOk) {
             printf("[HOST] WARNING: Controller initialization failed\n");
         }
 
         // Set component handler to receive parameter change callbacks from GUI
-        result = g_plugin.controller->setComponentHandler(&g_plugin.componentHandler);
+        g_instance->param_changes[g_instance->current_slot].clear();
+        g_instance->processor_params[g_instance->current_slot].clear();
+        g_instance->controller_sync[g_instance->current_slot].clear();
+        g_instance->plugin->componentHandler.changes = &g_instance->param_changes[g_instance->current_slot];
+        g_instance->plugin->componentHandler.processor_changes = &g_instance->processor_params[g_instance->current_slot];
+        g_instance->plugin->componentHandler.latency = &g_instance->latency[g_instance->current_slot];
+        g_instance->plugin->componentHandler.chain_latency = &g_instance->chain_latency;
+        result = g_instance->plugin->controller->setComponentHandler(&g_instance->plugin->componentHandler);
         printf("[HOST] setComponentHandler result=%d\n", result);
 
         // Connect component and controller via IConnectionPoint
         // This is required for separate processor/controller plugins (e.g., JUCE)
-        Steinberg::FUnknown* component_unknown = reinterpret_cast<Steinberg::FUnknown*>(g_plugin.component);
-        Steinberg::FUnknown* controller_unknown = reinterpret_cast<Steinberg::FUnknown*>(g_plugin.controller);
+        Steinberg::FUnknown* component_unknown = reinterpret_cast<Steinberg::FUnknown*>(g_instance->plugin->component);
+        Steinberg::FUnknown* controller_unknown = reinterpret_cast<Steinberg::FUnknown*>(g_instance->plugin->controller);
 
         Steinberg::IConnectionPoint* comp_conn = nullptr;
         Steinberg::IConnectionPoint* ctrl_conn = nullptr;
@@ -941,11 +1635,17 @@ bool load_plugin(const char* path, uint32_t class_index) {
             printf("[HOST] Component/controller connected\n");
         }
 
-        printf("[HOST] Parameters: %d\n", g_plugin.controller->getParameterCount());
+        printf("[HOST] Parameters: %d\n", g_instance->plugin->controller->getParameterCount());
+        load_midi_mapping(g_instance->plugin);
     }
 
-    g_plugin.loaded = true;
-    printf("[HOST] Plugin loaded: %s by %s\n", g_plugin.name, g_plugin.vendor);
+    g_instance->plugin->loaded = true;
+    printf("[HOST] Plugin loaded: %s by %s (slot %u)\n", g_instance->plugin->name, g_instance->plugin->vendor, g_instance->current_slot);
+
+    // Join a running audio setup with the current configuration
+    if (g_instance->audio.active) {
+        activate_slot(g_instance->plugin);
+    }
 
     return true;
 }
@@ -968,48 +1668,50 @@ static LRESULT CALLBACK EditorWndProc(HWND hwnd, UINT msg, WPARAM wParam, LPARAM
     }
 }
 
-// Register editor window class
+// Register the editor window class (once per process, shared by every instance)
 static bool g_editor_class_registered = false;
 static const wchar_t* EDITOR_CLASS_NAME = L"RackWineEditor";
 
 static bool register_editor_class() {
-    if (g_editor_class_registered) return true;
-
-    WNDCLASSEXW wc = {0};
-    wc.cbSize = sizeof(WNDCLASSEXW);
-    wc.style = CS_HREDRAW | CS_VREDRAW;
-    wc.lpfnWndProc = EditorWndProc;
-    wc.hInstance = GetModuleHandle(nullptr);
-    wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
-    wc.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
-    wc.lpszClassName = EDITOR_CLASS_NAME;
-
-    if (!RegisterClassExW(&wc)) {
-        printf("[HOST] ERROR: Failed to register editor window class\n");
-        return false;
+    EnterCriticalSection(&g_host_lock);
+    if (!g_editor_class_registered) {
+        WNDCLASSEXW wc = {0};
+        wc.cbSize = sizeof(WNDCLASSEXW);
+        wc.style = CS_HREDRAW | CS_VREDRAW;
+        wc.lpfnWndProc = EditorWndProc;
+        wc.hInstance = GetModuleHandle(nullptr);
+        wc.hCursor = LoadCursor(nullptr, IDC_ARROW);
+        wc.hbrBackground = (HBRUSH)(COLOR_WINDOW + 1);
+        wc.lpszClassName = EDITOR_CLASS_NAME;
+
+        if (RegisterClassExW(&wc)) {
+            g_editor_class_registered = true;
+        } else {
+            printf("[HOST] ERROR: Failed to register editor window class\n");
+        }
     }
-
-    g_editor_class_registered = true;
-    return true;
+    bool registered = g_editor_class_registered;
+    LeaveCriticalSection(&g_host_lock);
+    return registered;
 }
 
 bool open_editor(RespEditorInfo* resp) {
     memset(resp, 0, sizeof(*resp));
 
-    if (!g_plugin.loaded || !g_plugin.controller) {
+    if (!g_instance->plugin->loaded || !g_instance->plugin->controller) {
         printf("[HOST] ERROR: No plugin loaded or no controller\n");
         return false;
     }
 
-    if (g_plugin.editorOpen) {
+    if (g_instance->plugin->editorOpen) {
         printf("[HOST] Editor already open\n");
         // Return existing window info
-        if (g_plugin.editorHwnd) {
+        if (g_instance->plugin->editorHwnd) {
             // Get X11 window ID from Wine window
             // Wine exposes this through a special property
-            resp->x11_window_id = (uint32_t)(uintptr_t)g_plugin.editorHwnd;
+            resp->x11_window_id = (uint32_t)(uintptr_t)g_instance->plugin->editorHwnd;
             Steinberg::ViewRect rect;
-            if (g_plugin.view && g_plugin.view->getSize(&rect) == Steinberg::kResultOk) {
+            if (g_instance->plugin->view && g_instance->plugin->view->getSize(&rect) == Steinberg::kResultOk) {
                 resp->width = rect.getWidth();
                 resp->height = rect.getHeight();
             }
@@ -1018,7 +1720,7 @@ bool open_editor(RespEditorInfo* resp) {
     }
 
     // Create the view
-    void* rawView = g_plugin.controller->createView("editor");
+    void* rawView = g_instance->plugin->controller->createView("editor");
     if (!rawView) {
         printf("[HOST] ERROR: createView returned null\n");
         return false;
@@ -1027,8 +1729,8 @@ bool open_editor(RespEditorInfo* resp) {
     // Query for IPlugView interface
     Steinberg::FUnknown* viewUnknown = reinterpret_cast<Steinberg::FUnknown*>(rawView);
     Steinberg::tresult result = viewUnknown->queryInterface(Steinberg::IPlugView_iid,
-                                                            (void**)&g_plugin.view);
-    if (result != Steinberg::kResultOk || !g_plugin.view) {
+                                                            (void**)&g_instance->plugin->view);
+    if (result != Steinberg::kResultOk || !g_instance->plugin->view) {
         printf("[HOST] ERROR: Failed to get IPlugView interface\n");
         viewUnknown->release();
         return false;
@@ -1036,30 +1738,30 @@ bool open_editor(RespEditorInfo* resp) {
     viewUnknown->release();
 
     // Check if HWND is supported
-    result = g_plugin.view->isPlatformTypeSupported(Steinberg::kPlatformTypeHWND);
+    result = g_instance->plugin->view->isPlatformTypeSupported(Steinberg::kPlatformTypeHWND);
     if (result != Steinberg::kResultOk) {
         printf("[HOST] ERROR: Plugin doesn't support HWND platform\n");
-        g_plugin.view->release();
-        g_plugin.view = nullptr;
+        g_instance->plugin->view->release();
+        g_instance->plugin->view = nullptr;
         return false;
     }
 
     // Get initial size
     Steinberg::ViewRect rect = {0, 0, 800, 600};  // Default size
-    g_plugin.view->getSize(&rect);
+    g_instance->plugin->view->getSize(&rect);
     int width = rect.getWidth();
     int height = rect.getHeight();
     printf("[HOST] Editor size: %dx%d\n", width, height);
 
     // Register window class
     if (!register_editor_class()) {
-        g_plugin.view->release();
-        g_plugin.view = nullptr;
+        g_instance->plugin->view->release();
+        g_instance->plugin->view = nullptr;
         return false;
     }
 
     // Create editor window
-    g_plugin.editorHwnd = CreateWindowExW(
+    g_instance->plugin->editorHwnd = CreateWindowExW(
         0,
         EDITOR_CLASS_NAME,
         L"Plugin Editor",
@@ -1071,74 +1773,74 @@ bool open_editor(RespEditorInfo* resp) {
         nullptr
     );
 
-    if (!g_plugin.editorHwnd) {
+    if (!g_instance->plugin->editorHwnd) {
         printf("[HOST] ERROR: Failed to create editor window\n");
-        g_plugin.view->release();
-        g_plugin.view = nullptr;
+        g_instance->plugin->view->release();
+        g_instance->plugin->view = nullptr;
         return false;
     }
 
     // Set up the plug frame
-    g_plugin.plugFrame.view = g_plugin.view;
-    g_plugin.plugFrame.hwnd = g_plugin.editorHwnd;
-    g_plugin.view->setFrame(&g_plugin.plugFrame);
+    g_instance->plugin->plugFrame.view = g_instance->plugin->view;
+    g_instance->plugin->plugFrame.hwnd = g_instance->plugin->editorHwnd;
+    g_instance->plugin->view->setFrame(&g_instance->plugin->plugFrame);
 
     // Attach the view to the window
-    result = g_plugin.view->attached((void*)g_plugin.editorHwnd, Steinberg::kPlatformTypeHWND);
+    result = g_instance->plugin->view->attached((void*)g_instance->plugin->editorHwnd, Steinberg::kPlatformTypeHWND);
     if (result != Steinberg::kResultOk) {
         printf("[HOST] ERROR: Failed to attach view to window (result=%d)\n", result);
-        DestroyWindow(g_plugin.editorHwnd);
-        g_plugin.editorHwnd = nullptr;
-        g_plugin.view->release();
-        g_plugin.view = nullptr;
+        DestroyWindow(g_instance->plugin->editorHwnd);
+        g_instance->plugin->editorHwnd = nullptr;
+        g_instance->plugin->view->release();
+        g_instance->plugin->view = nullptr;
         return false;
     }
 
     // Show the window
-    ShowWindow(g_plugin.editorHwnd, SW_SHOW);
-    UpdateWindow(g_plugin.editorHwnd);
+    ShowWindow(g_instance->plugin->editorHwnd, SW_SHOW);
+    UpdateWindow(g_instance->plugin->editorHwnd);
 
-    g_plugin.editorOpen = true;
+    g_instance->plugin->editorOpen = true;
 
     // Return the window handle as X11 window ID
     // Wine windows are X11 windows, so the HWND can be used directly
     // (Wine internally maps HWNDs to X11 window IDs)
-    resp->x11_window_id = (uint32_t)(uintptr_t)g_plugin.editorHwnd;
+    resp->x11_window_id = (uint32_t)(uintptr_t)g_instance->plugin->editorHwnd;
     resp->width = width;
     resp->height = height;
 
-    printf("[HOST] Editor opened, HWND=%p\n", g_plugin.editorHwnd);
+    printf("[HOST] Editor opened, HWND=%p\n", g_instance->plugin->editorHwnd);
     return true;
 }
 
 void close_editor() {
-    if (!g_plugin.editorOpen) return;
+    if (!g_instance->plugin->editorOpen) return;
 
-    if (g_plugin.view) {
-        g_plugin.view->removed();
-        g_plugin.view->setFrame(nullptr);
-        g_plugin.view->release();
-        g_plugin.view = nullptr;
+    if (g_instance->plugin->view) {
+        g_instance->plugin->view->removed();
+        g_instance->plugin->view->setFrame(nullptr);
+        g_instance->plugin->view->release();
+        g_instance->plugin->view = nullptr;
     }
 
-    if (g_plugin.editorHwnd) {
-        DestroyWindow(g_plugin.editorHwnd);
-        g_plugin.editorHwnd = nullptr;
+    if (g_instance->plugin->editorHwnd) {
+        DestroyWindow(g_instance->plugin->editorHwnd);
+        g_instance->plugin->editorHwnd = nullptr;
     }
 
-    g_plugin.editorOpen = false;
+    g_instance->plugin->editorOpen = false;
     printf("[HOST] Editor closed\n");
 }
 
 bool get_editor_size(RespEditorSize* resp) {
     memset(resp, 0, sizeof(*resp));
 
-    if (!g_plugin.view) {
+    if (!g_instance->plugin->view) {
         return false;
     }
 
     Steinberg::ViewRect rect;
-    if (g_plugin.view->getSize(&rect) == Steinberg::kResultOk) {
+    if (g_instance->plugin->view->getSize(&rect) == Steinberg::kResultOk) {
         resp->width = rect.getWidth();
         resp->height = rect.getHeight();
         return true;
@@ -1147,25 +1849,45 @@ bool get_editor_size(RespEditorSize* resp) {
 }
 
 bool init_audio(const CmdInitAudio* cmd) {
-    if (!g_plugin.loaded) {
+    if (!any_slot_loaded()) {
         printf("[HOST] ERROR: No plugin loaded\n");
         return false;
     }
+    uint32_t depth = cmd->pipeline_depth ? cmd->pipeline_depth : 1;
+    if (cmd->num_inputs > RACK_WINE_MAX_CHANNELS || cmd->num_outputs > RACK_WINE_MAX_CHANNELS ||
+        cmd->block_size == 0 || cmd->block_size > RACK_WINE_MAX_BLOCK_SIZE ||
+        depth > RACK_WINE_MAX_PIPELINE_DEPTH || cmd->process_mode > 2 ||
+        cmd->sample_format > RACK_WINE_SAMPLE_F64) {
+        printf("[HOST] ERROR: Unsupported audio configuration\n");
+        return false;
+    }
 
-    printf("[HOST] Initializing audio: %uHz, %u samples, %u in, %u out\n",
-           cmd->sample_rate, cmd->block_size, cmd->num_inputs, cmd->num_outputs);
+    printf("[HOST] Initializing audio: %uHz, %u samples, %u in, %u out, %u block slot(s), %s, %s\n",
+           cmd->sample_rate, cmd->block_size, cmd->num_inputs, cmd->num_outputs, depth,
+           cmd->process_mode == 2 ? "offline" : (cmd->process_mode == 1 ? "prefetch" : "realtime"),
+           cmd->sample_format == RACK_WINE_SAMPLE_F64 ? "f64" : "f32");
     printf("[HOST] SHM name: %s\n", cmd->shm_name);
 
+    // Reconfiguring a running instance (new channel counts, block size or
+    // format) swaps the mapping and re-runs slot setup; the loaded plugins
+    // and the doorbell survive
+    bool was_running = g_instance->rt_thread != nullptr;
     cleanup_audio();
 
-    g_plugin.sample_rate = cmd->sample_rate;
-    g_plugin.block_size = cmd->block_size;
-    g_plugin.num_inputs = cmd->num_inputs;
-    g_plugin.num_outputs = cmd->num_outputs;
+    g_instance->audio.sample_rate = cmd->sample_rate;
+    g_instance->audio.block_size = cmd->block_size;
+    g_instance->audio.num_inputs = cmd->num_inputs;
+    g_instance->audio.num_outputs = cmd->num_outputs;
+    g_instance->audio.pipeline_depth = depth;
+    g_instance->audio.process_mode = static_cast<int32_t>(cmd->process_mode);
+    g_instance->audio.sample_format = cmd->sample_format;
+    g_instance->audio.slot_stride = (cmd->num_inputs + cmd->num_outputs) * cmd->block_size *
+                          RACK_WINE_SAMPLE_BYTES(cmd->sample_format);
 
     // Open the file (created by Linux client, accessed via Wine's Z: drive)
     // The path is like "Z:\tmp\rack-wine-audio-12345"
-    g_shm_size = RACK_WINE_SHM_SIZE(cmd->num_inputs, cmd->num_outputs, cmd->block_size);
+    g_instance->shm_size = RACK_WINE_SHM_SIZE_EVENTS(cmd->num_inputs, cmd->num_outputs, cmd->block_size, depth,
+                                           cmd->sample_format);
 
     HANDLE file_handle = CreateFileA(
         cmd->shm_name,
@@ -1183,134 +1905,1141 @@ bool init_audio(const CmdInitAudio* cmd) {
     }
 
     // Create file mapping on the file
-    g_shm_handle = CreateFileMappingA(file_handle, NULL, PAGE_READWRITE, 0, (DWORD)g_shm_size, NULL);
-    if (!g_shm_handle) {
+    g_instance->shm_handle = CreateFileMappingA(file_handle, NULL, PAGE_READWRITE, 0, (DWORD)g_instance->shm_size, NULL);
+    if (!g_instance->shm_handle) {
         printf("[HOST] ERROR: Failed to create file mapping (%lu)\n", GetLastError());
         CloseHandle(file_handle);
         return false;
     }
 
-    g_shm_ptr = MapViewOfFile(g_shm_handle, FILE_MAP_ALL_ACCESS, 0, 0, g_shm_size);
-    if (!g_shm_ptr) {
+    g_instance->shm_ptr = MapViewOfFile(g_instance->shm_handle, FILE_MAP_ALL_ACCESS, 0, 0, g_instance->shm_size);
+    if (!g_instance->shm_ptr) {
         printf("[HOST] ERROR: Failed to map shared memory (%lu)\n", GetLastError());
-        CloseHandle(g_shm_handle);
+        CloseHandle(g_instance->shm_handle);
         CloseHandle(file_handle);
-        g_shm_handle = nullptr;
+        g_instance->shm_handle = nullptr;
         return false;
     }
 
     // We can close the file handle now - the mapping keeps it open
     CloseHandle(file_handle);
 
-    printf("[HOST] Shared memory mapped: %zu bytes\n", g_shm_size);
-
-    // Setup bus arrangements (stereo in/out)
-    if (g_plugin.processor) {
-        Steinberg::SpeakerArrangement inArr = Steinberg::kStereo;
-        Steinberg::SpeakerArrangement outArr = Steinberg::kStereo;
-        g_plugin.processor->setBusArrangements(&inArr, 1, &outArr, 1);
-    }
-
-    // Activate buses
-    g_plugin.component->activateBus(Steinberg::kAudio, Steinberg::kInput, 0, 1);
-    g_plugin.component->activateBus(Steinberg::kAudio, Steinberg::kOutput, 0, 1);
-
-    // Setup processing
-    if (g_plugin.processor) {
-        Steinberg::ProcessSetup setup;
-        setup.processMode = 0;  // Realtime
-        setup.symbolicSampleSize = 0;  // 32-bit float
-        setup.maxSamplesPerBlock = cmd->block_size;
-        setup.sampleRate = cmd->sample_rate;
-
-        Steinberg::tresult r = g_plugin.processor->setupProcessing(setup);
-        printf("[HOST] setupProcessing result=%d\n", r);
+    printf("[HOST] Shared memory mapped: %zu bytes\n", g_instance->shm_size);
+
+    // Only an event area where the layout puts it is ever read
+    size_t events_offset = RACK_WINE_SHM_EVENTS_OFFSET(cmd->num_inputs, cmd->num_outputs, cmd->block_size, depth,
+                                                       cmd->sample_format);
+    const RackWineShmHeader* shm = (const RackWineShmHeader*)g_instance->shm_ptr;
+    g_instance->audio.events_offset = shm->events_offset == events_offset ? (uint32_t)events_offset : 0;
+    if (!g_instance->audio.events_offset) {
+        printf("[HOST] WARNING: No in-band event area in shared memory\n");
+    }
+
+    // Intermediate buffers for chains (never touch the client's memory)
+    uint32_t scratch_channels = cmd->num_inputs > cmd->num_outputs ? cmd->num_inputs : cmd->num_outputs;
+    size_t scratch_stride = (size_t)scratch_channels * cmd->block_size;
+    if (cmd->sample_format == RACK_WINE_SAMPLE_F64) {
+        g_instance->scratch64 = new double[3 * scratch_stride]();
+        g_instance->scratch = new float[2 * scratch_stride]();
+        for (uint32_t ch = 0; ch < scratch_channels; ch++) {
+            for (int b = 0; b < 3; b++) {
+                g_instance->scratch_ptrs64[b][ch] = g_instance->scratch64 + b * scratch_stride + ch * cmd->block_size;
+            }
+            for (int b = 0; b < 2; b++) {
+                g_instance->convert_ptrs[b][ch] = g_instance->scratch + b * scratch_stride + ch * cmd->block_size;
+            }
+        }
+    } else {
+        g_instance->scratch = new float[3 * scratch_stride]();
+        for (int b = 0; b < 3; b++) {
+            for (uint32_t ch = 0; ch < scratch_channels; ch++) {
+                g_instance->scratch_ptrs[b][ch] = g_instance->scratch + b * scratch_stride + ch * cmd->block_size;
+            }
+        }
     }
 
-    // Activate
-    Steinberg::tresult r = g_plugin.component->setActive(1);
-    printf("[HOST] setActive result=%d\n", r);
-    g_plugin.initialized = true;
-
-    // Start processing
-    if (g_plugin.processor) {
-        r = g_plugin.processor->setProcessing(1);
-        printf("[HOST] setProcessing result=%d\n", r);
+    for (uint32_t i = 0; i < RACK_WINE_MAX_SLOTS; i++) {
+        g_instance->perf[i].set_sample_rate(cmd->sample_rate);
+        if (g_instance->slots[i].loaded) {
+            activate_slot(&g_instance->slots[i]);
+        }
     }
-    g_plugin.processing = true;
+    g_instance->audio.active = true;
 
     printf("[HOST] Audio initialized\n");
+    resume_realtime(was_running);
     return true;
 }
 
-bool process_audio(uint32_t num_samples) {
-    if (!g_plugin.processing || !g_shm_ptr) {
-        return false;
+// Copy src channels to dst, zero-filling extra dst channels
+template <typename Sample>
+static void copy_channels(Sample* const* src, uint32_t src_ch, Sample* const* dst, uint32_t dst_ch,
+                          uint32_t num_samples) {
+    uint32_t channels = (src_ch < dst_ch) ? src_ch : dst_ch;
+    for (uint32_t ch = 0; ch < channels; ch++) {
+        if (dst[ch] != src[ch]) {
+            memcpy(dst[ch], src[ch], num_samples * sizeof(Sample));
+        }
+    }
+    for (uint32_t ch = channels; ch < dst_ch; ch++) {
+        memset(dst[ch], 0, num_samples * sizeof(Sample));
     }
+}
 
-    RackWineShmHeader* shm = (RackWineShmHeader*)g_shm_ptr;
+// Samples a slot may keep producing after its input goes silent
+static uint64_t slot_tail_samples(PluginState* slot) {
+    Steinberg::uint32 tail = slot->processor->getTailSamples();
+    if (tail == Steinberg::kInfiniteTail) {
+        return rack::SilenceGate::INFINITE_TAIL;
+    }
+    return (uint64_t)tail + slot->processor->getLatencySamples();
+}
 
-    // Calculate buffer pointers
-    float* input_base = (float*)((uint8_t*)g_shm_ptr + shm->input_offset);
-    float* output_base = (float*)((uint8_t*)g_shm_ptr + shm->output_offset);
+static void set_bus_channels(Steinberg::AudioBusBuffers& bus, float** channels) {
+    bus.channelBuffers32 = channels;
+}
+
+static void set_bus_channels(Steinberg::AudioBusBuffers& bus, double** channels) {
+    bus.channelBuffers64 = channels;
+}
+
+// ============================================================================
+// Events
+// ============================================================================
+
+// Convert a note-type MIDI message (note on/off, poly pressure) into a VST3
+// event. Returns false for every other message.
+static bool midi_to_event(uint32_t sample_offset, const uint8_t* data, Steinberg::Event* e) {
+    uint8_t type = data[0] & 0xF0;
+    uint8_t channel = data[0] & 0x0F;
+
+    memset(e, 0, sizeof(*e));
+    e->busIndex = 0;
+    e->sampleOffset = sample_offset;
+    e->flags = Steinberg::kIsLive;
+
+    if (type == 0x90 && data[2] > 0) {
+        // Note On
+        e->type = Steinberg::kNoteOnEvent;
+        e->noteOn.channel = channel;
+        e->noteOn.pitch = data[1];
+        e->noteOn.velocity = data[2] / 127.0f;
+        e->noteOn.tuning = 0.0f;
+        e->noteOn.length = 0;
+        e->noteOn.noteId = -1;
+        return true;
+    }
+    if (type == 0x80 || (type == 0x90 && data[2] == 0)) {
+        // Note Off
+        e->type = Steinberg::kNoteOffEvent;
+        e->noteOff.channel = channel;
+        e->noteOff.pitch = data[1];
+        e->noteOff.velocity = data[2] / 127.0f;
+        e->noteOff.tuning = 0.0f;
+        e->noteOff.noteId = -1;
+        return true;
+    }
+    if (type == 0xA0) {
+        // Poly Pressure (Aftertouch)
+        e->type = Steinberg::kPolyPressureEvent;
+        e->polyPressure.channel = channel;
+        e->polyPressure.pitch = data[1];
+        e->polyPressure.pressure = data[2] / 127.0f;
+        e->polyPressure.noteId = -1;
+        return true;
+    }
+    return false;
+}
+
+// VST3 has no CC, channel pressure or pitch bend events: plugins map them to
+// parameters through IMidiMapping. Returns false if the message is not one
+// of those or the slot does not map it.
+static bool midi_to_param(const PluginState* slot, const uint8_t* data, Steinberg::uint32* id, double* value) {
+    if (!slot->has_midi_mapping) {
+        return false;
+    }
+    uint8_t type = data[0] & 0xF0;
+    uint8_t channel = data[0] & 0x0F;
+
+    int ctrl;
+    if (type == 0xB0) {
+        ctrl = data[1] & 0x7F;
+        *value = (data[2] & 0x7F) / 127.0;
+    } else if (type == 0xD0) {
+        ctrl = Steinberg::kAfterTouch;
+        *value = (data[1] & 0x7F) / 127.0;
+    } else if (type == 0xE0) {
+        ctrl = Steinberg::kPitchBend;
+        *value = ((data[1] & 0x7F) | ((data[2] & 0x7F) << 7)) / 16383.0;
+    } else {
+        return false;
+    }
+    *id = slot->midi_params[channel][ctrl];
+    return *id != Steinberg::kNoParamId;
+}
 
-    // If no processor, just copy input to output (passthrough)
-    if (!g_plugin.processor) {
-        uint32_t channels = (shm->num_inputs < shm->num_outputs) ? shm->num_inputs : shm->num_outputs;
-        for (uint32_t ch = 0; ch < channels; ch++) {
-            float* in = input_base + ch * shm->block_size;
-            float* out = output_base + ch * shm->block_size;
-            memcpy(out, in, num_samples * sizeof(float));
+// Gather what the slot's next process() call receives besides queued
+// MIDI: values pending for its processor (at offset 0) and its share of
+// the block's in-band events. Audio path only.
+static void collect_block_events(PluginState* slot, uint32_t num_samples) {
+    uint32_t index = (uint32_t)(slot - g_instance->slots);
+    g_instance->input_params.clear();
+
+    // Leave the rest pending if the list fills up
+    Steinberg::uint32 id = 0;
+    double value = 0.0;
+    while (!g_instance->input_params.full() && g_instance->processor_params[index].pop(&id, &value)) {
+        g_instance->input_params.add(id, 0, value, false);
+    }
+
+    uint32_t last_frame = num_samples > 0 ? num_samples - 1 : 0;
+    uint64_t dropped = 0;
+
+    MidiEvent me;
+    while (g_instance->socket_midi[index].pop(me)) {
+        Steinberg::Event e;
+        uint32_t offset = me.sample_offset < last_frame ? me.sample_offset : last_frame;
+        if (midi_to_event(offset, me.data, &e) && slot->inputEvents.addEvent(e) != Steinberg::kResultOk) {
+            dropped++;
         }
-        for (uint32_t ch = channels; ch < shm->num_outputs; ch++) {
-            float* out = output_base + ch * shm->block_size;
-            memset(out, 0, num_samples * sizeof(float));
+    }
+
+    if (!g_instance->block_events) {
+        if (dropped > 0) {
+            g_instance->perf[index].add_dropped_midi(dropped);
         }
-        return true;
+        return;
+    }
+    uint32_t num_events = g_instance->block_events->num_events;
+    if (num_events > RACK_WINE_MAX_BLOCK_EVENTS) {
+        num_events = RACK_WINE_MAX_BLOCK_EVENTS;
+    }
+
+    for (uint32_t i = 0; i < num_events; i++) {
+        const RackWineShmEvent& ev = g_instance->block_events->events[i];
+        if (ev.slot != index) continue;
+        uint32_t offset = ev.sample_offset < last_frame ? ev.sample_offset : last_frame;
+
+        if (ev.type == RACK_WINE_EVENT_PARAM) {
+            g_instance->input_params.add(ev.param_id, (Steinberg::int32)offset, ev.value, true);
+        } else if (ev.type == RACK_WINE_EVENT_MIDI) {
+            Steinberg::Event e;
+            if (midi_to_event(offset, ev.midi, &e)) {
+                if (slot->inputEvents.addEvent(e) != Steinberg::kResultOk) dropped++;
+            } else if (midi_to_param(slot, ev.midi, &id, &value)) {
+                g_instance->input_params.add(id, (Steinberg::int32)offset, value, true);
+            }
+        }
+    }
+    if (dropped > 0) {
+        g_instance->perf[index].add_dropped_midi(dropped);
     }
+}
 
-    // Set up channel pointers
-    float* input_channels[RACK_WINE_MAX_CHANNELS];
-    float* output_channels[RACK_WINE_MAX_CHANNELS];
+// After process(): hand the final in-band value of each parameter to the
+// control thread for the slot's edit controller
+static void queue_controller_sync(PluginState* slot) {
+    Steinberg::ParamChangeQueue& sync = g_instance->controller_sync[slot - g_instance->slots];
+    for (Steinberg::int32 i = 0; i < g_instance->input_params.count; i++) {
+        const Steinberg::HostParamValueQueue& queue = g_instance->input_params.queues[i];
+        if (queue.sync_controller && queue.count > 0) {
+            sync.push(queue.id, queue.values[queue.count - 1]);
+        }
+    }
+}
 
-    for (uint32_t i = 0; i < shm->num_inputs; i++) {
-        input_channels[i] = input_base + i * shm->block_size;
+// Control thread: apply the values queued by queue_controller_sync
+static void sync_controllers() {
+    for (uint32_t i = 0; i < RACK_WINE_MAX_SLOTS; i++) {
+        if (g_instance->controller_sync[i].pending_count() == 0 || !g_instance->slots[i].controller) continue;
+        Steinberg::uint32 id = 0;
+        double value = 0.0;
+        while (g_instance->controller_sync[i].pop(&id, &value)) {
+            g_instance->slots[i].controller->setParamNormalized(id, value);
+        }
     }
-    for (uint32_t i = 0; i < shm->num_outputs; i++) {
-        output_channels[i] = output_base + i * shm->block_size;
+}
+
+// Run one slot from src into dst in the slot's own sample type (no
+// processor: passthrough)
+template <typename Sample>
+static bool run_slot(PluginState* slot, Sample** src, uint32_t src_ch, Sample** dst, uint32_t dst_ch,
+                     uint32_t num_samples) {
+    if (!slot->processor) {
+        copy_channels(src, src_ch, dst, dst_ch, num_samples);
+        return true;
+    }
+
+    // Silent input channels are flagged to the plugin; with idle sleep on,
+    // a plugin whose tail has run out is not called at all
+    rack::SilenceGate& gate = g_instance->silence_gates[slot - g_instance->slots];
+    bool input_silent = false;
+    uint64_t input_mask = rack::silent_channel_mask(src, src_ch, num_samples, &input_silent);
+    slot->inputEvents.defer_late((Steinberg::int32)num_samples);
+    collect_block_events(slot, num_samples);
+    bool has_events = slot->inputEvents.count > 0 || g_instance->input_params.count > 0;
+
+    if (gate.begin_block(input_silent, has_events, [slot]() { return slot_tail_samples(slot); })) {
+        for (uint32_t ch = 0; ch < dst_ch; ch++) {
+            memset(dst[ch], 0, num_samples * sizeof(Sample));
+        }
+        slot->inputEvents.clear();  // Brings deferred events forward
+        return true;
     }
 
     // Setup process data
     Steinberg::AudioBusBuffers inputs;
-    inputs.numChannels = shm->num_inputs;
-    inputs.silenceFlags = 0;
-    inputs.channelBuffers32 = input_channels;
+    inputs.numChannels = src_ch;
+    inputs.silenceFlags = input_mask;
+    set_bus_channels(inputs, src);
 
     Steinberg::AudioBusBuffers outputs;
-    outputs.numChannels = shm->num_outputs;
+    outputs.numChannels = dst_ch;
     outputs.silenceFlags = 0;
-    outputs.channelBuffers32 = output_channels;
+    set_bus_channels(outputs, dst);
 
     Steinberg::ProcessData data;
     memset(&data, 0, sizeof(data));
-    data.processMode = 0;  // Realtime
-    data.symbolicSampleSize = 0;  // 32-bit
+    data.processMode = g_instance->audio.process_mode;
+    data.symbolicSampleSize = std::is_same<Sample, double>::value ? Steinberg::kSample64
+                                                                  : Steinberg::kSample32;
     data.numSamples = num_samples;
     data.numInputs = 1;
     data.numOutputs = 1;
     data.inputs = &inputs;
     data.outputs = &outputs;
-    data.inputEvents = &g_input_events;
-    data.outputEvents = &g_output_events;
+    data.inputParameterChanges = static_cast<Steinberg::IParameterChanges*>(&g_instance->input_params);
+    data.inputEvents = &slot->inputEvents;
+    data.outputEvents = &slot->outputEvents;
 
     // Process
-    Steinberg::tresult result = g_plugin.processor->process(data);
+    Steinberg::tresult result = slot->processor->process(data);
 
     // Clear events after processing
-    g_input_events.clear();
-    g_output_events.clear();
+    slot->inputEvents.clear();
+    slot->outputEvents.clear();
+    queue_controller_sync(slot);
+
+    // The silence history only matters when idle sleep could use it
+    bool output_silent = false;
+    if (gate.enabled() && input_silent && !has_events) {
+        output_silent = dst_ch > 0 && outputs.silenceFlags == rack::all_channels_mask(dst_ch);
+        if (!output_silent) {
+            rack::silent_channel_mask(dst, dst_ch, num_samples, &output_silent);
+        }
+    }
+    gate.end_block(output_silent, num_samples);
+
+    if (result != Steinberg::kResultOk) {
+        g_instance->perf[slot - g_instance->slots].add_process_error();
+        return false;
+    }
+    return true;
+}
+
+static bool process_slot(PluginState* slot, float** src, uint32_t src_ch, float** dst, uint32_t dst_ch,
+                         uint32_t num_samples) {
+    return run_slot(slot, src, src_ch, dst, dst_ch, num_samples);
+}
+
+// F64 chain: 64-bit plugins run on the doubles, the rest on float copies
+static bool process_slot(PluginState* slot, double** src, uint32_t src_ch, double** dst, uint32_t dst_ch,
+                         uint32_t num_samples) {
+    if (slot->process64 || !slot->processor) {
+        return run_slot(slot, src, src_ch, dst, dst_ch, num_samples);
+    }
+
+    float** in = g_instance->convert_ptrs[0];
+    float** out = g_instance->convert_ptrs[1];
+    for (uint32_t ch = 0; ch < src_ch; ch++) {
+        rack::convert_samples(src[ch], in[ch], num_samples);
+    }
+    bool ok = run_slot(slot, in, src_ch, out, dst_ch, num_samples);
+    for (uint32_t ch = 0; ch < dst_ch; ch++) {
+        rack::convert_samples(out[ch], dst[ch], num_samples);
+    }
+    return ok;
+}
+
+// Run one slot and record the time it took in its statistics
+template <typename Sample>
+static bool measured_process_slot(PluginState* slot, Sample** src, uint32_t src_ch, Sample** dst,
+                                  uint32_t dst_ch, uint32_t num_samples) {
+    rack::PerfCounters& perf = g_instance->perf[slot - g_instance->slots];
+    rack::ScopedFlushDenormals flush_denormals;
+    uint64_t start = perf.begin();
+    bool ok = process_slot(slot, src, src_ch, dst, dst_ch, num_samples);
+    perf.end(start, num_samples);
+    return ok;
+}
+
+template <typename Sample>
+static Sample** scratch_channels(int buffer) {
+    if constexpr (std::is_same<Sample, double>::value) {
+        return g_instance->scratch_ptrs64[buffer];
+    } else {
+        return g_instance->scratch_ptrs[buffer];
+    }
+}
+
+// Resolve the chain into stage masks (default: loaded slots in order,
+// serial). Returns the number of stages.
+static uint32_t resolve_stages(uint32_t* stages) {
+    uint32_t num_stages = 0;
+    if (g_instance->chain_stages > 0) {
+        for (uint32_t i = 0; i < g_instance->chain_stages; i++) {
+            if (g_instance->chain[i]) stages[num_stages++] = g_instance->chain[i];
+        }
+    } else {
+        for (uint32_t i = 0; i < RACK_WINE_MAX_SLOTS; i++) {
+            if (g_instance->slots[i].processing) stages[num_stages++] = 1u << i;
+        }
+    }
+    return num_stages;
+}
+
+// Run the whole chain for one block: shm input -> stages -> shm output.
+// Only the first stage reads client memory and only the last one writes it.
+template <typename Sample>
+static bool process_chain(uint32_t block_slot, uint32_t num_samples) {
+    RackWineShmHeader* shm = (RackWineShmHeader*)g_instance->shm_ptr;
+
+    // Calculate buffer pointers
+    size_t slot_offset = (size_t)block_slot * g_instance->audio.slot_stride;
+    Sample* input_base = (Sample*)((uint8_t*)g_instance->shm_ptr + shm->input_offset + slot_offset);
+    Sample* output_base = (Sample*)((uint8_t*)g_instance->shm_ptr + shm->output_offset + slot_offset);
+
+    Sample* input_channels[RACK_WINE_MAX_CHANNELS];
+    Sample* output_channels[RACK_WINE_MAX_CHANNELS];
+    for (uint32_t i = 0; i < g_instance->audio.num_inputs; i++) {
+        input_channels[i] = input_base + i * g_instance->audio.block_size;
+    }
+    for (uint32_t i = 0; i < g_instance->audio.num_outputs; i++) {
+        output_channels[i] = output_base + i * g_instance->audio.block_size;
+    }
+
+    // This block's in-band events (layout checked in init_audio)
+    g_instance->block_events = g_instance->audio.events_offset != 0
+        ? (const RackWineShmEventBlock*)((uint8_t*)g_instance->shm_ptr + g_instance->audio.events_offset) + block_slot
+        : nullptr;
+
+    uint32_t stages[RACK_WINE_MAX_SLOTS];
+    uint32_t num_stages = resolve_stages(stages);
+
+    if (num_stages == 0) {
+        copy_channels(input_channels, g_instance->audio.num_inputs, output_channels, g_instance->audio.num_outputs, num_samples);
+        return true;
+    }
+
+    bool ok = true;
+    Sample** src = input_channels;
+    uint32_t src_ch = g_instance->audio.num_inputs;
+    uint32_t dst_ch = g_instance->audio.num_outputs;
+
+    for (uint32_t s = 0; s < num_stages; s++) {
+        Sample** dst = (s == num_stages - 1) ? output_channels : scratch_channels<Sample>(s & 1);
+        Sample** branch = scratch_channels<Sample>(2);
+        bool first = true;
+
+        for (uint32_t i = 0; i < RACK_WINE_MAX_SLOTS; i++) {
+            if (!(stages[s] & (1u << i)) || !g_instance->slots[i].processing) continue;
+
+            if (first) {
+                ok &= measured_process_slot(&g_instance->slots[i], src, src_ch, dst, dst_ch, num_samples);
+                first = false;
+            } else {
+                // Parallel branch: render aside, then sum into the stage output
+                ok &= measured_process_slot(&g_instance->slots[i], src, src_ch, branch, dst_ch, num_samples);
+                for (uint32_t ch = 0; ch < dst_ch; ch++) {
+                    rack::mix_add(branch[ch], dst[ch], num_samples, Sample(1));
+                }
+            }
+        }
+
+        if (first) {
+            // Every slot in this stage is gone - pass the signal through
+            copy_channels(src, src_ch, dst, dst_ch, num_samples);
+        }
+
+        src = dst;
+        src_ch = dst_ch;
+    }
+
+    return ok;
+}
+
+bool process_audio(uint32_t block_slot, uint32_t num_samples) {
+    if (!g_instance->audio.active || !g_instance->shm_ptr || block_slot >= g_instance->audio.pipeline_depth) {
+        return false;
+    }
+    if (num_samples > g_instance->audio.block_size) {
+        num_samples = g_instance->audio.block_size;
+    }
+
+    bool ok = (g_instance->audio.sample_format == RACK_WINE_SAMPLE_F64)
+        ? process_chain<double>(block_slot, num_samples)
+        : process_chain<float>(block_slot, num_samples);
+
+    // Let the client notice latency changes without a round trip
+    ((RackWineShmHeader*)g_instance->shm_ptr)->latency_generation = g_instance->chain_latency.generation();
+    return ok;
+}
+
+// Re-query every processing slot and recompute the chain: per stage the
+// largest latency and tail (parallel branches are not aligned against each
+// other), summed over stages. Control thread only; VST3 expects
+// getLatencySamples() off the audio thread.
+static void refresh_latency() {
+    for (uint32_t i = 0; i < RACK_WINE_MAX_SLOTS; i++) {
+        PluginState* slot = &g_instance->slots[i];
+        if (slot->loaded && slot->processor) {
+            g_instance->latency[i].update(slot->processor->getLatencySamples(), slot->processor->getTailSamples());
+        }
+    }
+
+    uint32_t stages[RACK_WINE_MAX_SLOTS];
+    uint32_t num_stages = resolve_stages(stages);
+    uint64_t latency = 0;
+    uint64_t tail = 0;
+    bool infinite = false;
+    for (uint32_t s = 0; s < num_stages; s++) {
+        uint32_t stage_latency = 0;
+        uint32_t stage_tail = 0;
+        for (uint32_t i = 0; i < RACK_WINE_MAX_SLOTS; i++) {
+            if (!(stages[s] & (1u << i)) || !g_instance->slots[i].processing) continue;
+            if (g_instance->latency[i].latency() > stage_latency) stage_latency = g_instance->latency[i].latency();
+            if (g_instance->latency[i].tail() == rack::LatencyMonitor::INFINITE_TAIL) {
+                infinite = true;
+            } else if (g_instance->latency[i].tail() > stage_tail) {
+                stage_tail = g_instance->latency[i].tail();
+            }
+        }
+        latency += stage_latency;
+        tail += stage_tail;
+    }
+
+    if (latency > UINT32_MAX) latency = UINT32_MAX;
+    if (infinite || tail >= RACK_WINE_TAIL_INFINITE) tail = RACK_WINE_TAIL_INFINITE;
+    g_instance->chain_latency.update((uint32_t)latency, (uint32_t)tail);
+}
+
+// ============================================================================
+// Realtime Doorbell
+// ============================================================================
+
+// Linux futex via raw syscall. The host is a PE binary, but under Wine on
+// x86_64 Linux the syscall instruction goes straight to the kernel, and our
+// shm view is a MAP_SHARED mapping of the client's file, so the futex key is
+// the same one the Linux client waits on. Set RACK_WINE_NO_FUTEX to fall back
+// to spin/yield polling (e.g. on Wine builds using syscall user dispatch).
+#define LINUX_SYS_FUTEX  202
+#define LINUX_FUTEX_WAIT 0
+#define LINUX_FUTEX_WAKE 1
+
+struct LinuxTimespec {
+    int64_t tv_sec;
+    int64_t tv_nsec;
+};
+
+static long linux_futex(volatile uint32_t* addr, int op, uint32_t val, const LinuxTimespec* timeout) {
+#if defined(__x86_64__)
+    long ret;
+    register long r10 __asm__("r10") = (long)timeout;
+    __asm__ volatile ("syscall"
+        : "=a"(ret)
+        : "0"((long)LINUX_SYS_FUTEX), "D"(addr), "S"((long)op), "d"((long)val), "r"(r10)
+        : "rcx", "r11", "memory");
+    return ret;
+#else
+    (void)addr; (void)op; (void)val; (void)timeout;
+    return -38;  // ENOSYS
+#endif
+}
+
+typedef void (__cdecl *WineGetHostVersionProc)(const char** sysname, const char** release);
+
+static bool detect_futex() {
+#if defined(__x86_64__)
+    if (getenv("RACK_WINE_NO_FUTEX")) return false;
+
+    HMODULE ntdll = GetModuleHandleA("ntdll.dll");
+    if (!ntdll) return false;
+
+    // Only present when running under Wine
+    WineGetHostVersionProc get_host_version =
+        (WineGetHostVersionProc)GetProcAddress(ntdll, "wine_get_host_version");
+    if (!get_host_version) return false;
+
+    const char* sysname = nullptr;
+    const char* release = nullptr;
+    get_host_version(&sysname, &release);
+    return sysname && strcmp(sysname, "Linux") == 0;
+#else
+    return false;
+#endif
+}
+
+// Wait until client_ready moves past seq. Returns false if asked to stop.
+static bool rt_wait_for_block(RackWineShmHeader* shm, uint32_t seq) {
+    for (int i = 0; i < RACK_WINE_RT_SPIN_COUNT; i++) {
+        if (shm->client_ready != seq) return true;
+        YieldProcessor();
+    }
+
+    uint32_t idle_rounds = 0;
+    while (!g_instance->rt_stop) {
+        // Publish host_waiting before re-checking, so a client that rang
+        // after our last check is guaranteed to see it and wake us
+        InterlockedExchange((volatile LONG*)&shm->host_waiting, 1);
+        if (shm->client_ready == seq && !g_instance->rt_stop) {
+            if (g_have_futex) {
+                LinuxTimespec timeout = {0, 50 * 1000 * 1000};
+                linux_futex(&shm->client_ready, LINUX_FUTEX_WAIT, seq, &timeout);
+            } else if (idle_rounds++ < 1000) {
+                SwitchToThread();
+            } else {
+                Sleep(1);
+            }
+        }
+        InterlockedExchange((volatile LONG*)&shm->host_waiting, 0);
+
+        if (shm->client_ready != seq) return true;
+    }
+    return false;
+}
+
+// Register the calling thread with MMCSS as a "Pro Audio" task. avrt.dll is
+// loaded at runtime, so hosts without it just keep the thread priority.
+// Returns the task handle for leave_pro_audio_task(), or NULL.
+static HANDLE enter_pro_audio_task() {
+    typedef HANDLE (WINAPI *AvSetMmThreadCharacteristicsProc)(LPCSTR, DWORD*);
+    HMODULE avrt = LoadLibraryA("avrt.dll");
+    if (!avrt) {
+        return NULL;
+    }
+    AvSetMmThreadCharacteristicsProc set_characteristics =
+        (AvSetMmThreadCharacteristicsProc)GetProcAddress(avrt, "AvSetMmThreadCharacteristicsA");
+    DWORD task_index = 0;
+    HANDLE task = set_characteristics ? set_characteristics("Pro Audio", &task_index) : NULL;
+    if (!task) {
+        FreeLibrary(avrt);
+    }
+    return task;
+}
+
+static void leave_pro_audio_task(HANDLE task) {
+    typedef BOOL (WINAPI *AvRevertMmThreadCharacteristicsProc)(HANDLE);
+    HMODULE avrt = GetModuleHandleA("avrt.dll");
+    if (!task || !avrt) {
+        return;
+    }
+    AvRevertMmThreadCharacteristicsProc revert =
+        (AvRevertMmThreadCharacteristicsProc)GetProcAddress(avrt, "AvRevertMmThreadCharacteristics");
+    if (revert) {
+        revert(task);
+    }
+    FreeLibrary(avrt);
+}
+
+static DWORD WINAPI rt_thread_proc(LPVOID param) {
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+    HANDLE mmcss_task = enter_pro_audio_task();
+    g_instance = (HostInstance*)param;
+
+    // The thread only ever runs plugin DSP: flush denormals for its lifetime
+    rack::set_fpu_mode(rack::fpu_mode_flush_denormals(rack::fpu_mode()));
+
+    RackWineShmHeader* shm = (RackWineShmHeader*)g_instance->shm_ptr;
+    uint32_t done = shm->host_ready;
+
+    while (rt_wait_for_block(shm, done)) {
+        uint32_t submitted = shm->client_ready;
+        MemoryBarrier();  // Input and slot_samples were written before client_ready
+
+        // Work through every submitted block in order (more than one can be
+        // pending in pipelined mode)
+        while (done != submitted && !g_instance->rt_stop) {
+            uint32_t seq = done + 1;
+            uint32_t block_slot = (seq - 1) % g_instance->audio.pipeline_depth;
+            uint32_t num_samples = shm->slot_samples[block_slot];
+
+            bool ok = process_audio(block_slot, num_samples);
+
+            if (ok) {
+                shm->rt_flags &= ~RACK_WINE_RT_ERROR;
+            } else {
+                shm->rt_flags |= RACK_WINE_RT_ERROR;
+            }
+
+            // Output must be visible before the completion sequence, and the
+            // completion store before we look at client_waiting
+            MemoryBarrier();
+            shm->host_ready = seq;
+            done = seq;
+            MemoryBarrier();
+
+            if (g_have_futex && shm->client_waiting) {
+                linux_futex(&shm->host_ready, LINUX_FUTEX_WAKE, 0x7FFFFFFF, nullptr);
+            }
+        }
+    }
+
+    leave_pro_audio_task(mmcss_task);
+    return 0;
+}
+
+bool start_realtime() {
+    if (!g_instance->audio.active || !g_instance->shm_ptr) {
+        return false;
+    }
+    if (g_instance->rt_thread) {
+        return true;
+    }
+
+    RackWineShmHeader* shm = (RackWineShmHeader*)g_instance->shm_ptr;
+    shm->host_ready = shm->client_ready;
+    shm->host_waiting = 0;
+    shm->rt_flags = RACK_WINE_RT_ACTIVE | (g_have_futex ? RACK_WINE_RT_FUTEX : 0);
+    MemoryBarrier();
+
+    g_instance->rt_stop = 0;
+    g_instance->rt_thread = CreateThread(NULL, 0, rt_thread_proc, g_instance, 0, NULL);
+    if (!g_instance->rt_thread) {
+        printf("[HOST] ERROR: Failed to create audio thread (%lu)\n", GetLastError());
+        shm->rt_flags = 0;
+        return false;
+    }
+
+    printf("[HOST] Realtime doorbell started (%s)\n", g_have_futex ? "futex" : "polling");
+    return true;
+}
+
+void stop_realtime() {
+    if (!g_instance->rt_thread) return;
+
+    InterlockedExchange(&g_instance->rt_stop, 1);
+    RackWineShmHeader* shm = (RackWineShmHeader*)g_instance->shm_ptr;
+    if (g_have_futex) {
+        linux_futex(&shm->client_ready, LINUX_FUTEX_WAKE, 0x7FFFFFFF, nullptr);
+    }
+
+    WaitForSingleObject(g_instance->rt_thread, INFINITE);
+    CloseHandle(g_instance->rt_thread);
+    g_instance->rt_thread = nullptr;
+
+    shm->rt_flags = 0;
+    printf("[HOST] Realtime doorbell stopped\n");
+}
+
+// Stop the audio thread around anything that rewrites slot or chain state
+// (load/unload, setState, CMD_SET_CHAIN), so the realtime path itself needs
+// no lock. A block rung meanwhile is completed (with stale output) when the
+// thread restarts.
+bool pause_realtime() {
+    bool was_running = g_instance->rt_thread != nullptr;
+    stop_realtime();
+    return was_running;
+}
+
+void resume_realtime(bool was_running) {
+    if (was_running && g_instance->audio.active) {
+        start_realtime();
+    }
+}
+
+// ============================================================================
+// State Transfer
+// ============================================================================
+
+void release_state_region() {
+    if (g_instance->state_ptr) {
+        UnmapViewOfFile(g_instance->state_ptr);
+        g_instance->state_ptr = nullptr;
+    }
+    if (g_instance->state_handle) {
+        CloseHandle(g_instance->state_handle);
+        g_instance->state_handle = nullptr;
+    }
+    g_instance->state_size = 0;
+}
+
+// Map the client's state file in place of the current region (size 0 just
+// unmaps it)
+bool map_state_region(const CmdStateRegion* cmd) {
+    release_state_region();
+    if (cmd->size == 0) {
+        return true;
+    }
+    if (cmd->size > RACK_WINE_MAX_STATE_REGION || (uint64_t)(size_t)cmd->size != cmd->size) {
+        printf("[HOST] ERROR: State region too large (%llu bytes)\n", (unsigned long long)cmd->size);
+        return false;
+    }
+
+    char name[sizeof(cmd->shm_name) + 1];
+    memcpy(name, cmd->shm_name, sizeof(cmd->shm_name));
+    name[sizeof(cmd->shm_name)] = '\0';
+
+    HANDLE file_handle = CreateFileA(name, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                     NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        printf("[HOST] ERROR: Failed to open state file '%s' (%lu)\n", name, GetLastError());
+        return false;
+    }
+
+    g_instance->state_handle = CreateFileMappingA(file_handle, NULL, PAGE_READWRITE, (DWORD)(cmd->size >> 32),
+                                                  (DWORD)cmd->size, NULL);
+    CloseHandle(file_handle);
+    if (!g_instance->state_handle) {
+        printf("[HOST] ERROR: Failed to create state mapping (%lu)\n", GetLastError());
+        return false;
+    }
+
+    g_instance->state_ptr = (uint8_t*)MapViewOfFile(g_instance->state_handle, FILE_MAP_ALL_ACCESS, 0, 0,
+                                                    (size_t)cmd->size);
+    if (!g_instance->state_ptr) {
+        printf("[HOST] ERROR: Failed to map state region (%lu)\n", GetLastError());
+        CloseHandle(g_instance->state_handle);
+        g_instance->state_handle = nullptr;
+        return false;
+    }
+    g_instance->state_size = cmd->size;
+    return true;
+}
+
+// Stream over the region from `offset` on (empty past its end)
+static Steinberg::ShmStateStream state_stream(uint64_t offset, uint64_t size) {
+    if (offset >= g_instance->state_size) {
+        return Steinberg::ShmStateStream(nullptr, 0, 0);
+    }
+    return Steinberg::ShmStateStream(g_instance->state_ptr + offset, g_instance->state_size - offset, size);
+}
+
+// Write the selected slot's state to the region. Each part gets a stream of
+// its own, so plugins that seek relative to the start stay inside their
+// part. Returns STATUS_OK, or STATUS_NO_SPACE with *size set to what the
+// region has to hold.
+uint32_t save_state(uint64_t* size) {
+    PluginState* slot = g_instance->plugin;
+
+    Steinberg::ShmStateStream component_stream = state_stream(sizeof(uint32_t), 0);
+    if (slot->component->getState(&component_stream) != Steinberg::kResultOk ||
+        component_stream.size() > UINT32_MAX) {
+        return STATUS_ERROR;
+    }
+    uint64_t controller_offset = sizeof(uint32_t) + component_stream.size();
+
+    Steinberg::ShmStateStream controller_stream = state_stream(controller_offset, 0);
+    if (slot->separate_controller && slot->controller->getState(&controller_stream) != Steinberg::kResultOk) {
+        return STATUS_ERROR;
+    }
+
+    *size = controller_offset + controller_stream.size();
+    if (*size > g_instance->state_size) {
+        return STATUS_NO_SPACE;
+    }
+    uint32_t component_size = (uint32_t)component_stream.size();
+    memcpy(g_instance->state_ptr, &component_size, sizeof(component_size));
+    return STATUS_OK;
+}
+
+// Restore the selected slot from the first `size` bytes of the region
+uint32_t load_state(uint64_t size) {
+    PluginState* slot = g_instance->plugin;
+    uint32_t component_size = 0;
+    if (size < sizeof(component_size) || size > g_instance->state_size) {
+        return STATUS_INVALID_PARAM;
+    }
+    memcpy(&component_size, g_instance->state_ptr, sizeof(component_size));
+    uint64_t controller_offset = sizeof(component_size) + (uint64_t)component_size;
+    if (controller_offset > size) {
+        return STATUS_INVALID_PARAM;
+    }
+
+    // The processor must not run halfway through its new state
+    Steinberg::ShmStateStream component_stream = state_stream(sizeof(component_size), component_size);
+    bool was_realtime = pause_realtime();
+    Steinberg::tresult result = slot->component->setState(&component_stream);
+    resume_realtime(was_realtime);
+    if (result != Steinberg::kResultOk) {
+        return STATUS_ERROR;
+    }
+
+    // New state may make the plugin audible without input, or change its
+    // latency
+    g_instance->silence_gates[g_instance->current_slot].wake();
+    g_instance->latency[g_instance->current_slot].mark_changed();
+    g_instance->chain_latency.mark_changed();
+
+    if (slot->separate_controller) {
+        component_stream.seek(0, Steinberg::IBStream::kIBSeekSet, nullptr);
+        slot->controller->setComponentState(&component_stream);
+
+        Steinberg::ShmStateStream controller_stream = state_stream(controller_offset, size - controller_offset);
+        if (size > controller_offset && slot->controller->setState(&controller_stream) != Steinberg::kResultOk) {
+            return STATUS_ERROR;
+        }
+    }
+    return STATUS_OK;
+}
+
+// ============================================================================
+// Control Commands
+// ============================================================================
+
+static bool buffer_reserve(ByteBuffer& buf, size_t capacity) {
+    if (capacity <= buf.capacity) {
+        return true;
+    }
+    size_t new_capacity = buf.capacity > 0 ? buf.capacity : 4096;
+    while (new_capacity < capacity) {
+        new_capacity *= 2;
+    }
+    uint8_t* data = new (std::nothrow) uint8_t[new_capacity];
+    if (!data) {
+        return false;
+    }
+    if (buf.size > 0) {
+        memcpy(data, buf.data, buf.size);
+    }
+    delete[] buf.data;
+    buf.data = data;
+    buf.capacity = new_capacity;
+    return true;
+}
+
+// Appends `size` uninitialized bytes and returns them, or nullptr if out of
+// memory. Earlier pointers into the buffer are invalidated.
+static uint8_t* buffer_append(ByteBuffer& buf, size_t size) {
+    if (!buffer_reserve(buf, buf.size + size)) {
+        return nullptr;
+    }
+    uint8_t* out = buf.data + buf.size;
+    buf.size += size;
+    return out;
+}
+
+static void buffer_free(ByteBuffer& buf) {
+    delete[] buf.data;
+    buf = ByteBuffer();
+}
+
+static uint32_t select_slot(const uint8_t* payload, uint32_t payload_size) {
+    if (payload_size < sizeof(CmdSelectSlot)) {
+        return STATUS_INVALID_PARAM;
+    }
+    const CmdSelectSlot* cmd = (const CmdSelectSlot*)payload;
+    if (cmd->slot >= RACK_WINE_MAX_SLOTS) {
+        return STATUS_INVALID_PARAM;
+    }
+    g_instance->current_slot = cmd->slot;
+    g_instance->plugin = &g_instance->slots[cmd->slot];
+    return STATUS_OK;
+}
+
+static bool fill_param_info(uint32_t param_index, RespParamInfo* resp) {
+    Steinberg::ParameterInfo pinfo;
+    if (g_instance->plugin->controller->getParameterInfo(param_index, pinfo) != Steinberg::kResultOk) {
+        return false;
+    }
+
+    memset(resp, 0, sizeof(*resp));
+    resp->id = pinfo.id;
+    // Convert UTF-16 title to ASCII
+    for (int i = 0; i < 127 && pinfo.title[i]; i++) {
+        resp->name[i] = (char)pinfo.title[i];
+    }
+    // Convert UTF-16 units to ASCII
+    for (int i = 0; i < 31 && pinfo.units[i]; i++) {
+        resp->units[i] = (char)pinfo.units[i];
+    }
+    resp->default_value = pinfo.defaultNormalizedValue;
+    resp->min_value = 0.0;  // Normalized range is always 0-1
+    resp->max_value = 1.0;
+    resp->flags = pinfo.flags;
+    return true;
+}
+
+static bool is_param_command(uint32_t command) {
+    switch (command) {
+        case CMD_GET_PARAM_COUNT:
+        case CMD_GET_PARAM_INFO:
+        case CMD_GET_PARAM_INFO_ALL:
+        case CMD_GET_PARAM:
+        case CMD_SET_PARAM:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Runs a parameter command against the selected slot and appends its
+// response payload to `out` (nothing on failure). Used for the standalone
+// commands and for CMD_BATCH entries. Returns a RackWineStatus.
+static uint32_t run_param_command(uint32_t command, const uint8_t* payload, uint32_t payload_size,
+                                  ByteBuffer& out) {
+    if (!g_instance->plugin->loaded) {
+        return STATUS_NOT_LOADED;
+    }
+    Steinberg::IEditController* controller = g_instance->plugin->controller;
+
+    switch (command) {
+        case CMD_GET_PARAM_COUNT: {
+            uint32_t count = controller ? controller->getParameterCount() : 0;
+            uint8_t* dst = buffer_append(out, sizeof(count));
+            if (!dst) {
+                return STATUS_ERROR;
+            }
+            memcpy(dst, &count, sizeof(count));
+            return STATUS_OK;
+        }
 
-    return result == Steinberg::kResultOk;
+        case CMD_GET_PARAM_INFO: {
+            if (!controller) {
+                return STATUS_ERROR;
+            }
+            if (payload_size < sizeof(uint32_t)) {
+                return STATUS_INVALID_PARAM;
+            }
+            uint32_t param_index = *(const uint32_t*)payload;
+            RespParamInfo resp;
+            if (!fill_param_info(param_index, &resp)) {
+                return STATUS_INVALID_PARAM;
+            }
+            uint8_t* dst = buffer_append(out, sizeof(resp));
+            if (!dst) {
+                return STATUS_ERROR;
+            }
+            memcpy(dst, &resp, sizeof(resp));
+            return STATUS_OK;
+        }
+
+        case CMD_GET_PARAM_INFO_ALL: {
+            if (!controller) {
+                return STATUS_ERROR;
+            }
+            int32_t param_count = controller->getParameterCount();
+            uint32_t total = param_count > 0 ? (uint32_t)param_count : 0;
+            uint32_t first = 0;
+            uint32_t count = total;
+            if (payload_size >= sizeof(CmdParamInfoRange)) {
+                const CmdParamInfoRange* range = (const CmdParamInfoRange*)payload;
+                first = range->first < total ? range->first : total;
+                count = range->count < total - first ? range->count : total - first;
+            }
+
+            // One reservation up front keeps the list header pointer valid
+            size_t start = out.size;
+            if (!buffer_reserve(out, start + sizeof(RespParamInfoList) + (size_t)count * sizeof(RespParamInfo))) {
+                return STATUS_ERROR;
+            }
+            RespParamInfoList* list = (RespParamInfoList*)buffer_append(out, sizeof(RespParamInfoList));
+            list->total_params = total;
+            list->first = first;
+            list->num_infos = 0;
+            RespParamInfo* infos = (RespParamInfo*)(out.data + out.size);
+            while (list->num_infos < count && fill_param_info(first + list->num_infos, &infos[list->num_infos])) {
+                list->num_infos++;
+            }
+            out.size += (size_t)list->num_infos * sizeof(RespParamInfo);
+            return STATUS_OK;
+        }
+
+        case CMD_GET_PARAM: {
+            if (!controller) {
+                return STATUS_ERROR;
+            }
+            if (payload_size < sizeof(uint32_t)) {
+                return STATUS_INVALID_PARAM;
+            }
+            CmdParam resp;
+            resp.param_id = *(const uint32_t*)payload;
+            resp.value = controller->getParamNormalized(resp.param_id);
+            uint8_t* dst = buffer_append(out, sizeof(resp));
+            if (!dst) {
+                return STATUS_ERROR;
+            }
+            memcpy(dst, &resp, sizeof(resp));
+            return STATUS_OK;
+        }
+
+        case CMD_SET_PARAM: {
+            if (!controller) {
+                return STATUS_ERROR;
+            }
+            if (payload_size < sizeof(CmdParam)) {
+                return STATUS_INVALID_PARAM;
+            }
+            const CmdParam* cmd = (const CmdParam*)payload;
+            Steinberg::tresult result = controller->setParamNormalized(cmd->param_id, cmd->value);
+            if (result != Steinberg::kResultOk) {
+                return STATUS_ERROR;
+            }
+            // The processor is a separate object: it gets the value with its
+            // next block
+            g_instance->processor_params[g_instance->current_slot].push(cmd->param_id, cmd->value);
+            return STATUS_OK;
+        }
+
+        default:
+            return STATUS_INVALID_PARAM;
+    }
+}
+
+// Runs a CMD_BATCH frame, building the combined response in `out`. The
+// frame is validated before any entry runs. Returns a RackWineStatus.
+static uint32_t run_batch(const uint8_t* payload, uint32_t payload_size, ByteBuffer& out) {
+    if (payload_size < sizeof(CmdBatch)) {
+        return STATUS_INVALID_PARAM;
+    }
+    uint32_t num_entries = ((const CmdBatch*)payload)->num_entries;
+
+    size_t offset = sizeof(CmdBatch);
+    for (uint32_t i = 0; i < num_entries; i++) {
+        if (payload_size - offset < sizeof(BatchEntry)) {
+            return STATUS_INVALID_PARAM;
+        }
+        const BatchEntry* entry = (const BatchEntry*)(payload + offset);
+        offset += sizeof(BatchEntry);
+        if (payload_size - offset < entry->payload_size) {
+            return STATUS_INVALID_PARAM;
+        }
+        offset += entry->payload_size;
+    }
+
+    out.size = 0;
+    RespBatch* resp = (RespBatch*)buffer_append(out, sizeof(RespBatch));
+    if (!resp) {
+        return STATUS_ERROR;
+    }
+    resp->num_entries = num_entries;
+
+    offset = sizeof(CmdBatch);
+    for (uint32_t i = 0; i < num_entries; i++) {
+        BatchEntry entry;
+        memcpy(&entry, payload + offset, sizeof(entry));
+        const uint8_t* entry_payload = payload + offset + sizeof(BatchEntry);
+        offset += sizeof(BatchEntry) + entry.payload_size;
+
+        size_t result_offset = out.size;
+        if (!buffer_append(out, sizeof(BatchResult))) {
+            return STATUS_ERROR;
+        }
+
+        uint32_t status;
+        if (entry.command == CMD_SELECT_SLOT) {
+            status = select_slot(entry_payload, entry.payload_size);
+        } else if (is_param_command(entry.command)) {
+            status = run_param_command(entry.command, entry_payload, entry.payload_size, out);
+        } else {
+            status = STATUS_INVALID_PARAM;
+        }
+
+        BatchResult result;
+        result.status = status;
+        result.payload_size = (uint32_t)(out.size - result_offset - sizeof(BatchResult));
+        memcpy(out.data + result_offset, &result, sizeof(result));
+    }
+    return STATUS_OK;
 }
 
 // ============================================================================
@@ -1337,6 +3066,9 @@ bool send_response(SOCKET client, uint32_t status, const void* payload, uint32_t
 }
 
 bool handle_command(SOCKET client, const RackWineHeader* header, const uint8_t* payload) {
+    // Catch the edit controllers up with automation the processors received
+    sync_controllers();
+
     switch (header->command) {
         case CMD_PING: {
             return send_response(client, STATUS_OK, nullptr, 0);
@@ -1347,107 +3079,150 @@ bool handle_command(SOCKET client, const RackWineHeader* header, const uint8_t*
                 return send_response(client, STATUS_INVALID_PARAM, nullptr, 0);
             }
             const CmdLoadPlugin* cmd = (const CmdLoadPlugin*)payload;
+            // Park the audio thread so it never sees a half-built slot
+            bool was_realtime = pause_realtime();
             bool ok = load_plugin(cmd->path, cmd->class_index);
+            resume_realtime(was_realtime);
             return send_response(client, ok ? STATUS_OK : STATUS_ERROR, nullptr, 0);
         }
 
         case CMD_UNLOAD_PLUGIN: {
+            bool was_realtime = pause_realtime();
             unload_plugin();
+            resume_realtime(was_realtime);
             return send_response(client, STATUS_OK, nullptr, 0);
         }
 
-        case CMD_GET_INFO: {
-            if (!g_plugin.loaded) {
-                return send_response(client, STATUS_NOT_LOADED, nullptr, 0);
-            }
-            RespPluginInfo info = {0};
-            strncpy(info.name, g_plugin.name, sizeof(info.name) - 1);
-            strncpy(info.vendor, g_plugin.vendor, sizeof(info.vendor) - 1);
-            strncpy(info.category, g_plugin.category, sizeof(info.category) - 1);
-            strncpy(info.uid, g_plugin.uid, sizeof(info.uid) - 1);
-            info.num_params = g_plugin.controller ? g_plugin.controller->getParameterCount() : 0;
-            info.num_audio_inputs = g_plugin.num_inputs;
-            info.num_audio_outputs = g_plugin.num_outputs;
-            return send_response(client, STATUS_OK, &info, sizeof(info));
-        }
-
-        case CMD_GET_PARAM_COUNT: {
-            if (!g_plugin.loaded) {
-                return send_response(client, STATUS_NOT_LOADED, nullptr, 0);
-            }
-            uint32_t count = g_plugin.controller ? g_plugin.controller->getParameterCount() : 0;
-            return send_response(client, STATUS_OK, &count, sizeof(count));
+        case CMD_SELECT_SLOT: {
+            return send_response(client, select_slot(payload, header->payload_size), nullptr, 0);
         }
 
-        case CMD_GET_PARAM_INFO: {
-            if (!g_plugin.loaded) {
-                return send_response(client, STATUS_NOT_LOADED, nullptr, 0);
-            }
-            if (!g_plugin.controller) {
-                return send_response(client, STATUS_ERROR, nullptr, 0);
+        case CMD_SET_CHAIN: {
+            if (header->payload_size < sizeof(CmdSetChain)) {
+                return send_response(client, STATUS_INVALID_PARAM, nullptr, 0);
             }
-            if (header->payload_size < sizeof(uint32_t)) {
+            const CmdSetChain* cmd = (const CmdSetChain*)payload;
+            if (cmd->num_stages > RACK_WINE_MAX_SLOTS) {
                 return send_response(client, STATUS_INVALID_PARAM, nullptr, 0);
             }
-            uint32_t param_index = *(const uint32_t*)payload;
+            for (uint32_t i = 0; i < cmd->num_stages; i++) {
+                if (cmd->stage_masks[i] == 0) {
+                    return send_response(client, STATUS_INVALID_PARAM, nullptr, 0);
+                }
+                for (uint32_t slot = 0; slot < RACK_WINE_MAX_SLOTS; slot++) {
+                    if ((cmd->stage_masks[i] & (1u << slot)) && !g_instance->slots[slot].loaded) {
+                        return send_response(client, STATUS_NOT_LOADED, nullptr, 0);
+                    }
+                }
+            }
+            bool was_realtime = pause_realtime();
+            memcpy(g_instance->chain, cmd->stage_masks, cmd->num_stages * sizeof(uint32_t));
+            g_instance->chain_stages = cmd->num_stages;
+            resume_realtime(was_realtime);
+            g_instance->chain_latency.mark_changed();
+            printf("[HOST] Chain set: %u stage(s)\n", cmd->num_stages);
+            return send_response(client, STATUS_OK, nullptr, 0);
+        }
 
-            Steinberg::ParameterInfo pinfo;
-            if (g_plugin.controller->getParameterInfo(param_index, pinfo) != Steinberg::kResultOk) {
+        case CMD_SET_IDLE_SLEEP: {
+            if (header->payload_size < sizeof(CmdSetIdleSleep)) {
                 return send_response(client, STATUS_INVALID_PARAM, nullptr, 0);
             }
+            const CmdSetIdleSleep* cmd = (const CmdSetIdleSleep*)payload;
+            g_instance->silence_gates[g_instance->current_slot].set_enabled(cmd->enabled != 0);
+            g_instance->silence_gates[g_instance->current_slot].wake();
+            printf("[HOST] Slot %u idle sleep %s\n", g_instance->current_slot, cmd->enabled ? "on" : "off");
+            return send_response(client, STATUS_OK, nullptr, 0);
+        }
 
-            RespParamInfo resp = {0};
-            resp.id = pinfo.id;
-            // Convert UTF-16 title to ASCII
-            for (int i = 0; i < 127 && pinfo.title[i]; i++) {
-                resp.name[i] = (char)pinfo.title[i];
-            }
-            // Convert UTF-16 units to ASCII
-            for (int i = 0; i < 31 && pinfo.units[i]; i++) {
-                resp.units[i] = (char)pinfo.units[i];
-            }
-            resp.default_value = pinfo.defaultNormalizedValue;
-            resp.min_value = 0.0;  // Normalized range is always 0-1
-            resp.max_value = 1.0;
-            resp.flags = pinfo.flags;
+        case CMD_GET_BLOCK_COUNTS: {
+            RespBlockCounts resp;
+            resp.processed_blocks = g_instance->silence_gates[g_instance->current_slot].processed_blocks();
+            resp.skipped_blocks = g_instance->silence_gates[g_instance->current_slot].skipped_blocks();
             return send_response(client, STATUS_OK, &resp, sizeof(resp));
         }
 
-        case CMD_GET_PARAM: {
-            if (!g_plugin.loaded) {
+        case CMD_GET_LATENCY: {
+            if (!g_instance->plugin->loaded) {
                 return send_response(client, STATUS_NOT_LOADED, nullptr, 0);
             }
-            if (!g_plugin.controller) {
-                return send_response(client, STATUS_ERROR, nullptr, 0);
+            refresh_latency();
+            RespLatency resp;
+            resp.latency_samples = g_instance->latency[g_instance->current_slot].latency();
+            resp.tail_samples = g_instance->latency[g_instance->current_slot].tail();
+            resp.chain_latency = g_instance->chain_latency.latency();
+            resp.chain_tail = g_instance->chain_latency.tail();
+            resp.generation = g_instance->chain_latency.generation();
+            if (g_instance->shm_ptr) {
+                ((RackWineShmHeader*)g_instance->shm_ptr)->latency_generation = resp.generation;
             }
-            if (header->payload_size < sizeof(uint32_t)) {
-                return send_response(client, STATUS_INVALID_PARAM, nullptr, 0);
-            }
-            uint32_t param_id = *(const uint32_t*)payload;
-            double value = g_plugin.controller->getParamNormalized(param_id);
-            CmdParam resp;
-            resp.param_id = param_id;
-            resp.value = value;
             return send_response(client, STATUS_OK, &resp, sizeof(resp));
         }
 
-        case CMD_SET_PARAM: {
-            if (!g_plugin.loaded) {
+        case CMD_GET_STATS: {
+            rack::PerfSnapshot snapshot;
+            g_instance->perf[g_instance->current_slot].snapshot(snapshot);
+
+            RespStats resp;
+            memset(&resp, 0, sizeof(resp));
+            resp.process_calls = snapshot.process_calls;
+            resp.frames = snapshot.frames;
+            resp.total_ns = snapshot.total_ns;
+            resp.max_ns = snapshot.max_ns;
+            resp.deadline_ns = snapshot.deadline_ns;
+            resp.deadline_misses = snapshot.deadline_misses;
+            resp.max_load = snapshot.max_load;
+            resp.average_load = snapshot.deadline_ns > 0
+                ? (double)snapshot.total_ns / (double)snapshot.deadline_ns : 0.0;
+            resp.process_errors = snapshot.process_errors;
+            resp.dropped_midi_events = snapshot.dropped_midi_events;
+            resp.dropped_param_changes = g_instance->param_changes[g_instance->current_slot].overflow_count() -
+                                         g_instance->param_overflow_base[g_instance->current_slot];
+            static_assert(RACK_WINE_STATS_HISTOGRAM_BUCKETS == rack::PERF_HISTOGRAM_BUCKETS,
+                          "histogram size mismatch");
+            memcpy(resp.histogram, snapshot.histogram, sizeof(resp.histogram));
+            return send_response(client, RACK_PERF_COUNTERS ? STATUS_OK : STATUS_ERROR, &resp, sizeof(resp));
+        }
+
+        case CMD_RESET_STATS: {
+            g_instance->perf[g_instance->current_slot].reset();
+            g_instance->param_overflow_base[g_instance->current_slot] = g_instance->param_changes[g_instance->current_slot].overflow_count();
+            return send_response(client, STATUS_OK, nullptr, 0);
+        }
+
+        case CMD_GET_INFO: {
+            if (!g_instance->plugin->loaded) {
                 return send_response(client, STATUS_NOT_LOADED, nullptr, 0);
             }
-            if (!g_plugin.controller) {
-                return send_response(client, STATUS_ERROR, nullptr, 0);
-            }
-            if (header->payload_size < sizeof(CmdParam)) {
-                return send_response(client, STATUS_INVALID_PARAM, nullptr, 0);
-            }
-            const CmdParam* cmd = (const CmdParam*)payload;
-            Steinberg::tresult result = g_plugin.controller->setParamNormalized(cmd->param_id, cmd->value);
-            return send_response(client, result == Steinberg::kResultOk ? STATUS_OK : STATUS_ERROR, nullptr, 0);
+            RespPluginInfo info = {0};
+            strncpy(info.name, g_instance->plugin->name, sizeof(info.name) - 1);
+            strncpy(info.vendor, g_instance->plugin->vendor, sizeof(info.vendor) - 1);
+            strncpy(info.category, g_instance->plugin->category, sizeof(info.category) - 1);
+            strncpy(info.uid, g_instance->plugin->uid, sizeof(info.uid) - 1);
+            info.num_params = g_instance->plugin->controller ? g_instance->plugin->controller->getParameterCount() : 0;
+            info.num_audio_inputs = g_instance->plugin->bus_inputs;
+            info.num_audio_outputs = g_instance->plugin->bus_outputs;
+            return send_response(client, STATUS_OK, &info, sizeof(info));
+        }
+
+        case CMD_GET_PARAM_COUNT:
+        case CMD_GET_PARAM_INFO:
+        case CMD_GET_PARAM_INFO_ALL:
+        case CMD_GET_PARAM:
+        case CMD_SET_PARAM: {
+            g_instance->tx_buffer.size = 0;
+            uint32_t status = run_param_command(header->command, payload, header->payload_size, g_instance->tx_buffer);
+            return send_response(client, status, g_instance->tx_buffer.data, (uint32_t)g_instance->tx_buffer.size);
+        }
+
+        case CMD_BATCH: {
+            uint32_t status = run_batch(payload, header->payload_size, g_instance->tx_buffer);
+            return send_response(client, status, g_instance->tx_buffer.data,
+                                 status == STATUS_OK ? (uint32_t)g_instance->tx_buffer.size : 0);
         }
 
         case CMD_SEND_MIDI: {
-            if (!g_plugin.loaded) {
+            if (!g_instance->plugin->loaded) {
                 return send_response(client, STATUS_NOT_LOADED, nullptr, 0);
             }
             if (header->payload_size < sizeof(CmdMidi)) {
@@ -1455,80 +3230,79 @@ bool handle_command(SOCKET client, const RackWineHeader* header, const uint8_t*
             }
             const CmdMidi* cmd = (const CmdMidi*)payload;
             const MidiEvent* events = (const MidiEvent*)(payload + sizeof(CmdMidi));
+            if ((header->payload_size - sizeof(CmdMidi)) / sizeof(MidiEvent) < cmd->num_events) {
+                return send_response(client, STATUS_INVALID_PARAM, nullptr, 0);
+            }
 
-            // Convert MIDI events to VST3 events
-            for (uint32_t i = 0; i < cmd->num_events && i < MAX_EVENTS; i++) {
+            // Note events are queued for the slot's next block; mapped CC,
+            // pressure and pitch bend go to the controller now and to the
+            // processor with its next block
+            rack::SpscQueue<MidiEvent, MAX_EVENTS>& notes = g_instance->socket_midi[g_instance->current_slot];
+            uint32_t dropped = 0;
+            for (uint32_t i = 0; i < cmd->num_events; i++) {
                 const MidiEvent* me = &events[i];
-                uint8_t status = me->data[0];
-                uint8_t data1 = me->data[1];
-                uint8_t data2 = me->data[2];
-                uint8_t type = status & 0xF0;
-                uint8_t channel = status & 0x0F;
-
                 Steinberg::Event e;
-                memset(&e, 0, sizeof(e));
-                e.busIndex = 0;
-                e.sampleOffset = me->sample_offset;
-                e.flags = Steinberg::kIsLive;
-
-                if (type == 0x90 && data2 > 0) {
-                    // Note On
-                    e.type = Steinberg::kNoteOnEvent;
-                    e.noteOn.channel = channel;
-                    e.noteOn.pitch = data1;
-                    e.noteOn.velocity = data2 / 127.0f;
-                    e.noteOn.tuning = 0.0f;
-                    e.noteOn.length = 0;
-                    e.noteOn.noteId = -1;
-                    g_input_events.addEvent(e);
-                } else if (type == 0x80 || (type == 0x90 && data2 == 0)) {
-                    // Note Off
-                    e.type = Steinberg::kNoteOffEvent;
-                    e.noteOff.channel = channel;
-                    e.noteOff.pitch = data1;
-                    e.noteOff.velocity = data2 / 127.0f;
-                    e.noteOff.tuning = 0.0f;
-                    e.noteOff.noteId = -1;
-                    g_input_events.addEvent(e);
-                } else if (type == 0xA0) {
-                    // Poly Pressure (Aftertouch)
-                    e.type = Steinberg::kPolyPressureEvent;
-                    e.polyPressure.channel = channel;
-                    e.polyPressure.pitch = data1;
-                    e.polyPressure.pressure = data2 / 127.0f;
-                    e.polyPressure.noteId = -1;
-                    g_input_events.addEvent(e);
+                Steinberg::uint32 param_id = 0;
+                double value = 0.0;
+                if (midi_to_event(me->sample_offset, me->data, &e)) {
+                    if (!notes.push(*me)) dropped++;
+                } else if (midi_to_param(g_instance->plugin, me->data, &param_id, &value)) {
+                    g_instance->plugin->controller->setParamNormalized(param_id, value);
+                    g_instance->processor_params[g_instance->current_slot].push(param_id, value);
                 }
-                // CC, pitch bend, etc. handled through parameters in VST3
             }
-            printf("[HOST] Received %u MIDI events, queued %d\n", cmd->num_events, g_input_events.count);
+            if (dropped > 0) {
+                g_instance->perf[g_instance->current_slot].add_dropped_midi(dropped);
+            }
             return send_response(client, STATUS_OK, nullptr, 0);
         }
 
         case CMD_INIT_AUDIO: {
-            if (header->payload_size < sizeof(CmdInitAudio)) {
+            // pipeline_depth and process_mode are optional: older clients send
+            // the payload without them (zero-filled below)
+            if (header->payload_size < offsetof(CmdInitAudio, pipeline_depth)) {
                 return send_response(client, STATUS_INVALID_PARAM, nullptr, 0);
             }
-            const CmdInitAudio* cmd = (const CmdInitAudio*)payload;
-            bool ok = init_audio(cmd);
+            CmdInitAudio cmd;
+            memset(&cmd, 0, sizeof(cmd));
+            memcpy(&cmd, payload, header->payload_size < sizeof(cmd) ? header->payload_size : sizeof(cmd));
+            bool ok = init_audio(&cmd);
             return send_response(client, ok ? STATUS_OK : STATUS_ERROR, nullptr, 0);
         }
 
         case CMD_PROCESS_AUDIO: {
-            if (!g_plugin.processing) {
+            if (!g_instance->audio.active) {
                 return send_response(client, STATUS_NOT_INITIALIZED, nullptr, 0);
             }
-            uint32_t num_samples = g_plugin.block_size;
+            uint32_t num_samples = g_instance->audio.block_size;
             if (header->payload_size >= sizeof(CmdProcessAudio)) {
                 const CmdProcessAudio* cmd = (const CmdProcessAudio*)payload;
                 num_samples = cmd->num_samples;
             }
-            bool ok = process_audio(num_samples);
+            // Synchronous path always uses block slot 0, which the realtime
+            // thread owns while it runs
+            if (g_instance->rt_thread) {
+                return send_response(client, STATUS_ERROR, nullptr, 0);
+            }
+            bool ok = process_audio(0, num_samples);
+            return send_response(client, ok ? STATUS_OK : STATUS_ERROR, nullptr, 0);
+        }
+
+        case CMD_START_REALTIME: {
+            if (!g_instance->audio.active) {
+                return send_response(client, STATUS_NOT_INITIALIZED, nullptr, 0);
+            }
+            bool ok = start_realtime();
             return send_response(client, ok ? STATUS_OK : STATUS_ERROR, nullptr, 0);
         }
 
+        case CMD_STOP_REALTIME: {
+            stop_realtime();
+            return send_response(client, STATUS_OK, nullptr, 0);
+        }
+
         case CMD_OPEN_EDITOR: {
-            if (!g_plugin.loaded) {
+            if (!g_instance->plugin->loaded) {
                 return send_response(client, STATUS_NOT_LOADED, nullptr, 0);
             }
             RespEditorInfo resp;
@@ -1542,7 +3316,7 @@ bool handle_command(SOCKET client, const RackWineHeader* header, const uint8_t*
         }
 
         case CMD_GET_EDITOR_SIZE: {
-            if (!g_plugin.view) {
+            if (!g_instance->plugin->view) {
                 return send_response(client, STATUS_ERROR, nullptr, 0);
             }
             RespEditorSize resp;
@@ -1552,23 +3326,57 @@ bool handle_command(SOCKET client, const RackWineHeader* header, const uint8_t*
 
         case CMD_GET_PARAM_CHANGES: {
             // Get pending parameter changes from GUI
-            int count = g_plugin.componentHandler.getPendingCount();
+            int count = g_instance->plugin->componentHandler.getPendingCount();
 
             // Build response: header + array of changes
-            size_t resp_size = sizeof(RespParamChanges) + count * sizeof(ParamChangeEvent);
+            size_t resp_size = sizeof(RespParamChanges) + count * sizeof(ParamChangeEvent) + sizeof(uint64_t);
             uint8_t* resp_buf = (uint8_t*)alloca(resp_size);
             RespParamChanges* resp = (RespParamChanges*)resp_buf;
             ParamChangeEvent* events = (ParamChangeEvent*)(resp_buf + sizeof(RespParamChanges));
 
             resp->num_changes = 0;
             Steinberg::ParamChange change;
-            while (g_plugin.componentHandler.getNextChange(&change) && resp->num_changes < (uint32_t)count) {
+            while (g_instance->plugin->componentHandler.getNextChange(&change) && resp->num_changes < (uint32_t)count) {
                 events[resp->num_changes].param_id = change.param_id;
                 events[resp->num_changes].value = change.value;
                 resp->num_changes++;
             }
 
-            return send_response(client, STATUS_OK, resp_buf, sizeof(RespParamChanges) + resp->num_changes * sizeof(ParamChangeEvent));
+            // Trailing cumulative overflow counter
+            uint64_t overflows = g_instance->plugin->componentHandler.getOverflowCount();
+            size_t events_size = sizeof(RespParamChanges) + resp->num_changes * sizeof(ParamChangeEvent);
+            memcpy(resp_buf + events_size, &overflows, sizeof(overflows));
+
+            return send_response(client, STATUS_OK, resp_buf, events_size + sizeof(overflows));
+        }
+
+        case CMD_SET_STATE_REGION: {
+            if (header->payload_size < sizeof(CmdStateRegion)) {
+                return send_response(client, STATUS_INVALID_PARAM, nullptr, 0);
+            }
+            bool ok = map_state_region((const CmdStateRegion*)payload);
+            return send_response(client, ok ? STATUS_OK : STATUS_ERROR, nullptr, 0);
+        }
+
+        case CMD_GET_STATE: {
+            if (!g_instance->plugin->loaded || !g_instance->plugin->component) {
+                return send_response(client, STATUS_NOT_LOADED, nullptr, 0);
+            }
+            RespState resp;
+            resp.size = 0;
+            uint32_t status = save_state(&resp.size);
+            return send_response(client, status, &resp, sizeof(resp));
+        }
+
+        case CMD_SET_STATE: {
+            if (header->payload_size < sizeof(CmdState)) {
+                return send_response(client, STATUS_INVALID_PARAM, nullptr, 0);
+            }
+            if (!g_instance->plugin->loaded || !g_instance->plugin->component) {
+                return send_response(client, STATUS_NOT_LOADED, nullptr, 0);
+            }
+            uint32_t status = load_state(((const CmdState*)payload)->size);
+            return send_response(client, status, nullptr, 0);
         }
 
         case CMD_SHUTDOWN: {
@@ -1583,6 +3391,79 @@ bool handle_command(SOCKET client, const RackWineHeader* header, const uint8_t*
     }
 }
 
+// ============================================================================
+// Server
+// ============================================================================
+
+// Keep listening after the last client disconnects (--persistent). Without
+// it the host exits once every session it served has ended.
+static bool g_persistent = false;
+static SOCKET g_server_socket = INVALID_SOCKET;
+static volatile LONG g_server_closed = 0;
+static volatile LONG g_sessions = 0;
+
+// Close the listening socket once, from whichever thread gets there first
+static void close_server_socket() {
+    if (InterlockedCompareExchange(&g_server_closed, 1, 0) == 0) {
+        closesocket(g_server_socket);
+    }
+}
+
+// Serve one connection with its own instance until the client disconnects
+// or sends CMD_SHUTDOWN
+static DWORD WINAPI session_thread_proc(LPVOID param) {
+    SOCKET client_socket = (SOCKET)(uintptr_t)param;
+
+    g_instance = new (std::nothrow) HostInstance();
+    if (g_instance) {
+        printf("[HOST] Client connected\n");
+
+        bool running = true;
+        while (running) {
+            RackWineHeader header;
+            int received = recv(client_socket, (char*)&header, sizeof(header), MSG_WAITALL);
+
+            if (received <= 0) break;
+            if (received != sizeof(header)) break;
+            if (header.magic != RACK_WINE_MAGIC) break;
+            if (header.version != RACK_WINE_PROTOCOL_VERSION) break;
+
+            if (header.payload_size > RACK_WINE_MAX_PAYLOAD) break;
+
+            uint8_t* payload = nullptr;
+            if (header.payload_size > 0) {
+                g_instance->rx_buffer.size = 0;
+                payload = buffer_append(g_instance->rx_buffer, header.payload_size);
+                if (!payload) {
+                    printf("[HOST] Out of memory for %u byte message\n", header.payload_size);
+                    break;
+                }
+                received = recv(client_socket, (char*)payload, header.payload_size, MSG_WAITALL);
+                if (received != (int)header.payload_size) break;
+            }
+
+            running = handle_command(client_socket, &header, payload);
+        }
+
+        unload_all_plugins();
+        release_state_region();
+        buffer_free(g_instance->rx_buffer);
+        buffer_free(g_instance->tx_buffer);
+        delete g_instance;
+        g_instance = nullptr;
+        printf("[HOST] Client disconnected\n");
+    } else {
+        printf("[HOST] ERROR: Out of memory for a new instance\n");
+    }
+    closesocket(client_socket);
+
+    // Last session gone: unblock accept() so the host can exit
+    if (InterlockedDecrement(&g_sessions) == 0 && !g_persistent) {
+        close_server_socket();
+    }
+    return 0;
+}
+
 int run_server() {
     WSADATA wsa_data;
     if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
@@ -1621,7 +3502,7 @@ int run_server() {
         return 1;
     }
 
-    if (listen(server_socket, 1) == SOCKET_ERROR) {
+    if (listen(server_socket, SOMAXCONN) == SOCKET_ERROR) {
         printf("[HOST] Listen failed\n");
         closesocket(server_socket);
         WSACleanup();
@@ -1631,45 +3512,36 @@ int run_server() {
     printf("PORT=%d\n", port);
     fflush(stdout);
 
-    printf("[HOST] Listening on 127.0.0.1:%d\n", port);
+    printf("[HOST] Listening on 127.0.0.1:%d%s\n", port, g_persistent ? " (persistent)" : "");
 
-    SOCKET client_socket = accept(server_socket, nullptr, nullptr);
-    if (client_socket == INVALID_SOCKET) {
-        printf("[HOST] Accept failed\n");
-        closesocket(server_socket);
-        WSACleanup();
-        return 1;
-    }
-
-    printf("[HOST] Client connected\n");
-
-    bool running = true;
-    while (running) {
-        RackWineHeader header;
-        int received = recv(client_socket, (char*)&header, sizeof(header), MSG_WAITALL);
-
-        if (received <= 0) break;
-        if (received != sizeof(header)) break;
-        if (header.magic != RACK_WINE_MAGIC) break;
-        if (header.version != RACK_WINE_PROTOCOL_VERSION) break;
+    // One thread per connection; each runs its own instance and, once audio
+    // is up, its own audio thread
+    g_server_socket = server_socket;
+    while (true) {
+        SOCKET client_socket = accept(server_socket, nullptr, nullptr);
+        if (client_socket == INVALID_SOCKET) {
+            break;
+        }
 
-        uint8_t* payload = nullptr;
-        if (header.payload_size > 0) {
-            payload = new uint8_t[header.payload_size];
-            received = recv(client_socket, (char*)payload, header.payload_size, MSG_WAITALL);
-            if (received != (int)header.payload_size) {
-                delete[] payload;
+        // Responses go out as a header and a payload send(); without this the
+        // payload waits on the client's delayed ACK of the header
+        int nodelay = 1;
+        setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&nodelay, sizeof(nodelay));
+
+        InterlockedIncrement(&g_sessions);
+        HANDLE thread = CreateThread(NULL, 0, session_thread_proc, (LPVOID)(uintptr_t)client_socket, 0, NULL);
+        if (!thread) {
+            printf("[HOST] ERROR: Failed to create session thread (%lu)\n", GetLastError());
+            closesocket(client_socket);
+            if (InterlockedDecrement(&g_sessions) == 0 && !g_persistent) {
                 break;
             }
+            continue;
         }
-
-        running = handle_command(client_socket, &header, payload);
-        delete[] payload;
+        CloseHandle(thread);
     }
 
-    unload_plugin();
-    closesocket(client_socket);
-    closesocket(server_socket);
+    close_server_socket();
     WSACleanup();
 
     printf("[HOST] Server shutdown\n");
@@ -1677,8 +3549,19 @@ int run_server() {
 }
 
 int main(int argc, char* argv[]) {
-    (void)argc;
-    (void)argv;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--persistent") == 0) {
+            g_persistent = true;
+        }
+    }
     printf("=== rack-wine-host v0.3 ===\n\n");
-    return run_server();
+
+    InitializeCriticalSection(&g_host_lock);
+    g_have_futex = detect_futex();
+    printf("[HOST] Doorbell wakeup: %s\n", g_have_futex ? "futex" : "polling");
+    printf("[HOST] Sample kernels: %s\n", rack::convert_isa());
+
+    int result = run_server();
+    DeleteCriticalSection(&g_host_lock);
+    return result;
 }
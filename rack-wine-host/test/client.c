@@ -10,7 +10,10 @@
 #include <sys/socket.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #include <fcntl.h>
+#include <time.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 
@@ -75,7 +78,7 @@ int create_shared_memory(uint32_t num_inputs, uint32_t num_outputs, uint32_t blo
     // Create a unique name based on PID
     snprintf(shm_name, sizeof(shm_name), "/tmp/rack-wine-audio-%d", getpid());
 
-    shm_size = RACK_WINE_SHM_SIZE(num_inputs, num_outputs, block_size);
+    shm_size = RACK_WINE_SHM_SIZE_EVENTS(num_inputs, num_outputs, block_size, 1, RACK_WINE_SAMPLE_F32);
 
     // Create as regular file (Wine can access /tmp through Z: drive)
     shm_fd = open(shm_name, O_RDWR | O_CREAT | O_TRUNC, 0666);
@@ -112,6 +115,8 @@ int create_shared_memory(uint32_t num_inputs, uint32_t num_outputs, uint32_t blo
     hdr->sample_rate = 48000;
     hdr->input_offset = sizeof(RackWineShmHeader);
     hdr->output_offset = sizeof(RackWineShmHeader) + num_inputs * block_size * sizeof(float);
+    hdr->events_offset = (uint32_t)RACK_WINE_SHM_EVENTS_OFFSET(num_inputs, num_outputs, block_size, 1,
+                                                               RACK_WINE_SAMPLE_F32);
 
     printf("Shared memory created: %s (%zu bytes)\n", shm_name, shm_size);
     printf("  Input offset: %u, Output offset: %u\n", hdr->input_offset, hdr->output_offset);
@@ -166,6 +171,44 @@ float calculate_output_rms(uint32_t num_samples) {
     return sqrtf(sum / (hdr->num_outputs * num_samples));
 }
 
+// Ring the realtime doorbell and wait for the host to finish the block
+// Returns 0 on success, -1 on timeout or if the host reports an error
+int rt_process_block(uint32_t num_samples) {
+    RackWineShmHeader* hdr = (RackWineShmHeader*)shm_ptr;
+    uint32_t seq = hdr->client_ready + 1;
+
+    hdr->slot_samples[0] = num_samples;  // Synchronous: always block slot 0
+    __atomic_store_n(&hdr->client_ready, seq, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&hdr->host_waiting, __ATOMIC_SEQ_CST)) {
+        syscall(SYS_futex, &hdr->client_ready, FUTEX_WAKE, 1, NULL, NULL, 0);
+    }
+
+    for (int i = 0; i < RACK_WINE_RT_SPIN_COUNT; i++) {
+        if (__atomic_load_n(&hdr->host_ready, __ATOMIC_ACQUIRE) == seq) goto done;
+        __builtin_ia32_pause();
+    }
+
+    // Park until the host completes, giving up after ~2 seconds
+    for (int round = 0; round < 2000; round++) {
+        __atomic_store_n(&hdr->client_waiting, 1, __ATOMIC_SEQ_CST);
+        uint32_t done_seq = __atomic_load_n(&hdr->host_ready, __ATOMIC_SEQ_CST);
+        if (done_seq != seq) {
+            if (hdr->rt_flags & RACK_WINE_RT_FUTEX) {
+                struct timespec timeout = {0, 1000000};
+                syscall(SYS_futex, &hdr->host_ready, FUTEX_WAIT, done_seq, &timeout, NULL, 0);
+            } else {
+                usleep(1000);
+            }
+        }
+        __atomic_store_n(&hdr->client_waiting, 0, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&hdr->host_ready, __ATOMIC_ACQUIRE) == seq) goto done;
+    }
+    return -1;
+
+done:
+    return (hdr->rt_flags & RACK_WINE_RT_ERROR) ? -1 : 0;
+}
+
 int main(int argc, char* argv[]) {
     if (argc < 3) {
         fprintf(stderr, "Usage: %s <port> <vst3_path>\n", argv[0]);
@@ -474,8 +517,95 @@ int main(int argc, char* argv[]) {
     }
     printf("  OK\n\n");
 
-    // Test 10: SHUTDOWN
-    printf("Test 10: SHUTDOWN\n");
+    // Test 10: Realtime doorbell (no socket round trip per block)
+    printf("Test 10: Realtime doorbell\n");
+    {
+        if (send_command(CMD_START_REALTIME, NULL, 0) < 0) { result = 1; goto cleanup; }
+        if (recv_response(&resp, payload_buf, sizeof(payload_buf)) < 0) { result = 1; goto cleanup; }
+        if (resp.status != STATUS_OK) {
+            printf("  FAILED to start realtime mode (status=%u)\n", resp.status);
+            result = 1; goto cleanup;
+        }
+
+        RackWineShmHeader* hdr = (RackWineShmHeader*)shm_ptr;
+        printf("  Wakeup: %s\n", (hdr->rt_flags & RACK_WINE_RT_FUTEX) ? "futex" : "polling");
+
+        uint32_t num_samples = 64;
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < 1000; i++) {
+            fill_test_input(num_samples);
+            if (rt_process_block(num_samples) < 0) {
+                printf("  FAILED at block %d\n", i);
+                result = 1; goto cleanup;
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double elapsed_us = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_nsec - start.tv_nsec) / 1e3;
+        printf("  1000 blocks of %u samples, %.1f us/block\n", num_samples, elapsed_us / 1000.0);
+
+        if (send_command(CMD_STOP_REALTIME, NULL, 0) < 0) { result = 1; goto cleanup; }
+        if (recv_response(&resp, payload_buf, sizeof(payload_buf)) < 0) { result = 1; goto cleanup; }
+    }
+    printf("  OK\n\n");
+
+    // Test 11: Plugin chain (second instance in slot 1, same process)
+    printf("Test 11: Plugin chain\n");
+    {
+        CmdSelectSlot select_cmd;
+        select_cmd.slot = 1;
+        if (send_command(CMD_SELECT_SLOT, &select_cmd, sizeof(select_cmd)) < 0) { result = 1; goto cleanup; }
+        if (recv_response(&resp, payload_buf, sizeof(payload_buf)) < 0) { result = 1; goto cleanup; }
+
+        CmdLoadPlugin load_cmd;
+        memset(&load_cmd, 0, sizeof(load_cmd));
+        strncpy(load_cmd.path, vst3_path, sizeof(load_cmd.path) - 1);
+        if (send_command(CMD_LOAD_PLUGIN, &load_cmd, sizeof(load_cmd)) < 0) { result = 1; goto cleanup; }
+        if (recv_response(&resp, payload_buf, sizeof(payload_buf)) < 0) { result = 1; goto cleanup; }
+        if (resp.status != STATUS_OK) {
+            printf("  FAILED to load plugin into slot 1 (status=%u)\n", resp.status);
+            result = 1; goto cleanup;
+        }
+
+        select_cmd.slot = 0;
+        if (send_command(CMD_SELECT_SLOT, &select_cmd, sizeof(select_cmd)) < 0) { result = 1; goto cleanup; }
+        if (recv_response(&resp, payload_buf, sizeof(payload_buf)) < 0) { result = 1; goto cleanup; }
+
+        // Serial (0 -> 1), then parallel (0 + 1)
+        const uint32_t serial[] = {0x1, 0x2};
+        const uint32_t parallel[] = {0x3};
+        const uint32_t* chains[] = {serial, parallel};
+        const uint32_t chain_stages[] = {2, 1};
+        const char* chain_names[] = {"serial", "parallel"};
+
+        for (int c = 0; c < 2; c++) {
+            CmdSetChain chain_cmd;
+            memset(&chain_cmd, 0, sizeof(chain_cmd));
+            chain_cmd.num_stages = chain_stages[c];
+            memcpy(chain_cmd.stage_masks, chains[c], chain_stages[c] * sizeof(uint32_t));
+            if (send_command(CMD_SET_CHAIN, &chain_cmd, sizeof(chain_cmd)) < 0) { result = 1; goto cleanup; }
+            if (recv_response(&resp, payload_buf, sizeof(payload_buf)) < 0) { result = 1; goto cleanup; }
+            if (resp.status != STATUS_OK) {
+                printf("  FAILED to set %s chain (status=%u)\n", chain_names[c], resp.status);
+                result = 1; goto cleanup;
+            }
+
+            fill_test_input(512);
+            CmdProcessAudio proc_cmd;
+            proc_cmd.num_samples = 512;
+            if (send_command(CMD_PROCESS_AUDIO, &proc_cmd, sizeof(proc_cmd)) < 0) { result = 1; goto cleanup; }
+            if (recv_response(&resp, payload_buf, sizeof(payload_buf)) < 0) { result = 1; goto cleanup; }
+            if (resp.status != STATUS_OK) {
+                printf("  FAILED to process %s chain (status=%u)\n", chain_names[c], resp.status);
+                result = 1; goto cleanup;
+            }
+            printf("  %s chain output RMS: %.4f\n", chain_names[c], calculate_output_rms(512));
+        }
+    }
+    printf("  OK\n\n");
+
+    // Test 12: SHUTDOWN
+    printf("Test 12: SHUTDOWN\n");
     if (send_command(CMD_SHUTDOWN, NULL, 0) < 0) { result = 1; goto cleanup; }
     if (recv_response(&resp, payload_buf, sizeof(payload_buf)) < 0) { result = 1; goto cleanup; }
     printf("  OK\n\n");
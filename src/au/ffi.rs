@@ -23,6 +23,11 @@ pub struct RackAUGui {
     _private: [u8; 0],
 }
 
+#[repr(C)]
+pub struct RackAUPool {
+    _private: [u8; 0],
+}
+
 // Plugin type enum
 #[repr(C)]
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
@@ -52,8 +57,12 @@ pub const RACK_AU_ERROR_GENERIC: c_int = -1;
 pub const RACK_AU_ERROR_NOT_FOUND: c_int = -2;
 pub const RACK_AU_ERROR_INVALID_PARAM: c_int = -3;
 pub const RACK_AU_ERROR_NOT_INITIALIZED: c_int = -4;
+pub const RACK_AU_ERROR_NOT_SUPPORTED: c_int = -6;
 pub const RACK_AU_ERROR_AUDIO_UNIT: c_int = -1000;
 
+/// Process-time histogram size of `RackAUPluginStats`
+pub const RACK_AU_STATS_HISTOGRAM_BUCKETS: usize = 32;
+
 extern "C" {
     // ============================================================================
     // Scanner API
@@ -112,6 +121,44 @@ extern "C" {
         max_plugins: usize,
     ) -> c_int;
 
+    /// Scan for plugins in a single pass
+    ///
+    /// # Returns
+    ///
+    /// - On success: number of plugins found; `*plugins` points to that many entries
+    /// - On error: negative error code (see RACK_AU_ERROR_* constants)
+    ///
+    /// # Safety
+    ///
+    /// - `scanner` must be a valid pointer returned by `rack_au_scanner_new`
+    /// - `plugins` must be valid for writes
+    /// - The returned array is owned by the scanner and is valid until the next
+    ///   scan or `rack_au_scanner_free`
+    pub fn rack_au_scanner_scan_results(
+        scanner: *mut RackAUScanner,
+        plugins: *mut *const RackAUPluginInfo,
+    ) -> c_int;
+
+    /// Get the registration generation (bumped on every AudioUnit registration change)
+    ///
+    /// # Safety
+    ///
+    /// - `scanner` must be a valid pointer returned by `rack_au_scanner_new`
+    /// - Thread-safety: may be called from any thread
+    pub fn rack_au_scanner_generation(scanner: *const RackAUScanner) -> u64;
+
+    /// Force the next scan to re-walk the component list
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `scanner` must be a valid pointer returned by `rack_au_scanner_new`
+    pub fn rack_au_scanner_invalidate(scanner: *mut RackAUScanner) -> c_int;
+
     // ============================================================================
     // Plugin Instance API (for future phases)
     // ============================================================================
@@ -136,6 +183,49 @@ extern "C" {
     /// - If `plugin` is NULL, this function does nothing (safe no-op)
     pub fn rack_au_plugin_free(plugin: *mut RackAUPlugin);
 
+    /// Create a new instance of the same AudioComponent with the source's
+    /// state (initialized like the source)
+    ///
+    /// # Safety
+    ///
+    /// - `source` must be a valid pointer
+    /// - Returns NULL on error; the returned pointer must be freed with
+    ///   `rack_au_plugin_free`
+    pub fn rack_au_plugin_clone(source: *mut RackAUPlugin) -> *mut RackAUPlugin;
+
+    /// Create a pool of up to `size` ready clones of `prototype`, refilled
+    /// on a background thread
+    ///
+    /// # Safety
+    ///
+    /// - `prototype` must be a valid pointer
+    /// - Returns NULL on error; the returned pointer must be freed with
+    ///   `rack_au_pool_free`
+    pub fn rack_au_pool_new(prototype: *mut RackAUPlugin, size: u32) -> *mut RackAUPool;
+
+    /// Free a pool and its spare instances
+    ///
+    /// # Safety
+    ///
+    /// - `pool` must be a valid pointer returned by `rack_au_pool_new`
+    /// - `pool` must not be used after this call
+    pub fn rack_au_pool_free(pool: *mut RackAUPool);
+
+    /// Take a ready instance out of the pool (NULL if empty)
+    ///
+    /// # Safety
+    ///
+    /// - `pool` must be a valid pointer
+    /// - The returned pointer must be freed with `rack_au_plugin_free`
+    pub fn rack_au_pool_acquire(pool: *mut RackAUPool) -> *mut RackAUPlugin;
+
+    /// Number of ready instances, or negative error code
+    ///
+    /// # Safety
+    ///
+    /// - `pool` must be a valid pointer
+    pub fn rack_au_pool_available(pool: *mut RackAUPool) -> c_int;
+
     /// Initialize plugin with sample rate and buffer size
     ///
     /// # Returns
@@ -249,6 +339,150 @@ extern "C" {
         frames: u32,
     ) -> c_int;
 
+    /// Process buffers of any length, splitting them into `max_block_size`
+    /// sub-blocks and routing queued MIDI to the sub-block it falls in
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - The first failing sub-block's negative error code
+    ///
+    /// # Safety
+    ///
+    /// - Same requirements as `rack_au_plugin_process`, except that `frames`
+    ///   may exceed `max_block_size`
+    pub fn rack_au_plugin_process_split(
+        plugin: *mut RackAUPlugin,
+        inputs: *const *const f32,
+        num_input_channels: u32,
+        outputs: *const *mut f32,
+        num_output_channels: u32,
+        frames: u32,
+    ) -> c_int;
+
+    /// Enable or disable offline rendering (kAudioUnitProperty_OfflineRender)
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - RACK_AU_ERROR_AUDIO_UNIT + OSStatus if the AudioUnit rejects it
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - Must not be called concurrently with `rack_au_plugin_process`
+    pub fn rack_au_plugin_set_offline_render(plugin: *mut RackAUPlugin, enabled: c_int) -> c_int;
+
+    /// Render buffers of any length in `max_block_size` chunks
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - Same requirements as `rack_au_plugin_process`, except that each
+    ///   channel buffer must hold `total_frames` values, which may exceed
+    ///   `max_block_size`
+    pub fn rack_au_plugin_render_offline(
+        plugin: *mut RackAUPlugin,
+        inputs: *const *const f32,
+        num_input_channels: u32,
+        outputs: *const *mut f32,
+        num_output_channels: u32,
+        total_frames: u64,
+    ) -> c_int;
+
+    /// Enable or disable idle sleep (skip processing once the input has been
+    /// silent for longer than the plugin's tail)
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    pub fn rack_au_plugin_set_idle_sleep(plugin: *mut RackAUPlugin, enabled: c_int) -> c_int;
+
+    /// Get the number of blocks processed and skipped while asleep
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - `processed` and `skipped` must each be valid or null
+    pub fn rack_au_plugin_get_block_counts(plugin: *mut RackAUPlugin, processed: *mut u64, skipped: *mut u64) -> c_int;
+
+    /// Snapshot the instance's processing statistics
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - RACK_AU_ERROR_NOT_SUPPORTED if built without performance counters
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - `stats` must be a valid pointer
+    pub fn rack_au_plugin_get_stats(plugin: *mut RackAUPlugin, stats: *mut RackAUPluginStats) -> c_int;
+
+    /// Zero the processing statistics
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    pub fn rack_au_plugin_reset_stats(plugin: *mut RackAUPlugin) -> c_int;
+
+    /// Lock the instance's preallocated buffers into RAM through a realtime context
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - `ctx` must be a valid pointer returned by `rack_rt_context_enter`
+    pub fn rack_au_plugin_lock_memory(plugin: *mut RackAUPlugin, ctx: *mut crate::rt::RackRtContext) -> c_int;
+
+    /// Get the number of input renders delivered zero-copy and by copying
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - `zero_copy` and `copied` must each be valid or null
+    pub fn rack_au_plugin_get_input_copy_counts(plugin: *mut RackAUPlugin, zero_copy: *mut u64, copied: *mut u64) -> c_int;
+
+    /// Get the unit's latency and tail in samples
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - RACK_AU_ERROR_NOT_INITIALIZED before initialize
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - `latency_samples` and `tail_samples` must each be valid or null
+    pub fn rack_au_plugin_get_latency(plugin: *mut RackAUPlugin, latency_samples: *mut u32, tail_samples: *mut u32) -> c_int;
+
+    /// Counter that advances whenever the latency or tail changes
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer or null
+    pub fn rack_au_plugin_get_latency_generation(plugin: *mut RackAUPlugin) -> u32;
+
     /// Get parameter count
     ///
     /// # Returns
@@ -297,6 +531,22 @@ extern "C" {
         value: f32,
     ) -> c_int;
 
+    /// Map a native AudioUnitParameterID to its parameter index
+    ///
+    /// # Returns
+    ///
+    /// - Parameter index (>= 0) on success
+    /// - RACK_AU_ERROR_NOT_FOUND if the ID is unknown
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer returned by `rack_au_plugin_new`
+    pub fn rack_au_plugin_param_index_for_id(
+        plugin: *mut RackAUPlugin,
+        param_id: u32,
+    ) -> c_int;
+
     /// Get parameter info (name, min, max, default, unit)
     ///
     /// # Returns
@@ -416,6 +666,21 @@ extern "C" {
         size: *mut usize,
     ) -> c_int;
 
+    /// Serialize the plugin state once into a plugin-owned buffer
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success (`*data`/`*size` describe the state)
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - `data` and `size` must be valid pointers
+    /// - The returned data is owned by the plugin and is invalidated by the
+    ///   next state call on it (see the C header)
+    pub fn rack_au_plugin_snapshot_state(plugin: *mut RackAUPlugin, data: *mut *const u8, size: *mut usize) -> c_int;
+
     /// Set plugin state (restore full state including parameters, preset, etc.)
     ///
     /// # Returns
@@ -485,6 +750,24 @@ pub enum RackAUMidiEventType {
     SystemReset = 0xFF,
 }
 
+// Processing statistics struct (matches C layout exactly)
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct RackAUPluginStats {
+    pub process_calls: u64,
+    pub frames: u64,
+    pub total_ns: u64,
+    pub max_ns: u64,
+    pub deadline_ns: u64,
+    pub deadline_misses: u64,
+    pub max_load: f64,
+    pub average_load: f64,
+    pub process_errors: u64,
+    pub dropped_midi_events: u64,
+    pub dropped_param_changes: u64,
+    pub histogram: [u64; RACK_AU_STATS_HISTOGRAM_BUCKETS],
+}
+
 // MIDI event struct (matches C layout exactly)
 #[repr(C)]
 #[derive(Debug, Clone, Copy)]
@@ -1,4 +1,5 @@
-use crate::{Error, MidiEvent, MidiEventKind, ParameterInfo, PluginInfo, PluginInstance, PresetInfo, Result};
+use crate::graph::{GraphNode, RawProcessor};
+use crate::{Error, LatencyInfo, MidiEvent, MidiEventKind, ParameterInfo, PluginInfo, PluginInstance, PresetInfo, ProcessStats, Result};
 use smallvec::SmallVec;
 use std::ffi::CString;
 use std::marker::PhantomData;
@@ -64,21 +65,42 @@ impl AudioUnitPlugin {
             })
         }
     }
-}
 
-impl PluginInstance for AudioUnitPlugin {
-    fn initialize(&mut self, sample_rate: f64, max_block_size: usize) -> Result<()> {
-        unsafe {
-            let result = ffi::rack_au_plugin_initialize(
-                self.inner.as_ptr(),
-                sample_rate,
-                max_block_size as u32,
-            );
+    /// Create another instance of this plugin with the same state
+    ///
+    /// The state (ClassInfo) goes from one unit to the other without being
+    /// serialized. Offline render and idle sleep settings carry over. If this
+    /// instance is initialized, the clone is initialized with the same sample
+    /// rate and block size.
+    pub fn try_clone(&mut self) -> Result<Self> {
+        let ptr = unsafe { ffi::rack_au_plugin_clone(self.inner.as_ptr()) };
+        let inner = NonNull::new(ptr).ok_or_else(|| {
+            Error::Other(format!("Failed to clone AudioUnit instance of {}", self.info.name))
+        })?;
+        Self::from_raw(inner, self.info.clone())
+    }
 
-            if result != ffi::RACK_AU_OK {
-                return Err(map_error(result));
-            }
+    /// Wrap an instance created by the C API, initialized or not
+    fn from_raw(inner: NonNull<ffi::RackAUPlugin>, info: PluginInfo) -> Result<Self> {
+        let mut plugin = Self {
+            inner,
+            info,
+            input_ptrs: Vec::new(),
+            output_ptrs: Vec::new(),
+            input_channels: 0,
+            output_channels: 0,
+            _not_sync: PhantomData,
+        };
+        if plugin.is_initialized() {
+            plugin.configure_channels()?;
+        }
+        Ok(plugin)
+    }
 
+    /// Query the channel configuration after initialization and size the
+    /// pre-allocated pointer arrays for it
+    fn configure_channels(&mut self) -> Result<()> {
+        unsafe {
             // Query actual channel configuration
             let input_channels = ffi::rack_au_plugin_get_input_channels(self.inner.as_ptr());
             let output_channels = ffi::rack_au_plugin_get_output_channels(self.inner.as_ptr());
@@ -89,19 +111,91 @@ impl PluginInstance for AudioUnitPlugin {
 
             self.input_channels = input_channels as usize;
             self.output_channels = output_channels as usize;
+        }
 
-            // Pre-allocate pointer arrays for zero-allocation process() calls
-            // Reserve capacity to avoid reallocation even if channel counts are unusual
-            self.input_ptrs = Vec::with_capacity(self.input_channels.max(8));
-            self.output_ptrs = Vec::with_capacity(self.output_channels.max(8));
+        // Pre-allocate pointer arrays for zero-allocation process() calls
+        // Reserve capacity to avoid reallocation even if channel counts are unusual
+        self.input_ptrs = Vec::with_capacity(self.input_channels.max(8));
+        self.output_ptrs = Vec::with_capacity(self.output_channels.max(8));
 
-            // Initialize with null pointers (will be filled in process())
-            self.input_ptrs.resize(self.input_channels, std::ptr::null());
-            self.output_ptrs.resize(self.output_channels, std::ptr::null_mut());
+        // Initialize with null pointers (will be filled in process())
+        self.input_ptrs.resize(self.input_channels, std::ptr::null());
+        self.output_ptrs.resize(self.output_channels, std::ptr::null_mut());
 
-            Ok(())
+        Ok(())
+    }
+}
+
+/// A pool of ready instances of one AudioUnit
+///
+/// Keeps up to `size` clones of a prototype instance (see
+/// [`AudioUnitPlugin::try_clone`]) created and initialized ahead of time, so
+/// [`acquire`](Self::acquire) hands one out in microseconds. A background
+/// thread refills the pool whenever an instance is taken. Clones carry the
+/// prototype's state and settings from when the pool was created; the
+/// prototype may be dropped afterwards.
+pub struct AudioUnitPool {
+    inner: NonNull<ffi::RackAUPool>,
+    info: PluginInfo,
+}
+
+// Safety: the C pool API is thread-safe
+unsafe impl Send for AudioUnitPool {}
+unsafe impl Sync for AudioUnitPool {}
+
+impl AudioUnitPool {
+    /// Create a pool of up to `size` instances of `prototype`
+    pub fn new(prototype: &mut AudioUnitPlugin, size: usize) -> Result<Self> {
+        let ptr = unsafe { ffi::rack_au_pool_new(prototype.inner.as_ptr(), size as u32) };
+        let inner = NonNull::new(ptr).ok_or_else(|| {
+            Error::Other(format!("Failed to create AudioUnit instance pool for {}", prototype.info.name))
+        })?;
+        Ok(Self {
+            inner,
+            info: prototype.info.clone(),
+        })
+    }
+
+    /// Take a ready instance, or `None` if the pool is empty (still
+    /// refilling, or creating instances failed). Never waits for an instance
+    /// to be created; not for the audio thread.
+    pub fn acquire(&self) -> Option<AudioUnitPlugin> {
+        let ptr = unsafe { ffi::rack_au_pool_acquire(self.inner.as_ptr()) };
+        let inner = NonNull::new(ptr)?;
+        AudioUnitPlugin::from_raw(inner, self.info.clone()).ok()
+    }
+
+    /// Number of ready instances
+    pub fn available(&self) -> usize {
+        let count = unsafe { ffi::rack_au_pool_available(self.inner.as_ptr()) };
+        count.max(0) as usize
+    }
+}
+
+impl Drop for AudioUnitPool {
+    fn drop(&mut self) {
+        unsafe {
+            ffi::rack_au_pool_free(self.inner.as_ptr());
         }
     }
+}
+
+impl PluginInstance for AudioUnitPlugin {
+    fn initialize(&mut self, sample_rate: f64, max_block_size: usize) -> Result<()> {
+        unsafe {
+            let result = ffi::rack_au_plugin_initialize(
+                self.inner.as_ptr(),
+                sample_rate,
+                max_block_size as u32,
+            );
+
+            if result != ffi::RACK_AU_OK {
+                return Err(map_error(result));
+            }
+        }
+
+        self.configure_channels()
+    }
 
     fn reset(&mut self) -> Result<()> {
         unsafe {
@@ -125,59 +219,14 @@ impl PluginInstance for AudioUnitPlugin {
             return Err(Error::NotInitialized);
         }
 
-        // Validate channel counts match plugin configuration
-        if inputs.len() != self.input_channels {
-            return Err(Error::Other(format!(
-                "Input channel count mismatch: plugin expects {}, got {}",
-                self.input_channels, inputs.len()
-            )));
-        }
-        if outputs.len() != self.output_channels {
-            return Err(Error::Other(format!(
-                "Output channel count mismatch: plugin expects {}, got {}",
-                self.output_channels, outputs.len()
-            )));
-        }
-
-        // Validate inputs (channel counts are now guaranteed to be correct)
-        if inputs.is_empty() || outputs.is_empty() {
-            return Err(Error::Other("Empty input or output channels".to_string()));
-        }
-
-        // Validate all channels have the same length
-        for (i, input) in inputs.iter().enumerate() {
-            if input.len() < num_frames {
-                return Err(Error::Other(format!(
-                    "Input channel {} has {} samples, need at least {}",
-                    i,
-                    input.len(),
-                    num_frames
-                )));
-            }
-        }
-
-        for (i, output) in outputs.iter().enumerate() {
-            if output.len() < num_frames {
-                return Err(Error::Other(format!(
-                    "Output channel {} has {} samples, need at least {}",
-                    i,
-                    output.len(),
-                    num_frames
-                )));
-            }
-        }
-
-        // Reuse pre-allocated pointer arrays (zero-allocation hot path)
-        // Fill with current buffer pointers
-        for (i, input_ch) in inputs.iter().enumerate() {
-            self.input_ptrs[i] = input_ch.as_ptr();
-        }
-        for (i, output_ch) in outputs.iter_mut().enumerate() {
-            self.output_ptrs[i] = output_ch.as_mut_ptr();
+        if num_frames > i32::MAX as usize {
+            return Err(Error::Other(format!("Frame count {} too large", num_frames)));
         }
+        self.fill_buffer_ptrs(inputs, outputs, num_frames)?;
 
+        // Longer-than-block buffers are split on the C++ side
         unsafe {
-            let result = ffi::rack_au_plugin_process(
+            let result = ffi::rack_au_plugin_process_split(
                 self.inner.as_ptr(),
                 self.input_ptrs.as_ptr(),
                 inputs.len() as u32,
@@ -460,33 +509,8 @@ impl PluginInstance for AudioUnitPlugin {
             return Err(Error::NotInitialized);
         }
 
-        unsafe {
-            // Get state size
-            let size = ffi::rack_au_plugin_get_state_size(self.inner.as_ptr());
-            if size <= 0 {
-                return Err(Error::Other("Failed to get plugin state size".to_string()));
-            }
-
-            // Allocate buffer
-            let mut data = vec![0u8; size as usize];
-            let mut actual_size = data.len();
-
-            // Get state data
-            let result = ffi::rack_au_plugin_get_state(
-                self.inner.as_ptr(),
-                data.as_mut_ptr(),
-                &mut actual_size,
-            );
-
-            if result != ffi::RACK_AU_OK {
-                return Err(map_error(result));
-            }
-
-            // Resize to actual size (in case it's smaller than allocated)
-            data.resize(actual_size, 0);
-
-            Ok(data)
-        }
+        // Serialized once, then copied out of the plugin-owned buffer
+        unsafe { Ok(self.snapshot_raw()?.to_vec()) }
     }
 
     fn set_state(&mut self, data: &[u8]) -> Result<()> {
@@ -513,6 +537,53 @@ impl PluginInstance for AudioUnitPlugin {
         }
     }
 
+    fn latency_info(&mut self) -> Result<LatencyInfo> {
+        let mut latency = 0u32;
+        let mut tail = 0u32;
+        let result = unsafe { ffi::rack_au_plugin_get_latency(self.inner.as_ptr(), &mut latency, &mut tail) };
+        if result != ffi::RACK_AU_OK {
+            return Err(map_error(result));
+        }
+        Ok(LatencyInfo::new(latency, tail))
+    }
+
+    fn latency_generation(&self) -> u32 {
+        unsafe { ffi::rack_au_plugin_get_latency_generation(self.inner.as_ptr()) }
+    }
+
+    fn stats(&mut self) -> Result<ProcessStats> {
+        let mut raw = ffi::RackAUPluginStats::default();
+        let result = unsafe { ffi::rack_au_plugin_get_stats(self.inner.as_ptr(), &mut raw) };
+        if result == ffi::RACK_AU_ERROR_NOT_SUPPORTED {
+            return Err(Error::Other("rack-sys was built without performance counters".to_string()));
+        }
+        if result != ffi::RACK_AU_OK {
+            return Err(map_error(result));
+        }
+        Ok(ProcessStats {
+            process_calls: raw.process_calls,
+            frames: raw.frames,
+            total_ns: raw.total_ns,
+            max_ns: raw.max_ns,
+            deadline_ns: raw.deadline_ns,
+            deadline_misses: raw.deadline_misses,
+            max_load: raw.max_load,
+            average_load: raw.average_load,
+            process_errors: raw.process_errors,
+            dropped_midi_events: raw.dropped_midi_events,
+            dropped_param_changes: raw.dropped_param_changes,
+            histogram: raw.histogram,
+        })
+    }
+
+    fn reset_stats(&mut self) -> Result<()> {
+        let result = unsafe { ffi::rack_au_plugin_reset_stats(self.inner.as_ptr()) };
+        if result != ffi::RACK_AU_OK {
+            return Err(map_error(result));
+        }
+        Ok(())
+    }
+
     fn info(&self) -> &PluginInfo {
         &self.info
     }
@@ -593,6 +664,241 @@ impl AudioUnitPlugin {
         self.output_channels
     }
 
+    /// Enable or disable offline rendering (`kAudioUnitProperty_OfflineRender`)
+    ///
+    /// Offline rendering lets the AudioUnit use its higher-quality,
+    /// non-realtime processing and be driven faster than realtime, e.g. for
+    /// bounces. May be called before or after `initialize()`.
+    pub fn set_offline_mode(&mut self, offline: bool) -> Result<()> {
+        unsafe {
+            let result = ffi::rack_au_plugin_set_offline_render(self.inner.as_ptr(), offline as i32);
+            if result != ffi::RACK_AU_OK {
+                return Err(map_error(result));
+            }
+        }
+
+        Ok(())
+    }
+
+    /// Lock the instance's preallocated processing buffers into RAM
+    ///
+    /// The buffers stay locked until `ctx` is dropped. Call after
+    /// `initialize()` (and again after re-initializing), before processing
+    /// starts. Does nothing if `ctx` was entered without `lock_memory`.
+    pub fn lock_memory(&mut self, ctx: &mut crate::rt::RtContext) -> Result<()> {
+        unsafe {
+            let result = ffi::rack_au_plugin_lock_memory(self.inner.as_ptr(), ctx.as_ptr());
+            if result != ffi::RACK_AU_OK {
+                return Err(map_error(result));
+            }
+        }
+
+        Ok(())
+    }
+
+    /// Render buffers of any length (planar format)
+    ///
+    /// Unlike `process()`, `num_frames` may exceed `max_block_size`: the
+    /// buffers are split into `max_block_size` chunks that are rendered in
+    /// order with continuous timestamps. Typically used with
+    /// [`set_offline_mode`](Self::set_offline_mode).
+    pub fn render_offline(
+        &mut self,
+        inputs: &[&[f32]],
+        outputs: &mut [&mut [f32]],
+        num_frames: usize,
+    ) -> Result<()> {
+        if !self.is_initialized() {
+            return Err(Error::NotInitialized);
+        }
+
+        self.fill_buffer_ptrs(inputs, outputs, num_frames)?;
+
+        unsafe {
+            let result = ffi::rack_au_plugin_render_offline(
+                self.inner.as_ptr(),
+                self.input_ptrs.as_ptr(),
+                inputs.len() as u32,
+                self.output_ptrs.as_ptr(),
+                outputs.len() as u32,
+                num_frames as u64,
+            );
+
+            if result != ffi::RACK_AU_OK {
+                return Err(map_error(result));
+            }
+        }
+
+        Ok(())
+    }
+
+    /// Let `process()` skip the AudioUnit once it has gone idle
+    ///
+    /// Silent input is always flagged to the AudioUnit. With idle sleep on, the
+    /// AudioUnit is not called once its input has been digital silence (with no
+    /// MIDI) for longer than its `TailTime` plus `Latency` and its last output
+    /// was silent; outputs are zero-filled instead. The first non-silent
+    /// block, MIDI event, reset or state load wakes it. Off by default;
+    /// avoid it for plugins that generate sound without input or MIDI.
+    pub fn set_idle_sleep(&mut self, enabled: bool) -> Result<()> {
+        unsafe {
+            let result = ffi::rack_au_plugin_set_idle_sleep(self.inner.as_ptr(), enabled as i32);
+            if result != ffi::RACK_AU_OK {
+                return Err(map_error(result));
+            }
+        }
+
+        Ok(())
+    }
+
+    /// Number of blocks processed and skipped while asleep, as
+    /// `(processed, skipped)`
+    pub fn block_counts(&self) -> (u64, u64) {
+        let mut processed = 0u64;
+        let mut skipped = 0u64;
+        unsafe {
+            ffi::rack_au_plugin_get_block_counts(self.inner.as_ptr(), &mut processed, &mut skipped);
+        }
+        (processed, skipped)
+    }
+
+    /// How input reached the AudioUnit, as `(zero_copy, copied)` render counts
+    ///
+    /// Units that allocate their own input buffers force a copy on every
+    /// render; a growing `copied` count identifies them.
+    pub fn input_copy_counts(&self) -> (u64, u64) {
+        let mut zero_copy = 0u64;
+        let mut copied = 0u64;
+        unsafe {
+            ffi::rack_au_plugin_get_input_copy_counts(self.inner.as_ptr(), &mut zero_copy, &mut copied);
+        }
+        (zero_copy, copied)
+    }
+
+    /// Serialize the plugin state once, without copying it
+    ///
+    /// Same bytes as [`get_state`](PluginInstance::get_state), but the state
+    /// is serialized a single time into a buffer owned by the plugin and
+    /// reused between snapshots. Suited to frequent autosave or undo
+    /// snapshots; the slice is valid until the next state call.
+    pub fn snapshot_state(&mut self) -> Result<&[u8]> {
+        if !self.is_initialized() {
+            return Err(Error::NotInitialized);
+        }
+
+        // Safety: the &mut borrow keeps other state calls away while the
+        // slice is alive
+        unsafe { self.snapshot_raw() }
+    }
+
+    /// Serialize the plugin state into `out`, reusing its allocation
+    ///
+    /// `out` is cleared first. Once it has grown to the plugin's state size,
+    /// repeated calls don't allocate.
+    pub fn get_state_into(&mut self, out: &mut Vec<u8>) -> Result<()> {
+        let state = self.snapshot_state()?;
+        out.clear();
+        out.extend_from_slice(state);
+        Ok(())
+    }
+
+    /// Take a state snapshot into the plugin-owned buffer
+    ///
+    /// # Safety
+    ///
+    /// The returned slice is invalidated by the next state call on this
+    /// plugin; the caller must not hold it across one.
+    unsafe fn snapshot_raw(&self) -> Result<&[u8]> {
+        let mut data: *const u8 = std::ptr::null();
+        let mut size: usize = 0;
+        let result = ffi::rack_au_plugin_snapshot_state(self.inner.as_ptr(), &mut data, &mut size);
+        if result != ffi::RACK_AU_OK {
+            return Err(map_error(result));
+        }
+        if data.is_null() || size == 0 {
+            return Ok(&[]);
+        }
+        Ok(std::slice::from_raw_parts(data, size))
+    }
+
+    /// Validate planar buffers against the plugin's configuration and store
+    /// their pointers in the pre-allocated pointer arrays
+    fn fill_buffer_ptrs(
+        &mut self,
+        inputs: &[&[f32]],
+        outputs: &mut [&mut [f32]],
+        num_frames: usize,
+    ) -> Result<()> {
+        // Validate channel counts match plugin configuration
+        if inputs.len() != self.input_channels {
+            return Err(Error::Other(format!(
+                "Input channel count mismatch: plugin expects {}, got {}",
+                self.input_channels, inputs.len()
+            )));
+        }
+        if outputs.len() != self.output_channels {
+            return Err(Error::Other(format!(
+                "Output channel count mismatch: plugin expects {}, got {}",
+                self.output_channels, outputs.len()
+            )));
+        }
+
+        // Validate inputs (channel counts are now guaranteed to be correct)
+        if inputs.is_empty() || outputs.is_empty() {
+            return Err(Error::Other("Empty input or output channels".to_string()));
+        }
+
+        // Validate all channels have the same length
+        for (i, input) in inputs.iter().enumerate() {
+            if input.len() < num_frames {
+                return Err(Error::Other(format!(
+                    "Input channel {} has {} samples, need at least {}",
+                    i,
+                    input.len(),
+                    num_frames
+                )));
+            }
+        }
+
+        for (i, output) in outputs.iter().enumerate() {
+            if output.len() < num_frames {
+                return Err(Error::Other(format!(
+                    "Output channel {} has {} samples, need at least {}",
+                    i,
+                    output.len(),
+                    num_frames
+                )));
+            }
+        }
+
+        // Reuse pre-allocated pointer arrays (zero-allocation hot path)
+        // Fill with current buffer pointers
+        for (i, input_ch) in inputs.iter().enumerate() {
+            self.input_ptrs[i] = input_ch.as_ptr();
+        }
+        for (i, output_ch) in outputs.iter_mut().enumerate() {
+            self.output_ptrs[i] = output_ch.as_mut_ptr();
+        }
+
+        Ok(())
+    }
+
+    /// Map a native AudioUnitParameterID to its parameter index
+    ///
+    /// Backed by a hash table built at initialization, so this is O(1) and
+    /// safe to call from the audio thread. Returns `None` for unknown IDs or
+    /// before initialization.
+    pub fn param_index_for_id(&self, param_id: u32) -> Option<usize> {
+        let result = unsafe {
+            ffi::rack_au_plugin_param_index_for_id(self.inner.as_ptr(), param_id)
+        };
+        if result >= 0 {
+            Some(result as usize)
+        } else {
+            None
+        }
+    }
+
     /// Create GUI asynchronously
     ///
     /// Creates the plugin's graphical user interface. This function tries multiple
@@ -693,6 +999,44 @@ impl AudioUnitPlugin {
     }
 }
 
+/// Graph trampoline: the graph passes the plugin as an untyped instance
+unsafe extern "C" fn graph_process(
+    instance: *mut std::ffi::c_void,
+    inputs: *const *const f32,
+    num_input_channels: u32,
+    outputs: *const *mut f32,
+    num_output_channels: u32,
+    frames: u32,
+) -> std::os::raw::c_int {
+    ffi::rack_au_plugin_process(
+        instance as *mut ffi::RackAUPlugin,
+        inputs,
+        num_input_channels,
+        outputs,
+        num_output_channels,
+        frames,
+    )
+}
+
+// Safety: the C++ instance is heap-allocated and outlives the Rust wrapper's
+// moves; process() only touches that instance's own state
+unsafe impl GraphNode for AudioUnitPlugin {
+    fn raw_processor(&mut self) -> Result<RawProcessor> {
+        if !self.is_initialized() {
+            return Err(Error::NotInitialized);
+        }
+
+        unsafe {
+            Ok(RawProcessor::new(
+                self.inner.as_ptr() as *mut std::ffi::c_void,
+                graph_process,
+                self.input_channels,
+                self.output_channels,
+            ))
+        }
+    }
+}
+
 impl Drop for AudioUnitPlugin {
     fn drop(&mut self) {
         unsafe {
@@ -5,5 +5,5 @@ mod instance;
 pub mod gui;
 
 pub use scanner::AudioUnitScanner;
-pub use instance::AudioUnitPlugin;
+pub use instance::{AudioUnitPlugin, AudioUnitPool};
 pub use gui::AudioUnitGui;
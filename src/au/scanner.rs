@@ -1,6 +1,6 @@
 use crate::{Error, PluginInfo, PluginScanner, PluginType, Result};
+use std::cell::RefCell;
 use std::marker::PhantomData;
-use std::mem::MaybeUninit;
 use std::path::PathBuf;
 use std::ptr::NonNull;
 
@@ -19,6 +19,9 @@ use super::util::{c_array_to_string, map_error};
 ///   without synchronization. Wrap in `Arc<Mutex<>>` if shared access is needed.
 pub struct AudioUnitScanner {
     inner: NonNull<ffi::RackAUScanner>,
+    // Converted results of the last scan, tagged with the registration
+    // generation they were taken at
+    cache: RefCell<Option<(u64, Vec<PluginInfo>)>>,
     // PhantomData<*const ()> makes this type !Sync while keeping it Send
     // This prevents concurrent access without Arc<Mutex<>>
     _not_sync: PhantomData<*const ()>,
@@ -47,67 +50,70 @@ impl AudioUnitScanner {
             }
             Ok(Self {
                 inner: NonNull::new_unchecked(ptr),
+                cache: RefCell::new(None),
                 _not_sync: PhantomData,
             })
         }
     }
 
+    /// Registration generation
+    ///
+    /// Increases whenever AudioUnits are registered or unregistered. If it is
+    /// unchanged since the last scan, that scan's results are still current.
+    /// This is cheap and does not scan.
+    pub fn generation(&self) -> u64 {
+        unsafe { ffi::rack_au_scanner_generation(self.inner.as_ptr()) }
+    }
+
+    /// Force the next scan to re-read the component list
+    ///
+    /// Only needed if registration change notifications may have been missed.
+    pub fn invalidate(&mut self) {
+        unsafe {
+            ffi::rack_au_scanner_invalidate(self.inner.as_ptr());
+        }
+        self.cache.borrow_mut().take();
+    }
+
     /// Scan for AudioUnit components
+    ///
+    /// Returns the cached results when the registration generation has not
+    /// changed since the previous scan.
     fn scan_components(&self) -> Result<Vec<PluginInfo>> {
-        unsafe {
-            // First pass: get count
-            let count = ffi::rack_au_scanner_scan(self.inner.as_ptr(), std::ptr::null_mut(), 0);
+        // Read the generation before scanning: a change that lands during the
+        // scan bumps it again, so the next call rescans
+        let generation = self.generation();
+        if let Some((cached_generation, plugins)) = self.cache.borrow().as_ref() {
+            if *cached_generation == generation {
+                return Ok(plugins.clone());
+            }
+        }
+
+        let plugins = unsafe {
+            let mut plugins_c: *const ffi::RackAUPluginInfo = std::ptr::null();
+            let count = ffi::rack_au_scanner_scan_results(self.inner.as_ptr(), &mut plugins_c);
 
             if count < 0 {
                 return Err(map_error(count));
             }
 
-            if count == 0 {
-                return Ok(Vec::new());
-            }
-
-            // Check for integer overflow when converting c_int to usize
-            let count_usize = usize::try_from(count)
-                .map_err(|_| Error::Other("Plugin count exceeds usize".to_string()))?;
-
-            // Allocate uninitialized array for results
-            // Safety: MaybeUninit allows uninitialized memory for C interop
-            let mut plugins_c: Vec<MaybeUninit<ffi::RackAUPluginInfo>> =
-                Vec::with_capacity(count_usize);
-            plugins_c.resize_with(count_usize, MaybeUninit::uninit);
-
-            // Second pass: fill array
-            let actual_count = ffi::rack_au_scanner_scan(
-                self.inner.as_ptr(),
-                plugins_c.as_mut_ptr() as *mut ffi::RackAUPluginInfo,
-                count_usize,
-            );
-
-            if actual_count < 0 {
-                return Err(map_error(actual_count));
+            if count == 0 || plugins_c.is_null() {
+                Vec::new()
+            } else {
+                let count_usize = usize::try_from(count)
+                    .map_err(|_| Error::Other("Plugin count exceeds usize".to_string()))?;
+
+                // Safety: the scanner owns `count` initialized entries, valid
+                // until the next scan; they are converted before this borrow ends
+                std::slice::from_raw_parts(plugins_c, count_usize)
+                    .iter()
+                    .map(convert_plugin_info)
+                    .collect::<Result<Vec<_>>>()?
             }
+        };
 
-            // Handle race condition: plugin list may have changed between passes
-            let actual_count_usize = usize::try_from(actual_count)
-                .map_err(|_| Error::Other("Actual plugin count exceeds usize".to_string()))?;
-
-            // Use the minimum of the two counts to avoid reading uninitialized memory
-            let valid_count = actual_count_usize.min(count_usize);
-
-            // Convert initialized C structs to Rust PluginInfo
-            // Safety: The C++ code guarantees that the first `actual_count` elements are initialized
-            let plugins = plugins_c
-                .into_iter()
-                .take(valid_count)
-                .map(|p| {
-                    // Safety: C++ has written valid data to these elements
-                    let plugin_info = p.assume_init();
-                    convert_plugin_info(&plugin_info)
-                })
-                .collect::<Result<Vec<_>>>()?;
-
-            Ok(plugins)
-        }
+        *self.cache.borrow_mut() = Some((generation, plugins.clone()));
+        Ok(plugins)
     }
 }
 
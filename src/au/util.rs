@@ -8,7 +8,7 @@ use super::ffi;
 /// Convert C API error code to Rust Error
 ///
 /// The C API returns negative error codes:
-/// - RACK_AU_ERROR_* codes (-1 to -4): rack-specific errors
+/// - RACK_AU_ERROR_* codes (-1 to -6): rack-specific errors
 /// - AudioUnit OSStatus codes (< -1000): Apple AudioUnit errors
 pub(crate) fn map_error(code: i32) -> Error {
     match code {
@@ -16,6 +16,7 @@ pub(crate) fn map_error(code: i32) -> Error {
         ffi::RACK_AU_ERROR_NOT_FOUND => Error::PluginNotFound("AudioUnit not found".to_string()),
         ffi::RACK_AU_ERROR_INVALID_PARAM => Error::Other("Invalid parameter".to_string()),
         ffi::RACK_AU_ERROR_NOT_INITIALIZED => Error::NotInitialized,
+        ffi::RACK_AU_ERROR_NOT_SUPPORTED => Error::Other("Not supported by this build of rack-sys".to_string()),
         // AudioUnit OSStatus errors (< -1000) or unknown negative codes
         _ => Error::from_os_status(code),
     }
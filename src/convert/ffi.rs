@@ -0,0 +1,91 @@
+//! Raw FFI bindings to the rack-sys sample conversion C API
+//!
+//! This module contains unsafe FFI declarations. The safe wrapper is in
+//! mod.rs.
+
+use std::os::raw::c_char;
+
+/// TPDF dither state (matches `RackDitherState`)
+#[repr(C)]
+#[derive(Clone, Copy, Debug)]
+pub struct RackDitherState {
+    pub lanes: [u32; 8],
+}
+
+extern "C" {
+    /// Seed a dither state
+    ///
+    /// # Safety
+    ///
+    /// - `state` must be a valid pointer
+    pub fn rack_dither_init(state: *mut RackDitherState, seed: u32);
+
+    /// Name of the selected instruction set (static string)
+    ///
+    /// # Safety
+    ///
+    /// Always safe to call; the first call selects the kernels.
+    pub fn rack_convert_isa() -> *const c_char;
+
+    /// Interleaved frames -> one buffer per channel
+    ///
+    /// # Safety
+    ///
+    /// - `interleaved` must hold `frames * channels` values
+    /// - `planar` must point to `channels` pointers, each to at least `frames` values
+    pub fn rack_convert_deinterleave(interleaved: *const f32, planar: *const *mut f32, channels: u32, frames: u32);
+
+    /// One buffer per channel -> interleaved frames
+    ///
+    /// # Safety
+    ///
+    /// - `planar` must point to `channels` pointers, each to at least `frames` values
+    /// - `interleaved` must have room for `frames * channels` values
+    pub fn rack_convert_interleave(planar: *const *const f32, interleaved: *mut f32, channels: u32, frames: u32);
+
+    /// # Safety
+    ///
+    /// - `src` and `dst` must each hold `count` samples
+    pub fn rack_convert_s16_to_f32(src: *const i16, dst: *mut f32, count: usize);
+
+    /// # Safety
+    ///
+    /// - `src` and `dst` must each hold `count` samples
+    /// - `dither` must be null or a valid pointer
+    pub fn rack_convert_f32_to_s16(src: *const f32, dst: *mut i16, count: usize, dither: *mut RackDitherState);
+
+    /// # Safety
+    ///
+    /// - `src` must hold `count * 3` bytes and `dst` `count` samples
+    pub fn rack_convert_s24_to_f32(src: *const u8, dst: *mut f32, count: usize);
+
+    /// # Safety
+    ///
+    /// - `src` must hold `count` samples and `dst` `count * 3` bytes
+    /// - `dither` must be null or a valid pointer
+    pub fn rack_convert_f32_to_s24(src: *const f32, dst: *mut u8, count: usize, dither: *mut RackDitherState);
+
+    /// # Safety
+    ///
+    /// - `src` and `dst` must each hold `count` samples
+    pub fn rack_convert_s32_to_f32(src: *const i32, dst: *mut f32, count: usize);
+
+    /// # Safety
+    ///
+    /// - `src` and `dst` must each hold `count` samples
+    pub fn rack_convert_f32_to_s32(src: *const f32, dst: *mut i32, count: usize);
+
+    /// `dst[i] += src[i] * gain`
+    ///
+    /// # Safety
+    ///
+    /// - `src` and `dst` must each hold `count` samples
+    pub fn rack_mix_add(src: *const f32, dst: *mut f32, count: usize, gain: f32);
+
+    /// `buffer[i] *= gain`
+    ///
+    /// # Safety
+    ///
+    /// - `buffer` must hold `count` samples
+    pub fn rack_apply_gain(buffer: *mut f32, count: usize, gain: f32);
+}
@@ -0,0 +1,156 @@
+//! Sample format conversion between audio devices and plugins
+//!
+//! Plugins process planar `f32` buffers (one slice per channel), while audio
+//! APIs such as cpal or JACK usually hand out interleaved frames, sometimes
+//! as integers. These functions convert between the two with vectorized
+//! kernels from rack-sys (SSE2/AVX2 picked at runtime on x86, NEON on ARM64).
+//!
+//! Integer full scale maps to `[-1.0, 1.0)`; float to integer rounds to
+//! nearest and clips. Every function works on the overlapping length of its
+//! arguments, never allocates, and is safe to call from the audio thread.
+//!
+//! # Example
+//!
+//! ```no_run
+//! use rack::convert::{self, Dither};
+//!
+//! // Device callback: plugin output (planar) -> interleaved i16
+//! let left = vec![0.0f32; 512];
+//! let right = vec![0.0f32; 512];
+//! let mut interleaved = vec![0.0f32; 1024];
+//! let mut device = vec![0i16; 1024];
+//! let mut dither = Dither::new(1);
+//!
+//! convert::interleave(&[&left, &right], &mut interleaved);
+//! convert::f32_to_i16(&interleaved, &mut device, Some(&mut dither));
+//! ```
+
+mod ffi;
+
+use smallvec::SmallVec;
+use std::ffi::CStr;
+
+/// TPDF (triangular, ±1 LSB) dither for float to integer conversion
+///
+/// Keep one per output stream so the noise stays uncorrelated.
+#[derive(Clone, Copy, Debug)]
+pub struct Dither {
+    state: ffi::RackDitherState,
+}
+
+impl Dither {
+    /// Create a dither generator from any seed
+    pub fn new(seed: u32) -> Self {
+        let mut state = ffi::RackDitherState { lanes: [0; 8] };
+        unsafe { ffi::rack_dither_init(&mut state, seed) };
+        Self { state }
+    }
+
+    fn as_mut_ptr(dither: Option<&mut Dither>) -> *mut ffi::RackDitherState {
+        dither.map_or(std::ptr::null_mut(), |d| &mut d.state as *mut _)
+    }
+}
+
+/// Instruction set the kernels run with: `"avx2"`, `"sse2"`, `"neon"` or `"scalar"`
+///
+/// The first call selects the kernels; call it once at startup rather than
+/// first in the audio callback.
+pub fn simd_level() -> &'static str {
+    unsafe {
+        CStr::from_ptr(ffi::rack_convert_isa())
+            .to_str()
+            .unwrap_or("scalar")
+    }
+}
+
+/// Split interleaved frames into one buffer per channel
+///
+/// The channel count is `planar.len()`. Returns the number of frames
+/// converted: the most that fit both `interleaved` and every channel.
+pub fn deinterleave(interleaved: &[f32], planar: &mut [&mut [f32]]) -> usize {
+    let channels = planar.len();
+    if channels == 0 {
+        return 0;
+    }
+    let frames = planar
+        .iter()
+        .map(|ch| ch.len())
+        .fold(interleaved.len() / channels, usize::min)
+        .min(u32::MAX as usize);
+
+    let ptrs: SmallVec<[*mut f32; 8]> = planar.iter_mut().map(|ch| ch.as_mut_ptr()).collect();
+    unsafe {
+        ffi::rack_convert_deinterleave(interleaved.as_ptr(), ptrs.as_ptr(), channels as u32, frames as u32);
+    }
+    frames
+}
+
+/// Merge one buffer per channel into interleaved frames
+///
+/// The channel count is `planar.len()`. Returns the number of frames
+/// converted: the most that fit both `interleaved` and every channel.
+pub fn interleave(planar: &[&[f32]], interleaved: &mut [f32]) -> usize {
+    let channels = planar.len();
+    if channels == 0 {
+        return 0;
+    }
+    let frames = planar
+        .iter()
+        .map(|ch| ch.len())
+        .fold(interleaved.len() / channels, usize::min)
+        .min(u32::MAX as usize);
+
+    let ptrs: SmallVec<[*const f32; 8]> = planar.iter().map(|ch| ch.as_ptr()).collect();
+    unsafe {
+        ffi::rack_convert_interleave(ptrs.as_ptr(), interleaved.as_mut_ptr(), channels as u32, frames as u32);
+    }
+    frames
+}
+
+/// Convert signed 16-bit samples to float
+pub fn i16_to_f32(src: &[i16], dst: &mut [f32]) {
+    let count = src.len().min(dst.len());
+    unsafe { ffi::rack_convert_s16_to_f32(src.as_ptr(), dst.as_mut_ptr(), count) };
+}
+
+/// Convert float samples to signed 16-bit, clipping, with optional dither
+pub fn f32_to_i16(src: &[f32], dst: &mut [i16], dither: Option<&mut Dither>) {
+    let count = src.len().min(dst.len());
+    unsafe { ffi::rack_convert_f32_to_s16(src.as_ptr(), dst.as_mut_ptr(), count, Dither::as_mut_ptr(dither)) };
+}
+
+/// Convert packed little-endian 24-bit samples (3 bytes each) to float
+pub fn i24_to_f32(src: &[u8], dst: &mut [f32]) {
+    let count = (src.len() / 3).min(dst.len());
+    unsafe { ffi::rack_convert_s24_to_f32(src.as_ptr(), dst.as_mut_ptr(), count) };
+}
+
+/// Convert float samples to packed little-endian 24-bit (3 bytes each),
+/// clipping, with optional dither
+pub fn f32_to_i24(src: &[f32], dst: &mut [u8], dither: Option<&mut Dither>) {
+    let count = src.len().min(dst.len() / 3);
+    unsafe { ffi::rack_convert_f32_to_s24(src.as_ptr(), dst.as_mut_ptr(), count, Dither::as_mut_ptr(dither)) };
+}
+
+/// Convert signed 32-bit samples to float
+pub fn i32_to_f32(src: &[i32], dst: &mut [f32]) {
+    let count = src.len().min(dst.len());
+    unsafe { ffi::rack_convert_s32_to_f32(src.as_ptr(), dst.as_mut_ptr(), count) };
+}
+
+/// Convert float samples to signed 32-bit, clipping
+pub fn f32_to_i32(src: &[f32], dst: &mut [i32]) {
+    let count = src.len().min(dst.len());
+    unsafe { ffi::rack_convert_f32_to_s32(src.as_ptr(), dst.as_mut_ptr(), count) };
+}
+
+/// Accumulate `src * gain` into `dst`
+pub fn mix_add(src: &[f32], dst: &mut [f32], gain: f32) {
+    let count = src.len().min(dst.len());
+    unsafe { ffi::rack_mix_add(src.as_ptr(), dst.as_mut_ptr(), count, gain) };
+}
+
+/// Multiply `buffer` by `gain` in place
+pub fn apply_gain(buffer: &mut [f32], gain: f32) {
+    unsafe { ffi::rack_apply_gain(buffer.as_mut_ptr(), buffer.len(), gain) };
+}
@@ -0,0 +1,124 @@
+//! Raw FFI bindings to the rack-sys graph C API
+//!
+//! This module contains unsafe FFI declarations. The safe wrapper is in
+//! mod.rs.
+
+#![allow(dead_code)]
+
+use std::ffi::c_void;
+use std::os::raw::c_int;
+
+// Opaque type (zero-sized to prevent construction)
+#[repr(C)]
+pub struct RackGraph {
+    _private: [u8; 0],
+}
+
+// Error codes
+pub const RACK_GRAPH_OK: c_int = 0;
+pub const RACK_GRAPH_ERROR_GENERIC: c_int = -1;
+pub const RACK_GRAPH_ERROR_INVALID_PARAM: c_int = -2;
+pub const RACK_GRAPH_ERROR_NOT_PREPARED: c_int = -3;
+pub const RACK_GRAPH_ERROR_CYCLE: c_int = -4;
+pub const RACK_GRAPH_ERROR_NODE_FAILED: c_int = -5;
+
+/// Node ID for the graph's own inputs (as a source) and outputs (as a destination)
+pub const RACK_GRAPH_IO: u32 = 0xFFFF_FFFF;
+
+// Worker thread flags
+pub const RACK_GRAPH_FLAG_PIN_THREADS: u32 = 0x1;
+pub const RACK_GRAPH_FLAG_REALTIME_PRIORITY: u32 = 0x2;
+
+/// Per-node process function (same shape as the per-format process calls)
+pub type RackGraphProcessFn = unsafe extern "C" fn(
+    instance: *mut c_void,
+    inputs: *const *const f32,
+    num_input_channels: u32,
+    outputs: *const *mut f32,
+    num_output_channels: u32,
+    frames: u32,
+) -> c_int;
+
+extern "C" {
+    /// Create a graph with `num_workers` threads besides the caller of process
+    ///
+    /// # Returns
+    ///
+    /// - Pointer to the graph, or NULL on failure
+    pub fn rack_graph_new(num_workers: u32, max_block_size: u32, flags: u32) -> *mut RackGraph;
+
+    /// Stop the workers and free the graph
+    ///
+    /// # Safety
+    ///
+    /// - `graph` must be a valid pointer returned by `rack_graph_new`
+    /// - Must not be called while `rack_graph_process` is running
+    pub fn rack_graph_free(graph: *mut RackGraph);
+
+    /// Add a node
+    ///
+    /// # Returns
+    ///
+    /// - Node ID (>= 0) on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `instance` must stay valid for `process` until the graph is freed
+    /// - `process` must be safe to call on a worker thread
+    pub fn rack_graph_add_node(
+        graph: *mut RackGraph,
+        instance: *mut c_void,
+        process: RackGraphProcessFn,
+        num_input_channels: u32,
+        num_output_channels: u32,
+    ) -> c_int;
+
+    /// Connect an output channel to an input channel (RACK_GRAPH_IO for graph I/O)
+    ///
+    /// # Safety
+    ///
+    /// - `graph` must be a valid pointer
+    pub fn rack_graph_connect(
+        graph: *mut RackGraph,
+        src_node: u32,
+        src_channel: u32,
+        dst_node: u32,
+        dst_channel: u32,
+    ) -> c_int;
+
+    /// Compute the schedule and allocate intermediate buffers
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - RACK_GRAPH_ERROR_CYCLE if the connections form a loop
+    ///
+    /// # Safety
+    ///
+    /// - `graph` must be a valid pointer
+    pub fn rack_graph_prepare(graph: *mut RackGraph) -> c_int;
+
+    /// Process one block through the graph
+    ///
+    /// # Safety
+    ///
+    /// - `graph` must be a valid, prepared graph
+    /// - `inputs`/`outputs` must hold the given number of channel pointers,
+    ///   each valid for `frames` samples
+    pub fn rack_graph_process(
+        graph: *mut RackGraph,
+        inputs: *const *const f32,
+        num_input_channels: u32,
+        outputs: *const *mut f32,
+        num_output_channels: u32,
+        frames: u32,
+    ) -> c_int;
+
+    /// Number of worker threads (excluding the caller of process)
+    ///
+    /// # Safety
+    ///
+    /// - `graph` must be a valid pointer
+    pub fn rack_graph_get_num_workers(graph: *mut RackGraph) -> u32;
+}
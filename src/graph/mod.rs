@@ -0,0 +1,333 @@
+//! Multi-threaded processing graph for plugin instances of any format
+//!
+//! A [`Graph`] owns a set of initialized plugins (nodes) and the audio
+//! connections between them. [`Graph::process`] runs every node once per
+//! block; nodes that don't depend on each other run in parallel on a fixed
+//! pool of worker threads, which steal work from each other so long chains
+//! and wide fan-outs both keep all cores busy.
+//!
+//! # Example
+//!
+//! ```no_run
+//! use rack::prelude::*;
+//! use rack::graph::{Graph, NodeId};
+//!
+//! # fn main() -> Result<()> {
+//! let scanner = Scanner::new()?;
+//! let plugins = scanner.scan()?;
+//!
+//! let mut graph = Graph::new(3, 512)?;
+//! let mut previous = NodeId::IO;
+//! for info in plugins.iter().take(4) {
+//!     let mut plugin = scanner.load(info)?;
+//!     plugin.initialize(48000.0, 512)?;
+//!     let node = graph.add_node(plugin)?;
+//!     graph.connect(previous, 0, node, 0)?;
+//!     previous = node;
+//! }
+//! graph.connect(previous, 0, NodeId::IO, 0)?;
+//! graph.prepare()?;
+//!
+//! let input = vec![0.0f32; 512];
+//! let mut output = vec![0.0f32; 512];
+//! graph.process(&[&input], &mut [&mut output], 512)?;
+//! # Ok(())
+//! # }
+//! ```
+
+mod ffi;
+
+use crate::{Error, PluginInstance, Result};
+use std::ffi::c_void;
+use std::marker::PhantomData;
+use std::ptr::NonNull;
+
+pub(crate) use ffi::RackGraphProcessFn;
+
+/// Convert graph C API error code to Rust Error
+fn map_error(code: i32) -> Error {
+    match code {
+        ffi::RACK_GRAPH_ERROR_GENERIC => Error::Other("Generic graph error".to_string()),
+        ffi::RACK_GRAPH_ERROR_INVALID_PARAM => Error::Other("Invalid graph node or channel".to_string()),
+        ffi::RACK_GRAPH_ERROR_NOT_PREPARED => Error::Other("Graph changed since prepare()".to_string()),
+        ffi::RACK_GRAPH_ERROR_CYCLE => Error::Other("Graph connections form a cycle".to_string()),
+        ffi::RACK_GRAPH_ERROR_NODE_FAILED => Error::Other("A graph node failed to process".to_string()),
+        _ => Error::Other(format!("Unknown graph error code: {}", code)),
+    }
+}
+
+/// A plugin's native realtime process entry point
+///
+/// Obtained from [`GraphNode::raw_processor`]; only the format backends in
+/// this crate can construct one.
+#[derive(Clone, Copy, Debug)]
+pub struct RawProcessor {
+    instance: *mut c_void,
+    process: RackGraphProcessFn,
+    num_inputs: u32,
+    num_outputs: u32,
+}
+
+impl RawProcessor {
+    /// # Safety
+    ///
+    /// `process(instance, ...)` must be callable from any thread (one at a
+    /// time) with `num_inputs`/`num_outputs` channels while the owning
+    /// plugin is alive and initialized.
+    #[allow(dead_code)] // Unused when no plugin format is compiled in
+    pub(crate) unsafe fn new(
+        instance: *mut c_void,
+        process: RackGraphProcessFn,
+        num_inputs: usize,
+        num_outputs: usize,
+    ) -> Self {
+        Self {
+            instance,
+            process,
+            num_inputs: num_inputs as u32,
+            num_outputs: num_outputs as u32,
+        }
+    }
+}
+
+/// A plugin instance that can run inside a [`Graph`]
+///
+/// Implemented by every plugin format's instance type, so one graph can mix
+/// formats.
+///
+/// # Safety
+///
+/// The processor returned by [`raw_processor`](GraphNode::raw_processor)
+/// must stay valid as long as the implementor is alive and is not
+/// re-initialized.
+pub unsafe trait GraphNode: PluginInstance + Send {
+    /// Native process entry point for the current channel configuration
+    ///
+    /// Fails with [`Error::NotInitialized`] before `initialize()`.
+    fn raw_processor(&mut self) -> Result<RawProcessor>;
+}
+
+/// Identifies a node in a [`Graph`]
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct NodeId(u32);
+
+impl NodeId {
+    /// The graph itself: its inputs as a connection source, its outputs as
+    /// a connection destination
+    pub const IO: NodeId = NodeId(ffi::RACK_GRAPH_IO);
+
+    /// Position of the node in insertion order
+    pub fn index(self) -> usize {
+        self.0 as usize
+    }
+}
+
+/// A graph of plugin instances processed in parallel
+///
+/// # Thread Safety
+///
+/// `Send` but not `Sync`; one thread calls [`process`](Graph::process) at a
+/// time (typically the audio callback), and the graph's own worker threads
+/// run the nodes.
+pub struct Graph {
+    inner: NonNull<ffi::RackGraph>,
+    nodes: Vec<Box<dyn GraphNode>>,
+    max_block_size: usize,
+    // Pre-allocated pointer arrays for zero-allocation process() calls
+    input_ptrs: Vec<*const f32>,
+    output_ptrs: Vec<*mut f32>,
+    // PhantomData<*const ()> makes this type !Sync while keeping it Send
+    _not_sync: PhantomData<*const ()>,
+}
+
+// Safety: the graph owns its nodes (all Send) and its C++ state exclusively
+unsafe impl Send for Graph {}
+
+impl Graph {
+    /// Create a graph with `num_workers` pinned, realtime-priority worker
+    /// threads in addition to the thread calling `process()`
+    ///
+    /// Pinning and realtime scheduling are best effort: where the platform
+    /// or the process's privileges don't allow them, the workers run as
+    /// normal threads. `num_workers = 0` processes everything on the
+    /// calling thread.
+    pub fn new(num_workers: usize, max_block_size: usize) -> Result<Self> {
+        Self::with_thread_options(num_workers, max_block_size, true, true)
+    }
+
+    /// Create a graph, choosing whether workers are pinned to cores and
+    /// whether they request realtime scheduling
+    pub fn with_thread_options(
+        num_workers: usize,
+        max_block_size: usize,
+        pin_threads: bool,
+        realtime_priority: bool,
+    ) -> Result<Self> {
+        if max_block_size == 0 || max_block_size > u32::MAX as usize {
+            return Err(Error::Other("Invalid max block size".to_string()));
+        }
+
+        let mut flags = 0;
+        if pin_threads {
+            flags |= ffi::RACK_GRAPH_FLAG_PIN_THREADS;
+        }
+        if realtime_priority {
+            flags |= ffi::RACK_GRAPH_FLAG_REALTIME_PRIORITY;
+        }
+
+        unsafe {
+            let ptr = ffi::rack_graph_new(num_workers as u32, max_block_size as u32, flags);
+            if ptr.is_null() {
+                return Err(Error::Other("Failed to create processing graph".to_string()));
+            }
+
+            Ok(Self {
+                inner: NonNull::new_unchecked(ptr),
+                nodes: Vec::new(),
+                max_block_size,
+                input_ptrs: Vec::with_capacity(8),
+                output_ptrs: Vec::with_capacity(8),
+                _not_sync: PhantomData,
+            })
+        }
+    }
+
+    /// Add an initialized plugin as a node; the graph takes ownership
+    ///
+    /// Call [`prepare`](Graph::prepare) before the next `process()`.
+    pub fn add_node<P: GraphNode + 'static>(&mut self, plugin: P) -> Result<NodeId> {
+        self.add_boxed_node(Box::new(plugin))
+    }
+
+    /// Add an already boxed plugin as a node (e.g. of a format chosen at runtime)
+    pub fn add_boxed_node(&mut self, mut plugin: Box<dyn GraphNode>) -> Result<NodeId> {
+        let processor = plugin.raw_processor()?;
+
+        let id = unsafe {
+            ffi::rack_graph_add_node(
+                self.inner.as_ptr(),
+                processor.instance,
+                processor.process,
+                processor.num_inputs,
+                processor.num_outputs,
+            )
+        };
+        if id < 0 {
+            return Err(map_error(id));
+        }
+
+        // The C++ instance lives on the heap, so moving the box is fine
+        self.nodes.push(plugin);
+        Ok(NodeId(id as u32))
+    }
+
+    /// Connect output `src_channel` of `src` to input `dst_channel` of `dst`
+    ///
+    /// Several connections into one input are summed. Use [`NodeId::IO`] as
+    /// `src` for a graph input or as `dst` for a graph output.
+    pub fn connect(&mut self, src: NodeId, src_channel: usize, dst: NodeId, dst_channel: usize) -> Result<()> {
+        let result = unsafe {
+            ffi::rack_graph_connect(
+                self.inner.as_ptr(),
+                src.0,
+                src_channel as u32,
+                dst.0,
+                dst_channel as u32,
+            )
+        };
+        if result != ffi::RACK_GRAPH_OK {
+            return Err(map_error(result));
+        }
+        Ok(())
+    }
+
+    /// Compute the schedule and allocate the intermediate buffers
+    ///
+    /// Required after adding nodes or connections. Fails if the connections
+    /// contain a feedback loop.
+    pub fn prepare(&mut self) -> Result<()> {
+        let result = unsafe { ffi::rack_graph_prepare(self.inner.as_ptr()) };
+        if result != ffi::RACK_GRAPH_OK {
+            return Err(map_error(result));
+        }
+        Ok(())
+    }
+
+    /// Process one block through the whole graph
+    ///
+    /// Unconnected graph outputs are zeroed; graph inputs that aren't passed
+    /// read as silence. Realtime-safe once prepared. If a node fails, its
+    /// outputs are silenced, the rest of the graph still runs, and an error
+    /// is returned.
+    pub fn process(
+        &mut self,
+        inputs: &[&[f32]],
+        outputs: &mut [&mut [f32]],
+        num_frames: usize,
+    ) -> Result<()> {
+        if num_frames > self.max_block_size {
+            return Err(Error::Other(format!(
+                "Frame count {} exceeds max block size {}",
+                num_frames, self.max_block_size
+            )));
+        }
+        if inputs.iter().any(|ch| ch.len() < num_frames) ||
+           outputs.iter().any(|ch| ch.len() < num_frames) {
+            return Err(Error::Other(format!(
+                "Channel buffer shorter than {} frames",
+                num_frames
+            )));
+        }
+
+        self.input_ptrs.clear();
+        self.input_ptrs.extend(inputs.iter().map(|ch| ch.as_ptr()));
+        self.output_ptrs.clear();
+        self.output_ptrs.extend(outputs.iter_mut().map(|ch| ch.as_mut_ptr()));
+
+        let result = unsafe {
+            ffi::rack_graph_process(
+                self.inner.as_ptr(),
+                self.input_ptrs.as_ptr(),
+                self.input_ptrs.len() as u32,
+                self.output_ptrs.as_ptr(),
+                self.output_ptrs.len() as u32,
+                num_frames as u32,
+            )
+        };
+        if result != ffi::RACK_GRAPH_OK {
+            return Err(map_error(result));
+        }
+        Ok(())
+    }
+
+    /// Access a node's plugin between blocks (parameters, MIDI, state)
+    ///
+    /// Don't re-initialize it: the graph relies on its channel configuration.
+    pub fn node_mut(&mut self, id: NodeId) -> Option<&mut (dyn GraphNode + 'static)> {
+        self.nodes.get_mut(id.index()).map(|node| node.as_mut())
+    }
+
+    /// Shared access to a node's plugin
+    pub fn node(&self, id: NodeId) -> Option<&(dyn GraphNode + 'static)> {
+        self.nodes.get(id.index()).map(|node| node.as_ref())
+    }
+
+    /// Number of nodes
+    pub fn node_count(&self) -> usize {
+        self.nodes.len()
+    }
+
+    /// Number of worker threads (excluding the thread calling `process()`)
+    pub fn num_workers(&self) -> usize {
+        unsafe { ffi::rack_graph_get_num_workers(self.inner.as_ptr()) as usize }
+    }
+}
+
+impl Drop for Graph {
+    fn drop(&mut self) {
+        // Stop the workers before the nodes are dropped
+        unsafe {
+            ffi::rack_graph_free(self.inner.as_ptr());
+        }
+    }
+}
@@ -52,14 +52,17 @@
 //! AudioUnit provides the best integration on Apple platforms (native GUI support).
 //! VST3 is the default on Windows and Linux, and also available on macOS.
 
+pub mod convert;
 pub mod error;
+pub mod graph;
 pub mod midi;
 pub mod plugin_info;
+pub mod rt;
 pub mod traits;
 
 pub use error::{Error, Result};
 pub use midi::{MidiEvent, MidiEventKind};
-pub use plugin_info::{ParameterInfo, PluginInfo, PluginType, PresetInfo};
+pub use plugin_info::{LatencyInfo, ParameterInfo, PluginInfo, PluginType, PresetInfo, ProcessStats};
 pub use traits::{PluginInstance, PluginScanner};
 
 // Platform-specific implementations
@@ -106,8 +109,8 @@ pub use vst3::Vst3Gui;
 /// Prelude module for convenient imports
 pub mod prelude {
     pub use crate::{
-        Error, MidiEvent, MidiEventKind, ParameterInfo, PluginInfo, PluginInstance,
-        PluginScanner, PluginType, PresetInfo, Result,
+        Error, LatencyInfo, MidiEvent, MidiEventKind, ParameterInfo, PluginInfo,
+        PluginInstance, PluginScanner, PluginType, PresetInfo, ProcessStats, Result,
     };
 
     // Platform-specific exports
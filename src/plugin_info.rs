@@ -121,6 +121,125 @@ impl ParameterInfo {
     }
 }
 
+/// Processing latency and tail reported by a plugin, for delay compensation
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub struct LatencyInfo {
+    /// Samples by which the output lags the input
+    pub latency_samples: u32,
+
+    /// Samples of output after the input goes silent, or `None` if the
+    /// plugin never stops ringing
+    pub tail_samples: Option<u32>,
+}
+
+impl LatencyInfo {
+    /// Tail value plugins use for an infinite tail (VST3 `kInfiniteTail`)
+    pub const INFINITE_TAIL: u32 = u32::MAX;
+
+    /// Create from raw values, mapping [`INFINITE_TAIL`](Self::INFINITE_TAIL) to `None`
+    pub fn new(latency_samples: u32, tail_samples: u32) -> Self {
+        Self {
+            latency_samples,
+            tail_samples: if tail_samples == Self::INFINITE_TAIL {
+                None
+            } else {
+                Some(tail_samples)
+            },
+        }
+    }
+}
+
+/// Processing statistics of one plugin instance
+///
+/// Counters accumulate from creation or the last
+/// [`reset_stats()`](crate::PluginInstance::reset_stats). Times cover whole
+/// `process()` calls; a call's block deadline is its frame count divided by
+/// the sample rate, so a load above 1.0 means that call alone could have
+/// caused an xrun.
+#[derive(Debug, Clone, Copy, PartialEq, Default)]
+pub struct ProcessStats {
+    /// Timed `process()` calls
+    pub process_calls: u64,
+
+    /// Frames rendered by those calls
+    pub frames: u64,
+
+    /// Time spent in them, in nanoseconds
+    pub total_ns: u64,
+
+    /// Slowest call, in nanoseconds
+    pub max_ns: u64,
+
+    /// Sum of the calls' block deadlines, in nanoseconds
+    pub deadline_ns: u64,
+
+    /// Calls slower than their block deadline
+    pub deadline_misses: u64,
+
+    /// Largest call time as a fraction of its block deadline
+    pub max_load: f64,
+
+    /// Total time as a fraction of the total deadline
+    pub average_load: f64,
+
+    /// Blocks where the plugin's own process/render call failed
+    pub process_errors: u64,
+
+    /// MIDI events that could not be queued
+    pub dropped_midi_events: u64,
+
+    /// Parameter changes from the plugin GUI that were dropped
+    pub dropped_param_changes: u64,
+
+    /// Call-time histogram: bucket `i` counts calls taking
+    /// `[2^i, 2^(i+1))` ns (the last bucket also counts anything longer)
+    pub histogram: [u64; ProcessStats::HISTOGRAM_BUCKETS],
+}
+
+impl ProcessStats {
+    /// Number of histogram buckets
+    pub const HISTOGRAM_BUCKETS: usize = 32;
+
+    /// Mean call time in nanoseconds (0 without calls)
+    pub fn mean_ns(&self) -> f64 {
+        if self.process_calls == 0 {
+            0.0
+        } else {
+            self.total_ns as f64 / self.process_calls as f64
+        }
+    }
+
+    /// Smallest call time in nanoseconds counted by histogram bucket `index`
+    pub fn bucket_floor_ns(index: usize) -> u64 {
+        if index == 0 {
+            0
+        } else {
+            1u64 << index.min(63)
+        }
+    }
+
+    /// Upper bound of the call time below which `quantile` (0.0..=1.0) of
+    /// the calls fall, from the histogram (exact to a factor of two)
+    pub fn quantile_ns(&self, quantile: f64) -> u64 {
+        let total: u64 = self.histogram.iter().sum();
+        if total == 0 {
+            return 0;
+        }
+        let rank = ((quantile.clamp(0.0, 1.0) * total as f64).ceil() as u64).max(1);
+        let mut seen = 0u64;
+        for (index, &count) in self.histogram.iter().enumerate() {
+            seen += count;
+            if seen >= rank {
+                if index + 1 == Self::HISTOGRAM_BUCKETS {
+                    return self.max_ns;
+                }
+                return Self::bucket_floor_ns(index + 1).min(self.max_ns.max(1));
+            }
+        }
+        self.max_ns
+    }
+}
+
 /// Information about a plugin preset
 #[derive(Debug, Clone)]
 pub struct PresetInfo {
@@ -0,0 +1,75 @@
+//! Raw FFI bindings to the rack-sys realtime context C API
+//!
+//! This module contains unsafe FFI declarations. The safe wrapper is in
+//! mod.rs.
+
+#![allow(dead_code)]
+
+use std::ffi::c_void;
+use std::os::raw::c_int;
+
+// Opaque type (zero-sized to prevent construction)
+#[repr(C)]
+pub struct RackRtContext {
+    _private: [u8; 0],
+}
+
+// Error codes
+pub const RACK_RT_OK: c_int = 0;
+pub const RACK_RT_ERROR_GENERIC: c_int = -1;
+pub const RACK_RT_ERROR_INVALID_PARAM: c_int = -2;
+pub const RACK_RT_ERROR_NOT_SUPPORTED: c_int = -3;
+
+// Context flags
+pub const RACK_RT_FLUSH_DENORMALS: u32 = 0x1;
+pub const RACK_RT_REALTIME_PRIORITY: u32 = 0x2;
+pub const RACK_RT_LOCK_MEMORY: u32 = 0x4;
+
+/// Context configuration (matches `RackRtConfig`)
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct RackRtConfig {
+    pub flags: u32,
+    pub priority: i32,
+    pub sample_rate: f64,
+    pub block_size: u32,
+}
+
+extern "C" {
+    /// Enter a realtime context on the calling thread
+    ///
+    /// # Safety
+    ///
+    /// - `config` must be a valid pointer or NULL
+    /// - The returned context must be left on the same thread
+    pub fn rack_rt_context_enter(config: *const RackRtConfig) -> *mut RackRtContext;
+
+    /// Restore the thread's settings, unlock memory and free the context
+    ///
+    /// # Safety
+    ///
+    /// - `ctx` must come from `rack_rt_context_enter` on the calling thread
+    pub fn rack_rt_context_leave(ctx: *mut RackRtContext);
+
+    /// Flags that took effect
+    ///
+    /// # Safety
+    ///
+    /// - `ctx` must be a valid pointer
+    pub fn rack_rt_context_applied(ctx: *const RackRtContext) -> u32;
+
+    /// Lock a memory range into RAM until the context is left
+    ///
+    /// # Safety
+    ///
+    /// - `ctx` must be a valid pointer
+    /// - `addr` must point to `size` bytes of mapped memory
+    pub fn rack_rt_context_lock_memory(ctx: *mut RackRtContext, addr: *const c_void, size: usize) -> c_int;
+
+    /// Realtime violations counted in process paths (RACK_RT_CHECKS builds)
+    ///
+    /// # Safety
+    ///
+    /// - `allocations` and `locks` must be valid pointers or NULL
+    pub fn rack_rt_get_violations(allocations: *mut u64, locks: *mut u64) -> c_int;
+}
@@ -1,4 +1,4 @@
-use crate::{MidiEvent, ParameterInfo, PluginInfo, PresetInfo, Result};
+use crate::{LatencyInfo, MidiEvent, ParameterInfo, PluginInfo, PresetInfo, ProcessStats, Result};
 
 /// Trait for scanning and discovering audio plugins
 pub trait PluginScanner {
@@ -73,7 +73,9 @@ pub trait PluginInstance: Send {
     ///
     /// * `inputs` - Array of input channel buffers (e.g., `&[left, right]` for stereo)
     /// * `outputs` - Array of output channel buffers (e.g., `&mut [left, right]` for stereo)
-    /// * `num_frames` - Number of audio frames to process (must be ≤ max_block_size)
+    /// * `num_frames` - Number of audio frames to process. May exceed max_block_size:
+    ///   longer buffers are processed in max_block_size sub-blocks, with queued MIDI and
+    ///   automation delivered to the sub-block containing their sample offset
     ///
     /// # Channel Formats
     ///
@@ -160,6 +162,14 @@ pub trait PluginInstance: Send {
     /// **AudioUnit:**
     /// - Full MIDI 1.0 support including system real-time messages.
     ///
+    /// # Threading
+    ///
+    /// Events go through a lock-free single-producer queue that the next
+    /// `process()` call drains. `&mut self` already guarantees one caller at
+    /// a time. Code that reaches the same instance through the C API or raw
+    /// pointers must still make sure only one thread sends MIDI at a time.
+    /// Concurrent senders corrupt the queue.
+    ///
     /// # Arguments
     ///
     /// * `events` - Slice of MIDI events to send
@@ -170,6 +180,7 @@ pub trait PluginInstance: Send {
     /// - The plugin doesn't support MIDI (e.g., most effect plugins)
     /// - Any event has invalid data (channel > 15, etc.)
     /// - The plugin is not initialized
+    /// - The queue has no room for all of `events` (none are sent)
     fn send_midi(&mut self, events: &[MidiEvent]) -> Result<()>;
 
     /// Get the number of factory presets
@@ -231,6 +242,41 @@ pub trait PluginInstance: Send {
     /// - The plugin doesn't support state serialization
     fn set_state(&mut self, data: &[u8]) -> Result<()>;
 
+    /// Query the plugin's current processing latency and tail
+    ///
+    /// Use the latency for plugin delay compensation. Plugins may change it
+    /// at runtime (for example when a lookahead parameter moves); re-query
+    /// whenever [`latency_generation()`](Self::latency_generation) changes.
+    /// Call from a control thread, not the audio thread.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the plugin is not initialized
+    fn latency_info(&mut self) -> Result<LatencyInfo>;
+
+    /// Counter that advances whenever the latency or tail may have changed
+    ///
+    /// Cheap and realtime-safe: poll it from the audio thread and compare
+    /// with the last value seen.
+    fn latency_generation(&self) -> u32;
+
+    /// Snapshot the instance's processing statistics
+    ///
+    /// Counting is cheap (tens of nanoseconds per `process()` call), so it
+    /// is always on; poll from a monitoring thread to find the instances
+    /// that blow their deadline.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if rack-sys was built without performance counters
+    /// (`RACK_PERF_COUNTERS=OFF`) or the plugin host cannot be reached
+    fn stats(&mut self) -> Result<ProcessStats>;
+
+    /// Zero the processing statistics
+    ///
+    /// Timing counters clear at the next `process()` call.
+    fn reset_stats(&mut self) -> Result<()>;
+
     /// Get plugin info
     fn info(&self) -> &PluginInfo;
 
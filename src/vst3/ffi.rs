@@ -5,6 +5,7 @@
 
 #![allow(dead_code)]
 
+use std::ffi::c_void;
 use std::os::raw::{c_char, c_int};
 
 // Opaque types (zero-sized to prevent construction)
@@ -23,6 +24,11 @@ pub struct RackVST3Gui {
     _private: [u8; 0],
 }
 
+#[repr(C)]
+pub struct RackVST3Pool {
+    _private: [u8; 0],
+}
+
 // Plugin type enum
 #[repr(C)]
 #[derive(Debug, Clone, Copy, PartialEq, Eq)]
@@ -34,6 +40,15 @@ pub enum RackVST3PluginType {
     Other = 4,
 }
 
+// Processing mode (values match Steinberg::Vst::ProcessModes)
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum RackVST3ProcessMode {
+    Realtime = 0,
+    Prefetch = 1,
+    Offline = 2,
+}
+
 // Plugin info struct (matches C layout exactly)
 #[repr(C)]
 #[derive(Clone)]
@@ -63,6 +78,16 @@ pub const RACK_VST3_ERROR_INVALID_PARAM: c_int = -3;
 pub const RACK_VST3_ERROR_NOT_INITIALIZED: c_int = -4;
 pub const RACK_VST3_ERROR_LOAD_FAILED: c_int = -5;
 pub const RACK_VST3_ERROR_NOT_SUPPORTED: c_int = -6;
+pub const RACK_VST3_ERROR_BUSY: c_int = -7;
+
+/// Process-time histogram size of `RackVST3PluginStats`
+pub const RACK_VST3_STATS_HISTOGRAM_BUCKETS: usize = 32;
+
+/// Returned by `rack_vst3_plugin_state_load_status` while a load is running
+pub const RACK_VST3_STATE_LOAD_PENDING: c_int = 1;
+
+/// Completion callback for asynchronous state loads (called on the loader thread)
+pub type RackVST3StateLoadCallback = Option<unsafe extern "C" fn(user_data: *mut c_void, result: c_int)>;
 
 extern "C" {
     // ============================================================================
@@ -118,6 +143,51 @@ extern "C" {
     /// - `scanner` must be a valid pointer returned by `rack_vst3_scanner_new`
     pub fn rack_vst3_scanner_add_default_paths(scanner: *mut RackVST3Scanner) -> c_int;
 
+    /// Set the on-disk scan cache file (NULL disables it)
+    ///
+    /// Unchanged bundles are reported from the cache without loading the module.
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `scanner` must be a valid pointer returned by `rack_vst3_scanner_new`
+    /// - `path` must be NULL or a valid null-terminated C string
+    pub fn rack_vst3_scanner_set_cache_path(scanner: *mut RackVST3Scanner, path: *const c_char) -> c_int;
+
+    /// Enable or disable out-of-process probing of uncached bundles (Linux only)
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `scanner` must be a valid pointer returned by `rack_vst3_scanner_new`
+    pub fn rack_vst3_scanner_set_out_of_process(scanner: *mut RackVST3Scanner, enabled: c_int) -> c_int;
+
+    /// Scan for plugins in a single pass
+    ///
+    /// # Returns
+    ///
+    /// - On success: number of plugins found; `*plugins` points to that many entries
+    /// - On error: negative error code (see RACK_VST3_ERROR_* constants)
+    ///
+    /// # Safety
+    ///
+    /// - `scanner` must be a valid pointer returned by `rack_vst3_scanner_new`
+    /// - `plugins` must be valid for writes
+    /// - The returned array is owned by the scanner and is valid until the next
+    ///   scan or `rack_vst3_scanner_free`
+    pub fn rack_vst3_scanner_scan_results(
+        scanner: *mut RackVST3Scanner,
+        plugins: *mut *const RackVST3PluginInfo,
+    ) -> c_int;
+
     /// Scan for plugins
     ///
     /// Two-pass usage pattern:
@@ -148,6 +218,41 @@ extern "C" {
         max_plugins: usize,
     ) -> c_int;
 
+    // ============================================================================
+    // Module Cache API
+    // ============================================================================
+
+    /// Load a module into the process-wide cache and keep it loaded
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success (also if already loaded)
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `path` must be a valid null-terminated C string
+    pub fn rack_vst3_module_preload(path: *const c_char) -> c_int;
+
+    /// Undo `rack_vst3_module_preload`
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - `RACK_VST3_ERROR_NOT_FOUND` if `path` is not preloaded
+    ///
+    /// # Safety
+    ///
+    /// - `path` must be a valid null-terminated C string
+    pub fn rack_vst3_module_release(path: *const c_char) -> c_int;
+
+    /// Check whether a module is loaded (1) or not (0)
+    ///
+    /// # Safety
+    ///
+    /// - `path` must be a valid null-terminated C string
+    pub fn rack_vst3_module_is_loaded(path: *const c_char) -> c_int;
+
     // ============================================================================
     // Plugin Instance API
     // ============================================================================
@@ -173,6 +278,73 @@ extern "C" {
     /// - If `plugin` is NULL, this function does nothing (safe no-op)
     pub fn rack_vst3_plugin_free(plugin: *mut RackVST3Plugin);
 
+    /// Create (and, if `max_block_size` > 0, initialize) plugin instances
+    /// on a worker pool
+    ///
+    /// # Returns
+    ///
+    /// - Number of instances created (failed entries are NULL)
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `paths` and `uids` must each point to `count` valid null-terminated
+    ///   C strings
+    /// - `plugins` must point to `count` writable entries; each non-NULL
+    ///   entry must be freed with `rack_vst3_plugin_free`
+    pub fn rack_vst3_plugins_new_parallel(
+        paths: *const *const c_char,
+        uids: *const *const c_char,
+        count: usize,
+        sample_rate: f64,
+        max_block_size: u32,
+        num_threads: u32,
+        plugins: *mut *mut RackVST3Plugin,
+    ) -> c_int;
+
+    /// Create a new instance of the same plugin with the source's state
+    /// (initialized like the source)
+    ///
+    /// # Safety
+    ///
+    /// - `source` must be a valid pointer
+    /// - Returns NULL on error; the returned pointer must be freed with
+    ///   `rack_vst3_plugin_free`
+    pub fn rack_vst3_plugin_clone(source: *mut RackVST3Plugin) -> *mut RackVST3Plugin;
+
+    /// Create a pool of up to `size` ready clones of `prototype`, refilled
+    /// on a background thread
+    ///
+    /// # Safety
+    ///
+    /// - `prototype` must be a valid pointer
+    /// - Returns NULL on error; the returned pointer must be freed with
+    ///   `rack_vst3_pool_free`
+    pub fn rack_vst3_pool_new(prototype: *mut RackVST3Plugin, size: u32) -> *mut RackVST3Pool;
+
+    /// Free a pool and its spare instances
+    ///
+    /// # Safety
+    ///
+    /// - `pool` must be a valid pointer returned by `rack_vst3_pool_new`
+    /// - `pool` must not be used after this call
+    pub fn rack_vst3_pool_free(pool: *mut RackVST3Pool);
+
+    /// Take a ready instance out of the pool (NULL if empty)
+    ///
+    /// # Safety
+    ///
+    /// - `pool` must be a valid pointer
+    /// - The returned pointer must be freed with `rack_vst3_plugin_free`
+    pub fn rack_vst3_pool_acquire(pool: *mut RackVST3Pool) -> *mut RackVST3Plugin;
+
+    /// Number of ready instances, or negative error code
+    ///
+    /// # Safety
+    ///
+    /// - `pool` must be a valid pointer
+    pub fn rack_vst3_pool_available(pool: *mut RackVST3Pool) -> c_int;
+
     /// Initialize plugin with sample rate and buffer size
     ///
     /// # Returns
@@ -287,6 +459,185 @@ extern "C" {
         frames: u32,
     ) -> c_int;
 
+    /// Process buffers of any length, splitting them into `max_block_size`
+    /// sub-blocks and routing queued MIDI and automation to the sub-block it falls in
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - The first failing sub-block's negative error code
+    ///
+    /// # Safety
+    ///
+    /// - Same requirements as `rack_vst3_plugin_process`, except that `frames`
+    ///   may exceed `max_block_size`
+    pub fn rack_vst3_plugin_process_split(
+        plugin: *mut RackVST3Plugin,
+        inputs: *const *const f32,
+        num_input_channels: u32,
+        outputs: *const *mut f32,
+        num_output_channels: u32,
+        frames: u32,
+    ) -> c_int;
+
+    /// Process double-precision buffers of any length
+    ///
+    /// Converts to and from `f32` around the plugin unless it processes at
+    /// 64 bits (see `rack_vst3_plugin_set_double_precision`).
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - The first failing sub-block's negative error code
+    ///
+    /// # Safety
+    ///
+    /// - Same requirements as `rack_vst3_plugin_process_split`
+    pub fn rack_vst3_plugin_process_split_f64(
+        plugin: *mut RackVST3Plugin,
+        inputs: *const *const f64,
+        num_input_channels: u32,
+        outputs: *const *mut f64,
+        num_output_channels: u32,
+        frames: u32,
+    ) -> c_int;
+
+    /// Request 64-bit processing (applied if the plugin supports kSample64)
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - Must not be called concurrently with `rack_vst3_plugin_process`
+    pub fn rack_vst3_plugin_set_double_precision(plugin: *mut RackVST3Plugin, enabled: c_int) -> c_int;
+
+    /// Bits per sample the plugin processes at
+    ///
+    /// # Returns
+    ///
+    /// - 32 or 64
+    /// - RACK_VST3_ERROR_NOT_INITIALIZED before initialize
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    pub fn rack_vst3_plugin_get_sample_size(plugin: *mut RackVST3Plugin) -> c_int;
+
+    /// Get the plugin's latency and tail in samples
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - RACK_VST3_ERROR_NOT_INITIALIZED before initialize
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - `latency_samples` and `tail_samples` must each be valid or null
+    pub fn rack_vst3_plugin_get_latency(plugin: *mut RackVST3Plugin, latency_samples: *mut u32, tail_samples: *mut u32) -> c_int;
+
+    /// Counter that advances whenever the latency or tail changes
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer or null
+    pub fn rack_vst3_plugin_get_latency_generation(plugin: *mut RackVST3Plugin) -> u32;
+
+    /// Set the processing mode reported to the plugin
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - RACK_VST3_ERROR_NOT_SUPPORTED if the plugin rejected the mode
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - Must not be called concurrently with `rack_vst3_plugin_process`
+    pub fn rack_vst3_plugin_set_process_mode(plugin: *mut RackVST3Plugin, mode: RackVST3ProcessMode) -> c_int;
+
+    /// Render buffers of any length in `max_block_size` chunks
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - Same requirements as `rack_vst3_plugin_process`, except that each
+    ///   channel buffer must hold `total_frames` values, which may exceed
+    ///   `max_block_size`
+    pub fn rack_vst3_plugin_render_offline(
+        plugin: *mut RackVST3Plugin,
+        inputs: *const *const f32,
+        num_input_channels: u32,
+        outputs: *const *mut f32,
+        num_output_channels: u32,
+        total_frames: u64,
+    ) -> c_int;
+
+    /// Enable or disable idle sleep (skip processing once the input has been
+    /// silent for longer than the plugin's tail)
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    pub fn rack_vst3_plugin_set_idle_sleep(plugin: *mut RackVST3Plugin, enabled: c_int) -> c_int;
+
+    /// Get the number of blocks processed and skipped while asleep
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - `processed` and `skipped` must each be valid or null
+    pub fn rack_vst3_plugin_get_block_counts(plugin: *mut RackVST3Plugin, processed: *mut u64, skipped: *mut u64) -> c_int;
+
+    /// Snapshot the instance's processing statistics
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - RACK_VST3_ERROR_NOT_SUPPORTED if built without performance counters
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - `stats` must be a valid pointer
+    pub fn rack_vst3_plugin_get_stats(plugin: *mut RackVST3Plugin, stats: *mut RackVST3PluginStats) -> c_int;
+
+    /// Zero the processing statistics
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    pub fn rack_vst3_plugin_reset_stats(plugin: *mut RackVST3Plugin) -> c_int;
+
+    /// Lock the instance's preallocated buffers into RAM through a realtime context
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - `ctx` must be a valid pointer returned by `rack_rt_context_enter`
+    pub fn rack_vst3_plugin_lock_memory(plugin: *mut RackVST3Plugin, ctx: *mut crate::rt::RackRtContext) -> c_int;
+
     /// Get parameter count
     ///
     /// # Returns
@@ -335,6 +686,54 @@ extern "C" {
         value: f32,
     ) -> c_int;
 
+    /// Queue sample-accurate automation points for the next process() call
+    ///
+    /// # Returns
+    ///
+    /// - Number of points queued (points with invalid index or that do not
+    ///   fit the preallocated queues are dropped)
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer returned by `rack_vst3_plugin_new`
+    /// - `points` must point to `count` valid `RackVST3ParamPoint` structs
+    /// - Must be called from the audio thread, between process() calls
+    pub fn rack_vst3_plugin_queue_param_points(
+        plugin: *mut RackVST3Plugin,
+        points: *const RackVST3ParamPoint,
+        count: u32,
+    ) -> c_int;
+
+    /// Apply controller-side parameter updates deferred from the audio thread
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer returned by `rack_vst3_plugin_new`
+    /// - Must be called from a non-realtime thread
+    pub fn rack_vst3_plugin_flush_param_updates(plugin: *mut RackVST3Plugin) -> c_int;
+
+    /// Map a native VST3 ParamID to its parameter index
+    ///
+    /// # Returns
+    ///
+    /// - Parameter index (>= 0) on success
+    /// - RACK_VST3_ERROR_NOT_FOUND if the ID is unknown
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer returned by `rack_vst3_plugin_new`
+    pub fn rack_vst3_plugin_param_index_for_id(
+        plugin: *mut RackVST3Plugin,
+        param_id: u32,
+    ) -> c_int;
+
     /// Get parameter info (name, min, max, default, unit)
     ///
     /// # Returns
@@ -454,6 +853,21 @@ extern "C" {
         size: *mut usize,
     ) -> c_int;
 
+    /// Serialize the plugin state once into a plugin-owned buffer
+    ///
+    /// # Returns
+    ///
+    /// - 0 on success (`*data`/`*size` describe the state)
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    /// - `data` and `size` must be valid pointers
+    /// - The returned data is owned by the plugin and is invalidated by the
+    ///   next state call on it (see the C header)
+    pub fn rack_vst3_plugin_snapshot_state(plugin: *mut RackVST3Plugin, data: *mut *const u8, size: *mut usize) -> c_int;
+
     /// Set plugin state (restore full state including parameters, preset, etc.)
     ///
     /// # Returns
@@ -474,6 +888,59 @@ extern "C" {
         size: usize,
     ) -> c_int;
 
+    // ============================================================================
+    // Asynchronous State Loading
+    // ============================================================================
+
+    /// Restore state on a background thread; process() bypasses the plugin
+    /// until the load has finished
+    ///
+    /// # Returns
+    ///
+    /// - 0 if the load was started
+    /// - RACK_VST3_ERROR_BUSY if a load is already pending
+    /// - Negative error code on failure
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer returned by `rack_vst3_plugin_new`
+    /// - `data` must point to `size` bytes of state data (copied before return)
+    /// - `callback` (if any) must be safe to call from another thread with `user_data`
+    pub fn rack_vst3_plugin_set_state_async(
+        plugin: *mut RackVST3Plugin,
+        data: *const u8,
+        size: usize,
+        callback: RackVST3StateLoadCallback,
+        user_data: *mut c_void,
+    ) -> c_int;
+
+    /// Load a factory preset on a background thread (see set_state_async)
+    ///
+    /// # Safety
+    ///
+    /// Same requirements as `rack_vst3_plugin_set_state_async`
+    pub fn rack_vst3_plugin_load_preset_async(
+        plugin: *mut RackVST3Plugin,
+        preset_number: i32,
+        callback: RackVST3StateLoadCallback,
+        user_data: *mut c_void,
+    ) -> c_int;
+
+    /// RACK_VST3_STATE_LOAD_PENDING while a load is running, otherwise the
+    /// result of the last asynchronous load
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    pub fn rack_vst3_plugin_state_load_status(plugin: *mut RackVST3Plugin) -> c_int;
+
+    /// Block until the pending asynchronous load has finished and return its result
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer
+    pub fn rack_vst3_plugin_wait_state_load(plugin: *mut RackVST3Plugin) -> c_int;
+
     // ============================================================================
     // MIDI API
     // ============================================================================
@@ -582,6 +1049,19 @@ extern "C" {
     #[cfg(any(target_os = "linux", target_os = "windows"))]
     pub fn rack_vst3_gui_get_window_id(gui: *mut RackVST3Gui) -> std::os::raw::c_ulong;
 
+    /// Get a file descriptor that is readable when the GUI needs pumping
+    ///
+    /// # Returns
+    ///
+    /// - fd (owned by the GUI) on success
+    /// - RACK_VST3_ERROR_NOT_SUPPORTED on Windows
+    ///
+    /// # Safety
+    ///
+    /// - `gui` must be a valid pointer returned by `rack_vst3_gui_create`
+    #[cfg(any(target_os = "linux", target_os = "windows"))]
+    pub fn rack_vst3_gui_get_fd(gui: *mut RackVST3Gui) -> c_int;
+
     /// Get IEditController from plugin
     ///
     /// # Safety
@@ -617,6 +1097,44 @@ extern "C" {
         changes: *mut RackVST3ParamChange,
         max_changes: u32,
     ) -> c_int;
+
+    /// Get the cumulative number of GUI parameter changes dropped
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer returned by `rack_vst3_plugin_new`
+    pub fn rack_vst3_plugin_get_param_change_overflows(plugin: *mut RackVST3Plugin) -> u64;
+
+    /// Get a file descriptor that is readable while GUI parameter changes are pending
+    ///
+    /// # Returns
+    ///
+    /// - fd (owned by the plugin) on success
+    /// - RACK_VST3_ERROR_NOT_SUPPORTED if unavailable
+    ///
+    /// # Safety
+    ///
+    /// - `plugin` must be a valid pointer returned by `rack_vst3_plugin_new`
+    /// - The fd must not be closed or read by the caller
+    pub fn rack_vst3_plugin_get_param_change_fd(plugin: *mut RackVST3Plugin) -> c_int;
+}
+
+// Processing statistics struct (matches C layout exactly)
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default)]
+pub struct RackVST3PluginStats {
+    pub process_calls: u64,
+    pub frames: u64,
+    pub total_ns: u64,
+    pub max_ns: u64,
+    pub deadline_ns: u64,
+    pub deadline_misses: u64,
+    pub max_load: f64,
+    pub average_load: f64,
+    pub process_errors: u64,
+    pub dropped_midi_events: u64,
+    pub dropped_param_changes: u64,
+    pub histogram: [u64; RACK_VST3_STATS_HISTOGRAM_BUCKETS],
 }
 
 // MIDI event struct (matches C layout exactly)
@@ -630,10 +1148,20 @@ pub struct RackVST3MidiEvent {
     pub channel: u8,
 }
 
+// Automation point struct (matches C layout exactly)
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct RackVST3ParamPoint {
+    pub param_index: u32,
+    pub sample_offset: u32,
+    pub value: f32,
+}
+
 // Parameter change event struct (for GUI -> host notifications)
 #[repr(C)]
 #[derive(Debug, Clone, Copy)]
 pub struct RackVST3ParamChange {
     pub param_id: u32,
+    pub param_index: i32,
     pub value: f64,
 }
@@ -279,6 +279,29 @@ impl Vst3Gui {
     pub fn get_window_id(&self) -> u64 {
         unsafe { ffi::rack_vst3_gui_get_window_id(self.handle) as u64 }
     }
+
+    /// Get a file descriptor for driving the GUI from an event loop
+    ///
+    /// The fd becomes readable when X11 events, or fds and timers the plugin
+    /// registered through `IRunLoop`, need servicing. Wait on it with
+    /// poll/epoll and call [`pump_events`](Self::pump_events) when it fires,
+    /// instead of pumping on a fixed interval. Pump once after `show()` and
+    /// `hide()` as well, since their events may already be buffered.
+    ///
+    /// The fd is owned by the GUI: do not read or close it. Returns `None` on
+    /// Windows, where messages arrive through the thread's message queue.
+    ///
+    /// # Thread Safety
+    ///
+    /// Can be called from any thread after creation.
+    pub fn fd(&self) -> Option<i32> {
+        let fd = unsafe { ffi::rack_vst3_gui_get_fd(self.handle) };
+        if fd >= 0 {
+            Some(fd)
+        } else {
+            None
+        }
+    }
 }
 
 impl Drop for Vst3Gui {
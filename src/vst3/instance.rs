@@ -1,4 +1,5 @@
-use crate::{Error, MidiEvent, MidiEventKind, ParameterInfo, PluginInfo, PluginInstance, PresetInfo, Result};
+use crate::graph::{GraphNode, RawProcessor};
+use crate::{Error, LatencyInfo, MidiEvent, MidiEventKind, ParameterInfo, PluginInfo, PluginInstance, PresetInfo, ProcessStats, Result};
 use smallvec::SmallVec;
 use std::ffi::CString;
 use std::marker::PhantomData;
@@ -28,6 +29,14 @@ pub struct Vst3Plugin {
     _not_sync: PhantomData<*const ()>,
 }
 
+/// Bundle path as the C API's module cache key
+fn module_path(info: &PluginInfo) -> Result<CString> {
+    let path_str = info.path.to_str()
+        .ok_or_else(|| Error::Other("Plugin path contains invalid UTF-8".to_string()))?;
+    CString::new(path_str)
+        .map_err(|_| Error::Other("Plugin path contains null byte".to_string()))
+}
+
 // Safety: Vst3Plugin can be sent between threads because:
 // 1. Each plugin instance owns its C++ state exclusively
 // 2. The plugin doesn't share mutable state with other instances
@@ -42,10 +51,7 @@ impl Vst3Plugin {
     pub(crate) fn new(info: &PluginInfo) -> Result<Self> {
         unsafe {
             // Convert path to CString
-            let path_str = info.path.to_str()
-                .ok_or_else(|| Error::Other("Plugin path contains invalid UTF-8".to_string()))?;
-            let path = CString::new(path_str)
-                .map_err(|_| Error::Other("Plugin path contains null byte".to_string()))?;
+            let path = module_path(info)?;
 
             // Convert unique_id to CString
             let unique_id = CString::new(info.unique_id.as_str())
@@ -72,6 +78,43 @@ impl Vst3Plugin {
         }
     }
 
+    /// Load a plugin's module ahead of its first instance
+    ///
+    /// Modules are shared by all instances created from the same bundle
+    /// path, so only the first `Vst3Plugin` pays for opening the bundle.
+    /// Preloading moves that cost out of the first instantiation and keeps
+    /// the module loaded when all instances are dropped, until
+    /// [`release_module`](Self::release_module).
+    pub fn preload_module(info: &PluginInfo) -> Result<()> {
+        let path = module_path(info)?;
+        let result = unsafe { ffi::rack_vst3_module_preload(path.as_ptr()) };
+        if result != ffi::RACK_VST3_OK {
+            return Err(map_error(result));
+        }
+        Ok(())
+    }
+
+    /// Undo [`preload_module`](Self::preload_module)
+    ///
+    /// The module is unloaded once no instance uses it.
+    pub fn release_module(info: &PluginInfo) -> Result<()> {
+        let path = module_path(info)?;
+        let result = unsafe { ffi::rack_vst3_module_release(path.as_ptr()) };
+        if result != ffi::RACK_VST3_OK {
+            return Err(map_error(result));
+        }
+        Ok(())
+    }
+
+    /// Whether the plugin's module is currently loaded (by instances or
+    /// preloading)
+    pub fn is_module_loaded(info: &PluginInfo) -> bool {
+        match module_path(info) {
+            Ok(path) => unsafe { ffi::rack_vst3_module_is_loaded(path.as_ptr()) != 0 },
+            Err(_) => false,
+        }
+    }
+
     /// Get raw pointer to the underlying C++ plugin instance
     ///
     /// This is used internally by the GUI module to create a GUI for the plugin.
@@ -85,11 +128,89 @@ impl Vst3Plugin {
         self.inner.as_ptr()
     }
 
+    /// Queue sample-accurate automation for the next `process()` call
+    ///
+    /// Each point is `(param_index, sample_offset, value)` with a normalized
+    /// value. Several points per parameter are allowed, so automation curves
+    /// are not quantized to block boundaries. Returns the number of points
+    /// queued; points with an invalid index or beyond the plugin's queue
+    /// capacity are dropped.
+    ///
+    /// Call from the audio thread between `process()` calls. The edit
+    /// controller is updated later by [`flush_param_updates`](Self::flush_param_updates).
+    pub fn queue_param_points(&mut self, points: &[(usize, u32, f32)]) -> Result<usize> {
+        if !self.is_initialized() {
+            return Err(Error::NotInitialized);
+        }
+
+        if points.is_empty() {
+            return Ok(0);
+        }
+
+        // Use SmallVec for zero-allocation in typical cases (≤64 points)
+        let c_points: SmallVec<[ffi::RackVST3ParamPoint; 64]> = points
+            .iter()
+            .map(|&(index, sample_offset, value)| ffi::RackVST3ParamPoint {
+                param_index: u32::try_from(index).unwrap_or(u32::MAX),
+                sample_offset,
+                value,
+            })
+            .collect();
+
+        unsafe {
+            let result = ffi::rack_vst3_plugin_queue_param_points(
+                self.inner.as_ptr(),
+                c_points.as_ptr(),
+                c_points.len() as u32,
+            );
+
+            if result < 0 {
+                return Err(map_error(result));
+            }
+
+            Ok(result as usize)
+        }
+    }
+
+    /// Apply controller-side parameter updates deferred from the audio thread
+    ///
+    /// `set_parameter()` and `queue_param_points()` only notify the audio
+    /// processor; the edit controller (and its GUI) catches up when this is
+    /// called. Call it from a non-realtime thread, e.g. alongside
+    /// `get_param_changes()` in a UI timer.
+    pub fn flush_param_updates(&mut self) -> Result<()> {
+        unsafe {
+            let result = ffi::rack_vst3_plugin_flush_param_updates(self.inner.as_ptr());
+
+            if result != ffi::RACK_VST3_OK {
+                return Err(map_error(result));
+            }
+
+            Ok(())
+        }
+    }
+
+    /// Map a native VST3 parameter ID to its parameter index
+    ///
+    /// Backed by a hash table built at initialization, so this is O(1) and
+    /// safe to call from the audio thread. Returns `None` for unknown IDs.
+    pub fn param_index_for_id(&self, param_id: u32) -> Option<usize> {
+        let result = unsafe {
+            ffi::rack_vst3_plugin_param_index_for_id(self.inner.as_ptr(), param_id)
+        };
+        if result >= 0 {
+            Some(result as usize)
+        } else {
+            None
+        }
+    }
+
     /// Get parameter changes from plugin GUI since last call
     ///
     /// Returns a list of (param_id, value) tuples for parameters that were
-    /// changed by the user in the plugin GUI. Call this regularly (e.g., every
-    /// audio buffer or on a timer) to stay in sync with GUI changes.
+    /// changed by the user in the plugin GUI. Call this when
+    /// [`param_change_fd`](Self::param_change_fd) becomes readable, or
+    /// regularly (e.g., on a timer) to stay in sync with GUI changes.
     ///
     /// # Example
     ///
@@ -102,64 +223,319 @@ impl Vst3Plugin {
     /// ```
     #[cfg(any(target_os = "linux", target_os = "windows"))]
     pub fn get_param_changes(&mut self) -> Result<Vec<(u32, f64)>> {
+        Ok(self.drain_param_changes()?
+            .into_iter()
+            .map(|c| (c.param_id, c.value))
+            .collect())
+    }
+
+    /// Get parameter changes from plugin GUI since last call, by index
+    ///
+    /// Like [`get_param_changes`](Self::get_param_changes), but returns
+    /// (parameter index, value) tuples that can be passed straight to
+    /// `set_parameter()`/`parameter_info()`. Changes for IDs outside the
+    /// parameter list are skipped.
+    #[cfg(any(target_os = "linux", target_os = "windows"))]
+    pub fn get_param_index_changes(&mut self) -> Result<Vec<(usize, f64)>> {
+        Ok(self.drain_param_changes()?
+            .into_iter()
+            .filter(|c| c.param_index >= 0)
+            .map(|c| (c.param_index as usize, c.value))
+            .collect())
+    }
+
+    /// Number of GUI parameter changes dropped so far
+    ///
+    /// Repeated edits to one parameter coalesce while pending, so this only
+    /// grows when more distinct parameters change between polls than the
+    /// queue holds. A non-zero value means `get_param_changes()` should be
+    /// polled more often.
+    #[cfg(any(target_os = "linux", target_os = "windows"))]
+    pub fn param_change_overflows(&self) -> u64 {
+        unsafe { ffi::rack_vst3_plugin_get_param_change_overflows(self.inner.as_ptr()) }
+    }
+
+    /// File descriptor that is readable while GUI parameter changes are pending
+    ///
+    /// Add it to a poll/epoll loop (alongside `Vst3Gui::fd()`)
+    /// and call `get_param_changes()` when it fires instead of polling. It
+    /// stays readable until every pending change has been returned. The fd is
+    /// owned by the plugin: do not read or close it. Returns `None` on Windows.
+    pub fn param_change_fd(&self) -> Option<i32> {
+        let fd = unsafe { ffi::rack_vst3_plugin_get_param_change_fd(self.inner.as_ptr()) };
+        if fd >= 0 {
+            Some(fd)
+        } else {
+            None
+        }
+    }
+
+    /// Set whether the plugin renders offline (VST3 `kOffline`) or in realtime
+    ///
+    /// Offline mode lets the plugin use its higher-quality, non-realtime
+    /// processing and be run faster than realtime, e.g. for bounces. May be
+    /// called before or after `initialize()`; afterwards the plugin is briefly
+    /// deactivated to apply the new setup. Must not be called concurrently
+    /// with `process()`.
+    pub fn set_offline_mode(&mut self, offline: bool) -> Result<()> {
+        let mode = if offline {
+            ffi::RackVST3ProcessMode::Offline
+        } else {
+            ffi::RackVST3ProcessMode::Realtime
+        };
+
         unsafe {
-            // First, get the count of pending changes
-            let count = ffi::rack_vst3_plugin_get_param_changes(
+            let result = ffi::rack_vst3_plugin_set_process_mode(self.inner.as_ptr(), mode);
+            if result != ffi::RACK_VST3_OK {
+                return Err(map_error(result));
+            }
+        }
+
+        Ok(())
+    }
+
+    /// Lock the instance's preallocated processing buffers into RAM
+    ///
+    /// The buffers stay locked until `ctx` is dropped. Call after
+    /// `initialize()` (and again after re-initializing), before processing
+    /// starts. Does nothing if `ctx` was entered without `lock_memory`.
+    pub fn lock_memory(&mut self, ctx: &mut crate::rt::RtContext) -> Result<()> {
+        unsafe {
+            let result = ffi::rack_vst3_plugin_lock_memory(self.inner.as_ptr(), ctx.as_ptr());
+            if result != ffi::RACK_VST3_OK {
+                return Err(map_error(result));
+            }
+        }
+
+        Ok(())
+    }
+
+    /// Request 64-bit (`kSample64`) processing for double-precision hosts
+    ///
+    /// The plugin switches only if it supports 64-bit samples; check
+    /// [`sample_size`](Self::sample_size). Either way,
+    /// [`process_f64`](Self::process_f64) works. May be called before or
+    /// after `initialize()`; afterwards the plugin is briefly deactivated.
+    /// Must not be called concurrently with `process()`.
+    pub fn set_double_precision(&mut self, enabled: bool) -> Result<()> {
+        let result = unsafe { ffi::rack_vst3_plugin_set_double_precision(self.inner.as_ptr(), enabled as i32) };
+        if result != ffi::RACK_VST3_OK {
+            return Err(map_error(result));
+        }
+        Ok(())
+    }
+
+    /// Bits per sample the plugin processes at (32 or 64), or `None` before
+    /// `initialize()`
+    pub fn sample_size(&self) -> Option<u32> {
+        let size = unsafe { ffi::rack_vst3_plugin_get_sample_size(self.inner.as_ptr()) };
+        if size > 0 {
+            Some(size as u32)
+        } else {
+            None
+        }
+    }
+
+    /// Process double-precision planar buffers of any length
+    ///
+    /// Same rules as `process()`. Runs without conversion when the plugin
+    /// processes at 64 bits (see
+    /// [`set_double_precision`](Self::set_double_precision)), otherwise the
+    /// samples are converted to `f32` and back around the plugin.
+    pub fn process_f64(
+        &mut self,
+        inputs: &[&[f64]],
+        outputs: &mut [&mut [f64]],
+        num_frames: usize,
+    ) -> Result<()> {
+        if !self.is_initialized() {
+            return Err(Error::NotInitialized);
+        }
+
+        if num_frames > i32::MAX as usize {
+            return Err(Error::Other(format!("Frame count {} too large", num_frames)));
+        }
+        self.check_buffers(inputs, outputs, num_frames)?;
+
+        let input_ptrs: SmallVec<[*const f64; 8]> = inputs.iter().map(|ch| ch.as_ptr()).collect();
+        let output_ptrs: SmallVec<[*mut f64; 8]> = outputs.iter_mut().map(|ch| ch.as_mut_ptr()).collect();
+
+        unsafe {
+            let result = ffi::rack_vst3_plugin_process_split_f64(
                 self.inner.as_ptr(),
-                std::ptr::null_mut(),
-                0,
+                input_ptrs.as_ptr(),
+                inputs.len() as u32,
+                output_ptrs.as_ptr(),
+                outputs.len() as u32,
+                num_frames as u32,
             );
 
-            if count < 0 {
-                return Err(map_error(count));
+            if result != ffi::RACK_VST3_OK {
+                return Err(map_error(result));
             }
+        }
 
-            if count == 0 {
-                return Ok(Vec::new());
-            }
+        Ok(())
+    }
 
-            // Allocate buffer and get changes
-            let mut changes = vec![ffi::RackVST3ParamChange { param_id: 0, value: 0.0 }; count as usize];
-            let actual = ffi::rack_vst3_plugin_get_param_changes(
+    /// Render buffers of any length (planar format)
+    ///
+    /// Unlike `process()`, `num_frames` may exceed `max_block_size`: the
+    /// buffers are split into `max_block_size` chunks that are processed in
+    /// order with a continuous sample position. Typically used with
+    /// [`set_offline_mode`](Self::set_offline_mode).
+    pub fn render_offline(
+        &mut self,
+        inputs: &[&[f32]],
+        outputs: &mut [&mut [f32]],
+        num_frames: usize,
+    ) -> Result<()> {
+        if !self.is_initialized() {
+            return Err(Error::NotInitialized);
+        }
+
+        self.fill_buffer_ptrs(inputs, outputs, num_frames)?;
+
+        unsafe {
+            let result = ffi::rack_vst3_plugin_render_offline(
                 self.inner.as_ptr(),
-                changes.as_mut_ptr(),
-                count as u32,
+                self.input_ptrs.as_ptr(),
+                inputs.len() as u32,
+                self.output_ptrs.as_ptr(),
+                outputs.len() as u32,
+                num_frames as u64,
             );
 
-            if actual < 0 {
-                return Err(map_error(actual));
+            if result != ffi::RACK_VST3_OK {
+                return Err(map_error(result));
             }
-
-            // Convert to (param_id, value) tuples
-            Ok(changes.into_iter()
-                .take(actual as usize)
-                .map(|c| (c.param_id, c.value))
-                .collect())
         }
+
+        Ok(())
     }
-}
 
-impl Drop for Vst3Plugin {
-    fn drop(&mut self) {
+    /// Let `process()` skip the plugin once it has gone idle
+    ///
+    /// Silent input is always flagged to the plugin. With idle sleep on, the
+    /// plugin is not called once its input has been digital silence (with no
+    /// MIDI) for longer than its reported tail plus latency and its last output
+    /// was silent; outputs are zero-filled instead. The first non-silent
+    /// block, MIDI event, reset or state load wakes it. Off by default;
+    /// avoid it for plugins that generate sound without input or MIDI.
+    pub fn set_idle_sleep(&mut self, enabled: bool) -> Result<()> {
         unsafe {
-            ffi::rack_vst3_plugin_free(self.inner.as_ptr());
+            let result = ffi::rack_vst3_plugin_set_idle_sleep(self.inner.as_ptr(), enabled as i32);
+            if result != ffi::RACK_VST3_OK {
+                return Err(map_error(result));
+            }
         }
+
+        Ok(())
     }
-}
 
-impl PluginInstance for Vst3Plugin {
-    fn initialize(&mut self, sample_rate: f64, max_block_size: usize) -> Result<()> {
+    /// Number of blocks processed and skipped while asleep, as
+    /// `(processed, skipped)`
+    pub fn block_counts(&self) -> (u64, u64) {
+        let mut processed = 0u64;
+        let mut skipped = 0u64;
         unsafe {
-            let result = ffi::rack_vst3_plugin_initialize(
-                self.inner.as_ptr(),
+            ffi::rack_vst3_plugin_get_block_counts(self.inner.as_ptr(), &mut processed, &mut skipped);
+        }
+        (processed, skipped)
+    }
+
+    /// Create many plugin instances in parallel
+    ///
+    /// Instances are created on a pool of `num_threads` workers (0 = one per
+    /// hardware thread) and, if `max_block_size` is non-zero, initialized
+    /// there too. Setup is only serialized between instances of the same
+    /// bundle, so loading a large project uses all cores. Results are in the
+    /// order of `infos`.
+    pub fn new_parallel(
+        infos: &[PluginInfo],
+        sample_rate: f64,
+        max_block_size: usize,
+        num_threads: usize,
+    ) -> Result<Vec<Result<Self>>> {
+        let mut paths = Vec::with_capacity(infos.len());
+        let mut uids = Vec::with_capacity(infos.len());
+        for info in infos {
+            paths.push(module_path(info)?);
+            uids.push(CString::new(info.unique_id.as_str())
+                .map_err(|_| Error::Other("Plugin UID contains null byte".to_string()))?);
+        }
+        let path_ptrs: Vec<*const std::os::raw::c_char> = paths.iter().map(|p| p.as_ptr()).collect();
+        let uid_ptrs: Vec<*const std::os::raw::c_char> = uids.iter().map(|u| u.as_ptr()).collect();
+        let mut ptrs: Vec<*mut ffi::RackVST3Plugin> = vec![std::ptr::null_mut(); infos.len()];
+
+        let result = unsafe {
+            ffi::rack_vst3_plugins_new_parallel(
+                path_ptrs.as_ptr(),
+                uid_ptrs.as_ptr(),
+                infos.len(),
                 sample_rate,
                 max_block_size as u32,
-            );
+                num_threads as u32,
+                ptrs.as_mut_ptr(),
+            )
+        };
+        if result < 0 {
+            return Err(map_error(result));
+        }
 
-            if result != ffi::RACK_VST3_OK {
-                return Err(map_error(result));
-            }
+        let plugins = infos
+            .iter()
+            .zip(ptrs)
+            .map(|(info, ptr)| {
+                let inner = NonNull::new(ptr).ok_or_else(|| {
+                    Error::PluginNotFound(format!("Failed to create VST3 instance for {}", info.name))
+                })?;
+                // Initialized by the worker pool if max_block_size > 0
+                Self::from_raw(inner, info.clone())
+            })
+            .collect();
+
+        Ok(plugins)
+    }
+
+    /// Create another instance of this plugin with the same state
+    ///
+    /// Much cheaper than a new instance followed by `set_state()`: the class
+    /// is instantiated from the already loaded module and the state is handed
+    /// over in memory before the clone is set up, so it is activated once.
+    /// Offline mode, double precision and idle sleep settings carry over. If
+    /// this instance is initialized, the clone is initialized with the same
+    /// sample rate and block size. `process()` may keep running on this
+    /// instance meanwhile.
+    pub fn try_clone(&mut self) -> Result<Self> {
+        let ptr = unsafe { ffi::rack_vst3_plugin_clone(self.inner.as_ptr()) };
+        let inner = NonNull::new(ptr).ok_or_else(|| {
+            Error::Other(format!("Failed to clone VST3 instance of {}", self.info.name))
+        })?;
+        Self::from_raw(inner, self.info.clone())
+    }
+
+    /// Wrap an instance created by the C API, initialized or not
+    fn from_raw(inner: NonNull<ffi::RackVST3Plugin>, info: PluginInfo) -> Result<Self> {
+        let mut plugin = Self {
+            inner,
+            info,
+            input_ptrs: Vec::new(),
+            output_ptrs: Vec::new(),
+            input_channels: 0,
+            output_channels: 0,
+            _not_sync: PhantomData,
+        };
+        if plugin.is_initialized() {
+            plugin.configure_channels()?;
+        }
+        Ok(plugin)
+    }
 
+    /// Query the channel configuration after initialization and size the
+    /// pre-allocated pointer arrays for it
+    fn configure_channels(&mut self) -> Result<()> {
+        unsafe {
             // Query actual channel configuration
             let input_channels = ffi::rack_vst3_plugin_get_input_channels(self.inner.as_ptr());
             let output_channels = ffi::rack_vst3_plugin_get_output_channels(self.inner.as_ptr());
@@ -184,28 +560,124 @@ impl PluginInstance for Vst3Plugin {
         }
     }
 
-    fn reset(&mut self) -> Result<()> {
-        unsafe {
-            let result = ffi::rack_vst3_plugin_reset(self.inner.as_ptr());
+    /// Serialize the plugin state once, without copying it
+    ///
+    /// Same bytes as [`get_state`](PluginInstance::get_state), but the state
+    /// is serialized a single time into a buffer owned by the plugin and
+    /// reused between snapshots. Suited to frequent autosave or undo
+    /// snapshots; the slice is valid until the next state call.
+    pub fn snapshot_state(&mut self) -> Result<&[u8]> {
+        if !self.is_initialized() {
+            return Err(Error::NotInitialized);
+        }
+
+        // Safety: the &mut borrow keeps other state calls away while the
+        // slice is alive
+        unsafe { self.snapshot_raw() }
+    }
 
+    /// Serialize the plugin state into `out`, reusing its allocation
+    ///
+    /// `out` is cleared first. Once it has grown to the plugin's state size,
+    /// repeated calls don't allocate.
+    pub fn get_state_into(&mut self, out: &mut Vec<u8>) -> Result<()> {
+        let state = self.snapshot_state()?;
+        out.clear();
+        out.extend_from_slice(state);
+        Ok(())
+    }
+
+    /// Take a state snapshot into the plugin-owned buffer
+    ///
+    /// # Safety
+    ///
+    /// The returned slice is invalidated by the next state call on this
+    /// plugin; the caller must not hold it across one.
+    unsafe fn snapshot_raw(&self) -> Result<&[u8]> {
+        let mut data: *const u8 = std::ptr::null();
+        let mut size: usize = 0;
+        let result = ffi::rack_vst3_plugin_snapshot_state(self.inner.as_ptr(), &mut data, &mut size);
+        if result != ffi::RACK_VST3_OK {
+            return Err(map_error(result));
+        }
+        if data.is_null() || size == 0 {
+            return Ok(&[]);
+        }
+        Ok(std::slice::from_raw_parts(data, size))
+    }
+
+    /// Start restoring `data` on a background thread
+    ///
+    /// Returns as soon as the load has started; `data` is copied. Until it
+    /// finishes, `process()` passes input straight to the output instead of
+    /// calling the plugin, and the blocking state and preset methods fail.
+    /// Use [`poll_state_load`](Self::poll_state_load) or
+    /// [`wait_state_load`](Self::wait_state_load) to collect the result.
+    pub fn set_state_async(&mut self, data: &[u8]) -> Result<()> {
+        if data.is_empty() {
+            return Err(Error::Other("State data is empty".to_string()));
+        }
+
+        unsafe {
+            let result = ffi::rack_vst3_plugin_set_state_async(
+                self.inner.as_ptr(),
+                data.as_ptr(),
+                data.len(),
+                None,
+                std::ptr::null_mut(),
+            );
             if result != ffi::RACK_VST3_OK {
                 return Err(map_error(result));
             }
-
-            Ok(())
         }
+        Ok(())
     }
 
-    fn process(
-        &mut self,
-        inputs: &[&[f32]],
-        outputs: &mut [&mut [f32]],
-        num_frames: usize,
-    ) -> Result<()> {
+    /// Start loading a factory preset on a background thread
+    ///
+    /// Same behaviour as [`set_state_async`](Self::set_state_async).
+    pub fn load_preset_async(&mut self, preset_number: i32) -> Result<()> {
         if !self.is_initialized() {
             return Err(Error::NotInitialized);
         }
 
+        unsafe {
+            let result = ffi::rack_vst3_plugin_load_preset_async(
+                self.inner.as_ptr(),
+                preset_number,
+                None,
+                std::ptr::null_mut(),
+            );
+            if result != ffi::RACK_VST3_OK {
+                return Err(map_error(result));
+            }
+        }
+        Ok(())
+    }
+
+    /// Result of the last asynchronous load, or `None` while it is running
+    pub fn poll_state_load(&self) -> Option<Result<()>> {
+        let status = unsafe { ffi::rack_vst3_plugin_state_load_status(self.inner.as_ptr()) };
+        match status {
+            ffi::RACK_VST3_STATE_LOAD_PENDING => None,
+            ffi::RACK_VST3_OK => Some(Ok(())),
+            code => Some(Err(map_error(code))),
+        }
+    }
+
+    /// Block until the pending asynchronous load has finished
+    ///
+    /// Returns the load's result (`Ok` if no load was started).
+    pub fn wait_state_load(&mut self) -> Result<()> {
+        let result = unsafe { ffi::rack_vst3_plugin_wait_state_load(self.inner.as_ptr()) };
+        if result != ffi::RACK_VST3_OK {
+            return Err(map_error(result));
+        }
+        Ok(())
+    }
+
+    /// Validate planar buffers against the plugin's configuration
+    fn check_buffers<T>(&self, inputs: &[&[T]], outputs: &[&mut [T]], num_frames: usize) -> Result<()> {
         // Validate channel counts match plugin configuration
         if inputs.len() != self.input_channels {
             return Err(Error::Other(format!(
@@ -250,6 +722,19 @@ impl PluginInstance for Vst3Plugin {
             }
         }
 
+        Ok(())
+    }
+
+    /// Validate planar buffers and store their pointers in the
+    /// pre-allocated pointer arrays
+    fn fill_buffer_ptrs(
+        &mut self,
+        inputs: &[&[f32]],
+        outputs: &mut [&mut [f32]],
+        num_frames: usize,
+    ) -> Result<()> {
+        self.check_buffers(inputs, outputs, num_frames)?;
+
         // Reuse pre-allocated pointer arrays (zero-allocation hot path)
         // Fill with current buffer pointers
         for (i, input_ch) in inputs.iter().enumerate() {
@@ -259,8 +744,193 @@ impl PluginInstance for Vst3Plugin {
             self.output_ptrs[i] = output_ch.as_mut_ptr();
         }
 
+        Ok(())
+    }
+
+    #[cfg(any(target_os = "linux", target_os = "windows"))]
+    fn drain_param_changes(&mut self) -> Result<Vec<ffi::RackVST3ParamChange>> {
         unsafe {
-            let result = ffi::rack_vst3_plugin_process(
+            // First, get the count of pending changes
+            let count = ffi::rack_vst3_plugin_get_param_changes(
+                self.inner.as_ptr(),
+                std::ptr::null_mut(),
+                0,
+            );
+
+            if count < 0 {
+                return Err(map_error(count));
+            }
+
+            if count == 0 {
+                return Ok(Vec::new());
+            }
+
+            // Allocate buffer and get changes
+            let empty = ffi::RackVST3ParamChange { param_id: 0, param_index: -1, value: 0.0 };
+            let mut changes = vec![empty; count as usize];
+            let actual = ffi::rack_vst3_plugin_get_param_changes(
+                self.inner.as_ptr(),
+                changes.as_mut_ptr(),
+                count as u32,
+            );
+
+            if actual < 0 {
+                return Err(map_error(actual));
+            }
+
+            changes.truncate(actual as usize);
+            Ok(changes)
+        }
+    }
+}
+
+/// Graph trampoline: the graph passes the plugin as an untyped instance
+unsafe extern "C" fn graph_process(
+    instance: *mut std::ffi::c_void,
+    inputs: *const *const f32,
+    num_input_channels: u32,
+    outputs: *const *mut f32,
+    num_output_channels: u32,
+    frames: u32,
+) -> std::os::raw::c_int {
+    ffi::rack_vst3_plugin_process(
+        instance as *mut ffi::RackVST3Plugin,
+        inputs,
+        num_input_channels,
+        outputs,
+        num_output_channels,
+        frames,
+    )
+}
+
+// Safety: the C++ instance is heap-allocated and outlives the Rust wrapper's
+// moves; process() only touches that instance's own state
+unsafe impl GraphNode for Vst3Plugin {
+    fn raw_processor(&mut self) -> Result<RawProcessor> {
+        if !self.is_initialized() {
+            return Err(Error::NotInitialized);
+        }
+
+        unsafe {
+            Ok(RawProcessor::new(
+                self.inner.as_ptr() as *mut std::ffi::c_void,
+                graph_process,
+                self.input_channels,
+                self.output_channels,
+            ))
+        }
+    }
+}
+
+impl Drop for Vst3Plugin {
+    fn drop(&mut self) {
+        unsafe {
+            ffi::rack_vst3_plugin_free(self.inner.as_ptr());
+        }
+    }
+}
+
+/// A pool of ready instances of one VST3 plugin
+///
+/// Keeps up to `size` clones of a prototype instance (see
+/// [`Vst3Plugin::try_clone`]) created, initialized and activated ahead of
+/// time, so [`acquire`](Self::acquire) hands one out in microseconds. A
+/// background thread refills the pool whenever an instance is taken. Clones
+/// carry the prototype's state and settings from when the pool was created;
+/// the prototype may be dropped afterwards.
+pub struct Vst3Pool {
+    inner: NonNull<ffi::RackVST3Pool>,
+    info: PluginInfo,
+}
+
+// Safety: the C pool API is thread-safe
+unsafe impl Send for Vst3Pool {}
+unsafe impl Sync for Vst3Pool {}
+
+impl Vst3Pool {
+    /// Create a pool of up to `size` instances of `prototype`
+    pub fn new(prototype: &mut Vst3Plugin, size: usize) -> Result<Self> {
+        let ptr = unsafe { ffi::rack_vst3_pool_new(prototype.inner.as_ptr(), size as u32) };
+        let inner = NonNull::new(ptr).ok_or_else(|| {
+            Error::Other(format!("Failed to create VST3 instance pool for {}", prototype.info.name))
+        })?;
+        Ok(Self {
+            inner,
+            info: prototype.info.clone(),
+        })
+    }
+
+    /// Take a ready instance, or `None` if the pool is empty (still
+    /// refilling, or creating instances failed). Never waits for an instance
+    /// to be created; not for the audio thread.
+    pub fn acquire(&self) -> Option<Vst3Plugin> {
+        let ptr = unsafe { ffi::rack_vst3_pool_acquire(self.inner.as_ptr()) };
+        let inner = NonNull::new(ptr)?;
+        Vst3Plugin::from_raw(inner, self.info.clone()).ok()
+    }
+
+    /// Number of ready instances
+    pub fn available(&self) -> usize {
+        let count = unsafe { ffi::rack_vst3_pool_available(self.inner.as_ptr()) };
+        count.max(0) as usize
+    }
+}
+
+impl Drop for Vst3Pool {
+    fn drop(&mut self) {
+        unsafe {
+            ffi::rack_vst3_pool_free(self.inner.as_ptr());
+        }
+    }
+}
+
+impl PluginInstance for Vst3Plugin {
+    fn initialize(&mut self, sample_rate: f64, max_block_size: usize) -> Result<()> {
+        unsafe {
+            let result = ffi::rack_vst3_plugin_initialize(
+                self.inner.as_ptr(),
+                sample_rate,
+                max_block_size as u32,
+            );
+
+            if result != ffi::RACK_VST3_OK {
+                return Err(map_error(result));
+            }
+        }
+
+        self.configure_channels()
+    }
+
+    fn reset(&mut self) -> Result<()> {
+        unsafe {
+            let result = ffi::rack_vst3_plugin_reset(self.inner.as_ptr());
+
+            if result != ffi::RACK_VST3_OK {
+                return Err(map_error(result));
+            }
+
+            Ok(())
+        }
+    }
+
+    fn process(
+        &mut self,
+        inputs: &[&[f32]],
+        outputs: &mut [&mut [f32]],
+        num_frames: usize,
+    ) -> Result<()> {
+        if !self.is_initialized() {
+            return Err(Error::NotInitialized);
+        }
+
+        if num_frames > i32::MAX as usize {
+            return Err(Error::Other(format!("Frame count {} too large", num_frames)));
+        }
+        self.fill_buffer_ptrs(inputs, outputs, num_frames)?;
+
+        // Longer-than-block buffers are split on the C++ side
+        unsafe {
+            let result = ffi::rack_vst3_plugin_process_split(
                 self.inner.as_ptr(),
                 self.input_ptrs.as_ptr(),
                 inputs.len() as u32,
@@ -507,33 +1177,8 @@ impl PluginInstance for Vst3Plugin {
             return Err(Error::NotInitialized);
         }
 
-        unsafe {
-            // Get state size
-            let size = ffi::rack_vst3_plugin_get_state_size(self.inner.as_ptr());
-            if size <= 0 {
-                return Err(Error::Other("Failed to get plugin state size".to_string()));
-            }
-
-            // Allocate buffer
-            let mut data = vec![0u8; size as usize];
-            let mut actual_size = data.len();
-
-            // Get state data
-            let result = ffi::rack_vst3_plugin_get_state(
-                self.inner.as_ptr(),
-                data.as_mut_ptr(),
-                &mut actual_size,
-            );
-
-            if result != ffi::RACK_VST3_OK {
-                return Err(map_error(result));
-            }
-
-            // Resize to actual size
-            data.resize(actual_size, 0);
-
-            Ok(data)
-        }
+        // Serialized once, then copied out of the plugin-owned buffer
+        unsafe { Ok(self.snapshot_raw()?.to_vec()) }
     }
 
     fn set_state(&mut self, data: &[u8]) -> Result<()> {
@@ -560,6 +1205,53 @@ impl PluginInstance for Vst3Plugin {
         }
     }
 
+    fn latency_info(&mut self) -> Result<LatencyInfo> {
+        let mut latency = 0u32;
+        let mut tail = 0u32;
+        let result = unsafe { ffi::rack_vst3_plugin_get_latency(self.inner.as_ptr(), &mut latency, &mut tail) };
+        if result != ffi::RACK_VST3_OK {
+            return Err(map_error(result));
+        }
+        Ok(LatencyInfo::new(latency, tail))
+    }
+
+    fn latency_generation(&self) -> u32 {
+        unsafe { ffi::rack_vst3_plugin_get_latency_generation(self.inner.as_ptr()) }
+    }
+
+    fn stats(&mut self) -> Result<ProcessStats> {
+        let mut raw = ffi::RackVST3PluginStats::default();
+        let result = unsafe { ffi::rack_vst3_plugin_get_stats(self.inner.as_ptr(), &mut raw) };
+        if result == ffi::RACK_VST3_ERROR_NOT_SUPPORTED {
+            return Err(Error::Other("rack-sys was built without performance counters".to_string()));
+        }
+        if result != ffi::RACK_VST3_OK {
+            return Err(map_error(result));
+        }
+        Ok(ProcessStats {
+            process_calls: raw.process_calls,
+            frames: raw.frames,
+            total_ns: raw.total_ns,
+            max_ns: raw.max_ns,
+            deadline_ns: raw.deadline_ns,
+            deadline_misses: raw.deadline_misses,
+            max_load: raw.max_load,
+            average_load: raw.average_load,
+            process_errors: raw.process_errors,
+            dropped_midi_events: raw.dropped_midi_events,
+            dropped_param_changes: raw.dropped_param_changes,
+            histogram: raw.histogram,
+        })
+    }
+
+    fn reset_stats(&mut self) -> Result<()> {
+        let result = unsafe { ffi::rack_vst3_plugin_reset_stats(self.inner.as_ptr()) };
+        if result != ffi::RACK_VST3_OK {
+            return Err(map_error(result));
+        }
+        Ok(())
+    }
+
     fn info(&self) -> &PluginInfo {
         &self.info
     }
@@ -7,7 +7,7 @@ mod instance;
 mod gui;
 
 pub use scanner::Vst3Scanner;
-pub use instance::Vst3Plugin;
+pub use instance::{Vst3Plugin, Vst3Pool};
 
 #[cfg(any(target_os = "linux", target_os = "windows"))]
 pub use gui::Vst3Gui;
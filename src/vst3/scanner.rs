@@ -1,7 +1,6 @@
 use crate::{Error, PluginInfo, PluginScanner, PluginType, Result};
 use std::ffi::CString;
 use std::marker::PhantomData;
-use std::mem::MaybeUninit;
 use std::path::{Path, PathBuf};
 use std::ptr::NonNull;
 
@@ -104,61 +103,67 @@ impl Vst3Scanner {
         Ok(())
     }
 
+    /// Persist scan results to a cache file
+    ///
+    /// Bundles whose binary is unchanged since they were cached are reported
+    /// without loading the module, which makes rescans at startup cheap.
+    /// Bundles that failed to load are remembered too and only retried once
+    /// they change.
+    ///
+    /// # Errors
+    ///
+    /// Returns an error if the path is invalid
+    pub fn set_cache_path(&mut self, path: &Path) -> Result<()> {
+        let path_str = path.to_str()
+            .ok_or_else(|| Error::Other("Path contains invalid UTF-8".to_string()))?;
+
+        let path_cstr = CString::new(path_str)
+            .map_err(|_| Error::Other("Path contains null byte".to_string()))?;
+
+        unsafe {
+            let result = ffi::rack_vst3_scanner_set_cache_path(self.inner.as_ptr(), path_cstr.as_ptr());
+            if result != ffi::RACK_VST3_OK {
+                return Err(map_error(result));
+            }
+        }
+
+        Ok(())
+    }
+
+    /// Enable or disable out-of-process probing (enabled by default)
+    ///
+    /// On Linux, bundles that need loading are probed in parallel worker
+    /// processes so a plugin that crashes or hangs during load is skipped
+    /// instead of taking down the host. Has no effect on other platforms.
+    pub fn set_out_of_process(&mut self, enabled: bool) {
+        unsafe {
+            ffi::rack_vst3_scanner_set_out_of_process(self.inner.as_ptr(), enabled as i32);
+        }
+    }
+
     /// Scan for VST3 plugins
     fn scan_plugins(&self) -> Result<Vec<PluginInfo>> {
         unsafe {
-            // First pass: get count
-            let count = ffi::rack_vst3_scanner_scan(self.inner.as_ptr(), std::ptr::null_mut(), 0);
+            let mut plugins_c: *const ffi::RackVST3PluginInfo = std::ptr::null();
+            let count = ffi::rack_vst3_scanner_scan_results(self.inner.as_ptr(), &mut plugins_c);
 
             if count < 0 {
                 return Err(map_error(count));
             }
 
-            if count == 0 {
+            if count == 0 || plugins_c.is_null() {
                 return Ok(Vec::new());
             }
 
-            // Check for integer overflow when converting c_int to usize
             let count_usize = usize::try_from(count)
                 .map_err(|_| Error::Other("Plugin count exceeds usize".to_string()))?;
 
-            // Allocate uninitialized array for results
-            // Safety: MaybeUninit allows uninitialized memory for C interop
-            let mut plugins_c: Vec<MaybeUninit<ffi::RackVST3PluginInfo>> =
-                Vec::with_capacity(count_usize);
-            plugins_c.resize_with(count_usize, MaybeUninit::uninit);
-
-            // Second pass: fill array
-            let actual_count = ffi::rack_vst3_scanner_scan(
-                self.inner.as_ptr(),
-                plugins_c.as_mut_ptr() as *mut ffi::RackVST3PluginInfo,
-                count_usize,
-            );
-
-            if actual_count < 0 {
-                return Err(map_error(actual_count));
-            }
-
-            // Handle race condition: plugin list may have changed between passes
-            let actual_count_usize = usize::try_from(actual_count)
-                .map_err(|_| Error::Other("Actual plugin count exceeds usize".to_string()))?;
-
-            // Use the minimum of the two counts to avoid reading uninitialized memory
-            let valid_count = actual_count_usize.min(count_usize);
-
-            // Convert initialized C structs to Rust PluginInfo
-            // Safety: The C++ code guarantees that the first `actual_count` elements are initialized
-            let plugins = plugins_c
-                .into_iter()
-                .take(valid_count)
-                .map(|p| {
-                    // Safety: C++ has written valid data to these elements
-                    let plugin_info = p.assume_init();
-                    convert_plugin_info(&plugin_info)
-                })
-                .collect::<Result<Vec<_>>>()?;
-
-            Ok(plugins)
+            // Safety: the scanner owns `count` initialized entries, valid until
+            // the next scan; they are converted before this borrow ends
+            std::slice::from_raw_parts(plugins_c, count_usize)
+                .iter()
+                .map(convert_plugin_info)
+                .collect()
         }
     }
 }
@@ -1,20 +1,27 @@
 //! Wine host for loading Windows VST3 plugins on Linux
 //!
 //! This module provides support for loading Windows VST3 plugins via Wine.
-//! It spawns a Wine host process that loads the plugin and communicates
-//! via TCP socket and shared memory for audio.
+//! Plugins share one Wine host process per executable and prefix; each one
+//! is its own session in it and communicates via TCP socket and shared
+//! memory for audio. Once audio is initialized the
+//! per-block handoff uses a doorbell in the shared memory header instead of
+//! the socket, so TCP is only used for control commands.
 
 mod protocol;
 
-use crate::{Error, MidiEvent, ParameterInfo, PluginInfo, PluginInstance, PluginScanner, PluginType, PresetInfo, Result};
+use crate::{Error, LatencyInfo, MidiEvent, ParameterInfo, PluginInfo, PluginInstance, PluginScanner, PluginType, PresetInfo, ProcessStats, Result};
 use protocol::*;
 
-use std::io::{Read, Write};
+use smallvec::SmallVec;
+use std::cell::{RefCell, RefMut};
+use std::collections::HashMap;
+use std::io::{BufRead, BufReader, Read, Write};
 use std::net::TcpStream;
 use std::path::{Path, PathBuf};
 use std::process::{Child, Command, Stdio};
 use std::sync::atomic::{AtomicU32, Ordering};
-use std::time::Duration;
+use std::sync::{mpsc, Arc, Mutex, Weak};
+use std::time::{Duration, Instant};
 
 /// Path to the Wine host executable (relative to the crate or absolute)
 const WINE_HOST_EXE: &str = "rack-wine-host.exe";
@@ -22,6 +29,13 @@ const WINE_HOST_EXE: &str = "rack-wine-host.exe";
 /// Global counter for unique shared memory names
 static SHM_COUNTER: AtomicU32 = AtomicU32::new(0);
 
+/// How long a freshly spawned host gets to report its port
+const HOST_STARTUP_TIMEOUT: Duration = Duration::from_secs(30);
+
+/// Running host processes by executable and Wine prefix, shared by every
+/// plugin loaded through them
+static HOST_PROCESSES: Mutex<Vec<(PathBuf, Option<PathBuf>, Weak<WineHostProcess>)>> = Mutex::new(Vec::new());
+
 /// IPC client for communicating with the Wine host
 struct WineClient {
     stream: TcpStream,
@@ -37,25 +51,31 @@ impl WineClient {
             .map_err(|e| Error::Other(format!("Failed to set read timeout: {}", e)))?;
         stream.set_write_timeout(Some(Duration::from_secs(30)))
             .map_err(|e| Error::Other(format!("Failed to set write timeout: {}", e)))?;
+        stream.set_nodelay(true)
+            .map_err(|e| Error::Other(format!("Failed to set TCP_NODELAY: {}", e)))?;
         Ok(Self { stream })
     }
 
     /// Send a command with optional payload
-    fn send_command(&mut self, cmd: HostCommand, payload: &[u8]) -> Result<()> {
+    ///
+    /// The request helpers only need `&self` (`&TcpStream` reads and
+    /// writes), so `&self` plugin methods such as `get_state` can talk to the
+    /// host too.
+    fn send_command(&self, cmd: HostCommand, payload: &[u8]) -> Result<()> {
         let header = Header::new(cmd, payload.len() as u32);
-        self.stream.write_all(&header.to_bytes())
+        (&self.stream).write_all(&header.to_bytes())
             .map_err(|e| Error::Other(format!("Failed to send header: {}", e)))?;
         if !payload.is_empty() {
-            self.stream.write_all(payload)
+            (&self.stream).write_all(payload)
                 .map_err(|e| Error::Other(format!("Failed to send payload: {}", e)))?;
         }
         Ok(())
     }
 
     /// Receive a response
-    fn recv_response(&mut self) -> Result<(ResponseHeader, Vec<u8>)> {
+    fn recv_response(&self) -> Result<(ResponseHeader, Vec<u8>)> {
         let mut header_buf = [0u8; 12];
-        self.stream.read_exact(&mut header_buf)
+        (&self.stream).read_exact(&mut header_buf)
             .map_err(|e| Error::Other(format!("Failed to read response header: {}", e)))?;
 
         let header = ResponseHeader::from_bytes(&header_buf);
@@ -65,7 +85,7 @@ impl WineClient {
 
         let mut payload = vec![0u8; header.payload_size as usize];
         if header.payload_size > 0 {
-            self.stream.read_exact(&mut payload)
+            (&self.stream).read_exact(&mut payload)
                 .map_err(|e| Error::Other(format!("Failed to read response payload: {}", e)))?;
         }
 
@@ -73,16 +93,24 @@ impl WineClient {
     }
 
     /// Send command and receive response, checking status
-    fn request(&mut self, cmd: HostCommand, payload: &[u8]) -> Result<Vec<u8>> {
+    fn request(&self, cmd: HostCommand, payload: &[u8]) -> Result<Vec<u8>> {
         self.send_command(cmd, payload)?;
         let (header, payload) = self.recv_response()?;
-        match header.status() {
-            Status::Ok => Ok(payload),
-            Status::NotLoaded => Err(Error::NotInitialized),
-            Status::NotInitialized => Err(Error::NotInitialized),
-            Status::InvalidParam => Err(Error::InvalidParameter(0)),
-            Status::Error => Err(Error::Other("Wine host returned error".to_string())),
+        check_status(header.status())?;
+        Ok(payload)
+    }
+
+    /// Run a batch of commands in one round trip
+    ///
+    /// Returns one result per entry; a failed entry does not fail the call.
+    fn batch(&mut self, batch: &CmdBatch) -> Result<Vec<BatchResult>> {
+        let payload = self.request(HostCommand::Batch, batch.as_bytes())?;
+        let results = parse_batch_response(&payload)
+            .ok_or_else(|| Error::Other("Invalid batch response".to_string()))?;
+        if results.len() != batch.len() {
+            return Err(Error::Other("Batch response entry count mismatch".to_string()));
         }
+        Ok(results)
     }
 
     /// Ping the host
@@ -122,6 +150,27 @@ impl WineClient {
             .ok_or_else(|| Error::Other("Invalid param info response".to_string()))
     }
 
+    /// Get info of every parameter, one request per run of describable
+    /// parameters (normally a single request)
+    ///
+    /// Parameters the plugin fails to describe are skipped.
+    fn get_param_info_all(&mut self) -> Result<Vec<RespParamInfo>> {
+        let mut infos = Vec::new();
+        let mut next = 0u32;
+        loop {
+            let range = CmdParamInfoRange { first: next, count: u32::MAX };
+            let payload = self.request(HostCommand::GetParamInfoAll, &range.to_bytes())?;
+            let list = RespParamInfoList::from_bytes(&payload)
+                .ok_or_else(|| Error::Other("Invalid param info list response".to_string()))?;
+            // The list stops at the first parameter without info; skip it
+            next = list.first + list.infos.len() as u32 + 1;
+            infos.extend(list.infos);
+            if next >= list.total_params {
+                return Ok(infos);
+            }
+        }
+    }
+
     /// Get parameter value
     fn get_param(&mut self, param_id: u32) -> Result<f64> {
         let cmd = CmdParam::new(param_id, 0.0);
@@ -144,8 +193,8 @@ impl WineClient {
     }
 
     /// Initialize audio
-    fn init_audio(&mut self, sample_rate: u32, block_size: u32, num_inputs: u32, num_outputs: u32, shm_name: &str) -> Result<()> {
-        let cmd = CmdInitAudio::new(sample_rate, block_size, num_inputs, num_outputs, shm_name);
+    fn init_audio(&mut self, sample_rate: u32, block_size: u32, num_inputs: u32, num_outputs: u32, shm_name: &str, pipeline_depth: u32, process_mode: u32, sample_format: u32) -> Result<()> {
+        let cmd = CmdInitAudio::new(sample_rate, block_size, num_inputs, num_outputs, shm_name, pipeline_depth, process_mode, sample_format);
         self.request(HostCommand::InitAudio, &cmd.to_bytes())?;
         Ok(())
     }
@@ -157,6 +206,78 @@ impl WineClient {
         Ok(())
     }
 
+    /// Start the host audio thread serving the shared memory doorbell
+    fn start_realtime(&mut self) -> Result<()> {
+        self.request(HostCommand::StartRealtime, &[])?;
+        Ok(())
+    }
+
+    /// Stop the host audio thread
+    fn stop_realtime(&mut self) -> Result<()> {
+        self.request(HostCommand::StopRealtime, &[])?;
+        Ok(())
+    }
+
+    /// Select the plugin slot addressed by subsequent control commands
+    fn select_slot(&mut self, slot: u32) -> Result<()> {
+        self.request(HostCommand::SelectSlot, &slot.to_le_bytes())?;
+        Ok(())
+    }
+
+    /// Set the processing chain (one bitmask of parallel slots per stage)
+    fn set_chain(&mut self, stage_masks: Vec<u32>) -> Result<()> {
+        let cmd = CmdSetChain { stage_masks };
+        self.request(HostCommand::SetChain, &cmd.to_bytes())?;
+        Ok(())
+    }
+
+    /// Enable or disable idle sleep for the selected slot
+    fn set_idle_sleep(&mut self, enabled: bool) -> Result<()> {
+        self.request(HostCommand::SetIdleSleep, &(enabled as u32).to_le_bytes())?;
+        Ok(())
+    }
+
+    /// Get the selected slot's processed/skipped block counters
+    fn get_block_counts(&mut self) -> Result<RespBlockCounts> {
+        let payload = self.request(HostCommand::GetBlockCounts, &[])?;
+        RespBlockCounts::from_bytes(&payload)
+            .ok_or_else(|| Error::Other("Invalid block counts response".to_string()))
+    }
+
+    /// Get the selected slot's processing statistics
+    fn get_stats(&mut self) -> Result<ProcessStats> {
+        let payload = self.request(HostCommand::GetStats, &[])?;
+        let resp = RespStats::from_bytes(&payload)
+            .ok_or_else(|| Error::Other("Invalid stats response".to_string()))?;
+        Ok(ProcessStats {
+            process_calls: resp.process_calls,
+            frames: resp.frames,
+            total_ns: resp.total_ns,
+            max_ns: resp.max_ns,
+            deadline_ns: resp.deadline_ns,
+            deadline_misses: resp.deadline_misses,
+            max_load: resp.max_load,
+            average_load: resp.average_load,
+            process_errors: resp.process_errors,
+            dropped_midi_events: resp.dropped_midi_events,
+            dropped_param_changes: resp.dropped_param_changes,
+            histogram: resp.histogram,
+        })
+    }
+
+    /// Zero the selected slot's processing statistics
+    fn reset_stats(&mut self) -> Result<()> {
+        self.request(HostCommand::ResetStats, &[])?;
+        Ok(())
+    }
+
+    /// Get the latency and tail of the selected slot and of the chain
+    fn get_latency(&mut self) -> Result<RespLatency> {
+        let payload = self.request(HostCommand::GetLatency, &[])?;
+        RespLatency::from_bytes(&payload)
+            .ok_or_else(|| Error::Other("Invalid latency response".to_string()))
+    }
+
     /// Send MIDI events
     fn send_midi(&mut self, events: &[protocol::MidiEvent]) -> Result<()> {
         let mut payload = Vec::with_capacity(4 + events.len() * 8);
@@ -182,11 +303,12 @@ impl WineClient {
         Ok(())
     }
 
-    /// Get parameter changes from GUI
-    fn get_param_changes(&mut self) -> Result<Vec<protocol::ParamChangeEvent>> {
+    /// Get parameter changes from GUI, plus the host's cumulative count of
+    /// dropped changes (0 from hosts that don't report it)
+    fn get_param_changes(&mut self) -> Result<(Vec<protocol::ParamChangeEvent>, u64)> {
         let payload = self.request(HostCommand::GetParamChanges, &[])?;
         if payload.len() < 4 {
-            return Ok(Vec::new());
+            return Ok((Vec::new(), 0));
         }
 
         let num_changes = u32::from_le_bytes([payload[0], payload[1], payload[2], payload[3]]) as usize;
@@ -204,16 +326,401 @@ impl WineClient {
             offset += 12;
         }
 
-        Ok(changes)
+        // Trailing u64 overflow counter
+        let overflows = payload
+            .get(offset..offset + 8)
+            .map(|b| u64::from_le_bytes(b.try_into().expect("slice is 8 bytes")))
+            .unwrap_or(0);
+
+        Ok((changes, overflows))
+    }
+
+    /// Map the shared-memory file plugin state is streamed through
+    fn set_state_region(&self, size: u64, shm_name: &str) -> Result<()> {
+        let cmd = CmdStateRegion::new(size, shm_name);
+        self.request(HostCommand::SetStateRegion, &cmd.to_bytes())?;
+        Ok(())
+    }
+
+    /// Have the host write the selected slot's state to the state region
+    ///
+    /// Returns `Ok(size)` once it fit, or `Err(needed)` with the region size
+    /// the state needs.
+    fn get_state(&self) -> Result<std::result::Result<u64, u64>> {
+        self.send_command(HostCommand::GetState, &[])?;
+        let (header, payload) = self.recv_response()?;
+        match (header.status(), parse_state_size(&payload)) {
+            (Status::Ok, Some(size)) => Ok(Ok(size)),
+            (Status::NoSpace, Some(needed)) => Ok(Err(needed)),
+            (status, _) => {
+                check_status(status)?;
+                Err(Error::Other("Invalid state response".to_string()))
+            }
+        }
     }
 
-    /// Shutdown the host
+    /// Restore the selected slot from the first `size` bytes of the state region
+    fn set_state(&self, size: u64) -> Result<()> {
+        self.request(HostCommand::SetState, &state_size_bytes(size))?;
+        Ok(())
+    }
+
+    /// End this session in the host
     fn shutdown(&mut self) -> Result<()> {
         self.request(HostCommand::Shutdown, &[])?;
         Ok(())
     }
 }
 
+/// Initial size of the state transfer region; it grows to the largest state
+/// seen
+const STATE_REGION_INITIAL_SIZE: usize = 1 << 20;
+
+/// Shared-memory file the host streams plugin state through
+/// (CMD_SET_STATE_REGION), so state never goes over the socket
+struct StateRegion {
+    path: String,
+    fd: i32,
+    ptr: *mut u8,
+    size: usize,
+}
+
+impl StateRegion {
+    #[cfg(target_os = "linux")]
+    fn create(size: usize) -> Result<Self> {
+        use std::os::unix::io::IntoRawFd;
+
+        let counter = SHM_COUNTER.fetch_add(1, Ordering::SeqCst);
+        let path = format!("/tmp/rack-wine-state-{}-{}", std::process::id(), counter);
+        let file = std::fs::OpenOptions::new()
+            .read(true)
+            .write(true)
+            .create(true)
+            .truncate(true)
+            .open(&path)
+            .map_err(|e| Error::Other(format!("Failed to create state region file: {}", e)))?;
+        if let Err(e) = file.set_len(size as u64) {
+            let _ = std::fs::remove_file(&path);
+            return Err(Error::Other(format!("Failed to set state region size: {}", e)));
+        }
+
+        let fd = file.into_raw_fd();
+        let ptr = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(),
+                size,
+                libc::PROT_READ | libc::PROT_WRITE,
+                libc::MAP_SHARED,
+                fd,
+                0,
+            )
+        };
+        if ptr == libc::MAP_FAILED {
+            unsafe {
+                libc::close(fd);
+            }
+            let _ = std::fs::remove_file(&path);
+            return Err(Error::Other("Failed to mmap state region".to_string()));
+        }
+
+        Ok(Self { path, fd, ptr: ptr as *mut u8, size })
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    fn create(_size: usize) -> Result<Self> {
+        Err(Error::Other("Wine VST3 host only supported on Linux".to_string()))
+    }
+
+    fn as_slice(&self) -> &[u8] {
+        // Safety: ptr maps `size` bytes for the region's lifetime
+        unsafe { std::slice::from_raw_parts(self.ptr, self.size) }
+    }
+
+    fn as_mut_slice(&mut self) -> &mut [u8] {
+        // Safety: as above, and &mut self makes the access exclusive
+        unsafe { std::slice::from_raw_parts_mut(self.ptr, self.size) }
+    }
+}
+
+impl Drop for StateRegion {
+    fn drop(&mut self) {
+        #[cfg(target_os = "linux")]
+        unsafe {
+            libc::munmap(self.ptr as *mut libc::c_void, self.size);
+            libc::close(self.fd);
+        }
+        let _ = std::fs::remove_file(&self.path);
+    }
+}
+
+/// How long the client waits for the host to finish a realtime block
+const DOORBELL_TIMEOUT: Duration = Duration::from_secs(2);
+
+/// View a doorbell word in the shared memory header as an atomic
+///
+/// # Safety
+/// `word` must point into a live, 4-byte aligned shared memory mapping.
+#[cfg(target_os = "linux")]
+unsafe fn shm_atomic<'a>(word: *mut u32) -> &'a AtomicU32 {
+    &*(word as *const AtomicU32)
+}
+
+/// Submit the next block on the realtime doorbell
+///
+/// Mirrors the host side in rack-wine-host: publish the block's sample count
+/// in its ring slot and the next request sequence, then wake the host if it
+/// is parked. Returns the sequence number of the submitted block.
+///
+/// # Safety
+/// `header` must point to the initialized header of a live shared memory mapping.
+#[cfg(target_os = "linux")]
+unsafe fn doorbell_submit(header: *mut ShmHeader, block_slot: usize, num_samples: u32) -> u32 {
+    let client_ready = shm_atomic(std::ptr::addr_of_mut!((*header).client_ready));
+    let host_waiting = shm_atomic(std::ptr::addr_of_mut!((*header).host_waiting));
+    let slot_samples = shm_atomic(std::ptr::addr_of_mut!((*header).slot_samples[block_slot]));
+
+    let seq = client_ready.load(Ordering::Relaxed).wrapping_add(1);
+    slot_samples.store(num_samples, Ordering::Relaxed);
+    client_ready.store(seq, Ordering::SeqCst);
+    if host_waiting.load(Ordering::SeqCst) != 0 {
+        libc::syscall(libc::SYS_futex, client_ready.as_ptr(), libc::FUTEX_WAKE, 1);
+    }
+    seq
+}
+
+/// Wait until the host has completed block `seq`
+///
+/// Spins briefly on the completion sequence before parking on it with
+/// FUTEX_WAIT (or yielding if the host cannot issue futex wakes).
+///
+/// # Safety
+/// `header` must point to the initialized header of a live shared memory mapping.
+#[cfg(target_os = "linux")]
+unsafe fn doorbell_wait(header: *mut ShmHeader, seq: u32) -> Result<()> {
+    let host_ready = shm_atomic(std::ptr::addr_of_mut!((*header).host_ready));
+    let client_waiting = shm_atomic(std::ptr::addr_of_mut!((*header).client_waiting));
+    let rt_flags = shm_atomic(std::ptr::addr_of_mut!((*header).rt_flags));
+
+    // Sequence numbers wrap; "done" means host_ready is not behind seq
+    let completed = |current: u32| (current.wrapping_sub(seq) as i32) >= 0;
+    let done = |flags: u32| -> Result<()> {
+        if flags & RACK_WINE_RT_ERROR != 0 {
+            Err(Error::Other("Wine host failed to process block".to_string()))
+        } else {
+            Ok(())
+        }
+    };
+
+    for _ in 0..RACK_WINE_RT_SPIN_COUNT {
+        if completed(host_ready.load(Ordering::Acquire)) {
+            return done(rt_flags.load(Ordering::Relaxed));
+        }
+        std::hint::spin_loop();
+    }
+
+    let deadline = Instant::now() + DOORBELL_TIMEOUT;
+    loop {
+        client_waiting.store(1, Ordering::SeqCst);
+        let current = host_ready.load(Ordering::SeqCst);
+        if !completed(current) {
+            if rt_flags.load(Ordering::Relaxed) & RACK_WINE_RT_FUTEX != 0 {
+                let timeout = libc::timespec { tv_sec: 0, tv_nsec: 1_000_000 };
+                libc::syscall(
+                    libc::SYS_futex,
+                    host_ready.as_ptr(),
+                    libc::FUTEX_WAIT,
+                    current,
+                    &timeout as *const libc::timespec,
+                );
+            } else {
+                std::thread::yield_now();
+            }
+        }
+        client_waiting.store(0, Ordering::SeqCst);
+
+        if completed(host_ready.load(Ordering::Acquire)) {
+            return done(rt_flags.load(Ordering::Relaxed));
+        }
+        if Instant::now() >= deadline {
+            return Err(Error::Other("Timed out waiting for Wine host".to_string()));
+        }
+    }
+}
+
+/// Map a host status to the client error it stands for
+fn check_status(status: Status) -> Result<()> {
+    match status {
+        Status::Ok => Ok(()),
+        Status::NotLoaded => Err(Error::NotInitialized),
+        Status::NotInitialized => Err(Error::NotInitialized),
+        Status::InvalidParam => Err(Error::InvalidParameter(0)),
+        Status::NoSpace => Err(Error::Other("Wine host shared memory region too small".to_string())),
+        Status::Error => Err(Error::Other("Wine host returned error".to_string())),
+    }
+}
+
+/// Channel-voice bytes of a MIDI event (status 0 for messages the host
+/// does not take)
+fn midi_bytes(e: &MidiEvent) -> (u8, u8, u8) {
+    match e.kind {
+        crate::MidiEventKind::NoteOn { note, velocity, channel } => {
+            (0x90 | (channel & 0x0F), note, velocity)
+        }
+        crate::MidiEventKind::NoteOff { note, velocity, channel } => {
+            (0x80 | (channel & 0x0F), note, velocity)
+        }
+        crate::MidiEventKind::ControlChange { controller, value, channel } => {
+            (0xB0 | (channel & 0x0F), controller, value)
+        }
+        crate::MidiEventKind::ProgramChange { program, channel } => {
+            (0xC0 | (channel & 0x0F), program, 0)
+        }
+        crate::MidiEventKind::PitchBend { value, channel } => {
+            let lsb = (value & 0x7F) as u8;
+            let msb = ((value >> 7) & 0x7F) as u8;
+            (0xE0 | (channel & 0x0F), lsb, msb)
+        }
+        crate::MidiEventKind::PolyphonicAftertouch { note, pressure, channel } => {
+            (0xA0 | (channel & 0x0F), note, pressure)
+        }
+        crate::MidiEventKind::ChannelAftertouch { pressure, channel } => {
+            (0xD0 | (channel & 0x0F), pressure, 0)
+        }
+        _ => (0, 0, 0), // Ignore system real-time messages
+    }
+}
+
+/// Stable in-place sort of a block's events by sample offset. Insertion
+/// sort: events are mostly queued in order, and unlike `sort_by_key` it
+/// does not allocate on the process path.
+fn sort_by_sample_offset(events: &mut [ShmEvent]) {
+    for i in 1..events.len() {
+        let event = events[i];
+        let mut j = i;
+        while j > 0 && events[j - 1].sample_offset > event.sample_offset {
+            events[j] = events[j - 1];
+            j -= 1;
+        }
+        events[j] = event;
+    }
+}
+
+/// Build the parameter ID -> index map (first index wins on duplicate IDs)
+fn build_param_index(param_ids: &[u32]) -> HashMap<u32, usize> {
+    let mut map = HashMap::with_capacity(param_ids.len());
+    for (index, &id) in param_ids.iter().enumerate() {
+        map.entry(id).or_insert(index);
+    }
+    map
+}
+
+/// A running rack-wine-host process
+///
+/// The host serves each TCP connection as an independent instance with its
+/// own slots, shared memory and audio thread, so every plugin loaded with
+/// the same executable and prefix connects to one process instead of
+/// starting Wine again. The process is killed when the last plugin using
+/// it is dropped.
+struct WineHostProcess {
+    child: Mutex<Child>,
+    port: u16,
+}
+
+impl WineHostProcess {
+    /// Start a host and wait for the port it prints on stdout
+    fn spawn(host_exe: &Path, wine_prefix: Option<&Path>) -> Result<Self> {
+        let mut cmd = Command::new("wine");
+        cmd.arg(host_exe);
+        // Sessions come and go; the process lives as long as this handle
+        cmd.arg("--persistent");
+        cmd.stdout(Stdio::piped());
+        cmd.stderr(Stdio::piped());
+
+        if let Some(prefix) = wine_prefix {
+            cmd.env("WINEPREFIX", prefix);
+        }
+
+        let mut child = cmd.spawn()
+            .map_err(|e| Error::Other(format!("Failed to spawn Wine host: {}", e)))?;
+
+        // Keep both pipes drained so host and Wine logging never blocks
+        let (port_tx, port_rx) = mpsc::channel();
+        if let Some(stdout) = child.stdout.take() {
+            std::thread::spawn(move || {
+                for line in BufReader::new(stdout).lines().map_while(|line| line.ok()) {
+                    let port = line.strip_prefix("PORT=").and_then(|p| p.trim().parse::<u16>().ok());
+                    if let Some(port) = port.filter(|p| (RACK_WINE_PORT_BASE..=RACK_WINE_PORT_MAX).contains(p)) {
+                        let _ = port_tx.send(port);
+                    }
+                }
+            });
+        }
+        if let Some(mut stderr) = child.stderr.take() {
+            std::thread::spawn(move || {
+                let _ = std::io::copy(&mut stderr, &mut std::io::sink());
+            });
+        }
+
+        match port_rx.recv_timeout(HOST_STARTUP_TIMEOUT) {
+            Ok(port) => Ok(Self { child: Mutex::new(child), port }),
+            Err(_) => {
+                let _ = child.kill();
+                let _ = child.wait();
+                Err(Error::Other("Wine host did not report a port".to_string()))
+            }
+        }
+    }
+
+    /// Open a new session (an independent instance) in this host
+    fn connect(&self) -> Result<WineClient> {
+        WineClient::connect(self.port)
+    }
+
+    fn is_running(&self) -> bool {
+        self.child.lock().map_or(false, |mut child| matches!(child.try_wait(), Ok(None)))
+    }
+}
+
+impl Drop for WineHostProcess {
+    fn drop(&mut self) {
+        if let Ok(child) = self.child.get_mut() {
+            let _ = child.kill();
+            let _ = child.wait();
+        }
+    }
+}
+
+/// Get the running host for this executable and prefix, starting one if
+/// there is none (or it has exited)
+fn shared_host_process(host_exe: &Path, wine_prefix: Option<&Path>) -> Result<Arc<WineHostProcess>> {
+    let mut hosts = HOST_PROCESSES.lock()
+        .map_err(|_| Error::Other("Wine host registry poisoned".to_string()))?;
+    hosts.retain(|(_, _, host)| host.strong_count() > 0);
+
+    let existing = hosts.iter()
+        .find(|(exe, prefix, _)| exe == host_exe && prefix.as_deref() == wine_prefix)
+        .and_then(|(_, _, host)| host.upgrade());
+    if let Some(host) = existing {
+        if host.is_running() {
+            return Ok(host);
+        }
+    }
+
+    let host = Arc::new(WineHostProcess::spawn(host_exe, wine_prefix)?);
+    hosts.retain(|(exe, prefix, _)| !(exe == host_exe && prefix.as_deref() == wine_prefix));
+    hosts.push((host_exe.to_path_buf(), wine_prefix.map(Path::to_path_buf), Arc::downgrade(&host)));
+    Ok(host)
+}
+
+/// Convert a Linux path to Wine format (Z: drive for absolute paths)
+fn to_wine_path(path: &Path) -> String {
+    if path.starts_with("/") {
+        format!("Z:{}", path.display())
+    } else {
+        path.display().to_string()
+    }
+}
+
 /// Scanner for Windows VST3 plugins via Wine
 pub struct WineVst3Scanner {
     /// Path to Wine host executable
@@ -257,33 +764,11 @@ impl WineVst3Scanner {
         }
     }
 
-    /// Spawn Wine host and connect
-    fn spawn_host(&self) -> Result<(Child, WineClient)> {
-        // Build wine command
-        let mut cmd = Command::new("wine");
-        cmd.arg(&self.host_exe);
-        cmd.stdout(Stdio::piped());
-        cmd.stderr(Stdio::piped());
-
-        if let Some(ref prefix) = self.wine_prefix {
-            cmd.env("WINEPREFIX", prefix);
-        }
-
-        // Spawn the host
-        let child = cmd.spawn()
-            .map_err(|e| Error::Other(format!("Failed to spawn Wine host: {}", e)))?;
-
-        // Wait a bit for the host to start
-        std::thread::sleep(Duration::from_millis(2000));
-
-        // Try to connect to ports in range
-        for port in RACK_WINE_PORT_BASE..=RACK_WINE_PORT_MAX {
-            if let Ok(client) = WineClient::connect(port) {
-                return Ok((child, client));
-            }
-        }
-
-        Err(Error::Other("Failed to connect to Wine host".to_string()))
+    /// Connect to the shared Wine host, starting it if needed
+    fn spawn_host(&self) -> Result<(Arc<WineHostProcess>, WineClient)> {
+        let host = shared_host_process(&self.host_exe, self.wine_prefix.as_deref())?;
+        let client = host.connect()?;
+        Ok((host, client))
     }
 }
 
@@ -343,14 +828,19 @@ impl PluginScanner for WineVst3Scanner {
 
 /// A Windows VST3 plugin loaded via Wine
 pub struct WineVst3Plugin {
-    /// Wine host process
-    _host_process: Child,
+    /// Wine host process, shared with other plugins; this plugin is one
+    /// session (connection) in it
+    _host: Arc<WineHostProcess>,
     /// IPC client
     client: WineClient,
     /// Plugin info
     info: PluginInfo,
+    /// Parameter info as reported by the host (indexed by parameter index)
+    param_infos: Vec<RespParamInfo>,
     /// Parameter IDs (indexed by parameter index)
     param_ids: Vec<u32>,
+    /// Parameter ID -> index (inverse of `param_ids`)
+    param_index: HashMap<u32, usize>,
     /// Shared memory path
     shm_path: Option<String>,
     /// Shared memory file descriptor (Linux side)
@@ -367,6 +857,110 @@ pub struct WineVst3Plugin {
     num_outputs: usize,
     /// Initialized flag
     initialized: bool,
+    /// Blocks are handed over via the shared memory doorbell instead of TCP
+    realtime: bool,
+    /// Bitmask of occupied plugin slots in the host (slot 0 is this plugin)
+    loaded_slots: u32,
+    /// Block slots in the shared memory ring (1 = synchronous)
+    pipeline_depth: usize,
+    /// Report kOffline instead of kRealtime to the plugin
+    offline: bool,
+    /// Shared memory sample format (`RACK_WINE_SAMPLE_*`)
+    sample_format: u32,
+    /// Blocks submitted so far in pipelined mode
+    blocks_submitted: u64,
+    /// In-band events for the next blocks in the order they were queued,
+    /// at most `RACK_WINE_MAX_BLOCK_EVENTS` (capacity reserved by
+    /// `initialize`, so queueing never allocates)
+    pending_events: Vec<ShmEvent>,
+    /// MIDI events dropped because `pending_events` was full (added to the
+    /// host's count in `stats`)
+    dropped_midi_events: u64,
+    /// GUI parameter changes the host has dropped (as of the last poll)
+    param_change_overflows: u64,
+    /// State transfer region, created on first use (`get_state` only has
+    /// `&self`, hence the RefCell)
+    state_region: RefCell<Option<StateRegion>>,
+}
+
+/// Sample types `process`/`process_f64` accept; copies to and from the
+/// shared memory convert when its format differs
+trait ShmSample: Copy {
+    const ZERO: Self;
+    fn to_f32(self) -> f32;
+    fn to_f64(self) -> f64;
+    fn from_f32(value: f32) -> Self;
+    fn from_f64(value: f64) -> Self;
+
+    /// Write `src` to the shm channel at `dst`
+    ///
+    /// # Safety
+    ///
+    /// `dst` must point to a channel of at least `src.len()` samples in `format`
+    unsafe fn store(src: &[Self], dst: *mut u8, format: u32) {
+        if format == RACK_WINE_SAMPLE_F64 {
+            let dst = std::slice::from_raw_parts_mut(dst as *mut f64, src.len());
+            for (d, s) in dst.iter_mut().zip(src) {
+                *d = s.to_f64();
+            }
+        } else {
+            let dst = std::slice::from_raw_parts_mut(dst as *mut f32, src.len());
+            for (d, s) in dst.iter_mut().zip(src) {
+                *d = s.to_f32();
+            }
+        }
+    }
+
+    /// Read the shm channel at `src` into `dst`
+    ///
+    /// # Safety
+    ///
+    /// `src` must point to a channel of at least `dst.len()` samples in `format`
+    unsafe fn load(src: *const u8, dst: &mut [Self], format: u32) {
+        if format == RACK_WINE_SAMPLE_F64 {
+            let src = std::slice::from_raw_parts(src as *const f64, dst.len());
+            for (d, s) in dst.iter_mut().zip(src) {
+                *d = Self::from_f64(*s);
+            }
+        } else {
+            let src = std::slice::from_raw_parts(src as *const f32, dst.len());
+            for (d, s) in dst.iter_mut().zip(src) {
+                *d = Self::from_f32(*s);
+            }
+        }
+    }
+}
+
+impl ShmSample for f32 {
+    const ZERO: Self = 0.0;
+    fn to_f32(self) -> f32 {
+        self
+    }
+    fn to_f64(self) -> f64 {
+        self as f64
+    }
+    fn from_f32(value: f32) -> Self {
+        value
+    }
+    fn from_f64(value: f64) -> Self {
+        value as f32
+    }
+}
+
+impl ShmSample for f64 {
+    const ZERO: Self = 0.0;
+    fn to_f32(self) -> f32 {
+        self as f32
+    }
+    fn to_f64(self) -> f64 {
+        self
+    }
+    fn from_f32(value: f32) -> Self {
+        value as f64
+    }
+    fn from_f64(value: f64) -> Self {
+        value
+    }
 }
 
 // Safety: WineVst3Plugin is Send because:
@@ -378,57 +972,23 @@ unsafe impl Send for WineVst3Plugin {}
 impl WineVst3Plugin {
     /// Create a new Wine VST3 plugin instance
     pub fn new(host_exe: &Path, plugin_path: &Path, wine_prefix: Option<&Path>) -> Result<Self> {
-        // Build wine command
-        let mut cmd = Command::new("wine");
-        cmd.arg(host_exe);
-        cmd.stdout(Stdio::piped());
-        cmd.stderr(Stdio::piped());
-
-        if let Some(prefix) = wine_prefix {
-            cmd.env("WINEPREFIX", prefix);
-        }
-
-        // Spawn the host
-        let host_process = cmd.spawn()
-            .map_err(|e| Error::Other(format!("Failed to spawn Wine host: {}", e)))?;
-
-        // Wait for host to start
-        std::thread::sleep(Duration::from_millis(2000));
-
-        // Connect to host
-        let mut client = None;
-        for port in RACK_WINE_PORT_BASE..=RACK_WINE_PORT_MAX {
-            if let Ok(c) = WineClient::connect(port) {
-                client = Some(c);
-                break;
-            }
-        }
-        let mut client = client.ok_or_else(|| Error::Other("Failed to connect to Wine host".to_string()))?;
+        // Each plugin gets its own session in the shared host process
+        let host = shared_host_process(host_exe, wine_prefix)?;
+        let mut client = host.connect()?;
 
         // Ping to verify connection
         client.ping()?;
 
-        // Convert path to Wine format (Z: drive for Linux paths)
-        let wine_path = if plugin_path.starts_with("/") {
-            format!("Z:{}", plugin_path.display())
-        } else {
-            plugin_path.display().to_string()
-        };
-
-        // Load the plugin
-        client.load_plugin(&wine_path, 0)?;
+        // Load the plugin (slot 0)
+        client.load_plugin(&to_wine_path(plugin_path), 0)?;
 
         // Get plugin info
         let host_info = client.get_info()?;
 
-        // Get parameter IDs
-        let param_count = host_info.num_params;
-        let mut param_ids = Vec::with_capacity(param_count as usize);
-        for i in 0..param_count {
-            if let Ok(info) = client.get_param_info(i) {
-                param_ids.push(info.id);
-            }
-        }
+        // Get parameter info in one round trip
+        let param_infos = client.get_param_info_all()?;
+        let param_ids: Vec<u32> = param_infos.iter().map(|info| info.id).collect();
+        let param_index = build_param_index(&param_ids);
 
         let info = PluginInfo {
             name: host_info.name,
@@ -440,10 +1000,12 @@ impl WineVst3Plugin {
         };
 
         Ok(Self {
-            _host_process: host_process,
+            _host: host,
             client,
             info,
+            param_infos,
             param_ids,
+            param_index,
             shm_path: None,
             #[cfg(target_os = "linux")]
             shm_fd: None,
@@ -454,9 +1016,282 @@ impl WineVst3Plugin {
             num_inputs: host_info.num_audio_inputs as usize,
             num_outputs: host_info.num_audio_outputs as usize,
             initialized: false,
+            realtime: false,
+            loaded_slots: 1,
+            pipeline_depth: 1,
+            offline: false,
+            sample_format: RACK_WINE_SAMPLE_F32,
+            blocks_submitted: 0,
+            pending_events: Vec::new(),
+            dropped_midi_events: 0,
+            param_change_overflows: 0,
+            state_region: RefCell::new(None),
         })
     }
 
+    /// Load another plugin into the same Wine host process
+    ///
+    /// The plugin goes into the next free slot and, until `set_chain` is
+    /// called, runs after the existing slots in series. The whole chain is
+    /// processed with a single handoff per block. Returns the slot index.
+    pub fn add_chain_plugin(&mut self, plugin_path: &Path) -> Result<u32> {
+        let slot = (0..RACK_WINE_MAX_SLOTS as u32)
+            .find(|s| self.loaded_slots & (1 << s) == 0)
+            .ok_or_else(|| Error::Other("No free plugin slot in Wine host".to_string()))?;
+
+        self.client.select_slot(slot)?;
+        let result = self.client.load_plugin(&to_wine_path(plugin_path), 0);
+        self.client.select_slot(0)?;
+        result?;
+
+        self.loaded_slots |= 1 << slot;
+        Ok(slot)
+    }
+
+    /// Set the processing graph over plugin slots
+    ///
+    /// Each entry in `stages` is a set of slots that process the previous
+    /// stage's output in parallel; their outputs are summed. Stages run in
+    /// order, e.g. `&[&[0], &[1, 2], &[3]]`. Intermediate buffers stay in the
+    /// host process.
+    pub fn set_chain(&mut self, stages: &[&[u32]]) -> Result<()> {
+        if stages.len() > RACK_WINE_MAX_SLOTS {
+            return Err(Error::Other("Too many chain stages".to_string()));
+        }
+        let mut masks = Vec::with_capacity(stages.len());
+        for stage in stages {
+            let mut mask = 0u32;
+            for &slot in stage.iter() {
+                if slot as usize >= RACK_WINE_MAX_SLOTS || self.loaded_slots & (1 << slot) == 0 {
+                    return Err(Error::Other(format!("Plugin slot {} is not loaded", slot)));
+                }
+                mask |= 1 << slot;
+            }
+            masks.push(mask);
+        }
+        self.client.set_chain(masks)
+    }
+
+    /// Set a parameter (by native ID) on a chained plugin slot
+    pub fn set_slot_parameter(&mut self, slot: u32, param_id: u32, value: f64) -> Result<()> {
+        if slot as usize >= RACK_WINE_MAX_SLOTS || self.loaded_slots & (1 << slot) == 0 {
+            return Err(Error::Other(format!("Plugin slot {} is not loaded", slot)));
+        }
+        self.client.select_slot(slot)?;
+        let result = self.client.set_param(param_id, value);
+        self.client.select_slot(0)?;
+        result
+    }
+
+    /// Set parameters (by native ID) on a chained plugin slot in one round trip
+    pub fn set_slot_parameters(&mut self, slot: u32, values: &[(u32, f64)]) -> Result<()> {
+        if slot as usize >= RACK_WINE_MAX_SLOTS || self.loaded_slots & (1 << slot) == 0 {
+            return Err(Error::Other(format!("Plugin slot {} is not loaded", slot)));
+        }
+        let mut batch = CmdBatch::new();
+        batch.push(HostCommand::SelectSlot, &slot.to_le_bytes());
+        for &(param_id, value) in values {
+            batch.push(HostCommand::SetParam, &CmdParam::new(param_id, value).to_bytes());
+        }
+        batch.push(HostCommand::SelectSlot, &0u32.to_le_bytes());
+        let results = self.client.batch(&batch)?;
+        results.iter().try_for_each(|r| check_status(r.status))
+    }
+
+    /// Set many parameters (by index) in one round trip
+    ///
+    /// Every value is sent even if some fail; the first failure is returned.
+    /// Use this instead of repeated `set_parameter` calls when restoring a
+    /// session or preset.
+    pub fn set_parameters(&mut self, values: &[(usize, f32)]) -> Result<()> {
+        let mut batch = CmdBatch::new();
+        for &(index, value) in values {
+            let param_id = *self.param_ids.get(index).ok_or(Error::InvalidParameter(index))?;
+            batch.push(HostCommand::SetParam, &CmdParam::new(param_id, value as f64).to_bytes());
+        }
+        if batch.is_empty() {
+            return Ok(());
+        }
+        let results = self.client.batch(&batch)?;
+        for (result, &(index, _)) in results.iter().zip(values) {
+            check_status(result.status).map_err(|e| match e {
+                Error::InvalidParameter(_) => Error::InvalidParameter(index),
+                e => e,
+            })?;
+        }
+        Ok(())
+    }
+
+    /// Read every parameter value (by index) in one round trip
+    pub fn parameter_values(&mut self) -> Result<Vec<f32>> {
+        let mut batch = CmdBatch::new();
+        for &param_id in &self.param_ids {
+            batch.push(HostCommand::GetParam, &param_id.to_le_bytes());
+        }
+        if batch.is_empty() {
+            return Ok(Vec::new());
+        }
+        let results = self.client.batch(&batch)?;
+        results
+            .iter()
+            .enumerate()
+            .map(|(index, result)| {
+                check_status(result.status)?;
+                // CmdParam response: param_id, then the normalized value
+                result.payload.get(4..12)
+                    .map(|v| f64::from_le_bytes(v.try_into().unwrap()) as f32)
+                    .ok_or(Error::InvalidParameter(index))
+            })
+            .collect()
+    }
+
+    /// Let the host skip plugins that have gone idle
+    ///
+    /// Silent input channels are always flagged to the plugin. With idle
+    /// sleep on, a slot whose input has been silent (with no MIDI) for longer
+    /// than its reported tail plus latency, and whose last output was silent,
+    /// is not processed; its output is zero-filled until input or MIDI
+    /// arrives. Off by default. Applies to every loaded slot.
+    pub fn set_idle_sleep(&mut self, enabled: bool) -> Result<()> {
+        for slot in (0..RACK_WINE_MAX_SLOTS as u32).filter(|s| self.loaded_slots & (1 << s) != 0) {
+            self.client.select_slot(slot)?;
+            let result = self.client.set_idle_sleep(enabled);
+            if result.is_err() {
+                self.client.select_slot(0)?;
+                return result;
+            }
+        }
+        self.client.select_slot(0)
+    }
+
+    /// Blocks a plugin slot processed and skipped while asleep
+    pub fn slot_block_counts(&mut self, slot: u32) -> Result<(u64, u64)> {
+        if slot as usize >= RACK_WINE_MAX_SLOTS || self.loaded_slots & (1 << slot) == 0 {
+            return Err(Error::Other(format!("Plugin slot {} is not loaded", slot)));
+        }
+        self.client.select_slot(slot)?;
+        let result = self.client.get_block_counts();
+        self.client.select_slot(0)?;
+        let counts = result?;
+        Ok((counts.processed_blocks, counts.skipped_blocks))
+    }
+
+    /// Processing statistics of a plugin slot, measured inside the host
+    pub fn slot_stats(&mut self, slot: u32) -> Result<ProcessStats> {
+        if slot as usize >= RACK_WINE_MAX_SLOTS || self.loaded_slots & (1 << slot) == 0 {
+            return Err(Error::Other(format!("Plugin slot {} is not loaded", slot)));
+        }
+        self.client.select_slot(slot)?;
+        let result = self.client.get_stats();
+        self.client.select_slot(0)?;
+        result
+    }
+
+    /// Enable pipelined processing with a ring of `depth` block slots
+    ///
+    /// Must be called before `initialize`. With depth N > 1, `process` hands
+    /// block k to the host and returns the output of block k - (N - 1), so the
+    /// plugin runs while the caller prepares the next block. This trades a
+    /// fixed latency of N - 1 blocks (see `latency_samples`) for not blocking
+    /// on the plugin's `process()`. Depth 1 is the default synchronous mode.
+    /// Pipelined mode expects every call to use `max_block_size` frames.
+    pub fn set_pipeline_depth(&mut self, depth: usize) -> Result<()> {
+        if self.initialized {
+            return Err(Error::Other("Pipeline depth must be set before initialize".to_string()));
+        }
+        if depth == 0 || depth > RACK_WINE_MAX_PIPELINE_DEPTH {
+            return Err(Error::Other(format!(
+                "Pipeline depth must be between 1 and {}",
+                RACK_WINE_MAX_PIPELINE_DEPTH
+            )));
+        }
+        self.pipeline_depth = depth;
+        Ok(())
+    }
+
+    /// Render in offline mode (VST3 `kOffline`)
+    ///
+    /// Must be called before `initialize`. Lets the plugin switch to its
+    /// non-realtime, higher-quality processing for bounces.
+    pub fn set_offline_mode(&mut self, offline: bool) -> Result<()> {
+        if self.initialized {
+            return Err(Error::Other("Offline mode must be set before initialize".to_string()));
+        }
+        self.offline = offline;
+        Ok(())
+    }
+
+    /// Carry 64-bit samples through shared memory
+    ///
+    /// Must be called before `initialize`. The host then sets plugins that
+    /// support it up for 64-bit processing and converts for the others, so
+    /// [`process_f64`](Self::process_f64) never converts on this side.
+    /// `process` still works, converting `f32` while copying.
+    pub fn set_double_precision(&mut self, enabled: bool) -> Result<()> {
+        if self.initialized {
+            return Err(Error::Other("Double precision must be set before initialize".to_string()));
+        }
+        self.sample_format = if enabled { RACK_WINE_SAMPLE_F64 } else { RACK_WINE_SAMPLE_F32 };
+        Ok(())
+    }
+
+    /// Process double-precision planar buffers of any length
+    ///
+    /// Same rules as `process`. Without
+    /// [`set_double_precision`](Self::set_double_precision) the samples are
+    /// converted to `f32` for the shared memory.
+    pub fn process_f64(
+        &mut self,
+        inputs: &[&[f64]],
+        outputs: &mut [&mut [f64]],
+        num_frames: usize,
+    ) -> Result<()> {
+        self.process_frames(inputs, outputs, num_frames)
+    }
+
+    /// Render buffers of any length
+    ///
+    /// Splits the buffers into `max_block_size` chunks and processes them in
+    /// order. Requires synchronous mode (pipeline depth 1), since pipelined
+    /// output lags its input.
+    pub fn render_offline(
+        &mut self,
+        inputs: &[&[f32]],
+        outputs: &mut [&mut [f32]],
+        num_frames: usize,
+    ) -> Result<()> {
+        if !self.initialized {
+            return Err(Error::NotInitialized);
+        }
+        if self.pipeline_depth > 1 {
+            return Err(Error::Other("render_offline requires pipeline depth 1".to_string()));
+        }
+        if inputs.iter().any(|ch| ch.len() < num_frames) || outputs.iter().any(|ch| ch.len() < num_frames) {
+            return Err(Error::Other(format!("Channel buffers must hold at least {} samples", num_frames)));
+        }
+
+        // process() splits the buffers into blocks
+        self.process(inputs, outputs, num_frames)
+    }
+
+    /// Latency added by the Wine bridge, in samples
+    ///
+    /// Zero in synchronous mode; `(depth - 1) * max_block_size` when
+    /// pipelined. Report this to the host for latency compensation.
+    pub fn latency_samples(&self) -> usize {
+        (self.pipeline_depth - 1) * self.block_size
+    }
+
+    /// Latency and tail of the plugin itself, without the block ring delay
+    /// included by [`latency_info`](PluginInstance::latency_info)
+    pub fn plugin_latency(&mut self) -> Result<LatencyInfo> {
+        if !self.initialized {
+            return Err(Error::NotInitialized);
+        }
+        let resp = self.client.get_latency()?;
+        Ok(LatencyInfo::new(resp.latency_samples, resp.tail_samples))
+    }
+
     /// Open the plugin editor
     pub fn open_editor(&mut self) -> Result<(u32, u32, u32)> {
         let info = self.client.open_editor()?;
@@ -473,11 +1308,221 @@ impl WineVst3Plugin {
     /// Returns a list of (param_id, value) tuples for parameters that were
     /// changed by the user in the plugin GUI. Call this regularly (e.g., every
     /// audio buffer or on a timer) to stay in sync with GUI changes.
+    ///
+    /// Each parameter appears at most once, with its latest value.
     pub fn get_param_changes(&mut self) -> Result<Vec<(u32, f64)>> {
-        let changes = self.client.get_param_changes()?;
+        let (changes, overflows) = self.client.get_param_changes()?;
+        self.param_change_overflows = overflows;
         Ok(changes.into_iter().map(|c| (c.param_id, c.value)).collect())
     }
 
+    /// Number of GUI parameter changes the host has dropped so far
+    ///
+    /// Updated on each `get_param_changes`/`get_param_index_changes` poll.
+    /// Non-zero means more distinct parameters changed between polls than
+    /// the host's queue holds; poll more often.
+    pub fn param_change_overflows(&self) -> u64 {
+        self.param_change_overflows
+    }
+
+    /// Get parameter changes from GUI since last poll, by parameter index
+    ///
+    /// Like `get_param_changes`, but IDs are mapped to the indices used by
+    /// `set_parameter`/`parameter_info`. Changes for IDs outside the
+    /// parameter list are skipped.
+    pub fn get_param_index_changes(&mut self) -> Result<Vec<(usize, f64)>> {
+        let (changes, overflows) = self.client.get_param_changes()?;
+        self.param_change_overflows = overflows;
+        Ok(changes
+            .into_iter()
+            .filter_map(|c| self.param_index.get(&c.param_id).map(|&i| (i, c.value)))
+            .collect())
+    }
+
+    /// Map a native VST3 parameter ID to its parameter index
+    pub fn param_index_for_id(&self, param_id: u32) -> Option<usize> {
+        self.param_index.get(&param_id).copied()
+    }
+
+    /// Process one block of at most `block_size` frames through shared memory
+    fn process_block<S: ShmSample>(
+        &mut self,
+        inputs: &[&[S]],
+        outputs: &mut [&mut [S]],
+        num_frames: usize,
+    ) -> Result<()> {
+        let shm_ptr = self.shm_ptr.ok_or(Error::NotInitialized)?;
+
+        // Read header to get offsets
+        let header = unsafe { &*(shm_ptr as *const ShmHeader) };
+        let input_offset = header.input_offset as usize;
+        let output_offset = header.output_offset as usize;
+        let block_size = header.block_size as usize;
+        let slot_stride = header.slot_stride as usize;
+        let channel_bytes = block_size * sample_format_bytes(self.sample_format);
+
+        if num_frames > block_size {
+            return Err(Error::Other(format!(
+                "Block of {} frames exceeds max block size {}",
+                num_frames, block_size
+            )));
+        }
+
+        // Pipelined mode: block n goes into ring slot n % depth, and the
+        // output we hand back is block n - (depth - 1)
+        let depth = self.pipeline_depth as u64;
+        let block_index = self.blocks_submitted;
+        let input_slot = (block_index % depth) as usize;
+
+        // Copy input data to shared memory
+        for (ch, input) in inputs.iter().enumerate() {
+            if ch < self.num_inputs {
+                let dest_offset = input_offset + input_slot * slot_stride + ch * channel_bytes;
+                let copy_len = num_frames.min(input.len());
+                unsafe { S::store(&input[..copy_len], shm_ptr.add(dest_offset), self.sample_format) };
+            }
+        }
+
+        // Events for this block travel with its input
+        unsafe { self.write_block_events(shm_ptr, input_slot, num_frames as u32) };
+
+        // Process
+        #[cfg(target_os = "linux")]
+        let output_slot = if self.realtime {
+            let header_ptr = shm_ptr as *mut ShmHeader;
+            let seq = unsafe { doorbell_submit(header_ptr, input_slot, num_frames as u32) };
+            self.blocks_submitted += 1;
+
+            if block_index < depth - 1 {
+                // Still filling the pipeline: nothing has come out yet
+                None
+            } else {
+                let lag = (depth - 1) as u32;
+                unsafe { doorbell_wait(header_ptr, seq.wrapping_sub(lag))? };
+                Some(((block_index - (depth - 1)) % depth) as usize)
+            }
+        } else {
+            self.client.process_audio(num_frames as u32)?;
+            Some(0)
+        };
+        #[cfg(not(target_os = "linux"))]
+        let output_slot = {
+            self.client.process_audio(num_frames as u32)?;
+            Some(0)
+        };
+
+        // Copy output data from shared memory
+        for (ch, output) in outputs.iter_mut().enumerate() {
+            if ch < self.num_outputs {
+                let copy_len = num_frames.min(output.len());
+                let Some(slot) = output_slot else {
+                    output[..copy_len].fill(S::ZERO);
+                    continue;
+                };
+                let src_offset = output_offset + slot * slot_stride + ch * channel_bytes;
+                unsafe { S::load(shm_ptr.add(src_offset), &mut output[..copy_len], self.sample_format) };
+            }
+        }
+
+        Ok(())
+    }
+
+    /// Move the pending events that fall into the next `num_frames` frames
+    /// into the event area of block slot `slot`, ordered by sample offset,
+    /// and rebase the rest onto the following block. The pending queue never
+    /// holds more than a block's worth of events, so they all fit.
+    ///
+    /// # Safety
+    /// `shm_ptr` must be the mapping set up by `setup_shared_memory`.
+    unsafe fn write_block_events(&mut self, shm_ptr: *mut u8, slot: usize, num_frames: u32) {
+        let header = &*(shm_ptr as *const ShmHeader);
+        let block = shm_ptr.add(header.events_offset as usize + slot * ShmEventBlock::SIZE) as *mut ShmEventBlock;
+        let events = std::slice::from_raw_parts_mut(
+            std::ptr::addr_of_mut!((*block).events) as *mut ShmEvent,
+            RACK_WINE_MAX_BLOCK_EVENTS,
+        );
+
+        let mut count = 0;
+        for event in self.pending_events.iter().filter(|e| e.sample_offset < num_frames) {
+            events[count] = *event;
+            count += 1;
+        }
+        sort_by_sample_offset(&mut events[..count]);
+        (*block).num_events = count as u32;
+
+        self.pending_events.retain_mut(|event| {
+            if event.sample_offset < num_frames {
+                return false;
+            }
+            event.sample_offset -= num_frames;
+            true
+        });
+    }
+
+    /// Queue an in-band event; false if a block's worth of events is
+    /// already pending
+    fn queue_event(&mut self, event: ShmEvent) -> bool {
+        if self.pending_events.len() >= RACK_WINE_MAX_BLOCK_EVENTS {
+            return false;
+        }
+        self.pending_events.push(event);
+        true
+    }
+
+    /// Automate a parameter (by index) at a frame of the next `process` call
+    ///
+    /// The value travels in shared memory with the audio and reaches the
+    /// plugin's processor at `sample_offset`; the host then passes it on to
+    /// the edit controller. Offsets past the end of the call carry over to
+    /// later calls.
+    pub fn queue_parameter(&mut self, index: usize, value: f32, sample_offset: u32) -> Result<()> {
+        if !self.initialized {
+            return Err(Error::NotInitialized);
+        }
+        let param_id = *self.param_ids.get(index).ok_or(Error::InvalidParameter(index))?;
+        if !self.queue_event(ShmEvent::param(0, sample_offset, param_id, value as f64)) {
+            return Err(Error::Other("In-band event queue is full".to_string()));
+        }
+        Ok(())
+    }
+
+    /// Process buffers of any length, one shared-memory block at a time
+    fn process_frames<S: ShmSample>(
+        &mut self,
+        inputs: &[&[S]],
+        outputs: &mut [&mut [S]],
+        num_frames: usize,
+    ) -> Result<()> {
+        if !self.initialized {
+            return Err(Error::NotInitialized);
+        }
+        if num_frames <= self.block_size {
+            return self.process_block(inputs, outputs, num_frames);
+        }
+        if inputs.iter().any(|ch| ch.len() < num_frames) || outputs.iter().any(|ch| ch.len() < num_frames) {
+            return Err(Error::Other(format!("Channel buffers must hold at least {} samples", num_frames)));
+        }
+
+        // Events queued past the end of a block are rebased onto the next
+        // one (write_block_events; the host does the same for CMD_SEND_MIDI)
+        let mut position = 0;
+        while position < num_frames {
+            let frames = (num_frames - position).min(self.block_size);
+            let chunk_inputs: SmallVec<[&[S]; 8]> = inputs
+                .iter()
+                .map(|ch| &ch[position..position + frames])
+                .collect();
+            let mut chunk_outputs: SmallVec<[&mut [S]; 8]> = outputs
+                .iter_mut()
+                .map(|ch| &mut ch[position..position + frames])
+                .collect();
+            self.process_block(&chunk_inputs, &mut chunk_outputs, frames)?;
+            position += frames;
+        }
+
+        Ok(())
+    }
+
     #[cfg(target_os = "linux")]
     fn setup_shared_memory(&mut self, block_size: usize, num_inputs: usize, num_outputs: usize) -> Result<String> {
         use std::os::unix::io::AsRawFd;
@@ -489,8 +1534,10 @@ impl WineVst3Plugin {
 
         // Calculate size
         let header_size = ShmHeader::SIZE;
-        let buffer_size = (num_inputs + num_outputs) * block_size * std::mem::size_of::<f32>();
-        let total_size = header_size + buffer_size;
+        let sample_bytes = sample_format_bytes(self.sample_format);
+        let slot_stride = (num_inputs + num_outputs) * block_size * sample_bytes;
+        let events_offset = shm_events_offset(header_size + slot_stride * self.pipeline_depth);
+        let total_size = events_offset + ShmEventBlock::SIZE * self.pipeline_depth;
 
         // Create and map shared memory using a regular file
         let file = std::fs::OpenOptions::new()
@@ -532,7 +1579,17 @@ impl WineVst3Plugin {
             (*header).host_ready = 0;
             (*header).client_ready = 0;
             (*header).input_offset = header_size as u32;
-            (*header).output_offset = (header_size + num_inputs * block_size * std::mem::size_of::<f32>()) as u32;
+            (*header).output_offset = (header_size + num_inputs * block_size * sample_bytes) as u32;
+            (*header).rt_flags = 0;
+            (*header).host_waiting = 0;
+            (*header).client_waiting = 0;
+            (*header).pipeline_depth = self.pipeline_depth as u32;
+            (*header).slot_stride = slot_stride as u32;
+            (*header).slot_samples = [0; RACK_WINE_MAX_PIPELINE_DEPTH];
+            (*header).sample_format = self.sample_format;
+            (*header).latency_generation = 0;
+            (*header).events_offset = events_offset as u32;
+            (*header).reserved = [0; 2];
         }
 
         self.shm_fd = Some(file.as_raw_fd());
@@ -546,6 +1603,71 @@ impl WineVst3Plugin {
         Ok(shm_name)
     }
 
+    /// Get the state region, replacing it with a larger one (and pointing the
+    /// host at it) when it holds fewer than `size` bytes
+    fn state_region(&self, size: usize) -> Result<RefMut<'_, StateRegion>> {
+        let mut region = self.state_region.borrow_mut();
+        if region.as_ref().map_or(true, |r| r.size < size) {
+            if size as u64 > RACK_WINE_MAX_STATE_REGION {
+                return Err(Error::Other(format!("Plugin state of {} bytes is too large", size)));
+            }
+            let capacity = size
+                .max(STATE_REGION_INITIAL_SIZE)
+                .checked_next_power_of_two()
+                .map_or(size, |c| c.min(RACK_WINE_MAX_STATE_REGION as usize).max(size));
+            let new_region = StateRegion::create(capacity)?;
+            self.client.set_state_region(capacity as u64, &format!("Z:{}", new_region.path))?;
+            // The host has switched; the old region can go
+            *region = Some(new_region);
+        }
+        Ok(RefMut::map(region, |r| r.as_mut().expect("state region was just created")))
+    }
+
+    /// Serialize the plugin state into `out`, reusing its allocation
+    ///
+    /// The host streams the state into the shared state region; only sizes
+    /// cross the socket. The region grows to fit the largest state seen.
+    pub fn get_state_into(&self, out: &mut Vec<u8>) -> Result<()> {
+        let mut needed = STATE_REGION_INITIAL_SIZE;
+        // The state can grow between the attempt that measured it and the
+        // next one; give up if it keeps doing so
+        for _ in 0..3 {
+            let region = self.state_region(needed)?;
+            match self.client.get_state()? {
+                Ok(size) => {
+                    let state = region.as_slice().get(..size as usize)
+                        .ok_or_else(|| Error::Other("Invalid state size from Wine host".to_string()))?;
+                    out.clear();
+                    out.extend_from_slice(state);
+                    return Ok(());
+                }
+                Err(required) => needed = required as usize,
+            }
+        }
+        Err(Error::Other("Plugin state kept growing while being saved".to_string()))
+    }
+
+    /// Unmap and remove the shared memory of the current configuration
+    fn release_shared_memory(&mut self) {
+        #[cfg(target_os = "linux")]
+        {
+            if let Some(ptr) = self.shm_ptr.take() {
+                unsafe {
+                    libc::munmap(ptr as *mut libc::c_void, self.shm_size);
+                }
+            }
+            if let Some(fd) = self.shm_fd.take() {
+                unsafe {
+                    libc::close(fd);
+                }
+            }
+            if let Some(path) = self.shm_path.take() {
+                let _ = std::fs::remove_file(path);
+            }
+        }
+        self.shm_size = 0;
+    }
+
     #[cfg(not(target_os = "linux"))]
     fn setup_shared_memory(&mut self, _block_size: usize, _num_inputs: usize, _num_outputs: usize) -> Result<String> {
         Err(Error::Other("Wine VST3 host only supported on Linux".to_string()))
@@ -555,20 +1677,12 @@ impl WineVst3Plugin {
 impl Drop for WineVst3Plugin {
     fn drop(&mut self) {
         // Try to shutdown gracefully
-        let _ = self.client.shutdown();
-
-        // Cleanup shared memory
-        #[cfg(target_os = "linux")]
-        if let Some(ptr) = self.shm_ptr {
-            unsafe {
-                libc::munmap(ptr as *mut libc::c_void, self.shm_size);
-            }
+        if self.realtime {
+            let _ = self.client.stop_realtime();
         }
+        let _ = self.client.shutdown();
 
-        #[cfg(target_os = "linux")]
-        if let Some(path) = &self.shm_path {
-            let _ = std::fs::remove_file(path);
-        }
+        self.release_shared_memory();
     }
 }
 
@@ -577,6 +1691,12 @@ impl PluginInstance for WineVst3Plugin {
         self.sample_rate = sample_rate;
         self.block_size = max_block_size;
 
+        // Re-initializing swaps in shared memory sized for the new
+        // configuration and the host remaps it without reloading the
+        // plugins. Its own view of the old file stays valid until then.
+        self.initialized = false;
+        self.release_shared_memory();
+
         // Setup shared memory
         let shm_name = self.setup_shared_memory(max_block_size, self.num_inputs, self.num_outputs)?;
 
@@ -590,8 +1710,26 @@ impl PluginInstance for WineVst3Plugin {
             self.num_inputs as u32,
             self.num_outputs as u32,
             &wine_shm_name,
+            self.pipeline_depth as u32,
+            if self.offline { 2 } else { 0 },
+            self.sample_format,
         )?;
 
+        // Prefer the shared memory doorbell; older hosts without it still
+        // work through CMD_PROCESS_AUDIO
+        self.realtime = cfg!(target_os = "linux")
+            && self.client.start_realtime().is_ok()
+            && self.shm_ptr.map_or(false, |ptr| {
+                let header = ptr as *const ShmHeader;
+                unsafe { std::ptr::read_volatile(std::ptr::addr_of!((*header).rt_flags)) & RACK_WINE_RT_ACTIVE != 0 }
+            });
+        if self.pipeline_depth > 1 && !self.realtime {
+            return Err(Error::Other("Pipelined mode requires the realtime doorbell".to_string()));
+        }
+        self.blocks_submitted = 0;
+        self.pending_events.clear();
+        self.pending_events.reserve(RACK_WINE_MAX_BLOCK_EVENTS);
+
         self.initialized = true;
         Ok(())
     }
@@ -608,52 +1746,7 @@ impl PluginInstance for WineVst3Plugin {
         outputs: &mut [&mut [f32]],
         num_frames: usize,
     ) -> Result<()> {
-        if !self.initialized {
-            return Err(Error::NotInitialized);
-        }
-
-        let shm_ptr = self.shm_ptr.ok_or(Error::NotInitialized)?;
-
-        // Read header to get offsets
-        let header = unsafe { &*(shm_ptr as *const ShmHeader) };
-        let input_offset = header.input_offset as usize;
-        let output_offset = header.output_offset as usize;
-        let block_size = header.block_size as usize;
-
-        // Copy input data to shared memory
-        for (ch, input) in inputs.iter().enumerate() {
-            if ch < self.num_inputs {
-                let dest_offset = input_offset + ch * block_size * std::mem::size_of::<f32>();
-                let dest = unsafe {
-                    std::slice::from_raw_parts_mut(
-                        shm_ptr.add(dest_offset) as *mut f32,
-                        num_frames,
-                    )
-                };
-                let copy_len = num_frames.min(input.len());
-                dest[..copy_len].copy_from_slice(&input[..copy_len]);
-            }
-        }
-
-        // Process
-        self.client.process_audio(num_frames as u32)?;
-
-        // Copy output data from shared memory
-        for (ch, output) in outputs.iter_mut().enumerate() {
-            if ch < self.num_outputs {
-                let src_offset = output_offset + ch * block_size * std::mem::size_of::<f32>();
-                let src = unsafe {
-                    std::slice::from_raw_parts(
-                        shm_ptr.add(src_offset) as *const f32,
-                        num_frames,
-                    )
-                };
-                let copy_len = num_frames.min(output.len());
-                output[..copy_len].copy_from_slice(&src[..copy_len]);
-            }
-        }
-
-        Ok(())
+        self.process_frames(inputs, outputs, num_frames)
     }
 
     fn parameter_count(&self) -> usize {
@@ -661,19 +1754,14 @@ impl PluginInstance for WineVst3Plugin {
     }
 
     fn parameter_info(&self, index: usize) -> Result<ParameterInfo> {
-        if index >= self.param_ids.len() {
-            return Err(Error::InvalidParameter(index));
-        }
-
-        // We'd need to cache this or query the host
-        // For now, return basic info
+        let info = self.param_infos.get(index).ok_or(Error::InvalidParameter(index))?;
         Ok(ParameterInfo {
             index,
-            name: format!("Parameter {}", index),
-            min: 0.0,
-            max: 1.0,
-            default: 0.5,
-            unit: String::new(),
+            name: info.name.clone(),
+            min: info.min_value as f32,
+            max: info.max_value as f32,
+            default: info.default_value as f32,
+            unit: info.units.clone(),
         })
     }
 
@@ -695,33 +1783,27 @@ impl PluginInstance for WineVst3Plugin {
     }
 
     fn send_midi(&mut self, events: &[MidiEvent]) -> Result<()> {
-        let midi_events: Vec<protocol::MidiEvent> = events.iter().map(|e| {
-            let (status, data1, data2) = match e.kind {
-                crate::MidiEventKind::NoteOn { note, velocity, channel } => {
-                    (0x90 | (channel & 0x0F), note, velocity)
-                }
-                crate::MidiEventKind::NoteOff { note, velocity, channel } => {
-                    (0x80 | (channel & 0x0F), note, velocity)
-                }
-                crate::MidiEventKind::ControlChange { controller, value, channel } => {
-                    (0xB0 | (channel & 0x0F), controller, value)
-                }
-                crate::MidiEventKind::ProgramChange { program, channel } => {
-                    (0xC0 | (channel & 0x0F), program, 0)
-                }
-                crate::MidiEventKind::PitchBend { value, channel } => {
-                    let lsb = (value & 0x7F) as u8;
-                    let msb = ((value >> 7) & 0x7F) as u8;
-                    (0xE0 | (channel & 0x0F), lsb, msb)
-                }
-                crate::MidiEventKind::PolyphonicAftertouch { note, pressure, channel } => {
-                    (0xA0 | (channel & 0x0F), note, pressure)
-                }
-                crate::MidiEventKind::ChannelAftertouch { pressure, channel } => {
-                    (0xD0 | (channel & 0x0F), pressure, 0)
+        // Once audio is set up, MIDI goes in-band with the next blocks;
+        // before that it is queued on the host over the socket
+        if self.initialized {
+            // All-or-nothing, like the VST3 and AU queues: don't deliver half
+            // of a chord when the queue is full
+            let count = events.iter().filter(|e| midi_bytes(e).0 != 0).count();
+            if self.pending_events.len() + count > RACK_WINE_MAX_BLOCK_EVENTS {
+                self.dropped_midi_events += count as u64;
+                return Err(Error::Other("In-band event queue is full".to_string()));
+            }
+            for e in events {
+                let (status, data1, data2) = midi_bytes(e);
+                if status != 0 {
+                    self.queue_event(ShmEvent::midi(0, e.sample_offset, status, data1, data2));
                 }
-                _ => (0, 0, 0), // Ignore system real-time messages
-            };
+            }
+            return Ok(());
+        }
+
+        let midi_events: Vec<protocol::MidiEvent> = events.iter().map(|e| {
+            let (status, data1, data2) = midi_bytes(e);
             protocol::MidiEvent::new(e.sample_offset, status, data1, data2)
         }).collect();
 
@@ -742,12 +1824,48 @@ impl PluginInstance for WineVst3Plugin {
     }
 
     fn get_state(&self) -> Result<Vec<u8>> {
-        // Not implemented in protocol yet
-        Err(Error::Other("State serialization not implemented".to_string()))
+        let mut state = Vec::new();
+        self.get_state_into(&mut state)?;
+        Ok(state)
     }
 
-    fn set_state(&mut self, _data: &[u8]) -> Result<()> {
-        Err(Error::Other("State serialization not implemented".to_string()))
+    fn set_state(&mut self, data: &[u8]) -> Result<()> {
+        if data.is_empty() {
+            return Err(Error::Other("State data is empty".to_string()));
+        }
+        let mut region = self.state_region(data.len())?;
+        region.as_mut_slice()[..data.len()].copy_from_slice(data);
+        drop(region);
+        self.client.set_state(data.len() as u64)
+    }
+
+    fn latency_info(&mut self) -> Result<LatencyInfo> {
+        if !self.initialized {
+            return Err(Error::NotInitialized);
+        }
+        // Chain latency plus the delay of the block ring
+        let resp = self.client.get_latency()?;
+        let latency = (resp.chain_latency as u64 + self.latency_samples() as u64).min(u32::MAX as u64) as u32;
+        Ok(LatencyInfo::new(latency, resp.chain_tail))
+    }
+
+    fn latency_generation(&self) -> u32 {
+        self.shm_ptr.map_or(0, |ptr| {
+            let header = ptr as *const ShmHeader;
+            unsafe { std::ptr::read_volatile(std::ptr::addr_of!((*header).latency_generation)) }
+        })
+    }
+
+    fn stats(&mut self) -> Result<ProcessStats> {
+        let mut stats = self.client.get_stats()?;
+        stats.dropped_midi_events += self.dropped_midi_events;
+        Ok(stats)
+    }
+
+    fn reset_stats(&mut self) -> Result<()> {
+        self.client.reset_stats()?;
+        self.dropped_midi_events = 0;
+        Ok(())
     }
 
     fn info(&self) -> &PluginInfo {
@@ -758,3 +1876,25 @@ impl PluginInstance for WineVst3Plugin {
         self.initialized
     }
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_sort_by_sample_offset_is_stable() {
+        // Note-off and note-on at the same offset must keep their order
+        let mut events = [
+            ShmEvent::midi(0, 64, 0x90, 60, 100),
+            ShmEvent::midi(0, 0, 0x80, 62, 0),
+            ShmEvent::midi(0, 64, 0x80, 60, 0),
+            ShmEvent::param(0, 0, 7, 0.5),
+            ShmEvent::midi(0, 32, 0x90, 62, 100),
+        ];
+        sort_by_sample_offset(&mut events);
+
+        let order: Vec<(u32, u8)> = events.iter().map(|e| (e.sample_offset, e.midi[0])).collect();
+        assert_eq!(order, vec![(0, 0x80), (0, 0), (32, 0x90), (64, 0x90), (64, 0x80)]);
+        assert_eq!(events[1].kind, RACK_WINE_EVENT_PARAM);
+    }
+}
@@ -36,6 +36,18 @@ pub enum HostCommand {
     GetParamChanges = 17,
     InitAudio = 20,
     ProcessAudio = 21,
+    StartRealtime = 22,
+    StopRealtime = 23,
+    SelectSlot = 24,
+    SetChain = 25,
+    SetIdleSleep = 26,
+    GetBlockCounts = 27,
+    GetLatency = 28,
+    GetStats = 29,
+    ResetStats = 30,
+    Batch = 31,
+    GetParamInfoAll = 32,
+    SetStateRegion = 33,
     Shutdown = 99,
 }
 
@@ -48,6 +60,8 @@ pub enum Status {
     NotLoaded = 2,
     NotInitialized = 3,
     InvalidParam = 4,
+    /// Shared-memory region too small (see `RespState`)
+    NoSpace = 5,
 }
 
 impl From<u32> for Status {
@@ -58,6 +72,7 @@ impl From<u32> for Status {
             2 => Status::NotLoaded,
             3 => Status::NotInitialized,
             4 => Status::InvalidParam,
+            5 => Status::NoSpace,
             _ => Status::Error,
         }
     }
@@ -160,16 +175,24 @@ pub struct CmdInitAudio {
     pub num_inputs: u32,
     pub num_outputs: u32,
     pub shm_name: [u8; 64],
+    pub pipeline_depth: u32,
+    /// VST3 process mode: 0 = realtime, 2 = offline
+    pub process_mode: u32,
+    /// Shared memory sample format (`RACK_WINE_SAMPLE_*`)
+    pub sample_format: u32,
 }
 
 impl CmdInitAudio {
-    pub fn new(sample_rate: u32, block_size: u32, num_inputs: u32, num_outputs: u32, shm_name: &str) -> Self {
+    pub fn new(sample_rate: u32, block_size: u32, num_inputs: u32, num_outputs: u32, shm_name: &str, pipeline_depth: u32, process_mode: u32, sample_format: u32) -> Self {
         let mut cmd = Self {
             sample_rate,
             block_size,
             num_inputs,
             num_outputs,
             shm_name: [0u8; 64],
+            pipeline_depth,
+            process_mode,
+            sample_format,
         };
         let bytes = shm_name.as_bytes();
         let len = bytes.len().min(63);
@@ -178,12 +201,15 @@ impl CmdInitAudio {
     }
 
     pub fn to_bytes(&self) -> Vec<u8> {
-        let mut buf = Vec::with_capacity(80);
+        let mut buf = Vec::with_capacity(88);
         buf.extend_from_slice(&self.sample_rate.to_le_bytes());
         buf.extend_from_slice(&self.block_size.to_le_bytes());
         buf.extend_from_slice(&self.num_inputs.to_le_bytes());
         buf.extend_from_slice(&self.num_outputs.to_le_bytes());
         buf.extend_from_slice(&self.shm_name);
+        buf.extend_from_slice(&self.pipeline_depth.to_le_bytes());
+        buf.extend_from_slice(&self.process_mode.to_le_bytes());
+        buf.extend_from_slice(&self.sample_format.to_le_bytes());
         buf
     }
 }
@@ -204,6 +230,120 @@ impl CmdProcessAudio {
     }
 }
 
+/// Maximum plugin slots per host process
+pub const RACK_WINE_MAX_SLOTS: usize = 16;
+
+/// CMD_SET_CHAIN payload: stages of parallel slot bitmasks, run in order
+pub struct CmdSetChain {
+    pub stage_masks: Vec<u32>,
+}
+
+impl CmdSetChain {
+    pub fn to_bytes(&self) -> [u8; 4 + RACK_WINE_MAX_SLOTS * 4] {
+        let mut buf = [0u8; 4 + RACK_WINE_MAX_SLOTS * 4];
+        let num_stages = self.stage_masks.len().min(RACK_WINE_MAX_SLOTS);
+        buf[0..4].copy_from_slice(&(num_stages as u32).to_le_bytes());
+        for (i, mask) in self.stage_masks.iter().take(num_stages).enumerate() {
+            buf[4 + i * 4..8 + i * 4].copy_from_slice(&mask.to_le_bytes());
+        }
+        buf
+    }
+}
+
+/// CMD_GET_BLOCK_COUNTS response: blocks processed and skipped while asleep
+#[derive(Debug, Clone, Copy, Default)]
+pub struct RespBlockCounts {
+    pub processed_blocks: u64,
+    pub skipped_blocks: u64,
+}
+
+impl RespBlockCounts {
+    pub fn from_bytes(buf: &[u8]) -> Option<Self> {
+        if buf.len() < 16 {
+            return None;
+        }
+        Some(Self {
+            processed_blocks: u64::from_le_bytes(buf[0..8].try_into().ok()?),
+            skipped_blocks: u64::from_le_bytes(buf[8..16].try_into().ok()?),
+        })
+    }
+}
+
+/// Response: latency of the selected slot and the whole chain
+///
+/// Tails use `LatencyInfo::INFINITE_TAIL` (RACK_WINE_TAIL_INFINITE). The
+/// trailing generation word is not decoded; clients poll
+/// `ShmHeader::latency_generation` instead.
+#[derive(Debug, Clone, Copy)]
+pub struct RespLatency {
+    pub latency_samples: u32,
+    pub tail_samples: u32,
+    pub chain_latency: u32,
+    pub chain_tail: u32,
+}
+
+impl RespLatency {
+    pub fn from_bytes(buf: &[u8]) -> Option<Self> {
+        if buf.len() < 16 {
+            return None;
+        }
+        let word = |i: usize| u32::from_le_bytes(buf[i * 4..i * 4 + 4].try_into().unwrap());
+        Some(Self {
+            latency_samples: word(0),
+            tail_samples: word(1),
+            chain_latency: word(2),
+            chain_tail: word(3),
+        })
+    }
+}
+
+/// Process-time histogram size of RespStats
+pub const RACK_WINE_STATS_HISTOGRAM_BUCKETS: usize = 32;
+
+/// CMD_GET_STATS response: processing statistics of the selected slot
+#[derive(Debug, Clone, Copy)]
+pub struct RespStats {
+    pub process_calls: u64,
+    pub frames: u64,
+    pub total_ns: u64,
+    pub max_ns: u64,
+    pub deadline_ns: u64,
+    pub deadline_misses: u64,
+    pub max_load: f64,
+    pub average_load: f64,
+    pub process_errors: u64,
+    pub dropped_midi_events: u64,
+    pub dropped_param_changes: u64,
+    pub histogram: [u64; RACK_WINE_STATS_HISTOGRAM_BUCKETS],
+}
+
+impl RespStats {
+    pub fn from_bytes(buf: &[u8]) -> Option<Self> {
+        if buf.len() < (11 + RACK_WINE_STATS_HISTOGRAM_BUCKETS) * 8 {
+            return None;
+        }
+        let word = |i: usize| u64::from_le_bytes(buf[i * 8..i * 8 + 8].try_into().unwrap());
+        let mut histogram = [0u64; RACK_WINE_STATS_HISTOGRAM_BUCKETS];
+        for (i, bucket) in histogram.iter_mut().enumerate() {
+            *bucket = word(11 + i);
+        }
+        Some(Self {
+            process_calls: word(0),
+            frames: word(1),
+            total_ns: word(2),
+            max_ns: word(3),
+            deadline_ns: word(4),
+            deadline_misses: word(5),
+            max_load: f64::from_bits(word(6)),
+            average_load: f64::from_bits(word(7)),
+            process_errors: word(8),
+            dropped_midi_events: word(9),
+            dropped_param_changes: word(10),
+            histogram,
+        })
+    }
+}
+
 /// CMD_GET_PARAM / CMD_SET_PARAM payload
 #[repr(C, packed)]
 pub struct CmdParam {
@@ -278,8 +418,11 @@ pub struct RespParamInfo {
 }
 
 impl RespParamInfo {
+    /// Wire size of the packed C struct
+    pub const SIZE: usize = 192;
+
     pub fn from_bytes(buf: &[u8]) -> Option<Self> {
-        if buf.len() < 196 {
+        if buf.len() < Self::SIZE {
             return None;
         }
 
@@ -309,6 +452,127 @@ impl RespParamInfo {
     }
 }
 
+/// CMD_GET_PARAM_INFO_ALL payload: a range of parameter indices
+pub struct CmdParamInfoRange {
+    pub first: u32,
+    pub count: u32,
+}
+
+impl CmdParamInfoRange {
+    pub fn to_bytes(&self) -> [u8; 8] {
+        let mut buf = [0u8; 8];
+        buf[0..4].copy_from_slice(&self.first.to_le_bytes());
+        buf[4..8].copy_from_slice(&self.count.to_le_bytes());
+        buf
+    }
+}
+
+/// CMD_GET_PARAM_INFO_ALL response
+#[derive(Debug, Clone)]
+pub struct RespParamInfoList {
+    /// Parameter count of the selected slot
+    pub total_params: u32,
+    /// Index of `infos[0]`
+    pub first: u32,
+    pub infos: Vec<RespParamInfo>,
+}
+
+impl RespParamInfoList {
+    pub fn from_bytes(buf: &[u8]) -> Option<Self> {
+        if buf.len() < 12 {
+            return None;
+        }
+        let word = |i: usize| u32::from_le_bytes(buf[i * 4..i * 4 + 4].try_into().unwrap());
+        let num_infos = word(2) as usize;
+        let infos_bytes = &buf[12..];
+        if infos_bytes.len() < num_infos * RespParamInfo::SIZE {
+            return None;
+        }
+        let infos = infos_bytes
+            .chunks_exact(RespParamInfo::SIZE)
+            .take(num_infos)
+            .map(RespParamInfo::from_bytes)
+            .collect::<Option<Vec<_>>>()?;
+        Some(Self {
+            total_params: word(0),
+            first: word(1),
+            infos,
+        })
+    }
+}
+
+/// CMD_BATCH payload builder
+///
+/// Entries run in order on the host exactly as separate messages would; a
+/// `SelectSlot` entry retargets the entries after it. Only slot selection
+/// and the parameter commands may be batched.
+#[derive(Debug, Default)]
+pub struct CmdBatch {
+    num_entries: u32,
+    buf: Vec<u8>,
+}
+
+impl CmdBatch {
+    pub fn new() -> Self {
+        Self {
+            num_entries: 0,
+            buf: 0u32.to_le_bytes().to_vec(),
+        }
+    }
+
+    pub fn push(&mut self, cmd: HostCommand, payload: &[u8]) -> &mut Self {
+        self.buf.extend_from_slice(&(cmd as u32).to_le_bytes());
+        self.buf.extend_from_slice(&(payload.len() as u32).to_le_bytes());
+        self.buf.extend_from_slice(payload);
+        self.num_entries += 1;
+        self.buf[0..4].copy_from_slice(&self.num_entries.to_le_bytes());
+        self
+    }
+
+    pub fn len(&self) -> usize {
+        self.num_entries as usize
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.num_entries == 0
+    }
+
+    pub fn as_bytes(&self) -> &[u8] {
+        &self.buf
+    }
+}
+
+/// One entry of the CMD_BATCH response
+#[derive(Debug, Clone)]
+pub struct BatchResult {
+    pub status: Status,
+    /// The command's usual response payload (empty unless `status` is Ok)
+    pub payload: Vec<u8>,
+}
+
+/// Split a CMD_BATCH response into per-entry results
+pub fn parse_batch_response(buf: &[u8]) -> Option<Vec<BatchResult>> {
+    if buf.len() < 4 {
+        return None;
+    }
+    let num_entries = u32::from_le_bytes(buf[0..4].try_into().ok()?) as usize;
+    let mut results = Vec::with_capacity(num_entries.min(buf.len() / 8));
+    let mut offset = 4;
+    for _ in 0..num_entries {
+        let header = buf.get(offset..offset + 8)?;
+        let status = u32::from_le_bytes(header[0..4].try_into().ok()?);
+        let size = u32::from_le_bytes(header[4..8].try_into().ok()?) as usize;
+        offset += 8;
+        let payload = buf.get(offset..offset + size)?;
+        offset += size;
+        results.push(BatchResult {
+            status: Status::from(status),
+            payload: payload.to_vec(),
+        });
+    }
+    Some(results)
+}
+
 /// Response: Editor info
 #[derive(Debug, Clone, Default)]
 pub struct RespEditorInfo {
@@ -400,11 +664,151 @@ pub struct ShmHeader {
     pub client_ready: u32,
     pub input_offset: u32,
     pub output_offset: u32,
-    pub reserved: [u32; 4],
+    pub rt_flags: u32,
+    pub host_waiting: u32,
+    pub client_waiting: u32,
+    pub pipeline_depth: u32,
+    pub slot_stride: u32,
+    pub slot_samples: [u32; RACK_WINE_MAX_PIPELINE_DEPTH],
+    pub sample_format: u32,
+    pub latency_generation: u32,
+    /// Offset of the event block ring (`shm_events_offset`)
+    pub events_offset: u32,
+    pub reserved: [u32; 2],
 }
 
 pub const RACK_WINE_SHM_MAGIC: u32 = 0x52574153; // 'RWAS'
 
+/// Shared memory sample formats (CmdInitAudio/ShmHeader::sample_format)
+pub const RACK_WINE_SAMPLE_F32: u32 = 0;
+pub const RACK_WINE_SAMPLE_F64: u32 = 1;
+
+/// Bytes per sample in a shared memory sample format
+pub fn sample_format_bytes(format: u32) -> usize {
+    if format == RACK_WINE_SAMPLE_F64 {
+        std::mem::size_of::<f64>()
+    } else {
+        std::mem::size_of::<f32>()
+    }
+}
+
+/// Realtime doorbell flags (ShmHeader::rt_flags)
+pub const RACK_WINE_RT_ACTIVE: u32 = 0x1;
+pub const RACK_WINE_RT_FUTEX: u32 = 0x2;
+pub const RACK_WINE_RT_ERROR: u32 = 0x4;
+
+/// Maximum block slots in the pipelined shared memory ring
+pub const RACK_WINE_MAX_PIPELINE_DEPTH: usize = 4;
+
+/// Spin iterations before either side parks on the doorbell
+pub const RACK_WINE_RT_SPIN_COUNT: u32 = 4000;
+
 impl ShmHeader {
     pub const SIZE: usize = std::mem::size_of::<Self>();
 }
+
+/// Events per shared memory block slot
+pub const RACK_WINE_MAX_BLOCK_EVENTS: usize = 512;
+
+/// ShmEvent::kind values
+pub const RACK_WINE_EVENT_MIDI: u32 = 0;
+pub const RACK_WINE_EVENT_PARAM: u32 = 1;
+
+/// In-band event delivered with a block (RackWineShmEvent)
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct ShmEvent {
+    pub kind: u32,
+    /// Plugin slot the event is for
+    pub slot: u32,
+    /// Frame within the block
+    pub sample_offset: u32,
+    /// Parameter ID (RACK_WINE_EVENT_PARAM)
+    pub param_id: u32,
+    /// Status and data bytes (RACK_WINE_EVENT_MIDI)
+    pub midi: [u8; 4],
+    pub reserved: u32,
+    /// Normalized value (RACK_WINE_EVENT_PARAM)
+    pub value: f64,
+}
+
+impl ShmEvent {
+    pub fn midi(slot: u32, sample_offset: u32, status: u8, data1: u8, data2: u8) -> Self {
+        Self {
+            kind: RACK_WINE_EVENT_MIDI,
+            slot,
+            sample_offset,
+            param_id: 0,
+            midi: [status, data1, data2, 0],
+            reserved: 0,
+            value: 0.0,
+        }
+    }
+
+    pub fn param(slot: u32, sample_offset: u32, param_id: u32, value: f64) -> Self {
+        Self {
+            kind: RACK_WINE_EVENT_PARAM,
+            slot,
+            sample_offset,
+            param_id,
+            midi: [0; 4],
+            reserved: 0,
+            value,
+        }
+    }
+}
+
+/// Event area of one block slot (RackWineShmEventBlock)
+#[repr(C)]
+pub struct ShmEventBlock {
+    pub num_events: u32,
+    pub reserved: [u32; 3],
+    pub events: [ShmEvent; RACK_WINE_MAX_BLOCK_EVENTS],
+}
+
+impl ShmEventBlock {
+    pub const SIZE: usize = std::mem::size_of::<Self>();
+}
+
+/// Offset of the event block ring: after the audio block slots, rounded up
+/// to 64 bytes (RACK_WINE_SHM_EVENTS_OFFSET)
+pub fn shm_events_offset(audio_size: usize) -> usize {
+    (audio_size + 63) & !63
+}
+
+/// Largest state region the host maps (RACK_WINE_MAX_STATE_REGION)
+pub const RACK_WINE_MAX_STATE_REGION: u64 = 1 << 32;
+
+/// CMD_SET_STATE_REGION payload: the file plugin state is streamed through
+pub struct CmdStateRegion {
+    pub size: u64,
+    pub shm_name: [u8; 64],
+}
+
+impl CmdStateRegion {
+    pub fn new(size: u64, shm_name: &str) -> Self {
+        let mut cmd = Self { size, shm_name: [0u8; 64] };
+        let bytes = shm_name.as_bytes();
+        let len = bytes.len().min(63);
+        cmd.shm_name[..len].copy_from_slice(&bytes[..len]);
+        cmd
+    }
+
+    pub fn to_bytes(&self) -> [u8; 72] {
+        let mut buf = [0u8; 72];
+        buf[0..8].copy_from_slice(&self.size.to_le_bytes());
+        buf[8..].copy_from_slice(&self.shm_name);
+        buf
+    }
+}
+
+/// CMD_SET_STATE payload and CMD_GET_STATE response (CmdState / RespState):
+/// bytes of state at the start of the region, or with `Status::NoSpace` the
+/// region size the state needs
+pub fn state_size_bytes(size: u64) -> [u8; 8] {
+    size.to_le_bytes()
+}
+
+pub fn parse_state_size(buf: &[u8]) -> Option<u64> {
+    buf.get(..8).map(|b| u64::from_le_bytes(b.try_into().unwrap()))
+}